@@ -106,32 +106,27 @@ T avg ( InputIterator first, InputIterator last, T init )
   return init / static_cast<T>(cnt);
 }
 
-/// Calculate standard deviation
+/// Calculate standard deviation (population).
+/// Single pass, uses Welford's method.
 template <class InputIterator, class T>
 T std_dev(InputIterator first, InputIterator last, T defValue)
 {
-  T outValue = defValue;
+  T meanVal = static_cast<T>(0.0);
+  T sumSqDif = static_cast<T>(0.0);
   T difAvg;
+  int cnt = 0;
 
-  int cnt = (last - first);
-
-  if (cnt > 0) {
-    T avgVal = avg(first, last, 0.0);
-    outValue = 0.0;
-
-    for(InputIterator it = first; it != last; ++it) {
-      difAvg = *it - avgVal;
-      outValue += (difAvg * difAvg);
-    }
-
-    if (cnt == 0) cnt = 1;
-    outValue = (static_cast<T>(1.0) / static_cast<T>(cnt)) * outValue;
-    outValue = sqrt(outValue);
-  } else {
-    outValue = defValue;
+  for(InputIterator it = first; it != last; ++it) {
+    cnt++;
+    difAvg = *it - meanVal;
+    meanVal += difAvg / static_cast<T>(cnt);
+    sumSqDif += difAvg * (*it - meanVal);
   }
 
-  return outValue;
+  if (cnt == 0)
+    return defValue;
+
+  return sqrt(sumSqDif / static_cast<T>(cnt));
 }
 
 /// Find minimum & maximum at the same time
@@ -151,7 +151,7 @@ public:
   virtual void writeObjectEnd() = 0;
   virtual void writeArrayBegin() = 0;
   virtual void writeArrayEnd() = 0;
-  virtual void writeFixTypeArrayBegin(unsigned int arraySize) = 0;
+  virtual void writeFixTypeArrayBegin(size_t arraySize) = 0;
   virtual void writeFixTypeArrayEnd() = 0;
   virtual void writeElementName(char *name) = 0;
   virtual void writeElementName(const std::string &name) = 0;
@@ -229,11 +229,11 @@ public:
     m_output->write(&instrCode, sizeof(char));
   }
 
-  void writeFixTypeArrayBegin(unsigned int arraySize) {
+  void writeFixTypeArrayBegin(size_t arraySize) {
     const char instrCode = bic_fixtype_array;
     m_output->write(&instrCode, sizeof(char));
 
-    char buf[VARINT_MAX_SIZE_INT];
+    char buf[VARINT_MAX_SIZE_INT64];
     unsigned int written = varint_encode(arraySize, buf, sizeof(buf));
     m_output->write(buf, written);
   }
@@ -30,6 +30,7 @@
 #endif
 
 #include <set>
+#include <istream>
 
 #include <boost/shared_ptr.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
@@ -97,6 +98,12 @@ public:
   virtual ~YawlReaderBase();
 
   bool parseString(const dtpString &input);
+  /// Parses next part of input, call parseComplete() after the last one
+  bool parseChunk(const char *input, size_t inputLen);
+  /// Finishes chunked parsing (flushes trailing top-level number)
+  bool parseComplete();
+  /// Parses stream in chunks of a given size, memory use does not depend on input size
+  bool parseStream(std::istream &input, size_t bufferSize = 64 * 1024);
 
   virtual int processNull() = 0;
   virtual int processBoolean(int boolVal) = 0;
@@ -35,12 +35,13 @@ namespace dtp {
 ///    int operator()(int pos, const T &value); // compares item at a given pos with provided value
 /// };
 /// \endcode
-template<typename ValueType, typename CompareOpByPos>
-bool binary_search_by_pos(size_t beginPos, size_t endPos, const ValueType &value, CompareOpByPos compareOp, int &found_pos)
+/// PosType is a signed integer type of positions (int or int64).
+template<typename ValueType, typename CompareOpByPos, typename PosType>
+bool binary_search_by_pos(size_t beginPos, size_t endPos, const ValueType &value, CompareOpByPos compareOp, PosType &found_pos)
 {
-  int left = beginPos;
-  int right = endPos - 1;
-  int cpos;
+  PosType left = static_cast<PosType>(beginPos);
+  PosType right = static_cast<PosType>(endPos) - 1;
+  PosType cpos;
   bool res = false;
   ValueType cv;
   int cres;
@@ -70,4 +70,13 @@
 #define DTP_UNIQUE_PTR_STD
 #endif
 
+// thread-local storage for POD variables
+#if defined(DTP_CPP11)
+#define DTP_THREAD_LOCAL thread_local
+#elif defined(DTP_COMP_VS)
+#define DTP_THREAD_LOCAL __declspec(thread)
+#else
+#define DTP_THREAD_LOCAL __thread
+#endif
+
 #endif //_DTPDEFS_H__
@@ -135,6 +135,12 @@ Name patterns used in dnode:
 #define DATANODE_CHILD_INDEX_VECTOR_STD
 // define to have more RTTI information in build
 #define DATANODE_ADD_RTTI
+/// define to keep global counters of live containers & bridges (see dnMemoryStats)
+//#define DATANODE_MEMORY_STATS
+/// define to collect per-thread counters of hidden operation costs (see dnPerfStats)
+//#define DATANODE_PERF_COUNTERS
+/// define to use 64-bit sizes & positions in containers (over 4G items in array), see dnSizeType
+//#define DATANODE_SIZE64
 
 // enable to use 'unordered_map' for parent children
 //#define DATANODE_UNORDERED_ENABLED sloooow....
@@ -155,6 +161,7 @@ Name patterns used in dnode:
 #include <map>
 #include <vector>
 #include <functional>
+#include <iosfwd>
 
 //C++11
 #ifdef DATANODE_STATIC_ASSERT_STD
@@ -168,6 +175,7 @@ Name patterns used in dnode:
 //boost
 #include <boost/shared_ptr.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/ptr_container/ptr_deque.hpp>
 
 #ifdef DTP_COMP_VS
 #pragma warning( push )
@@ -198,6 +206,7 @@ Name patterns used in dnode:
 #include "base/utils.h"
 
 //sc
+#include "dtp/details/defs.h"
 #include "dtp/details/dtypes.h"
 #include "dtp/details/bin_search.h"
 #include "dtp/details/utils.h"
@@ -209,6 +218,15 @@ namespace dtp {
 // ----------------------------------------------------------------------------
 // Simple type definitions
 // ----------------------------------------------------------------------------
+#ifdef DATANODE_SIZE64
+/// number of items in container
+typedef uint64 dnSizeType;
+/// position of item in container, signed
+typedef int64 dnPosType;
+#else
+typedef uint dnSizeType;
+typedef int dnPosType;
+#endif
 
 // ----------------------------------------------------------------------------
 // Forward class definitions
@@ -267,7 +285,8 @@ enum dnValueType {
 enum dnInitContainerType {
     ict_parent = 1,
     ict_list = 2,
-    ict_array
+    ict_array,
+    ict_deque
 };
 
 enum dnPos {
@@ -277,6 +296,50 @@ enum dnPos {
 
 dtpString getValueTypeName(dnValueType accessType);
 
+// ----------------------------------------------------------------------------
+// dnPerfCounters
+// ----------------------------------------------------------------------------
+/// Counters of hidden costs in data node operations, collected per thread.
+struct dnPerfCounters {
+  uint64 bridgeAllocs;     ///< value bridges created (iterators, at())
+  uint64 poolHits;         ///< bridges reused from object pool
+  uint64 poolMisses;       ///< bridges which required object pool growth
+  uint64 deepCopies;       ///< containers (parent, list, array) copied with contents
+  uint64 stringAllocs;     ///< string objects allocated for values
+  uint64 typeConversions;  ///< value reads & casts between different types
+  uint64 exceptionsThrown; ///< data node errors (dnError) created
+
+  void clear() {
+    bridgeAllocs = poolHits = poolMisses = deepCopies = stringAllocs = typeConversions = exceptionsThrown = 0;
+  }
+};
+
+// ----------------------------------------------------------------------------
+// dnPerfStats
+// ----------------------------------------------------------------------------
+/// Access to performance counters of calling thread.
+/// Counters are collected only if DATANODE_PERF_COUNTERS is defined, otherwise all values are zero.
+class dnPerfStats {
+public:
+  /// Returns true if counters are compiled in.
+  static bool enabled();
+  /// Returns copy of counters of calling thread.
+  static dnPerfCounters snapshot();
+  /// Sets counters of calling thread to zero.
+  static void reset();
+  /// Returns counters as text: "name=value; name=value..."
+  static dtpString toString(const dnPerfCounters &counters);
+};
+
+namespace Details {
+#ifdef DATANODE_PERF_COUNTERS
+extern DTP_THREAD_LOCAL dnPerfCounters dnPerfCountersLocal;
+#define DN_PERF_INC(a) (++dtp::Details::dnPerfCountersLocal.a)
+#else
+#define DN_PERF_INC(a)
+#endif
+} // namespace Details
+
 // ----------------------------------------------------------------------------
 // Errors
 // ----------------------------------------------------------------------------
@@ -286,7 +349,7 @@ class dnError: public std::runtime_error {
 public:
   dnError(const std::string s)
     : std::runtime_error(s)
-    { }
+    { DN_PERF_INC(exceptionsThrown); }
 };
 
 class dnNotImplementedError: public dnError {
@@ -325,6 +388,141 @@ public:
   virtual void nodeValue(const dnode &node) { }
 };
 
+// ----------------------------------------------------------------------------
+// dnDumpSink
+// ----------------------------------------------------------------------------
+/// Output of streamed dnode::dump(), receives text in parts.
+class dnDumpSink {
+public:
+  virtual ~dnDumpSink() {}
+  virtual void write(const char *text, size_t length) = 0;
+};
+
+/// Writes dump to output stream
+class dnDumpStreamSink: public dnDumpSink {
+public:
+  dnDumpStreamSink(std::ostream &output): m_output(output) {}
+  virtual void write(const char *text, size_t length);
+private:
+  std::ostream &m_output;
+};
+
+/// Appends dump to string
+class dnDumpStringSink: public dnDumpSink {
+public:
+  dnDumpStringSink(dtpString &output): m_output(output) {}
+  virtual void write(const char *text, size_t length) { m_output.append(text, length); }
+private:
+  dtpString &m_output;
+};
+
+/// Limits of streamed dump, 0 = no limit
+struct dnDumpOptions {
+  /// Contents of containers on this depth (root = 0) or deeper are written as "..."
+  uint maxDepth;
+  /// Output is cut after this number of characters & "..." is appended
+  uint64 maxSize;
+
+  dnDumpOptions(): maxDepth(0), maxSize(0) {}
+};
+
+// ----------------------------------------------------------------------------
+// dnMemoryUsage
+// ----------------------------------------------------------------------------
+/// Estimated memory (in bytes) used by data node structure, grouped by category.
+/// Heap allocator overhead is not included.
+struct dnMemoryUsage {
+  uint64 nodeCount;   ///< number of nodes, including root
+  uint64 nodeHeaders; ///< dnode objects
+  uint64 strings;     ///< string values: objects & their buffers
+  uint64 childMaps;   ///< child containers: objects, name map & index vector
+  uint64 nameVectors; ///< child name vectors, including name buffers
+  uint64 arrays;      ///< array objects & item buffers
+
+  dnMemoryUsage() { clear(); }
+
+  void clear() {
+    nodeCount = nodeHeaders = strings = childMaps = nameVectors = arrays = 0;
+  }
+
+  uint64 total() const {
+    return nodeHeaders + strings + childMaps + nameVectors + arrays;
+  }
+
+  dnMemoryUsage &operator+=(const dnMemoryUsage &rhs) {
+    nodeCount += rhs.nodeCount;
+    nodeHeaders += rhs.nodeHeaders;
+    strings += rhs.strings;
+    childMaps += rhs.childMaps;
+    nameVectors += rhs.nameVectors;
+    arrays += rhs.arrays;
+    return *this;
+  }
+};
+
+// ----------------------------------------------------------------------------
+// dnMemoryStats
+// ----------------------------------------------------------------------------
+/// Global counters of live data node containers.
+/// Counters are collected only if DATANODE_MEMORY_STATS is defined, otherwise all values are zero.
+/// Bridges are process-wide objects (iterators), so they are reported here and not
+/// in dnode::memoryUsage().
+/// Registration of containers is thread-safe, getStats() requires that no other
+/// thread modifies or destroys nodes while it is running.
+class dnMemoryStats {
+public:
+  /// Returns true if counters are compiled in.
+  static bool enabled();
+  /// Fills output with parent node: container type name -> [count, items, bytes].
+  /// Container type names: dnChildColnDblMap, dnChildColnList, dnArrayOfPod<type>, dnArrayOfDataNode2, dnValueBridge.
+  static void getStats(dnode &output);
+  /// Returns number of live value bridges.
+  static uint64 liveBridgeCount();
+  /// Returns estimated number of bytes used by live value bridges.
+  static uint64 liveBridgeBytes();
+
+  static void bridgeCreated();
+  static void bridgeReleased();
+};
+
+namespace Details {
+
+/// Returns number of bytes used by string object and its heap buffer (if any).
+inline uint64 dnStringMemoryUsage(const dtpString &value)
+{
+  const char *data = value.data();
+  const char *objBegin = reinterpret_cast<const char *>(&value);
+  // short strings are stored inside object
+  if ((data >= objBegin) && (data < objBegin + sizeof(dtpString)))
+    return sizeof(dtpString);
+  else
+    return sizeof(dtpString) + value.capacity() + 1;
+}
+
+#ifdef DATANODE_MEMORY_STATS
+/// Base class for containers registered in global list of live objects - see dnMemoryStats.
+class dnMemoryTracked {
+public:
+  dnMemoryTracked();
+  dnMemoryTracked(const dnMemoryTracked &src);
+  virtual ~dnMemoryTracked();
+  dnMemoryTracked &operator=(const dnMemoryTracked &rhs) { return *this; }
+
+  virtual dtpString getMemoryStatName() const = 0;
+  virtual uint64 getMemoryStatItems() const = 0;
+  virtual void calcMemoryUsage(dnMemoryUsage &output, bool deep) const = 0;
+
+private:
+  friend class dtp::dnMemoryStats;
+  void link();
+  void unlink();
+  dnMemoryTracked *m_prev;
+  dnMemoryTracked *m_next;
+};
+#endif
+
+} // namespace Details
+
 // ----------------------------------------------------------------------------
 // dnValueMeta
 // ----------------------------------------------------------------------------
@@ -333,19 +531,26 @@ namespace Details {
 
 class dnChildColnBaseIntf {
 public:
-  typedef uint size_type;
+  typedef dnSizeType size_type;
   virtual bool supportsAccessByName() const = 0;
   virtual dnode &getByName(const dtpString &name) = 0;
   virtual const dnode &getByNameR(const dtpString &name) const = 0;
   virtual dnode *peekChild(const dtpString &name) = 0;
   virtual const dnode *peekChildR(const dtpString &name) const = 0;
-  virtual dnode &at(int pos) = 0;
-  virtual const dnode &at(int pos) const = 0;
+  virtual dnode &at(dnPosType pos) = 0;
+  virtual const dnode &at(dnPosType pos) const = 0;
   virtual size_type size() const = 0;
   virtual bool isList() const = 0;
+  virtual bool isFrozen() const { return false; }
+  virtual bool isDeque() const { return false; }
+  virtual bool isCompact() const { return false; }
 };
 
 class dnChildColnBase;
+class dnChildColnDeque;
+class dnFrozenNamePool;
+class dnCompactBlock;
+class dnDumpWriter;
 
 template <typename T>
 struct dnValueMeta {
@@ -628,6 +833,7 @@ struct dnValueInitializer {
 template <>
 struct dnValueInitializer<dtpString> {
   static void init(dnValueStorage &storage, const dtpString &value) {
+    DN_PERF_INC(stringAllocs);
     storage = (void *)(new dtpString(value));
   }
 };
@@ -635,6 +841,7 @@ struct dnValueInitializer<dtpString> {
 template <>
 struct dnValueInitializer<const char *> {
   static void init(dnValueStorage &storage, const char *value) {
+    DN_PERF_INC(stringAllocs);
     storage = (void *)(new dtpString(value));
   }
 };
@@ -642,6 +849,7 @@ struct dnValueInitializer<const char *> {
 template <>
 struct dnValueInitializer<char *> {
   static void init(dnValueStorage &storage, char *value) {
+    DN_PERF_INC(stringAllocs);
     storage = (void *)(new dtpString(value));
   }
 };
@@ -649,6 +857,7 @@ struct dnValueInitializer<char *> {
 template <unsigned N>
 struct dnValueInitializer<char const[N]> {
   static void init(dnValueStorage &storage, char const value[]) {
+    DN_PERF_INC(stringAllocs);
     storage = (void *)(new dtpString(value));
   }
 };
@@ -803,6 +1012,7 @@ struct dnValueWriter<char *> {
   static void store(dnValueStorage &storage, const value_type &newValue) {
     dtpString *ptr = (dtpString *)(boost::get<void_ptr>(storage));
     if (ptr == DTP_NULL) {
+      DN_PERF_INC(stringAllocs);
       storage = (void *)(new dtpString(newValue));
     } else {
       *ptr = newValue;
@@ -816,6 +1026,7 @@ struct dnValueWriter<dtpString> {
   static void store(dnValueStorage &storage, const value_type &newValue) {
     dtpString *ptr = static_cast<dtpString *>(boost::get<void_ptr>(storage));
     if (ptr == DTP_NULL) {
+      DN_PERF_INC(stringAllocs);
       storage = (void *)(new dtpString(newValue));
     } else {
       *ptr = newValue;
@@ -1303,201 +1514,158 @@ struct dnValueCasterByEnum {
 };
 
 // ----------------------------------------------------------------------------
-// dnValueDynamicCaster
+// dnValueConversion
 // ----------------------------------------------------------------------------
-class dnValueDynamicCaster {
-public:
-  virtual ~dnValueDynamicCaster() {}
-  virtual void cast(int srcValueType, const dnValueStorage &srcStorage, int targetValueType, dnValueStorage &outStorage) = 0;
-  virtual int compare(const dnValueStorage &storage1, const dnValueStorage &storage2) = 0;
-  virtual bool equals(const dnValueStorage &storage1, const dnValueStorage &storage2) = 0;
-};
+/// Cast used by all value reads & conversions - the only place where
+/// conversions between different types are counted.
+template <typename ValueType>
+struct dnValueConversion {
+  typedef typename dnValueCaster<ValueType>::return_type return_type;
 
-// ----------------------------------------------------------------------------
-// dnValueDynamicCasterByType
-// ----------------------------------------------------------------------------
-template<int ValueType>
-class dnValueDynamicCasterByType: public dnValueDynamicCaster {
-public:
-  typedef typename dnValueTypeIdMeta<ValueType>::native_type target_type;
-  virtual void cast(int srcValueType, const dnValueStorage &srcStorage, int targetValueType, dnValueStorage &outStorage)
+  static return_type cast(const dnValueStorage &storage, int srcValueType, int targetValueType)
   {
-    dnValueWriter<target_type>::store(outStorage, dnValueCasterByEnum<ValueType>::cast(srcStorage, srcValueType));
-  }
-
-  virtual int compare(const dnValueStorage &storage1, const dnValueStorage &storage2) {
-    return compareImpl<target_type>(storage1, storage2, dnValueMetaCanCompareDir<target_type>());
-  }
-
-  virtual bool equals(const dnValueStorage &storage1, const dnValueStorage &storage2) {
-    return equalsImpl<target_type>(storage1, storage2, dnValueMetaCanCompareDir<target_type>());
-  }
-
-protected:
-  template<typename TargetValueType>
-  int compareImpl(const dnValueStorage &storage1, const dnValueStorage &storage2, dtpSelector<false> canCompareDirectly) {
-    TargetValueType value1 = dnValueReader<TargetValueType>::getValue(storage1);
-    TargetValueType value2 = dnValueReader<TargetValueType>::getValue(storage2);
-    if (value1 < value2)
-      return -1;
-    else if (value1 > value2)
-      return 1;
-    else
-      return 0;
-  }
-
-  template<typename TargetValueType>
-  int compareImpl(const dnValueStorage &storage1, const dnValueStorage &storage2, dtpSelector<true> canCompareDirectly) {
-    if (storage1 == storage2)
-      return 0;
-    else if (storage1 < storage2)
-      return -1;
-    else
-      return 1;
-  }
-
-  template<typename TargetValueType>
-  bool equalsImpl(const dnValueStorage &storage1, const dnValueStorage &storage2, dtpSelector<false> canCompareDirectly) {
-    TargetValueType value1 = dnValueReader<TargetValueType>::getValue(storage1);
-    TargetValueType value2 = dnValueReader<TargetValueType>::getValue(storage2);
-    return (value1 == value2);
-  }
-
-  template<typename TargetValueType>
-  bool equalsImpl(const dnValueStorage &storage1, const dnValueStorage &storage2, dtpSelector<true> canCompareDirectly) {
-    return (storage1 == storage2);
+    if (srcValueType != targetValueType) {
+      DN_PERF_INC(typeConversions);
+    }
+    return dnValueCaster<ValueType>::cast(storage, srcValueType);
   }
 };
 
 // ----------------------------------------------------------------------------
-// dnValueDynamicCasterRegister
+// dnValueConvMatrix
 // ----------------------------------------------------------------------------
-class dnValueDynamicCasterRegister {
+typedef void (*dnValueCastFunc)(const dnValueStorage &srcStorage, dnValueStorage &outStorage);
+typedef int (*dnValueCompareFunc)(const dnValueStorage &storage1, const dnValueStorage &storage2);
+typedef bool (*dnValueEqualsFunc)(const dnValueStorage &storage1, const dnValueStorage &storage2);
+
+/// Flat source x target dispatch table for value conversion & comparison.
+/// Tables are constant-initialized (see dnode3.cpp), so one cast costs
+/// a single indexed call with both value types fixed at compile time.
+class dnValueConvMatrix {
 public:
-  typedef dnValueDynamicCaster item_type;
-  typedef boost::shared_ptr<item_type> item_guard;
-  typedef std::map<int, item_guard> item_map;
+  enum { type_count = vt_last + 1 };
 
-  static void registerType(dnValueType aType, item_type *item)
+  static void cast(int srcValueType, const dnValueStorage &srcStorage, int targetValueType, dnValueStorage &outStorage)
   {
-    getMap().insert(std::make_pair(aType, item_guard(item)));
+    getCastFunc(srcValueType, targetValueType)(srcStorage, outStorage);
   }
 
-  static void cast(int srcValueType, const dnValueStorage &srcStorage, int targetValueType, dnValueStorage &outStorage)
+  static int compare(int valueType, const dnValueStorage &storage1, const dnValueStorage &storage2)
   {
-    item_map &map = getMap();
-    item_map::iterator it = map.find(targetValueType);
-    if (it != map.end()) {
-      it->second->cast(srcValueType, srcStorage, targetValueType, outStorage);
-    } else {
-      throw std::runtime_error(dtpString("Unknown target value type for cast: ")+toString(targetValueType));
-    }
+    checkType(valueType);
+    return m_compareTable[valueType](storage1, storage2);
   }
 
-  static int compare(int targetValueType, const dnValueStorage &storage1, const dnValueStorage &storage2)
+  static bool equals(int valueType, const dnValueStorage &storage1, const dnValueStorage &storage2)
   {
-    item_map &map = getMap();
-    item_map::iterator it = map.find(targetValueType);
-    if (it != map.end()) {
-      return it->second->compare(storage1, storage2);
-    } else {
-      throw std::runtime_error(dtpString("Unknown target value type for cast: ")+toString(targetValueType));
-      return 0;
-    }
+    checkType(valueType);
+    return m_equalsTable[valueType](storage1, storage2);
   }
 
-  static bool equals(int targetValueType, const dnValueStorage &storage1, const dnValueStorage &storage2)
+  /// Returns <true> if values of a given type can be compared using storage only
+  static bool canCompareDirectly(int valueType)
   {
-    item_map &map = getMap();
-    item_map::iterator it = map.find(targetValueType);
-    if (it != map.end()) {
-      return it->second->equals(storage1, storage2);
-    } else {
-      throw std::runtime_error(dtpString("Unknown target value type for cast: ")+toString(targetValueType));
-      return false;
-    }
+    checkType(valueType);
+    return m_directCompare[valueType];
   }
+
+  static dnValueCastFunc getCastFunc(int srcValueType, int targetValueType)
+  {
+    checkType(srcValueType);
+    checkType(targetValueType);
+    return m_castTable[srcValueType][targetValueType];
+  }
+
+  static void throwUnknownType(int valueType);
 protected:
-  static item_map &getMap() {
-    static item_map registeredItems;
-    return registeredItems;
+  static void checkType(int valueType)
+  {
+    if (static_cast<uint>(valueType) >= type_count)
+      throwUnknownType(valueType);
   }
 private:
+  static const dnValueCastFunc m_castTable[type_count][type_count];
+  static const dnValueCompareFunc m_compareTable[type_count];
+  static const dnValueEqualsFunc m_equalsTable[type_count];
+  static const bool m_directCompare[type_count];
 };
 
 // ----------------------------------------------------------------------------
-// dnValueDynamicCasterBinder
+// dnValueCastCell
 // ----------------------------------------------------------------------------
-/// binds integer value type to caster
-template<int ValueType>
-class dnValueDynamicCasterBinder {
-public:
-  dnValueDynamicCasterBinder() {
-    dnValueDynamicCasterRegister::registerType(static_cast<dnValueType>(ValueType), new dnValueDynamicCasterByType<ValueType>());
+/// Conversion for single (source, target) pair - source switch in dnValueCaster
+/// is folded by compiler since source type is constant here.
+template<int SrcValueType, int TargetValueType, typename TargetType = typename dnValueTypeIdMeta<TargetValueType>::native_type>
+struct dnValueCastCell {
+  static void cast(const dnValueStorage &srcStorage, dnValueStorage &outStorage)
+  {
+    dnValueWriter<TargetType>::store(outStorage, dnValueConversion<TargetType>::cast(srcStorage, SrcValueType, TargetValueType));
   }
 };
 
+/// null, parent & array are not valid conversion targets
+template<int SrcValueType, int TargetValueType>
+struct dnValueCastCell<SrcValueType, TargetValueType, void> {
+  static void cast(const dnValueStorage &srcStorage, dnValueStorage &outStorage)
+  {
+    dnValueConvMatrix::throwUnknownType(TargetValueType);
+  }
+};
 
 // ----------------------------------------------------------------------------
-// dnValueDynamicStrategyRegister
+// dnValueCompareCell
 // ----------------------------------------------------------------------------
-template<typename IntfName>
-class dnValueDynamicStrategyRegister {
-public:
-  typedef IntfName item_type;
-  typedef boost::shared_ptr<item_type> item_guard;
-  typedef item_type *item_ptr;
-  typedef std::vector<item_guard> item_container;
-  typedef std::vector<item_ptr> item_container_raw;
-  typedef dnValueDynamicStrategyRegister<IntfName> this_type;
+template<int ValueType, typename NativeType = typename dnValueTypeIdMeta<ValueType>::native_type>
+struct dnValueCompareCell {
+  static int compare(const dnValueStorage &storage1, const dnValueStorage &storage2) {
+    return compareImpl(storage1, storage2, dnValueMetaCanCompareDir<NativeType>());
+  }
 
-  static void registerType(dnValueType aType, item_type *item)
-  {
-    at(aType, item);
+  static bool equals(const dnValueStorage &storage1, const dnValueStorage &storage2) {
+    return equalsImpl(storage1, storage2, dnValueMetaCanCompareDir<NativeType>());
   }
 
-  static item_type &at(dnValueType aType, item_type *newItem = DTP_NULL) {
-    static item_container registeredItems(vt_last + 1);
-    if (newItem != DTP_NULL) {
-      size_t item_index = static_cast<int>(aType);
-      if (registeredItems.size() <= item_index)
-      {
-        registeredItems.resize(item_index + 1);
-      }
-      registeredItems[item_index] = item_guard(newItem);
-    }
-    return *(registeredItems[aType]);
+protected:
+  static int compareImpl(const dnValueStorage &storage1, const dnValueStorage &storage2, dtpSelector<false> canCompareDirectly) {
+    const NativeType &value1 = dnValueReader<NativeType>::getValue(storage1);
+    const NativeType &value2 = dnValueReader<NativeType>::getValue(storage2);
+    if (value1 < value2)
+      return -1;
+    else if (value1 > value2)
+      return 1;
+    else
+      return 0;
   }
-};
 
-// ----------------------------------------------------------------------------
-// dnValueCompareStrategyIntf
-// ----------------------------------------------------------------------------
-class dnValueCompareStrategyIntf {
-public:
-  virtual ~dnValueCompareStrategyIntf() {}
-  virtual bool canCompareDirectly() = 0;
-};
+  static int compareImpl(const dnValueStorage &storage1, const dnValueStorage &storage2, dtpSelector<true> canCompareDirectly) {
+    if (storage1 == storage2)
+      return 0;
+    else if (storage1 < storage2)
+      return -1;
+    else
+      return 1;
+  }
 
-// ----------------------------------------------------------------------------
-// dnValueCompareStrategy
-// ----------------------------------------------------------------------------
-template<int ValueType>
-class dnValueCompareStrategy: public dnValueCompareStrategyIntf {
-public:
-  virtual bool canCompareDirectly() {
-    return (dnValueCompareMeta<ValueType>::can_compare_dir != 0);
+  static bool equalsImpl(const dnValueStorage &storage1, const dnValueStorage &storage2, dtpSelector<false> canCompareDirectly) {
+    return (dnValueReader<NativeType>::getValue(storage1) == dnValueReader<NativeType>::getValue(storage2));
+  }
+
+  static bool equalsImpl(const dnValueStorage &storage1, const dnValueStorage &storage2, dtpSelector<true> canCompareDirectly) {
+    return (storage1 == storage2);
   }
 };
 
-// ----------------------------------------------------------------------------
-// dnValueCompareStrategyBinder
-// ----------------------------------------------------------------------------
+/// types without native value cannot be compared by value
 template<int ValueType>
-class dnValueCompareStrategyBinder {
-public:
-  dnValueCompareStrategyBinder() {
-    dnValueDynamicStrategyRegister<dnValueCompareStrategyIntf>::registerType(static_cast<dnValueType>(ValueType), new dnValueCompareStrategy<ValueType>());
+struct dnValueCompareCell<ValueType, void> {
+  static int compare(const dnValueStorage &storage1, const dnValueStorage &storage2) {
+    dnValueConvMatrix::throwUnknownType(ValueType);
+    return 0;
+  }
+
+  static bool equals(const dnValueStorage &storage1, const dnValueStorage &storage2) {
+    dnValueConvMatrix::throwUnknownType(ValueType);
+    return false;
   }
 };
 
@@ -1523,7 +1691,7 @@ struct dnValueMetaHasParentVisitor: public dtpSelector<Value>
 
 template <typename Selector>
 class ParentVisitorGeneric {
-    typedef uint size_type;
+    typedef dnSizeType size_type;
 
     template<typename ValueType, typename Visitor>
     static
@@ -1534,14 +1702,14 @@ class ParentVisitorGeneric {
 
     template<typename IntCompareOp>
     static
-    bool binarySearchNode(const dnChildColnBaseIntf *parent, const dnode &value, IntCompareOp compOp, int &foundPos)
+    bool binarySearchNode(const dnChildColnBaseIntf *parent, const dnode &value, IntCompareOp compOp, dnPosType &foundPos)
     {
       throw dnNotImplementedError();
     }
 
     template<typename ValueType, typename IntCompareOp>
     static
-    bool binarySearchValue(const dnChildColnBaseIntf *parent, const ValueType &value, IntCompareOp compOp, int &foundPos)
+    bool binarySearchValue(const dnChildColnBaseIntf *parent, const ValueType &value, IntCompareOp compOp, dnPosType &foundPos)
     {
       throw dnNotImplementedError();
     }
@@ -1556,7 +1724,7 @@ class ParentVisitorGeneric {
 
 template <int ParentType>
 class ParentVisitor {
-    typedef uint size_type;
+    typedef dnSizeType size_type;
     template<typename ValueType, typename Visitor>
     static
     void visitTreeValues(const dnChildColnBaseIntf *parent, Visitor visitor)
@@ -1587,14 +1755,14 @@ class ParentVisitor {
 
     template<typename ValueType, typename IntCompareOp>
     static
-    bool binarySearchValue(const dnChildColnBaseIntf *parent, const ValueType &value, IntCompareOp compOp, int &foundPos)
+    bool binarySearchValue(const dnChildColnBaseIntf *parent, const ValueType &value, IntCompareOp compOp, dnPosType &foundPos)
     {
       throw dnNotImplementedError();
     }
 
     template<typename IntCompareOp>
     static
-    bool binarySearchNode(const dnChildColnBaseIntf *parent, const dnode &value, IntCompareOp compOp, int &foundPos)
+    bool binarySearchNode(const dnChildColnBaseIntf *parent, const dnode &value, IntCompareOp compOp, dnPosType &foundPos)
     {
       throw dnNotImplementedError();
     }
@@ -1659,7 +1827,7 @@ class ParentVisitor {
 /// Use it when you want to have STL container with variable-type values.
 class dnValue {
 public:
-    typedef uint size_type;
+    typedef dnSizeType size_type;
 
     //dnValue();
     dnValue(): m_valueType(vt_null) {}
@@ -1776,7 +1944,7 @@ public:
       {
         return dnValueReader<ValueType>::getValue(m_valueData);
       } else {
-        return dnValueCaster<ValueType>::cast(m_valueData, m_valueType);
+        return dnValueConversion<ValueType>::cast(m_valueData, m_valueType, dnValueTypeMeta<ValueType>::item_type);
       }
     }
 
@@ -1971,28 +2139,28 @@ public:
 
   template <typename ValueType, typename CompOp, class ArrayType>
   static
-  bool binarySearchValue(ArrayType *aArray, const ValueType &value, CompOp compOp, int &foundPos)
+  bool binarySearchValue(ArrayType *aArray, const ValueType &value, CompOp compOp, dnPosType &foundPos)
   {
       throw dnNotImplementedError();
   }
 
   template<typename ValueType, typename IntCompareOp, class ArrayType>
   static
-  bool binarySearchValueDirect(ArrayType *aArray, const ValueType &value, IntCompareOp compOp, int &foundPos)
+  bool binarySearchValueDirect(ArrayType *aArray, const ValueType &value, IntCompareOp compOp, dnPosType &foundPos)
   {
       throw dnNotImplementedError();
   }
 
   template<typename ValueType, typename IntCompareOp, class ArrayType>
   static
-  bool binarySearchValueByItem(ArrayType *aArray, const ValueType &value, IntCompareOp compOp, int &foundPos)
+  bool binarySearchValueByItem(ArrayType *aArray, const ValueType &value, IntCompareOp compOp, dnPosType &foundPos)
   {
       throw dnNotImplementedError();
   }
 
   template<typename IntCompareOp, class ArrayType>
   static
-  bool binarySearchNode(ArrayType *aArray, const dnode &value, IntCompareOp compOp, int &foundPos)
+  bool binarySearchNode(ArrayType *aArray, const dnode &value, IntCompareOp compOp, dnPosType &foundPos)
   {
       throw dnNotImplementedError();
   }
@@ -2043,9 +2211,13 @@ struct dnArrayVisitMeta {
 };
 
 ///base class for all arrays
-class dnArray {
+class dnArray
+#ifdef DATANODE_MEMORY_STATS
+  : public dnMemoryTracked
+#endif
+{
 public:
-  typedef uint size_type;
+  typedef dnSizeType size_type;
   static const size_type npos;
   //static const size_type npos = static_cast<dnArray::size_type>(-1);
 
@@ -2060,12 +2232,12 @@ public:
   virtual bool empty() const = 0;
   virtual dnArray *clone() const = 0;
   virtual dnArray *cloneEmpty() const = 0;
-  virtual void getItem(int index, dnode &output) const = 0;
-  virtual const dnode &getNode(int index, dnode &helper) const;
-  virtual dnode *getNodePtr(int index, dnode &helper) const;
-  virtual void setItem(int index, const dnode &input) = 0;
-  virtual void setItemValue(int index, const dnode &input);
-  virtual void setNode(int index, const dnode &value);
+  virtual void getItem(dnPosType index, dnode &output) const = 0;
+  virtual const dnode &getNode(dnPosType index, dnode &helper) const;
+  virtual dnode *getNodePtr(dnPosType index, dnode &helper) const;
+  virtual void setItem(dnPosType index, const dnode &input) = 0;
+  virtual void setItemValue(dnPosType index, const dnode &input);
+  virtual void setNode(dnPosType index, const dnode &value);
   virtual void addItem(const dnValue &input) = 0;
   void addItem(const dnode &input) { addItemAsNode(input); }
   virtual void addItem(base::move_ptr<dnode> input) = 0;
@@ -2074,16 +2246,25 @@ public:
   virtual void addItemAtFront(const dnode &input) = 0;
   virtual void addItemAtPos(size_type pos, const dnode &input) = 0;
   virtual void eatItem(dnode &input);
-  virtual void eraseItem(int index) = 0;
-  virtual void eraseFrom(int index) = 0;
+  virtual void eraseItem(dnPosType index) = 0;
+  virtual void eraseFrom(dnPosType index) = 0;
+  /// removes count items starting at index
+  virtual void eraseRange(dnPosType index, dnPosType count) = 0;
   virtual size_type indexOfValue(const dnode &input) const = 0;
   virtual size_type findByName(const dtpString &name) const { return npos; }
   virtual void clear() = 0;
   virtual size_type size() const = 0;
   virtual void resize(size_type newSize) = 0;
+  /// releases unused capacity of item storage
+  virtual void shrinkToFit() {}
 
   virtual void swap(size_type pos1, size_type pos2) = 0;
 
+  /// adds memory used by array to output, including contained nodes if deep = true
+  virtual void calcMemoryUsage(dnMemoryUsage &output, bool deep) const = 0;
+  virtual dtpString getMemoryStatName() const;
+  virtual uint64 getMemoryStatItems() const { return size(); }
+
   //template<typename ValueType>
   //  typename dtpDisableIf<Details::dnValueMetaIsObject<ValueType>, void>::type
   //    addItem(ValueType value)
@@ -2230,7 +2411,7 @@ public:
 
 
   template <typename ValueType, typename CompOp>
-  bool binarySearchValue(const ValueType &value, CompOp compOp, int &foundPos) const
+  bool binarySearchValue(const ValueType &value, CompOp compOp, dnPosType &foundPos) const
   {
      typedef typename dnArrayVisitMeta<ValueType>::visitor_tag visitor_tag;
      typedef dnArrayVisitor<visitor_tag> ArrayVisitor;
@@ -2333,7 +2514,7 @@ public:
   //}
 
   template<typename ValueType, typename IntCompareOp>
-  bool binarySearchValueDirect(const ValueType &value, IntCompareOp compOp, int &foundPos) const
+  bool binarySearchValueDirect(const ValueType &value, IntCompareOp compOp, dnPosType &foundPos) const
   {
      typedef typename dnArrayVisitMeta<ValueType>::visitor_tag visitor_tag;
      typedef dnArrayVisitor<visitor_tag> ArrayVisitor;
@@ -2341,7 +2522,7 @@ public:
   }
 
   template<typename ValueType, typename IntCompareOp>
-  bool binarySearchValueByItem(const ValueType &value, IntCompareOp compOp, int &foundPos) const
+  bool binarySearchValueByItem(const ValueType &value, IntCompareOp compOp, dnPosType &foundPos) const
   {
      typedef typename dnArrayVisitMeta<ValueType>::visitor_tag visitor_tag;
      typedef dnArrayVisitor<visitor_tag> ArrayVisitor;
@@ -2349,7 +2530,7 @@ public:
   }
 
   template<typename IntCompareOp>
-  bool binarySearchNode(const dnode &value, IntCompareOp compOp, int &foundPos) const
+  bool binarySearchNode(const dnode &value, IntCompareOp compOp, dnPosType &foundPos) const
   {
      typedef typename dnArrayVisitMeta<IntCompareOp>::visitor_tag visitor_tag;
      typedef dnArrayVisitor<visitor_tag> ArrayVisitor;
@@ -2406,16 +2587,18 @@ namespace Details {
 
 typedef boost::ptr_vector<dnode> dnodeColn;
 typedef dnodeColn::auto_type dnodeColnTransport;
+typedef boost::ptr_deque<dnode> dnodeDequeColn;
 
 #ifdef DATANODE_UNORDERED_ENABLED
 typedef boost::unordered_map<dtpString, dnChildTransporter>  dnChildColnNameMap;
 typedef boost::unordered_map<int, dnChildTransporter>  dnChildColnIndexMap;
 #else
 #ifdef DATANODE_POOL_CONTAINERS
+// pools are shared by all threads - default (mutex) synchronisation is required
 typedef boost::fast_pool_allocator<
 				std::pair<dtpString, dnChildTransporter>,
 				boost::default_user_allocator_new_delete,
-				boost::details::pool::null_mutex>
+				boost::details::pool::default_mutex>
                                 //,8192>
 		  dnChildColnNameMapAllocator;
 
@@ -2441,7 +2624,7 @@ typedef dnodeColn dnChildColnIndexMap;
 #endif
 typedef std::vector<dtpString> dnChildColnNameVector;
 #else
-typedef boost::pool_allocator<dnChildTransporter, boost::default_user_allocator_new_delete, boost::details::pool::null_mutex>
+typedef boost::pool_allocator<dnChildTransporter, boost::default_user_allocator_new_delete, boost::details::pool::default_mutex>
   dnChildColnIndexMapAllocator;
 typedef std::vector<dnChildTransporter, dnChildColnIndexMapAllocator>  dnChildColnIndexMap;
 #endif // DATANODE_CHILD_MAP_NOT_SMART
@@ -2485,7 +2668,7 @@ class dnode: public dnValue {
     typedef Details::dnChildColnBaseIntf dnChildColnBaseIntf;
     typedef Details::dnArray dnArray;
 public:
-    typedef uint size_type;
+    typedef dnSizeType size_type;
     typedef dnArray array_type;
 
     static const size_type npos;
@@ -2672,11 +2855,29 @@ public:
 
     void setAsParent();
     void setAsList();
+    /// Converts node to list with O(1) insert & erase at both ends (see dnChildColnDeque)
+    void setAsDeque();
+    /// Returns true if node is a list in deque mode
+    bool isDeque() const;
     void setAsNull();
 
     dnChildColnBase &getChildren();
     const dnChildColnBase &getChildrenR() const;
 
+    /// Converts parent / list (with all nested ones) to immutable compact form.
+    /// After that any modification of children throws dnError,
+    /// children are accessible with const methods only. Other nodes are not changed.
+    void freeze();
+    bool isFrozen() const;
+
+    /// Relocates all nodes of subtree to one contiguous block, in depth-first order
+    /// (children of each container are stored next to each other), shrinks child
+    /// vectors, name indexes & arrays to fit. Tree can be modified later, new nodes
+    /// are allocated outside of block. Frozen containers are not changed.
+    void compact();
+    /// Returns true if children of node are stored in compacted form
+    bool isCompact() const;
+
     dnArray *getArray()
     {
       return getAsArray();
@@ -2744,7 +2945,7 @@ public:
     }
 
     /// Remove child from container and returns it (similar to auto_ptr::release)
-    dnode *extractChild(int index);
+    dnode *extractChild(dnPosType index);
 
     /// Add children from input - move them
     void transferChildrenFrom(dnode &input);
@@ -2800,46 +3001,50 @@ public:
     /// \Result Returns <false> if node contains any items, <true> otherwise.
     bool empty() const;
 
-    dnode &getElement(int index, dnode &output) const;
-    const dnode getElement(int index) const;
+    dnode &getElement(dnPosType index, dnode &output) const;
+    const dnode getElement(dnPosType index) const;
     dnode &getElement(const dtpString &aName, dnode &output) const;
     const dnode getElement(const dtpString &aName) const;
 
     bool getElementSafe(const dtpString &aName, dnode &output) const;
     bool hasElement(const dtpString &name) const;
 
-    dnValueType getElementType(int index) const;
+    dnValueType getElementType(dnPosType index) const;
     dnValueType getElementType(const dtpString &aName) const;
     dnValueType getElementType() const;
 
-    void forceElementType(int index, dnValueType valueType);
+    void forceElementType(dnPosType index, dnValueType valueType);
+    /// Converts all elements to a given type.
+    /// Arrays of numbers (byte, int, uint, int64, uint64, float, double, xdouble) are converted
+    /// to array of target type in a single pass (static_cast of each value,
+    /// values must fit in target type - e.g. no negative values for byte / uint).
     void forceElementTypeAll(dnValueType valueType);
 
-    const dtpString getElementName(int index) const;
-    void getElementName(int index, dtpString &output) const;
-    dnode *cloneElement(int index) const;
+    const dtpString getElementName(dnPosType index) const;
+    void getElementName(dnPosType index, dtpString &output) const;
+    dnode *cloneElement(dnPosType index) const;
 
-    void setElement(int index, const dnode &value);
+    void setElement(dnPosType index, const dnode &value);
     void setElement(const dtpString &aName, const dnode &value);
     bool setElementSafe(const dtpString &aName, const dnode &value);
     bool setElementSafe(const dtpString &aName, base::move_ptr<dnode> value);
 
-    void setElementValue(int index, const dnode &value);
+    void setElementValue(dnPosType index, const dnode &value);
     void setElementValue(const dtpString &aName, const dnode &value);
 
     bool getElementByPath(const dnode &pathNode, dnode &output);
     bool setElementByPath(const dnode &pathNode, const dnode &value);
 
-    const dnode &getNode(int index, dnode &helper) const;
+    const dnode &getNode(dnPosType index, dnode &helper) const;
     const dnode &getNode(const dtpString &aName, dnode &helper) const;
 
-    dnode *getNodePtr(int index, dnode &helper);
+    dnode *getNodePtr(dnPosType index, dnode &helper);
     dnode *getNodePtr(const dtpString &aName, dnode &helper);
 
-    const dnode *getNodePtrR(int index, dnode &helper) const;
+    const dnode *getNodePtrR(dnPosType index, dnode &helper) const;
     const dnode *getNodePtrR(const dtpString &aName, dnode &helper) const;
 
-    void setNode(int index, dnode &value);
+    void setNode(dnPosType index, dnode &value);
     void setNode(const dtpString &aName, dnode &value);
 
     dnode &addElement(const dnode &value);
@@ -2851,8 +3056,10 @@ public:
     //move value from node to a new sub-node
     void eatElement(dnode& src);
     //remove element from collection
-    void eraseElement(uint index);
-    void eraseFrom(uint index);
+    void eraseElement(dnSizeType index);
+    void eraseFrom(dnSizeType index);
+    /// Removes count elements starting at index (children or array items)
+    void eraseElements(dnSizeType index, dnSizeType count);
 
 //
 // value shortcuts
@@ -2902,30 +3109,30 @@ public:
     DTP_DEPRECATED void setDateTime(const dtpString &a_name, fdatetime_t value);
 
 //---- by integer position
-    DTP_DEPRECATED dtpString getString(int a_index) const;
-    DTP_DEPRECATED bool getBool(int a_index) const;
-    DTP_DEPRECATED int getInt(int a_index) const;
-    DTP_DEPRECATED byte getByte(int a_index) const;
-    DTP_DEPRECATED uint getUInt(int a_index) const;
-    DTP_DEPRECATED int64 getInt64(int a_index) const;
-    DTP_DEPRECATED uint64 getUInt64(int a_index) const;
-    DTP_DEPRECATED float getFloat(int a_index) const;
-    DTP_DEPRECATED double getDouble(int a_index) const;
-    DTP_DEPRECATED xdouble getXDouble(int a_index) const;
-    DTP_DEPRECATED void_ptr getVoidPtr(int a_index) const;
+    DTP_DEPRECATED dtpString getString(dnPosType a_index) const;
+    DTP_DEPRECATED bool getBool(dnPosType a_index) const;
+    DTP_DEPRECATED int getInt(dnPosType a_index) const;
+    DTP_DEPRECATED byte getByte(dnPosType a_index) const;
+    DTP_DEPRECATED uint getUInt(dnPosType a_index) const;
+    DTP_DEPRECATED int64 getInt64(dnPosType a_index) const;
+    DTP_DEPRECATED uint64 getUInt64(dnPosType a_index) const;
+    DTP_DEPRECATED float getFloat(dnPosType a_index) const;
+    DTP_DEPRECATED double getDouble(dnPosType a_index) const;
+    DTP_DEPRECATED xdouble getXDouble(dnPosType a_index) const;
+    DTP_DEPRECATED void_ptr getVoidPtr(dnPosType a_index) const;
     // setters
-    DTP_DEPRECATED void setString(int a_index, const dtpString &value);
-    DTP_DEPRECATED void setString(int a_index, const char *value);
-    DTP_DEPRECATED void setBool(int a_index, bool value);
-    DTP_DEPRECATED void setInt(int a_index, int value);
-    DTP_DEPRECATED void setByte(int a_index, byte value);
-    DTP_DEPRECATED void setUInt(int a_index, uint value);
-    DTP_DEPRECATED void setInt64(int a_index, int64 value);
-    DTP_DEPRECATED void setUInt64(int a_index, uint64 value);
-    DTP_DEPRECATED void setFloat(int a_index, float value);
-    DTP_DEPRECATED void setDouble(int a_index, double value);
-    DTP_DEPRECATED void setXDouble(int a_index, xdouble value);
-    DTP_DEPRECATED void setVoidPtr(int a_index, void_ptr value);
+    DTP_DEPRECATED void setString(dnPosType a_index, const dtpString &value);
+    DTP_DEPRECATED void setString(dnPosType a_index, const char *value);
+    DTP_DEPRECATED void setBool(dnPosType a_index, bool value);
+    DTP_DEPRECATED void setInt(dnPosType a_index, int value);
+    DTP_DEPRECATED void setByte(dnPosType a_index, byte value);
+    DTP_DEPRECATED void setUInt(dnPosType a_index, uint value);
+    DTP_DEPRECATED void setInt64(dnPosType a_index, int64 value);
+    DTP_DEPRECATED void setUInt64(dnPosType a_index, uint64 value);
+    DTP_DEPRECATED void setFloat(dnPosType a_index, float value);
+    DTP_DEPRECATED void setDouble(dnPosType a_index, double value);
+    DTP_DEPRECATED void setXDouble(dnPosType a_index, xdouble value);
+    DTP_DEPRECATED void setVoidPtr(dnPosType a_index, void_ptr value);
 
 // with template access
     /// Returns item selected by name, if does not exist or is NULL then defValue is returned.
@@ -2940,7 +3147,7 @@ public:
 //      return 0;
       ValueType res;
 
-      const dnode *child = const_cast<dnChildColnBaseIntf *>(getAsChildrenIntfR())->peekChildR(name);
+      const dnode *child = peekChildR(name);
 
       if (child != NULL) {
         if (child->getValueType() == vt_null)
@@ -2965,7 +3172,7 @@ public:
       //throw dnError("Not implemented!");
       //return 0;
       ValueType res;
-      dnode *child = const_cast<dnChildColnBaseIntf *>(getChildrenPtrR())->peekChildR(name);
+      const dnode *child = peekChildR(name);
       if (child != NULL) {
         if (child->getValueType() == vt_null)
           res = defValue;
@@ -2980,7 +3187,7 @@ public:
     template<typename ValueType>
     ValueType get(const dtpString &name) const
     {
-      return (*(const_cast<dnode *>(this)))[name].getAs<ValueType>();
+      return (*this)[name].getAs<ValueType>();
     }
 
     template<typename ValueType>
@@ -3006,7 +3213,7 @@ public:
         return getAsArrayNoCheckR()->get<ValueType>(index);
       } else if (isParent()) {
         //return const_cast<dnChildColnBaseIntf *>(getAsChildrenNoCheckR())->at(index).getAs<ValueType>();
-        return const_cast<dnChildColnBaseIntf *>(getAsChildrenIntfR())->at(index).getAs<ValueType>();
+        return getAsChildrenIntfR()->at(index).getAs<ValueType>();
       } else {
         throwNotContainer();
         return ValueType();
@@ -3022,7 +3229,7 @@ public:
       if (isArray()) {
         output = getAsArrayNoCheckR()->get<ValueType>(index);
       } else if (isParent()) {
-        output = const_cast<dnChildColnBaseIntf *>(getAsChildrenNoCheckR())->at(index).getAs<ValueType>();
+        output = getAsChildrenIntfR()->at(index).getAs<ValueType>();
       } else {
         throwNotContainer();
         output = ValueType();
@@ -3058,9 +3265,9 @@ public:
     void moveFrom(dnode& src);
 
 //---
-    const dnode &operator[](int idx) const;
+    const dnode &operator[](dnPosType idx) const;
     const dnode &operator[](const dtpString &str_idx) const;
-    dnode &operator[](int idx);
+    dnode &operator[](dnPosType idx);
     dnode &operator[](const dtpString &str_idx);
 
     void scan(dnScanner &scanner) const;
@@ -3068,6 +3275,16 @@ public:
     /// Convert node to a string, including each contained item on each level.
     /// Useful for debugging.
     dtpString dump(const dtpString &indent = "", const dtpString &name = "") const;
+    /// Writes the same text as dump() to output, depth-first, without building it in memory.
+    /// \result Returns <false> if output was cut because of options limits.
+    bool dump(std::ostream &output, const dnDumpOptions &options = dnDumpOptions()) const;
+    bool dump(dnDumpSink &output, const dnDumpOptions &options = dnDumpOptions()) const;
+
+    /// Returns estimated memory used by this node and all contained nodes.
+    dnMemoryUsage memoryUsage() const;
+
+    /// Adds memory used by value & contained nodes to output (node object itself is not included).
+    void calcContentsMemoryUsage(dnMemoryUsage &output) const;
 
     DTP_DEPRECATED dtpString dumpHierarchy() const;
 
@@ -3092,6 +3309,8 @@ public:
     static dnode explode(const dtpString &separator, const dtpString &a_text, bool useAsNames = false);
 
 protected:
+    void intFreeze(const boost::shared_ptr<Details::dnFrozenNamePool> &namePool);
+    void intCompact(const boost::shared_ptr<Details::dnCompactBlock> &block);
     void intAddChild(const dtpString &name, dnode *child);
 
     using inherited::copyFrom;
@@ -3200,10 +3419,8 @@ protected:
   dnChildColnBase &setupChildren(bool aNamed);
   void disposeChildren();
   void disposeArray();
-  dtpString dumpValue(const dtpString &indent) const;
-  dtpString dumpChildren(const dtpString &indent) const;
-  dtpString dumpItems(const dtpString &indent) const;
   void copyStructureFrom( const dnode& src);
+  void intDump(Details::dnDumpWriter &writer, const dtpString &name) const;
   void scanValue(dnScanner &scanner) const;
   void scanChildren(dnScanner &scanner) const;
   void scanItems(dnScanner &scanner) const;
@@ -3232,13 +3449,22 @@ public:
 ///
 class dnValueBridge {
 protected:
-   dnValueBridge() {}
-   dnValueBridge( const dnValueBridge& src) {}
+#ifdef DATANODE_MEMORY_STATS
+   dnValueBridge() { dnMemoryStats::bridgeCreated(); DN_PERF_INC(bridgeAllocs); }
+   dnValueBridge( const dnValueBridge& src) { dnMemoryStats::bridgeCreated(); DN_PERF_INC(bridgeAllocs); }
+#else
+   dnValueBridge() { DN_PERF_INC(bridgeAllocs); }
+   dnValueBridge( const dnValueBridge& src) { DN_PERF_INC(bridgeAllocs); }
+#endif
 public:
-    typedef uint size_type;
+    typedef dnSizeType size_type;
     static const size_type npos;
 
+#ifdef DATANODE_MEMORY_STATS
+    virtual ~dnValueBridge() { dnMemoryStats::bridgeReleased(); }
+#else
     virtual ~dnValueBridge() {}
+#endif
 
     virtual void release_to_pool() = 0;
 
@@ -3349,8 +3575,8 @@ public:
 
     virtual void setPosBegin() = 0; /// set pos to begin
     virtual void setPosEnd() = 0; /// set pos to end
-    virtual void incPos(int value = 1) = 0; /// increment pos
-    virtual void decPos(int value = 1) = 0; /// decrement pos
+    virtual void incPos(dnPosType value = 1) = 0; /// increment pos
+    virtual void decPos(dnPosType value = 1) = 0; /// decrement pos
 
     // container info
     virtual bool empty() const = 0;
@@ -3363,7 +3589,7 @@ public:
       return (calcPosDiff(value) < 0);
     }
 
-    virtual int calcPosDiff(const dnValueBridge& value) const = 0;
+    virtual dnPosType calcPosDiff(const dnValueBridge& value) const = 0;
 protected:
     virtual dnode &getAsNodeRef();
 }; // dnValueBridge
@@ -3379,9 +3605,9 @@ class dnConstIterator
         typedef dnode parent_type;
         typedef value_type& reference;
         typedef value_type* pointer;
-        typedef int difference_type;
+        typedef dnPosType difference_type;
         typedef std::random_access_iterator_tag iterator_category;
-        typedef uint size_type;
+        typedef dnSizeType size_type;
 
         dnConstIterator() : m_target(0) { }
         ~dnConstIterator()
@@ -3526,8 +3752,8 @@ class dnIterator: public dnConstIterator
         typedef value_type& reference;
         typedef value_type* pointer;
         typedef std::random_access_iterator_tag iterator_category;
-        typedef int difference_type;
-        typedef uint size_type;
+        typedef dnPosType difference_type;
+        typedef dnSizeType size_type;
 
     private:
         explicit dnIterator(const dnConstIterator& x) : dnConstIterator(x){}
@@ -3593,7 +3819,7 @@ public:
   typedef T value_type;
   typedef value_type& reference;
   typedef value_type* pointer;
-  typedef int difference_type;
+  typedef dnPosType difference_type;
   typedef dtp::dnode::size_type size_type;
   typedef std::random_access_iterator_tag iterator_category;
 
@@ -3758,7 +3984,7 @@ public:
   typedef T value_type;
   typedef value_type& reference;
   typedef value_type* pointer;
-  typedef int difference_type;
+  typedef dnPosType difference_type;
   typedef dtp::dnode::size_type size_type;
   typedef std::random_access_iterator_tag iterator_category;
 
@@ -3924,7 +4150,7 @@ public:
 }; // scalar_iterator
 
 protected:
-    dnode::dnValueBridge *newValueBridge(int idx);
+    dnode::dnValueBridge *newValueBridge(dnPosType idx);
     dnode::dnValueBridge *newValueBridge(const char *name);
     dnode::dnValueBridge *newValueBridge(const dtpString &name);
     dnode::dnValueBridge *newValueBridge(dnPos pos);
@@ -3941,7 +4167,7 @@ public:
             return iterator(this, static_cast<size_type>(0));
         }
 
-       iterator at(int idx)
+       iterator at(dnPosType idx)
         {
             return iterator(this, idx);
         }
@@ -4001,7 +4227,7 @@ public:
             return const_iterator(const_cast<dnode *>(this), static_cast<size_type>(0));
         }
 
-        const_iterator at(int idx) const
+        const_iterator at(dnPosType idx) const
         {
             return const_iterator(const_cast<dnode *>(this), idx);
         }
@@ -4062,7 +4288,7 @@ public:
         }
 
         template<typename T>
-        scalar_iterator<T> scalarAt(int idx)
+        scalar_iterator<T> scalarAt(dnPosType idx)
         {
             return scalar_iterator<T>(*this, idx);
         }
@@ -4090,7 +4316,7 @@ public:
 
 
         template<typename T>
-        const_scalar_iterator<T> scalarAtR(int idx) const
+        const_scalar_iterator<T> scalarAtR(dnPosType idx) const
         {
             return const_scalar_iterator<T>(*this, idx);
         }
@@ -4360,7 +4586,7 @@ public:
     {
       using namespace Details;
 
-      int temp;
+      dnPosType temp;
       if (isArray())
       {
         const dnArray *arr = getArrayR();
@@ -4383,7 +4609,7 @@ public:
     template<typename LtCompareOp>
     bool binarySearchNode(const dnode &value, LtCompareOp compOp) const
     {
-      int temp;
+      dnPosType temp;
       if (isArray())
       {
         const dnArray *arr = getArrayR();
@@ -4488,7 +4714,7 @@ public:
     T avg (T init)
     {
       init = accumulate(init);
-      int cnt = size();
+      size_type cnt = size();
       if (cnt == 0)
         cnt = 1;
       return init / static_cast<T>(cnt);
@@ -5366,9 +5592,13 @@ namespace Details {
 // ----------------------------------------------------------------------------
 // dnChildColnBase
 // ----------------------------------------------------------------------------
-class dnChildColnBase: public dnChildColnBaseIntf {
+class dnChildColnBase: public dnChildColnBaseIntf
+#ifdef DATANODE_MEMORY_STATS
+  , public dnMemoryTracked
+#endif
+{
 public:
-  typedef uint size_type;
+  typedef dnSizeType size_type;
   dnChildColnBase();
   virtual ~dnChildColnBase() {};
   virtual void clear();
@@ -5376,26 +5606,33 @@ public:
   virtual void resize(size_type newSize) = 0;
   virtual bool empty() const = 0;
   virtual bool hasChild(const dtpString &name) const = 0;
-  virtual const dtpString getName(int index) const = 0;
-  virtual void setName(int index, const dtpString &name) = 0;
+  virtual const dtpString getName(dnPosType index) const = 0;
+  virtual void setName(dnPosType index, const dtpString &name) = 0;
   virtual size_type indexOfName(const dtpString &name) const = 0;
   virtual size_type indexOfValue(const dnode &value) const = 0;
   virtual dnode &getByName(const dtpString &name);
   virtual const dnode &getByNameR(const dtpString &name) const;
   virtual dnode *peekChild(const dtpString &name);
   virtual const dnode *peekChildR(const dtpString &name) const;
-  virtual dnode &at(int pos) = 0;
-  virtual const dnode &at(int pos) const = 0;
-  virtual void getChild(int index, dnode &output) = 0;
+  virtual dnode &at(dnPosType pos) = 0;
+  virtual const dnode &at(dnPosType pos) const = 0;
+  virtual void getChild(dnPosType index, dnode &output) = 0;
   virtual void erase(const dtpString &name) = 0;
-  virtual void erase(int index) = 0;
-  virtual void eraseFrom(int index) = 0;
+  virtual void erase(dnPosType index) = 0;
+  virtual void eraseFrom(dnPosType index) = 0;
+  /// removes count items starting at index
+  virtual void eraseRange(dnPosType index, dnPosType count) = 0;
   virtual bool isList() const {return false;}
-  virtual dnode *cloneChild(int index) const = 0;
-  virtual dnode *extractChild(int index) = 0;
+  virtual dnode *cloneChild(dnPosType index) const = 0;
+  virtual dnode *extractChild(dnPosType index) = 0;
 
   virtual void swap(size_type pos1, size_type pos2) = 0;
 
+  /// adds memory used by container to output, including child nodes if deep = true
+  virtual void calcMemoryUsage(dnMemoryUsage &output, bool deep) const;
+  virtual dtpString getMemoryStatName() const { return "dnChildColnBase"; }
+  virtual uint64 getMemoryStatItems() const { return size(); }
+
   // --- visit
   template<typename ValueType, typename Visitor, typename DerivedClass>
   void visitTreeValues(Visitor visitor) const
@@ -5527,13 +5764,13 @@ public:
   }
 
   template<typename ValueType, typename IntCompareOp>
-  bool binarySearchValue(const ValueType &value, IntCompareOp compOp, int &foundPos) const
+  bool binarySearchValue(const ValueType &value, IntCompareOp compOp, dnPosType &foundPos) const
   {
      return binary_search_by_pos(0, size(), value, VectorItemCompPosGetAs<ValueType, IntCompareOp>(*this, compOp), foundPos);
   }
 
   template<typename IntCompareOp>
-  bool binarySearchNode(const dnode &value, IntCompareOp compOp, int &foundPos) const
+  bool binarySearchNode(const dnode &value, IntCompareOp compOp, dnPosType &foundPos) const
   {
      return binary_search_by_pos(0, size(), value, VectorItemCompPosAt<IntCompareOp>(*this, compOp), foundPos);
   }
@@ -5571,10 +5808,11 @@ public:
   virtual void insert(size_type pos, const dtpString &name, dnode *node) = 0;
   virtual void insert(const dtpString &name, dnode *node) = 0;
 protected:
-  virtual void setAt(int pos, dnode *node) = 0;
+  virtual void setAt(dnPosType pos, dnode *node) = 0;
   virtual void copyFrom(const dnChildColnBase& src);
   virtual void clearItems() = 0;
   virtual dnode *createChild(const dnode &src) const {  return (new dnode(src)); }
+  void calcChildrenMemoryUsage(dnMemoryUsage &output) const;
 
   // comparator with internal container & at() / getAs<> access method
   template<typename ValueType, typename IntCompareOp>
@@ -5582,9 +5820,9 @@ protected:
     public:
      VectorItemCompPosGetAs(const dnChildColnBase &childColn, IntCompareOp compOp): m_childColn(childColn), m_compOp(compOp) {}
      // compares item at a given pos with provided value
-     int operator()(int pos, const ValueType &value)
+     int operator()(dnPosType pos, const ValueType &value)
      {
-       const dnode &nodeRef = const_cast<dnChildColnBase &>(m_childColn).at(pos);
+       const dnode &nodeRef = m_childColn.at(pos);
        ValueType valueAtPos = nodeRef.getAs<ValueType>();
        return m_compOp(valueAtPos, value);
      }
@@ -5599,9 +5837,9 @@ protected:
     public:
      VectorItemCompPosAt(const dnChildColnBase &childColn, IntCompareOp compOp): m_childColn(childColn), m_compOp(compOp) {}
      // compares item at a given pos with provided value
-     int operator()(int pos, const dnode &value)
+     int operator()(dnPosType pos, const dnode &value)
      {
-       const dnode &nodeRef = const_cast<dnChildColnBase &>(m_childColn).at(pos);
+       const dnode &nodeRef = m_childColn.at(pos);
        return m_compOp(nodeRef, value);
      }
     protected:
@@ -5635,21 +5873,25 @@ public:
   virtual void clearItems();
 
   virtual void erase(const dtpString &name);
-  virtual void erase(int index);
-  virtual void eraseFrom(int index);
+  virtual void erase(dnPosType index);
+  virtual void eraseFrom(dnPosType index);
+  virtual void eraseRange(dnPosType index, dnPosType count);
 
-  virtual dnode &at(int pos) { return m_items[pos]; }
-  virtual const dnode &at(int pos) const { return m_items[pos]; }
-  virtual void getChild(int index, dnode &output);
+  virtual dnode &at(dnPosType pos) { return m_items[pos]; }
+  virtual const dnode &at(dnPosType pos) const { return m_items[pos]; }
+  virtual void getChild(dnPosType index, dnode &output);
   virtual size_type indexOfName(const dtpString &name) const;
   virtual size_type indexOfValue(const dnode &value) const;
   virtual bool hasChild(const dtpString &name) const;
-  virtual const dtpString getName(int index) const;
-  virtual void setName(int index, const dtpString &name);
+  virtual const dtpString getName(dnPosType index) const;
+  virtual void setName(dnPosType index, const dtpString &name);
 
   virtual bool isList() const {return true;}
   virtual bool supportsAccessByName() const { return false; }
 
+  virtual void calcMemoryUsage(dnMemoryUsage &output, bool deep) const;
+  virtual dtpString getMemoryStatName() const { return "dnChildColnList"; }
+
   vector_type &getItems() { return m_items; }
   const vector_type &getItems() const { return m_items; }
 
@@ -5708,13 +5950,106 @@ protected:
   virtual void insert(size_type pos, dnode *node);
   virtual void insert(size_type pos, const dtpString &name, dnode *node);
   virtual void insert(const dtpString &name, dnode *node);
-  virtual void setAt(int pos, dnode *node);
-  virtual dnode *extractChild(int index);
-  virtual dnode *cloneChild(int index) const;
+  virtual void setAt(dnPosType pos, dnode *node);
+  virtual dnode *extractChild(dnPosType index);
+  virtual dnode *cloneChild(dnPosType index) const;
 protected:
   dnodeColn m_items;
 };
 
+// ----------------------------------------------------------------------------
+// dnChildColnDeque
+// ----------------------------------------------------------------------------
+/// Unnamed child list stored in a deque of pointers.
+/// Insert & erase at both ends are O(1), in the middle - O(min(pos, size - pos)),
+/// random access is O(1) but slower than in dnChildColnList.
+/// Used for work queues & sliding windows, see dnode::setAsDeque().
+class dnChildColnDeque: public dnChildColnBase {
+public:
+  typedef dnodeDequeColn vector_type;
+
+  dnChildColnDeque(): dnChildColnBase() {}
+  virtual ~dnChildColnDeque() {}
+
+  virtual size_type size() const { return static_cast<size_type>(m_items.size()); }
+  virtual void resize(size_type newSize);
+  virtual bool empty() const { return m_items.empty(); }
+  virtual void clearItems() { m_items.clear(); }
+
+  virtual void erase(const dtpString &name) {}
+  virtual void erase(dnPosType index);
+  virtual void eraseFrom(dnPosType index);
+  virtual void eraseRange(dnPosType index, dnPosType count);
+
+  virtual dnode &at(dnPosType pos) { return m_items[pos]; }
+  virtual const dnode &at(dnPosType pos) const { return m_items[pos]; }
+  virtual void getChild(dnPosType index, dnode &output) { output = m_items[index]; }
+  virtual size_type indexOfName(const dtpString &name) const { return dnode::npos; }
+  virtual size_type indexOfValue(const dnode &value) const;
+  virtual bool hasChild(const dtpString &name) const { return false; }
+  virtual const dtpString getName(dnPosType index) const { return dtpString(""); }
+  virtual void setName(dnPosType index, const dtpString &name) {}
+
+  virtual bool isList() const { return true; }
+  virtual bool isDeque() const { return true; }
+  virtual bool supportsAccessByName() const { return false; }
+
+  virtual void calcMemoryUsage(dnMemoryUsage &output, bool deep) const;
+  virtual dtpString getMemoryStatName() const { return "dnChildColnDeque"; }
+
+  vector_type &getItems() { return m_items; }
+  const vector_type &getItems() const { return m_items; }
+
+  /// swaps item pointers, nodes are not copied
+  virtual void swap(size_type pos1, size_type pos2);
+
+  template<typename ValueType, typename Visitor>
+  void visitTreeValues(Visitor visitor) const
+  {
+     typedef typename vector_type::const_iterator vector_iterator;
+     for(vector_iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+       (*it).visitTreeValues<ValueType>(visitor);
+  }
+
+  template<typename ValueType, typename Visitor>
+  void visitTreeNodes(Visitor visitor) const
+  {
+     typedef typename vector_type::const_iterator vector_iterator;
+     for(vector_iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+       (*it).visitTreeNodes<ValueType>(visitor);
+  }
+
+  template<typename ValueType, typename Visitor>
+  Visitor visitVectorValues(Visitor visitor) const
+  {
+     typedef typename vector_type::const_iterator vector_iterator;
+     for(vector_iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+       visitor((*it).template getAs<ValueType>());
+
+     return (visitor);
+  }
+
+  template<typename ValueType, typename Visitor>
+  void visitVectorNodes(Visitor visitor) const
+  {
+     typedef typename vector_type::const_iterator vector_iterator;
+     for(vector_iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+       visitor(*it);
+  }
+
+protected:
+  virtual void copyItemsFrom(const dnChildColnBase& src);
+  virtual void insert(dnode *node) { m_items.push_back(node); }
+  virtual void insert(size_type pos, dnode *node);
+  virtual void insert(size_type pos, const dtpString &name, dnode *node) { insert(pos, node); }
+  virtual void insert(const dtpString &name, dnode *node) { m_items.push_back(node); }
+  virtual void setAt(dnPosType pos, dnode *node) { m_items.replace(pos, node); }
+  virtual dnode *extractChild(dnPosType index);
+  virtual dnode *cloneChild(dnPosType index) const { return createChild(m_items[index]); }
+private:
+  vector_type m_items;
+};
+
 class dnChildColnDblMap: public dnChildColnBase {
 public:
   typedef dnChildColnIndexMap vector_type;
@@ -5727,10 +6062,11 @@ public:
   virtual void clearItems();
 
   virtual void erase(const dtpString &name);
-  virtual void erase(int index);
-  virtual void eraseFrom(int index);
+  virtual void erase(dnPosType index);
+  virtual void eraseFrom(dnPosType index);
+  virtual void eraseRange(dnPosType index, dnPosType count);
 
-  virtual dnode &at(int pos) { 
+  virtual dnode &at(dnPosType pos) { 
 #ifdef DATANODE_CHILD_INDEX_VECTOR_STD
     return *m_map2[pos]; 
 #else
@@ -5738,7 +6074,7 @@ public:
 #endif
   }
 
-  virtual const dnode &at(int pos) const
+  virtual const dnode &at(dnPosType pos) const
   {
 #ifdef DATANODE_CHILD_INDEX_VECTOR_STD
     return *m_map2[pos]; 
@@ -5747,7 +6083,7 @@ public:
 #endif
   }
 
-  virtual void getChild(int index, dnode &output);
+  virtual void getChild(dnPosType index, dnode &output);
   virtual size_type indexOfName(const dtpString &name) const;
   virtual size_type indexOfValue(const dnode &value) const;
   virtual dnode &getByName(const dtpString &name);
@@ -5755,13 +6091,16 @@ public:
   virtual dnode *peekChild(const dtpString &name);
   virtual const dnode *peekChildR(const dtpString &name) const;
   virtual bool hasChild(const dtpString &name) const;
-  virtual const dtpString getName(int index) const;
-  virtual void setName(int index, const dtpString &name);
+  virtual const dtpString getName(dnPosType index) const;
+  virtual void setName(dnPosType index, const dtpString &name);
   void swap(dnChildColnDblMap &rhs);
   vector_type &getItems() { return m_map2; }
   const vector_type &getItems() const { return m_map2; }
   virtual bool supportsAccessByName() const { return true; }
 
+  virtual void calcMemoryUsage(dnMemoryUsage &output, bool deep) const;
+  virtual dtpString getMemoryStatName() const { return "dnChildColnDblMap"; }
+
   void swap(size_type pos1, size_type pos2)
   {
     if (pos1 == pos2)
@@ -5836,11 +6175,11 @@ protected:
   virtual void insert(size_type pos, dnode *node);
   virtual void insert(size_type pos, const dtpString &name, dnode *node);
   virtual void insert(const dtpString &name, dnode *node);
-  virtual void setAt(int pos, dnode *node);
-  virtual dnode *extractChild(int index);
+  virtual void setAt(dnPosType pos, dnode *node);
+  virtual dnode *extractChild(dnPosType index);
   //inline void rebuildMap();
-  virtual dnode *cloneChild(int index) const;
-  void eraseItem(int index);
+  virtual dnode *cloneChild(dnPosType index) const;
+  void eraseItem(dnPosType index);
   dnChildColnDblMap *newEmpty();
 private:
   dnChildColnNameMap m_map1; /// name -> node
@@ -5848,6 +6187,277 @@ private:
   dnChildColnNameVector m_names; // name
 };
 
+// ----------------------------------------------------------------------------
+// dnFrozenNamePool
+// ----------------------------------------------------------------------------
+/// Interned child names of a frozen tree, shared by all its containers.
+/// Names are added only during dnode::freeze(), later the pool is read-only.
+class dnFrozenNamePool {
+public:
+  dnFrozenNamePool() {}
+  /// Returns offset of name in pool, name is added if not found
+  uint intern(const char *name, size_t length);
+  /// Releases memory used only during freeze
+  void finish();
+  const char *data() const { return m_text.empty() ? "" : &m_text[0]; }
+  size_t size() const { return m_text.size(); }
+private:
+  typedef std::multimap<uint64, std::pair<uint, uint> > dnFrozenNameIndex;
+  std::vector<char> m_text;
+  dnFrozenNameIndex m_index; /// hash -> (offset, length)
+};
+
+typedef boost::shared_ptr<dnFrozenNamePool> dnFrozenNamePoolPtr;
+
+// ----------------------------------------------------------------------------
+// dnChildColnFrozen
+// ----------------------------------------------------------------------------
+/// Immutable child container created by dnode::freeze().
+/// Children are stored in one block, names are interned in dnFrozenNamePool
+/// and found using minimal perfect hash (hash & displace), built per container.
+/// All modifying methods - including non-const access to children - throw dnError,
+/// const methods do not change any state, so concurrent reads need no locking.
+class dnChildColnFrozen: public dnChildColnBase {
+public:
+  typedef std::vector<dnode> vector_type;
+
+  /// Takes children from source (source items are left as null nodes)
+  dnChildColnFrozen(dnChildColnBase &source, const dnFrozenNamePoolPtr &namePool);
+  virtual ~dnChildColnFrozen() {}
+
+  virtual size_type size() const { return m_items.size(); }
+  virtual void resize(size_type newSize);
+  virtual bool empty() const { return m_items.empty(); }
+  virtual void clearItems();
+
+  virtual void erase(const dtpString &name);
+  virtual void erase(dnPosType index);
+  virtual void eraseFrom(dnPosType index);
+  virtual void eraseRange(dnPosType index, dnPosType count);
+
+  virtual dnode &at(dnPosType pos);
+  virtual const dnode &at(dnPosType pos) const { return m_items[pos]; }
+  virtual void getChild(dnPosType index, dnode &output);
+  virtual size_type indexOfName(const dtpString &name) const;
+  virtual size_type indexOfValue(const dnode &value) const;
+  virtual bool hasChild(const dtpString &name) const;
+  virtual const dtpString getName(dnPosType index) const;
+  virtual void setName(dnPosType index, const dtpString &name);
+
+  virtual bool isList() const { return m_isList; }
+  virtual bool isFrozen() const { return true; }
+  virtual bool supportsAccessByName() const { return !m_isList; }
+
+  virtual void calcMemoryUsage(dnMemoryUsage &output, bool deep) const;
+  virtual dtpString getMemoryStatName() const { return "dnChildColnFrozen"; }
+
+  /// Direct access to items, for internal algorithms (must not modify them)
+  vector_type &getItems() { return m_items; }
+  const vector_type &getItems() const { return m_items; }
+
+  virtual void swap(size_type pos1, size_type pos2);
+
+  template<typename ValueType, typename Visitor>
+  void visitTreeValues(Visitor visitor) const
+  {
+     typedef typename vector_type::const_iterator vector_iterator;
+     for(vector_iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+       (*it).visitTreeValues<ValueType>(visitor);
+  }
+
+  template<typename ValueType, typename Visitor>
+  void visitTreeNodes(Visitor visitor) const
+  {
+     typedef typename vector_type::const_iterator vector_iterator;
+     for(vector_iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+       (*it).visitTreeNodes<ValueType>(visitor);
+  }
+
+  template<typename ValueType, typename Visitor>
+  Visitor visitVectorValues(Visitor visitor) const
+  {
+     typedef typename vector_type::const_iterator vector_iterator;
+     for(vector_iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+       visitor((*it).template getAs<ValueType>());
+
+     return (visitor);
+  }
+
+  template<typename ValueType, typename Visitor>
+  void visitVectorNodes(Visitor visitor) const
+  {
+     typedef typename vector_type::const_iterator vector_iterator;
+     for(vector_iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+       visitor(*it);
+  }
+
+  static void throwFrozen();
+protected:
+  virtual void copyItemsFrom(const dnChildColnBase& src);
+  virtual void insert(dnode *node);
+  virtual void insert(size_type pos, dnode *node);
+  virtual void insert(size_type pos, const dtpString &name, dnode *node);
+  virtual void insert(const dtpString &name, dnode *node);
+  virtual void setAt(dnPosType pos, dnode *node);
+  virtual dnode *extractChild(dnPosType index);
+  virtual dnode *cloneChild(dnPosType index) const;
+
+  void buildIndex(const std::vector<uint64> &hashes);
+  bool tryBuildIndex(const std::vector<uint64> &hashes, const std::vector<uint> &keys, uint64 seed);
+  size_type findSlot(uint64 hash) const;
+  bool nameEquals(size_type index, const char *name, size_t length) const;
+private:
+  /// Interned name: offset & length in name pool
+  struct dnFrozenName {
+    uint offset;
+    uint length;
+  };
+
+  vector_type m_items;
+  std::vector<dnFrozenName> m_names;
+  std::vector<uint> m_displacements; /// bucket -> displacement or direct slot
+  std::vector<uint> m_slots;         /// slot -> child index, empty = linear search
+  uint64 m_seed;
+  dnFrozenNamePoolPtr m_namePool;
+  bool m_isList;
+};
+
+// ----------------------------------------------------------------------------
+// dnCompactBlock
+// ----------------------------------------------------------------------------
+/// Storage of nodes relocated by dnode::compact(), shared by all containers of compacted tree.
+/// Nodes are constructed in place & destroyed by container owning them,
+/// memory is released when the last container is gone.
+class dnCompactBlock {
+public:
+  explicit dnCompactBlock(size_t capacity);
+  ~dnCompactBlock();
+  /// Returns count of consecutive, not constructed slots
+  dnode *allocate(size_t count);
+  bool contains(const dnode *node) const { return (node >= m_begin) && (node < m_end); }
+  size_t capacity() const { return static_cast<size_t>(m_end - m_begin); }
+  size_t used() const { return static_cast<size_t>(m_next - m_begin); }
+private:
+  dnCompactBlock(const dnCompactBlock &);
+  dnCompactBlock &operator=(const dnCompactBlock &);
+
+  dnode *m_begin;
+  dnode *m_next;
+  dnode *m_end;
+};
+
+typedef boost::shared_ptr<dnCompactBlock> dnCompactBlockPtr;
+
+// ----------------------------------------------------------------------------
+// dnChildColnCompact
+// ----------------------------------------------------------------------------
+/// Child container created by dnode::compact().
+/// Children are stored in dnCompactBlock next to each other, names are kept in
+/// a vector with index sorted by name (binary search, first of duplicated names is found).
+/// Container can be modified, new children are allocated on heap. Removed
+/// children from block are only destroyed, their slots are not reused.
+class dnChildColnCompact: public dnChildColnBase {
+public:
+  /// non-owning, ownership is handled by container (block or heap)
+  typedef boost::ptr_vector<dnode, boost::view_clone_allocator> vector_type;
+  typedef std::vector<size_type> name_index_vector;
+
+  /// Moves children of source to consecutive slots of block (source items are left as null nodes)
+  dnChildColnCompact(dnChildColnBase &source, const dnCompactBlockPtr &block);
+  virtual ~dnChildColnCompact();
+
+  virtual size_type size() const { return static_cast<size_type>(m_items.size()); }
+  virtual void resize(size_type newSize);
+  virtual bool empty() const { return m_items.empty(); }
+  virtual void clearItems();
+
+  virtual void erase(const dtpString &name);
+  virtual void erase(dnPosType index);
+  virtual void eraseFrom(dnPosType index);
+  virtual void eraseRange(dnPosType index, dnPosType count);
+
+  virtual dnode &at(dnPosType pos) { return m_items[pos]; }
+  virtual const dnode &at(dnPosType pos) const { return m_items[pos]; }
+  virtual void getChild(dnPosType index, dnode &output) { output = m_items[index]; }
+  virtual size_type indexOfName(const dtpString &name) const;
+  virtual size_type indexOfValue(const dnode &value) const;
+  virtual bool hasChild(const dtpString &name) const { return indexOfName(name) != dnode::npos; }
+  virtual const dtpString getName(dnPosType index) const;
+  virtual void setName(dnPosType index, const dtpString &name);
+
+  virtual bool isList() const { return m_isList; }
+  virtual bool isCompact() const { return true; }
+  virtual bool supportsAccessByName() const { return !m_isList; }
+
+  virtual void calcMemoryUsage(dnMemoryUsage &output, bool deep) const;
+  virtual dtpString getMemoryStatName() const { return "dnChildColnCompact"; }
+
+  vector_type &getItems() { return m_items; }
+  const vector_type &getItems() const { return m_items; }
+
+  /// Returns number of children stored outside of block
+  size_type getSpillCount() const;
+
+  /// swaps item pointers (and names), nodes are not copied
+  virtual void swap(size_type pos1, size_type pos2);
+
+  template<typename ValueType, typename Visitor>
+  void visitTreeValues(Visitor visitor) const
+  {
+     typedef typename vector_type::const_iterator vector_iterator;
+     for(vector_iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+       (*it).visitTreeValues<ValueType>(visitor);
+  }
+
+  template<typename ValueType, typename Visitor>
+  void visitTreeNodes(Visitor visitor) const
+  {
+     typedef typename vector_type::const_iterator vector_iterator;
+     for(vector_iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+       (*it).visitTreeNodes<ValueType>(visitor);
+  }
+
+  template<typename ValueType, typename Visitor>
+  Visitor visitVectorValues(Visitor visitor) const
+  {
+     typedef typename vector_type::const_iterator vector_iterator;
+     for(vector_iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+       visitor((*it).template getAs<ValueType>());
+
+     return (visitor);
+  }
+
+  template<typename ValueType, typename Visitor>
+  void visitVectorNodes(Visitor visitor) const
+  {
+     typedef typename vector_type::const_iterator vector_iterator;
+     for(vector_iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+       visitor(*it);
+  }
+
+protected:
+  virtual void copyItemsFrom(const dnChildColnBase& src);
+  virtual void insert(dnode *node);
+  virtual void insert(size_type pos, dnode *node);
+  virtual void insert(size_type pos, const dtpString &name, dnode *node);
+  virtual void insert(const dtpString &name, dnode *node);
+  virtual void setAt(dnPosType pos, dnode *node);
+  virtual dnode *extractChild(dnPosType index);
+  virtual dnode *cloneChild(dnPosType index) const { return createChild(m_items[index]); }
+
+  /// destroys node in block or deletes node from heap
+  void releaseNode(dnode *node);
+  void indexName(size_type index);
+  void unindexName(size_type index);
+  void shiftNameIndex(size_type from, dnPosType delta);
+private:
+  vector_type m_items;
+  std::vector<dtpString> m_names;  /// empty for list
+  name_index_vector m_nameIndex;   /// child indices ordered by (name, index)
+  dnCompactBlockPtr m_block;
+  bool m_isList;
+};
+
 // ----------------------------------------------------------------------------
 // dnChildColnImplMeta
 // ----------------------------------------------------------------------------
@@ -5873,7 +6483,7 @@ typedef dnChildColnBase dnChildColn;
 
 class ParentVisitorCommon {
 public:
-  typedef uint size_type;
+  typedef dnSizeType size_type;
 
   template<typename ValueType, typename CompOp, typename DerivedClass>
   static
@@ -5947,7 +6557,7 @@ protected:
 
      SortToolForVector(VectorType &vect, CompareOp compOp): m_vect(vect), m_compareOp(compOp) {}
 
-     ValueType get(int pos)
+     ValueType get(dnPosType pos)
      {
        dnode &nodeRef = m_vect[pos];
        return nodeRef.getAs<ValueType>();
@@ -5969,7 +6579,7 @@ protected:
      }
 
     protected:
-     void set(int pos, ValueType newValue)
+     void set(dnPosType pos, ValueType newValue)
      {
        dnode &nodeRef = m_vect[pos];
        nodeRef.setAs<ValueType>(newValue);
@@ -5987,7 +6597,7 @@ template<typename ValueType, typename ChildColn, typename CompareOp>
 
      SortToolForValueAs(ChildColn &childColn, CompareOp compOp): m_childColn(childColn), m_compareOp(compOp) {}
 
-     ValueType get(int pos)
+     ValueType get(dnPosType pos)
      {
        dnode &nodeRef = m_childColn.at(pos);
        return nodeRef.getAs<ValueType>();
@@ -6004,7 +6614,7 @@ template<typename ValueType, typename ChildColn, typename CompareOp>
      }
 
     protected:
-     void set(int pos, ValueType newValue)
+     void set(dnPosType pos, ValueType newValue)
      {
        dnode &nodeRef = m_childColn.at(pos);
        nodeRef.setAs<ValueType>(newValue);
@@ -6020,7 +6630,7 @@ template<typename ValueType, typename ChildColn, typename CompareOp>
     public:
      SortToolForNodeRef(ChildColn &childColn, CompareOp compOp): m_childColn(childColn), m_compareOp(compOp) {}
 
-     dnode &get(int pos)
+     dnode &get(dnPosType pos)
      {
        return m_childColn.at(pos);
      }
@@ -6036,7 +6646,7 @@ template<typename ValueType, typename ChildColn, typename CompareOp>
      }
 
     protected:
-     void set(int pos, const dnode &newValue)
+     void set(dnPosType pos, const dnode &newValue)
      {
        dnode &nodeRef = m_childColn.at(pos);
        //nodeRef.setValue(newValue);
@@ -6054,7 +6664,7 @@ template <>
 class ParentVisitor<ict_parent> {
 public:
     typedef dnChildColnDblMap implementation_type;
-    typedef uint size_type;
+    typedef dnSizeType size_type;
 
     template<typename ValueType, typename Visitor>
     static
@@ -6145,11 +6755,12 @@ public:
 
 };
 
-template <>
-class ParentVisitor<ict_list> {
+/// Visitor for unnamed lists, ImplClass provides vector_type & getItems()
+template <class ImplClass>
+class ParentVisitorListOf {
 public:
-    typedef dnChildColnList implementation_type;
-    typedef uint size_type;
+    typedef ImplClass implementation_type;
+    typedef dnSizeType size_type;
 
     template<typename ValueType, typename Visitor>
     static
@@ -6202,7 +6813,7 @@ public:
     static
     size_type find_if_derived(const dnChildColnBaseIntf *parent, ValueType value, CompOp compOp)
     {
-      return ParentVisitorCommon::find_if_derived<ValueType, CompOp, dnChildColnImplMeta<ict_list>::implementation_type>(parent, value, compOp);
+      return ParentVisitorCommon::find_if_derived<ValueType, CompOp, implementation_type>(parent, value, compOp);
     }
 
     template<typename ValueType>
@@ -6230,16 +6841,104 @@ public:
     }
 };
 
+template <>
+class ParentVisitor<ict_list>: public ParentVisitorListOf<dnChildColnList> {
+};
+
+typedef ParentVisitorListOf<dnChildColnDeque> ParentVisitorDeque;
+typedef ParentVisitorListOf<dnChildColnCompact> ParentVisitorCompact;
+
+/// Visitor for dnChildColnFrozen, sorting is not allowed
+class ParentVisitorFrozen {
+public:
+    typedef dnChildColnFrozen implementation_type;
+    typedef dnSizeType size_type;
+
+    template<typename ValueType, typename Visitor>
+    static
+    void visitTreeValues(const dnChildColnBaseIntf *parent, Visitor visitor)
+    {
+        static_cast<const implementation_type *>(parent)->visitTreeValues<ValueType, Visitor>(visitor);
+    }
+
+    template<typename ValueType, typename Visitor>
+    static
+    void visitTreeNodes(const dnChildColnBaseIntf *parent, Visitor visitor)
+    {
+        static_cast<const implementation_type *>(parent)->visitTreeNodes<ValueType, Visitor>(visitor);
+    }
+
+    template<typename ValueType, typename Visitor>
+    static
+    Visitor visitVectorValues(const dnChildColnBaseIntf *parent, Visitor visitor)
+    {
+        return static_cast<const implementation_type *>(parent)->visitVectorValues<ValueType, Visitor>(visitor);
+    }
+
+    template<typename ValueType, typename Visitor>
+    static
+    void visitVectorNodes(const dnChildColnBaseIntf *parent, Visitor visitor)
+    {
+        static_cast<const implementation_type *>(parent)->visitVectorNodes<ValueType, Visitor>(visitor);
+    }
+
+    template<typename ValueType, typename CompareOp>
+    static
+    void sortValues(const dnChildColnBaseIntf *parent, CompareOp compOp)
+    {
+        implementation_type::throwFrozen();
+    }
+
+    template<typename CompareOp>
+    static
+    void sortNodes(const dnChildColnBaseIntf *parent, CompareOp compOp)
+    {
+        implementation_type::throwFrozen();
+    }
+
+    template<typename ValueType, typename CompOp>
+    static
+    size_type find_if_derived(const dnChildColnBaseIntf *parent, ValueType value, CompOp compOp)
+    {
+      return ParentVisitorCommon::find_if_derived<ValueType, CompOp, implementation_type>(parent, value, compOp);
+    }
+
+    template<typename ValueType>
+    static
+    size_type find_derived(dnChildColnBaseIntf *parent, ValueType value)
+    {
+       const implementation_type::vector_type &vector = static_cast<const implementation_type *>(parent)->getItems();
+       size_type res = vector.size();
+
+       for(size_type i = 0, epos = res; i != epos; i++)
+       {
+         if (vector[i].template getAs<ValueType>() == value)
+         {
+           res = i;
+           break;
+         }
+       }
+
+       return res;
+    }
+};
+
 template <>
 class ParentVisitorGeneric<parent_visitor_impl_tag> {
 public:
-    typedef uint size_type;
+    typedef dnSizeType size_type;
 
     template<typename ValueType, typename Visitor>
     static
     void visitTreeValues(const dnChildColnBaseIntf *parent, Visitor visitor)
     {
-        if (parent->isList())
+        if (parent->isFrozen())
+          ParentVisitorFrozen::visitTreeValues<ValueType, Visitor>(parent, visitor);
+        else if (parent->isDeque())
+          ParentVisitorDeque::visitTreeValues<ValueType, Visitor>(parent, visitor);
+        else if (parent->isCompact())
+          ParentVisitorCompact::visitTreeValues<ValueType, Visitor>(parent, visitor);
+        else if (parent->isList())
           ParentVisitor<ict_list>::visitTreeValues<ValueType, Visitor>(parent, visitor);
         else
           ParentVisitor<ict_parent>::visitTreeValues<ValueType, Visitor>(parent, visitor);
@@ -6247,7 +6946,7 @@ public:
 
     template<typename IntCompareOp>
     static
-    bool binarySearchNode(const dnChildColnBaseIntf *parent, const dnode &value, IntCompareOp compOp, int &foundPos)
+    bool binarySearchNode(const dnChildColnBaseIntf *parent, const dnode &value, IntCompareOp compOp, dnPosType &foundPos)
     {
         dnChildColnBase *children = static_cast<dnChildColnBase *>(const_cast<dnChildColnBaseIntf *>(parent));
         return children->binarySearchNode(value, compOp, foundPos);
@@ -6255,7 +6954,7 @@ public:
 
     template<typename ValueType, typename IntCompareOp>
     static
-    bool binarySearchValue(const dnChildColnBaseIntf *parent, const ValueType &value, IntCompareOp compOp, int &foundPos)
+    bool binarySearchValue(const dnChildColnBaseIntf *parent, const ValueType &value, IntCompareOp compOp, dnPosType &foundPos)
     {
         dnChildColnBase *parentBase = static_cast<dnChildColnBase *>(const_cast<dnChildColnBaseIntf *>(parent));
         return parentBase->binarySearchValue<ValueType, IntCompareOp>(value, compOp, foundPos);
@@ -6265,7 +6964,13 @@ public:
     static
     void visitTreeNodes(const dnChildColnBaseIntf *parent, Visitor visitor)
     {
-        if (parent->isList())
+        if (parent->isFrozen())
+          ParentVisitorFrozen::visitTreeValues<ValueType, Visitor>(parent, visitor);
+        else if (parent->isDeque())
+          ParentVisitorDeque::visitTreeValues<ValueType, Visitor>(parent, visitor);
+        else if (parent->isCompact())
+          ParentVisitorCompact::visitTreeValues<ValueType, Visitor>(parent, visitor);
+        else if (parent->isList())
           ParentVisitor<ict_list>::visitTreeValues<ValueType, Visitor>(parent, visitor);
         else
           ParentVisitor<ict_parent>::visitTreeValues<ValueType, Visitor>(parent, visitor);
@@ -6276,7 +6981,13 @@ public:
     Visitor visitVectorValues(const dnChildColnBaseIntf *parent, Visitor visitor)
     {
         //static_cast<dnChildColnBase *>(parent)->visitVectorValues<ValueType, Visitor, implementation_type>(visitor);
-        if (parent->isList())
+        if (parent->isFrozen())
+          return ParentVisitorFrozen::visitVectorValues<ValueType, Visitor>(parent, visitor);
+        else if (parent->isDeque())
+          return ParentVisitorDeque::visitVectorValues<ValueType, Visitor>(parent, visitor);
+        else if (parent->isCompact())
+          return ParentVisitorCompact::visitVectorValues<ValueType, Visitor>(parent, visitor);
+        else if (parent->isList())
           return ParentVisitor<ict_list>::visitVectorValues<ValueType, Visitor>(parent, visitor);
         else
           return ParentVisitor<ict_parent>::visitVectorValues<ValueType, Visitor>(parent, visitor);
@@ -6287,7 +6998,13 @@ public:
     void visitVectorNodes(const dnChildColnBaseIntf *parent, Visitor visitor)
     {
         //static_cast<dnChildColnBase *>(parent)->visitVectorNodes<ValueType, Visitor, implementation_type>(visitor);
-        if (parent->isList())
+        if (parent->isFrozen())
+          ParentVisitorFrozen::visitVectorNodes<ValueType, Visitor>(parent, visitor);
+        else if (parent->isDeque())
+          ParentVisitorDeque::visitVectorNodes<ValueType, Visitor>(parent, visitor);
+        else if (parent->isCompact())
+          ParentVisitorCompact::visitVectorNodes<ValueType, Visitor>(parent, visitor);
+        else if (parent->isList())
           ParentVisitor<ict_list>::visitVectorNodes<ValueType, Visitor>(parent, visitor);
         else
           ParentVisitor<ict_parent>::visitVectorNodes<ValueType, Visitor>(parent, visitor);
@@ -6298,7 +7015,13 @@ public:
     void sortNodes(const dnChildColnBaseIntf *parent, CompareOp compOp)
     {
         //ParentVisitorCommon::sortNodesWithNodeRef<CompareOp, implementation_type>(parent, compOp);
-        if (parent->isList())
+        if (parent->isFrozen())
+          ParentVisitorFrozen::sortNodes<CompareOp>(parent, compOp);
+        else if (parent->isDeque())
+          ParentVisitorDeque::sortNodes<CompareOp>(parent, compOp);
+        else if (parent->isCompact())
+          ParentVisitorCompact::sortNodes<CompareOp>(parent, compOp);
+        else if (parent->isList())
           ParentVisitor<ict_list>::sortNodes<CompareOp>(parent, compOp);
         else
           ParentVisitor<ict_parent>::sortNodes<CompareOp>(parent, compOp);
@@ -6308,7 +7031,13 @@ public:
     static
     void sortValues(const dnChildColnBaseIntf *parent, CompareOp compOp)
     {
-        if (parent->isList())
+        if (parent->isFrozen())
+          ParentVisitorFrozen::sortValues<ValueType, CompareOp>(parent, compOp);
+        else if (parent->isDeque())
+          ParentVisitorDeque::sortValues<ValueType, CompareOp>(parent, compOp);
+        else if (parent->isCompact())
+          ParentVisitorCompact::sortValues<ValueType, CompareOp>(parent, compOp);
+        else if (parent->isList())
           ParentVisitor<ict_list>::sortValues<ValueType, CompareOp>(parent, compOp);
         else
           ParentVisitor<ict_parent>::sortValues<ValueType, CompareOp>(parent, compOp);
@@ -6326,7 +7055,13 @@ public:
     static
     size_type find_if_derived(const dnChildColnBaseIntf *parent, ValueType value, CompOp compOp)
     {
-      if (parent->isList())
+      if (parent->isFrozen())
+        return ParentVisitorFrozen::find_if_derived<ValueType, CompOp>(parent, value, compOp);
+      else if (parent->isDeque())
+        return ParentVisitorDeque::find_if_derived<ValueType, CompOp>(parent, value, compOp);
+      else if (parent->isCompact())
+        return ParentVisitorCompact::find_if_derived<ValueType, CompOp>(parent, value, compOp);
+      else if (parent->isList())
         return ParentVisitorCommon::find_if_derived<ValueType, CompOp, dnChildColnImplMeta<ict_list>::implementation_type>(parent, value, compOp);
       else
         return ParentVisitorCommon::find_if_derived<ValueType, CompOp, dnChildColnImplMeta<ict_parent>::implementation_type>(parent, value, compOp);
@@ -6336,7 +7071,13 @@ public:
     static
     size_type find_derived(dnChildColnBaseIntf *parent, ValueType value)
     {
-      if (parent->isList())
+      if (parent->isFrozen())
+        return ParentVisitorFrozen::find_derived<ValueType>(parent, value);
+      else if (parent->isDeque())
+        return ParentVisitorDeque::find_derived<ValueType>(parent, value);
+      else if (parent->isCompact())
+        return ParentVisitorCompact::find_derived<ValueType>(parent, value);
+      else if (parent->isList())
         //return ParentVisitorCommon::find_derived<ValueType, dnChildColnImplMeta<ict_list>::implementation_type>(parent, value);
         return ParentVisitor<ict_list>::find_derived<ValueType>(parent, value); 
       else
@@ -75,7 +75,7 @@ struct dnArrayMetaItemIsNode: public dtpSelector<Value>
 // ----------------------------------------------------------------------------
 class dnArrayBase: public Details::dnArray {
 public:
-  typedef uint size_type;
+  typedef dnSizeType size_type;
   typedef dnArray inherited;
 
   dnArrayBase(dnValueType a_type):dnArray(a_type) {}
@@ -178,7 +178,7 @@ public:
   typedef typename vector_type::iterator self_iterator;
   typedef ValueType value_type;
   typedef dnArrayOfPod<ValueType> self_type;
-  typedef uint size_type;
+  typedef dnSizeType size_type;
 
   dnArrayOfPod(dnValueType a_type = vt_datanode): inherited(a_type) {}
   virtual ~dnArrayOfPod() {}
@@ -210,12 +210,12 @@ public:
     return new self_type(this->getValueType());
   }
 
-  void getItem(int index, dnode &output) const
+  void getItem(dnPosType index, dnode &output) const
   {
     output.setAs<ValueType>(m_items[index]);
   }
 
-  void setItem(int index, const dnode &input)
+  void setItem(dnPosType index, const dnode &input)
   {
     m_items[index] = input.getAs<ValueType>();
   }
@@ -241,18 +241,24 @@ public:
     m_items.push_back(inputGuard->getAs<ValueType>());
   }
 
-  void eraseItem(int index)
+  void eraseItem(dnPosType index)
   {
     self_iterator itRemove = m_items.begin() + index;
     m_items.erase(itRemove);
   }
 
-  void eraseFrom(int index)
+  void eraseFrom(dnPosType index)
   {
     self_iterator itRemove = m_items.begin() + index;
     m_items.erase(itRemove, m_items.end());
   }
 
+  void eraseRange(dnPosType index, dnPosType count)
+  {
+    self_iterator itRemove = m_items.begin() + index;
+    m_items.erase(itRemove, itRemove + count);
+  }
+
   dnArray::size_type indexOfValue(const dnode &input) const
   {
     size_type pos = std::find(m_items.begin(), m_items.end(), input.getAs<ValueType>()) - m_items.begin();
@@ -335,6 +341,17 @@ public:
     return value.getAs<T>();
   }
 
+  virtual void calcMemoryUsage(dnMemoryUsage &output, bool deep) const
+  {
+    output.arrays += sizeof(self_type) + m_items.capacity() * sizeof(value_type);
+  }
+
+  virtual void shrinkToFit()
+  {
+    if (m_items.capacity() > m_items.size())
+      vector_type(m_items).swap(m_items);
+  }
+
   virtual void swap(size_type pos1, size_type pos2) {
     if (pos1 == pos2)
       return;
@@ -384,12 +401,12 @@ public:
   virtual void copyFrom(const dnArray *a_source);
   virtual bool empty() const;
 
-  virtual void getItem(int index, dnode &output) const;
-  virtual void setItem(int index, const dnode &input);
-  virtual void setItemValue(int index, const dnode &input);
-  virtual const dnode &getNode(int index, dnode &helper) const;
-  virtual dnode *getNodePtr(int index, dnode &helper) const;
-  virtual void setNode(int index, const dnode &value);
+  virtual void getItem(dnPosType index, dnode &output) const;
+  virtual void setItem(dnPosType index, const dnode &input);
+  virtual void setItemValue(dnPosType index, const dnode &input);
+  virtual const dnode &getNode(dnPosType index, dnode &helper) const;
+  virtual dnode *getNodePtr(dnPosType index, dnode &helper) const;
+  virtual void setNode(dnPosType index, const dnode &value);
 
   virtual void addItem(base::move_ptr<dnode> input);
   virtual void addItem(const dnValue &input);
@@ -413,14 +430,19 @@ public:
   }
 
   virtual void eatItem(dnode &input);
-  virtual void eraseItem(int index);
-  virtual void eraseFrom(int index);
+  virtual void eraseItem(dnPosType index);
+  virtual void eraseFrom(dnPosType index);
+  virtual void eraseRange(dnPosType index, dnPosType count);
   virtual size_type indexOfValue(const dnode &input) const;
   virtual size_type findByName(const dtpString &name) const;
   virtual void clear();
   virtual size_type size() const;
   virtual void resize(size_type newSize);
   virtual dnode::dnValueBridge *newValueBridge();
+  virtual void calcMemoryUsage(dnMemoryUsage &output, bool deep) const;
+  virtual dtpString getMemoryStatName() const { return "dnArrayOfDataNode2"; }
+  /// shrinks vector of item pointers, items are not moved
+  virtual void shrinkToFit();
 
   template<typename T>
   T getFromNode(dtp::dnode::size_type pos) const
@@ -578,6 +600,24 @@ public:
   enum Options { item_type = vt_uint };
 };
 
+template <>
+class dnArrayByIntMeta<vt_int64> {
+public:
+  typedef int64 value_type;
+  typedef dnArrayOfPod<value_type> implementation_type;
+  typedef implementation_type::vector_type vector_type;
+  enum Options { item_type = vt_int64 };
+};
+
+template <>
+class dnArrayByIntMeta<vt_uint64> {
+public:
+  typedef uint64 value_type;
+  typedef dnArrayOfPod<value_type> implementation_type;
+  typedef implementation_type::vector_type vector_type;
+  enum Options { item_type = vt_uint64 };
+};
+
 // ----------------------------------------------------------------------------
 // dnArrayFactory
 // ----------------------------------------------------------------------------
@@ -859,7 +899,7 @@ public:
 
   template <typename ValueType, typename CompOp, class ArrayType>
   static
-  bool binarySearchValue(ArrayType *aArray, const ValueType &value, CompOp compOp, int &foundPos)
+  bool binarySearchValue(ArrayType *aArray, const ValueType &value, CompOp compOp, dnPosType &foundPos)
   {
      typedef dnArrayImplMeta<dnArrayMetaIsDefined<ValueType>::value, ValueType> array_impl_meta;
      bool directMode = (array_impl_meta::item_type == aArray->getValueType()) && (aArray->getValueType() != vt_datanode);
@@ -871,7 +911,7 @@ public:
 
   template<typename ValueType, typename IntCompareOp, class ArrayType>
   static
-  bool binarySearchValueDirect(ArrayType *aArray, const ValueType &value, IntCompareOp compOp, int &foundPos)
+  bool binarySearchValueDirect(ArrayType *aArray, const ValueType &value, IntCompareOp compOp, dnPosType &foundPos)
   {
      using namespace Details;
 
@@ -886,7 +926,7 @@ public:
 
   template<typename ValueType, typename IntCompareOp, class ArrayType>
   static
-  bool binarySearchValueByItem(ArrayType *aArray, const ValueType &value, IntCompareOp compOp, int &foundPos)
+  bool binarySearchValueByItem(ArrayType *aArray, const ValueType &value, IntCompareOp compOp, dnPosType &foundPos)
   {
      using namespace Details;
 
@@ -899,7 +939,7 @@ public:
 
   template<typename IntCompareOp, class ArrayType>
   static
-  bool binarySearchNode(ArrayType *aArray, const dnode &value, IntCompareOp compOp, int &foundPos)
+  bool binarySearchNode(ArrayType *aArray, const dnode &value, IntCompareOp compOp, dnPosType &foundPos)
   {
      using namespace Details;
      dnArray *implArray = const_cast<dnArray *>(checked_cast<const dnArray *>(aArray));
@@ -1275,7 +1315,7 @@ protected:
     public:
      VectorItemCompPosDirect(const VectorType &vector, IntCompareOp compOp): m_vector(vector), m_compOp(compOp) {}
      // compares item at a given pos with provided value
-     int operator()(int pos, const ValueType &value)
+     int operator()(dnPosType pos, const ValueType &value)
      {
        ValueType valueAtPos = m_vector[pos];
        return m_compOp(valueAtPos, value);
@@ -1291,7 +1331,7 @@ protected:
     public:
      VectorItemCompPosByItem(const ImplArray &arr, IntCompareOp compOp): m_array(arr), m_compOp(compOp) {}
      // compares item at a given pos with provided value
-     int operator()(int pos, const ValueType &value)
+     int operator()(dnPosType pos, const ValueType &value)
      {
        dnode helper;
        const dnode *nodePtr = m_array.getNodePtr(pos, helper);
@@ -1310,7 +1350,7 @@ protected:
     public:
      VectorItemCompPosByNode(const ImplArray &arr, IntCompareOp compOp): m_array(arr), m_compOp(compOp) {}
      // compares item at a given pos with provided value
-     int operator()(int pos, const dnode &value)
+     int operator()(dnPosType pos, const dnode &value)
      {
        dnode helper;
        const dnode *nodePtr = m_array.getNodePtr(pos, helper);
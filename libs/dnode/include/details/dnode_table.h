@@ -0,0 +1,215 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_table.h
+// Project:     dtpLib
+// Purpose:     Row-wise access to rows & columns tables
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNTABLE_H__
+#define _DTPDNTABLE_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_table.h
+\brief Row-wise access to rows & columns tables
+
+Shared by table algorithms (group_by, hash_join) and expressions.
+Table formats:
+- rows: list of parents, field path is child name or path "address/city"
+- columns: parent with named columns (arrays or lists) of equal size,
+  field path is column name
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include <vector>
+#include <algorithm>
+
+#include "dtp/dnode.h"
+
+namespace dtp {
+namespace Details {
+
+const char DNTABLE_PATH_SEPARATOR = '/';
+
+// ----------------------------------------------------------------------------
+// dnTableReader
+// ----------------------------------------------------------------------------
+/// Reads fields of rows or columns table
+class dnTableReader {
+public:
+  typedef dnode::size_type size_type;
+
+  dnTableReader(const dnode &table): m_table(table), m_columnar(false), m_rowCount(0) {
+    if (!table.isContainer())
+      throw dnError("Table must be a container");
+
+    if (table.supportsNames() && !table.empty()) {
+      dnode helper;
+      m_columnar = true;
+      m_rowCount = table.getNode(0, helper).size();
+      for(size_type i=0, epos = table.size(); i != epos; i++) {
+        const dnode &column = table.getNode(i, helper);
+        if (!column.isContainer())
+          throw dnError("Table column must be a container: " + toString(i));
+        if (column.size() != m_rowCount)
+          throw dnError("Table column size mismatch: " + toString(i));
+      }
+    } else {
+      m_rowCount = table.size();
+    }
+  }
+
+  const dnode &getTable() const { return m_table; }
+  bool isColumnar() const { return m_columnar; }
+  size_type rowCount() const { return m_rowCount; }
+  /// Returns column of field in columns table, NULL for rows table
+  const dnode *getColumn(uint field) const { return m_columnar ? m_columns[field] : DTP_NULL; }
+
+  /// Registers field path and returns its number
+  uint addField(const dtpString &path) {
+    std::vector<dtpString> items;
+    splitPath(path, items);
+
+    if (m_columnar) {
+      size_type idx = m_table.indexOfName(path);
+      if (idx == dnode::npos)
+        throw dnError("Column not found: " + path);
+      // columns are children of parent, returned by reference
+      dnode helper;
+      m_columns.push_back(&(m_table.getNode(idx, helper)));
+    }
+
+    m_paths.push_back(items);
+    return static_cast<uint>(m_paths.size() - 1);
+  }
+
+  /// Returns value of field in a given row or NULL if row has no such field,
+  /// helper is used for array items
+  const dnode *getValue(size_type row, uint field, dnode &helper) const {
+    if (m_columnar)
+      return &(m_columns[field]->getNode(row, helper));
+    return findField(m_table.getNode(row, helper), m_paths[field]);
+  }
+
+  /// Returns child of row at path or NULL if not found
+  static const dnode *findField(const dnode &row, const std::vector<dtpString> &path) {
+    const dnode *current = &row;
+    dnode helper;
+    size_type idx;
+
+    for(std::vector<dtpString>::const_iterator it = path.begin(), epos = path.end(); it != epos; ++it) {
+      if (!current->isParent())
+        return DTP_NULL;
+      idx = current->indexOfName(*it);
+      if (idx == dnode::npos)
+        return DTP_NULL;
+      // children of parent are returned by reference, helper is not used
+      current = &(current->getNode(idx, helper));
+    }
+
+    return current;
+  }
+
+  /// Splits path "name1/name2" into items, throws dnError for empty path
+  static void splitPath(const dtpString &path, std::vector<dtpString> &output) {
+    size_t start = 0, end;
+    output.clear();
+    do {
+      end = path.find(DNTABLE_PATH_SEPARATOR, start);
+      if (end == dtpString::npos)
+        end = path.length();
+      if (end > start)
+        output.push_back(path.substr(start, end - start));
+      start = end + 1;
+    } while (end < path.length());
+
+    if (output.empty())
+      throw dnError("Empty field path");
+  }
+
+  /// Returns last item of field path
+  static dtpString fieldName(const dtpString &path) {
+    size_t pos = path.rfind(DNTABLE_PATH_SEPARATOR);
+    if (pos == dtpString::npos)
+      return path;
+    return path.substr(pos + 1);
+  }
+private:
+  const dnode &m_table;
+  bool m_columnar;
+  size_type m_rowCount;
+  std::vector<std::vector<dtpString> > m_paths;
+  std::vector<const dnode *> m_columns;
+};
+
+// ----------------------------------------------------------------------------
+// dnTableWriter
+// ----------------------------------------------------------------------------
+/// Builds rows or columns table row by row
+class dnTableWriter {
+public:
+  dnTableWriter(bool columnar): m_columnar(columnar), m_output(columnar ? ict_parent : ict_list) {}
+
+  /// Adds output column, in columns output it is array of item type of source
+  /// (if source is array and value can't be null) or list
+  void addColumn(const dtpString &name, const dnode *source, bool nullable) {
+    if (std::find(m_names.begin(), m_names.end(), name) != m_names.end())
+      throw dnError("Duplicate output column: " + name);
+    m_names.push_back(name);
+    if (m_columnar) {
+      DTP_UNIQUE_PTR(dnode) column;
+      if ((source != DTP_NULL) && source->isArray() && !nullable)
+        column.reset(new dnode(ict_array, source->getElementType()));
+      else
+        column.reset(new dnode(ict_list));
+      m_columns.push_back(column.get());
+      m_output.addChild(name, column.release());
+    }
+  }
+
+  void beginRow() {
+    if (!m_columnar)
+      m_row.reset(new dnode(ict_parent));
+  }
+
+  /// Sets value of column in current row, NULL = null value
+  void setValue(uint column, const dnode *value) {
+    if (m_columnar) {
+      dnode *target = m_columns[column];
+      if (!target->isArray())
+        target->addChild((value != DTP_NULL) ? new dnode(*value) : new dnode());
+      else if (value != DTP_NULL)
+        target->addItem(*value);
+      else
+        throw dnError("Null value in array column: " + m_names[column]);
+    } else {
+      m_row->addChild(m_names[column], (value != DTP_NULL) ? new dnode(*value) : new dnode());
+    }
+  }
+
+  void endRow() {
+    if (!m_columnar)
+      m_output.addChild(m_row.release());
+  }
+
+  /// Moves result to output
+  void release(dnode &output) {
+    output.swap(m_output);
+  }
+private:
+  bool m_columnar;
+  dnode m_output;
+  std::vector<dtpString> m_names;
+  std::vector<dnode *> m_columns;
+  DTP_UNIQUE_PTR(dnode) m_row;
+};
+
+} // namespace Details
+} // namespace dtp
+
+#endif // _DTPDNTABLE_H__
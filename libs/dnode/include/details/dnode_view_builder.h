@@ -0,0 +1,259 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_view_builder.h
+// Project:     dtpLib
+// Purpose:     Writer of dnode tree records in DNV layout
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNVIEWBLD_H__
+#define _DTPDNVIEWBLD_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_view_builder.h
+\brief Writer of dnode tree records in DNV layout
+
+Shared by dnViewWriter (contiguous buffer) and dnPersistentStore (file heap).
+Heap type must provide:
+\code
+  dnViewOffset alloc(size_t size); // zero-filled block aligned to 8 bytes
+  void put(dnViewOffset offset, const void *data, size_t size);
+\endcode
+Each record, string and table is allocated as a separate block, so blocks
+can be released one by one.
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include <vector>
+#include <algorithm>
+
+#include "dtp/dnode_view.h"
+
+namespace dtp {
+namespace Details {
+
+// ----------------------------------------------------------------------------
+// dnViewNameLess
+// ----------------------------------------------------------------------------
+struct dnViewNameLess {
+  const std::vector<dtpString> &names;
+  dnViewNameLess(const std::vector<dtpString> &aNames): names(aNames) {}
+  bool operator()(dnViewOffset lhs, dnViewOffset rhs) const {
+    return names[static_cast<size_t>(lhs)] < names[static_cast<size_t>(rhs)];
+  }
+};
+
+// ----------------------------------------------------------------------------
+// dnViewNodeWriter
+// ----------------------------------------------------------------------------
+template<typename Heap>
+class dnViewNodeWriter {
+public:
+  dnViewNodeWriter(Heap &heap): m_heap(heap) {}
+
+  /// Writes node with all sub-nodes, returns offset of node record
+  dnViewOffset writeNode(const dnode &input) {
+    dnViewRecord record;
+    memset(&record, 0, sizeof(record));
+    record.kind = static_cast<byte>(input.getValueType());
+
+    switch (input.getValueType()) {
+      case vt_null:
+        break;
+      case vt_parent:
+        writeParent(input, record);
+        break;
+      case vt_array:
+        writeArray(input, record);
+        break;
+      case vt_byte:
+        setScalar<byte>(record, input.getAs<byte>());
+        break;
+      case vt_int:
+        setScalar<int>(record, input.getAs<int>());
+        break;
+      case vt_uint:
+        setScalar<uint>(record, input.getAs<uint>());
+        break;
+      case vt_int64:
+        setScalar<int64>(record, input.getAs<int64>());
+        break;
+      case vt_uint64:
+        setScalar<uint64>(record, input.getAs<uint64>());
+        break;
+      case vt_bool:
+        setScalar<bool>(record, input.getAs<bool>());
+        break;
+      case vt_float:
+        setScalar<float>(record, input.getAs<float>());
+        break;
+      case vt_double:
+      case vt_date:
+      case vt_time:
+      case vt_datetime:
+        // date & time kinds keep their day count, kind tells them apart
+        setScalar<double>(record, input.getAs<double>());
+        break;
+      case vt_xdouble: {
+        if (sizeof(xdouble) > sizeof(record.a) + sizeof(record.b))
+          throw dnError("xdouble size not supported by DNV layout");
+        xdouble value = input.getAs<xdouble>();
+        memcpy(&record.a, &value, sizeof(value));
+        break;
+      }
+      case vt_string: {
+        dtpString value = input.getAs<dtpString>();
+        record.count = value.length();
+        record.a = writeString(value);
+        break;
+      }
+      default:
+        throw dnError("Value type not supported by DNV layout: " + getValueTypeName(input.getValueType()));
+    }
+
+    return writeRecord(record);
+  }
+
+  dnViewOffset writeString(const char *text, size_t length) {
+    uint64 len = length;
+    dnViewOffset res = m_heap.alloc(sizeof(uint64) + length + 1);
+    m_heap.put(res, &len, sizeof(len));
+    m_heap.put(res + sizeof(uint64), text, length);
+    return res;
+  }
+
+  dnViewOffset writeString(const dtpString &value) {
+    return writeString(value.c_str(), value.length());
+  }
+
+  dnViewOffset writeTable(const std::vector<dnViewOffset> &items) {
+    dnViewOffset res = m_heap.alloc(items.size() * sizeof(dnViewOffset));
+    if (!items.empty())
+      m_heap.put(res, &items[0], items.size() * sizeof(dnViewOffset));
+    return res;
+  }
+
+  dnViewOffset writeRecord(const dnViewRecord &record) {
+    dnViewOffset res = m_heap.alloc(sizeof(record));
+    m_heap.put(res, &record, sizeof(record));
+    return res;
+  }
+
+protected:
+  template<typename ValueType>
+  void setScalar(dnViewRecord &record, ValueType value) {
+    memcpy(&record.a, &value, sizeof(value));
+  }
+
+  template<typename ValueType>
+  dnViewOffset writePodItems(const dnode &input) {
+    size_t cnt = input.size();
+    dnViewOffset res = m_heap.alloc(cnt * sizeof(ValueType));
+    ValueType value;
+    for(size_t i=0; i < cnt; i++) {
+      value = input.get<ValueType>(i);
+      m_heap.put(res + i * sizeof(ValueType), &value, sizeof(value));
+    }
+    return res;
+  }
+
+  void writeParent(const dnode &input, dnViewRecord &record) {
+    size_t cnt = input.size();
+    std::vector<dnViewOffset> childOffsets(cnt);
+    dnode helper;
+
+    for(size_t i=0; i < cnt; i++)
+      childOffsets[i] = writeNode(input.getNode(i, helper));
+
+    record.count = cnt;
+    record.a = writeTable(childOffsets);
+
+    if (input.supportsNames()) {
+      std::vector<dtpString> names(cnt);
+      // name offsets followed by child indices sorted by name
+      std::vector<dnViewOffset> nameTable(2 * cnt);
+
+      for(size_t i=0; i < cnt; i++) {
+        input.getElementName(i, names[i]);
+        nameTable[i] = names[i].empty() ? 0 : writeString(names[i]);
+        nameTable[cnt + i] = i;
+      }
+
+      std::stable_sort(nameTable.begin() + cnt, nameTable.end(), dnViewNameLess(names));
+
+      record.flags = dvfNamed;
+      record.b = writeTable(nameTable);
+    }
+  }
+
+  void writeArray(const dnode &input, dnViewRecord &record) {
+    dnValueType itemType = input.getElementType();
+    size_t cnt = input.size();
+
+    record.itemType = static_cast<byte>(itemType);
+    record.count = cnt;
+
+    switch (itemType) {
+      case vt_datanode: {
+        std::vector<dnViewOffset> itemOffsets(cnt);
+        dnode helper;
+        for(size_t i=0; i < cnt; i++)
+          itemOffsets[i] = writeNode(input.getNode(i, helper));
+        record.a = writeTable(itemOffsets);
+        break;
+      }
+      case vt_string: {
+        std::vector<dnViewOffset> itemOffsets(cnt);
+        for(size_t i=0; i < cnt; i++)
+          itemOffsets[i] = writeString(input.get<dtpString>(i));
+        record.a = writeTable(itemOffsets);
+        break;
+      }
+      case vt_byte:
+        record.a = writePodItems<byte>(input);
+        break;
+      case vt_int:
+        record.a = writePodItems<int>(input);
+        break;
+      case vt_uint:
+        record.a = writePodItems<uint>(input);
+        break;
+      case vt_int64:
+        record.a = writePodItems<int64>(input);
+        break;
+      case vt_uint64:
+        record.a = writePodItems<uint64>(input);
+        break;
+      case vt_bool:
+        record.a = writePodItems<bool>(input);
+        break;
+      case vt_float:
+        record.a = writePodItems<float>(input);
+        break;
+      case vt_double:
+      case vt_date:
+      case vt_time:
+      case vt_datetime:
+        record.a = writePodItems<double>(input);
+        break;
+      case vt_xdouble:
+        record.a = writePodItems<xdouble>(input);
+        break;
+      default:
+        throw dnError("Array type not supported by DNV layout: " + getValueTypeName(itemType));
+    }
+  }
+
+private:
+  Heap &m_heap;
+};
+
+} // namespace Details
+} // namespace dtp
+
+#endif // _DTPDNVIEWBLD_H__
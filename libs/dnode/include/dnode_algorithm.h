@@ -36,6 +36,13 @@ List of algorithms:
 - replace, replace_if
 - transform
 - for_each
+- group_by - hash grouping of table rows with aggregates (count, sum, avg, min, max)
+- hash_join - inner, left & semi join of two tables on key fields
+
+Tables (input of group_by, hash_join):
+- rows: list of parents, field path is child name or path "address/city"
+- columns: parent with named columns (arrays or lists) of equal size,
+  field path is column name
 
 TODO:
 - partition (use in sort)
@@ -56,10 +63,12 @@ See dtp::dnode_cast.h for cast functions.
 #include <algorithm>
 #include <iterator>
 #include <numeric>
+#include <vector>
 
 #include "dtp/details/dtypes.h"
 #include "dtp/dnode.h"
 #include "dtp/dnode_cast.h"
+#include "dtp/dnode_parallel.h"
 #include "base/algorithm.h"
 
 namespace dtp {
@@ -75,14 +84,128 @@ namespace dtp {
 // ----------------------------------------------------------------------------
 // Constants
 // ----------------------------------------------------------------------------
+const uint DALG_DEF_MIN_PARALLEL_ROWS = 16384;
 
 // ----------------------------------------------------------------------------
 // Class definitions
 // ----------------------------------------------------------------------------
+enum dnAggregateFunc {
+  daf_count,
+  daf_sum,
+  daf_avg,
+  daf_min,
+  daf_max
+};
+
+enum dnTableFormat {
+  dtf_auto,    ///< output in format of input
+  dtf_rows,    ///< list of parents
+  dtf_columns  ///< parent with named columns
+};
+
+/// Aggregate calculated for each group
+struct dnAggregateSpec {
+  dnAggregateFunc func;
+  /// Field path, empty for daf_count = number of rows in group
+  dtpString path;
+  /// Name of output field, empty = "<func>_<field>", e.g. "sum_price" or "count"
+  dtpString outputName;
+
+  dnAggregateSpec(dnAggregateFunc aFunc, const dtpString &aPath = dtpString(), const dtpString &aOutputName = dtpString()):
+    func(aFunc), path(aPath), outputName(aOutputName) {}
+};
+
+enum dnJoinType {
+  djt_inner,  ///< pairs of matching rows
+  djt_left,   ///< pairs of matching rows + left rows without match (right columns null)
+  djt_semi    ///< left rows with at least one match, each one once
+};
+
+enum dnJoinSide {
+  djs_left,
+  djs_right
+};
+
+/// Field of left or right table copied to join output
+struct dnJoinColumn {
+  dnJoinSide side;
+  dtpString path;
+  /// Name of output field, empty = last item of path
+  dtpString outputName;
+
+  dnJoinColumn(dnJoinSide aSide, const dtpString &aPath, const dtpString &aOutputName = dtpString()):
+    side(aSide), path(aPath), outputName(aOutputName) {}
+};
+
+struct dnGroupByOptions {
+  dnTableFormat outputFormat;
+  /// Use thread pool for tables with at least minParallelRows rows
+  bool parallel;
+  uint minParallelRows;
+  /// Pool to be used, NULL = dnThreadPool::getDefault()
+  dnThreadPool *pool;
+
+  dnGroupByOptions(): outputFormat(dtf_auto), parallel(true), minParallelRows(DALG_DEF_MIN_PARALLEL_ROWS), pool(DTP_NULL) {}
+};
+
+struct dnJoinOptions {
+  /// dtf_auto = format of left table
+  dnTableFormat outputFormat;
+  /// Probe hash table using thread pool if probed table has at least minParallelRows rows
+  bool parallel;
+  uint minParallelRows;
+  /// Pool to be used, NULL = dnThreadPool::getDefault()
+  dnThreadPool *pool;
+
+  dnJoinOptions(): outputFormat(dtf_auto), parallel(true), minParallelRows(DALG_DEF_MIN_PARALLEL_ROWS), pool(DTP_NULL) {}
+};
 
 // ----------------------------------------------------------------------------
 // Function definitions
 // ----------------------------------------------------------------------------
+/// Groups rows of table by values of key fields and calculates aggregates for each group.
+/// Output contains one row per group (in order of first appearance) with key fields
+/// (named by last item of key path) followed by aggregates.
+/// Null or missing values form own key and are skipped by aggregates.
+/// Keys of different types (e.g. 1 and 1.0) are different.
+/// In columns output aggregates are typed arrays: count - uint64, sum - int64 or double,
+/// avg, min & max - double (NaN for group without values).
+/// Parallel version builds partial hash table for each row range and merges them
+/// at the end, result is identical to the sequential one.
+/// Throws dnError if key is a container or aggregated value is not numeric.
+/// \code
+///   std::vector<dtpString> keys(1, "city");
+///   std::vector<dnAggregateSpec> aggs;
+///   aggs.push_back(dnAggregateSpec(daf_count));
+///   aggs.push_back(dnAggregateSpec(daf_avg, "salary"));
+///   group_by(employees, keys, aggs, output);
+///   // output: [{city: "Paris", count: 12, avg_salary: 4200.0}, ...]
+/// \endcode
+void group_by(const dnode &table, const std::vector<dtpString> &keyPaths,
+  const std::vector<dnAggregateSpec> &aggregates, dnode &output,
+  const dnGroupByOptions &options = dnGroupByOptions());
+
+/// Joins rows of left and right table with equal values of key fields
+/// (leftKeys[i] = rightKeys[i]). Hash table is built for the smaller table,
+/// the other one is probed (in row ranges on thread pool for large tables).
+/// Output rows are ordered by left row, then by right row, and contain only
+/// requested columns (other fields are not copied).
+/// Null or missing keys do not match. Integer keys of different types match
+/// (int 1 = uint64 1), integer and float keys do not.
+/// In columns output array columns keep their item type unless they can
+/// contain nulls (right columns of left join), those are lists.
+/// Throws dnError for invalid keys or columns, also for right columns in semi join.
+/// \code
+///   std::vector<dtpString> leftKeys(1, "customer_id"), rightKeys(1, "id");
+///   std::vector<dnJoinColumn> columns;
+///   columns.push_back(dnJoinColumn(djs_left, "order_no"));
+///   columns.push_back(dnJoinColumn(djs_right, "name", "customer"));
+///   hash_join(orders, customers, leftKeys, rightKeys, columns, djt_left, output);
+/// \endcode
+void hash_join(const dnode &left, const dnode &right,
+  const std::vector<dtpString> &leftKeys, const std::vector<dtpString> &rightKeys,
+  const std::vector<dnJoinColumn> &columns, dnJoinType joinType, dnode &output,
+  const dnJoinOptions &options = dnJoinOptions());
 
 // ----------------------------------------------------------------------------
 // STL-like functions for scLib data types
@@ -0,0 +1,347 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_bind.h
+// Project:     dtpLib
+// Purpose:     Compile-time binding of C++ structures to dnode
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNODEBIND_H__
+#define _DTPDNODEBIND_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_bind.h
+\brief Compile-time binding of C++ structures to dnode
+
+Field list of a structure is declared once with macros, readers and writers
+are generated by templates - without name tables built at runtime and without
+intermediate nodes.
+
+Supported field types:
+- scalars: byte, int, uint, int64, uint64, bool, float, double, xdouble
+- dtpString
+- bound structures
+- std::vector of any of the above (scalars & strings: stored as typed array, other: as list)
+
+Declaration (must be placed in global namespace):
+\code
+  struct Point { int x; int y; };
+  struct Shape { dtpString name; std::vector<Point> points; std::vector<double> weights; };
+
+  DNODE_BIND_BEGIN(Point)
+    DNODE_BIND_FIELD(x)
+    DNODE_BIND_FIELD(y)
+  DNODE_BIND_END()
+
+  DNODE_BIND_BEGIN(Shape)
+    DNODE_BIND_FIELD_AS(name, "shape_name")
+    DNODE_BIND_FIELD(points)
+    DNODE_BIND_FIELD(weights)
+  DNODE_BIND_END()
+\endcode
+
+Function list:
+- dbind_to_node - structure to dnode
+- dbind_from_node - dnode to structure
+- dbind_field_count - number of declared fields
+- dbind_for_each_field - invoke visitor for each field
+
+Reading from dnode: missing fields are left unchanged, unknown children are ignored.
+
+See also dnode_bind_json.h (JSON events) and dnode_bind_bion.h (BION writer).
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include <vector>
+#include <cstring>
+
+#include "dtp/dnode.h"
+
+// ----------------------------------------------------------------------------
+// Simple type definitions
+// ----------------------------------------------------------------------------
+/// Starts field list of structure, use in global namespace
+#define DNODE_BIND_BEGIN(StructType) \
+  namespace dtp { \
+  template<> struct dnBinding<StructType> { \
+    enum { is_bound = 1 }; \
+    typedef StructType struct_type; \
+    static const char *getName() { return #StructType; } \
+    template<typename Visitor, typename ObjectType> \
+    static void visit(Visitor &visitor, ObjectType &obj) {
+
+/// Declares field with name equal to member name
+#define DNODE_BIND_FIELD(field) visitor.visitField(#field, obj.field);
+
+/// Declares field with custom name
+#define DNODE_BIND_FIELD_AS(field, fieldName) visitor.visitField(fieldName, obj.field);
+
+/// Ends field list
+#define DNODE_BIND_END() \
+    } \
+  }; \
+  }
+
+namespace dtp {
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+enum dnBindKindCode {
+  dbkScalar = 1,
+  dbkString = 2,
+  dbkStruct = 3,
+  dbkVector = 4
+};
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+
+/// Field list of structure, specialized by DNODE_BIND_BEGIN
+template<typename T>
+struct dnBinding {
+  enum { is_bound = 0 };
+};
+
+/// Category of bound value type
+template<typename T>
+struct dnBindKind {
+  enum { value = dnBinding<T>::is_bound ? dbkStruct : dbkScalar };
+};
+
+template<>
+struct dnBindKind<dtpString> {
+  enum { value = dbkString };
+};
+
+template<typename T, typename Alloc>
+struct dnBindKind<std::vector<T, Alloc> > {
+  enum { value = dbkVector };
+};
+
+/// Returns true if type is stored as dnode array item (not as list child)
+template<typename T>
+struct dnBindIsArrayItem {
+  enum { value = (dnBindKind<T>::value == dbkScalar) || (dnBindKind<T>::value == dbkString) };
+};
+
+namespace Details {
+
+template<typename T, int Kind = dnBindKind<T>::value>
+struct dnBindNodeIo;
+
+// ----------------------------------------------------------------------------
+// dnBindNodeIo - scalars & strings
+// ----------------------------------------------------------------------------
+template<typename T>
+struct dnBindNodeIo<T, dbkScalar> {
+  static void toNode(const T &value, dnode &output) {
+    output.setAs<T>(value);
+  }
+
+  static void fromNode(const dnode &input, T &value) {
+    value = input.getAs<T>();
+  }
+};
+
+template<typename T>
+struct dnBindNodeIo<T, dbkString> {
+  static void toNode(const T &value, dnode &output) {
+    output.setAs<dtpString>(value);
+  }
+
+  static void fromNode(const dnode &input, T &value) {
+    value = input.getAs<dtpString>();
+  }
+};
+
+// ----------------------------------------------------------------------------
+// dnBindNodeIo - structures
+// ----------------------------------------------------------------------------
+class dnBindToNodeVisitor {
+public:
+  dnBindToNodeVisitor(dnode &output): m_output(output) {}
+
+  template<typename FieldType>
+  void visitField(const char *name, const FieldType &value) {
+    DTP_UNIQUE_PTR(dnode) child(new dnode());
+    dnBindNodeIo<FieldType>::toNode(value, *child);
+    m_output.addChild(name, child.release());
+  }
+private:
+  dnode &m_output;
+};
+
+/// Reads fields from parent node. Children are checked by position first
+/// (matches when node was produced by dbind_to_node), then by name.
+class dnBindFromNodeVisitor {
+public:
+  dnBindFromNodeVisitor(const dnode &input): m_input(input), m_index(0), m_size(input.size()) {}
+
+  template<typename FieldType>
+  void visitField(const char *name, FieldType &value) {
+    const dnode *child = DTP_NULL;
+
+    if (m_index < m_size) {
+      m_input.getElementName(m_index, m_nameBuffer);
+      if (m_nameBuffer == name)
+        child = &m_input.getNode(m_index, m_helper);
+    }
+
+    if (child == DTP_NULL) {
+      m_nameBuffer = name;
+      child = m_input.peekChildR(m_nameBuffer);
+    }
+
+    m_index++;
+
+    if (child != DTP_NULL)
+      dnBindNodeIo<FieldType>::fromNode(*child, value);
+  }
+private:
+  const dnode &m_input;
+  dnode m_helper;
+  dtpString m_nameBuffer;
+  dnode::size_type m_index;
+  dnode::size_type m_size;
+};
+
+template<typename T>
+struct dnBindNodeIo<T, dbkStruct> {
+  static void toNode(const T &value, dnode &output) {
+    output.setAsParent();
+    dnBindToNodeVisitor visitor(output);
+    dnBinding<T>::visit(visitor, value);
+  }
+
+  static void fromNode(const dnode &input, T &value) {
+    if (!input.supportsNames())
+      throw dnError(dtpString("Parent node required for ") + dnBinding<T>::getName());
+    dnBindFromNodeVisitor visitor(input);
+    dnBinding<T>::visit(visitor, value);
+  }
+};
+
+// ----------------------------------------------------------------------------
+// dnBindNodeIo - vectors
+// ----------------------------------------------------------------------------
+template<typename ItemType, bool IsArrayItem = dnBindIsArrayItem<ItemType>::value>
+struct dnBindVectorNodeIo {
+  template<typename VectorType>
+  static void toNode(const VectorType &value, dnode &output) {
+    output.setAsArray(static_cast<dnValueType>(dnValueTypeMeta<ItemType>::item_type));
+    for(typename VectorType::const_iterator it = value.begin(), epos = value.end(); it != epos; ++it)
+      output.addItem(static_cast<ItemType>(*it));
+  }
+
+  template<typename VectorType>
+  static void fromNode(const dnode &input, VectorType &value) {
+    dnode::size_type cnt = input.size();
+    value.resize(cnt);
+    for(dnode::size_type i=0; i < cnt; i++)
+      value[i] = input.get<ItemType>(i);
+  }
+};
+
+template<typename ItemType>
+struct dnBindVectorNodeIo<ItemType, false> {
+  template<typename VectorType>
+  static void toNode(const VectorType &value, dnode &output) {
+    output.setAsList();
+    for(typename VectorType::const_iterator it = value.begin(), epos = value.end(); it != epos; ++it) {
+      DTP_UNIQUE_PTR(dnode) child(new dnode());
+      dnBindNodeIo<ItemType>::toNode(*it, *child);
+      output.addChild(child.release());
+    }
+  }
+
+  template<typename VectorType>
+  static void fromNode(const dnode &input, VectorType &value) {
+    dnode::size_type cnt = input.size();
+    dnode helper;
+    value.resize(cnt);
+    for(dnode::size_type i=0; i < cnt; i++)
+      dnBindNodeIo<ItemType>::fromNode(input.getNode(i, helper), value[i]);
+  }
+};
+
+template<typename T>
+struct dnBindNodeIo<T, dbkVector> {
+  typedef typename T::value_type item_type;
+
+  static void toNode(const T &value, dnode &output) {
+    dnBindVectorNodeIo<item_type>::toNode(value, output);
+  }
+
+  static void fromNode(const dnode &input, T &value) {
+    if (!input.isContainer())
+      throw dnError("Container node required for vector");
+    dnBindVectorNodeIo<item_type>::fromNode(input, value);
+  }
+};
+
+class dnBindFieldCounter {
+public:
+  dnBindFieldCounter(): m_count(0) {}
+
+  template<typename FieldType>
+  void visitField(const char *, const FieldType &) { m_count++; }
+
+  uint getCount() const { return m_count; }
+private:
+  uint m_count;
+};
+
+} // namespace Details
+
+// ----------------------------------------------------------------------------
+// Function definitions
+// ----------------------------------------------------------------------------
+
+/// Converts bound structure (or vector of structures) to dnode
+template<typename T>
+void dbind_to_node(const T &input, dnode &output)
+{
+  output.clear();
+  Details::dnBindNodeIo<T>::toNode(input, output);
+}
+
+/// Reads bound structure (or vector of structures) from dnode
+template<typename T>
+void dbind_from_node(const dnode &input, T &output)
+{
+  Details::dnBindNodeIo<T>::fromNode(input, output);
+}
+
+/// Returns number of fields declared for structure (structure must be default-constructible)
+template<typename T>
+uint dbind_field_count()
+{
+  Details::dnBindFieldCounter counter;
+  const T obj = T();
+  dnBinding<T>::visit(counter, obj);
+  return counter.getCount();
+}
+
+/// Invokes visitor.visitField(name, value) for each declared field
+template<typename T, typename Visitor>
+void dbind_for_each_field(T &input, Visitor &visitor)
+{
+  dnBinding<T>::visit(visitor, input);
+}
+
+template<typename T, typename Visitor>
+void dbind_for_each_field(const T &input, Visitor &visitor)
+{
+  dnBinding<T>::visit(visitor, input);
+}
+
+} // namespace dtp
+
+#endif // _DTPDNODEBIND_H__
@@ -0,0 +1,137 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_bind_bion.h
+// Project:     dtpLib
+// Purpose:     BION writer for structures bound with dnode_bind.h
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNODEBINDBION_H__
+#define _DTPDNODEBINDBION_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_bind_bion.h
+\brief BION writer for structures bound with dnode_bind.h
+
+Writes bound structures directly with BionWriter, producing the same layout
+as dnBionWriter for equivalent dnode (so output can be read back with
+dnBionProcessor):
+- structure -> object
+- vector of scalars or strings -> fixed-type array
+- vector of structures or vectors -> list array
+
+Function list:
+- dbind_write_bion - write structure with header & footer
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include "dtp/dnode_bind.h"
+#include "dtp/dnode_bion.h"
+
+namespace dtp {
+
+namespace Details {
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+template<typename T, int Kind = dnBindKind<T>::value>
+struct dnBindBionIo;
+
+template<typename T>
+struct dnBindBionIo<T, dbkScalar> {
+  template<typename Writer>
+  static void write(Writer &writer, const T &value) {
+    writer.writeValue(value);
+  }
+};
+
+template<typename T>
+struct dnBindBionIo<T, dbkString> {
+  template<typename Writer>
+  static void write(Writer &writer, const T &value) {
+    writer.writeZString(value);
+  }
+};
+
+template<typename Writer>
+class dnBindBionFieldWriter {
+public:
+  dnBindBionFieldWriter(Writer &writer): m_writer(writer) {}
+
+  template<typename FieldType>
+  void visitField(const char *name, const FieldType &value) {
+    m_writer.writeElementName(std::string(name));
+    dnBindBionIo<FieldType>::write(m_writer, value);
+  }
+private:
+  Writer &m_writer;
+};
+
+template<typename T>
+struct dnBindBionIo<T, dbkStruct> {
+  template<typename Writer>
+  static void write(Writer &writer, const T &value) {
+    dnBindBionFieldWriter<Writer> fieldWriter(writer);
+    writer.writeObjectBegin();
+    dnBinding<T>::visit(fieldWriter, value);
+    writer.writeObjectEnd();
+  }
+};
+
+template<typename ItemType, bool IsArrayItem = dnBindIsArrayItem<ItemType>::value>
+struct dnBindBionVectorIo {
+  template<typename Writer, typename VectorType>
+  static void write(Writer &writer, const VectorType &value) {
+    writer.writeFixTypeArrayBegin(value.size());
+    writer.writeValueType(ItemType());
+    for(typename VectorType::const_iterator it = value.begin(), epos = value.end(); it != epos; ++it)
+      writer.writeValueData(static_cast<ItemType>(*it));
+    writer.writeFixTypeArrayEnd();
+  }
+};
+
+template<typename ItemType>
+struct dnBindBionVectorIo<ItemType, false> {
+  template<typename Writer, typename VectorType>
+  static void write(Writer &writer, const VectorType &value) {
+    writer.writeArrayBegin();
+    writer.writeInt(dbatList);
+    for(typename VectorType::const_iterator it = value.begin(), epos = value.end(); it != epos; ++it)
+      dnBindBionIo<ItemType>::write(writer, *it);
+    writer.writeArrayEnd();
+  }
+};
+
+template<typename T>
+struct dnBindBionIo<T, dbkVector> {
+  template<typename Writer>
+  static void write(Writer &writer, const T &value) {
+    dnBindBionVectorIo<typename T::value_type>::write(writer, value);
+  }
+};
+
+} // namespace Details
+
+// ----------------------------------------------------------------------------
+// Function definitions
+// ----------------------------------------------------------------------------
+
+/// Writes bound structure (or vector) as complete BION document
+template<typename T, typename Output>
+void dbind_write_bion(const T &input, Output &output)
+{
+  BionWriter<Output> writer(output);
+  writer.writeHeader();
+  Details::dnBindBionIo<T>::write(writer, input);
+  writer.writeFooter();
+}
+
+} // namespace dtp
+
+#endif // _DTPDNODEBINDBION_H__
@@ -0,0 +1,502 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_bind_json.h
+// Project:     dtpLib
+// Purpose:     JSON reader & writer for structures bound with dnode_bind.h
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNODEBINDJSON_H__
+#define _DTPDNODEBINDJSON_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_bind_json.h
+\brief JSON reader & writer for structures bound with dnode_bind.h
+
+Structure is filled directly from parser events (YawlReaderBase callbacks)
+and written directly to yajl generator - no dnode tree is created.
+Plain JSON is used: objects for structures, arrays for vectors.
+
+For each bound type a static table of handlers is generated (dnBindJsonOps),
+parser keeps a stack of (object, handlers) pairs - one item per nesting level.
+
+Function list:
+- dbind_read_json - parse JSON text into structure
+- dbind_write_json - write structure as JSON text
+
+Unknown keys are skipped, missing keys leave fields unchanged.
+Value of wrong type (for example string for int field) is reported as dnError.
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include <vector>
+#include <cstring>
+
+#include "dtp/dnode_bind.h"
+#include "dtp/YawlIoClasses.h"
+
+namespace dtp {
+
+// ----------------------------------------------------------------------------
+// Forward class definitions
+// ----------------------------------------------------------------------------
+struct dnBindJsonOps;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+
+/// Bound object with its handlers
+struct dnBindJsonTarget {
+  void *object;
+  const dnBindJsonOps *ops;
+
+  dnBindJsonTarget(): object(DTP_NULL), ops(DTP_NULL) {}
+  dnBindJsonTarget(void *aObject, const dnBindJsonOps *aOps): object(aObject), ops(aOps) {}
+};
+
+/// Handlers of parser events for a single bound type. Functions return false on type mismatch.
+/// For vectors scalar handlers append new item.
+struct dnBindJsonOps {
+  int kind;
+  bool (*setNull)(void *obj);
+  bool (*setBool)(void *obj, bool value);
+  bool (*setInteger)(void *obj, long value);
+  bool (*setDouble)(void *obj, double value);
+  bool (*setString)(void *obj, const char *value, size_t len);
+  /// structures only: finds field by name
+  bool (*findField)(void *obj, const char *name, size_t len, dnBindJsonTarget &output);
+  /// vectors only: removes all items
+  void (*clearItems)(void *obj);
+  /// vectors only: appends default item, returns it as target
+  void (*appendItem)(void *obj, dnBindJsonTarget &output);
+};
+
+namespace Details {
+
+template<typename T, int Kind = dnBindKind<T>::value>
+struct dnBindJsonIo;
+
+inline bool dnBindJsonIgnore(void *) { return true; }
+inline bool dnBindJsonRejectBool(void *, bool) { return false; }
+inline bool dnBindJsonRejectInteger(void *, long) { return false; }
+inline bool dnBindJsonRejectDouble(void *, double) { return false; }
+inline bool dnBindJsonRejectString(void *, const char *, size_t) { return false; }
+inline bool dnBindJsonNoField(void *, const char *, size_t, dnBindJsonTarget &) { return false; }
+inline void dnBindJsonNoClear(void *) {}
+inline void dnBindJsonNoAppend(void *, dnBindJsonTarget &output) { output = dnBindJsonTarget(); }
+
+// ----------------------------------------------------------------------------
+// dnBindJsonIo - scalars
+// ----------------------------------------------------------------------------
+template<typename T>
+struct dnBindJsonIo<T, dbkScalar> {
+  static bool setBool(void *obj, bool value) {
+    *static_cast<T *>(obj) = static_cast<T>(value);
+    return true;
+  }
+
+  static bool setInteger(void *obj, long value) {
+    *static_cast<T *>(obj) = static_cast<T>(value);
+    return true;
+  }
+
+  static bool setDouble(void *obj, double value) {
+    *static_cast<T *>(obj) = static_cast<T>(value);
+    return true;
+  }
+
+  static const dnBindJsonOps *getOps() {
+    static const dnBindJsonOps ops = {
+      dbkScalar, dnBindJsonIgnore, setBool, setInteger, setDouble, dnBindJsonRejectString,
+      dnBindJsonNoField, dnBindJsonNoClear, dnBindJsonNoAppend
+    };
+    return &ops;
+  }
+
+  static void write(yajl_gen gen, const T &value) {
+    writeValue(gen, value);
+  }
+
+  static void writeValue(yajl_gen gen, bool value) { yajl_gen_bool(gen, value ? 1 : 0); }
+  static void writeValue(yajl_gen gen, float value) { yajl_gen_double(gen, value); }
+  static void writeValue(yajl_gen gen, double value) { yajl_gen_double(gen, value); }
+  static void writeValue(yajl_gen gen, xdouble value) { yajl_gen_double(gen, static_cast<double>(value)); }
+
+  template<typename IntType>
+  static void writeValue(yajl_gen gen, IntType value) {
+    if ((static_cast<IntType>(static_cast<long>(value)) == value) &&
+        ((static_cast<long>(value) < 0) == (value < IntType())))
+    {
+      yajl_gen_integer(gen, static_cast<long>(value));
+    } else {
+      // does not fit into long - write number as text
+      dtpString text = toString(value);
+      yajl_gen_number(gen, text.c_str(), static_cast<unsigned int>(text.length()));
+    }
+  }
+};
+
+// ----------------------------------------------------------------------------
+// dnBindJsonIo - strings
+// ----------------------------------------------------------------------------
+template<typename T>
+struct dnBindJsonIo<T, dbkString> {
+  static bool setString(void *obj, const char *value, size_t len) {
+    static_cast<T *>(obj)->assign(value, len);
+    return true;
+  }
+
+  static const dnBindJsonOps *getOps() {
+    static const dnBindJsonOps ops = {
+      dbkString, dnBindJsonIgnore, dnBindJsonRejectBool, dnBindJsonRejectInteger, dnBindJsonRejectDouble, setString,
+      dnBindJsonNoField, dnBindJsonNoClear, dnBindJsonNoAppend
+    };
+    return &ops;
+  }
+
+  static void write(yajl_gen gen, const T &value) {
+    yajl_gen_string(gen, reinterpret_cast<const unsigned char *>(value.c_str()), static_cast<unsigned int>(value.length()));
+  }
+};
+
+// ----------------------------------------------------------------------------
+// dnBindJsonIo - structures
+// ----------------------------------------------------------------------------
+class dnBindJsonFieldFinder {
+public:
+  dnBindJsonFieldFinder(const char *name, size_t len): m_name(name), m_len(len), m_found(false) {}
+
+  template<typename FieldType>
+  void visitField(const char *name, FieldType &value) {
+    if (!m_found && (strlen(name) == m_len) && (memcmp(name, m_name, m_len) == 0)) {
+      m_target = dnBindJsonTarget(&value, dnBindJsonIo<FieldType>::getOps());
+      m_found = true;
+    }
+  }
+
+  bool getResult(dnBindJsonTarget &output) const {
+    if (m_found)
+      output = m_target;
+    return m_found;
+  }
+private:
+  const char *m_name;
+  size_t m_len;
+  bool m_found;
+  dnBindJsonTarget m_target;
+};
+
+class dnBindJsonFieldWriter {
+public:
+  dnBindJsonFieldWriter(yajl_gen gen): m_gen(gen) {}
+
+  template<typename FieldType>
+  void visitField(const char *name, const FieldType &value) {
+    yajl_gen_string(m_gen, reinterpret_cast<const unsigned char *>(name), static_cast<unsigned int>(strlen(name)));
+    dnBindJsonIo<FieldType>::write(m_gen, value);
+  }
+private:
+  yajl_gen m_gen;
+};
+
+template<typename T>
+struct dnBindJsonIo<T, dbkStruct> {
+  static bool findField(void *obj, const char *name, size_t len, dnBindJsonTarget &output) {
+    dnBindJsonFieldFinder finder(name, len);
+    dnBinding<T>::visit(finder, *static_cast<T *>(obj));
+    return finder.getResult(output);
+  }
+
+  static const dnBindJsonOps *getOps() {
+    static const dnBindJsonOps ops = {
+      dbkStruct, dnBindJsonIgnore, dnBindJsonRejectBool, dnBindJsonRejectInteger, dnBindJsonRejectDouble,
+      dnBindJsonRejectString, findField, dnBindJsonNoClear, dnBindJsonNoAppend
+    };
+    return &ops;
+  }
+
+  static void write(yajl_gen gen, const T &value) {
+    yajl_gen_map_open(gen);
+    dnBindJsonFieldWriter writer(gen);
+    dnBinding<T>::visit(writer, value);
+    yajl_gen_map_close(gen);
+  }
+};
+
+// ----------------------------------------------------------------------------
+// dnBindJsonIo - vectors
+// ----------------------------------------------------------------------------
+/// Appends container item to vector. Items of scalar vectors are never containers.
+template<typename T, bool IsArrayItem = dnBindIsArrayItem<typename T::value_type>::value>
+struct dnBindJsonItemAppender {
+  static void appendItem(T *, dnBindJsonTarget &output) {
+    output = dnBindJsonTarget();
+  }
+};
+
+template<typename T>
+struct dnBindJsonItemAppender<T, false> {
+  static void appendItem(T *vect, dnBindJsonTarget &output) {
+    vect->push_back(typename T::value_type());
+    output = dnBindJsonTarget(&vect->back(), dnBindJsonIo<typename T::value_type>::getOps());
+  }
+};
+
+template<typename T>
+struct dnBindJsonIo<T, dbkVector> {
+  typedef typename T::value_type item_type;
+  typedef dnBindJsonIo<item_type> item_io;
+
+  static bool setNull(void *obj) {
+    static_cast<T *>(obj)->push_back(item_type());
+    return true;
+  }
+
+  static bool setBool(void *obj, bool value) {
+    item_type item = item_type();
+    if (!item_io::getOps()->setBool(&item, value))
+      return false;
+    static_cast<T *>(obj)->push_back(item);
+    return true;
+  }
+
+  static bool setInteger(void *obj, long value) {
+    item_type item = item_type();
+    if (!item_io::getOps()->setInteger(&item, value))
+      return false;
+    static_cast<T *>(obj)->push_back(item);
+    return true;
+  }
+
+  static bool setDouble(void *obj, double value) {
+    item_type item = item_type();
+    if (!item_io::getOps()->setDouble(&item, value))
+      return false;
+    static_cast<T *>(obj)->push_back(item);
+    return true;
+  }
+
+  static bool setString(void *obj, const char *value, size_t len) {
+    item_type item = item_type();
+    if (!item_io::getOps()->setString(&item, value, len))
+      return false;
+    static_cast<T *>(obj)->push_back(item);
+    return true;
+  }
+
+  static void clearItems(void *obj) {
+    static_cast<T *>(obj)->clear();
+  }
+
+  static void appendItem(void *obj, dnBindJsonTarget &output) {
+    dnBindJsonItemAppender<T>::appendItem(static_cast<T *>(obj), output);
+  }
+
+  static const dnBindJsonOps *getOps() {
+    static const dnBindJsonOps ops = {
+      dbkVector, setNull, setBool, setInteger, setDouble, setString,
+      dnBindJsonNoField, clearItems, appendItem
+    };
+    return &ops;
+  }
+
+  static void write(yajl_gen gen, const T &value) {
+    yajl_gen_array_open(gen);
+    for(typename T::const_iterator it = value.begin(), epos = value.end(); it != epos; ++it)
+      item_io::write(gen, *it);
+    yajl_gen_array_close(gen);
+  }
+};
+
+} // namespace Details
+
+// ----------------------------------------------------------------------------
+// dnBindJsonReader
+// ----------------------------------------------------------------------------
+/// Parses JSON directly into bound structure
+class dnBindJsonReader: public YawlReaderBase {
+public:
+  template<typename T>
+  dnBindJsonReader(T &output, bool checkUtf8 = true, bool commentsEnabled = false):
+    YawlReaderBase(checkUtf8, commentsEnabled),
+    m_root(&output, Details::dnBindJsonIo<T>::getOps()),
+    m_skipDepth(0)
+  {}
+
+  /// Parses input, throws dnError on type mismatch or std::runtime_error on syntax error
+  bool parseString(const dtpString &input) {
+    m_stack.clear();
+    m_pending = m_root;
+    m_skipDepth = 0;
+    m_error.clear();
+
+    bool res = YawlReaderBase::parseString(input);
+    if (!m_error.empty())
+      throw dnError(m_error);
+    return res;
+  }
+
+protected:
+  virtual int processNull() {
+    dnBindJsonTarget target;
+    if (acquireScalarTarget(target) && !target.ops->setNull(target.object))
+      setError("null");
+    return 1;
+  }
+
+  virtual int processBoolean(int boolVal) {
+    dnBindJsonTarget target;
+    if (acquireScalarTarget(target) && !target.ops->setBool(target.object, boolVal != 0))
+      setError("boolean");
+    return 1;
+  }
+
+  virtual int processInteger(long integerVal) {
+    dnBindJsonTarget target;
+    if (acquireScalarTarget(target) && !target.ops->setInteger(target.object, integerVal))
+      setError("integer");
+    return 1;
+  }
+
+  virtual int processDouble(double doubleVal) {
+    dnBindJsonTarget target;
+    if (acquireScalarTarget(target) && !target.ops->setDouble(target.object, doubleVal))
+      setError("double");
+    return 1;
+  }
+
+  virtual int processString(const unsigned char * stringVal, unsigned int stringLen) {
+    dnBindJsonTarget target;
+    if (acquireScalarTarget(target) &&
+        !target.ops->setString(target.object, reinterpret_cast<const char *>(stringVal), stringLen))
+      setError("string");
+    return 1;
+  }
+
+  virtual int processMapKey(const unsigned char * stringVal, unsigned int stringLen) {
+    if (isSkipping())
+      return 1;
+    const dnBindJsonTarget &top = m_stack.back();
+    if (!top.ops->findField(top.object, reinterpret_cast<const char *>(stringVal), stringLen, m_pending))
+      m_pending = dnBindJsonTarget(); // unknown key - value will be skipped
+    return 1;
+  }
+
+  virtual int processStartMap() {
+    openContainer(dbkStruct, "object");
+    return 1;
+  }
+
+  virtual int processEndMap() {
+    closeContainer();
+    return 1;
+  }
+
+  virtual int processStartArray() {
+    openContainer(dbkVector, "array");
+    return 1;
+  }
+
+  virtual int processEndArray() {
+    closeContainer();
+    return 1;
+  }
+
+protected:
+  bool isSkipping() const {
+    return (m_skipDepth > 0) || !m_error.empty();
+  }
+
+  /// Returns target for next value: pending field or new vector item
+  void acquireTarget(dnBindJsonTarget &output) {
+    if (!m_stack.empty() && (m_stack.back().ops->kind == dbkVector)) {
+      output = m_stack.back();
+    } else {
+      output = m_pending;
+      m_pending = dnBindJsonTarget();
+    }
+  }
+
+  bool acquireScalarTarget(dnBindJsonTarget &output) {
+    if (isSkipping())
+      return false;
+    acquireTarget(output);
+    return (output.ops != DTP_NULL);
+  }
+
+  void openContainer(int kind, const char *valueName) {
+    if (isSkipping()) {
+      m_skipDepth++;
+      return;
+    }
+
+    dnBindJsonTarget target;
+    if (!m_stack.empty() && (m_stack.back().ops->kind == dbkVector)) {
+      // container as vector item
+      m_stack.back().ops->appendItem(m_stack.back().object, target);
+    } else {
+      acquireTarget(target);
+    }
+
+    if (target.ops == DTP_NULL) {
+      m_skipDepth++;
+    } else if (target.ops->kind != kind) {
+      setError(valueName);
+      m_skipDepth++;
+    } else {
+      if (kind == dbkVector)
+        target.ops->clearItems(target.object);
+      m_stack.push_back(target);
+    }
+  }
+
+  void closeContainer() {
+    if (m_skipDepth > 0)
+      m_skipDepth--;
+    else if (!m_stack.empty())
+      m_stack.pop_back();
+  }
+
+  void setError(const char *valueName) {
+    if (m_error.empty())
+      m_error = dtpString("Unexpected JSON value type: ") + valueName;
+  }
+
+private:
+  dnBindJsonTarget m_root;
+  dnBindJsonTarget m_pending;
+  std::vector<dnBindJsonTarget> m_stack;
+  uint m_skipDepth;
+  dtpString m_error;
+};
+
+// ----------------------------------------------------------------------------
+// Function definitions
+// ----------------------------------------------------------------------------
+
+/// Parses JSON text into bound structure (or vector)
+template<typename T>
+void dbind_read_json(const dtpString &input, T &output)
+{
+  dnBindJsonReader reader(output);
+  reader.parseString(input);
+}
+
+/// Writes bound structure (or vector) as JSON text
+template<typename T>
+void dbind_write_json(const T &input, dtpString &output, bool beautify = false)
+{
+  YawlWriter writer(beautify, "  ");
+  Details::dnBindJsonIo<T>::write(*writer.getContext(), input);
+  writer.outputToString(output);
+}
+
+} // namespace dtp
+
+#endif // _DTPDNODEBINDJSON_H__
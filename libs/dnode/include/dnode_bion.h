@@ -26,6 +26,7 @@ No further details.
 #include <string>
 #include "base/bion.h"
 #include "dtp/dnode.h"
+#include "dtp/dnode_string_pool.h"
 
 // ----------------------------------------------------------------------------
 // Simple type definitions
@@ -108,6 +109,40 @@ private:
   dtp::dnode &m_output;
 };
 
+/// Reads string array or list of strings (written by dnBionWriter) directly into string pool
+class dnBionStringPoolProcessor
+#ifdef DEBUG
+  : public BionReaderProcessorIntf
+#endif
+{
+public:
+  dnBionStringPoolProcessor(dtp::dnStringPool &output);
+  void processHeader(void *data, size_t dataSize);
+  void processFooter(void *data, size_t dataSize) {}
+  void processObjectBegin();
+  void processObjectEnd() {}
+  void processArrayBegin() { m_listTagWait = true; }
+  void processArrayEnd() {}
+  void processFixTypeArrayBegin(BionValueType valueType, unsigned int elementSize, size_t arraySize);
+  void processFixTypeArrayEnd() {}
+  void processElementName(char *name);
+  void processFloat(float value) { throwWrongType(); }
+  void processDouble(double value) { throwWrongType(); }
+  void processXDouble(xdouble value) { throwWrongType(); }
+  void processZString(char *value) { m_output.push_back(dtp::dnStringRef(value)); }
+  void processBool(bool value) { throwWrongType(); }
+  void processNull() { throwWrongType(); }
+  void processInt(int value);
+  void processInt64(int64 value) { throwWrongType(); }
+  void processUInt(uint value) { throwWrongType(); }
+  void processUInt64(uint64 value) { throwWrongType(); }
+protected:
+  void throwWrongType();
+private:
+  dtp::dnStringPool &m_output;
+  bool m_listTagWait;
+};
+
 template<typename Output>
 class dnBionWriter {
 public:
@@ -119,6 +154,17 @@ public:
     m_writer.writeFooter();
   }
 
+  /// Writes pool as fixed-type string array, texts are taken from pool buffer
+  void write(const dtp::dnStringPool &pool) {
+    m_writer.writeHeader();
+    m_writer.writeFixTypeArrayBegin(pool.size());
+    m_writer.writeZStringType();
+    for(dtp::dnStringPool::size_type i=0, epos = pool.size(); i != epos; ++i)
+      m_writer.writeZStringData(pool.c_str(i));
+    m_writer.writeFixTypeArrayEnd();
+    m_writer.writeFooter();
+  }
+
 protected:
   void writeNode(const dtp::dnode &node) {
     if (!node.isContainer()) {
@@ -127,7 +173,7 @@ protected:
       m_writer.writeArrayBegin();
       m_writer.writeInt(dbatList);
       dnode helper;
-      for(uint i=0, epos = node.size(); i != epos; ++i)
+      for(dtp::dnode::size_type i=0, epos = node.size(); i != epos; ++i)
         writeNode(node.getNode(i, helper));
       m_writer.writeArrayEnd();
     } else if (node.isArray())
@@ -136,13 +182,13 @@ protected:
         m_writer.writeArrayBegin();
         m_writer.writeInt(dbatArray + static_cast<uint>(node.getElementType()));
         dnode helper;
-        for(uint i=0, epos = node.size(); i != epos; ++i)
+        for(dtp::dnode::size_type i=0, epos = node.size(); i != epos; ++i)
           writeNode(node.getNode(i, helper));
         m_writer.writeArrayEnd();
       } else {
         m_writer.writeFixTypeArrayBegin(node.size());
         writeElementType(node.getElementType());
-        for(uint i=0, epos = node.size(); i != epos; ++i)
+        for(dtp::dnode::size_type i=0, epos = node.size(); i != epos; ++i)
           writeNodeElementValue(node, i);
         m_writer.writeFixTypeArrayEnd();
       } // array as fix type
@@ -150,7 +196,7 @@ protected:
     {
       m_writer.writeObjectBegin();
       dnode helper;
-      for(uint i=0, epos = node.size(); i != epos; ++i) {
+      for(dtp::dnode::size_type i=0, epos = node.size(); i != epos; ++i) {
         m_writer.writeElementName(node.getElementName(i));
         writeNode(node.getNode(i, helper));
       }
@@ -229,7 +275,7 @@ protected:
       } // switch
   }
 
-  void writeNodeElementValue(const dtp::dnode &node, uint idx)
+  void writeNodeElementValue(const dtp::dnode &node, dtp::dnode::size_type idx)
   {
     switch(node.getElementType()) {
     case vt_int:
@@ -0,0 +1,606 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_compressed.h
+// Project:     dtpLib
+// Purpose:     Block-compressed in-memory array of numeric values
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNODECOMPRESSED_H__
+#define _DTPDNODECOMPRESSED_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_compressed.h
+\brief Block-compressed in-memory array of numeric values
+
+dnCompressedArray keeps long numeric series (time series etc.) encoded in
+blocks of DCOMPRESS_BLOCK_SIZE items:
+- integers (byte, int, uint, int64, uint64): delta to previous item,
+  zig-zag, bit-packed with the smallest width needed by the block
+- floating point (float, double): XOR with previous value bits, stored as
+  leading zeros + meaningful bits, reusing previous bit window when possible
+  (Gorilla-style)
+
+Each block starts at 64-bit word boundary and has its first value stored
+raw in block directory, so:
+- get decodes one block (last decoded block is cached)
+- push_back collects items in uncompressed tail, full tail is encoded,
+  so appending is amortized O(1)
+- set re-encodes one block, moving following blocks when its size changes
+- const_iterator decodes block by block, without allocation
+- reductions (visitValues, sum, mean, minValue, maxValue) decode on the fly
+
+Conversion: fromArray / toArray - from / to dense dnode array.
+
+Example:
+\code
+  dnCompressedArray<double> history;
+  history.fromArray(samples);
+  double avg = history.mean();
+  for(dnCompressedArray<double>::const_iterator it = history.begin(), epos = history.end(); it != epos; ++it)
+    process(it.index(), *it);
+\endcode
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#include "base/bit.h"
+#include "dtp/dnode.h"
+
+namespace dtp {
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+/// Number of items encoded together, unit of random access
+const uint DCOMPRESS_BLOCK_SIZE = 128;
+
+namespace Details {
+
+// ----------------------------------------------------------------------------
+// Bit stream
+// ----------------------------------------------------------------------------
+inline uint64 dnBitMask(uint bits)
+{
+  return (bits >= 64) ? ~static_cast<uint64>(0) : ((static_cast<uint64>(1) << bits) - 1);
+}
+
+inline uint dnLeadingZeros(uint64 value)
+{
+  if (value == 0)
+    return 64;
+  uint res = 0;
+  if ((value >> 32) == 0) { res += 32; value <<= 32; }
+  if ((value >> 48) == 0) { res += 16; value <<= 16; }
+  if ((value >> 56) == 0) { res += 8; value <<= 8; }
+  if ((value >> 60) == 0) { res += 4; value <<= 4; }
+  if ((value >> 62) == 0) { res += 2; value <<= 2; }
+  if ((value >> 63) == 0) { res += 1; }
+  return res;
+}
+
+inline uint dnTrailingZeros(uint64 value)
+{
+  if (value == 0)
+    return 64;
+  uint res = 0;
+  if ((value & 0xFFFFFFFFULL) == 0) { res += 32; value >>= 32; }
+  if ((value & 0xFFFFULL) == 0) { res += 16; value >>= 16; }
+  if ((value & 0xFFULL) == 0) { res += 8; value >>= 8; }
+  if ((value & 0xFULL) == 0) { res += 4; value >>= 4; }
+  if ((value & 0x3ULL) == 0) { res += 2; value >>= 2; }
+  if ((value & 0x1ULL) == 0) { res += 1; }
+  return res;
+}
+
+/// Appends bits (LSB first) to vector of words, starts at new word
+class dnBitWriter {
+public:
+  dnBitWriter(std::vector<uint64> &output): m_output(output), m_used(64) {}
+
+  /// Writes lowest bits of value, bits <= 64
+  void write(uint64 value, uint bits) {
+    if (bits == 0)
+      return;
+    value &= dnBitMask(bits);
+    if (m_used == 64) {
+      m_output.push_back(0);
+      m_used = 0;
+    }
+    m_output.back() |= (value << m_used);
+    uint space = 64 - m_used;
+    if (bits <= space) {
+      m_used += bits;
+    } else {
+      m_output.push_back(value >> space);
+      m_used = bits - space;
+    }
+  }
+private:
+  std::vector<uint64> &m_output;
+  uint m_used;
+};
+
+/// Reads bits written by dnBitWriter
+class dnBitReader {
+public:
+  dnBitReader(const uint64 *data): m_data(data), m_bit(0) {}
+
+  uint64 read(uint bits) {
+    if (bits == 0)
+      return 0;
+    uint64 res = (*m_data) >> m_bit;
+    uint avail = 64 - m_bit;
+    if (bits < avail) {
+      m_bit += bits;
+    } else if (bits == avail) {
+      ++m_data;
+      m_bit = 0;
+      return res;
+    } else {
+      ++m_data;
+      res |= (*m_data) << avail;
+      m_bit = bits - avail;
+    }
+    return res & dnBitMask(bits);
+  }
+
+  bool readBit() { return (read(1) != 0); }
+private:
+  const uint64 *m_data;
+  uint m_bit;
+};
+
+// ----------------------------------------------------------------------------
+// Codecs
+// ----------------------------------------------------------------------------
+/// Encoding of one block: first value is kept raw by caller
+struct dnCompressBlockInfo {
+  dnSizeType wordOffset;
+  uint64 first;
+  uint width; // bits per item for integers
+};
+
+/// Delta + zig-zag + bit-packing
+template<typename T>
+struct dnCompressIntCodec {
+  static uint64 toBits(T value) { return static_cast<uint64>(value); }
+  static T fromBits(uint64 value) { return static_cast<T>(value); }
+
+  static void encode(const T *values, uint count, dnCompressBlockInfo &info, dnBitWriter &writer) {
+    uint64 prev = toBits(values[0]);
+    uint64 mask = 0;
+    info.first = prev;
+
+    uint64 delta, zigzag;
+    for(uint i = 1; i < count; i++) {
+      delta = toBits(values[i]) - prev;
+      prev += delta;
+      zigzag = (delta << 1) ^ (0 - (delta >> 63));
+      mask |= zigzag;
+    }
+
+    info.width = getActiveBitSize(mask);
+    if (info.width == 0)
+      return;
+
+    prev = info.first;
+    for(uint i = 1; i < count; i++) {
+      delta = toBits(values[i]) - prev;
+      prev += delta;
+      writer.write((delta << 1) ^ (0 - (delta >> 63)), info.width);
+    }
+  }
+
+  static void decode(const uint64 *data, const dnCompressBlockInfo &info, uint count, T *output) {
+    uint64 value = info.first;
+    output[0] = fromBits(value);
+    if (info.width == 0) {
+      for(uint i = 1; i < count; i++)
+        output[i] = output[0];
+      return;
+    }
+
+    dnBitReader reader(data);
+    uint64 zigzag;
+    for(uint i = 1; i < count; i++) {
+      zigzag = reader.read(info.width);
+      value += (zigzag >> 1) ^ (0 - (zigzag & 1));
+      output[i] = fromBits(value);
+    }
+  }
+};
+
+/// XOR with previous value, Gorilla-style bit windows
+template<typename T, typename BitsType>
+struct dnCompressFloatCodec {
+  static uint64 toBits(T value) {
+    BitsType bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return static_cast<uint64>(bits);
+  }
+
+  static T fromBits(uint64 value) {
+    BitsType bits = static_cast<BitsType>(value);
+    T res;
+    memcpy(&res, &bits, sizeof(res));
+    return res;
+  }
+
+  static void encode(const T *values, uint count, dnCompressBlockInfo &info, dnBitWriter &writer) {
+    uint64 prev = toBits(values[0]);
+    info.first = prev;
+    info.width = 0;
+
+    uint prevLead = 65;
+    uint prevTrail = 0;
+    uint64 bits, diff;
+    uint lead, trail, len;
+
+    for(uint i = 1; i < count; i++) {
+      bits = toBits(values[i]);
+      diff = bits ^ prev;
+      prev = bits;
+      if (diff == 0) {
+        writer.write(0, 1);
+        continue;
+      }
+
+      lead = dnLeadingZeros(diff);
+      trail = dnTrailingZeros(diff);
+      if ((prevLead <= lead) && (prevTrail <= trail)) {
+        // control bits "10": meaningful bits fit in previous window
+        writer.write(1, 2);
+        writer.write(diff >> prevTrail, 64 - prevLead - prevTrail);
+      } else {
+        // control bits "11": new window
+        len = 64 - lead - trail;
+        writer.write(3, 2);
+        writer.write(lead, 6);
+        writer.write(len - 1, 6);
+        writer.write(diff >> trail, len);
+        prevLead = lead;
+        prevTrail = trail;
+      }
+    }
+  }
+
+  static void decode(const uint64 *data, const dnCompressBlockInfo &info, uint count, T *output) {
+    uint64 value = info.first;
+    output[0] = fromBits(value);
+
+    dnBitReader reader(data);
+    uint prevLead = 0;
+    uint prevTrail = 0;
+    uint len;
+
+    for(uint i = 1; i < count; i++) {
+      if (reader.readBit()) {
+        if (reader.readBit()) {
+          prevLead = static_cast<uint>(reader.read(6));
+          len = static_cast<uint>(reader.read(6)) + 1;
+          prevTrail = 64 - prevLead - len;
+        } else {
+          len = 64 - prevLead - prevTrail;
+        }
+        value ^= (reader.read(len) << prevTrail);
+      }
+      output[i] = fromBits(value);
+    }
+  }
+};
+
+template<typename T>
+struct dnCompressCodec;
+
+template<> struct dnCompressCodec<byte>: public dnCompressIntCodec<byte> {};
+template<> struct dnCompressCodec<int>: public dnCompressIntCodec<int> {};
+template<> struct dnCompressCodec<uint>: public dnCompressIntCodec<uint> {};
+template<> struct dnCompressCodec<int64>: public dnCompressIntCodec<int64> {};
+template<> struct dnCompressCodec<uint64>: public dnCompressIntCodec<uint64> {};
+template<> struct dnCompressCodec<float>: public dnCompressFloatCodec<float, uint> {};
+template<> struct dnCompressCodec<double>: public dnCompressFloatCodec<double, uint64> {};
+
+} // namespace Details
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+
+// ----------------------------------------------------------------------------
+// dnCompressedArray
+// ----------------------------------------------------------------------------
+template<typename ValueType>
+class dnCompressedArray {
+public:
+  typedef dnode::size_type size_type;
+  typedef ValueType value_type;
+  typedef Details::dnCompressCodec<ValueType> codec_type;
+  typedef Details::dnCompressBlockInfo block_info;
+
+  /// Sequential reader, decodes one block at a time
+  class const_iterator {
+  public:
+    const_iterator(): m_array(DTP_NULL), m_index(0), m_blockBegin(0), m_blockEnd(0) {}
+    const_iterator(const dnCompressedArray<ValueType> *owner, size_type index):
+      m_array(owner), m_index(index), m_blockBegin(0), m_blockEnd(0) {}
+
+    size_type index() const { return m_index; }
+
+    ValueType operator*() const {
+      if ((m_index < m_blockBegin) || (m_index >= m_blockEnd))
+        loadBlock();
+      return m_buffer[m_index - m_blockBegin];
+    }
+
+    const_iterator &operator++() {
+      ++m_index;
+      return *this;
+    }
+
+    bool operator==(const const_iterator &rhs) const { return (m_index == rhs.m_index); }
+    bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+  private:
+    void loadBlock() const {
+      size_type block = m_index / DCOMPRESS_BLOCK_SIZE;
+      uint count = m_array->decodeBlock(block, m_buffer);
+      m_blockBegin = block * DCOMPRESS_BLOCK_SIZE;
+      m_blockEnd = m_blockBegin + count;
+    }
+  private:
+    const dnCompressedArray<ValueType> *m_array;
+    size_type m_index;
+    mutable size_type m_blockBegin;
+    mutable size_type m_blockEnd;
+    mutable ValueType m_buffer[DCOMPRESS_BLOCK_SIZE];
+  };
+
+  dnCompressedArray(): m_cacheBlock(npos_block()) {}
+
+  size_type size() const { return static_cast<size_type>(m_blocks.size()) * DCOMPRESS_BLOCK_SIZE + static_cast<size_type>(m_tail.size()); }
+  bool empty() const { return m_blocks.empty() && m_tail.empty(); }
+  /// Number of encoded (full) blocks
+  size_type blockCount() const { return static_cast<size_type>(m_blocks.size()); }
+
+  void clear() {
+    m_words.clear();
+    m_blocks.clear();
+    m_tail.clear();
+    m_cacheBlock = npos_block();
+  }
+
+  void push_back(const ValueType &value) {
+    m_tail.push_back(value);
+    if (m_tail.size() == DCOMPRESS_BLOCK_SIZE) {
+      appendBlock(&m_tail[0]);
+      m_tail.clear();
+    }
+  }
+
+  ValueType get(size_type index) const {
+    checkIndex(index);
+    size_type block = index / DCOMPRESS_BLOCK_SIZE;
+    if (block == m_blocks.size())
+      return m_tail[index % DCOMPRESS_BLOCK_SIZE];
+    if (block != m_cacheBlock) {
+      decodeBlock(block, m_cache);
+      m_cacheBlock = block;
+    }
+    return m_cache[index % DCOMPRESS_BLOCK_SIZE];
+  }
+
+  ValueType operator[](size_type index) const { return get(index); }
+
+  /// Changes item value, encoded block is re-encoded
+  void set(size_type index, const ValueType &value) {
+    checkIndex(index);
+    size_type block = index / DCOMPRESS_BLOCK_SIZE;
+    if (block == m_blocks.size()) {
+      m_tail[index % DCOMPRESS_BLOCK_SIZE] = value;
+      return;
+    }
+
+    ValueType values[DCOMPRESS_BLOCK_SIZE];
+    decodeBlock(block, values);
+    if (values[index % DCOMPRESS_BLOCK_SIZE] == value)
+      return;
+    values[index % DCOMPRESS_BLOCK_SIZE] = value;
+    replaceBlock(block, values);
+  }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, size()); }
+
+  /// Decodes block to output (DCOMPRESS_BLOCK_SIZE items), returns number of items in block
+  uint decodeBlock(size_type block, ValueType *output) const {
+    if (block == m_blocks.size()) {
+      std::copy(m_tail.begin(), m_tail.end(), output);
+      return static_cast<uint>(m_tail.size());
+    }
+    const block_info &info = m_blocks[block];
+    codec_type::decode(m_words.empty() ? DTP_NULL : &m_words[0] + info.wordOffset, info, DCOMPRESS_BLOCK_SIZE, output);
+    return DCOMPRESS_BLOCK_SIZE;
+  }
+
+  /// Calls visitor for each value, in index order
+  template<typename Visitor>
+  Visitor visitValues(Visitor visitor) const {
+    ValueType values[DCOMPRESS_BLOCK_SIZE];
+    uint count;
+    for(size_type block = 0, epos = m_blocks.size(); block <= epos; block++) {
+      count = decodeBlock(block, values);
+      visitor = std::for_each(values, values + count, visitor);
+    }
+    return visitor;
+  }
+
+  template<typename ResultType>
+  ResultType sum(ResultType init) const {
+    ValueType values[DCOMPRESS_BLOCK_SIZE];
+    uint count;
+    for(size_type block = 0, epos = m_blocks.size(); block <= epos; block++) {
+      count = decodeBlock(block, values);
+      for(uint i = 0; i < count; i++)
+        init += static_cast<ResultType>(values[i]);
+    }
+    return init;
+  }
+
+  /// Average of all items, 0 for empty array
+  double mean() const {
+    if (empty())
+      return 0.0;
+    return sum(0.0) / static_cast<double>(size());
+  }
+
+  /// Minimum of all items, ValueType() for empty array
+  ValueType minValue() const {
+    if (empty())
+      return ValueType();
+    ValueType values[DCOMPRESS_BLOCK_SIZE];
+    ValueType res = get(0);
+    uint count;
+    for(size_type block = 0, epos = m_blocks.size(); block <= epos; block++) {
+      count = decodeBlock(block, values);
+      if (count > 0)
+        res = std::min(res, *std::min_element(values, values + count));
+    }
+    return res;
+  }
+
+  /// Maximum of all items, ValueType() for empty array
+  ValueType maxValue() const {
+    if (empty())
+      return ValueType();
+    ValueType values[DCOMPRESS_BLOCK_SIZE];
+    ValueType res = get(0);
+    uint count;
+    for(size_type block = 0, epos = m_blocks.size(); block <= epos; block++) {
+      count = decodeBlock(block, values);
+      if (count > 0)
+        res = std::max(res, *std::max_element(values, values + count));
+    }
+    return res;
+  }
+
+  /// Replaces contents with items of array (or list of scalars)
+  void fromArray(const dnode &input) {
+    clear();
+    if (input.isArray() && (input.getElementType() == static_cast<dnValueType>(Details::dnValueTypeMeta<ValueType>::item_type))) {
+      input.visitVectorValues<ValueType>(AppendVisitor(*this));
+    } else {
+      for(size_type i=0, epos = input.size(); i != epos; i++)
+        push_back(input.get<ValueType>(i));
+    }
+  }
+
+  /// Writes all items to dense array
+  void toArray(dnode &output) const {
+    dnode res(ict_array, static_cast<dnValueType>(Details::dnValueTypeMeta<ValueType>::item_type));
+    res.resize(size());
+    ValueType values[DCOMPRESS_BLOCK_SIZE];
+    uint count;
+    size_type pos = 0;
+    for(size_type block = 0, epos = m_blocks.size(); block <= epos; block++) {
+      count = decodeBlock(block, values);
+      for(uint i = 0; i < count; i++)
+        res.set<ValueType>(pos++, values[i]);
+    }
+    output.swap(res);
+  }
+
+  void swap(dnCompressedArray<ValueType> &other) {
+    m_words.swap(other.m_words);
+    m_blocks.swap(other.m_blocks);
+    m_tail.swap(other.m_tail);
+    std::swap(m_cacheBlock, other.m_cacheBlock);
+    std::swap_ranges(m_cache, m_cache + DCOMPRESS_BLOCK_SIZE, other.m_cache);
+  }
+
+  void shrinkToFit() {
+    if (m_words.capacity() > m_words.size())
+      std::vector<uint64>(m_words).swap(m_words);
+    if (m_blocks.capacity() > m_blocks.size())
+      std::vector<block_info>(m_blocks).swap(m_blocks);
+  }
+
+  /// Number of bytes used by encoded blocks and uncompressed tail
+  uint64 dataSize() const {
+    return m_words.capacity() * sizeof(uint64) +
+      m_blocks.capacity() * sizeof(block_info) +
+      m_tail.capacity() * sizeof(ValueType);
+  }
+
+  /// Estimated number of bytes used by storage, including fixed size of object
+  /// (with decoded block cache of DCOMPRESS_BLOCK_SIZE values)
+  uint64 memoryUsed() const {
+    return sizeof(*this) + dataSize();
+  }
+protected:
+  class AppendVisitor {
+  public:
+    AppendVisitor(dnCompressedArray<ValueType> &output): m_output(&output) {}
+    void operator()(const ValueType &value) { m_output->push_back(value); }
+  private:
+    dnCompressedArray<ValueType> *m_output;
+  };
+
+  static size_type npos_block() { return static_cast<size_type>(-1); }
+
+  void checkIndex(size_type index) const {
+    if (index >= size())
+      throw dnError("Index out of range: " + toString(static_cast<uint64>(index)));
+  }
+
+  void appendBlock(const ValueType *values) {
+    block_info info;
+    info.wordOffset = static_cast<dnSizeType>(m_words.size());
+    Details::dnBitWriter writer(m_words);
+    codec_type::encode(values, DCOMPRESS_BLOCK_SIZE, info, writer);
+    m_blocks.push_back(info);
+  }
+
+  void replaceBlock(size_type block, const ValueType *values) {
+    std::vector<uint64> words;
+    block_info info;
+    Details::dnBitWriter writer(words);
+    codec_type::encode(values, DCOMPRESS_BLOCK_SIZE, info, writer);
+
+    dnSizeType start = m_blocks[block].wordOffset;
+    dnSizeType oldEnd = (block + 1 < m_blocks.size()) ? m_blocks[block + 1].wordOffset : static_cast<dnSizeType>(m_words.size());
+    dnSizeType oldCount = oldEnd - start;
+    dnSizeType newCount = static_cast<dnSizeType>(words.size());
+
+    if (newCount < oldCount)
+      m_words.erase(m_words.begin() + (start + newCount), m_words.begin() + oldEnd);
+    else if (newCount > oldCount)
+      m_words.insert(m_words.begin() + oldEnd, newCount - oldCount, static_cast<uint64>(0));
+    std::copy(words.begin(), words.end(), m_words.begin() + start);
+
+    info.wordOffset = start;
+    m_blocks[block] = info;
+    for(size_type i = block + 1, epos = m_blocks.size(); i < epos; i++)
+      m_blocks[i].wordOffset = m_blocks[i].wordOffset + newCount - oldCount;
+
+    if (m_cacheBlock == block)
+      m_cacheBlock = npos_block();
+  }
+private:
+  std::vector<uint64> m_words;
+  std::vector<block_info> m_blocks;
+  std::vector<ValueType> m_tail;
+  mutable size_type m_cacheBlock;
+  mutable ValueType m_cache[DCOMPRESS_BLOCK_SIZE];
+};
+
+} // namespace dtp
+
+#endif // _DTPDNODECOMPRESSED_H__
@@ -0,0 +1,209 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_expr.h
+// Project:     dtpLib
+// Purpose:     Compiled expressions over dnode rows & tables
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNODEEXPR_H__
+#define _DTPDNODEEXPR_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_expr.h
+\brief Compiled expressions over dnode rows & tables
+
+dnExpression compiles expression text once into a tree of operation nodes
+(constant parts are calculated during compilation). Each node keeps buffer
+for its result, so evaluation for next row reuses memory of previous one.
+
+Syntax:
+\verbatim
+  literals:    12, 1.5e3, 'text', "text", true, false, null
+  fields:      name, address.city, [order no] - path in row, "a.b" = dnode path "a/b"
+  arithmetic:  + - * / %        (+ with string operand = concatenation)
+  comparison:  = == != <> < <= > >=
+  logic:       and or not, && || !
+  functions:   abs(x), round(x[, digits]), floor(x), ceil(x), sqrt(x), pow(x, y),
+               min(x, y), max(x, y), if(cond, a, b), coalesce(a, b, ...), is_null(x),
+               len(s), lower(s), upper(s), trim(s), substr(s, start[, count]),
+               contains(s, part), starts_with(s, part), ends_with(s, part),
+               str(x), num(s),
+               date(s), date_str(d), datetime_str(d), year(d), month(d), day(d),
+               hour(d), minute(d), second(d), today(), now()
+\endverbatim
+
+Values: null, bool, number (double) or string. Dates are numbers - days
+since 1970-01-01 with time as fraction of day (see base/date.h), date('2026-10-18')
+parses ISO date with optional time.
+Null operand gives null for arithmetic, comparison and "not", "and" & "or"
+treat null as false. Missing field is null. Filter accepts rows with true
+result only.
+
+Tables (rows or columns format, see dtp::group_by): expression is bound to
+table with bindTable(). Expressions with numeric result on columns table
+with numeric arrays are evaluated in batches (DNEXPR_BATCH_SIZE rows per node
+call), others row by row.
+
+Table operations (output in format of input):
+- expr_filter - rows with true result
+- expr_project - table of calculated columns
+- expr_sort - rows ordered by calculated key (stable, nulls first)
+
+Example:
+\code
+  dnExpression expr("price * qty > 100 and lower(address.city) = 'paris'");
+  if (expr.test(order))
+    ...
+
+  dnode selected;
+  expr_filter(orders, "year(created) = 2026", selected);
+\endcode
+
+dnExpression is not thread-safe, use separate copy for each thread.
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include <vector>
+
+#include "dtp/dnode.h"
+
+namespace dtp {
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+const uint DNEXPR_BATCH_SIZE = 1024;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+enum dnExprType {
+  det_null,
+  det_bool,
+  det_number,
+  det_string
+};
+
+class dnExprError: public dnError {
+public:
+  dnExprError(const std::string &msg): dnError("Expression error: " + msg) {}
+};
+
+// ----------------------------------------------------------------------------
+// dnExprValue
+// ----------------------------------------------------------------------------
+/// Result of expression
+class dnExprValue {
+public:
+  dnExprValue(): m_type(det_null), m_number(0.0) {}
+
+  dnExprType getType() const { return m_type; }
+  bool isNull() const { return (m_type == det_null); }
+  bool isString() const { return (m_type == det_string); }
+  /// Number or bool
+  bool isNumeric() const { return (m_type == det_number) || (m_type == det_bool); }
+  /// Returns true for true, non-zero number or non-empty string
+  bool isTrue() const;
+
+  /// Returns number (bool as 0 or 1), throws dnExprError for other types
+  double getNumber() const;
+  bool getBool() const { return isTrue(); }
+  /// Returns string, throws dnExprError for other types
+  const dtpString &getString() const;
+  /// Returns value converted to dnode (double, bool, string or null)
+  void getAsNode(dnode &output) const;
+
+  void setNull() { m_type = det_null; }
+  void setBool(bool value) { m_type = det_bool; m_number = value ? 1.0 : 0.0; }
+  void setNumber(double value) { m_type = det_number; m_number = value; }
+  void setString(const dtpString &value) { m_type = det_string; m_text.assign(value); }
+  /// Sets type to string and returns buffer of value
+  dtpString &prepareString() { m_type = det_string; return m_text; }
+private:
+  dnExprType m_type;
+  double m_number;
+  dtpString m_text;
+};
+
+// ----------------------------------------------------------------------------
+// dnExpression
+// ----------------------------------------------------------------------------
+class dnExpression {
+public:
+  typedef dnode::size_type size_type;
+
+  dnExpression();
+  /// Compiles expression, throws dnExprError on syntax error
+  explicit dnExpression(const dtpString &source);
+  /// Compiles source of src again, result is not bound to table
+  dnExpression(const dnExpression &src);
+  dnExpression &operator=(const dnExpression &src);
+  ~dnExpression();
+
+  /// Compiles expression, throws dnExprError with error position on syntax error
+  void compile(const dtpString &source);
+  bool isCompiled() const;
+  const dtpString &getSource() const;
+  /// Returns paths of fields used in expression (items separated by '/')
+  const std::vector<dtpString> &getFieldPaths() const;
+
+  // -- single row --
+  /// Calculates value for row (parent), result is valid until next evaluation
+  const dnExprValue &evaluate(const dnode &row);
+  /// Returns true if result for row is true
+  bool test(const dnode &row);
+
+  // -- table --
+  /// Binds expression to table, table must not be modified while it is bound.
+  /// Throws dnError if columns table has no column used in expression.
+  void bindTable(const dnode &table);
+  void unbindTable();
+  bool isBound() const;
+  size_type getRowCount() const;
+  /// Returns true if result is numeric (or bool) for all rows of bound table
+  bool isNumeric() const;
+  /// Calculates value for row of bound table
+  const dnExprValue &evaluateRow(size_type row);
+  bool testRow(size_type row);
+  /// Calculates results of rows [first, first + count) of bound table as numbers:
+  /// bool as 0 or 1, null as NaN. Throws dnExprError for string result.
+  void evaluateBatch(size_type first, size_type count, double *output);
+private:
+  void checkCompiled() const;
+  void checkBound() const;
+private:
+  struct Impl;
+  Impl *m_impl;
+};
+
+/// Output column of expr_project
+struct dnExprColumn {
+  dtpString name;
+  dtpString expression;
+
+  dnExprColumn(const dtpString &aName, const dtpString &aExpression): name(aName), expression(aExpression) {}
+};
+
+// ----------------------------------------------------------------------------
+// Function definitions
+// ----------------------------------------------------------------------------
+/// Copies rows of table for which predicate is true to output
+void expr_filter(const dnode &table, const dtpString &predicate, dnode &output);
+
+/// Creates table with a given calculated columns, one row for each row of table.
+/// In columns output numeric expressions give double arrays (null = NaN), other ones lists.
+void expr_project(const dnode &table, const std::vector<dnExprColumn> &columns, dnode &output);
+
+/// Copies rows of table to output in order of key values (stable).
+/// Nulls go first, then numbers, then strings (in ascending order).
+void expr_sort(const dnode &table, const dtpString &key, bool ascending, dnode &output);
+
+} // namespace dtp
+
+#endif // _DTPDNODEEXPR_H__
@@ -0,0 +1,306 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_index.h
+// Project:     dtpLib
+// Purpose:     Secondary indexes on child fields of dnode list items
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNODEINDEX_H__
+#define _DTPDNODEINDEX_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_index.h
+\brief Secondary indexes on child fields of dnode list items
+
+dnIndexedList keeps a list of parents together with attached indexes.
+Each index maps key (value of child field or path "address/city" in item)
+to item positions and is updated by list modification functions:
+- addItem - O(1) for hash, O(log n) for sorted index
+- setElement - replaces key of one item
+- eraseElement - also shifts positions of following items, O(n)
+
+Index types:
+- dnHashIndex<KeyType> - point lookup in O(1) (boost::unordered_multimap)
+- dnSortedIndex<KeyType> - point lookup in O(log n), range lookup in O(log n + k)
+
+Key is read as KeyType with getAs<KeyType>(). Items without key field are
+not indexed. For equal keys find() returns the lowest position and findAll()
+returns positions in ascending order.
+
+Example:
+\code
+  dnIndexedList users;
+  users.addIndex("id", new dnHashIndex<int>("id"));
+  users.addIndex("age", new dnSortedIndex<int>("profile/age"));
+
+  users.addItem(user);
+
+  dnode::size_type pos = users.getIndexAs<dnHashIndex<int> >("id").find(1234);
+  if (pos != dnode::npos)
+    std::cout << users[pos].get<dtpString>("name");
+
+  std::vector<dnode::size_type> found;
+  users.getIndexAs<dnSortedIndex<int> >("age").findRange(18, 30, found);
+\endcode
+
+Modifications of list done directly (not by dnIndexedList) require rebuildIndexes().
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include <map>
+#include <vector>
+#include <algorithm>
+
+#include <boost/unordered_map.hpp>
+
+#include "dtp/dnode.h"
+
+namespace dtp {
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+const char DNINDEX_PATH_SEPARATOR = '/';
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+
+// ----------------------------------------------------------------------------
+// dnListIndex
+// ----------------------------------------------------------------------------
+/// Base class of list indexes, item position is index in list
+class dnListIndex {
+public:
+  typedef dnode::size_type size_type;
+
+  /// keyPath: name of child or path of names separated by '/'
+  dnListIndex(const dtpString &keyPath);
+  virtual ~dnListIndex() {}
+
+  const dtpString &getKeyPath() const { return m_keyPath; }
+
+  virtual void clear() = 0;
+  /// Number of indexed items
+  virtual size_type size() const = 0;
+  /// Adds item which was inserted into list at pos, pos must be >= positions in index
+  virtual void addItem(const dnode &item, size_type pos) = 0;
+  /// Removes item stored at pos, positions greater than pos are decreased if shift is true
+  virtual void eraseItem(const dnode &item, size_type pos, bool shift) = 0;
+  /// Builds index for all items of list
+  void rebuild(const dnode &list);
+
+  /// Returns key field of item or NULL if item has no such field
+  const dnode *findKey(const dnode &item) const;
+protected:
+  static void shiftPositions(size_type &value, size_type pos) {
+    if (value > pos)
+      --value;
+  }
+private:
+  dtpString m_keyPath;
+  std::vector<dtpString> m_path;
+};
+
+// ----------------------------------------------------------------------------
+// dnHashIndex
+// ----------------------------------------------------------------------------
+template<typename KeyType>
+class dnHashIndex: public dnListIndex {
+public:
+  typedef boost::unordered_multimap<KeyType, size_type> map_type;
+
+  dnHashIndex(const dtpString &keyPath): dnListIndex(keyPath) {}
+
+  virtual void clear() { m_map.clear(); }
+  virtual size_type size() const { return m_map.size(); }
+
+  virtual void addItem(const dnode &item, size_type pos) {
+    const dnode *key = findKey(item);
+    if (key != DTP_NULL)
+      m_map.insert(std::make_pair(key->getAs<KeyType>(), pos));
+  }
+
+  virtual void eraseItem(const dnode &item, size_type pos, bool shift) {
+    const dnode *key = findKey(item);
+    if (key != DTP_NULL) {
+      std::pair<typename map_type::iterator, typename map_type::iterator> range = m_map.equal_range(key->getAs<KeyType>());
+      for(typename map_type::iterator it = range.first; it != range.second; ++it)
+        if (it->second == pos) {
+          m_map.erase(it);
+          break;
+        }
+    }
+    if (shift)
+      for(typename map_type::iterator it = m_map.begin(), epos = m_map.end(); it != epos; ++it)
+        shiftPositions(it->second, pos);
+  }
+
+  /// Returns position of first item with a given key or dnode::npos
+  size_type find(const KeyType &key) const {
+    std::pair<typename map_type::const_iterator, typename map_type::const_iterator> range = m_map.equal_range(key);
+    size_type res = dnode::npos;
+    for(typename map_type::const_iterator it = range.first; it != range.second; ++it)
+      if ((res == dnode::npos) || (it->second < res))
+        res = it->second;
+    return res;
+  }
+
+  /// Appends positions of all items with a given key to output (ascending)
+  void findAll(const KeyType &key, std::vector<size_type> &output) const {
+    std::pair<typename map_type::const_iterator, typename map_type::const_iterator> range = m_map.equal_range(key);
+    const size_t start = output.size();
+    for(typename map_type::const_iterator it = range.first; it != range.second; ++it)
+      output.push_back(it->second);
+    std::sort(output.begin() + start, output.end());
+  }
+
+  size_type count(const KeyType &key) const { return m_map.count(key); }
+  bool contains(const KeyType &key) const { return (m_map.find(key) != m_map.end()); }
+private:
+  map_type m_map;
+};
+
+// ----------------------------------------------------------------------------
+// dnSortedIndex
+// ----------------------------------------------------------------------------
+template<typename KeyType>
+class dnSortedIndex: public dnListIndex {
+public:
+  typedef std::multimap<KeyType, size_type> map_type;
+  typedef typename map_type::const_iterator const_iterator;
+
+  dnSortedIndex(const dtpString &keyPath): dnListIndex(keyPath) {}
+
+  virtual void clear() { m_map.clear(); }
+  virtual size_type size() const { return m_map.size(); }
+
+  virtual void addItem(const dnode &item, size_type pos) {
+    const dnode *key = findKey(item);
+    if (key != DTP_NULL)
+      m_map.insert(std::make_pair(key->getAs<KeyType>(), pos));
+  }
+
+  virtual void eraseItem(const dnode &item, size_type pos, bool shift) {
+    const dnode *key = findKey(item);
+    if (key != DTP_NULL) {
+      std::pair<typename map_type::iterator, typename map_type::iterator> range = m_map.equal_range(key->getAs<KeyType>());
+      for(typename map_type::iterator it = range.first; it != range.second; ++it)
+        if (it->second == pos) {
+          m_map.erase(it);
+          break;
+        }
+    }
+    if (shift)
+      for(typename map_type::iterator it = m_map.begin(), epos = m_map.end(); it != epos; ++it)
+        shiftPositions(it->second, pos);
+  }
+
+  /// Returns position of first item with a given key or dnode::npos
+  size_type find(const KeyType &key) const {
+    std::pair<const_iterator, const_iterator> range = m_map.equal_range(key);
+    size_type res = dnode::npos;
+    for(const_iterator it = range.first; it != range.second; ++it)
+      if ((res == dnode::npos) || (it->second < res))
+        res = it->second;
+    return res;
+  }
+
+  /// Appends positions of all items with a given key to output (ascending)
+  void findAll(const KeyType &key, std::vector<size_type> &output) const {
+    std::pair<const_iterator, const_iterator> range = m_map.equal_range(key);
+    const size_t start = output.size();
+    for(const_iterator it = range.first; it != range.second; ++it)
+      output.push_back(it->second);
+    std::sort(output.begin() + start, output.end());
+  }
+
+  /// Appends positions of items with first <= key < last to output, in key order
+  void findRange(const KeyType &first, const KeyType &last, std::vector<size_type> &output) const {
+    for(const_iterator it = m_map.lower_bound(first), epos = m_map.lower_bound(last); it != epos; ++it)
+      output.push_back(it->second);
+  }
+
+  size_type count(const KeyType &key) const { return m_map.count(key); }
+  bool contains(const KeyType &key) const { return (m_map.find(key) != m_map.end()); }
+
+  /// Iteration in key order: it->first is key, it->second item position
+  const_iterator begin() const { return m_map.begin(); }
+  const_iterator end() const { return m_map.end(); }
+  const_iterator lowerBound(const KeyType &key) const { return m_map.lower_bound(key); }
+  const_iterator upperBound(const KeyType &key) const { return m_map.upper_bound(key); }
+private:
+  map_type m_map;
+};
+
+// ----------------------------------------------------------------------------
+// dnIndexedList
+// ----------------------------------------------------------------------------
+/// List of items with attached indexes maintained on modification
+class dnIndexedList {
+public:
+  typedef dnode::size_type size_type;
+
+  dnIndexedList();
+  explicit dnIndexedList(const dnode &list);
+  ~dnIndexedList();
+
+  // -- list access --
+  const dnode &getList() const { return m_list; }
+  size_type size() const { return m_list.size(); }
+  bool empty() const { return m_list.empty(); }
+  const dnode &operator[](size_type index) const { return m_list[index]; }
+  const dnode &get(size_type index) const { return m_list[index]; }
+
+  /// Replaces contents with copy of list and rebuilds indexes
+  void setList(const dnode &list);
+  /// Exchanges contents with list (without copy) and rebuilds indexes
+  void swapList(dnode &list);
+
+  // -- modification --
+  void addItem(const dnode &item);
+  void setElement(size_type index, const dnode &item);
+  void eraseElement(size_type index);
+  void clear();
+
+  // -- indexes --
+  /// Attaches index with a given name (takes ownership) and builds it for current items
+  dnListIndex &addIndex(const dtpString &name, dnListIndex *index);
+  void removeIndex(const dtpString &name);
+  bool hasIndex(const dtpString &name) const { return (m_indexes.find(name) != m_indexes.end()); }
+  /// Returns index with a given name, throws dnError if not found
+  dnListIndex &getIndex(const dtpString &name) const;
+
+  template<typename IndexType>
+  IndexType &getIndexAs(const dtpString &name) const {
+    IndexType *res = dynamic_cast<IndexType *>(&getIndex(name));
+    if (res == DTP_NULL)
+      throw dnError("Wrong index type: " + name);
+    return *res;
+  }
+
+  /// Builds all indexes again, required after direct list modification
+  void rebuildIndexes();
+private:
+  dnIndexedList(const dnIndexedList &);
+  dnIndexedList &operator=(const dnIndexedList &);
+
+  void checkIndex(size_type index) const {
+    if (index >= m_list.size())
+      throw dnError("Index out of range: " + toString(index));
+  }
+private:
+  typedef std::map<dtpString, dnListIndex *> IndexMap;
+  dnode m_list;
+  IndexMap m_indexes;
+};
+
+} // namespace dtp
+
+#endif // _DTPDNODEINDEX_H__
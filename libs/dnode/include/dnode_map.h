@@ -898,7 +898,7 @@ template<typename KeyType, typename ValueType, typename Visitor>
   keyNodePtr = &(node[_DMAP_KEY_OFFSET]);
   valueNodePtr = &(node[_DMAP_VALUE_OFFSET]);
 
-  for(uint i = 0, epos = dmap_size<KeyType>(node); i != epos; i++)
+  for(dtp::dnode::size_type i = 0, epos = dmap_size<KeyType>(node); i != epos; i++)
   {
     key = (*keyNodePtr).get<KeyType>(i);
     value = (*valueNodePtr).get<ValueType>(i);
@@ -915,7 +915,7 @@ template<typename KeyType, typename ValueType, typename Visitor>
   KeyType key;
   ValueType value;
 
-  for(uint i = 0, epos = node.size(); i != epos; i++)
+  for(dtp::dnode::size_type i = 0, epos = node.size(); i != epos; i++)
   {
     key = node.getElementName(i);
     value = node.get<ValueType>(i);
@@ -963,7 +963,7 @@ template<typename KeyType, typename Visitor>
 
   keyNodePtr = &(node[_DMAP_KEY_OFFSET]);
 
-  for(uint i = 0, epos = dmap_size<KeyType>(node); i != epos; i++)
+  for(dtp::dnode::size_type i = 0, epos = dmap_size<KeyType>(node); i != epos; i++)
   {
     key = (*keyNodePtr).get<KeyType>(i);
     visitor(key);
@@ -976,7 +976,7 @@ template<typename KeyType, typename Visitor>
   typename dtpEnableIf<Details::dnValueMetaIsString<KeyType>, Visitor>::type
     dmap_visit_keys(const dtp::dnode &node, Visitor visitor)
 {
-  for(uint i = 0, epos = node.size(); i != epos; i++)
+  for(dtp::dnode::size_type i = 0, epos = node.size(); i != epos; i++)
   {
     visitor(node.getElementName(i));
   }
@@ -1062,7 +1062,7 @@ class DMapSortTool {
        m_values(static_cast<dnArrayBase *>(node[_DMAP_VALUE_OFFSET].getArray())),
        m_compareOp(compOp) {}
 
-    KeyType get(int pos)
+    KeyType get(dtp::dnPosType pos)
     {
       return m_keys->get<KeyType>(pos);
     }
@@ -1094,7 +1094,7 @@ class DMapSortTool<dtpString, CompareOp> {
        m_node(&node),
        m_compareOp(compOp) {}
 
-    KeyType get(int pos)
+    KeyType get(dtp::dnPosType pos)
     {
       return m_node->getElementName(pos);
     }
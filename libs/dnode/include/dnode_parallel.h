@@ -0,0 +1,130 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_parallel.h
+// Project:     dtpLib
+// Purpose:     Parallel deep copy & compare for large dnode trees
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNODEPARALLEL_H__
+#define _DTPDNODEPARALLEL_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_parallel.h
+\brief Parallel deep copy & compare for large dnode trees
+
+Parallel versions of dnode::copyFrom, dnode::copyChildrenFrom and
+dnChildColnBase::cloneChild. Children of a container are cloned on worker
+threads in index ranges, then inserted into output on the calling thread in
+source order - result is identical to the one of the sequential version.
+
+Containers smaller than dnParallelOptions::minParallelItems are processed
+sequentially, but their children are inspected (up to maxSplitDepth levels)
+so a small root with a few large branches is still split.
+
+Input tree must not be modified while function is running.
+Workers build named parents too - container pools (DATANODE_POOL_CONTAINERS)
+use mutex-guarded allocators, so this is safe.
+
+Deep compare (dnode_deep_equal) checks container kind, size, child names
+(for parents) and all items recursively. Scalars are compared with
+dnode::isEqualTo.
+
+Function list:
+- dpar_copy_from - parallel dnode::copyFrom
+- dpar_copy_children_from - parallel dnode::copyChildrenFrom
+- dpar_clone_child - parallel deep clone of a single child
+- dnode_deep_equal - sequential deep compare
+- dpar_deep_equal - parallel deep compare
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include "dtp/dnode.h"
+
+namespace dtp {
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+const uint DPAR_DEF_MIN_ITEMS = 256;
+const uint DPAR_DEF_MAX_SPLIT_DEPTH = 4;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+
+/// Unit of work executed by dnThreadPool
+class dnParallelTask {
+public:
+  virtual ~dnParallelTask() {}
+  virtual void run() = 0;
+};
+
+namespace Details {
+class dnThreadPoolImpl;
+}
+
+/// Fixed-size pool of worker threads.
+/// execute() blocks until all tasks are finished. Calling thread takes part
+/// in execution, so execute() can be called from inside of a task.
+class dnThreadPool {
+public:
+  /// @param[in] threadCount number of worker threads, 0 = hardware concurrency - 1
+  dnThreadPool(uint threadCount = 0);
+  virtual ~dnThreadPool();
+
+  /// Returns number of threads executing tasks (workers + calling thread)
+  uint getConcurrency() const;
+
+  /// Executes tasks and waits for all of them.
+  /// First exception thrown by a task is rethrown (as dnError if not std::bad_alloc).
+  void execute(dnParallelTask **tasks, size_t count);
+
+  /// Returns shared pool, created on first use
+  static dnThreadPool &getDefault();
+private:
+  dnThreadPool(const dnThreadPool &);
+  dnThreadPool &operator=(const dnThreadPool &);
+private:
+  Details::dnThreadPoolImpl *m_impl;
+};
+
+/// Options of parallel functions
+struct dnParallelOptions {
+  /// Minimal number of container items for parallel processing
+  uint minParallelItems;
+  /// Maximal depth searched for large containers below a small one
+  uint maxSplitDepth;
+  /// Pool to be used, NULL = dnThreadPool::getDefault()
+  dnThreadPool *pool;
+
+  dnParallelOptions(): minParallelItems(DPAR_DEF_MIN_ITEMS), maxSplitDepth(DPAR_DEF_MAX_SPLIT_DEPTH), pool(DTP_NULL) {}
+};
+
+// ----------------------------------------------------------------------------
+// Function definitions
+// ----------------------------------------------------------------------------
+
+/// Replaces value of output with a deep copy of input (as dnode::copyFrom).
+void dpar_copy_from(dnode &output, const dnode &input, const dnParallelOptions &options = dnParallelOptions());
+
+/// Appends deep copies of input children to output (as dnode::copyChildrenFrom).
+void dpar_copy_children_from(dnode &output, const dnode &input, const dnParallelOptions &options = dnParallelOptions());
+
+/// Returns deep copy of input child (as dnChildColnBase::cloneChild), caller owns result.
+dnode *dpar_clone_child(const dnode &input, dnPosType index, const dnParallelOptions &options = dnParallelOptions());
+
+/// Returns true if both nodes have the same structure, names and values.
+bool dnode_deep_equal(const dnode &lhs, const dnode &rhs);
+
+/// Parallel version of dnode_deep_equal, stops as soon as difference is found.
+bool dpar_deep_equal(const dnode &lhs, const dnode &rhs, const dnParallelOptions &options = dnParallelOptions());
+
+} // namespace dtp
+
+#endif // _DTPDNODEPARALLEL_H__
@@ -0,0 +1,161 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_persist.h
+// Project:     dtpLib
+// Purpose:     Persistent data node tree stored in memory-mapped file
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNODEPERSIST_H__
+#define _DTPDNODEPERSIST_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_persist.h
+\brief Persistent data node tree stored in memory-mapped file
+
+dnPersistentStore keeps dnode tree in a file mapped read-write into memory.
+Nodes use DNV record layout (see dnode_view.h) - all links are offsets from
+file start, so file is usable directly after mapping (open does not read the tree)
+and getRoot() returns zero-copy dnodeView.
+
+File layout ("DNP"):
+\verbatim
+  header:  magic "DNP1", byte order mark (uint), version (uint), sizeof(xdouble) (uint),
+           reserved (uint64), two commit slots
+  slot:    sequence, root offset, heap end, free table offset, free table size, checksum (uint64 each)
+  heap:    DNV records, strings and tables, each one in separate block aligned to 8 bytes
+\endverbatim
+
+Commit points:
+- commit() writes data (msync), then the older slot with next sequence number, then header (msync)
+- on open the valid slot with highest sequence is used, so crash at any time
+  leaves store at last completed commit point
+- blocks referenced by last commit point are never overwritten: update of such block
+  writes a copy (and copies of its parents up to root), blocks written after last
+  commit are updated in place
+- rollback() returns to last commit point, close() without commit() discards changes
+
+Allocator:
+- best-fit free list with block split, file grows by doubling
+- blocks released after commit point become reusable after next commit()
+- free list is saved with commit point
+- compact() rewrites live tree to "<file>.part" and replaces file by rename
+
+Paths: "name1/name2/3" - each item is child name or index (see dnodeView::getElementByPath).
+
+Example:
+\code
+  dnPersistentStore store("data.dnp");
+  store.setElement("config", config);
+  store.addChild("", "count", dnode(12));
+  store.commit();
+
+  dnodeView item;
+  if (store.getElementByPath("config/items/0", item))
+    std::cout << item.getStringRef().str();
+\endcode
+
+Views returned by store are valid until next modification or close.
+Class is not thread-safe.
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include "dtp/dnode.h"
+#include "dtp/dnode_view.h"
+
+namespace dtp {
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+const uint DNPERSIST_VERSION = 1;
+const uint64 DNPERSIST_MIN_FILE_SIZE = 64 * 1024;
+const char *const DNPERSIST_PART_EXT = ".part";
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+class dnPersistFormatError: public dnError {
+public:
+  dnPersistFormatError(const std::string &msg): dnError("Invalid persistent store: " + msg) {}
+};
+
+// ----------------------------------------------------------------------------
+// dnPersistentStore
+// ----------------------------------------------------------------------------
+class dnPersistentStore {
+public:
+  dnPersistentStore();
+  /// Opens existing store or creates a new one with null root
+  explicit dnPersistentStore(const dtpString &fileName);
+  /// Closes store, uncommitted changes are discarded
+  ~dnPersistentStore();
+
+  /// Opens existing store or creates a new one with null root.
+  /// Throws dnPersistFormatError if file is not a valid store.
+  void open(const dtpString &fileName);
+  /// Closes store, uncommitted changes are discarded
+  void close();
+  bool isOpen() const;
+  const dtpString &getFileName() const;
+
+  // -- read access --
+  /// Returns view of root node, valid until next modification
+  dnodeView getRoot() const;
+  /// Returns false if element not found
+  bool getElementByPath(const dtpString &path, dnodeView &output) const;
+  /// Creates dnode copy of tree
+  void load(dnode &output) const;
+
+  // -- modification --
+  /// Replaces whole tree
+  void setRoot(const dnode &value);
+  /// Replaces element at path, adds named child if last path item is missing.
+  /// For arrays value is converted to item type.
+  void setElement(const dtpString &path, const dnode &value);
+  /// Appends item to list, parent (without name) or array at path
+  void addItem(const dtpString &path, const dnode &value);
+  /// Appends named child to parent at path
+  void addChild(const dtpString &path, const dtpString &name, const dnode &value);
+  /// Removes element at path from its container
+  void eraseElement(const dtpString &path);
+
+  // -- commit points --
+  /// Makes current state durable, no-op if there are no changes
+  void commit();
+  /// Returns to state of last commit point
+  void rollback();
+  /// Writes modified pages to disk without creating commit point
+  void flush();
+  /// Commits changes and rewrites file without unused space
+  void compact();
+
+  // -- properties --
+  bool isModified() const;
+  /// Returns sequence number of last commit point
+  uint64 getSequence() const;
+  /// Returns size of used part of file
+  uint64 getDataSize() const;
+  /// Returns size of blocks available for reuse
+  uint64 getFreeSize() const;
+  uint64 getFileSize() const;
+
+private:
+  dnPersistentStore(const dnPersistentStore &);
+  dnPersistentStore &operator=(const dnPersistentStore &);
+
+  void checkOpen() const;
+  static dnodeView makeView(const void *base, dnViewOffset recordOffset);
+private:
+  struct Impl;
+  Impl *m_impl;
+};
+
+} // namespace dtp
+
+#endif // _DTPDNODEPERSIST_H__
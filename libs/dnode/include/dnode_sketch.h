@@ -0,0 +1,386 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_sketch.h
+// Project:     dtpLib
+// Purpose:     Streaming quantile, histogram & distinct count sketches
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNODESKETCH_H__
+#define _DTPDNODESKETCH_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_sketch.h
+\brief Streaming quantile, histogram & distinct count sketches
+
+Sketches summarize a stream of values in bounded memory, without sorting
+or storing the values:
+- dnQuantileSketch - t-digest, approximate quantiles & CDF, most accurate
+  near both ends (p1, p99, p99.9)
+- dnHistogram - fixed-width buckets over [min, max] + underflow & overflow
+- dnLogHistogram - logarithmic buckets with bounded relative error,
+  also returns approximate quantiles
+- dnDistinctCounter - HyperLogLog approximate count of distinct values
+
+All sketches are mergeable: sketches of shards (threads, files, processes)
+can be combined with merge(). State can be stored in a dnode with toNode()
+and restored with fromNode(), so partial sketches can be transferred using
+any dnode serializer. NaN values are ignored.
+
+Sketches can be fed with single values, iterator ranges, dnode containers
+(dsketch_add_array) or columns of delimited text (dsketch_add_csv_column).
+Distinct counter hashes numbers by value and text fields by their content.
+
+Sketch objects are not thread-safe, use one sketch per thread and merge.
+
+Example:
+\code
+  dnQuantileSketch latency;
+  dsketch_add_array(samples, latency);
+  double p99 = latency.quantile(0.99);
+\endcode
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include <vector>
+#include <map>
+#include <istream>
+
+#include "dtp/dnode.h"
+#include "dtp/dnode_split.h"
+
+namespace dtp {
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+const double DSKETCH_DEF_COMPRESSION = 100.0;
+const double DSKETCH_DEF_RELATIVE_ACCURACY = 0.01;
+const uint DSKETCH_DEF_DISTINCT_PRECISION = 12;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+
+// ----------------------------------------------------------------------------
+// dnQuantileSketch
+// ----------------------------------------------------------------------------
+/// Merging t-digest. Values are buffered and merged into centroids, size of
+/// centroid is limited by arcsine scale function, so there are more (smaller)
+/// centroids near the ends of distribution.
+class dnQuantileSketch {
+public:
+  /// @param[in] compression number of centroids is approx. compression * 1.6
+  dnQuantileSketch(double compression = DSKETCH_DEF_COMPRESSION);
+
+  void clear();
+  void add(double value);
+  template<typename InputIterator>
+  void add(InputIterator first, InputIterator last) {
+    for(; first != last; ++first)
+      add(static_cast<double>(*first));
+  }
+  void merge(const dnQuantileSketch &other);
+
+  bool empty() const { return m_count == 0; }
+  uint64 count() const { return m_count; }
+  double getCompression() const { return m_compression; }
+  double minValue() const { return m_min; }
+  double maxValue() const { return m_max; }
+
+  /// Returns approximate value at quantile q (0..1), 0 for empty sketch
+  double quantile(double q) const;
+  /// Returns approximate fraction of values lower or equal to value
+  double cdf(double value) const;
+  /// Returns number of centroids (after merging buffered values)
+  size_t getCentroidCount() const;
+
+  void toNode(dnode &output) const;
+  void fromNode(const dnode &input);
+protected:
+  struct Centroid {
+    double mean;
+    double weight;
+
+    Centroid() {}
+    Centroid(double aMean, double aWeight): mean(aMean), weight(aWeight) {}
+    bool operator<(const Centroid &rhs) const { return mean < rhs.mean; }
+  };
+
+  /// Merges buffered values into centroids
+  void flush() const;
+  double scale(double q) const;
+private:
+  double m_compression;
+  size_t m_bufferLimit;
+  uint64 m_count;
+  double m_min;
+  double m_max;
+  mutable std::vector<Centroid> m_centroids;
+  mutable std::vector<Centroid> m_buffer;
+  mutable std::vector<Centroid> m_work;
+};
+
+// ----------------------------------------------------------------------------
+// dnHistogramBucket
+// ----------------------------------------------------------------------------
+/// Range [lower, upper) of histogram & number of values in it
+struct dnHistogramBucket {
+  double lower;
+  double upper;
+  uint64 count;
+
+  dnHistogramBucket(): lower(0.0), upper(0.0), count(0) {}
+  dnHistogramBucket(double aLower, double aUpper, uint64 aCount): lower(aLower), upper(aUpper), count(aCount) {}
+};
+
+// ----------------------------------------------------------------------------
+// dnHistogram
+// ----------------------------------------------------------------------------
+/// Histogram with buckets of equal width. Max value is counted in the last
+/// bucket, values outside of [min, max] are counted as underflow & overflow.
+class dnHistogram {
+public:
+  dnHistogram(double minValue, double maxValue, uint bucketCount);
+
+  void clear();
+  void add(double value);
+  template<typename InputIterator>
+  void add(InputIterator first, InputIterator last) {
+    for(; first != last; ++first)
+      add(static_cast<double>(*first));
+  }
+  /// Adds counts of other histogram, throws dnError if bucket layout differs
+  void merge(const dnHistogram &other);
+
+  uint64 count() const { return m_count; }
+  uint getBucketCount() const { return static_cast<uint>(m_counts.size()); }
+  uint64 getBucketValue(uint index) const { return m_counts[index]; }
+  dnHistogramBucket getBucket(uint index) const;
+  void getBuckets(std::vector<dnHistogramBucket> &output) const;
+  uint64 getUnderflow() const { return m_underflow; }
+  uint64 getOverflow() const { return m_overflow; }
+
+  void toNode(dnode &output) const;
+  void fromNode(const dnode &input);
+private:
+  double m_min;
+  double m_max;
+  double m_scale;
+  uint64 m_count;
+  uint64 m_underflow;
+  uint64 m_overflow;
+  std::vector<uint64> m_counts;
+};
+
+// ----------------------------------------------------------------------------
+// dnLogHistogram
+// ----------------------------------------------------------------------------
+/// Histogram with bucket bounds growing geometrically, bucket i covers
+/// (gamma^(i-1), gamma^i] where gamma = (1 + accuracy) / (1 - accuracy).
+/// Negative values use mirrored buckets, zero has its own counter.
+/// Only non-empty buckets are stored.
+class dnLogHistogram {
+public:
+  /// @param[in] relativeAccuracy maximal relative error of quantile, (0, 1)
+  dnLogHistogram(double relativeAccuracy = DSKETCH_DEF_RELATIVE_ACCURACY);
+
+  void clear();
+  void add(double value);
+  template<typename InputIterator>
+  void add(InputIterator first, InputIterator last) {
+    for(; first != last; ++first)
+      add(static_cast<double>(*first));
+  }
+  /// Adds counts of other histogram, throws dnError if accuracy differs
+  void merge(const dnLogHistogram &other);
+
+  bool empty() const { return m_count == 0; }
+  uint64 count() const { return m_count; }
+  double getRelativeAccuracy() const { return m_accuracy; }
+  /// Returns approximate value at quantile q (0..1), 0 for empty histogram
+  double quantile(double q) const;
+  /// Returns non-empty buckets in ascending order
+  void getBuckets(std::vector<dnHistogramBucket> &output) const;
+
+  void toNode(dnode &output) const;
+  void fromNode(const dnode &input);
+protected:
+  typedef std::map<int, uint64> bucket_map;
+
+  void init(double relativeAccuracy);
+  int bucketIndex(double absValue) const;
+  double bucketUpper(int index) const;
+  double bucketValue(int index) const;
+private:
+  double m_accuracy;
+  double m_gamma;
+  double m_logGamma;
+  uint64 m_count;
+  uint64 m_zeroCount;
+  bucket_map m_positive;
+  bucket_map m_negative;
+};
+
+// ----------------------------------------------------------------------------
+// dnDistinctCounter
+// ----------------------------------------------------------------------------
+/// HyperLogLog distinct counter, uses 2^precision one-byte registers.
+/// Standard error is approx. 1.04 / sqrt(2^precision) (1.6% for precision 12).
+class dnDistinctCounter {
+public:
+  /// @param[in] precision 4..18
+  dnDistinctCounter(uint precision = DSKETCH_DEF_DISTINCT_PRECISION);
+
+  void clear();
+  /// Adds number (hashed by value, 1 and 1.0 are the same)
+  void add(double value);
+  /// Adds text (hashed by content)
+  void add(const dnStringRef &text);
+  template<typename InputIterator>
+  void add(InputIterator first, InputIterator last) {
+    for(; first != last; ++first)
+      add(*first);
+  }
+  /// Adds already hashed value, hash must be uniformly distributed
+  void addHash(uint64 hash);
+  /// Combines registers, throws dnError if precision differs
+  void merge(const dnDistinctCounter &other);
+
+  uint getPrecision() const { return m_precision; }
+  /// Returns estimated number of distinct values
+  double estimate() const;
+
+  void toNode(dnode &output) const;
+  void fromNode(const dnode &input);
+protected:
+  void init(uint precision);
+private:
+  uint m_precision;
+  std::vector<byte> m_registers;
+};
+
+namespace Details {
+
+template<class Sketch>
+inline void dnSketchAddNode(const dnode &item, Sketch &output)
+{
+  output.add(item.getAs<double>());
+}
+
+inline void dnSketchAddNode(const dnode &item, dnDistinctCounter &output)
+{
+  if (item.getValueType() == vt_string)
+    output.add(dnStringRef(item.getAsString()));
+  else
+    output.add(item.getAs<double>());
+}
+
+template<class Sketch>
+inline void dnSketchAddField(const dnStringRef &field, Sketch &output)
+{
+  output.add(dstr_to_double(field));
+}
+
+inline void dnSketchAddField(const dnStringRef &field, dnDistinctCounter &output)
+{
+  output.add(field);
+}
+
+template<typename T, class Sketch>
+void dnSketchAddPod(const dnArray *arr, Sketch &output)
+{
+  const std::vector<T> &items = checked_cast<const dnArrayOfPod<T> *>(arr)->getItems();
+  output.add(items.begin(), items.end());
+}
+
+/// Selects field of a given index from delimited line
+class dnSketchFieldPicker {
+public:
+  dnSketchFieldPicker(size_t columnIndex): m_columnIndex(columnIndex), m_index(0), m_found(false) {}
+
+  void reset() { m_index = 0; m_found = false; }
+  void operator()(const dnStringRef &field) {
+    if (m_index++ == m_columnIndex) {
+      m_field = field;
+      m_found = true;
+    }
+  }
+  bool found() const { return m_found; }
+  const dnStringRef &getField() const { return m_field; }
+private:
+  size_t m_columnIndex;
+  size_t m_index;
+  bool m_found;
+  dnStringRef m_field;
+};
+
+} // namespace Details
+
+// ----------------------------------------------------------------------------
+// Function definitions
+// ----------------------------------------------------------------------------
+
+/// Adds non-null items of container to sketch, arrays of numbers are read directly
+template<class Sketch>
+void dsketch_add_array(const dnode &input, Sketch &output)
+{
+  using namespace Details;
+
+  if (!input.isContainer())
+    throw dnError("Container expected as sketch input");
+
+  if (input.isArray()) {
+    const dnArray *arr = input.getArrayR();
+    switch (arr->getValueType()) {
+      case vt_byte: dnSketchAddPod<byte>(arr, output); return;
+      case vt_int: dnSketchAddPod<int>(arr, output); return;
+      case vt_uint: dnSketchAddPod<uint>(arr, output); return;
+      case vt_float: dnSketchAddPod<float>(arr, output); return;
+      case vt_double: dnSketchAddPod<double>(arr, output); return;
+      case vt_xdouble: dnSketchAddPod<xdouble>(arr, output); return;
+      default: break;
+    }
+  }
+
+  dnode helper;
+  for(dnode::size_type i=0, epos = input.size(); i != epos; i++) {
+    const dnode *item = input.getNodePtrR(i, helper);
+    if (!item->isNull())
+      dnSketchAddNode(*item, output);
+  }
+}
+
+/// Adds values of column from delimited text (one record per line, no quoting).
+/// Lines without column & blank fields are skipped, invalid number throws dnError.
+/// @param[in] skipHeader if true, first line is skipped
+template<class Sketch>
+void dsketch_add_csv_column(std::istream &input, size_t columnIndex, const dnSplitSeparator &separator,
+  Sketch &output, bool skipHeader = false)
+{
+  Details::dnSketchFieldPicker picker(columnIndex);
+  dtpString line;
+
+  if (skipHeader)
+    std::getline(input, line);
+
+  dnStringRef field;
+  while (std::getline(input, line)) {
+    picker.reset();
+    dstr_for_each_field(dnStringRef(line), separator, picker);
+    if (!picker.found())
+      continue;
+    field = dstr_trim(picker.getField());
+    if (!field.empty())
+      Details::dnSketchAddField(field, output);
+  }
+}
+
+} // namespace dtp
+
+#endif // _DTPDNODESKETCH_H__
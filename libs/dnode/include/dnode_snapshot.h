@@ -0,0 +1,269 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_snapshot.h
+// Project:     dtpLib
+// Purpose:     Versioned dnode state with lock-free readers
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNODESNAPSHOT_H__
+#define _DTPDNODESNAPSHOT_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_snapshot.h
+\brief Versioned dnode state with lock-free readers
+
+Read-copy-update holder for state tree updated by a single writer and read
+by many threads.
+
+State is a set of named branches (top-level nodes). Each published version
+(dnodeSnapshotVersion) is immutable. Writer prepares next version with
+dnodeSnapshotWriter - only branches which are modified are copied, all other
+branches are shared with previous version. New version is published with
+a single atomic pointer exchange.
+
+Reader threads use own dnodeSnapshotReader. Pinning current version costs
+two atomic operations, there is no lock and no reference counting on read
+path, so read latency does not depend on write load.
+
+Old versions are reclaimed using epochs: each publish advances global epoch,
+replaced version is retired with epoch of its replacement and released when
+all pinned readers have newer epoch. Reclamation is performed by writer
+(on publish and in dnodeSnapshot::reclaim).
+
+Rules:
+- only one dnodeSnapshotWriter can exist at a time
+- dnodeSnapshotReader must not be shared between threads
+- nodes returned by pinned version are valid until unpin(), use
+  dnodeSnapshotVersion::getBranchPtr() to keep a branch longer
+- all readers and writer must be destroyed before dnodeSnapshot
+
+Example:
+\code
+  dnodeSnapshot state;
+
+  // writer thread
+  dnodeSnapshotWriter writer(state);
+  writer.modify("config").setElement("limit", dnode(10));
+  writer.publish();
+
+  // reader thread
+  dnodeSnapshotReader reader(state);
+  {
+    dnodeSnapshotGuard guard(reader);
+    int limit = guard->get("config").get<int>("limit");
+  }
+\endcode
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include <vector>
+#include <map>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "dtp/dnode.h"
+
+namespace dtp {
+
+// ----------------------------------------------------------------------------
+// Forward declarations
+// ----------------------------------------------------------------------------
+class dnodeSnapshot;
+class dnodeSnapshotWriter;
+
+namespace Details {
+struct dnSnapshotReaderSlot;
+}
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+
+// ----------------------------------------------------------------------------
+// dnodeSnapshotVersion
+// ----------------------------------------------------------------------------
+/// Immutable, published state version
+class dnodeSnapshotVersion {
+public:
+  typedef uint size_type;
+  typedef boost::shared_ptr<const dnode> branch_ptr;
+  static const size_type npos;
+
+  /// Returns version number, first published version is 1
+  uint64 getVersion() const { return m_version; }
+  size_type size() const { return static_cast<size_type>(m_branches.size()); }
+  bool empty() const { return m_branches.empty(); }
+
+  const dtpString &getName(size_type index) const { return m_names[index]; }
+  const dnode &at(size_type index) const { return *m_branches[index]; }
+  /// Returns shared pointer to branch, can be used after version is unpinned
+  branch_ptr getBranchPtr(size_type index) const { return m_branches[index]; }
+
+  size_type indexOfName(const dtpString &name) const;
+  bool hasBranch(const dtpString &name) const { return indexOfName(name) != npos; }
+  /// Returns branch with a given name, throws dnError if it does not exist
+  const dnode &get(const dtpString &name) const;
+
+  /// Builds parent node with deep copies of all branches
+  void copyTo(dnode &output) const;
+protected:
+  friend class dnodeSnapshot;
+  friend class dnodeSnapshotWriter;
+
+  dnodeSnapshotVersion(): m_version(0), m_retireEpoch(0) {}
+  void rebuildIndex();
+private:
+  typedef std::map<dtpString, size_type> name_index;
+
+  uint64 m_version;
+  uint64 m_retireEpoch;
+  std::vector<dtpString> m_names;
+  std::vector<branch_ptr> m_branches;
+  name_index m_index;
+};
+
+// ----------------------------------------------------------------------------
+// dnodeSnapshot
+// ----------------------------------------------------------------------------
+/// Holder of current state version
+class dnodeSnapshot {
+public:
+  dnodeSnapshot();
+  virtual ~dnodeSnapshot();
+
+  /// Returns number of current version, 0 = nothing published yet
+  uint64 getVersion() const;
+  /// Returns number of replaced versions which are not released yet
+  size_t getRetiredCount() const;
+  /// Releases retired versions not used by readers, to be called by writer thread
+  void reclaim();
+protected:
+  friend class dnodeSnapshotReader;
+  friend class dnodeSnapshotWriter;
+
+  const dnodeSnapshotVersion &pin(Details::dnSnapshotReaderSlot &slot) const;
+  void unpin(Details::dnSnapshotReaderSlot &slot) const;
+  void addReader(Details::dnSnapshotReaderSlot *slot);
+  void removeReader(Details::dnSnapshotReaderSlot *slot);
+  void beginWrite();
+  void endWrite();
+  /// Replaces current version, takes ownership of version
+  void publish(dnodeSnapshotVersion *version);
+  const dnodeSnapshotVersion &getCurrentForWriter() const { return *m_current.load(boost::memory_order_acquire); }
+  uint64 getMinReaderEpoch();
+private:
+  dnodeSnapshot(const dnodeSnapshot &);
+  dnodeSnapshot &operator=(const dnodeSnapshot &);
+private:
+  boost::atomic<dnodeSnapshotVersion *> m_current;
+  boost::atomic<uint64> m_epoch;
+  boost::atomic<bool> m_writerActive;
+  boost::mutex m_readersMutex;
+  std::vector<Details::dnSnapshotReaderSlot *> m_readers;
+  std::vector<dnodeSnapshotVersion *> m_retired; /// accessed by writer only
+  boost::atomic<size_t> m_retiredCount;
+};
+
+// ----------------------------------------------------------------------------
+// dnodeSnapshotReader
+// ----------------------------------------------------------------------------
+/// Per-thread reader of snapshot. Registration (constructor & destructor)
+/// is synchronized, pin() & unpin() are lock-free.
+class dnodeSnapshotReader {
+public:
+  dnodeSnapshotReader(dnodeSnapshot &snapshot);
+  virtual ~dnodeSnapshotReader();
+
+  /// Pins current version, nested calls return the same version
+  const dnodeSnapshotVersion &pin();
+  /// Releases version pinned by matching pin()
+  void unpin();
+  bool isPinned() const { return m_pinCount > 0; }
+private:
+  dnodeSnapshotReader(const dnodeSnapshotReader &);
+  dnodeSnapshotReader &operator=(const dnodeSnapshotReader &);
+private:
+  dnodeSnapshot &m_snapshot;
+  Details::dnSnapshotReaderSlot *m_slot;
+  const dnodeSnapshotVersion *m_pinned;
+  uint m_pinCount;
+};
+
+// ----------------------------------------------------------------------------
+// dnodeSnapshotGuard
+// ----------------------------------------------------------------------------
+/// Keeps version pinned in scope
+class dnodeSnapshotGuard {
+public:
+  dnodeSnapshotGuard(dnodeSnapshotReader &reader): m_reader(reader), m_version(reader.pin()) {}
+  ~dnodeSnapshotGuard() { m_reader.unpin(); }
+
+  const dnodeSnapshotVersion &version() const { return m_version; }
+  const dnodeSnapshotVersion *operator->() const { return &m_version; }
+private:
+  dnodeSnapshotGuard(const dnodeSnapshotGuard &);
+  dnodeSnapshotGuard &operator=(const dnodeSnapshotGuard &);
+private:
+  dnodeSnapshotReader &m_reader;
+  const dnodeSnapshotVersion &m_version;
+};
+
+// ----------------------------------------------------------------------------
+// dnodeSnapshotWriter
+// ----------------------------------------------------------------------------
+/// Prepares & publishes new versions. Draft starts as a copy of current
+/// version (sharing all branches), branch is deep-copied on first modify().
+class dnodeSnapshotWriter {
+public:
+  typedef dnodeSnapshotVersion::size_type size_type;
+
+  /// Throws dnError if another writer exists
+  dnodeSnapshotWriter(dnodeSnapshot &snapshot);
+  virtual ~dnodeSnapshotWriter();
+
+  /// Returns branch for modification (copy of published branch)
+  /// Throws dnError if branch does not exist.
+  dnode &modify(const dtpString &name);
+  /// Adds or replaces branch, takes ownership of value
+  void setBranch(const dtpString &name, dnode *value);
+  /// Adds or replaces branch with a copy of value
+  void setBranch(const dtpString &name, const dnode &value);
+  void eraseBranch(const dtpString &name);
+
+  size_type size() const { return static_cast<size_type>(m_names.size()); }
+  bool hasBranch(const dtpString &name) const { return indexOfName(name) != dnodeSnapshotVersion::npos; }
+  /// Returns draft branch for reading (does not copy it)
+  const dnode &get(const dtpString &name) const;
+  /// Returns true if draft differs from published version
+  bool isModified() const { return m_modified; }
+
+  /// Publishes draft as new version, returns its number.
+  /// Draft is kept as a base for next changes.
+  uint64 publish();
+  /// Resets draft to current version
+  void discard();
+protected:
+  size_type indexOfName(const dtpString &name) const;
+  size_type findOrAdd(const dtpString &name);
+private:
+  dnodeSnapshotWriter(const dnodeSnapshotWriter &);
+  dnodeSnapshotWriter &operator=(const dnodeSnapshotWriter &);
+private:
+  dnodeSnapshot &m_snapshot;
+  std::vector<dtpString> m_names;
+  std::vector<dnodeSnapshotVersion::branch_ptr> m_branches;
+  std::vector<boost::shared_ptr<dnode> > m_private; /// branches copied in this draft
+  bool m_modified;
+};
+
+} // namespace dtp
+
+#endif // _DTPDNODESNAPSHOT_H__
@@ -0,0 +1,386 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_sparse.h
+// Project:     dtpLib
+// Purpose:     Sparse array of scalar values with default value
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNODESPARSE_H__
+#define _DTPDNODESPARSE_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_sparse.h
+\brief Sparse array of scalar values with default value
+
+dnSparseArray keeps only items with value different from default one.
+Index space is divided into chunks of DSPARSE_CHUNK_SIZE items, each chunk
+with at least one item stores sorted 16-bit offsets & values in two vectors.
+Chunks are kept in a map ordered by first index, so:
+- get / set use two binary searches (chunk & offset)
+- appending items in index order is amortized O(1)
+- iteration visits non-default items only, in index order
+- reductions (sum, min, max, visitValues) run over contiguous value
+  vectors and add default value for all empty ranges at once
+
+Setting an item to default value removes it from storage.
+
+Conversion:
+- fromArray / toArray - from / to dense dnode array
+- fromNode / toNode - stored as parent node with fields:
+  size, default, index (uint64 array), value (array)
+
+Example:
+\code
+  dnSparseArray<double> readings(1000000, 0.0);
+  readings.set(12, 1.5);
+  readings.set(500000, 2.5);
+  double total = readings.sum(0.0);
+  for(dnSparseArray<double>::const_iterator it = readings.begin(), epos = readings.end(); it != epos; ++it)
+    process(it.index(), it.value());
+\endcode
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "dtp/dnode.h"
+
+namespace dtp {
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+/// Number of indices covered by one chunk, offsets inside chunk are 16-bit
+const uint DSPARSE_CHUNK_SIZE = 4096;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+
+// ----------------------------------------------------------------------------
+// dnSparseArray
+// ----------------------------------------------------------------------------
+template<typename ValueType>
+class dnSparseArray {
+public:
+  typedef dnode::size_type size_type;
+  typedef ValueType value_type;
+  typedef unsigned short offset_type;
+
+  /// Non-default items of one chunk
+  struct Chunk {
+    std::vector<offset_type> offsets;
+    std::vector<ValueType> values;
+  };
+
+  typedef std::map<size_type, Chunk> chunk_map;
+
+  /// Iterates over non-default items in index order
+  class const_iterator {
+  public:
+    const_iterator(): m_pos(0) {}
+    const_iterator(typename chunk_map::const_iterator chunk, size_type pos): m_chunk(chunk), m_pos(pos) {}
+
+    size_type index() const { return m_chunk->first + m_chunk->second.offsets[m_pos]; }
+    const ValueType &value() const { return m_chunk->second.values[m_pos]; }
+
+    const_iterator &operator++() {
+      ++m_pos;
+      if (m_pos == m_chunk->second.values.size()) {
+        ++m_chunk;
+        m_pos = 0;
+      }
+      return *this;
+    }
+
+    bool operator==(const const_iterator &rhs) const { return (m_chunk == rhs.m_chunk) && (m_pos == rhs.m_pos); }
+    bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+  private:
+    typename chunk_map::const_iterator m_chunk;
+    size_type m_pos;
+  };
+
+  dnSparseArray(size_type size = 0, const ValueType &defaultValue = ValueType()):
+    m_size(size), m_count(0), m_default(defaultValue) {}
+
+  size_type size() const { return m_size; }
+  /// Changes number of items, items at or after newSize are removed
+  void resize(size_type newSize) {
+    if (newSize < m_size)
+      eraseFrom(newSize);
+    m_size = newSize;
+  }
+
+  const ValueType &defaultValue() const { return m_default; }
+  /// Number of stored (non-default) items
+  size_type nonDefaultCount() const { return m_count; }
+  size_type chunkCount() const { return static_cast<size_type>(m_chunks.size()); }
+
+  /// Removes all stored items, size is not changed
+  void clear() {
+    m_chunks.clear();
+    m_count = 0;
+  }
+
+  ValueType get(size_type index) const {
+    checkIndex(index);
+    typename chunk_map::const_iterator chunk = m_chunks.find(chunkBase(index));
+    if (chunk == m_chunks.end())
+      return m_default;
+    const std::vector<offset_type> &offsets = chunk->second.offsets;
+    offset_type offset = static_cast<offset_type>(index - chunk->first);
+    typename std::vector<offset_type>::const_iterator it = std::lower_bound(offsets.begin(), offsets.end(), offset);
+    if ((it == offsets.end()) || (*it != offset))
+      return m_default;
+    return chunk->second.values[it - offsets.begin()];
+  }
+
+  void set(size_type index, const ValueType &value) {
+    checkIndex(index);
+    if (value == m_default)
+      reset(index);
+    else
+      intSet(index, value);
+  }
+
+  /// Restores default value of item
+  void reset(size_type index) {
+    checkIndex(index);
+    typename chunk_map::iterator chunk = m_chunks.find(chunkBase(index));
+    if (chunk == m_chunks.end())
+      return;
+    Chunk &items = chunk->second;
+    offset_type offset = static_cast<offset_type>(index - chunk->first);
+    typename std::vector<offset_type>::iterator it = std::lower_bound(items.offsets.begin(), items.offsets.end(), offset);
+    if ((it == items.offsets.end()) || (*it != offset))
+      return;
+    items.values.erase(items.values.begin() + (it - items.offsets.begin()));
+    items.offsets.erase(it);
+    m_count--;
+    if (items.values.empty())
+      m_chunks.erase(chunk);
+  }
+
+  const_iterator begin() const { return const_iterator(m_chunks.begin(), 0); }
+  const_iterator end() const { return const_iterator(m_chunks.end(), 0); }
+
+  /// Calls visitor for each non-default value, in index order
+  template<typename Visitor>
+  Visitor visitValues(Visitor visitor) const {
+    for(typename chunk_map::const_iterator it = m_chunks.begin(), epos = m_chunks.end(); it != epos; ++it)
+      visitor = std::for_each(it->second.values.begin(), it->second.values.end(), visitor);
+    return visitor;
+  }
+
+  /// Sum of all items, including default ones
+  template<typename ResultType>
+  ResultType sum(ResultType init) const {
+    for(typename chunk_map::const_iterator it = m_chunks.begin(), epos = m_chunks.end(); it != epos; ++it) {
+      const std::vector<ValueType> &values = it->second.values;
+      for(size_type i=0, cnt = static_cast<size_type>(values.size()); i != cnt; i++)
+        init += static_cast<ResultType>(values[i]);
+    }
+    if (m_default != ValueType())
+      init += static_cast<ResultType>(m_default) * static_cast<ResultType>(m_size - m_count);
+    return init;
+  }
+
+  /// Average of all items, 0 for empty array
+  double mean() const {
+    if (m_size == 0)
+      return 0.0;
+    return sum(0.0) / static_cast<double>(m_size);
+  }
+
+  /// Minimum of all items, default value for empty array
+  ValueType minValue() const {
+    ValueType res = m_default;
+    bool found = (m_count < m_size) || (m_count == 0);
+    for(typename chunk_map::const_iterator it = m_chunks.begin(), epos = m_chunks.end(); it != epos; ++it) {
+      const std::vector<ValueType> &values = it->second.values;
+      ValueType chunkMin = *std::min_element(values.begin(), values.end());
+      if (!found || (chunkMin < res))
+        res = chunkMin;
+      found = true;
+    }
+    return res;
+  }
+
+  /// Maximum of all items, default value for empty array
+  ValueType maxValue() const {
+    ValueType res = m_default;
+    bool found = (m_count < m_size) || (m_count == 0);
+    for(typename chunk_map::const_iterator it = m_chunks.begin(), epos = m_chunks.end(); it != epos; ++it) {
+      const std::vector<ValueType> &values = it->second.values;
+      ValueType chunkMax = *std::max_element(values.begin(), values.end());
+      if (!found || (res < chunkMax))
+        res = chunkMax;
+      found = true;
+    }
+    return res;
+  }
+
+  /// Replaces contents with items of dense array (or list of scalars)
+  void fromArray(const dnode &input) {
+    clear();
+    m_size = input.size();
+    if (input.isArray() && (input.getElementType() == static_cast<dnValueType>(Details::dnValueTypeMeta<ValueType>::item_type))) {
+      input.visitVectorValues<ValueType>(AppendVisitor(*this));
+    } else {
+      for(size_type i=0; i != m_size; i++) {
+        ValueType value = input.get<ValueType>(i);
+        if (value != m_default)
+          intSet(i, value);
+      }
+    }
+  }
+
+  /// Writes all items (including default ones) to dense array
+  void toArray(dnode &output) const {
+    dnode res(ict_array, static_cast<dnValueType>(Details::dnValueTypeMeta<ValueType>::item_type));
+    res.resize(m_size);
+    if (m_default != ValueType())
+      for(size_type i=0; i != m_size; i++)
+        res.set<ValueType>(i, m_default);
+    for(const_iterator it = begin(), epos = end(); it != epos; ++it)
+      res.set<ValueType>(it.index(), it.value());
+    output.swap(res);
+  }
+
+  /// Stores contents as parent node
+  void toNode(dnode &output) const {
+    dnode res(ict_parent);
+    res.addChild("size", new dnode(static_cast<uint64>(m_size)));
+    res.addChild("default", new dnode(m_default));
+    dnode *indices = new dnode(ict_array, vt_uint64);
+    dnode *values = new dnode(ict_array, static_cast<dnValueType>(Details::dnValueTypeMeta<ValueType>::item_type));
+    res.addChild("index", indices);
+    res.addChild("value", values);
+    for(const_iterator it = begin(), epos = end(); it != epos; ++it) {
+      indices->addItem(static_cast<uint64>(it.index()));
+      values->addItem(it.value());
+    }
+    output.swap(res);
+  }
+
+  /// Restores contents stored by toNode
+  void fromNode(const dnode &input) {
+    dnSparseArray<ValueType> res(static_cast<size_type>(input.get<uint64>("size")), input.get<ValueType>("default"));
+    const dnode &indices = input["index"];
+    const dnode &values = input["value"];
+    if (indices.size() != values.size())
+      throw dnError("Sparse array index & value size mismatch");
+    for(size_type i=0, epos = indices.size(); i != epos; i++)
+      res.set(static_cast<size_type>(indices.get<uint64>(i)), values.get<ValueType>(i));
+    swap(res);
+  }
+
+  void swap(dnSparseArray<ValueType> &other) {
+    std::swap(m_size, other.m_size);
+    std::swap(m_count, other.m_count);
+    std::swap(m_default, other.m_default);
+    m_chunks.swap(other.m_chunks);
+  }
+
+  /// Estimated number of bytes used by storage
+  uint64 memoryUsed() const {
+    uint64 res = sizeof(*this);
+    for(typename chunk_map::const_iterator it = m_chunks.begin(), epos = m_chunks.end(); it != epos; ++it) {
+      // map node: key, value & 3 pointers + color
+      res += sizeof(typename chunk_map::value_type) + 4 * sizeof(void *);
+      res += it->second.offsets.capacity() * sizeof(offset_type);
+      res += it->second.values.capacity() * sizeof(ValueType);
+    }
+    return res;
+  }
+protected:
+  class AppendVisitor {
+  public:
+    AppendVisitor(dnSparseArray<ValueType> &output): m_output(&output), m_index(0) {}
+    void operator()(const ValueType &value) {
+      if (value != m_output->m_default)
+        m_output->intSet(m_index, value);
+      m_index++;
+    }
+  private:
+    dnSparseArray<ValueType> *m_output;
+    size_type m_index;
+  };
+
+  static size_type chunkBase(size_type index) { return index - (index % DSPARSE_CHUNK_SIZE); }
+
+  void checkIndex(size_type index) const {
+    if (index >= m_size)
+      throw dnError("Index out of range: " + toString(static_cast<uint64>(index)));
+  }
+
+  /// Removes stored items with index >= given one
+  void eraseFrom(size_type index) {
+    typename chunk_map::iterator chunk = m_chunks.lower_bound(chunkBase(index));
+    if ((chunk != m_chunks.end()) && (chunk->first < index)) {
+      Chunk &items = chunk->second;
+      offset_type offset = static_cast<offset_type>(index - chunk->first);
+      typename std::vector<offset_type>::iterator it = std::lower_bound(items.offsets.begin(), items.offsets.end(), offset);
+      size_type pos = static_cast<size_type>(it - items.offsets.begin());
+      m_count -= static_cast<size_type>(items.offsets.size()) - pos;
+      items.offsets.erase(it, items.offsets.end());
+      items.values.erase(items.values.begin() + pos, items.values.end());
+      if (items.values.empty())
+        m_chunks.erase(chunk++);
+      else
+        ++chunk;
+    }
+
+    for(typename chunk_map::iterator it = chunk, epos = m_chunks.end(); it != epos; ++it)
+      m_count -= static_cast<size_type>(it->second.values.size());
+    m_chunks.erase(chunk, m_chunks.end());
+  }
+
+  /// Stores non-default value
+  void intSet(size_type index, const ValueType &value) {
+    size_type base = chunkBase(index);
+    offset_type offset = static_cast<offset_type>(index - base);
+    typename chunk_map::iterator chunk;
+
+    if (!m_chunks.empty() && (m_chunks.rbegin()->first == base))
+      chunk = --m_chunks.end();
+    else
+      chunk = m_chunks.insert(typename chunk_map::value_type(base, Chunk())).first;
+
+    Chunk &items = chunk->second;
+    if (items.offsets.empty() || (items.offsets.back() < offset)) {
+      // append
+      items.offsets.push_back(offset);
+      items.values.push_back(value);
+      m_count++;
+      return;
+    }
+
+    typename std::vector<offset_type>::iterator it = std::lower_bound(items.offsets.begin(), items.offsets.end(), offset);
+    size_type pos = static_cast<size_type>(it - items.offsets.begin());
+    if (*it == offset) {
+      items.values[pos] = value;
+    } else {
+      items.offsets.insert(it, offset);
+      items.values.insert(items.values.begin() + pos, value);
+      m_count++;
+    }
+  }
+private:
+  size_type m_size;
+  size_type m_count;
+  ValueType m_default;
+  chunk_map m_chunks;
+};
+
+} // namespace dtp
+
+#endif // _DTPDNODESPARSE_H__
@@ -0,0 +1,221 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_split.h
+// Project:     dtpLib
+// Purpose:     Allocation-free string splitting & joining for dnode
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNODESPLIT_H__
+#define _DTPDNODESPLIT_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_split.h
+\brief Allocation-free string splitting & joining for dnode
+
+Faster versions of dnode::explode / dnode::implode for wide delimited lines:
+- input is passed as dnStringRef (pointer + length), no substrings are created
+- separator can be a multi-character text or a set of characters
+- output array is sized in advance, numeric items are converted in place
+- when output node is reused (same item type), its storage is reused too
+
+Field rules: empty text gives no fields, otherwise N separators give N+1
+fields (including empty ones). Empty numeric field is converted to zero.
+
+Function list:
+- dstr_for_each_field - invoke functor for each field
+- dstr_count_fields - count fields
+- dstr_split - split to vector of dnStringRef (no allocation after warm-up)
+- dstr_explode - split to typed array node (string, int, uint, int64, uint64, float, double)
+- dstr_implode - join items of container node (or range of strings) into reused output string
+- dstr_trim - skip leading & trailing white space of field
+- dstr_to_double - convert field to number
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include <vector>
+#include <cstring>
+
+#include "dtp/dnode.h"
+
+namespace dtp {
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+
+/// Non-owning reference to a piece of text
+class dnStringRef {
+public:
+  dnStringRef(): m_data(""), m_length(0) {}
+  dnStringRef(const char *data): m_data(data), m_length(strlen(data)) {}
+  dnStringRef(const char *data, size_t length): m_data(data), m_length(length) {}
+  dnStringRef(const dtpString &text): m_data(text.c_str()), m_length(text.length()) {}
+
+  const char *data() const { return m_data; }
+  const char *begin() const { return m_data; }
+  const char *end() const { return m_data + m_length; }
+  size_t length() const { return m_length; }
+  size_t size() const { return m_length; }
+  bool empty() const { return (m_length == 0); }
+  char operator[](size_t index) const { return m_data[index]; }
+
+  /// Returns copy of text (allocates memory)
+  dtpString str() const { return dtpString(m_data, m_length); }
+
+  /// Copies text to output, reusing its capacity
+  void assignTo(dtpString &output) const { output.assign(m_data, m_length); }
+
+  bool operator==(const dnStringRef &rhs) const {
+    return (m_length == rhs.m_length) && (memcmp(m_data, rhs.m_data, m_length) == 0);
+  }
+  bool operator!=(const dnStringRef &rhs) const { return !(*this == rhs); }
+private:
+  const char *m_data;
+  size_t m_length;
+};
+
+/// Field separator: text (one or more characters) or set of single characters
+class dnSplitSeparator {
+public:
+  /// Text separator, use anyOf() for set of characters
+  dnSplitSeparator(const char *text);
+  dnSplitSeparator(const dtpString &text);
+
+  /// Returns separator matching any of the given characters
+  static dnSplitSeparator anyOf(const dnStringRef &chars);
+
+  /// Returns position of the first separator in [begin, end) or end if not found.
+  /// Length of the separator found is returned in sepLength.
+  const char *find(const char *begin, const char *end, size_t &sepLength) const {
+    if (m_isSet)
+      return findAnyOf(begin, end, sepLength);
+    sepLength = m_text.length();
+    if (sepLength == 1) {
+      const void *res = memchr(begin, m_text[0], end - begin);
+      return (res != DTP_NULL) ? static_cast<const char *>(res) : end;
+    }
+    return findText(begin, end);
+  }
+protected:
+  dnSplitSeparator();
+  void init(const dnStringRef &text);
+  const char *findAnyOf(const char *begin, const char *end, size_t &sepLength) const;
+  const char *findText(const char *begin, const char *end) const;
+private:
+  dtpString m_text;
+  bool m_isSet;
+  bool m_charSet[256];
+};
+
+namespace Details {
+
+class dnSplitFieldCounter {
+public:
+  dnSplitFieldCounter(): m_count(0) {}
+  void operator()(const dnStringRef &) { m_count++; }
+  size_t getCount() const { return m_count; }
+private:
+  size_t m_count;
+};
+
+class dnSplitRefCollector {
+public:
+  dnSplitRefCollector(std::vector<dnStringRef> &output): m_output(output) {}
+  void operator()(const dnStringRef &field) { m_output.push_back(field); }
+private:
+  std::vector<dnStringRef> &m_output;
+};
+
+} // namespace Details
+
+// ----------------------------------------------------------------------------
+// Function definitions
+// ----------------------------------------------------------------------------
+
+/// Invokes func(dnStringRef) for each field of text
+template<typename Func>
+void dstr_for_each_field(const dnStringRef &text, const dnSplitSeparator &separator, Func &func)
+{
+  if (text.empty())
+    return;
+
+  const char *pos = text.begin();
+  const char *epos = text.end();
+  const char *fieldEnd;
+  size_t sepLength;
+
+  for(;;) {
+    fieldEnd = separator.find(pos, epos, sepLength);
+    func(dnStringRef(pos, fieldEnd - pos));
+    if (fieldEnd == epos)
+      break;
+    pos = fieldEnd + sepLength;
+  }
+}
+
+/// Returns number of fields in text
+inline size_t dstr_count_fields(const dnStringRef &text, const dnSplitSeparator &separator)
+{
+  Details::dnSplitFieldCounter counter;
+  dstr_for_each_field(text, separator, counter);
+  return counter.getCount();
+}
+
+/// Splits text to references into text, output is cleared first (capacity is kept)
+inline std::vector<dnStringRef> &dstr_split(const dnStringRef &text, const dnSplitSeparator &separator,
+  std::vector<dnStringRef> &output)
+{
+  output.clear();
+  Details::dnSplitRefCollector collector(output);
+  dstr_for_each_field(text, separator, collector);
+  return output;
+}
+
+/// Splits text to array of a given item type, output is sized in advance.
+/// Numeric fields are converted without temporary strings, invalid number throws dnError.
+/// @param[in] itemType vt_string, vt_int, vt_uint, vt_int64, vt_uint64, vt_float or vt_double
+dnode &dstr_explode(const dnStringRef &text, const dnSplitSeparator &separator, dnode &output,
+  dnValueType itemType = vt_string);
+
+/// Returns field without leading & trailing white space
+dnStringRef dstr_trim(const dnStringRef &text);
+
+/// Converts field to number without temporary string, empty field gives zero.
+/// Invalid number throws dnError.
+double dstr_to_double(const dnStringRef &text);
+
+/// Joins items of container (or value of scalar) using separator.
+/// Output is cleared first (capacity is kept).
+dtpString &dstr_implode(const dnode &input, const dnStringRef &separator, dtpString &output);
+
+/// Joins range of strings (or dnStringRef) using separator, output is presized.
+template<typename Iterator>
+dtpString &dstr_implode(Iterator first, Iterator last, const dnStringRef &separator, dtpString &output)
+{
+  size_t total = 0;
+  size_t cnt = 0;
+  for(Iterator it = first; it != last; ++it, ++cnt)
+    total += it->length();
+
+  output.clear();
+  if (cnt == 0)
+    return output;
+
+  output.reserve(total + (cnt - 1) * separator.length());
+  for(Iterator it = first; it != last; ++it) {
+    if (it != first)
+      output.append(separator.data(), separator.length());
+    output.append(it->data(), it->length());
+  }
+  return output;
+}
+
+} // namespace dtp
+
+#endif // _DTPDNODESPLIT_H__
@@ -0,0 +1,175 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_stats.h
+// Project:     dtpLib
+// Purpose:     One-pass statistics for dnode arrays & tables
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNODESTATS_H__
+#define _DTPDNODESTATS_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_stats.h
+\brief One-pass statistics for dnode arrays & tables
+
+Accumulators read each value once and keep only a fixed-size state:
+- dnStatsAccumulator - count, sum, mean, variance, skewness, min & max
+- dnCovarianceAccumulator - covariance & correlation of value pairs
+
+Mean & central moments are updated with Welford's method, sum uses
+compensated (Kahan-Neumaier) summation, so results stay accurate for
+billions of values. Two accumulators can be merged - partial results
+calculated for separate ranges, threads or processes give the same result
+(up to rounding) as one pass over all values. State can be stored in
+a dnode with toNode() & restored with fromNode().
+
+Input of functions:
+- array: container with scalar items, arrays of numbers are read directly
+- column: field of list-of-parents table (rows), rows without field or
+  with null value are skipped
+
+Function list:
+- dstat_array - adds array items to accumulator
+- dstat_column - adds table column to accumulator
+- dstat_covariance - adds pairs of items from two arrays
+- dstat_covariance_columns - adds pairs of values from two table columns
+- dpar_stat_array, dpar_stat_column, dpar_stat_covariance,
+  dpar_stat_covariance_columns - parallel versions (see dnode_parallel.h)
+
+Example:
+\code
+  dnStatsAccumulator stats;
+  dstat_column(orders, "amount", stats);
+  double avg = stats.mean();
+  double dev = stats.stdDev();
+\endcode
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include "dtp/dnode.h"
+#include "dtp/dnode_parallel.h"
+
+namespace dtp {
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+
+// ----------------------------------------------------------------------------
+// dnStatsAccumulator
+// ----------------------------------------------------------------------------
+/// Mergeable one-pass statistics of a series of values
+class dnStatsAccumulator {
+public:
+  dnStatsAccumulator() { clear(); }
+
+  void clear();
+  void add(double value);
+  template<typename InputIterator>
+  void add(InputIterator first, InputIterator last) {
+    for(; first != last; ++first)
+      add(static_cast<double>(*first));
+  }
+  /// Adds state of other accumulator, as if its values were added here
+  void merge(const dnStatsAccumulator &other);
+
+  bool empty() const { return m_count == 0; }
+  uint64 count() const { return m_count; }
+  double sum() const { return m_sum + m_sumCorrection; }
+  double mean() const { return m_mean; }
+  /// Population variance, 0 for empty series
+  double variance() const;
+  /// Sample (unbiased) variance, 0 for less than 2 values
+  double sampleVariance() const;
+  double stdDev() const;
+  double sampleStdDev() const;
+  /// Population skewness, 0 for constant series
+  double skewness() const;
+  /// Minimum value, 0 for empty series
+  double minValue() const { return m_min; }
+  /// Maximum value, 0 for empty series
+  double maxValue() const { return m_max; }
+
+  /// Stores state as parent node
+  void toNode(dnode &output) const;
+  /// Restores state stored by toNode
+  void fromNode(const dnode &input);
+protected:
+  void addToSum(double value);
+private:
+  uint64 m_count;
+  double m_mean;
+  double m_m2;
+  double m_m3;
+  double m_min;
+  double m_max;
+  double m_sum;
+  double m_sumCorrection;
+};
+
+// ----------------------------------------------------------------------------
+// dnCovarianceAccumulator
+// ----------------------------------------------------------------------------
+/// Mergeable one-pass covariance of pairs of values
+class dnCovarianceAccumulator {
+public:
+  dnCovarianceAccumulator() { clear(); }
+
+  void clear();
+  void add(double x, double y);
+  void merge(const dnCovarianceAccumulator &other);
+
+  bool empty() const { return m_count == 0; }
+  uint64 count() const { return m_count; }
+  double meanX() const { return m_meanX; }
+  double meanY() const { return m_meanY; }
+  /// Population covariance, 0 for empty series
+  double covariance() const;
+  /// Sample covariance, 0 for less than 2 pairs
+  double sampleCovariance() const;
+  /// Pearson correlation, 0 if any series is constant
+  double correlation() const;
+
+  void toNode(dnode &output) const;
+  void fromNode(const dnode &input);
+private:
+  uint64 m_count;
+  double m_meanX;
+  double m_meanY;
+  double m_m2X;
+  double m_m2Y;
+  double m_coMoment;
+};
+
+// ----------------------------------------------------------------------------
+// Function definitions
+// ----------------------------------------------------------------------------
+/// Adds non-null items of input container to output
+void dstat_array(const dnode &input, dnStatsAccumulator &output);
+/// Adds non-null values of field of each row to output
+void dstat_column(const dnode &table, const dtpString &fieldName, dnStatsAccumulator &output);
+/// Adds pairs of items with the same index, arrays must have equal size.
+/// Pairs with null value are skipped.
+void dstat_covariance(const dnode &inputX, const dnode &inputY, dnCovarianceAccumulator &output);
+/// Adds pairs of field values from each row, rows with missing or null value are skipped.
+void dstat_covariance_columns(const dnode &table, const dtpString &fieldX, const dtpString &fieldY, dnCovarianceAccumulator &output);
+
+/// Parallel version of dstat_array
+void dpar_stat_array(const dnode &input, dnStatsAccumulator &output, const dnParallelOptions &options = dnParallelOptions());
+/// Parallel version of dstat_column
+void dpar_stat_column(const dnode &table, const dtpString &fieldName, dnStatsAccumulator &output, const dnParallelOptions &options = dnParallelOptions());
+/// Parallel version of dstat_covariance
+void dpar_stat_covariance(const dnode &inputX, const dnode &inputY, dnCovarianceAccumulator &output, const dnParallelOptions &options = dnParallelOptions());
+/// Parallel version of dstat_covariance_columns
+void dpar_stat_covariance_columns(const dnode &table, const dtpString &fieldX, const dtpString &fieldY, dnCovarianceAccumulator &output,
+  const dnParallelOptions &options = dnParallelOptions());
+
+} // namespace dtp
+
+#endif // _DTPDNODESTATS_H__
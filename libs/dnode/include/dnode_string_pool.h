@@ -0,0 +1,178 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_string_pool.h
+// Project:     dtpLib
+// Purpose:     Array of strings packed into one contiguous character buffer
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNODESTRPOOL_H__
+#define _DTPDNODESTRPOOL_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_string_pool.h
+\brief Array of strings packed into one contiguous character buffer
+
+dnStringPool is a packed alternative to vt_string dnode array, which keeps
+every item as a separate node with its own string allocation.
+Pool keeps all characters in one buffer, each item is followed by '\0',
+and item start positions in offset vector (with end sentinel), so:
+- push_back is amortized O(1), no allocation per item
+- get returns dnStringRef pointing into buffer, getString copies on demand
+- c_str returns zero-terminated text without copying
+- set with the same length overwrites in place, otherwise moves buffer tail
+
+Operations working on buffer directly:
+- find - compares lengths from offsets, then bytes
+- sort - sorts item order by memcmp, then rebuilds buffer in one pass
+- implode / explode - join to text / split text into pool
+- writeCsvLine / readCsvLine - one CSV line with quoting
+- BION: dnBionWriter::write(pool) and dnBionStringPoolProcessor (dnode_bion.h)
+
+Conversion: fromArray / toArray - from / to vt_string (or any) dnode array.
+
+Example:
+\code
+  dnStringPool names;
+  names.reserve(1000, 16000);
+  names.push_back("beta");
+  names.push_back("alpha");
+  names.sort();
+  dnStringRef first = names.get(0);
+  dtpString line;
+  names.writeCsvLine(line);
+\endcode
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include <vector>
+
+#include "dtp/dnode.h"
+#include "dtp/dnode_split.h"
+
+namespace dtp {
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+
+// ----------------------------------------------------------------------------
+// dnStringPool
+// ----------------------------------------------------------------------------
+class dnStringPool {
+public:
+  typedef dnSizeType size_type;
+  typedef std::vector<char> data_vector;
+  typedef std::vector<size_type> offset_vector;
+
+  dnStringPool();
+
+  size_type size() const { return m_offsets.size() - 1; }
+  bool empty() const { return (m_offsets.size() == 1); }
+  /// Returns number of characters in buffer, including terminators
+  size_type dataSize() const { return m_data.size(); }
+  const data_vector &getData() const { return m_data; }
+  const offset_vector &getOffsets() const { return m_offsets; }
+
+  /// Prepares storage for a given number of items & characters (without terminators)
+  void reserve(size_type itemCount, size_type charCount);
+  void clear();
+  /// Truncates pool or appends empty strings
+  void resize(size_type newSize);
+  void shrinkToFit();
+  void swap(dnStringPool &other);
+  size_type memoryUsed() const;
+
+  /// Returns text of item, valid until pool is modified
+  dnStringRef get(size_type index) const {
+    checkIndex(index);
+    return dnStringRef(&m_data[m_offsets[index]], m_offsets[index + 1] - m_offsets[index] - 1);
+  }
+
+  /// Returns zero-terminated text of item, valid until pool is modified
+  const char *c_str(size_type index) const {
+    checkIndex(index);
+    return &m_data[m_offsets[index]];
+  }
+
+  size_type length(size_type index) const {
+    checkIndex(index);
+    return m_offsets[index + 1] - m_offsets[index] - 1;
+  }
+
+  dtpString getString(size_type index) const { return get(index).str(); }
+  /// Copies item text to output, reusing its capacity
+  dtpString &getString(size_type index, dtpString &output) const {
+    get(index).assignTo(output);
+    return output;
+  }
+
+  dnStringRef operator[](size_type index) const { return get(index); }
+
+  void push_back(const dnStringRef &value) {
+    if (isInData(value.data())) {
+      dtpString temp(value.data(), value.length());
+      push_back(dnStringRef(temp));
+      return;
+    }
+    m_data.insert(m_data.end(), value.begin(), value.end());
+    m_data.push_back('\0');
+    m_offsets.push_back(m_data.size());
+  }
+
+  void pop_back();
+
+  /// Replaces item text, in place when length is unchanged
+  void set(size_type index, const dnStringRef &value);
+
+  /// Returns index of first item equal to value (starting from startPos) or dnode::npos
+  size_type find(const dnStringRef &value, size_type startPos = 0) const;
+
+  /// Sorts items in ascending byte order
+  void sort();
+
+  /// Joins items using separator, output is cleared first (capacity is kept)
+  dtpString &implode(const dnStringRef &separator, dtpString &output) const;
+  /// Replaces contents with fields of text
+  void explode(const dnStringRef &text, const dnSplitSeparator &separator);
+
+  /// Writes items as one CSV line (without line end), output is cleared first.
+  /// Fields with separator, quote or line break (or all if forceQuoted) are quoted.
+  dtpString &writeCsvLine(dtpString &output, char sepChar = ',', char quoteChar = '"', bool forceQuoted = false) const;
+  /// Replaces contents with fields of one CSV line, unterminated quote throws dnError
+  void readCsvLine(const dnStringRef &line, char sepChar = ',', char quoteChar = '"');
+
+  /// Replaces contents with items of container (or value of scalar)
+  void fromArray(const dnode &input);
+  /// Writes items to vt_string array, reusing output items when possible
+  void toArray(dnode &output) const;
+
+protected:
+  void checkIndex(size_type index) const {
+    if (index >= size())
+      throw dnError("Index out of range: " + toString(index));
+  }
+
+  void appendChars(const char *begin, const char *end) { m_data.insert(m_data.end(), begin, end); }
+  void appendChar(char value) { m_data.push_back(value); }
+  /// Terminates item which characters were appended
+  void endItem() {
+    m_data.push_back('\0');
+    m_offsets.push_back(m_data.size());
+  }
+  bool isInData(const char *ptr) const {
+    return !m_data.empty() && (ptr >= &m_data[0]) && (ptr < &m_data[0] + m_data.size());
+  }
+private:
+  data_vector m_data;
+  offset_vector m_offsets;
+};
+
+} // namespace dtp
+
+#endif // _DTPDNODESTRPOOL_H__
@@ -0,0 +1,361 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_transcode.h
+// Project:     dtpLib
+// Purpose:     Streaming transcoder between JSON, BION, CSV and structure outputs
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNODETRANSCODE_H__
+#define _DTPDNODETRANSCODE_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_transcode.h
+\brief Streaming transcoder between JSON, BION, CSV and structure outputs
+
+Parser events are passed directly to output writer, no dnode is built.
+Memory usage depends on nesting depth only (plus input / output buffers).
+
+Event flow:
+- JSON input: dnJsonStructureReader (YawlReaderBase) -> StructureOutputIntf
+- BION input: dnBionStructureProcessor (BionReaderProcessorIntf) -> StructureOutputIntf
+- JSON output: dnStructureOutputJson (StructureOutputIntf) -> yajl generator -> stream
+- BION output: dnStructureOutputBion (dnode dialect) or base::StructureOutputBion (plain)
+- CSV input: dnCsvStructureReader -> StructureOutputIntf
+- CSV output: dnStructureOutputCsv (StructureOutputIntf) -> stream
+
+BION "dnode dialect" is the format written by dnBionWriter and read by
+dnBionProcessor: each variable array starts with container type marker
+(dbatList / dbatArray + item type). In plain BION arrays have no marker.
+
+JSON is plain JSON - special encoding of dnSerializer (typed arrays, escaped
+value types) is not interpreted.
+
+CSV holds a list of flat maps: one line per map, header line with keys of the
+first map. Values are read back as strings. Line parsing & quoting is done by
+dnStringPool::readCsvLine / writeCsvLine.
+
+Function list:
+- dtc_json_to_bion
+- dtc_bion_to_json
+- dtc_json_to_structure
+- dtc_bion_to_structure
+- dtc_json_to_csv
+- dtc_csv_to_json
+- dtc_csv_to_structure
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include <istream>
+#include <ostream>
+#include <map>
+#include <vector>
+
+#include "base/StructureWriter.h"
+#include "base/StructureOutputBion.h"
+#include "dtp/YawlIoClasses.h"
+#include "dtp/dnode_bion.h"
+#include "dtp/dnode_string_pool.h"
+
+namespace dtp {
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+const size_t DTC_DEF_BUFFER_SIZE = 64 * 1024;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+
+// ----------------------------------------------------------------------------
+// dnStructureOutputJson
+// ----------------------------------------------------------------------------
+/// Writes structure events as JSON. When output stream is provided, generator
+/// buffer is flushed to it each time it exceeds flush size.
+class dnStructureOutputJson: public base::StructureOutputIntf {
+public:
+  // construction
+  dnStructureOutputJson(yajl_gen *context, std::ostream *output = DTP_NULL, size_t flushSize = DTC_DEF_BUFFER_SIZE);
+  virtual ~dnStructureOutputJson() {}
+  // properties
+  uint64 getBytesWritten() const { return m_bytesWritten; }
+  // execution
+  virtual void accept(base::StructureWriterIntf &writer);
+  /// Writes generator buffer to output stream
+  void flush();
+  // visitation
+  virtual void beginWrite();
+  virtual void endWrite();
+  virtual void beginMap();
+  virtual void endMap();
+  virtual void beginArray(size_t size = 0);
+  virtual void beginArrayOf(const std::string &valueTag, size_t size = 0);
+  virtual void beginArrayOf(float valueTag, size_t size = 0);
+  virtual void beginArrayOf(double valueTag, size_t size = 0);
+  virtual void beginArrayOf(xdouble valueTag, size_t size = 0);
+  virtual void beginArrayOf(bool valueTag, size_t size = 0);
+  virtual void beginArrayOf(byte valueTag, size_t size = 0);
+  virtual void beginArrayOf(int valueTag, size_t size = 0);
+  virtual void beginArrayOf(uint valueTag, size_t size = 0);
+  virtual void beginArrayOf(int64 valueTag, size_t size = 0);
+  virtual void beginArrayOf(uint64 valueTag, size_t size = 0);
+  virtual void endArray();
+  //----
+  virtual void writeKeyName(const std::string &name);
+  //----
+  virtual void writeValue(const std::string &value);
+  virtual void writeValue(float value);
+  virtual void writeValue(double value);
+  virtual void writeValue(xdouble value);
+  virtual void writeValue(byte value);
+  virtual void writeValue(int value);
+  virtual void writeValue(uint value);
+  virtual void writeValue(int64 value);
+  virtual void writeValue(uint64 value);
+  virtual void writeValue(bool value);
+  virtual void writeNullValue();
+protected:
+  void checkFlush();
+  void writeNumberText(const dtpString &text);
+private:
+  yajl_gen *m_context;
+  std::ostream *m_output;
+  size_t m_flushSize;
+  uint64 m_bytesWritten;
+  dtpString m_numBuffer;
+};
+
+// ----------------------------------------------------------------------------
+// dnStructureOutputBion
+// ----------------------------------------------------------------------------
+/// Writes structure events as BION in dnode dialect (readable with dnBionProcessor)
+class dnStructureOutputBion: public base::StructureOutputBion {
+public:
+  dnStructureOutputBion(BionWriterIntf &writer): base::StructureOutputBion(writer), m_bionWriter(writer) {}
+  virtual ~dnStructureOutputBion() {}
+
+  virtual void beginArray(size_t size = 0);
+  virtual void beginArrayOf(const std::string &valueTag, size_t size = 0);
+  virtual void beginArrayOf(float valueTag, size_t size = 0);
+  virtual void beginArrayOf(double valueTag, size_t size = 0);
+  virtual void beginArrayOf(xdouble valueTag, size_t size = 0);
+  virtual void beginArrayOf(bool valueTag, size_t size = 0);
+  virtual void beginArrayOf(byte valueTag, size_t size = 0);
+  virtual void beginArrayOf(int valueTag, size_t size = 0);
+  virtual void beginArrayOf(uint valueTag, size_t size = 0);
+  virtual void beginArrayOf(int64 valueTag, size_t size = 0);
+  virtual void beginArrayOf(uint64 valueTag, size_t size = 0);
+protected:
+  template<typename T>
+  void beginTypedArray(T valueTag, size_t size) {
+    base::StructureOutputBion::beginArrayOf(valueTag, size);
+    if (size == 0)
+      writeListMarker();
+  }
+
+  void writeListMarker();
+private:
+  BionWriterIntf &m_bionWriter;
+};
+
+// ----------------------------------------------------------------------------
+// dnStructureOutputCsv
+// ----------------------------------------------------------------------------
+/// Writes list of flat maps as CSV. Header is built from keys of the first map,
+/// keys of next maps are matched to it by name (missing key gives empty field).
+/// Null is written as empty field, bool as true / false.
+/// Unknown key, nested container or input other than list of maps throws dnError.
+class dnStructureOutputCsv: public base::StructureOutputIntf {
+public:
+  // construction
+  dnStructureOutputCsv(std::ostream &output, char sepChar = ',', char quoteChar = '"');
+  virtual ~dnStructureOutputCsv() {}
+  // execution
+  virtual void accept(base::StructureWriterIntf &writer);
+  // visitation
+  virtual void beginWrite();
+  virtual void endWrite();
+  virtual void beginMap();
+  virtual void endMap();
+  virtual void beginArray(size_t size = 0);
+  virtual void beginArrayOf(const std::string &valueTag, size_t size = 0);
+  virtual void beginArrayOf(float valueTag, size_t size = 0);
+  virtual void beginArrayOf(double valueTag, size_t size = 0);
+  virtual void beginArrayOf(xdouble valueTag, size_t size = 0);
+  virtual void beginArrayOf(bool valueTag, size_t size = 0);
+  virtual void beginArrayOf(byte valueTag, size_t size = 0);
+  virtual void beginArrayOf(int valueTag, size_t size = 0);
+  virtual void beginArrayOf(uint valueTag, size_t size = 0);
+  virtual void beginArrayOf(int64 valueTag, size_t size = 0);
+  virtual void beginArrayOf(uint64 valueTag, size_t size = 0);
+  virtual void endArray();
+  //----
+  virtual void writeKeyName(const std::string &name);
+  //----
+  virtual void writeValue(const std::string &value);
+  virtual void writeValue(float value);
+  virtual void writeValue(double value);
+  virtual void writeValue(xdouble value);
+  virtual void writeValue(byte value);
+  virtual void writeValue(int value);
+  virtual void writeValue(uint value);
+  virtual void writeValue(int64 value);
+  virtual void writeValue(uint64 value);
+  virtual void writeValue(bool value);
+  virtual void writeNullValue();
+protected:
+  enum Level { clvNone, clvList, clvRow };
+  /// Stores value of current key in current row
+  void setField(const dtpString &value);
+  void setDoubleField(double value);
+  void writeLine(const dnStringPool &fields);
+  void throwNotFlat() const;
+private:
+  std::ostream &m_output;
+  char m_sepChar;
+  char m_quoteChar;
+  Level m_level;
+  bool m_headerWritten;
+  dnStringPool m_header;
+  std::map<dtpString, size_t> m_columns;
+  std::vector<dtpString> m_row;
+  dtpString m_key;
+  dnStringPool m_fields;
+  dtpString m_lineBuffer;
+  dtpString m_numBuffer;
+};
+
+// ----------------------------------------------------------------------------
+// dnCsvStructureReader
+// ----------------------------------------------------------------------------
+/// Reads CSV with header line and passes it to structure output as list of
+/// maps, one per line, keys taken from header. All values are strings, missing
+/// trailing fields are empty. Empty lines are skipped, quoted fields may contain
+/// line breaks. More fields than in header or unterminated quote throws dnError.
+class dnCsvStructureReader {
+public:
+  dnCsvStructureReader(base::StructureOutputIntf &output, char sepChar = ',', char quoteChar = '"');
+  virtual ~dnCsvStructureReader() {}
+
+  /// Reads whole stream, output receives beginWrite / endWrite
+  void read(std::istream &input);
+protected:
+  /// Reads one CSV record (one or more lines if quoted field has line break)
+  bool readRecord(std::istream &input, dtpString &output);
+private:
+  base::StructureOutputIntf &m_output;
+  char m_sepChar;
+  char m_quoteChar;
+  dtpString m_lineBuffer;
+  std::string m_buffer;
+};
+
+// ----------------------------------------------------------------------------
+// dnJsonStructureReader
+// ----------------------------------------------------------------------------
+/// Parses JSON and passes events to structure output
+class dnJsonStructureReader: public YawlReaderBase {
+public:
+  dnJsonStructureReader(base::StructureOutputIntf &output, bool checkUtf8 = true, bool commentsEnabled = false);
+  virtual ~dnJsonStructureReader() {}
+
+  /// Parses JSON text, output receives beginWrite / endWrite
+  void read(const dtpString &input);
+  /// Parses JSON stream in chunks, output receives beginWrite / endWrite
+  void read(std::istream &input, size_t bufferSize = DTC_DEF_BUFFER_SIZE);
+protected:
+  virtual int processNull();
+  virtual int processBoolean(int boolVal);
+  virtual int processInteger(long integerVal);
+  virtual int processDouble(double doubleVal);
+  virtual int processString(const unsigned char * stringVal,
+                       unsigned int stringLen);
+  virtual int processMapKey(const unsigned char * stringVal,
+                     unsigned int stringLen);
+  virtual int processStartMap();
+  virtual int processEndMap();
+  virtual int processStartArray();
+  virtual int processEndArray();
+private:
+  base::StructureOutputIntf &m_output;
+  std::string m_buffer;
+};
+
+// ----------------------------------------------------------------------------
+// dnBionStructureProcessor
+// ----------------------------------------------------------------------------
+/// BION reader processor which passes events to structure output
+class dnBionStructureProcessor: public BionReaderProcessorIntf {
+public:
+  /// @param[in] dnodeDialect if true, type marker at start of variable array is consumed
+  dnBionStructureProcessor(base::StructureOutputIntf &output, bool dnodeDialect = true);
+  virtual ~dnBionStructureProcessor() {}
+
+  virtual void processHeader(void *data, size_t dataSize);
+  virtual void processFooter(void *data, size_t dataSize);
+  virtual void processObjectBegin();
+  virtual void processObjectEnd();
+  virtual void processArrayBegin();
+  virtual void processArrayEnd();
+  virtual void processFixTypeArrayBegin(BionValueType valueType, unsigned int elementSize, size_t arraySize);
+  virtual void processFixTypeArrayEnd();
+  virtual void processElementName(char *name);
+  virtual void processFloat(float value);
+  virtual void processDouble(double value);
+  virtual void processXDouble(xdouble value);
+  virtual void processZString(char *value);
+  virtual void processBool(bool value);
+  virtual void processNull();
+  virtual void processInt(int value);
+  virtual void processInt64(int64 value);
+  virtual void processUInt(uint value);
+  virtual void processUInt64(uint64 value);
+protected:
+  /// Returns true if value was consumed as array type marker
+  bool consumeMarker() {
+    if (!m_arrayInitWait)
+      return false;
+    m_arrayInitWait = false;
+    return true;
+  }
+private:
+  base::StructureOutputIntf &m_output;
+  bool m_dnodeDialect;
+  bool m_arrayInitWait;
+  std::string m_buffer;
+};
+
+// ----------------------------------------------------------------------------
+// Function definitions
+// ----------------------------------------------------------------------------
+
+/// Converts JSON stream to BION stream (dnode dialect by default)
+void dtc_json_to_bion(std::istream &input, std::ostream &output, bool dnodeDialect = true);
+
+/// Converts BION stream to JSON stream
+void dtc_bion_to_json(std::istream &input, std::ostream &output, bool dnodeDialect = true, bool beautify = false);
+
+/// Passes events from JSON stream to structure output
+void dtc_json_to_structure(std::istream &input, base::StructureOutputIntf &output);
+
+/// Passes events from BION stream to structure output
+void dtc_bion_to_structure(std::istream &input, base::StructureOutputIntf &output, bool dnodeDialect = true);
+
+/// Converts JSON list of flat objects to CSV stream with header line
+void dtc_json_to_csv(std::istream &input, std::ostream &output, char sepChar = ',', char quoteChar = '"');
+
+/// Converts CSV stream with header line to JSON list of objects (string values)
+void dtc_csv_to_json(std::istream &input, std::ostream &output, bool beautify = false, char sepChar = ',', char quoteChar = '"');
+
+/// Passes CSV stream with header line to structure output as list of maps
+void dtc_csv_to_structure(std::istream &input, base::StructureOutputIntf &output, char sepChar = ',', char quoteChar = '"');
+
+} // namespace dtp
+
+#endif // _DTPDNODETRANSCODE_H__
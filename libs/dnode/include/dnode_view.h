@@ -0,0 +1,419 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_view.h
+// Project:     dtpLib
+// Purpose:     Read-only data node view over serialized buffer
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPDNODEVIEW_H__
+#define _DTPDNODEVIEW_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file dnode_view.h
+\brief Read-only data node view over serialized buffer
+
+Defines binary, offset-based layout of data node tree ("DNV") which can be
+accessed in place - directly from memory buffer or memory-mapped file, without
+deserialization.
+
+Classes:
+- dnViewWriter - writes dnode tree in DNV layout
+- dnodeView - read-only node view, does not allocate memory on read access
+- dnViewMappedFile - maps DNV file into memory and provides root view
+
+Layout (host byte order, all records aligned to 8 bytes):
+\verbatim
+  header:  magic "DNV1", byte order mark (uint), version (uint),
+           sizeof(xdouble) (uint), reserved (uint), root offset (uint64), total size (uint64)
+  node:    kind (byte, dnValueType), item type (byte), flags (ushort), reserved (uint),
+           count (uint64), a (uint64), b (uint64)
+  string:  length (uint64), characters, '\0'
+\endverbatim
+
+Node record fields:
+- scalar: value stored inline in a (xdouble: in a and b)
+- date, time, datetime: day count stored as double in a, kind keeps the value type
+- string: count = length, a = string record offset
+- parent / list: count = child count, a = child node offset table,
+  b = (parents only) name offset table followed by child index table sorted by name
+- array: count = item count, item type = dnValueType of items, a = item data:
+  - POD types: contiguous items
+  - strings: string record offset table
+  - vt_datanode: node offset table
+
+Example:
+\code
+  std::vector<char> buffer;
+  dnViewWriter::write(node, buffer);
+
+  dnodeView root = dnodeView::open(&buffer[0], buffer.size());
+  double val = root.getElement("values").get<double>(3);
+
+  dnViewMappedFile file("data.dnv");
+  dnodeView item;
+  if (file.getRoot().getElementByPath("config/items/0", item))
+    std::cout << item.getStringRef().str();
+\endcode
+
+Pointer values (vt_vptr) have no meaning outside of process and are not
+supported - writer throws dnError for them.
+
+Buffer must remain valid and unchanged while views are used.
+Buffer start must be aligned to 8 bytes (memory returned by new/malloc and mmap is).
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include <vector>
+#include <cstring>
+#include <iterator>
+
+#include "dtp/dnode.h"
+
+namespace dtp {
+
+// ----------------------------------------------------------------------------
+// Simple type definitions
+// ----------------------------------------------------------------------------
+typedef uint64 dnViewOffset;
+
+// ----------------------------------------------------------------------------
+// Forward class definitions
+// ----------------------------------------------------------------------------
+class dnodeView;
+class dnViewConstIterator;
+class dnPersistentStore;
+
+// ----------------------------------------------------------------------------
+// Constants
+// ----------------------------------------------------------------------------
+const uint DNVIEW_VERSION = 1;
+const uint DNVIEW_BYTE_ORDER_MARK = 0x01020304;
+const char DNVIEW_PATH_SEPARATOR = '/';
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+class dnViewFormatError: public dnError {
+public:
+  dnViewFormatError(const std::string &msg): dnError("Invalid DNV data: " + msg) {}
+};
+
+namespace Details {
+
+struct dnViewHeader {
+  char magic[4];
+  uint byteOrderMark;
+  uint version;
+  uint xdoubleSize;
+  uint reserved;
+  uint reserved2;
+  dnViewOffset rootOffset;
+  dnViewOffset totalSize;
+};
+
+struct dnViewRecord {
+  byte kind;
+  byte itemType;
+  unsigned short flags;
+  uint reserved;
+  uint64 count;
+  uint64 a;
+  uint64 b;
+};
+
+enum dnViewRecordFlags {
+  dvfNamed = 1 ///< parent with named children (name table present)
+};
+
+template<typename T>
+inline T dnViewReadRaw(const byte *ptr)
+{
+  T res;
+  memcpy(&res, ptr, sizeof(T));
+  return res;
+}
+
+} // namespace Details
+
+// ----------------------------------------------------------------------------
+// dnViewString
+// ----------------------------------------------------------------------------
+/// Reference to string stored inside of view buffer.
+class dnViewString {
+public:
+  dnViewString(): m_data(""), m_length(0) {}
+  dnViewString(const char *data, size_t length): m_data(data), m_length(length) {}
+
+  const char *data() const { return m_data; }
+  /// Returns null-terminated text
+  const char *c_str() const { return m_data; }
+  size_t length() const { return m_length; }
+  size_t size() const { return m_length; }
+  bool empty() const { return (m_length == 0); }
+
+  /// Returns copy of string (allocates memory)
+  dtpString str() const { return dtpString(m_data, m_length); }
+
+  int compare(const char *text, size_t length) const {
+    size_t minLen = (m_length < length) ? m_length : length;
+    int res = memcmp(m_data, text, minLen);
+    if (res == 0)
+      res = (m_length < length) ? -1 : ((m_length > length) ? 1 : 0);
+    return res;
+  }
+
+  bool operator==(const dnViewString &rhs) const { return (compare(rhs.m_data, rhs.m_length) == 0); }
+  bool operator!=(const dnViewString &rhs) const { return !(*this == rhs); }
+  bool operator==(const dtpString &rhs) const { return (compare(rhs.c_str(), rhs.length()) == 0); }
+  bool operator!=(const dtpString &rhs) const { return !(*this == rhs); }
+  bool operator==(const char *rhs) const { return (compare(rhs, strlen(rhs)) == 0); }
+  bool operator!=(const char *rhs) const { return !(*this == rhs); }
+private:
+  const char *m_data;
+  size_t m_length;
+};
+
+// ----------------------------------------------------------------------------
+// dnodeView
+// ----------------------------------------------------------------------------
+/// Read-only view of node stored in DNV buffer. Lightweight value type - can be copied freely.
+/// Array items are represented as views of array with item index.
+class dnodeView {
+public:
+  typedef dnode::size_type size_type;
+  static const size_type npos;
+
+  typedef dnViewConstIterator const_iterator;
+
+
+  /// Creates null view
+  dnodeView(): m_base(DTP_NULL), m_record(DTP_NULL), m_itemIndex(npos) {}
+
+  /// Returns root view of buffer, throws dnViewFormatError if buffer is not valid DNV data.
+  /// Only header is verified - function executes in constant time.
+  static dnodeView open(const void *data, size_t dataSize);
+
+  /// Verifies all offsets of tree, returns false if structure is damaged. Executes in O(n).
+  bool validate(size_t dataSize) const;
+
+  // -- type --
+  dnValueType getValueType() const {
+    if (m_record == DTP_NULL)
+      return vt_null;
+    if (m_itemIndex != npos)
+      return getItemType();
+    return static_cast<dnValueType>(m_record->kind);
+  }
+
+  bool isNull() const { return (getValueType() == vt_null); }
+  bool isParent() const { return (getValueType() == vt_parent); }
+  bool isArray() const { return (getValueType() == vt_array); }
+  bool isList() const { return (isParent() && !supportsNames()); }
+  bool isContainer() const { return (isParent() || isArray()); }
+  bool supportsNames() const { return (isParent() && ((m_record->flags & Details::dvfNamed) != 0)); }
+
+  /// Returns type of items for array, vt_datanode for parent.
+  dnValueType getElementType() const;
+
+  // -- container access --
+  size_type size() const {
+    if (isContainer())
+      return static_cast<size_type>(m_record->count);
+    return 0;
+  }
+
+  bool empty() const { return (size() == 0); }
+
+  dnodeView getElement(size_type index) const;
+  dnodeView getElement(const dtpString &name) const { return getElement(name.c_str(), name.length()); }
+  dnodeView getElement(const char *name) const { return getElement(name, strlen(name)); }
+  dnodeView getElement(const char *name, size_t nameLen) const;
+
+  /// Returns name of child or empty string for lists & arrays
+  dnViewString getElementName(size_type index) const;
+  void getElementName(size_type index, dtpString &output) const;
+
+  bool hasChild(const dtpString &name) const { return (indexOfName(name.c_str(), name.length()) != npos); }
+  bool hasChild(const char *name) const { return (indexOfName(name, strlen(name)) != npos); }
+
+  /// Finds child by name using sorted name index, returns npos if not found.
+  size_type indexOfName(const dtpString &name) const { return indexOfName(name.c_str(), name.length()); }
+  size_type indexOfName(const char *name, size_t nameLen) const;
+
+  /// Returns false if element not found
+  bool findElement(const char *name, size_t nameLen, dnodeView &output) const;
+  bool findElement(const dtpString &name, dnodeView &output) const { return findElement(name.c_str(), name.length(), output); }
+
+  /// Access element by path "name1/name2/3" - each path item is child name or index.
+  /// Returns false if path is not valid.
+  bool getElementByPath(const char *path, dnodeView &output, char separator = DNVIEW_PATH_SEPARATOR) const;
+  bool getElementByPath(const dtpString &path, dnodeView &output, char separator = DNVIEW_PATH_SEPARATOR) const
+  {
+    return getElementByPath(path.c_str(), output, separator);
+  }
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  // -- value access --
+  /// Returns value converted to a given type. Conversion rules are the same as for dnode.
+  template<typename ValueType>
+  ValueType getAs() const
+  {
+    dnValueType valueType = getValueType();
+    if (valueType == static_cast<dnValueType>(Details::dnValueTypeMeta<ValueType>::item_type))
+      return Details::dnViewReadRaw<ValueType>(getValuePtr());
+    dnValue helper;
+    getValue(helper);
+    return helper.getAs<ValueType>();
+  }
+
+  template<typename ValueType>
+  ValueType get(size_type index) const { return getElement(index).getAs<ValueType>(); }
+
+  template<typename ValueType>
+  ValueType get(const dtpString &name) const { return getElement(name).getAs<ValueType>(); }
+
+  /// Returns string value without copy, throws dnError if value is not a string.
+  dnViewString getStringRef() const;
+
+  /// Returns pointer to contiguous items of array of POD type, throws dnError if type does not match.
+  template<typename ValueType>
+  const ValueType *arrayData() const
+  {
+    if (!isArray() || (m_itemIndex != npos) ||
+        (getItemType() != static_cast<dnValueType>(Details::dnValueTypeMeta<ValueType>::item_type)))
+      throw dnError("Array type mismatch");
+    return reinterpret_cast<const ValueType *>(m_base + m_record->a);
+  }
+
+  /// Copies scalar value to output (strings: allocates memory).
+  void getValue(dnValue &output) const;
+
+  /// Creates full dnode copy of viewed structure.
+  void toNode(dnode &output) const;
+
+protected:
+  dnodeView(const byte *base, const Details::dnViewRecord *record, size_type itemIndex = npos):
+    m_base(base), m_record(record), m_itemIndex(itemIndex) {}
+
+  const Details::dnViewRecord *recordAt(dnViewOffset offset) const {
+    return reinterpret_cast<const Details::dnViewRecord *>(m_base + offset);
+  }
+
+  dnViewOffset offsetTableItem(dnViewOffset tableOffset, uint64 index) const {
+    return Details::dnViewReadRaw<dnViewOffset>(m_base + tableOffset + index * sizeof(dnViewOffset));
+  }
+
+  dnViewString stringAt(dnViewOffset offset) const {
+    uint64 len = Details::dnViewReadRaw<uint64>(m_base + offset);
+    return dnViewString(reinterpret_cast<const char *>(m_base + offset + sizeof(uint64)), static_cast<size_t>(len));
+  }
+
+  dnValueType getItemType() const { return static_cast<dnValueType>(m_record->itemType); }
+  const byte *getValuePtr() const;
+  void checkContainer() const;
+  void checkIndex(size_type index) const;
+  bool validateNode(const Details::dnViewRecord *record, size_t dataSize, uint depth) const;
+private:
+  friend class dnPersistentStore;
+  const byte *m_base;
+  const Details::dnViewRecord *m_record;
+  size_type m_itemIndex;
+};
+
+template<>
+dtpString dnodeView::getAs<dtpString>() const;
+
+// ----------------------------------------------------------------------------
+// dnViewConstIterator
+// ----------------------------------------------------------------------------
+/// Iterator over elements of container view, dereference returns element view.
+class dnViewConstIterator {
+public:
+  typedef dnodeView::size_type size_type;
+  typedef std::bidirectional_iterator_tag iterator_category;
+  typedef dnodeView value_type;
+  typedef ptrdiff_t difference_type;
+  typedef const dnodeView *pointer;
+  typedef const dnodeView &reference;
+
+  dnViewConstIterator(): m_pos(0) {}
+  dnViewConstIterator(const dnodeView &container, size_type pos): m_container(container), m_pos(pos) {}
+
+  reference operator*() const { m_item = m_container.getElement(m_pos); return m_item; }
+  pointer operator->() const { return &(operator*()); }
+  dnViewConstIterator &operator++() { ++m_pos; return *this; }
+  dnViewConstIterator operator++(int) { dnViewConstIterator res(*this); ++m_pos; return res; }
+  dnViewConstIterator &operator--() { --m_pos; return *this; }
+  dnViewConstIterator operator--(int) { dnViewConstIterator res(*this); --m_pos; return res; }
+  bool operator==(const dnViewConstIterator &rhs) const { return (m_pos == rhs.m_pos); }
+  bool operator!=(const dnViewConstIterator &rhs) const { return (m_pos != rhs.m_pos); }
+
+  size_type getIndex() const { return m_pos; }
+  dnViewString getName() const { return m_container.getElementName(m_pos); }
+private:
+  dnodeView m_container;
+  size_type m_pos;
+  mutable dnodeView m_item;
+};
+
+inline dnodeView::const_iterator dnodeView::begin() const
+{
+  return const_iterator(*this, 0);
+}
+
+inline dnodeView::const_iterator dnodeView::end() const
+{
+  return const_iterator(*this, size());
+}
+
+// ----------------------------------------------------------------------------
+// dnViewWriter
+// ----------------------------------------------------------------------------
+/// Writes dnode tree in DNV layout
+class dnViewWriter {
+public:
+  /// Replaces contents of output with DNV image of input
+  static void write(const dnode &input, std::vector<char> &output);
+  /// Writes DNV image of input to file, throws dnError on IO error
+  static void writeToFile(const dnode &input, const dtpString &fileName);
+  /// Returns size of item for a given array item type (0 for non-POD types)
+  static size_t getItemSize(dnValueType valueType);
+};
+
+// ----------------------------------------------------------------------------
+// dnViewMappedFile
+// ----------------------------------------------------------------------------
+/// DNV file mapped into memory (read-only).
+class dnViewMappedFile {
+public:
+  dnViewMappedFile();
+  explicit dnViewMappedFile(const dtpString &fileName);
+  ~dnViewMappedFile();
+
+  /// Maps file, throws dnError if file cannot be opened or it is not a valid DNV file.
+  void open(const dtpString &fileName);
+  void close();
+  bool isOpen() const;
+
+  const dnodeView &getRoot() const { return m_root; }
+  size_t getDataSize() const;
+private:
+  dnViewMappedFile(const dnViewMappedFile &);
+  dnViewMappedFile &operator=(const dnViewMappedFile &);
+private:
+  struct Impl;
+  Impl *m_impl;
+  dnodeView m_root;
+};
+
+} // namespace dtp
+
+#endif // _DTPDNODEVIEW_H__
@@ -405,6 +405,37 @@ bool YawlReaderBase::parseString(const dtpString &input)
   return true;
 }
 
+bool YawlReaderBase::parseChunk(const char *input, size_t inputLen)
+{
+  m_input = reinterpret_cast<unsigned char *>(const_cast<char *>(input));
+  m_inputLen = inputLen;
+  yajl_status stat = yajl_parse(m_hand, m_input, m_inputLen);
+  checkStatus(stat);
+  return true;
+}
+
+bool YawlReaderBase::parseComplete()
+{
+  yajl_status stat = yajl_parse_complete(m_hand);
+  checkStatus(stat);
+  return true;
+}
+
+bool YawlReaderBase::parseStream(std::istream &input, size_t bufferSize)
+{
+  std::vector<char> buffer(bufferSize);
+  std::streamsize readCnt;
+
+  while (input.good()) {
+    input.read(&buffer[0], bufferSize);
+    readCnt = input.gcount();
+    if (readCnt > 0)
+      parseChunk(&buffer[0], static_cast<size_t>(readCnt));
+  }
+
+  return parseComplete();
+}
+
 void YawlReaderBase::checkStatus(yajl_status stat)
 {
   if (stat != yajl_status_ok &&
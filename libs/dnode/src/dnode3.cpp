@@ -8,6 +8,18 @@
 // Created:     28/04/2012
 /////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <new>
+#include <ostream>
+#include <cstring>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#ifdef DATANODE_PERF_COUNTERS
+#include <boost/thread/tss.hpp>
+#endif
+
 #include "base/btypes.h"
 #include "base/date.h"
 
@@ -40,47 +52,162 @@ DN_ARRAY_TYPE_BINDER(date);
 DN_ARRAY_TYPE_BINDER(time);
 DN_ARRAY_TYPE_BINDER(datetime);
 
-// Required to define dynamic value conversion
-#define DN_VALUE_CAST_BINDER(a) const Details::dnValueDynamicCasterBinder<vt_##a> value_caster_binder_##a
-DN_VALUE_CAST_BINDER(bool);
-DN_VALUE_CAST_BINDER(byte);
-DN_VALUE_CAST_BINDER(int);
-DN_VALUE_CAST_BINDER(uint);
-DN_VALUE_CAST_BINDER(int64);
-DN_VALUE_CAST_BINDER(uint64);
-DN_VALUE_CAST_BINDER(float);
-DN_VALUE_CAST_BINDER(double);
-DN_VALUE_CAST_BINDER(xdouble);
-DN_VALUE_CAST_BINDER(string);
-DN_VALUE_CAST_BINDER(vptr);
-DN_VALUE_CAST_BINDER(date);
-DN_VALUE_CAST_BINDER(time);
-DN_VALUE_CAST_BINDER(datetime);
-
-// Required to define dynamic value conversion
-#define DN_COMP_STRATEGY_BINDER(a) const Details::dnValueCompareStrategyBinder<vt_##a> value_strategy_binder_##a
-DN_COMP_STRATEGY_BINDER(null);
-DN_COMP_STRATEGY_BINDER(array);
-DN_COMP_STRATEGY_BINDER(parent);
-DN_COMP_STRATEGY_BINDER(bool);
-DN_COMP_STRATEGY_BINDER(byte);
-DN_COMP_STRATEGY_BINDER(int);
-DN_COMP_STRATEGY_BINDER(uint);
-DN_COMP_STRATEGY_BINDER(int64);
-DN_COMP_STRATEGY_BINDER(uint64);
-DN_COMP_STRATEGY_BINDER(float);
-DN_COMP_STRATEGY_BINDER(double);
-DN_COMP_STRATEGY_BINDER(xdouble);
-DN_COMP_STRATEGY_BINDER(string);
-DN_COMP_STRATEGY_BINDER(vptr);
-DN_COMP_STRATEGY_BINDER(date);
-DN_COMP_STRATEGY_BINDER(time);
-DN_COMP_STRATEGY_BINDER(datetime);
+// Flat value conversion & comparison tables, rows & columns in dnValueType order
+#define DN_CONV_CAST(s, t) &dnValueCastCell<s, t>::cast
+#define DN_CONV_CAST_ROW(s) { \
+  DN_CONV_CAST(s, vt_null), DN_CONV_CAST(s, vt_parent), DN_CONV_CAST(s, vt_array), \
+  DN_CONV_CAST(s, vt_byte), DN_CONV_CAST(s, vt_int), DN_CONV_CAST(s, vt_uint), \
+  DN_CONV_CAST(s, vt_int64), DN_CONV_CAST(s, vt_uint64), DN_CONV_CAST(s, vt_string), \
+  DN_CONV_CAST(s, vt_bool), DN_CONV_CAST(s, vt_float), DN_CONV_CAST(s, vt_double), \
+  DN_CONV_CAST(s, vt_xdouble), DN_CONV_CAST(s, vt_vptr), DN_CONV_CAST(s, vt_date), \
+  DN_CONV_CAST(s, vt_time), DN_CONV_CAST(s, vt_datetime) }
+
+#define DN_CONV_BY_TYPE(m) { \
+  m(vt_null), m(vt_parent), m(vt_array), m(vt_byte), m(vt_int), m(vt_uint), \
+  m(vt_int64), m(vt_uint64), m(vt_string), m(vt_bool), m(vt_float), m(vt_double), \
+  m(vt_xdouble), m(vt_vptr), m(vt_date), m(vt_time), m(vt_datetime) }
+
+#define DN_CONV_COMPARE(t) &dnValueCompareCell<t>::compare
+#define DN_CONV_EQUALS(t) &dnValueCompareCell<t>::equals
+#define DN_CONV_DIRECT(t) (dnValueCompareMeta<t>::can_compare_dir != 0)
+
+const dnValueCastFunc dnValueConvMatrix::m_castTable[dnValueConvMatrix::type_count][dnValueConvMatrix::type_count] = {
+  DN_CONV_CAST_ROW(vt_null), DN_CONV_CAST_ROW(vt_parent), DN_CONV_CAST_ROW(vt_array),
+  DN_CONV_CAST_ROW(vt_byte), DN_CONV_CAST_ROW(vt_int), DN_CONV_CAST_ROW(vt_uint),
+  DN_CONV_CAST_ROW(vt_int64), DN_CONV_CAST_ROW(vt_uint64), DN_CONV_CAST_ROW(vt_string),
+  DN_CONV_CAST_ROW(vt_bool), DN_CONV_CAST_ROW(vt_float), DN_CONV_CAST_ROW(vt_double),
+  DN_CONV_CAST_ROW(vt_xdouble), DN_CONV_CAST_ROW(vt_vptr), DN_CONV_CAST_ROW(vt_date),
+  DN_CONV_CAST_ROW(vt_time), DN_CONV_CAST_ROW(vt_datetime)
+};
+
+const dnValueCompareFunc dnValueConvMatrix::m_compareTable[dnValueConvMatrix::type_count] = DN_CONV_BY_TYPE(DN_CONV_COMPARE);
+const dnValueEqualsFunc dnValueConvMatrix::m_equalsTable[dnValueConvMatrix::type_count] = DN_CONV_BY_TYPE(DN_CONV_EQUALS);
+const bool dnValueConvMatrix::m_directCompare[dnValueConvMatrix::type_count] = DN_CONV_BY_TYPE(DN_CONV_DIRECT);
+
+void dnValueConvMatrix::throwUnknownType(int valueType)
+{
+  throw std::runtime_error(dtpString("Unknown target value type for cast: ")+toString(valueType));
+}
 
 // ----------------------------------------------------------------------------
 // private classes
 // ----------------------------------------------------------------------------
 
+// ----------------------------------------------------------------------------
+// dnPerfCounters
+// ----------------------------------------------------------------------------
+#ifdef DATANODE_PERF_COUNTERS
+namespace dtp {
+namespace Details {
+DTP_THREAD_LOCAL dnPerfCounters dnPerfCountersLocal;
+} // namespace Details
+} // namespace dtp
+#endif
+
+bool dnPerfStats::enabled()
+{
+#ifdef DATANODE_PERF_COUNTERS
+  return true;
+#else
+  return false;
+#endif
+}
+
+dnPerfCounters dnPerfStats::snapshot()
+{
+  dnPerfCounters res;
+#ifdef DATANODE_PERF_COUNTERS
+  res = dnPerfCountersLocal;
+#else
+  res.clear();
+#endif
+  return res;
+}
+
+void dnPerfStats::reset()
+{
+#ifdef DATANODE_PERF_COUNTERS
+  dnPerfCountersLocal.clear();
+#endif
+}
+
+dtpString dnPerfStats::toString(const dnPerfCounters &counters)
+{
+  dtpString res;
+  res += "bridge_allocs="+::toString(counters.bridgeAllocs);
+  res += "; pool_hits="+::toString(counters.poolHits);
+  res += "; pool_misses="+::toString(counters.poolMisses);
+  res += "; deep_copies="+::toString(counters.deepCopies);
+  res += "; string_allocs="+::toString(counters.stringAllocs);
+  res += "; type_conversions="+::toString(counters.typeConversions);
+  res += "; exceptions="+::toString(counters.exceptionsThrown);
+  return res;
+}
+
+// ----------------------------------------------------------------------------
+// dnBridgePool
+// ----------------------------------------------------------------------------
+/// Object pool for bridges.
+/// With DATANODE_PERF_COUNTERS a small per-thread cache of released slots is
+/// kept, slot taken from the cache is counted as pool hit, slot taken from
+/// ObjectPool as pool miss. Otherwise ObjectPool is used directly.
+#ifndef DATANODE_PERF_COUNTERS
+template<class T>
+class dnBridgePool {
+public:
+  static T *newObject() { return ObjectPool<T>::newObject(); }
+  static void deleteObject(T *obj) { ObjectPool<T>::deleteObject(obj); }
+};
+#else
+template<class T>
+class dnBridgePool {
+public:
+  static T *newObject() {
+    SlotCache *cache = localCache();
+    if (cache->count > 0) {
+      DN_PERF_INC(poolHits);
+      return new (cache->slots[--cache->count]) T();
+    }
+    DN_PERF_INC(poolMisses);
+    return ObjectPool<T>::newObject();
+  }
+
+  static void deleteObject(T *obj) {
+    SlotCache *cache = localCache();
+    if (cache->count < cache_size) {
+      obj->~T();
+      cache->slots[cache->count++] = obj;
+    } else {
+      ObjectPool<T>::deleteObject(obj);
+    }
+  }
+protected:
+  enum { cache_size = 32 };
+
+  struct SlotCache {
+    SlotCache(): count(0) {}
+    // slots are returned to ObjectPool on thread exit
+    ~SlotCache() {
+      while (count > 0)
+        ObjectPool<T>::deleteObject(new (slots[--count]) T());
+    }
+    void *slots[cache_size];
+    uint count;
+  };
+
+  static SlotCache *localCache() {
+    // never destroyed - avoids cleanup after ObjectPool at process exit
+    static boost::thread_specific_ptr<SlotCache> *caches = new boost::thread_specific_ptr<SlotCache>();
+    SlotCache *res = caches->get();
+    if (res == DTP_NULL) {
+      res = new SlotCache();
+      caches->reset(res);
+    }
+    return res;
+  }
+};
+#endif
+
 // ----------------------------------------------------------------------------
 // dnValueBridge
 // ----------------------------------------------------------------------------
@@ -120,10 +247,10 @@ public:
     virtual void setPosEnd() {
       setPos(this->size());
     }
-    virtual void incPos(int value = 1) {
+    virtual void incPos(dnPosType value = 1) {
       setPos(m_index + value);
     }
-    virtual void decPos(int value = 1) {
+    virtual void decPos(dnPosType value = 1) {
       setPos(m_index - value);
     }
 
@@ -131,8 +258,8 @@ public:
     virtual bool isEqualPos(const dnValueBridge& value) const {
         return (this->getPos() == value.getPos());
     }
-    virtual int calcPosDiff(const dnValueBridge& value) const {
-        return (this->getPos() - value.getPos());
+    virtual dnPosType calcPosDiff(const dnValueBridge& value) const {
+        return static_cast<dnPosType>(this->getPos() - value.getPos());
     }
 private:
     size_type m_index;
@@ -175,7 +302,7 @@ public:
 
     virtual void release_to_pool() {
 #ifdef DATANODE_POOL_BRIDGE
-      ObjectPool<this_type>::deleteObject(this);
+      dnBridgePool<this_type>::deleteObject(this);
 #endif
     }
 
@@ -192,7 +319,7 @@ public:
 #ifndef DATANODE_POOL_BRIDGE
         bridge = new this_type(*this);
 #else
-        bridge = ObjectPool<this_type>::newObject();
+        bridge = dnBridgePool<this_type>::newObject();
         try {
           bridge->copyFrom(*this);
         } catch (...) {
@@ -264,7 +391,7 @@ public:
 
     virtual void release_to_pool() {
 #ifdef DATANODE_POOL_BRIDGE
-      ObjectPool<this_type>::deleteObject(this);
+      dnBridgePool<this_type>::deleteObject(this);
 #endif
     }
 
@@ -284,7 +411,7 @@ public:
 #ifndef DATANODE_POOL_BRIDGE
         bridge = new this_type(*this);
 #else
-        bridge = ObjectPool<this_type>::newObject();
+        bridge = dnBridgePool<this_type>::newObject();
         try {
           bridge->copyFrom(*this);
         } catch (...) {
@@ -329,7 +456,7 @@ public:
 
     virtual void release_to_pool() {
 #ifdef DATANODE_POOL_BRIDGE
-      ObjectPool<this_type>::deleteObject(this);
+      dnBridgePool<this_type>::deleteObject(this);
 #endif
     }
 
@@ -348,7 +475,7 @@ public:
 #ifndef DATANODE_POOL_BRIDGE
         bridge = new this_type(*this);
 #else
-        bridge = ObjectPool<this_type>::newObject();
+        bridge = dnBridgePool<this_type>::newObject();
         try {
           bridge->copyFrom(*this);
         } catch (...) {
@@ -420,7 +547,7 @@ public:
 
     virtual void release_to_pool() {
 #ifdef DATANODE_POOL_BRIDGE
-      ObjectPool<this_type>::deleteObject(this);
+      dnBridgePool<this_type>::deleteObject(this);
 #endif
     }
 
@@ -430,7 +557,7 @@ public:
 #ifndef DATANODE_POOL_BRIDGE
         bridge = new this_type(*this);
 #else
-        bridge = ObjectPool<this_type>::newObject();
+        bridge = dnBridgePool<this_type>::newObject();
         try {
           bridge->copyFrom(*this);
         } catch (...) {
@@ -471,7 +598,7 @@ static dnode::dnValueBridge *newValueBridgeForArrayAsVector(ArrayType &arr)
 #ifndef DATANODE_POOL_BRIDGE
         bridge = new bridge_type(this);
 #else
-        bridge = ObjectPool<bridge_type>::newObject();
+        bridge = dnBridgePool<bridge_type>::newObject();
         try {
           bridge->setTarget(&arr, &(arr.getItems()));
         } catch (...) {
@@ -500,7 +627,7 @@ public:
 
     virtual void release_to_pool() {
 #ifdef DATANODE_POOL_BRIDGE
-      ObjectPool<this_type>::deleteObject(this);
+      dnBridgePool<this_type>::deleteObject(this);
 #endif
     }
 
@@ -516,7 +643,7 @@ public:
 #ifndef DATANODE_POOL_BRIDGE
         bridge = new this_type(*this);
 #else
-        bridge = ObjectPool<this_type>::newObject();
+        bridge = dnBridgePool<this_type>::newObject();
         try {
           bridge->copyFrom(*this);
         } catch (...) {
@@ -541,7 +668,7 @@ public:
     }
 
     virtual void getAsItem(dnode& output) const {
-        output = m_items->at(getPos());
+        output = getItemsR()->at(getPos());
     }
 
     virtual void setAsItem(const dnValue& value) {
@@ -550,7 +677,7 @@ public:
     }
 
     virtual void getAsItem(dnValue& output) const {
-        output = m_items->at(getPos());
+        output = getItemsR()->at(getPos());
     }
 
     bool supportsRefs() const
@@ -570,8 +697,10 @@ public:
 
     const dnode &getAsNode(dnode &helper) const
     {
-        return m_items->at(getPos());
+        return getItemsR()->at(getPos());
     }
+protected:
+    const dnChildColnBase *getItemsR() const { return m_items; }
 private:
     dnChildColnBase *m_items;
 };
@@ -594,7 +723,7 @@ public:
 
     virtual void release_to_pool() {
 #ifdef DATANODE_POOL_BRIDGE
-      ObjectPool<this_type>::deleteObject(this);
+      dnBridgePool<this_type>::deleteObject(this);
 #endif
     }
 
@@ -610,7 +739,7 @@ public:
 #ifndef DATANODE_POOL_BRIDGE
         bridge = new this_type(*this);
 #else
-        bridge = ObjectPool<this_type>::newObject();
+        bridge = dnBridgePool<this_type>::newObject();
         try {
           bridge->copyFrom(*this);
         } catch (...) {
@@ -665,7 +794,7 @@ public:
     }
 
     virtual void getAsItem(dnode& output) const {
-        output = m_items->getByName(m_namePos);
+        output = getItemsR()->getByNameR(m_namePos);
     }
 
     virtual void setAsItem(const dnValue& value) {
@@ -674,7 +803,7 @@ public:
     }
 
     virtual void getAsItem(dnValue& output) const {
-        output = m_items->getByName(m_namePos);
+        output = getItemsR()->getByNameR(m_namePos);
     }
 
     bool supportsRefs() const
@@ -694,8 +823,10 @@ public:
 
     const dnode &getAsNode(dnode &helper) const
     {
-        return m_items->getByName(m_namePos);
+        return getItemsR()->getByNameR(m_namePos);
     }
+protected:
+    const dnChildColnBase *getItemsR() const { return m_items; }
 private:
     dnChildColnBase *m_items;
     dtpString m_namePos;
@@ -889,6 +1020,9 @@ void dnode::initValueFrom( const dnode& src)
 {
   if (src.isParent())
   {
+    DN_PERF_INC(deepCopies);
+    if (src.isDeque() && !isParent())
+      setAsParent(new dnChildColnDeque());
     setupChildren(!src.isList()).copyItemsFrom(
       src.getChildrenR()
     );
@@ -898,6 +1032,7 @@ void dnode::initValueFrom( const dnode& src)
     //initArray(src.getArrayR()->getValueType());
     //getArray()->copyFrom(src.getArrayR());
     setAsArray(src.getArrayR()->clone());
+    DN_PERF_INC(deepCopies);
   } else {
     this->initScalarFrom(src);
   }
@@ -1169,6 +1304,9 @@ dnode::dnode(dnInitContainerType value)
     case ict_list:
       setAsList();
       break;
+    case ict_deque:
+      setAsDeque();
+      break;
     default:
       setAsParent();
   }
@@ -1245,6 +1383,84 @@ const dnChildColnBase &dnode::getChildrenR() const
   }
 }
 
+void dnode::freeze()
+{
+  Details::dnFrozenNamePoolPtr namePool(new Details::dnFrozenNamePool());
+  intFreeze(namePool);
+  namePool->finish();
+}
+
+bool dnode::isFrozen() const
+{
+  const dnChildColnBase *ptr = isParent() ? getChildrenPtrR() : DTP_NULL;
+  return (ptr != DTP_NULL) && ptr->isFrozen();
+}
+
+void dnode::intFreeze(const Details::dnFrozenNamePoolPtr &namePool)
+{
+  dnChildColnBase *children = isParent() ? getChildrenPtr() : DTP_NULL;
+  if ((children == DTP_NULL) || children->isFrozen())
+    return;
+
+  // nested containers first, so that failure leaves valid (partially frozen) tree
+  for(size_type i=0, epos = children->size(); i != epos; i++)
+    children->at(i).intFreeze(namePool);
+
+  setAsParent(new Details::dnChildColnFrozen(*children, namePool));
+}
+
+namespace {
+
+/// Returns number of nodes relocated by dnode::compact()
+size_t dnCompactNodeCount(const dnode &node)
+{
+  const dnChildColnBase *children = node.isParent() ? &node.getChildrenR() : DTP_NULL;
+  if ((children == DTP_NULL) || children->isFrozen())
+    return 0;
+
+  size_t res = children->isDeque() ? 0 : children->size();
+  for(dnode::size_type i=0, epos = children->size(); i != epos; i++)
+    res += dnCompactNodeCount(children->at(i));
+
+  return res;
+}
+
+} // namespace
+
+void dnode::compact()
+{
+  Details::dnCompactBlockPtr block(new Details::dnCompactBlock(dnCompactNodeCount(*this)));
+  intCompact(block);
+}
+
+bool dnode::isCompact() const
+{
+  const dnChildColnBase *ptr = isParent() ? getChildrenPtrR() : DTP_NULL;
+  return (ptr != DTP_NULL) && ptr->isCompact();
+}
+
+void dnode::intCompact(const Details::dnCompactBlockPtr &block)
+{
+  if (isArray()) {
+    getArray()->shrinkToFit();
+    return;
+  }
+
+  dnChildColnBase *children = isParent() ? getChildrenPtr() : DTP_NULL;
+  if ((children == DTP_NULL) || children->isFrozen())
+    return;
+
+  // deque keeps its own storage, only nested containers are compacted
+  if (!children->isDeque()) {
+    setAsParent(new Details::dnChildColnCompact(*children, block));
+    children = getChildrenPtr();
+  }
+
+  // children of this node first, then nested containers - depth-first order of containers
+  for(size_type i=0, epos = children->size(); i != epos; i++)
+    children->at(i).intCompact(block);
+}
+
 dnChildColnBase *dnode::getChildrenPtr()
 {
   if (isParent()) {
@@ -1280,6 +1496,28 @@ void dnode::setAsList()
 
 }
 
+void dnode::setAsDeque()
+{
+  if (!isDeque()) {
+    dnode res;
+    res.setAsParent(new dnChildColnDeque());
+    if (isList()) {
+      // move items, from the end to avoid shifting of source vector
+      dnChildColnBase &src = getChildren();
+      dnChildColnBase &dest = res.getChildren();
+      while (!src.empty())
+        dest.insert(0, src.extractChild(src.size() - 1));
+    }
+    swap(res);
+  }
+}
+
+bool dnode::isDeque() const
+{
+  const dnChildColnBase *ptr = isParent() ? getChildrenPtrR() : DTP_NULL;
+  return (ptr != DTP_NULL) && ptr->isDeque();
+}
+
 void dnode::setAsNull()
 {
   clear();
@@ -1322,7 +1560,7 @@ void dnode::intAddChild(const dtpString &name, dnode *child)
   setupChildren(true).insert(name, child);
 }
 
-dnode *dnode::extractChild(int index)
+dnode *dnode::extractChild(dnPosType index)
 {
   return getChildren().extractChild(index);
 }
@@ -1591,18 +1829,18 @@ bool dnode::empty() const
     return true;
 }
 
-dnode &dnode::getElement(int index, dnode &output) const
+dnode &dnode::getElement(dnPosType index, dnode &output) const
 {
   if (isArray())
     getArrayR()->getItem(index, output);
   else if (isParent())
-    output = const_cast<dnChildColnBase *>(getChildrenPtrR())->at(index);
+    output = getChildrenPtrR()->at(index);
   else
     throwNotContainer();
   return output;
 }
 
-const dnode dnode::getElement(int index) const
+const dnode dnode::getElement(dnPosType index) const
 {
   dnode res;
   getElement(index, res);
@@ -1665,7 +1903,7 @@ bool dnode::hasElement(const dtpString &name) const
     return false;
 }
 
-dnValueType dnode::getElementType(int index) const
+dnValueType dnode::getElementType(dnPosType index) const
 {
   dnValueType res;
   if (isArray()) {
@@ -1723,7 +1961,7 @@ dnValueType dnode::getElementType() const
   return res;
 }
 
-void dnode::forceElementType(int index, dnValueType valueType)
+void dnode::forceElementType(dnPosType index, dnValueType valueType)
 {
   if (isArray()) {
     dnValueType oldValType;
@@ -1744,6 +1982,59 @@ void dnode::forceElementType(int index, dnValueType valueType)
   }
 }
 
+namespace {
+
+typedef dnArray *(*dnPodArrayConvFunc)(const dnArray *src, dnValueType targetType);
+
+/// Converts all items of POD array in a single typed loop
+template<typename SrcType, typename TargetType>
+dnArray *dnConvertPodArray(const dnArray *src, dnValueType targetType)
+{
+  const std::vector<SrcType> &srcItems = checked_cast<const dnArrayOfPod<SrcType> *>(src)->getItems();
+  DTP_UNIQUE_PTR(dnArrayOfPod<TargetType>) res(new dnArrayOfPod<TargetType>(targetType));
+  std::vector<TargetType> &outItems = res->getItems();
+  size_t itemCount = srcItems.size();
+
+  outItems.resize(itemCount);
+  if (itemCount > 0) {
+    const SrcType *inPtr = &srcItems[0];
+    TargetType *outPtr = &outItems[0];
+    for(size_t i=0; i != itemCount; i++)
+      outPtr[i] = static_cast<TargetType>(inPtr[i]);
+  }
+
+  return res.release();
+}
+
+/// Index of array value type stored directly in vector, -1 if array stores nodes
+int dnPodArrayConvIndex(dnValueType valueType)
+{
+  switch (valueType) {
+    case vt_byte: return 0;
+    case vt_int: return 1;
+    case vt_uint: return 2;
+    case vt_int64: return 3;
+    case vt_uint64: return 4;
+    case vt_float: return 5;
+    case vt_double: return 6;
+    case vt_xdouble: return 7;
+    default: return -1;
+  }
+}
+
+#define DN_POD_CONV(s, t) &dnConvertPodArray<s, t>
+#define DN_POD_CONV_ROW(s) { DN_POD_CONV(s, byte), DN_POD_CONV(s, int), DN_POD_CONV(s, uint), \
+  DN_POD_CONV(s, int64), DN_POD_CONV(s, uint64), \
+  DN_POD_CONV(s, float), DN_POD_CONV(s, double), DN_POD_CONV(s, xdouble) }
+
+const dnPodArrayConvFunc dnPodArrayConvTable[8][8] = {
+  DN_POD_CONV_ROW(byte), DN_POD_CONV_ROW(int), DN_POD_CONV_ROW(uint),
+  DN_POD_CONV_ROW(int64), DN_POD_CONV_ROW(uint64),
+  DN_POD_CONV_ROW(float), DN_POD_CONV_ROW(double), DN_POD_CONV_ROW(xdouble)
+};
+
+} // namespace
+
 void dnode::forceElementTypeAll(dnValueType valueType)
 {
   size_t aSize = size();
@@ -1754,20 +2045,23 @@ void dnode::forceElementTypeAll(dnValueType valueType)
     if (oldValType == vt_datanode) {
       dnode item;
       dnArray *myArray = getArray();
-      for(uint i=0; i != aSize; i++) 
+      for(size_type i=0; i != aSize; i++)
       {
         myArray->getItem(i, item);
         item.convertTo(valueType);
         myArray->setItem(i, item);
       }
-    } else {
-      if (oldValType != valueType)
+    } else if (oldValType != valueType) {
+      int srcIndex = dnPodArrayConvIndex(oldValType);
+      int targetIndex = dnPodArrayConvIndex(valueType);
+      if ((srcIndex < 0) || (targetIndex < 0))
         throw dnError("Cannot change value type inside array");
+      setAsArray(dnPodArrayConvTable[srcIndex][targetIndex](getArrayR(), valueType));
     }
   } else if (isParent()) {
     dnChildColnBase *coln = getChildrenPtr();
 
-    for(uint i=0; i != aSize; i++) 
+    for(size_type i=0; i != aSize; i++)
     {
       coln->at(i).convertTo(valueType);
     }
@@ -1778,14 +2072,14 @@ void dnode::forceElementTypeAll(dnValueType valueType)
   }
 }
 
-const dtpString dnode::getElementName(int index) const
+const dtpString dnode::getElementName(dnPosType index) const
 {
   dtpString res;
   getElementName(index, res);
   return res;
 }
 
-void dnode::getElementName(int index, dtpString &output) const
+void dnode::getElementName(dnPosType index, dtpString &output) const
 {
   if (isArray()) {
     output = "";
@@ -1796,14 +2090,14 @@ void dnode::getElementName(int index, dtpString &output) const
   }
 }
 
-dnode *dnode::cloneElement(int index) const
+dnode *dnode::cloneElement(dnPosType index) const
 {
   DTP_UNIQUE_PTR(dnode) guard(new dnode());
   getElement(index, *guard);
   return guard.release();
 }
 
-void dnode::setElement(int index, const dnode &value)
+void dnode::setElement(dnPosType index, const dnode &value)
 {
   if (isArray())
     getArray()->setItem(index, value);
@@ -1830,7 +2124,7 @@ void dnode::setElement(const dtpString &aName, const dnode &value)
     throwNotContainer();
 }
 
-void dnode::setElementValue(int index, const dnode &value)
+void dnode::setElementValue(dnPosType index, const dnode &value)
 {
   if (isArray()) {
     getArray()->setItemValue(index, value);
@@ -1962,7 +2256,7 @@ void dnode::eatElement(dnode& src)
   }
 }
 
-void dnode::eraseElement(uint index)
+void dnode::eraseElement(dnSizeType index)
 {
   assert(index < size());
   if (isArray())
@@ -1973,7 +2267,7 @@ void dnode::eraseElement(uint index)
     throwNotContainer();
 }
 
-void dnode::eraseFrom(uint index)
+void dnode::eraseFrom(dnSizeType index)
 {
   assert(index < size());
   if (isArray())
@@ -1984,6 +2278,22 @@ void dnode::eraseFrom(uint index)
     throwNotContainer();
 }
 
+void dnode::eraseElements(dnSizeType index, dnSizeType count)
+{
+  assert(index <= size());
+  assert(count <= size() - index);
+  if (count == 0) {
+    if (!isContainer())
+      throwNotContainer();
+  }
+  else if (isArray())
+    getArray()->eraseRange(index, count);
+  else if (isParent())
+    getChildrenPtr()->eraseRange(index, count);
+  else
+    throwNotContainer();
+}
+
 void dnode::clearValue()
 {
   clear();
@@ -2079,7 +2389,7 @@ void dnode::resize(size_type newSize)
     throwNotContainer();
 }
 
-const dnode &dnode::operator[](int idx) const
+const dnode &dnode::operator[](dnPosType idx) const
 {
   const dnChildColnBase *ptr = getChildrenPtrR();
   return ptr->at(idx);
@@ -2091,7 +2401,7 @@ const dnode &dnode::operator[](const dtpString &str_idx) const
   return ptr->getByNameR(str_idx);
 }
 
-dnode &dnode::operator[](int idx)
+dnode &dnode::operator[](dnPosType idx)
 {
   return getChildrenPtr()->at(idx);
 }
@@ -2474,19 +2784,19 @@ void dnode::setDateTime(const dtpString &a_name, fdatetime_t value)
 }
 
 //
-dtpString dnode::getString(int a_index) const
+dtpString dnode::getString(dnPosType a_index) const
 {
   dnode resNode;
   return getNode(a_index, resNode).getAs<dtpString>();
 }
 
-bool dnode::getBool(int a_index) const
+bool dnode::getBool(dnPosType a_index) const
 {
   dnode resNode;
   return getNode(a_index, resNode).getAs<bool>();
 }
 
-int dnode::getInt(int a_index) const
+int dnode::getInt(dnPosType a_index) const
 {
   //--- optimized version:
   int res;
@@ -2504,13 +2814,13 @@ int dnode::getInt(int a_index) const
   //---
 }
 
-byte dnode::getByte(int a_index) const
+byte dnode::getByte(dnPosType a_index) const
 {
   dnode resNode;
   return getNode(a_index, resNode).getAs<byte>();
 }
 
-uint dnode::getUInt(int a_index) const
+uint dnode::getUInt(dnPosType a_index) const
 {
   //--- optimized version:
   uint res;
@@ -2528,19 +2838,19 @@ uint dnode::getUInt(int a_index) const
   //---
 }
 
-int64 dnode::getInt64(int a_index) const
+int64 dnode::getInt64(dnPosType a_index) const
 {
   dnode resNode;
   return getNode(a_index, resNode).getAs<int64>();
 }
 
-uint64 dnode::getUInt64(int a_index) const
+uint64 dnode::getUInt64(dnPosType a_index) const
 {
   dnode resNode;
   return getNode(a_index, resNode).getAs<uint64>();
 }
 
-float dnode::getFloat(int a_index) const
+float dnode::getFloat(dnPosType a_index) const
 {
   //--- optimized version:
   float res;
@@ -2558,7 +2868,7 @@ float dnode::getFloat(int a_index) const
   //---
 }
 
-double dnode::getDouble(int a_index) const
+double dnode::getDouble(dnPosType a_index) const
 {
   //--- optimized version:
   double res;
@@ -2575,20 +2885,20 @@ double dnode::getDouble(int a_index) const
   //---
 }
 
-xdouble dnode::getXDouble(int a_index) const
+xdouble dnode::getXDouble(dnPosType a_index) const
 {
   dnode resNode;
   return getNode(a_index, resNode).getAs<xdouble>();
 }
 
-void_ptr dnode::getVoidPtr(int a_index) const
+void_ptr dnode::getVoidPtr(dnPosType a_index) const
 {
   dnode resNode;
   return getNode(a_index, resNode).getAs<void_ptr>();
 }
 
 // setters
-void dnode::setString(int a_index, const dtpString &value)
+void dnode::setString(dnPosType a_index, const dtpString &value)
 {
   if (isArray()) {
     dnode bufNode;
@@ -2599,7 +2909,7 @@ void dnode::setString(int a_index, const dtpString &value)
   }
 }
 
-void dnode::setString(int a_index, const char *value)
+void dnode::setString(dnPosType a_index, const char *value)
 {
   if (isArray()) {
     dnode bufNode;
@@ -2610,7 +2920,7 @@ void dnode::setString(int a_index, const char *value)
   }
 }
 
-void dnode::setBool(int a_index, bool value)
+void dnode::setBool(dnPosType a_index, bool value)
 {
   if (isArray()) {
     dnode bufNode;
@@ -2621,7 +2931,7 @@ void dnode::setBool(int a_index, bool value)
   }
 }
 
-void dnode::setInt(int a_index, int value)
+void dnode::setInt(dnPosType a_index, int value)
 {
   if (isArray()) {
     dnode bufNode;
@@ -2632,7 +2942,7 @@ void dnode::setInt(int a_index, int value)
   }
 }
 
-void dnode::setByte(int a_index, byte value)
+void dnode::setByte(dnPosType a_index, byte value)
 {
   if (isArray()) {
     dnode bufNode;
@@ -2643,7 +2953,7 @@ void dnode::setByte(int a_index, byte value)
   }
 }
 
-void dnode::setUInt(int a_index, uint value)
+void dnode::setUInt(dnPosType a_index, uint value)
 {
   if (isArray()) {
     dnode bufNode;
@@ -2654,7 +2964,7 @@ void dnode::setUInt(int a_index, uint value)
   }
 }
 
-void dnode::setInt64(int a_index, int64 value)
+void dnode::setInt64(dnPosType a_index, int64 value)
 {
   if (isArray()) {
     dnode bufNode;
@@ -2665,7 +2975,7 @@ void dnode::setInt64(int a_index, int64 value)
   }
 }
 
-void dnode::setUInt64(int a_index, uint64 value)
+void dnode::setUInt64(dnPosType a_index, uint64 value)
 {
   if (isArray()) {
     dnode bufNode;
@@ -2676,7 +2986,7 @@ void dnode::setUInt64(int a_index, uint64 value)
   }
 }
 
-void dnode::setFloat(int a_index, float value)
+void dnode::setFloat(dnPosType a_index, float value)
 {
   if (isArray()) {
     dnode bufNode;
@@ -2687,7 +2997,7 @@ void dnode::setFloat(int a_index, float value)
   }
 }
 
-void dnode::setDouble(int a_index, double value)
+void dnode::setDouble(dnPosType a_index, double value)
 {
   if (isArray()) {
     dnode bufNode;
@@ -2698,7 +3008,7 @@ void dnode::setDouble(int a_index, double value)
   }
 }
 
-void dnode::setXDouble(int a_index, xdouble value)
+void dnode::setXDouble(dnPosType a_index, xdouble value)
 {
   if (isArray()) {
     dnode bufNode;
@@ -2709,7 +3019,7 @@ void dnode::setXDouble(int a_index, xdouble value)
   }
 }
 
-void dnode::setVoidPtr(int a_index, void_ptr value)
+void dnode::setVoidPtr(dnPosType a_index, void_ptr value)
 {
   if (isArray()) {
     dnode bufNode;
@@ -2727,76 +3037,209 @@ dtpString dnode::dumpHierarchy() const
   return res;
 }
 
+// ----------------------------------------------------------------------------
+// dnDumpWriter
+// ----------------------------------------------------------------------------
+void dnDumpStreamSink::write(const char *text, size_t length)
+{
+  m_output.write(text, static_cast<std::streamsize>(length));
+}
+
+namespace dtp {
+namespace Details {
+
+/// Writes dump text to sink, keeps indent & applies limits of dnDumpOptions
+class dnDumpWriter {
+public:
+  dnDumpWriter(dnDumpSink &sink, const dnDumpOptions &options, const dtpString &indent):
+    m_sink(sink), m_options(options), m_indent(indent), m_depth(0), m_size(0), m_complete(true), m_stopped(false) {}
+
+  void write(const char *text, size_t length) {
+    if (m_stopped)
+      return;
+    if ((m_options.maxSize > 0) && (m_size + length > m_options.maxSize)) {
+      m_sink.write(text, static_cast<size_t>(m_options.maxSize - m_size));
+      m_sink.write("...", 3);
+      m_size = m_options.maxSize;
+      m_complete = false;
+      m_stopped = true;
+      return;
+    }
+    m_sink.write(text, length);
+    m_size += length;
+  }
+
+  void write(const char *text) { write(text, strlen(text)); }
+  void write(const dtpString &text) { write(text.c_str(), text.length()); }
+  void writeIndent() { write(m_indent); }
+
+  /// Write value with characters used by dump format replaced by "?"
+  void writeValue(const dtpString &text) {
+    size_t pos = 0;
+    for(size_t i = 0, epos = text.length(); i < epos; ++i) {
+      char c = text[i];
+      if ((c == '[') || (c == ']') || (c == ':')) {
+        write(text.c_str() + pos, i - pos);
+        write("?", 1);
+        pos = i + 1;
+      }
+    }
+    write(text.c_str() + pos, text.length() - pos);
+  }
+
+  /// Returns <false> if contents of containers on current level should be skipped
+  bool enter() {
+    if ((m_options.maxDepth > 0) && (m_depth >= m_options.maxDepth)) {
+      m_complete = false;
+      return false;
+    }
+    m_depth++;
+    m_indent.append("  ");
+    return true;
+  }
+
+  void leave() {
+    m_depth--;
+    m_indent.resize(m_indent.length() - 2);
+  }
+
+  bool stopped() const { return m_stopped; }
+  bool complete() const { return m_complete; }
+private:
+  dnDumpSink &m_sink;
+  const dnDumpOptions &m_options;
+  dtpString m_indent;
+  uint m_depth;
+  uint64 m_size;
+  bool m_complete;
+  bool m_stopped;
+};
+
+} // namespace Details
+} // namespace dtp
+
 dtpString dnode::dump(const dtpString &indent, const dtpString &name) const
 {
   dtpString res;
-  res = indent + "{";
-  if (!name.empty())
-    res += "head:[name="+name+"];";
-  res += "\n"+indent;
-  if (isArray())
-  {
-    res += "as_array:[count="+toString(const_cast<dnode *>(this)->getArray()->size())+"]";
-    res += "[item_type="+toString(int(const_cast<dnode *>(this)->getArray()->getValueType()))+"]";
-    res += "[items="+dumpItems(indent+"  ")+"]";
-    res += "\n";
-  } else if (isParent()) {
-    res += "as_parent:[count="+toString(const_cast<dnode *>(this)->getChildren().size())+"]";
-    res += "[children="+dumpChildren(indent+"  ")+"]";
-    res += "\n";
-  } else {
-    res += "as_scalar:[type="+toString(int(const_cast<dnode *>(this)->getValueType()))+"]";
-    res += "[value="+dumpValue(indent+"  ")+"]";
-    res += "\n";
-  }
+  dnDumpStringSink sink(res);
+  dnDumpOptions options;
+  dnDumpWriter writer(sink, options, indent);
+  intDump(writer, name);
   return res;
 }
 
-dtpString dnode::dumpItems(const dtpString &indent) const
+bool dnode::dump(std::ostream &output, const dnDumpOptions &options) const
 {
-  dtpString res;
+  dnDumpStreamSink sink(output);
+  return dump(sink, options);
+}
 
-  if (!getArrayR())
-    res += indent+"array_not_rdy";
-  else {
-    size_type cnt = getArrayR()->size();
-    dnode node;
-    for(size_type i=0; i < cnt; ++i)
-    {
-      getArrayR()->getItem(i, node);
-      res += indent+node.getAs<dtpString>()+";\n";
-    }
-  }
-  return res;
+bool dnode::dump(dnDumpSink &output, const dnDumpOptions &options) const
+{
+  dnDumpWriter writer(output, options, "");
+  intDump(writer, "");
+  return writer.complete();
 }
 
-dtpString dnode::dumpChildren(const dtpString &indent) const
+void dnode::intDump(dnDumpWriter &writer, const dtpString &name) const
 {
-  dtpString res;
+  writer.writeIndent();
+  writer.write("{");
+  if (!name.empty()) {
+    writer.write("head:[name=");
+    writer.write(name);
+    writer.write("];");
+  }
+  writer.write("\n");
+  writer.writeIndent();
 
-  if (!getChildrenPtrR())
-    res += indent+"children_not_rdy";
-  else {
-    size_type cnt = const_cast<dnode *>(this)->getChildren().size();
-    dnChildColnBase &children = const_cast<dnode *>(this)->getChildren();
-    for(size_type i=0; i < cnt; ++i)
-      res += children.at(i).dump(indent, children.getName(i))+";\n";
+  if (isArray())
+  {
+    const dnArray *arr = getArrayR();
+    writer.write("as_array:[count="+toString(arr ? arr->size() : 0)+"]");
+    writer.write("[item_type="+toString(int(arr ? arr->getValueType() : vt_null))+"][items=");
+    if (writer.enter()) {
+      if (!arr) {
+        writer.writeIndent();
+        writer.write("array_not_rdy");
+      } else {
+        size_type cnt = arr->size();
+        dnode node;
+        for(size_type i=0; (i < cnt) && !writer.stopped(); ++i)
+        {
+          arr->getItem(i, node);
+          writer.writeIndent();
+          writer.write(node.getAs<dtpString>());
+          writer.write(";\n");
+        }
+      }
+      writer.leave();
+    } else {
+      writer.write("...");
+    }
+    writer.write("]\n");
+  } else if (isParent()) {
+    const dnChildColnBase *children = getChildrenPtrR();
+    writer.write("as_parent:[count="+toString(children ? children->size() : 0)+"][children=");
+    if (writer.enter()) {
+      if (!children) {
+        writer.writeIndent();
+        writer.write("children_not_rdy");
+      } else {
+        size_type cnt = children->size();
+        for(size_type i=0; (i < cnt) && !writer.stopped(); ++i)
+        {
+          children->at(i).intDump(writer, children->getName(i));
+          writer.write(";\n");
+        }
+      }
+      writer.leave();
+    } else {
+      writer.write("...");
+    }
+    writer.write("]\n");
+  } else {
+    writer.write("as_scalar:[type="+toString(int(getValueType()))+"][value=");
+    if (isNull())
+      writer.write("/null/");
+    else
+      writer.writeValue(getAs<dtpString>());
+    writer.write("]\n");
   }
+}
+
+dnMemoryUsage dnode::memoryUsage() const
+{
+  dnMemoryUsage res;
+  res.nodeCount++;
+  res.nodeHeaders += sizeof(dnode);
+  calcContentsMemoryUsage(res);
   return res;
 }
 
-dtpString dnode::dumpValue(const dtpString &indent) const
+void dnode::calcContentsMemoryUsage(dnMemoryUsage &output) const
 {
-  dtpString res;
-  if (const_cast<dnode *>(this)->isNull())
-    res = "/null/";
-  else {
-    res = const_cast<dnode *>(this)->getAs<dtpString>();
-    strReplaceThis(res, "]", "?", true);
-    strReplaceThis(res, "[", "?", true);
-    strReplaceThis(res, ":", "?", true);
+  switch (m_valueType) {
+    case vt_string: {
+      const dtpString *ptr = static_cast<const dtpString *>(boost::get<void_ptr>(m_valueData));
+      if (ptr != DTP_NULL)
+        output.strings += dnStringMemoryUsage(*ptr);
+      break;
+    }
+    case vt_parent: {
+      if (getAsChildrenNoCheckR() != DTP_NULL)
+        getAsChildrenNoCheckR()->calcMemoryUsage(output, true);
+      break;
+    }
+    case vt_array: {
+      if (getAsArrayNoCheckR() != DTP_NULL)
+        getAsArrayNoCheckR()->calcMemoryUsage(output, true);
+      break;
+    }
+    default:
+      // scalar values are stored inside node
+      break;
   }
-  return res;
 }
 
 void dnode::scan(dnScanner &scanner) const
@@ -2829,9 +3272,9 @@ void dnode::scanChildren(dnScanner &scanner) const
 {
   if (getChildrenPtrR() != DTP_NULL)
   {
-    int cnt = size();
-    for(int i=0; i < cnt; ++i)
-      const_cast<dnode *>(this)->getChildren().at(i).intScan(scanner);
+    size_type cnt = size();
+    for(size_type i=0; i < cnt; ++i)
+      getChildrenR().at(i).intScan(scanner);
   }
 }
 
@@ -2840,9 +3283,9 @@ void dnode::scanItems(dnScanner &scanner) const
 
   if (this->getArrayR())
   {
-    int cnt = size();
+    size_type cnt = size();
     dnode node;
-    for(int i=0; i < cnt; ++i)
+    for(size_type i=0; i < cnt; ++i)
     {
       getArrayR()->getItem(i, node);
       node.intScan(scanner);
@@ -2879,7 +3322,7 @@ dnode &dnode::explode(const dtpString &separator, const dtpString &a_text, dnode
 
   output.clear();
 
-  for(i = 0; (tfind = a_text.find(separator, i)) != std::string::npos; i = tfind + 1)
+  for(i = 0; (tfind = a_text.find(separator, i)) != std::string::npos; i = tfind + separator.length())
   {
     if (useAsNames) {
       guard.reset(new dnode());
@@ -3027,7 +3470,7 @@ bool dnode::setElementByPath(const dnode &pathNode, const dnode &value)
 /// Similar to getElement version, but faster when helper is not required.
 /// Note: returned value can be only a shadow of existing node, so
 //  to change it's contents you need to call setNode()
-const dnode &dnode::getNode(int index, dnode &helper) const
+const dnode &dnode::getNode(dnPosType index, dnode &helper) const
 {
   if (isParent()) {
     return getChildrenPtrR()->at(index);
@@ -3065,7 +3508,7 @@ const dnode &dnode::getNode(const dtpString &aName, dnode &helper) const
 /// Similar to getElement version, but faster when helper is not required.
 /// Note: returned value can be only a shadow of existing node, so
 //  to change it's contents you need to call setNode()
-dnode *dnode::getNodePtr(int index, dnode &helper)
+dnode *dnode::getNodePtr(dnPosType index, dnode &helper)
 {
   if (isParent()) {
     return &(getChildrenPtr()->at(index));
@@ -3079,7 +3522,7 @@ dnode *dnode::getNodePtr(int index, dnode &helper)
 }
 
 /// read-only version of getNodePtr
-const dnode *dnode::getNodePtrR(int index, dnode &helper) const
+const dnode *dnode::getNodePtrR(dnPosType index, dnode &helper) const
 {
   if (isParent()) {
     return &(getChildrenPtrR()->at(index));
@@ -3128,7 +3571,7 @@ const dnode *dnode::getNodePtrR(const dtpString &aName, dnode &helper) const
 }
 
 // update node, if &value == &target then do nothing
-void dnode::setNode(int index, dnode &value)
+void dnode::setNode(dnPosType index, dnode &value)
 {
   if (isParent()) {
     dnode *target = &(getChildrenPtr()->at(index));
@@ -3157,7 +3600,7 @@ void dnode::setNode(const dtpString &aName, dnode &value)
   }
 }
 
-dnode::dnValueBridge *dnode::newValueBridge(int idx)
+dnode::dnValueBridge *dnode::newValueBridge(dnPosType idx)
 {
     DTP_UNIQUE_PTR(dnValueBridge) res;
 
@@ -3165,7 +3608,7 @@ dnode::dnValueBridge *dnode::newValueBridge(int idx)
 #ifndef DATANODE_POOL_BRIDGE
         res.reset(new dnValueBridgeForChildColn(this->getChildrenPtr()));
 #else
-        res.reset(ObjectPool<dnValueBridgeForChildColn>::newObject());
+        res.reset(dnBridgePool<dnValueBridgeForChildColn>::newObject());
         static_cast<dnValueBridgeForChildColn *>(res.get())->setTarget(this->getChildrenPtr());
 #endif
     } else if (isArray()) {
@@ -3208,7 +3651,7 @@ dnode::dnValueBridge *dnode::intNewValueBridgeForChildName(const dtpString &name
 #ifndef DATANODE_POOL_BRIDGE
     res.reset(new dnValueBridgeForChildColnNames(this->getChildrenPtr()));
 #else
-    res.reset(ObjectPool<dnValueBridgeForChildColnNames>::newObject());
+    res.reset(dnBridgePool<dnValueBridgeForChildColnNames>::newObject());
     static_cast<dnValueBridgeForChildColnNames *>(res.get())->setTarget(this->getChildrenPtr());
 #endif
 
@@ -3226,14 +3669,14 @@ dnode::dnValueBridge *dnode::newValueBridge(dnPos pos)
 #ifndef DATANODE_POOL_BRIDGE
         res.reset(new dnValueBridgeForChildColn(this->getChildrenPtr()));
 #else
-        res.reset(ObjectPool<dnValueBridgeForChildColn>::newObject());
+        res.reset(dnBridgePool<dnValueBridgeForChildColn>::newObject());
         static_cast<dnValueBridgeForChildColn *>(res.get())->setTarget(this->getChildrenPtr());
 #endif
     } else if (isArray()) {
 #ifndef DATANODE_POOL_BRIDGE
         res.reset(new dnValueBridgeForArray(this->getArray()));
 #else
-        res.reset(ObjectPool<dnValueBridgeForArray>::newObject());
+        res.reset(dnBridgePool<dnValueBridgeForArray>::newObject());
         static_cast<dnValueBridgeForArray *>(res.get())->setTarget(this->getArray());
 #endif
     }
@@ -3292,11 +3735,11 @@ bool dnValue::operator==(const dnValue &rhs) const
   if (m_valueData.which() != rhs.m_valueData.which())
     return false;
 
-  if (Details::dnValueDynamicStrategyRegister<Details::dnValueCompareStrategyIntf>::at(m_valueType).canCompareDirectly())
+  if (Details::dnValueConvMatrix::canCompareDirectly(m_valueType))
     return (m_valueData == rhs.m_valueData);
   else
     return
-       Details::dnValueDynamicCasterRegister::equals(m_valueType, m_valueData, rhs.m_valueData);
+       Details::dnValueConvMatrix::equals(m_valueType, m_valueData, rhs.m_valueData);
 }
 
 /// returns <true> of both values are equal
@@ -3324,11 +3767,11 @@ bool dnValue::isEqualTo(const dnValue &value, void *buffer) const
   }
 
   //if (Details::dnValueCompareMetaScanner<vt_first>::canCompareDirectly(m_valueType))
-  if (Details::dnValueDynamicStrategyRegister<Details::dnValueCompareStrategyIntf>::at(m_valueType).canCompareDirectly())
+  if (Details::dnValueConvMatrix::canCompareDirectly(m_valueType))
     return (m_valueData == value.m_valueData);
   else
     return
-       Details::dnValueDynamicCasterRegister::equals(m_valueType, m_valueData, value.m_valueData);
+       Details::dnValueConvMatrix::equals(m_valueType, m_valueData, value.m_valueData);
 }
 
 //bool dnValue::empty() const
@@ -3502,7 +3945,7 @@ void dnValue::convertTo(dnValueType valueType)
   if (m_valueType == valueType)
     return;
 
-  Details::dnValueDynamicCasterRegister::cast(m_valueType, m_valueData, valueType, m_valueData);
+  Details::dnValueConvMatrix::cast(m_valueType, m_valueData, valueType, m_valueData);
   m_valueType = valueType;
 
 /*
@@ -3629,7 +4072,7 @@ bool dnValue::dataEqualTo(const dnValue& src) const
 // copy value, keep type as it was
 void dnValue::assignFrom(const dnValue& src)
 {
-  Details::dnValueDynamicCasterRegister::cast(src.getValueType(), src.m_valueData, m_valueType, m_valueData);
+  Details::dnValueConvMatrix::cast(src.getValueType(), src.m_valueData, m_valueType, m_valueData);
 /*
   switch (m_valueType) {
     case vt_bool:
@@ -4308,7 +4751,7 @@ fdatetime_t dnValue::getAsDateTime() const
 // ----------------------------------------------------------------------------
 const dnArray::size_type dnArray::npos = static_cast<dnArray::size_type>(-1);
 
-void dnArray::setItemValue(int index, const dnode &input)
+void dnArray::setItemValue(dnPosType index, const dnode &input)
 {
   this->setItem(index, input);
 }
@@ -4318,19 +4761,28 @@ void dnArray::eatItem(dnode &input)
   addItem(input);
 }
 
-const dnode &dnArray::getNode(int index, dnode &helper) const
+const dnode &dnArray::getNode(dnPosType index, dnode &helper) const
 {
   getItem(index, helper);
   return helper;
 }
 
-dnode *dnArray::getNodePtr(int index, dnode &helper) const
+dnode *dnArray::getNodePtr(dnPosType index, dnode &helper) const
 {
   getItem(index, helper);
   return &helper;
 }
 
-void dnArray::setNode(int index, const dnode &value)
+dtpString dnArray::getMemoryStatName() const
+{
+#ifdef DATANODE_ADD_RTTI
+  return "dnArrayOfPod<"+dtp::getValueTypeName(getValueType())+">";
+#else
+  return "dnArrayOfPod<"+toString(int(getValueType()))+">";
+#endif
+}
+
+void dnArray::setNode(dnPosType index, const dnode &value)
 {
   setItem(index, value);
 }
@@ -4344,7 +4796,7 @@ dnode::dnValueBridge *dnArrayBase::newValueBridge()
 #ifndef DATANODE_POOL_BRIDGE
         bridge = new dnValueBridgeForArray(this);
 #else
-        bridge = ObjectPool<dnValueBridgeForArray>::newObject();
+        bridge = dnBridgePool<dnValueBridgeForArray>::newObject();
         try {
           bridge->setTarget(this);
         } catch (...) {
@@ -4397,32 +4849,32 @@ bool dnArrayOfDataNode2::empty() const
   return m_items.empty();
 }
 
-void dnArrayOfDataNode2::getItem(int index, dnode &output) const
+void dnArrayOfDataNode2::getItem(dnPosType index, dnode &output) const
 {
   output.copyFrom(m_items[index]);
 }
 
-void dnArrayOfDataNode2::setItem(int index, const dnode &input)
+void dnArrayOfDataNode2::setItem(dnPosType index, const dnode &input)
 {
   m_items[index] = input;
 }
 
-void dnArrayOfDataNode2::setItemValue(int index, const dnode &input)
+void dnArrayOfDataNode2::setItemValue(dnPosType index, const dnode &input)
 {
   m_items[index].copyValueFrom(input);
 }
 
-const dnode &dnArrayOfDataNode2::getNode(int index, dnode &helper) const
+const dnode &dnArrayOfDataNode2::getNode(dnPosType index, dnode &helper) const
 {
   return m_items[index];
 }
 
-dnode *dnArrayOfDataNode2::getNodePtr(int index, dnode &helper) const
+dnode *dnArrayOfDataNode2::getNodePtr(dnPosType index, dnode &helper) const
 {
   return &(const_cast<dnArrayOfDataNode2 *>(this)->m_items[index]);
 }
 
-void dnArrayOfDataNode2::setNode(int index, const dnode &value)
+void dnArrayOfDataNode2::setNode(dnPosType index, const dnode &value)
 {
   if (&(m_items[index]) != &value)
     m_items[index] = value;
@@ -4455,18 +4907,24 @@ void dnArrayOfDataNode2::eatItem(dnode &input)
   itemRef.moveFrom(input);
 }
 
-void dnArrayOfDataNode2::eraseItem(int index)
+void dnArrayOfDataNode2::eraseItem(dnPosType index)
 {
   self_iterator itRemove = m_items.begin() + index;
   m_items.erase(itRemove);
 }
 
-void dnArrayOfDataNode2::eraseFrom(int index)
+void dnArrayOfDataNode2::eraseFrom(dnPosType index)
 {
   self_iterator itRemove = m_items.begin() + index;
   m_items.erase(itRemove, m_items.end());
 }
 
+void dnArrayOfDataNode2::eraseRange(dnPosType index, dnPosType count)
+{
+  self_iterator itRemove = m_items.begin() + index;
+  m_items.erase(itRemove, itRemove + count);
+}
+
 dnArray::size_type dnArrayOfDataNode2::indexOfValue(const dnode &input) const
 {
   self_const_iterator it = std::find_if(
@@ -4517,7 +4975,7 @@ dnode::dnValueBridge *dnArrayOfDataNode2::newValueBridge()
 #ifndef DATANODE_POOL_BRIDGE
         bridge = new dnValueBridgeForArrayOfDataNode(this);
 #else
-        bridge = ObjectPool<dnValueBridgeForArrayOfDataNode>::newObject();
+        bridge = dnBridgePool<dnValueBridgeForArrayOfDataNode>::newObject();
         try {
           bridge->setTarget(this);
         } catch (...) {
@@ -4528,6 +4986,27 @@ dnode::dnValueBridge *dnArrayOfDataNode2::newValueBridge()
         return bridge;
 }
 
+void dnArrayOfDataNode2::shrinkToFit()
+{
+  // ownership stays with m_items, only pointer storage is reallocated
+  if (m_items.capacity() > m_items.size())
+    std::vector<void *>(m_items.base()).swap(m_items.base());
+}
+
+void dnArrayOfDataNode2::calcMemoryUsage(dnMemoryUsage &output, bool deep) const
+{
+  output.arrays += sizeof(self_type) + m_items.capacity() * sizeof(void_ptr);
+
+  if (deep) {
+    for(self_const_iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+    {
+      output.nodeCount++;
+      output.nodeHeaders += sizeof(dnode);
+      it->calcContentsMemoryUsage(output);
+    }
+  }
+}
+
 // ----------------------------------------------------------------------------
 // dnChildColnBase
 // ----------------------------------------------------------------------------
@@ -4586,6 +5065,28 @@ const dnode *dnChildColnBase::peekChildR(const dtpString &name) const
     return NULL;
 }
 
+void dnChildColnBase::calcMemoryUsage(dnMemoryUsage &output, bool deep) const
+{
+  output.childMaps += size() * sizeof(dnodePtr);
+
+  if (supportsAccessByName()) {
+    for(size_type i=0, epos = size(); i != epos; i++)
+      output.nameVectors += dnStringMemoryUsage(getName(i));
+  }
+
+  if (deep)
+    calcChildrenMemoryUsage(output);
+}
+
+void dnChildColnBase::calcChildrenMemoryUsage(dnMemoryUsage &output) const
+{
+  for(size_type i=0, epos = size(); i != epos; i++) {
+    output.nodeCount++;
+    output.nodeHeaders += sizeof(dnode);
+    at(i).calcContentsMemoryUsage(output);
+  }
+}
+
 // ----------------------------------------------------------------------------
 // dnChildColnList
 // ----------------------------------------------------------------------------
@@ -4649,16 +5150,21 @@ void dnChildColnList::erase(const dtpString &name)
   }
 }
 
-void dnChildColnList::erase(int index)
+void dnChildColnList::erase(dnPosType index)
 {
   m_items.erase(m_items.begin() + index);
 }
 
-void dnChildColnList::eraseFrom(int index)
+void dnChildColnList::eraseFrom(dnPosType index)
 {
   m_items.erase(m_items.begin() + index, m_items.end());
 }
 
+void dnChildColnList::eraseRange(dnPosType index, dnPosType count)
+{
+  m_items.erase(m_items.begin() + index, m_items.begin() + index + count);
+}
+
 void dnChildColnList::insert(dnode *node)
 {
   m_items.push_back(node);
@@ -4679,27 +5185,27 @@ void dnChildColnList::insert(const dtpString &name, dnode *node)
   m_items.push_back(node);
 }
 
-const dtpString dnChildColnList::getName(int index) const
+const dtpString dnChildColnList::getName(dnPosType index) const
 {
   return dtpString("");
 }
 
-void dnChildColnList::setName(int index, const dtpString &name)
+void dnChildColnList::setName(dnPosType index, const dtpString &name)
 { // do nothing
 }
 
-void dnChildColnList::setAt(int pos, dnode *node)
+void dnChildColnList::setAt(dnPosType pos, dnode *node)
 {
   m_items.replace(pos, node);
 }
 
-dnode *dnChildColnList::extractChild(int index)
+dnode *dnChildColnList::extractChild(dnPosType index)
 {
   dnodeColn::auto_type item = m_items.release( m_items.begin() + index );
   return item.release();
 }
 
-dnode *dnChildColnList::cloneChild(int index) const
+dnode *dnChildColnList::cloneChild(dnPosType index) const
 {
   return createChild(m_items[index]);
 }
@@ -4722,13 +5228,13 @@ dnChildColnBase::size_type dnChildColnList::indexOfValue(const dnode &value) con
 }
 
 /*
-dnode &dnChildColnList::at(int pos)
+dnode &dnChildColnList::at(dnPosType pos)
 {
   return m_items[pos];
 }
 */
 
-void dnChildColnList::getChild(int index, dnode &output)
+void dnChildColnList::getChild(dnPosType index, dnode &output)
 {
   output = m_items[index];
 }
@@ -4738,6 +5244,14 @@ bool dnChildColnList::hasChild(const dtpString &name) const
   return (indexOfName(name) != dnode::npos);
 }
 
+void dnChildColnList::calcMemoryUsage(dnMemoryUsage &output, bool deep) const
+{
+  output.childMaps += sizeof(dnChildColnList) + m_items.capacity() * sizeof(dnodePtr);
+
+  if (deep)
+    calcChildrenMemoryUsage(output);
+}
+
 // ----------------------------------------------------------------------------
 // dnChildColnDblMap
 // ----------------------------------------------------------------------------
@@ -4760,18 +5274,15 @@ void dnChildColnDblMap::copyItemsFrom(const dnChildColnBase& src)
     dnGuard transp;
     boost::shared_ptr<dnGuard> stransp;
 
-    dnChildColnBase *ptr = &const_cast<dnChildColnBase&>(src);
-    dnChildColnDblMap *nsrcPtr = dynamic_cast<dnChildColnDblMap *>(ptr);
-
     clearItems();
 
     int id = 0;
     dtpString name;
 
-    if (nsrcPtr) {
+    if (src.supportsAccessByName()) {
        for(size_type i=0,epos=src.size(); i != epos; i++) {
          name = src.getName(i);
-         transp.reset(createChild(const_cast<dnChildColnBase&>(src).at(i)));
+         transp.reset(createChild(src.at(i)));
 
          if (name.empty())
            name = toString(id);
@@ -4785,7 +5296,7 @@ void dnChildColnDblMap::copyItemsFrom(const dnChildColnBase& src)
     } else {
        for(size_type i=0,epos=src.size(); i != epos; i++) {
          name = toString(id);
-         transp.reset(createChild(const_cast<dnChildColnBase&>(src).at(i)));
+         transp.reset(createChild(src.at(i)));
          m_map1.insert(std::make_pair(name, transp.get()));
          m_map2.push_back(transp.release());
          m_names.push_back(name);
@@ -4850,12 +5361,12 @@ void dnChildColnDblMap::erase(const dtpString &name)
     m_map1.erase(namePos);
 }
 
-void dnChildColnDblMap::erase(int index)
+void dnChildColnDblMap::erase(dnPosType index)
 {
   eraseItem(index);
 }
 
-void dnChildColnDblMap::eraseItem(int index)
+void dnChildColnDblMap::eraseItem(dnPosType index)
 {
   dtpString name = m_names[index];
 
@@ -4874,22 +5385,37 @@ void dnChildColnDblMap::eraseItem(int index)
     m_map1.erase(namePos);
 }
 
-void dnChildColnDblMap::eraseFrom(int index)
+void dnChildColnDblMap::eraseFrom(dnPosType index)
 {
-  size_type atPos = static_cast<size_type>(index);
-  size_type endPos = m_map2.size();
-
-  while(atPos < endPos)
-  {
-    eraseItem(index); // always the same pos
-    atPos++;
-  }
+  if (static_cast<size_type>(index) < size())
+    eraseRange(index, size() - index);
 }
 
-dnChildColnDblMap *dnChildColnDblMap::newEmpty()
+void dnChildColnDblMap::eraseRange(dnPosType index, dnPosType count)
 {
-   return new dnChildColnDblMap();
-}
+  if (count <= 0)
+    return;
+
+  // name map entries first - only the ones pointing to removed nodes
+  // (with duplicated names map points to the first node)
+  for(dnPosType i = index, epos = index + count; i != epos; i++) {
+    dnChildColnNameMap::iterator namePos = m_map1.find(m_names[i]);
+    if ((namePos != m_map1.end()) && (&at(i) == namePos->second))
+      m_map1.erase(namePos);
+  }
+
+#ifdef DATANODE_CHILD_INDEX_VECTOR_STD
+  for(dnPosType i = index, epos = index + count; i != epos; i++)
+    delete m_map2[i];
+#endif
+  m_map2.erase(m_map2.begin() + index, m_map2.begin() + index + count);
+  m_names.erase(m_names.begin() + index, m_names.begin() + index + count);
+}
+
+dnChildColnDblMap *dnChildColnDblMap::newEmpty()
+{
+   return new dnChildColnDblMap();
+}
 
 void dnChildColnDblMap::insert(dnode *node)
 {
@@ -4934,12 +5460,12 @@ void dnChildColnDblMap::insert(const dtpString &name, dnode *node)
   m_names.push_back(name);
 }
 
-const dtpString dnChildColnDblMap::getName(int index) const
+const dtpString dnChildColnDblMap::getName(dnPosType index) const
 {
   return m_names[index];
 }
 
-void dnChildColnDblMap::setName(int index, const dtpString &name)
+void dnChildColnDblMap::setName(dnPosType index, const dtpString &name)
 {
   dnChildColnIndexMap::const_iterator idxPos = m_map2.begin() + index;
   dtpString oldName;
@@ -4966,7 +5492,7 @@ void dnChildColnDblMap::setName(int index, const dtpString &name)
   m_names[index] = name;
 }
 
-void dnChildColnDblMap::setAt(int pos, dnode *node)
+void dnChildColnDblMap::setAt(dnPosType pos, dnode *node)
 {
 #ifdef DATANODE_CHILD_INDEX_VECTOR_STD
   dnChildColnNameMap::iterator namePos = m_map1.find(m_names[pos]);
@@ -4990,7 +5516,7 @@ void dnChildColnDblMap::setAt(int pos, dnode *node)
 #endif
 }
 
-dnode *dnChildColnDblMap::extractChild(int index)
+dnode *dnChildColnDblMap::extractChild(dnPosType index)
 {
   dnChildColnNameMap::iterator namePos;
 
@@ -5023,7 +5549,7 @@ dnode *dnChildColnDblMap::extractChild(int index)
 #endif
 }
 
-dnode *dnChildColnDblMap::cloneChild(int index) const
+dnode *dnChildColnDblMap::cloneChild(dnPosType index) const
 {
 #ifdef DATANODE_CHILD_INDEX_VECTOR_STD
   return createChild(*m_map2[index]);
@@ -5067,13 +5593,13 @@ dnChildColnBase::size_type dnChildColnDblMap::indexOfValue(const dnode &value) c
 }
 
 /*
-dnode &dnChildColnDblMap::at(int pos)
+dnode &dnChildColnDblMap::at(dnPosType pos)
 {
   return m_map2[pos];
 }
 */
 
-void dnChildColnDblMap::getChild(int index, dnode &output)
+void dnChildColnDblMap::getChild(dnPosType index, dnode &output)
 {
 #ifdef DATANODE_CHILD_INDEX_VECTOR_STD
   output = *m_map2[index];
@@ -5123,6 +5649,26 @@ bool dnChildColnDblMap::hasChild(const dtpString &name) const
   return m_map1.find(name) != m_map1.end();
 }
 
+void dnChildColnDblMap::calcMemoryUsage(dnMemoryUsage &output, bool deep) const
+{
+  // tree node: value + color + 3 links
+  const uint64 mapNodeSize = sizeof(dnChildColnNameMap::value_type) + sizeof(int) + 3 * sizeof(void_ptr);
+
+  output.childMaps += sizeof(dnChildColnDblMap);
+  output.childMaps += m_map2.capacity() * sizeof(dnChildColnIndexMap::value_type);
+  output.childMaps += m_map1.size() * mapNodeSize;
+
+  for(dnChildColnNameMap::const_iterator it = m_map1.begin(), epos = m_map1.end(); it != epos; ++it)
+    output.childMaps += dnStringMemoryUsage(it->first) - sizeof(dtpString);
+
+  output.nameVectors += (m_names.capacity() - m_names.size()) * sizeof(dtpString);
+  for(dnChildColnNameVector::const_iterator it = m_names.begin(), epos = m_names.end(); it != epos; ++it)
+    output.nameVectors += dnStringMemoryUsage(*it);
+
+  if (deep)
+    calcChildrenMemoryUsage(output);
+}
+
 void dnChildColnDblMap::swap(dnChildColnDblMap &rhs)
 {
   indirect_swap(this->m_map1, rhs.m_map1);
@@ -5135,6 +5681,787 @@ void swap(dnChildColnDblMap &lhs, dnChildColnDblMap &rhs)
   lhs.swap(rhs);
 }
 
+// ----------------------------------------------------------------------------
+// dnChildColnDeque
+// ----------------------------------------------------------------------------
+void dnChildColnDeque::copyItemsFrom(const dnChildColnBase& src)
+{
+  DTP_UNIQUE_PTR(dnode) transp;
+
+  if (this != &src)
+  {
+     clearItems();
+
+     for(size_type i=0,epos=src.size(); i != epos; i++) {
+       transp.reset(createChild(src.at(i)));
+       m_items.push_back(transp.release());
+     }
+  }
+}
+
+void dnChildColnDeque::resize(size_type newSize)
+{
+  if (m_items.size() < newSize)
+  {
+    size_type addCnt = newSize - static_cast<size_type>(m_items.size());
+    while(addCnt > 0)
+    {
+      m_items.push_back(new dnode());
+      addCnt--;
+    }
+  } else {
+    eraseFrom(newSize);
+  }
+}
+
+void dnChildColnDeque::erase(dnPosType index)
+{
+  if (index == 0)
+    m_items.pop_front();
+  else
+    m_items.erase(m_items.begin() + index);
+}
+
+void dnChildColnDeque::eraseFrom(dnPosType index)
+{
+  m_items.erase(m_items.begin() + index, m_items.end());
+}
+
+void dnChildColnDeque::eraseRange(dnPosType index, dnPosType count)
+{
+  m_items.erase(m_items.begin() + index, m_items.begin() + index + count);
+}
+
+void dnChildColnDeque::insert(size_type pos, dnode *node)
+{
+  if (pos == 0)
+    m_items.push_front(node);
+  else if (pos == m_items.size())
+    m_items.push_back(node);
+  else
+    m_items.insert(m_items.begin() + pos, node);
+}
+
+dnode *dnChildColnDeque::extractChild(dnPosType index)
+{
+  vector_type::auto_type item = m_items.release(m_items.begin() + index);
+  return item.release();
+}
+
+dnChildColnBase::size_type dnChildColnDeque::indexOfValue(const dnode &value) const
+{
+  dtpStringGuard keyValue;
+
+  for(size_type i=0, epos = size(); i!=epos; i++) {
+    if (m_items[i].isEqualTo(value, &keyValue))
+      return i;
+  }
+
+  return dnode::npos;
+}
+
+void dnChildColnDeque::swap(size_type pos1, size_type pos2)
+{
+  if (pos1 != pos2)
+    std::swap(m_items.base()[pos1], m_items.base()[pos2]);
+}
+
+void dnChildColnDeque::calcMemoryUsage(dnMemoryUsage &output, bool deep) const
+{
+  // deque blocks are not visible, count one pointer per item
+  output.childMaps += sizeof(dnChildColnDeque) + m_items.size() * sizeof(dnodePtr);
+
+  if (deep)
+    calcChildrenMemoryUsage(output);
+}
+
+// ----------------------------------------------------------------------------
+// dnFrozenNamePool
+// ----------------------------------------------------------------------------
+namespace {
+
+const uint DN_FROZEN_LINEAR_LIMIT = 8;
+const uint DN_FROZEN_BUCKET_SIZE = 2;
+const uint DN_FROZEN_MAX_SEEDS = 16;
+const uint DN_FROZEN_MAX_DISPLACEMENT = 1 << 20;
+const uint DN_FROZEN_DIRECT_SLOT = 0x80000000u;
+const uint64 DN_FROZEN_SEED_STEP = 0x9E3779B97F4A7C15ULL;
+
+/// FNV-1a
+inline uint64 frozenNameHash(const char *name, size_t length)
+{
+  uint64 res = 14695981039346656037ULL;
+  for(const char *it = name, *epos = name + length; it != epos; ++it) {
+    res ^= static_cast<unsigned char>(*it);
+    res *= 1099511628211ULL;
+  }
+  return res;
+}
+
+/// 64-bit finalizer (MurmurHash3)
+inline uint64 frozenMix(uint64 value)
+{
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ULL;
+  value ^= value >> 33;
+  return value;
+}
+
+inline size_t frozenBucket(uint64 hash, uint64 seed, size_t bucketCount)
+{
+  return static_cast<size_t>((frozenMix(hash ^ seed) >> 32) % bucketCount);
+}
+
+inline size_t frozenSlot(uint64 hash, uint64 seed, uint displacement, size_t slotCount)
+{
+  return static_cast<size_t>(frozenMix(hash ^ (seed + (static_cast<uint64>(displacement) + 1) * DN_FROZEN_SEED_STEP)) % slotCount);
+}
+
+typedef std::vector<std::vector<uint> > dnFrozenBuckets;
+
+class dnFrozenBucketSizeGreater {
+public:
+  dnFrozenBucketSizeGreater(const dnFrozenBuckets &buckets): m_buckets(buckets) {}
+  bool operator()(uint lhs, uint rhs) const { return m_buckets[lhs].size() > m_buckets[rhs].size(); }
+private:
+  const dnFrozenBuckets &m_buckets;
+};
+
+} // namespace
+
+uint dnFrozenNamePool::intern(const char *name, size_t length)
+{
+  uint64 hash = frozenNameHash(name, length);
+  std::pair<dnFrozenNameIndex::const_iterator, dnFrozenNameIndex::const_iterator> range = m_index.equal_range(hash);
+
+  for(dnFrozenNameIndex::const_iterator it = range.first; it != range.second; ++it)
+    if ((it->second.second == length) && (memcmp(data() + it->second.first, name, length) == 0))
+      return it->second.first;
+
+  if (m_text.size() + length > static_cast<size_t>(DN_FROZEN_DIRECT_SLOT))
+    throw dnError("Frozen name pool overflow");
+
+  uint offset = static_cast<uint>(m_text.size());
+  m_text.insert(m_text.end(), name, name + length);
+  m_index.insert(std::make_pair(hash, std::make_pair(offset, static_cast<uint>(length))));
+  return offset;
+}
+
+void dnFrozenNamePool::finish()
+{
+  dnFrozenNameIndex().swap(m_index);
+  std::vector<char>(m_text).swap(m_text);
+}
+
+// ----------------------------------------------------------------------------
+// dnChildColnFrozen
+// ----------------------------------------------------------------------------
+dnChildColnFrozen::dnChildColnFrozen(dnChildColnBase &source, const dnFrozenNamePoolPtr &namePool):
+  dnChildColnBase(), m_seed(0), m_namePool(namePool), m_isList(source.isList())
+{
+  size_type cnt = source.size();
+
+  if (!m_isList) {
+    std::vector<uint64> hashes(cnt);
+    dtpString name;
+
+    m_names.resize(cnt);
+    for(size_type i=0; i != cnt; i++) {
+      name = source.getName(i);
+      m_names[i].offset = namePool->intern(name.c_str(), name.length());
+      m_names[i].length = static_cast<uint>(name.length());
+      hashes[i] = frozenNameHash(name.c_str(), name.length());
+    }
+
+    buildIndex(hashes);
+  }
+
+  // nothing can fail below, source is not changed if exception was thrown
+  m_items.resize(cnt);
+  for(size_type i=0; i != cnt; i++)
+    m_items[i].swap(source.at(i));
+}
+
+void dnChildColnFrozen::throwFrozen()
+{
+  throw dnError("Node is frozen");
+}
+
+void dnChildColnFrozen::buildIndex(const std::vector<uint64> &hashes)
+{
+  if (m_names.size() <= DN_FROZEN_LINEAR_LIMIT)
+    return;
+
+  // unique names only, first child with a given name wins (as in dnChildColnDblMap)
+  typedef std::vector<std::pair<uint64, uint> > hash_index_vector;
+  hash_index_vector sorted(hashes.size());
+  for(size_t i=0, epos = hashes.size(); i != epos; i++)
+    sorted[i] = std::make_pair(hashes[i], static_cast<uint>(i));
+  std::sort(sorted.begin(), sorted.end());
+
+  std::vector<uint> keys;
+  keys.reserve(sorted.size());
+
+  for(size_t i=0, epos = sorted.size(); i != epos; i++) {
+    bool duplicate = false;
+    const dnFrozenName &name = m_names[sorted[i].second];
+    for(size_t j = i; (j > 0) && (sorted[j - 1].first == sorted[i].first); j--)
+      if (nameEquals(sorted[j - 1].second, m_namePool->data() + name.offset, name.length)) {
+        duplicate = true;
+        break;
+      }
+    if (!duplicate)
+      keys.push_back(sorted[i].second);
+  }
+
+  for(uint attempt = 0; attempt != DN_FROZEN_MAX_SEEDS; attempt++)
+    if (tryBuildIndex(hashes, keys, attempt * DN_FROZEN_SEED_STEP))
+      return;
+
+  throw dnError("Unable to build frozen name index");
+}
+
+/// Hash & displace: buckets are placed from the largest, for each one
+/// displacement is searched which moves all its keys to free slots.
+/// Single-key buckets store slot number directly.
+bool dnChildColnFrozen::tryBuildIndex(const std::vector<uint64> &hashes, const std::vector<uint> &keys, uint64 seed)
+{
+  const size_t slotCount = keys.size();
+  const size_t bucketCount = slotCount / DN_FROZEN_BUCKET_SIZE + 1;
+
+  dnFrozenBuckets buckets(bucketCount);
+  for(std::vector<uint>::const_iterator it = keys.begin(), epos = keys.end(); it != epos; ++it)
+    buckets[frozenBucket(hashes[*it], seed, bucketCount)].push_back(*it);
+
+  std::vector<uint> order(bucketCount);
+  for(size_t i=0; i != bucketCount; i++)
+    order[i] = static_cast<uint>(i);
+  std::stable_sort(order.begin(), order.end(), dnFrozenBucketSizeGreater(buckets));
+
+  std::vector<bool> taken(slotCount, false);
+  std::vector<size_t> slots;
+  size_t freeSlot = 0;
+
+  m_displacements.assign(bucketCount, 0);
+  m_slots.assign(slotCount, 0);
+
+  for(std::vector<uint>::const_iterator it = order.begin(), epos = order.end(); it != epos; ++it) {
+    const std::vector<uint> &bucket = buckets[*it];
+
+    if (bucket.empty())
+      break;
+
+    if (bucket.size() == 1) {
+      while (taken[freeSlot])
+        ++freeSlot;
+      taken[freeSlot] = true;
+      m_displacements[*it] = DN_FROZEN_DIRECT_SLOT | static_cast<uint>(freeSlot);
+      m_slots[freeSlot] = bucket[0];
+      continue;
+    }
+
+    uint displacement = 0;
+    for(; displacement != DN_FROZEN_MAX_DISPLACEMENT; displacement++) {
+      slots.clear();
+      for(std::vector<uint>::const_iterator key = bucket.begin(), keyEnd = bucket.end(); key != keyEnd; ++key) {
+        size_t slot = frozenSlot(hashes[*key], seed, displacement, slotCount);
+        if (taken[slot] || (std::find(slots.begin(), slots.end(), slot) != slots.end()))
+          break;
+        slots.push_back(slot);
+      }
+      if (slots.size() == bucket.size())
+        break;
+    }
+
+    if (displacement == DN_FROZEN_MAX_DISPLACEMENT)
+      return false;
+
+    m_displacements[*it] = displacement;
+    for(size_t i=0, cnt = slots.size(); i != cnt; i++) {
+      taken[slots[i]] = true;
+      m_slots[slots[i]] = bucket[i];
+    }
+  }
+
+  m_seed = seed;
+  return true;
+}
+
+dnChildColnBase::size_type dnChildColnFrozen::findSlot(uint64 hash) const
+{
+  uint displacement = m_displacements[frozenBucket(hash, m_seed, m_displacements.size())];
+  if ((displacement & DN_FROZEN_DIRECT_SLOT) != 0)
+    return (displacement & ~DN_FROZEN_DIRECT_SLOT);
+  return static_cast<size_type>(frozenSlot(hash, m_seed, displacement, m_slots.size()));
+}
+
+bool dnChildColnFrozen::nameEquals(size_type index, const char *name, size_t length) const
+{
+  const dnFrozenName &itemName = m_names[index];
+  return (itemName.length == length) && (memcmp(m_namePool->data() + itemName.offset, name, length) == 0);
+}
+
+dnChildColnBase::size_type dnChildColnFrozen::indexOfName(const dtpString &name) const
+{
+  if (m_isList)
+    return dnode::npos;
+
+  const char *nameText = name.c_str();
+  size_t nameLength = name.length();
+
+  if (m_slots.empty()) {
+    for(size_type i=0, epos = m_names.size(); i != epos; i++)
+      if (nameEquals(i, nameText, nameLength))
+        return i;
+    return dnode::npos;
+  }
+
+  size_type index = m_slots[findSlot(frozenNameHash(nameText, nameLength))];
+  return nameEquals(index, nameText, nameLength) ? index : dnode::npos;
+}
+
+dnChildColnBase::size_type dnChildColnFrozen::indexOfValue(const dnode &value) const
+{
+  dtpStringGuard keyValue;
+
+  for(size_type i=0, epos = size(); i != epos; i++) {
+    if (m_items[i].isEqualTo(value, &keyValue))
+      return i;
+  }
+
+  return dnode::npos;
+}
+
+bool dnChildColnFrozen::hasChild(const dtpString &name) const
+{
+  return (indexOfName(name) != dnode::npos);
+}
+
+const dtpString dnChildColnFrozen::getName(dnPosType index) const
+{
+  if (m_isList)
+    return dtpString("");
+
+  const dnFrozenName &name = m_names[index];
+  return dtpString(m_namePool->data() + name.offset, name.length);
+}
+
+dnode &dnChildColnFrozen::at(dnPosType pos)
+{
+  throwFrozen();
+  return m_items[pos];
+}
+
+void dnChildColnFrozen::getChild(dnPosType index, dnode &output)
+{
+  output = m_items[index];
+}
+
+dnode *dnChildColnFrozen::cloneChild(dnPosType index) const
+{
+  return createChild(m_items[index]);
+}
+
+void dnChildColnFrozen::calcMemoryUsage(dnMemoryUsage &output, bool deep) const
+{
+  output.childMaps += sizeof(dnChildColnFrozen);
+  output.childMaps += (m_displacements.capacity() + m_slots.capacity()) * sizeof(uint);
+  output.nameVectors += m_names.capacity() * sizeof(dnFrozenName);
+
+  // names are interned, so this is the upper limit
+  for(std::vector<dnFrozenName>::const_iterator it = m_names.begin(), epos = m_names.end(); it != epos; ++it)
+    output.nameVectors += it->length;
+
+  if (deep)
+    calcChildrenMemoryUsage(output);
+}
+
+void dnChildColnFrozen::resize(size_type newSize) { throwFrozen(); }
+void dnChildColnFrozen::clearItems() { throwFrozen(); }
+void dnChildColnFrozen::erase(const dtpString &name) { throwFrozen(); }
+void dnChildColnFrozen::erase(dnPosType index) { throwFrozen(); }
+void dnChildColnFrozen::eraseFrom(dnPosType index) { throwFrozen(); }
+void dnChildColnFrozen::eraseRange(dnPosType index, dnPosType count) { throwFrozen(); }
+void dnChildColnFrozen::setName(dnPosType index, const dtpString &name) { throwFrozen(); }
+void dnChildColnFrozen::swap(size_type pos1, size_type pos2) { throwFrozen(); }
+void dnChildColnFrozen::copyItemsFrom(const dnChildColnBase& src) { throwFrozen(); }
+void dnChildColnFrozen::insert(dnode *node) { delete node; throwFrozen(); }
+void dnChildColnFrozen::insert(size_type pos, dnode *node) { delete node; throwFrozen(); }
+void dnChildColnFrozen::insert(size_type pos, const dtpString &name, dnode *node) { delete node; throwFrozen(); }
+void dnChildColnFrozen::insert(const dtpString &name, dnode *node) { delete node; throwFrozen(); }
+void dnChildColnFrozen::setAt(dnPosType pos, dnode *node) { delete node; throwFrozen(); }
+
+dnode *dnChildColnFrozen::extractChild(dnPosType index)
+{
+  throwFrozen();
+  return DTP_NULL;
+}
+
+// ----------------------------------------------------------------------------
+// dnCompactBlock
+// ----------------------------------------------------------------------------
+dnCompactBlock::dnCompactBlock(size_t capacity)
+{
+  m_begin = (capacity > 0) ? static_cast<dnode *>(::operator new(capacity * sizeof(dnode))) : DTP_NULL;
+  m_next = m_begin;
+  m_end = m_begin + capacity;
+}
+
+dnCompactBlock::~dnCompactBlock()
+{
+  ::operator delete(m_begin);
+}
+
+dnode *dnCompactBlock::allocate(size_t count)
+{
+  if (count > static_cast<size_t>(m_end - m_next))
+    throw dnError("Compact block overflow");
+
+  dnode *res = m_next;
+  m_next += count;
+  return res;
+}
+
+// ----------------------------------------------------------------------------
+// dnChildColnCompact
+// ----------------------------------------------------------------------------
+namespace {
+
+/// Orders child indices by (name, index)
+class dnCompactNameLess {
+public:
+  dnCompactNameLess(const std::vector<dtpString> &names): m_names(names) {}
+  bool operator()(dnSizeType lhs, dnSizeType rhs) const {
+    int res = m_names[lhs].compare(m_names[rhs]);
+    return (res < 0) || ((res == 0) && (lhs < rhs));
+  }
+private:
+  const std::vector<dtpString> &m_names;
+};
+
+/// Compares indexed name with searched one
+class dnCompactNameKeyLess {
+public:
+  dnCompactNameKeyLess(const std::vector<dtpString> &names): m_names(names) {}
+  bool operator()(dnSizeType lhs, const dtpString &rhs) const {
+    return m_names[lhs] < rhs;
+  }
+private:
+  const std::vector<dtpString> &m_names;
+};
+
+class dnCompactIndexInRange {
+public:
+  dnCompactIndexInRange(dnSizeType first, dnSizeType last): m_first(first), m_last(last) {}
+  bool operator()(dnSizeType value) const { return (value >= m_first) && (value < m_last); }
+private:
+  dnSizeType m_first;
+  dnSizeType m_last;
+};
+
+} // namespace
+
+dnChildColnCompact::dnChildColnCompact(dnChildColnBase &source, const dnCompactBlockPtr &block):
+  dnChildColnBase(), m_block(block), m_isList(source.isList())
+{
+  size_type cnt = source.size();
+
+  if (!m_isList) {
+    m_names.reserve(cnt);
+    for(size_type i=0; i != cnt; i++)
+      m_names.push_back(source.getName(i));
+
+    m_nameIndex.resize(cnt);
+    for(size_type i=0; i != cnt; i++)
+      m_nameIndex[i] = i;
+    std::sort(m_nameIndex.begin(), m_nameIndex.end(), dnCompactNameLess(m_names));
+  }
+
+  m_items.reserve(cnt);
+  dnode *slots = block->allocate(cnt);
+
+  // nothing can fail below, source is not changed if exception was thrown
+  for(size_type i=0; i != cnt; i++) {
+    dnode *node = new (slots + i) dnode();
+    node->swap(source.at(i));
+    m_items.push_back(node);
+  }
+}
+
+dnChildColnCompact::~dnChildColnCompact()
+{
+  for(vector_type::iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+    releaseNode(&(*it));
+}
+
+void dnChildColnCompact::releaseNode(dnode *node)
+{
+  if (m_block->contains(node))
+    node->~dnode();
+  else
+    delete node;
+}
+
+void dnChildColnCompact::indexName(size_type index)
+{
+  name_index_vector::iterator pos = std::lower_bound(m_nameIndex.begin(), m_nameIndex.end(), index, dnCompactNameLess(m_names));
+  m_nameIndex.insert(pos, index);
+}
+
+void dnChildColnCompact::unindexName(size_type index)
+{
+  name_index_vector::iterator pos = std::lower_bound(m_nameIndex.begin(), m_nameIndex.end(), index, dnCompactNameLess(m_names));
+  assert((pos != m_nameIndex.end()) && (*pos == index));
+  m_nameIndex.erase(pos);
+}
+
+void dnChildColnCompact::shiftNameIndex(size_type from, dnPosType delta)
+{
+  for(name_index_vector::iterator it = m_nameIndex.begin(), epos = m_nameIndex.end(); it != epos; ++it)
+    if (*it >= from)
+      *it += delta;
+}
+
+void dnChildColnCompact::copyItemsFrom(const dnChildColnBase& src)
+{
+  if (this != &src)
+  {
+    clearItems();
+
+    bool useNames = src.supportsAccessByName();
+    dtpString name;
+
+    for(size_type i=0,epos=src.size(); i != epos; i++) {
+      if (!m_isList) {
+        name = useNames ? src.getName(i) : dtpString();
+        if (name.empty())
+          name = toString(i);
+      }
+      insert(i, name, createChild(src.at(i)));
+    }
+  }
+}
+
+void dnChildColnCompact::clearItems()
+{
+  for(vector_type::iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+    releaseNode(&(*it));
+
+  m_items.clear();
+  m_names.clear();
+  m_nameIndex.clear();
+}
+
+void dnChildColnCompact::resize(size_type newSize)
+{
+  if (size() < newSize)
+  {
+    size_type addCnt = newSize - size();
+    while(addCnt > 0)
+    {
+      insert(new dnode());
+      addCnt--;
+    }
+  } else {
+    eraseFrom(newSize);
+  }
+}
+
+void dnChildColnCompact::erase(const dtpString &name)
+{
+  size_type idx = indexOfName(name);
+
+  if (idx != dnode::npos)
+    eraseRange(idx, 1);
+}
+
+void dnChildColnCompact::erase(dnPosType index)
+{
+  eraseRange(index, 1);
+}
+
+void dnChildColnCompact::eraseFrom(dnPosType index)
+{
+  if (static_cast<size_type>(index) < size())
+    eraseRange(index, size() - index);
+}
+
+void dnChildColnCompact::eraseRange(dnPosType index, dnPosType count)
+{
+  if (count <= 0)
+    return;
+
+  for(dnPosType i = index, epos = index + count; i != epos; i++)
+    releaseNode(&m_items[i]);
+
+  m_items.erase(m_items.begin() + index, m_items.begin() + index + count);
+
+  if (!m_isList) {
+    m_nameIndex.erase(
+      std::remove_if(m_nameIndex.begin(), m_nameIndex.end(), dnCompactIndexInRange(index, index + count)),
+      m_nameIndex.end());
+    m_names.erase(m_names.begin() + index, m_names.begin() + index + count);
+    shiftNameIndex(index + count, -count);
+  }
+}
+
+void dnChildColnCompact::insert(dnode *node)
+{
+  if (m_isList)
+    insert(size(), dtpString(), node);
+  else
+    insert(size(), toString(size()), node);
+}
+
+void dnChildColnCompact::insert(size_type pos, dnode *node)
+{
+  if (m_isList)
+    insert(pos, dtpString(), node);
+  else
+    insert(pos, toString(size()), node);
+}
+
+void dnChildColnCompact::insert(const dtpString &name, dnode *node)
+{
+  insert(size(), name, node);
+}
+
+void dnChildColnCompact::insert(size_type pos, const dtpString &name, dnode *node)
+{
+  DTP_UNIQUE_PTR(dnode) guard(node);
+
+  m_items.reserve(m_items.size() + 1);
+  if (!m_isList) {
+    m_nameIndex.reserve(m_nameIndex.size() + 1);
+    m_names.insert(m_names.begin() + pos, name);
+  }
+
+  // nothing can fail below
+  m_items.insert(m_items.begin() + pos, guard.release());
+
+  if (!m_isList) {
+    shiftNameIndex(pos, 1);
+    indexName(pos);
+  }
+}
+
+const dtpString dnChildColnCompact::getName(dnPosType index) const
+{
+  if (m_isList)
+    return dtpString("");
+  else
+    return m_names[index];
+}
+
+void dnChildColnCompact::setName(dnPosType index, const dtpString &name)
+{
+  if (m_isList)
+    return;
+
+  dtpString newName(name);
+  unindexName(index);
+  m_names[index].swap(newName);
+  indexName(index);
+}
+
+void dnChildColnCompact::setAt(dnPosType pos, dnode *node)
+{
+  dnode *oldNode = &m_items[pos];
+  m_items.base()[pos] = node;
+  releaseNode(oldNode);
+}
+
+dnode *dnChildColnCompact::extractChild(dnPosType index)
+{
+  dnode *item = &m_items[index];
+  DTP_UNIQUE_PTR(dnode) res;
+
+  if (m_block->contains(item)) {
+    res.reset(new dnode());
+    res->swap(*item);
+    item->~dnode();
+  } else {
+    res.reset(item);
+  }
+
+  m_items.erase(m_items.begin() + index);
+
+  if (!m_isList) {
+    unindexName(index);
+    m_names.erase(m_names.begin() + index);
+    shiftNameIndex(index + 1, -1);
+  }
+
+  return res.release();
+}
+
+dnChildColnBase::size_type dnChildColnCompact::indexOfName(const dtpString &name) const
+{
+  if (m_isList)
+    return dnode::npos;
+
+  name_index_vector::const_iterator it = std::lower_bound(m_nameIndex.begin(), m_nameIndex.end(), name, dnCompactNameKeyLess(m_names));
+  if ((it != m_nameIndex.end()) && (m_names[*it] == name))
+    return *it;
+
+  return dnode::npos;
+}
+
+dnChildColnBase::size_type dnChildColnCompact::indexOfValue(const dnode &value) const
+{
+  dtpStringGuard keyValue;
+
+  for(size_type i=0, epos = size(); i!=epos; i++) {
+    if (m_items[i].isEqualTo(value, &keyValue))
+      return i;
+  }
+
+  return dnode::npos;
+}
+
+void dnChildColnCompact::swap(size_type pos1, size_type pos2)
+{
+  if (pos1 == pos2)
+    return;
+
+  if (!m_isList) {
+    unindexName(pos1);
+    unindexName(pos2);
+    m_names[pos1].swap(m_names[pos2]);
+  }
+
+  std::swap(m_items.base()[pos1], m_items.base()[pos2]);
+
+  if (!m_isList) {
+    indexName(pos1);
+    indexName(pos2);
+  }
+}
+
+dnChildColnBase::size_type dnChildColnCompact::getSpillCount() const
+{
+  size_type res = 0;
+  for(vector_type::const_iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+    if (!m_block->contains(&(*it)))
+      res++;
+  return res;
+}
+
+void dnChildColnCompact::calcMemoryUsage(dnMemoryUsage &output, bool deep) const
+{
+  output.childMaps += sizeof(dnChildColnCompact) + m_items.capacity() * sizeof(dnodePtr);
+  output.childMaps += m_nameIndex.capacity() * sizeof(size_type);
+
+  output.nameVectors += (m_names.capacity() - m_names.size()) * sizeof(dtpString);
+  for(std::vector<dtpString>::const_iterator it = m_names.begin(), epos = m_names.end(); it != epos; ++it)
+    output.nameVectors += dnStringMemoryUsage(*it);
+
+  if (deep)
+    calcChildrenMemoryUsage(output);
+}
+
 // ----------------------------------------------------------------------------
 // dnValueBridge
 // ----------------------------------------------------------------------------
@@ -5518,6 +6845,137 @@ dnArray *dnode::extractArray()
 // dnValueBridgeForChildColn
 // ----------------------------------------------------------------------------
 
+// ----------------------------------------------------------------------------
+// dnMemoryStats
+// ----------------------------------------------------------------------------
+namespace {
+  boost::atomic<uint64> g_liveBridgeCount(0);
+#ifdef DATANODE_MEMORY_STATS
+  dnMemoryTracked *g_memoryTrackedFirst = DTP_NULL;
+
+  /// Guards list of tracked containers, created on first use
+  boost::mutex &memoryTrackedMutex() {
+    static boost::mutex mutex;
+    return mutex;
+  }
+
+  struct dnMemoryStatItem {
+    uint64 count;
+    uint64 items;
+    uint64 bytes;
+    dnMemoryStatItem(): count(0), items(0), bytes(0) {}
+  };
+#endif
+}
+
+bool dnMemoryStats::enabled()
+{
+#ifdef DATANODE_MEMORY_STATS
+  return true;
+#else
+  return false;
+#endif
+}
+
+void dnMemoryStats::getStats(dnode &output)
+{
+  output.setAsParent();
+#ifdef DATANODE_MEMORY_STATS
+  typedef std::map<dtpString, dnMemoryStatItem> StatMap;
+  StatMap stats;
+  dnMemoryUsage usage;
+
+  {
+    boost::lock_guard<boost::mutex> guard(memoryTrackedMutex());
+    for(const dnMemoryTracked *obj = g_memoryTrackedFirst; obj != DTP_NULL; obj = obj->m_next)
+    {
+      dnMemoryStatItem &item = stats[obj->getMemoryStatName()];
+      usage.clear();
+      obj->calcMemoryUsage(usage, false);
+      item.count++;
+      item.items += obj->getMemoryStatItems();
+      item.bytes += usage.total();
+    }
+  }
+
+  dnMemoryStatItem &bridgeItem = stats["dnValueBridge"];
+  bridgeItem.count = liveBridgeCount();
+  bridgeItem.bytes = liveBridgeBytes();
+
+  for(StatMap::const_iterator it = stats.begin(), epos = stats.end(); it != epos; ++it)
+  {
+    dnGuard statNode(new dnode(ict_parent));
+    statNode->addChild("count", it->second.count);
+    statNode->addChild("items", it->second.items);
+    statNode->addChild("bytes", it->second.bytes);
+    output.addChild(it->first, statNode.release());
+  }
+#endif
+}
+
+uint64 dnMemoryStats::liveBridgeCount()
+{
+  return g_liveBridgeCount.load(boost::memory_order_relaxed);
+}
+
+uint64 dnMemoryStats::liveBridgeBytes()
+{
+  // typical bridge: vtable, position & container pointer
+  return liveBridgeCount() * (sizeof(dnode::dnValueBridge) + sizeof(dnode::size_type) + sizeof(void_ptr));
+}
+
+void dnMemoryStats::bridgeCreated()
+{
+  g_liveBridgeCount.fetch_add(1, boost::memory_order_relaxed);
+}
+
+void dnMemoryStats::bridgeReleased()
+{
+  g_liveBridgeCount.fetch_sub(1, boost::memory_order_relaxed);
+}
+
+#ifdef DATANODE_MEMORY_STATS
+// ----------------------------------------------------------------------------
+// dnMemoryTracked
+// ----------------------------------------------------------------------------
+dnMemoryTracked::dnMemoryTracked()
+{
+  link();
+}
+
+dnMemoryTracked::dnMemoryTracked(const dnMemoryTracked &src)
+{
+  link();
+}
+
+dnMemoryTracked::~dnMemoryTracked()
+{
+  unlink();
+}
+
+void dnMemoryTracked::link()
+{
+  boost::lock_guard<boost::mutex> guard(memoryTrackedMutex());
+  m_prev = DTP_NULL;
+  m_next = g_memoryTrackedFirst;
+  if (m_next != DTP_NULL)
+    m_next->m_prev = this;
+  g_memoryTrackedFirst = this;
+}
+
+void dnMemoryTracked::unlink()
+{
+  boost::lock_guard<boost::mutex> guard(memoryTrackedMutex());
+  if (m_prev != DTP_NULL)
+    m_prev->m_next = m_next;
+  else
+    g_memoryTrackedFirst = m_next;
+
+  if (m_next != DTP_NULL)
+    m_next->m_prev = m_prev;
+}
+#endif
+
 void swap(dnValue& lhs, dnValue& rhs) {
   lhs.swap(rhs);
 }
@@ -0,0 +1,710 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_algorithm.cpp
+// Project:     dtpLib
+// Purpose:     DataNode-specific versions of algorithms
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <limits>
+
+#include <boost/unordered_map.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include "dtp/dnode_algorithm.h"
+#include "dtp/details/dnode_table.h"
+
+using namespace dtp;
+using namespace Details;
+
+namespace {
+
+typedef dnode::size_type size_type;
+
+dnThreadPool &selectPool(dnThreadPool *pool)
+{
+  return (pool != DTP_NULL) ? *pool : dnThreadPool::getDefault();
+}
+
+bool useParallel(bool parallel, uint minParallelRows, size_type rowCount, dnThreadPool &pool)
+{
+  return parallel && (rowCount >= minParallelRows) && (rowCount > 1) && (pool.getConcurrency() > 1);
+}
+
+/// Executes Task(context, first, last) for ranges covering [0, rowCount),
+/// tasks are returned in range order
+template<typename Task, typename Context>
+void executeRowRanges(dnThreadPool &pool, const Context &context, size_type rowCount, boost::ptr_vector<Task> &tasks)
+{
+  const size_type taskCount = std::min<size_type>(rowCount, pool.getConcurrency());
+  std::vector<dnParallelTask *> taskPtrs;
+
+  tasks.reserve(taskCount);
+  taskPtrs.reserve(taskCount);
+
+  for(size_type i=0; i != taskCount; i++) {
+    tasks.push_back(new Task(context,
+      static_cast<size_type>(static_cast<uint64>(rowCount) * i / taskCount),
+      static_cast<size_type>(static_cast<uint64>(rowCount) * (i + 1) / taskCount)));
+    taskPtrs.push_back(&tasks.back());
+  }
+
+  pool.execute(&taskPtrs[0], taskPtrs.size());
+}
+
+inline bool isNullValue(const dnode *value)
+{
+  return (value == DTP_NULL) || (value->getValueType() == vt_null);
+}
+
+template<typename T>
+inline void appendRaw(dtpString &output, T value)
+{
+  output.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+/// Appends binary form of key value to output, values with equal form are equal
+void appendKey(const dnode *value, dtpString &output)
+{
+  if (isNullValue(value)) {
+    output += 'n';
+    return;
+  }
+
+  switch (value->getValueType()) {
+    case vt_byte:
+    case vt_int:
+    case vt_uint:
+    case vt_int64:
+    case vt_bool:
+      output += 'i';
+      appendRaw(output, value->getAs<int64>());
+      break;
+    case vt_uint64: {
+      uint64 number = value->getAs<uint64>();
+      if (number <= static_cast<uint64>(std::numeric_limits<int64>::max())) {
+        output += 'i';
+        appendRaw(output, static_cast<int64>(number));
+      } else {
+        output += 'u';
+        appendRaw(output, number);
+      }
+      break;
+    }
+    case vt_string: {
+      dtpString text = value->getAs<dtpString>();
+      output += 's';
+      appendRaw(output, static_cast<uint64>(text.length()));
+      output += text;
+      break;
+    }
+    case vt_parent:
+    case vt_array:
+    case vt_vptr:
+      throw dnError("Unsupported key type: " + getValueTypeName(value->getValueType()));
+    default:
+      output += 'd';
+      appendRaw(output, value->getAs<double>());
+      break;
+  }
+}
+
+inline bool isIntegerValue(dnValueType valueType)
+{
+  switch (valueType) {
+    case vt_byte:
+    case vt_int:
+    case vt_uint:
+    case vt_int64:
+    case vt_uint64:
+    case vt_bool:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// dnAggregateState
+// ----------------------------------------------------------------------------
+/// Accumulator of a single aggregate in a single group
+struct dnAggregateState {
+  uint64 count;
+  int64 intSum;
+  double floatSum;
+  double minValue;
+  double maxValue;
+  bool hasFloat;
+
+  dnAggregateState(): count(0), intSum(0), floatSum(0.0), minValue(0.0), maxValue(0.0), hasFloat(false) {}
+
+  void add(dnAggregateFunc func, const dnode &value) {
+    count++;
+    switch (func) {
+      case daf_count:
+        break;
+      case daf_sum:
+      case daf_avg:
+        if (isIntegerValue(value.getValueType())) {
+          intSum += value.getAs<int64>();
+        } else {
+          floatSum += value.getAs<double>();
+          hasFloat = true;
+        }
+        break;
+      case daf_min:
+      case daf_max: {
+        double v = value.getAs<double>();
+        if ((count == 1) || (v < minValue))
+          minValue = v;
+        if ((count == 1) || (v > maxValue))
+          maxValue = v;
+        break;
+      }
+    }
+  }
+
+  void merge(const dnAggregateState &other) {
+    if (other.count == 0)
+      return;
+    if ((count == 0) || (other.minValue < minValue))
+      minValue = other.minValue;
+    if ((count == 0) || (other.maxValue > maxValue))
+      maxValue = other.maxValue;
+    count += other.count;
+    intSum += other.intSum;
+    floatSum += other.floatSum;
+    hasFloat = hasFloat || other.hasFloat;
+  }
+
+  double total() const {
+    return static_cast<double>(intSum) + floatSum;
+  }
+
+  /// Returns value of aggregate, null for avg, min & max without values
+  dnode result(dnAggregateFunc func) const {
+    switch (func) {
+      case daf_count:
+        return dnode(count);
+      case daf_sum:
+        if (hasFloat)
+          return dnode(total());
+        else
+          return dnode(intSum);
+      case daf_avg:
+        if (count > 0)
+          return dnode(total() / static_cast<double>(count));
+        break;
+      case daf_min:
+        if (count > 0)
+          return dnode(minValue);
+        break;
+      case daf_max:
+        if (count > 0)
+          return dnode(maxValue);
+        break;
+    }
+    return dnode();
+  }
+};
+
+// ----------------------------------------------------------------------------
+// dnGroupTable
+// ----------------------------------------------------------------------------
+/// Hash table of groups: binary key -> group number.
+/// Keys and aggregate states are stored in flat vectors, group after group.
+class dnGroupTable {
+public:
+  dnGroupTable(uint keyCount, const std::vector<dnAggregateSpec> &aggregates):
+    m_keyCount(keyCount), m_aggregates(aggregates) {}
+
+  size_t size() const { return m_groupKeys.size(); }
+  const dnode &getKey(size_t group, uint keyNo) const { return m_keys[group * m_keyCount + keyNo]; }
+  const dnAggregateState &getState(size_t group, uint aggNo) const { return m_states[group * m_aggregates.size() + aggNo]; }
+
+  /// Returns number of group with a given binary key, adds group if not found
+  size_t findOrAdd(const dtpString &key, const std::vector<const dnode *> &keyValues) {
+    GroupMap::const_iterator it = m_map.find(key);
+    if (it != m_map.end())
+      return it->second;
+
+    size_t group = addGroup(key);
+    for(std::vector<const dnode *>::const_iterator vit = keyValues.begin(), epos = keyValues.end(); vit != epos; ++vit)
+      if (isNullValue(*vit))
+        m_keys.push_back(dnode());
+      else
+        m_keys.push_back(**vit);
+    return group;
+  }
+
+  void addValue(size_t group, uint aggNo, const dnode *value) {
+    if (!isNullValue(value))
+      m_states[group * m_aggregates.size() + aggNo].add(m_aggregates[aggNo].func, *value);
+  }
+
+  /// Adds groups of other table, new groups are appended in order of other table
+  void merge(const dnGroupTable &other) {
+    const size_t aggCount = m_aggregates.size();
+    for(size_t i=0, epos = other.size(); i != epos; i++) {
+      const dtpString &key = *other.m_groupKeys[i];
+      GroupMap::const_iterator it = m_map.find(key);
+      if (it == m_map.end()) {
+        addGroup(key);
+        for(uint k=0; k != m_keyCount; k++)
+          m_keys.push_back(other.getKey(i, k));
+        std::copy(other.m_states.begin() + i * aggCount, other.m_states.begin() + (i + 1) * aggCount, m_states.end() - aggCount);
+      } else {
+        for(size_t a=0; a != aggCount; a++)
+          m_states[it->second * aggCount + a].merge(other.m_states[i * aggCount + a]);
+      }
+    }
+  }
+private:
+  size_t addGroup(const dtpString &key) {
+    size_t group = m_groupKeys.size();
+    std::pair<GroupMap::iterator, bool> res = m_map.insert(std::make_pair(key, group));
+    // element references are stable on rehash
+    m_groupKeys.push_back(&(res.first->first));
+    m_states.resize(m_states.size() + m_aggregates.size());
+    return group;
+  }
+private:
+  typedef boost::unordered_map<dtpString, size_t> GroupMap;
+  uint m_keyCount;
+  const std::vector<dnAggregateSpec> &m_aggregates;
+  GroupMap m_map;
+  std::vector<const dtpString *> m_groupKeys;
+  std::vector<dnode> m_keys;
+  std::vector<dnAggregateState> m_states;
+};
+
+// ----------------------------------------------------------------------------
+// dnGroupByContext
+// ----------------------------------------------------------------------------
+/// Input of group_by shared by all row ranges
+struct dnGroupByContext {
+  const dnTableReader &reader;
+  const std::vector<uint> &keyFields;
+  /// Field number for each aggregate, -1 = count rows
+  const std::vector<int> &aggFields;
+  const std::vector<dnAggregateSpec> &aggregates;
+
+  dnGroupByContext(const dnTableReader &aReader, const std::vector<uint> &aKeyFields,
+    const std::vector<int> &aAggFields, const std::vector<dnAggregateSpec> &aAggregates):
+    reader(aReader), keyFields(aKeyFields), aggFields(aAggFields), aggregates(aAggregates) {}
+};
+
+void groupRows(const dnGroupByContext &context, size_type first, size_type last, dnGroupTable &output)
+{
+  const uint keyCount = static_cast<uint>(context.keyFields.size());
+  const uint aggCount = static_cast<uint>(context.aggFields.size());
+  const dnode rowMarker(true);
+  std::vector<dnode> keyHelpers(keyCount);
+  std::vector<const dnode *> keyValues(keyCount);
+  dnode helper;
+  dtpString key;
+  size_t group;
+
+  for(size_type row = first; row != last; row++) {
+    key.clear();
+    for(uint k=0; k != keyCount; k++) {
+      keyValues[k] = context.reader.getValue(row, context.keyFields[k], keyHelpers[k]);
+      appendKey(keyValues[k], key);
+    }
+
+    group = output.findOrAdd(key, keyValues);
+
+    for(uint a=0; a != aggCount; a++)
+      if (context.aggFields[a] < 0)
+        output.addValue(group, a, &rowMarker);
+      else
+        output.addValue(group, a, context.reader.getValue(row, static_cast<uint>(context.aggFields[a]), helper));
+  }
+}
+
+class dnGroupByTask: public dnParallelTask {
+public:
+  dnGroupByTask(const dnGroupByContext &context, size_type first, size_type last):
+    m_context(context), m_first(first), m_last(last),
+    m_table(static_cast<uint>(context.keyFields.size()), context.aggregates) {}
+
+  virtual void run() {
+    groupRows(m_context, m_first, m_last, m_table);
+  }
+
+  const dnGroupTable &getTable() const { return m_table; }
+private:
+  const dnGroupByContext &m_context;
+  size_type m_first;
+  size_type m_last;
+  dnGroupTable m_table;
+};
+
+const char *aggregateFuncName(dnAggregateFunc func)
+{
+  switch (func) {
+    case daf_count: return "count";
+    case daf_sum: return "sum";
+    case daf_avg: return "avg";
+    case daf_min: return "min";
+    case daf_max: return "max";
+  }
+  return "";
+}
+
+dtpString aggregateOutputName(const dnAggregateSpec &spec)
+{
+  if (!spec.outputName.empty())
+    return spec.outputName;
+  if (spec.path.empty())
+    return aggregateFuncName(spec.func);
+  return dtpString(aggregateFuncName(spec.func)) + "_" + dnTableReader::fieldName(spec.path);
+}
+
+void writeRows(const dnGroupTable &groups, const std::vector<dtpString> &keyNames,
+  const std::vector<dtpString> &aggNames, const std::vector<dnAggregateSpec> &aggregates, dnode &output)
+{
+  output.setAsList();
+  for(size_t g=0, epos = groups.size(); g != epos; g++) {
+    DTP_UNIQUE_PTR(dnode) row(new dnode(ict_parent));
+    for(uint k=0; k != keyNames.size(); k++)
+      row->addChild(keyNames[k], new dnode(groups.getKey(g, k)));
+    for(uint a=0; a != aggNames.size(); a++)
+      row->addChild(aggNames[a], new dnode(groups.getState(g, a).result(aggregates[a].func)));
+    output.addChild(row.release());
+  }
+}
+
+void writeColumns(const dnGroupTable &groups, const std::vector<dtpString> &keyNames,
+  const std::vector<dtpString> &aggNames, const std::vector<dnAggregateSpec> &aggregates, dnode &output)
+{
+  const size_t groupCount = groups.size();
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+
+  output.setAsParent();
+
+  for(uint k=0; k != keyNames.size(); k++) {
+    DTP_UNIQUE_PTR(dnode) column(new dnode(ict_list));
+    for(size_t g=0; g != groupCount; g++)
+      column->addChild(new dnode(groups.getKey(g, k)));
+    output.addChild(keyNames[k], column.release());
+  }
+
+  for(uint a=0; a != aggNames.size(); a++) {
+    const dnAggregateFunc func = aggregates[a].func;
+    DTP_UNIQUE_PTR(dnode) column;
+
+    if (func == daf_count) {
+      column.reset(new dnode(ict_array, vt_uint64));
+      for(size_t g=0; g != groupCount; g++)
+        column->addItem(groups.getState(g, a).count);
+    } else {
+      bool hasFloat = (func != daf_sum);
+      for(size_t g=0; (g != groupCount) && !hasFloat; g++)
+        hasFloat = groups.getState(g, a).hasFloat;
+
+      if (!hasFloat) {
+        column.reset(new dnode(ict_array, vt_int64));
+        for(size_t g=0; g != groupCount; g++)
+          column->addItem(groups.getState(g, a).intSum);
+      } else {
+        column.reset(new dnode(ict_array, vt_double));
+        for(size_t g=0; g != groupCount; g++) {
+          const dnAggregateState &state = groups.getState(g, a);
+          switch (func) {
+            case daf_sum:
+              column->addItem(state.total());
+              break;
+            case daf_avg:
+              column->addItem((state.count > 0) ? state.total() / static_cast<double>(state.count) : nan);
+              break;
+            case daf_min:
+              column->addItem((state.count > 0) ? state.minValue : nan);
+              break;
+            default:
+              column->addItem((state.count > 0) ? state.maxValue : nan);
+              break;
+          }
+        }
+      }
+    }
+
+    output.addChild(aggNames[a], column.release());
+  }
+}
+
+// ----------------------------------------------------------------------------
+// dnJoinHashTable
+// ----------------------------------------------------------------------------
+/// Encodes key of row into output, returns false if any key field is null
+bool readRowKey(const dnTableReader &reader, size_type row, const std::vector<uint> &keyFields,
+  dnode &helper, dtpString &output)
+{
+  const dnode *value;
+  output.clear();
+  for(std::vector<uint>::const_iterator it = keyFields.begin(), epos = keyFields.end(); it != epos; ++it) {
+    value = reader.getValue(row, *it, helper);
+    if (isNullValue(value))
+      return false;
+    appendKey(value, output);
+  }
+  return true;
+}
+
+/// Hash table of build side rows: binary key -> chain of rows in ascending order
+class dnJoinHashTable {
+public:
+  void build(const dnTableReader &reader, const std::vector<uint> &keyFields) {
+    const size_type rowCount = reader.rowCount();
+    dnode helper;
+    dtpString key;
+
+    m_next.assign(rowCount, dnode::npos);
+    m_map.rehash(rowCount);
+
+    for(size_type row = 0; row != rowCount; row++) {
+      if (!readRowKey(reader, row, keyFields, helper, key))
+        continue;
+      ChainMap::iterator it = m_map.find(key);
+      if (it == m_map.end()) {
+        m_map.insert(std::make_pair(key, dnJoinChain(row)));
+      } else {
+        m_next[it->second.last] = row;
+        it->second.last = row;
+      }
+    }
+  }
+
+  /// Returns first row with a given key or dnode::npos
+  size_type findFirst(const dtpString &key) const {
+    ChainMap::const_iterator it = m_map.find(key);
+    return (it != m_map.end()) ? it->second.first : dnode::npos;
+  }
+
+  /// Returns next row with the same key or dnode::npos
+  size_type next(size_type row) const { return m_next[row]; }
+private:
+  struct dnJoinChain {
+    size_type first;
+    size_type last;
+    dnJoinChain(size_type row): first(row), last(row) {}
+  };
+  typedef boost::unordered_map<dtpString, dnJoinChain> ChainMap;
+  ChainMap m_map;
+  std::vector<size_type> m_next;
+};
+
+/// Pair of matching rows: left row, right row
+typedef std::pair<size_type, size_type> dnJoinMatch;
+typedef std::vector<dnJoinMatch> dnJoinMatchList;
+
+/// Probe side of join shared by all row ranges
+struct dnJoinProbeContext {
+  const dnTableReader &reader;
+  const std::vector<uint> &keyFields;
+  const dnJoinHashTable &table;
+  /// true if hash table contains left rows
+  bool buildLeft;
+  /// true if a single match for each left row is enough
+  bool firstOnly;
+
+  dnJoinProbeContext(const dnTableReader &aReader, const std::vector<uint> &aKeyFields,
+    const dnJoinHashTable &aTable, bool aBuildLeft, bool aFirstOnly):
+    reader(aReader), keyFields(aKeyFields), table(aTable), buildLeft(aBuildLeft), firstOnly(aFirstOnly) {}
+};
+
+void probeRows(const dnJoinProbeContext &context, size_type first, size_type last, dnJoinMatchList &output)
+{
+  dnode helper;
+  dtpString key;
+
+  for(size_type row = first; row != last; row++) {
+    if (!readRowKey(context.reader, row, context.keyFields, helper, key))
+      continue;
+    for(size_type match = context.table.findFirst(key); match != dnode::npos; match = context.table.next(match)) {
+      if (context.buildLeft) {
+        output.push_back(dnJoinMatch(match, row));
+      } else {
+        output.push_back(dnJoinMatch(row, match));
+        if (context.firstOnly)
+          break;
+      }
+    }
+  }
+}
+
+class dnJoinProbeTask: public dnParallelTask {
+public:
+  dnJoinProbeTask(const dnJoinProbeContext &context, size_type first, size_type last):
+    m_context(context), m_first(first), m_last(last) {}
+
+  virtual void run() {
+    probeRows(m_context, m_first, m_last, m_matches);
+  }
+
+  const dnJoinMatchList &getMatches() const { return m_matches; }
+private:
+  const dnJoinProbeContext &m_context;
+  size_type m_first;
+  size_type m_last;
+  dnJoinMatchList m_matches;
+};
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// group_by
+// ----------------------------------------------------------------------------
+void dtp::group_by(const dnode &table, const std::vector<dtpString> &keyPaths,
+  const std::vector<dnAggregateSpec> &aggregates, dnode &output,
+  const dnGroupByOptions &options)
+{
+  dnTableReader reader(table);
+  std::vector<uint> keyFields;
+  std::vector<int> aggFields;
+  std::vector<dtpString> keyNames, aggNames;
+
+  for(std::vector<dtpString>::const_iterator it = keyPaths.begin(), epos = keyPaths.end(); it != epos; ++it) {
+    keyFields.push_back(reader.addField(*it));
+    keyNames.push_back(dnTableReader::fieldName(*it));
+  }
+
+  for(std::vector<dnAggregateSpec>::const_iterator it = aggregates.begin(), epos = aggregates.end(); it != epos; ++it) {
+    if (it->path.empty()) {
+      if (it->func != daf_count)
+        throw dnError("Aggregate field path required: " + dtpString(aggregateFuncName(it->func)));
+      aggFields.push_back(-1);
+    } else {
+      aggFields.push_back(static_cast<int>(reader.addField(it->path)));
+    }
+    aggNames.push_back(aggregateOutputName(*it));
+  }
+
+  dnGroupByContext context(reader, keyFields, aggFields, aggregates);
+  dnGroupTable groups(static_cast<uint>(keyFields.size()), aggregates);
+  const size_type rowCount = reader.rowCount();
+  dnThreadPool &pool = selectPool(options.pool);
+
+  if (useParallel(options.parallel, options.minParallelRows, rowCount, pool)) {
+    boost::ptr_vector<dnGroupByTask> tasks;
+    executeRowRanges(pool, context, rowCount, tasks);
+
+    // merge in range order keeps order of first appearance
+    for(size_type i=0, epos = tasks.size(); i != epos; i++)
+      groups.merge(tasks[i].getTable());
+  } else {
+    groupRows(context, 0, rowCount, groups);
+  }
+
+  dnTableFormat format = options.outputFormat;
+  if (format == dtf_auto)
+    format = reader.isColumnar() ? dtf_columns : dtf_rows;
+
+  dnode result;
+  if (format == dtf_columns)
+    writeColumns(groups, keyNames, aggNames, aggregates, result);
+  else
+    writeRows(groups, keyNames, aggNames, aggregates, result);
+  output.swap(result);
+}
+
+// ----------------------------------------------------------------------------
+// hash_join
+// ----------------------------------------------------------------------------
+void dtp::hash_join(const dnode &left, const dnode &right,
+  const std::vector<dtpString> &leftKeys, const std::vector<dtpString> &rightKeys,
+  const std::vector<dnJoinColumn> &columns, dnJoinType joinType, dnode &output,
+  const dnJoinOptions &options)
+{
+  if (leftKeys.empty() || (leftKeys.size() != rightKeys.size()))
+    throw dnError("Join key count mismatch: " + toString(leftKeys.size()) + ", " + toString(rightKeys.size()));
+
+  dnTableReader leftReader(left);
+  dnTableReader rightReader(right);
+  std::vector<uint> leftKeyFields, rightKeyFields, columnFields;
+
+  for(size_t i=0, epos = leftKeys.size(); i != epos; i++) {
+    leftKeyFields.push_back(leftReader.addField(leftKeys[i]));
+    rightKeyFields.push_back(rightReader.addField(rightKeys[i]));
+  }
+
+  dnTableFormat format = options.outputFormat;
+  if (format == dtf_auto)
+    format = leftReader.isColumnar() ? dtf_columns : dtf_rows;
+
+  dnTableWriter writer(format == dtf_columns);
+
+  for(std::vector<dnJoinColumn>::const_iterator it = columns.begin(), epos = columns.end(); it != epos; ++it) {
+    const bool fromRight = (it->side == djs_right);
+    if (fromRight && (joinType == djt_semi))
+      throw dnError("Semi join cannot output right column: " + it->path);
+    dnTableReader &reader = fromRight ? rightReader : leftReader;
+    uint field = reader.addField(it->path);
+    columnFields.push_back(field);
+    writer.addColumn(it->outputName.empty() ? dnTableReader::fieldName(it->path) : it->outputName,
+      reader.getColumn(field), fromRight && (joinType == djt_left));
+  }
+
+  // hash table for smaller table, the other one is probed
+  const bool buildLeft = (leftReader.rowCount() < rightReader.rowCount());
+  const dnTableReader &buildReader = buildLeft ? leftReader : rightReader;
+  const dnTableReader &probeReader = buildLeft ? rightReader : leftReader;
+  dnJoinHashTable table;
+  table.build(buildReader, buildLeft ? leftKeyFields : rightKeyFields);
+
+  dnJoinProbeContext context(probeReader, buildLeft ? rightKeyFields : leftKeyFields, table,
+    buildLeft, (joinType == djt_semi));
+  const size_type probeCount = probeReader.rowCount();
+  dnThreadPool &pool = selectPool(options.pool);
+  dnJoinMatchList matches;
+
+  if (useParallel(options.parallel, options.minParallelRows, probeCount, pool)) {
+    boost::ptr_vector<dnJoinProbeTask> tasks;
+    executeRowRanges(pool, context, probeCount, tasks);
+
+    size_t matchCount = 0;
+    for(size_t i=0, epos = tasks.size(); i != epos; i++)
+      matchCount += tasks[i].getMatches().size();
+    matches.reserve(matchCount);
+    for(size_t i=0, epos = tasks.size(); i != epos; i++)
+      matches.insert(matches.end(), tasks[i].getMatches().begin(), tasks[i].getMatches().end());
+  } else {
+    probeRows(context, 0, probeCount, matches);
+  }
+
+  // matches are ordered by probed row
+  if (buildLeft)
+    std::sort(matches.begin(), matches.end());
+
+  dnode leftHelper, rightHelper;
+  dnJoinMatchList::const_iterator match = matches.begin(), matchEnd = matches.end();
+  const uint columnCount = static_cast<uint>(columns.size());
+
+  for(size_type row = 0, epos = leftReader.rowCount(); row != epos; row++) {
+    bool matched = false;
+
+    for(; (match != matchEnd) && (match->first == row); ++match) {
+      if (matched && (joinType == djt_semi))
+        continue;
+      matched = true;
+      writer.beginRow();
+      for(uint c=0; c != columnCount; c++)
+        if (columns[c].side == djs_right)
+          writer.setValue(c, rightReader.getValue(match->second, columnFields[c], rightHelper));
+        else
+          writer.setValue(c, leftReader.getValue(row, columnFields[c], leftHelper));
+      writer.endRow();
+    }
+
+    if (!matched && (joinType == djt_left)) {
+      writer.beginRow();
+      for(uint c=0; c != columnCount; c++)
+        writer.setValue(c, (columns[c].side == djs_right) ? DTP_NULL : leftReader.getValue(row, columnFields[c], leftHelper));
+      writer.endRow();
+    }
+  }
+
+  writer.release(output);
+}
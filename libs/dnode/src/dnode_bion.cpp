@@ -296,3 +296,46 @@ void dnBionProcessor::processUInt64(uint64 value)
   addScalar(node);
 }
 
+// ----------------------------------------------------------------------------
+// dnBionStringPoolProcessor
+// ----------------------------------------------------------------------------
+dnBionStringPoolProcessor::dnBionStringPoolProcessor(dtp::dnStringPool &output): m_output(output), m_listTagWait(false)
+{
+  m_output.clear();
+}
+
+void dnBionStringPoolProcessor::processHeader(void *data, size_t dataSize)
+{
+  m_output.clear();
+  m_listTagWait = false;
+}
+
+void dnBionStringPoolProcessor::processObjectBegin()
+{
+  throw dnBionError(DBE_UndefContainerType);
+}
+
+void dnBionStringPoolProcessor::processFixTypeArrayBegin(BionValueType valueType, unsigned int elementSize, size_t arraySize)
+{
+  if (valueType != bvt_zstring)
+    throwWrongType();
+  m_output.reserve(m_output.size() + arraySize, 0);
+}
+
+void dnBionStringPoolProcessor::processElementName(char *name)
+{
+  throw dnBionError(DBE_UndefContainerType);
+}
+
+void dnBionStringPoolProcessor::processInt(int value)
+{
+  // list type tag written after array start
+  if (!m_listTagWait)
+    throwWrongType();
+  m_listTagWait = false;
+}
+
+void dnBionStringPoolProcessor::throwWrongType()
+{
+  throw dnBionError(DBE_WrongScalarType);
+}
@@ -0,0 +1,1614 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_expr.cpp
+// Project:     dtpLib
+// Purpose:     Compiled expressions over dnode rows & tables
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <limits>
+#include <algorithm>
+#include <map>
+
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include "base/date.h"
+#include "dtp/dnode_expr.h"
+#include "dtp/details/dnode_table.h"
+
+using namespace dtp;
+using namespace Details;
+
+// ----------------------------------------------------------------------------
+// dnExprValue
+// ----------------------------------------------------------------------------
+bool dnExprValue::isTrue() const
+{
+  switch (m_type) {
+    case det_bool:
+    case det_number:
+      return (m_number != 0.0);
+    case det_string:
+      return !m_text.empty();
+    default:
+      return false;
+  }
+}
+
+double dnExprValue::getNumber() const
+{
+  if ((m_type != det_number) && (m_type != det_bool))
+    throw dnExprError(isNull() ? "Null value used as number" : "String value used as number: '" + m_text + "'");
+  return m_number;
+}
+
+const dtpString &dnExprValue::getString() const
+{
+  if (m_type != det_string)
+    throw dnExprError("String expected");
+  return m_text;
+}
+
+void dnExprValue::getAsNode(dnode &output) const
+{
+  switch (m_type) {
+    case det_bool:
+      output = dnode(m_number != 0.0);
+      break;
+    case det_number:
+      output = dnode(m_number);
+      break;
+    case det_string:
+      output = dnode(m_text);
+      break;
+    default:
+      output = dnode();
+      break;
+  }
+}
+
+namespace {
+
+typedef dnode::size_type size_type;
+
+const double DNEXPR_NAN = std::numeric_limits<double>::quiet_NaN();
+
+inline bool isNan(double value)
+{
+  return (value != value);
+}
+
+/// Truth of batch value: non-null, non-zero
+inline bool isTrueNumber(double value)
+{
+  return !isNan(value) && (value != 0.0);
+}
+
+inline double batchNumber(const dnExprValue &value)
+{
+  if (value.isNull())
+    return DNEXPR_NAN;
+  return value.getNumber();
+}
+
+void appendNumber(dtpString &output, double value)
+{
+  char buffer[32];
+  if ((value == std::floor(value)) && (std::fabs(value) < 1e15))
+    snprintf(buffer, sizeof(buffer), "%.0f", value);
+  else
+    snprintf(buffer, sizeof(buffer), "%.15g", value);
+  output += buffer;
+}
+
+void appendText(dtpString &output, const dnExprValue &value)
+{
+  switch (value.getType()) {
+    case det_string:
+      output += value.getString();
+      break;
+    case det_bool:
+      output += value.isTrue() ? "true" : "false";
+      break;
+    case det_number:
+      appendNumber(output, value.getNumber());
+      break;
+    default:
+      break;
+  }
+}
+
+bool isNumericType(dnValueType valueType)
+{
+  switch (valueType) {
+    case vt_byte:
+    case vt_int:
+    case vt_uint:
+    case vt_int64:
+    case vt_uint64:
+    case vt_bool:
+    case vt_float:
+    case vt_double:
+    case vt_xdouble:
+    case vt_date:
+    case vt_time:
+    case vt_datetime:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/// Parses "YYYY-MM-DD", "YYYY-MM-DD HH:NN" or "YYYY-MM-DD HH:NN:SS" (also with 'T')
+bool parseIsoDateTime(const dtpString &text, double &output)
+{
+  uint parts[6] = {0, 0, 0, 0, 0, 0};
+  const uint digits[6] = {4, 2, 2, 2, 2, 2};
+  const char separators[6] = {0, '-', '-', ' ', ':', ':'};
+  size_t pos = 0;
+  uint count = 0;
+
+  for(; count < 6; count++) {
+    if (count > 0) {
+      if (pos == text.length())
+        break;
+      char separator = text[pos];
+      if ((separator != separators[count]) && !((count == 3) && (separator == 'T')))
+        return false;
+      pos++;
+    }
+    for(uint i=0; i < digits[count]; i++, pos++) {
+      if ((pos >= text.length()) || !isdigit(static_cast<unsigned char>(text[pos])))
+        return false;
+      parts[count] = parts[count] * 10 + static_cast<uint>(text[pos] - '0');
+    }
+  }
+
+  if ((count < 3) || (count == 4) || (pos != text.length()))
+    return false;
+  if ((parts[1] < 1) || (parts[1] > 12) || (parts[2] < 1) || (parts[2] > 31) ||
+      (parts[3] > 23) || (parts[4] > 59) || (parts[5] > 59))
+    return false;
+
+  fdatetime_t value;
+  if (!encodeDateTime(parts[0], parts[1], parts[2], parts[3], parts[4], parts[5], value))
+    return false;
+  output = value;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// dnExprContext
+// ----------------------------------------------------------------------------
+/// Input of evaluation: single row or row(s) of bound table
+struct dnExprContext {
+  const dnode *row;
+  const dnTableReader *reader;
+  size_type rowIndex;
+  size_type batchFirst;
+  size_t batchCount;
+
+  dnExprContext(): row(DTP_NULL), reader(DTP_NULL), rowIndex(0), batchFirst(0), batchCount(0) {}
+};
+
+// ----------------------------------------------------------------------------
+// dnExprNode
+// ----------------------------------------------------------------------------
+/// Operation node, result of eval is stored in node and reused for next rows
+class dnExprNode {
+public:
+  virtual ~dnExprNode() {}
+
+  void addChild(dnExprNode *child) { m_children.push_back(child); }
+
+  /// Calculates value for context row
+  virtual const dnExprValue &eval(const dnExprContext &context) = 0;
+  /// Prepares node for table, reader is NULL for single row evaluation
+  virtual void bind(const dnTableReader *reader) {
+    for(size_t i=0, epos = m_children.size(); i != epos; i++)
+      m_children[i].bind(reader);
+  }
+  /// Returns true if result is number, bool or null for each row
+  virtual bool isNumeric() const = 0;
+  /// Returns true if result does not depend on row
+  virtual bool isConstant() const {
+    for(size_t i=0, epos = m_children.size(); i != epos; i++)
+      if (!m_children[i].isConstant())
+        return false;
+    return true;
+  }
+  /// Calculates results for batch rows as numbers (null = NaN)
+  virtual const double *evalBatch(dnExprContext &context) {
+    return evalRows(context);
+  }
+protected:
+  /// Calculates results of batch row by row
+  const double *evalRows(dnExprContext &context) {
+    prepareBatch();
+    for(size_t i=0; i != context.batchCount; i++) {
+      context.rowIndex = context.batchFirst + i;
+      m_batch[i] = batchNumber(eval(context));
+    }
+    return &m_batch[0];
+  }
+
+  bool childrenNumeric() const {
+    for(size_t i=0, epos = m_children.size(); i != epos; i++)
+      if (!m_children[i].isNumeric())
+        return false;
+    return true;
+  }
+
+  void prepareBatch() {
+    if (m_batch.size() < DNEXPR_BATCH_SIZE)
+      m_batch.resize(DNEXPR_BATCH_SIZE);
+  }
+protected:
+  boost::ptr_vector<dnExprNode> m_children;
+  dnExprValue m_value;
+  std::vector<double> m_batch;
+};
+
+// ----------------------------------------------------------------------------
+// dnExprLiteral
+// ----------------------------------------------------------------------------
+class dnExprLiteral: public dnExprNode {
+public:
+  dnExprLiteral(const dnExprValue &value) { m_value = value; }
+
+  virtual const dnExprValue &eval(const dnExprContext &) { return m_value; }
+  virtual bool isNumeric() const { return !m_value.isString(); }
+  virtual bool isConstant() const { return true; }
+
+  virtual const double *evalBatch(dnExprContext &context) {
+    if (m_value.isString())
+      return evalRows(context);
+    prepareBatch();
+    std::fill(m_batch.begin(), m_batch.begin() + context.batchCount, batchNumber(m_value));
+    return &m_batch[0];
+  }
+};
+
+// ----------------------------------------------------------------------------
+// dnExprField
+// ----------------------------------------------------------------------------
+class dnExprField: public dnExprNode {
+public:
+  dnExprField(uint field, const dtpString &path): m_field(field), m_pathText(path), m_column(DTP_NULL), m_numericColumn(false) {
+    dnTableReader::splitPath(path, m_path);
+  }
+
+  virtual const dnExprValue &eval(const dnExprContext &context) {
+    const dnode *value;
+    if (context.reader != DTP_NULL)
+      value = context.reader->getValue(context.rowIndex, m_field, m_helper);
+    else
+      value = dnTableReader::findField(*context.row, m_path);
+
+    if (value == DTP_NULL) {
+      m_value.setNull();
+      return m_value;
+    }
+
+    switch (value->getValueType()) {
+      case vt_null:
+        m_value.setNull();
+        break;
+      case vt_bool:
+        m_value.setBool(value->getAs<bool>());
+        break;
+      case vt_string:
+        m_value.setString(value->getAs<dtpString>());
+        break;
+      case vt_parent:
+      case vt_array:
+      case vt_vptr:
+        throw dnExprError("Field is not a scalar: " + m_pathText);
+      default:
+        m_value.setNumber(value->getAs<double>());
+        break;
+    }
+    return m_value;
+  }
+
+  virtual void bind(const dnTableReader *reader) {
+    m_column = (reader != DTP_NULL) ? reader->getColumn(m_field) : DTP_NULL;
+    m_numericColumn = (m_column != DTP_NULL) && m_column->isArray() && isNumericType(m_column->getElementType());
+  }
+
+  virtual bool isNumeric() const { return m_numericColumn; }
+  virtual bool isConstant() const { return false; }
+
+  virtual const double *evalBatch(dnExprContext &context) {
+    if (!m_numericColumn)
+      return evalRows(context);
+    prepareBatch();
+    for(size_t i=0; i != context.batchCount; i++)
+      m_batch[i] = m_column->get<double>(context.batchFirst + i);
+    return &m_batch[0];
+  }
+private:
+  uint m_field;
+  dtpString m_pathText;
+  std::vector<dtpString> m_path;
+  const dnode *m_column;
+  bool m_numericColumn;
+  dnode m_helper;
+};
+
+// ----------------------------------------------------------------------------
+// dnExprUnary
+// ----------------------------------------------------------------------------
+enum dnExprUnaryOp {
+  euo_neg,
+  euo_not
+};
+
+class dnExprUnary: public dnExprNode {
+public:
+  dnExprUnary(dnExprUnaryOp op, dnExprNode *arg): m_op(op) { addChild(arg); }
+
+  virtual const dnExprValue &eval(const dnExprContext &context) {
+    const dnExprValue &arg = m_children[0].eval(context);
+    if (arg.isNull())
+      m_value.setNull();
+    else if (m_op == euo_neg)
+      m_value.setNumber(-arg.getNumber());
+    else
+      m_value.setBool(!arg.isTrue());
+    return m_value;
+  }
+
+  virtual bool isNumeric() const { return true; }
+
+  virtual const double *evalBatch(dnExprContext &context) {
+    if (!childrenNumeric())
+      return evalRows(context);
+    const double *arg = m_children[0].evalBatch(context);
+    prepareBatch();
+    if (m_op == euo_neg) {
+      for(size_t i=0; i != context.batchCount; i++)
+        m_batch[i] = -arg[i];
+    } else {
+      for(size_t i=0; i != context.batchCount; i++)
+        m_batch[i] = isNan(arg[i]) ? DNEXPR_NAN : ((arg[i] == 0.0) ? 1.0 : 0.0);
+    }
+    return &m_batch[0];
+  }
+private:
+  dnExprUnaryOp m_op;
+};
+
+// ----------------------------------------------------------------------------
+// dnExprBinary
+// ----------------------------------------------------------------------------
+enum dnExprBinaryOp {
+  ebo_add,
+  ebo_sub,
+  ebo_mul,
+  ebo_div,
+  ebo_mod,
+  ebo_eq,
+  ebo_ne,
+  ebo_lt,
+  ebo_le,
+  ebo_gt,
+  ebo_ge
+};
+
+inline bool isCompareOp(dnExprBinaryOp op)
+{
+  return (op >= ebo_eq);
+}
+
+/// Returns result of comparison for compare result (-1, 0, 1)
+inline bool compareResult(dnExprBinaryOp op, int cmp)
+{
+  switch (op) {
+    case ebo_eq: return (cmp == 0);
+    case ebo_ne: return (cmp != 0);
+    case ebo_lt: return (cmp < 0);
+    case ebo_le: return (cmp <= 0);
+    case ebo_gt: return (cmp > 0);
+    default: return (cmp >= 0);
+  }
+}
+
+inline int compareNumbers(double a, double b)
+{
+  return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+class dnExprBinary: public dnExprNode {
+public:
+  dnExprBinary(dnExprBinaryOp op, dnExprNode *left, dnExprNode *right): m_op(op) {
+    addChild(left);
+    addChild(right);
+  }
+
+  virtual const dnExprValue &eval(const dnExprContext &context) {
+    const dnExprValue &a = m_children[0].eval(context);
+    const dnExprValue &b = m_children[1].eval(context);
+
+    if (a.isNull() || b.isNull()) {
+      m_value.setNull();
+      return m_value;
+    }
+
+    if (isCompareOp(m_op)) {
+      if (a.isString() && b.isString())
+        m_value.setBool(compareResult(m_op, a.getString().compare(b.getString())));
+      else if (a.isNumeric() && b.isNumeric())
+        m_value.setBool(compareResult(m_op, compareNumbers(a.getNumber(), b.getNumber())));
+      else if ((m_op == ebo_eq) || (m_op == ebo_ne))
+        m_value.setBool(m_op == ebo_ne);
+      else
+        throw dnExprError("Cannot compare string with number");
+      return m_value;
+    }
+
+    if ((m_op == ebo_add) && (a.isString() || b.isString())) {
+      dtpString &text = m_value.prepareString();
+      text.clear();
+      appendText(text, a);
+      appendText(text, b);
+      return m_value;
+    }
+
+    m_value.setNumber(calc(a.getNumber(), b.getNumber()));
+    return m_value;
+  }
+
+  virtual bool isNumeric() const {
+    return (m_op != ebo_add) || childrenNumeric();
+  }
+
+  virtual const double *evalBatch(dnExprContext &context) {
+    if (!childrenNumeric())
+      return evalRows(context);
+
+    const double *a = m_children[0].evalBatch(context);
+    const double *b = m_children[1].evalBatch(context);
+    const size_t count = context.batchCount;
+    prepareBatch();
+    double *out = &m_batch[0];
+
+    switch (m_op) {
+      case ebo_add:
+        for(size_t i=0; i != count; i++) out[i] = a[i] + b[i];
+        break;
+      case ebo_sub:
+        for(size_t i=0; i != count; i++) out[i] = a[i] - b[i];
+        break;
+      case ebo_mul:
+        for(size_t i=0; i != count; i++) out[i] = a[i] * b[i];
+        break;
+      case ebo_div:
+        for(size_t i=0; i != count; i++) out[i] = a[i] / b[i];
+        break;
+      case ebo_mod:
+        for(size_t i=0; i != count; i++) out[i] = std::fmod(a[i], b[i]);
+        break;
+      default:
+        for(size_t i=0; i != count; i++)
+          out[i] = (isNan(a[i]) || isNan(b[i])) ? DNEXPR_NAN :
+            (compareResult(m_op, compareNumbers(a[i], b[i])) ? 1.0 : 0.0);
+        break;
+    }
+    return out;
+  }
+private:
+  double calc(double a, double b) const {
+    switch (m_op) {
+      case ebo_add: return a + b;
+      case ebo_sub: return a - b;
+      case ebo_mul: return a * b;
+      case ebo_div: return a / b;
+      default: return std::fmod(a, b);
+    }
+  }
+private:
+  dnExprBinaryOp m_op;
+};
+
+// ----------------------------------------------------------------------------
+// dnExprLogic
+// ----------------------------------------------------------------------------
+class dnExprLogic: public dnExprNode {
+public:
+  dnExprLogic(bool isAnd, dnExprNode *left, dnExprNode *right): m_isAnd(isAnd) {
+    addChild(left);
+    addChild(right);
+  }
+
+  virtual const dnExprValue &eval(const dnExprContext &context) {
+    // right side is not evaluated if result is known
+    bool res = m_children[0].eval(context).isTrue();
+    if (res == m_isAnd)
+      res = m_children[1].eval(context).isTrue();
+    m_value.setBool(res);
+    return m_value;
+  }
+
+  virtual bool isNumeric() const { return true; }
+
+  virtual const double *evalBatch(dnExprContext &context) {
+    if (!childrenNumeric())
+      return evalRows(context);
+    const double *a = m_children[0].evalBatch(context);
+    const double *b = m_children[1].evalBatch(context);
+    prepareBatch();
+    if (m_isAnd) {
+      for(size_t i=0; i != context.batchCount; i++)
+        m_batch[i] = (isTrueNumber(a[i]) && isTrueNumber(b[i])) ? 1.0 : 0.0;
+    } else {
+      for(size_t i=0; i != context.batchCount; i++)
+        m_batch[i] = (isTrueNumber(a[i]) || isTrueNumber(b[i])) ? 1.0 : 0.0;
+    }
+    return &m_batch[0];
+  }
+private:
+  bool m_isAnd;
+};
+
+// ----------------------------------------------------------------------------
+// dnExprFunction
+// ----------------------------------------------------------------------------
+enum dnExprFunc {
+  efn_abs, efn_round, efn_floor, efn_ceil, efn_sqrt, efn_pow, efn_min, efn_max,
+  efn_if, efn_coalesce, efn_is_null,
+  efn_len, efn_lower, efn_upper, efn_trim, efn_substr, efn_contains, efn_starts_with, efn_ends_with,
+  efn_str, efn_num,
+  efn_date, efn_date_str, efn_datetime_str, efn_year, efn_month, efn_day, efn_hour, efn_minute, efn_second,
+  efn_today, efn_now
+};
+
+enum dnExprResultKind {
+  erk_number,  ///< number, bool or null
+  erk_string,  ///< string or null
+  erk_args     ///< one of arguments
+};
+
+struct dnExprFuncInfo {
+  const char *name;
+  dnExprFunc func;
+  uint minArgs;
+  uint maxArgs;
+  dnExprResultKind resultKind;
+};
+
+const uint DNEXPR_MANY_ARGS = 1000;
+
+const dnExprFuncInfo DNEXPR_FUNCTIONS[] = {
+  {"abs", efn_abs, 1, 1, erk_number},
+  {"round", efn_round, 1, 2, erk_number},
+  {"floor", efn_floor, 1, 1, erk_number},
+  {"ceil", efn_ceil, 1, 1, erk_number},
+  {"sqrt", efn_sqrt, 1, 1, erk_number},
+  {"pow", efn_pow, 2, 2, erk_number},
+  {"min", efn_min, 2, 2, erk_number},
+  {"max", efn_max, 2, 2, erk_number},
+  {"if", efn_if, 3, 3, erk_args},
+  {"coalesce", efn_coalesce, 1, DNEXPR_MANY_ARGS, erk_args},
+  {"is_null", efn_is_null, 1, 1, erk_number},
+  {"len", efn_len, 1, 1, erk_number},
+  {"lower", efn_lower, 1, 1, erk_string},
+  {"upper", efn_upper, 1, 1, erk_string},
+  {"trim", efn_trim, 1, 1, erk_string},
+  {"substr", efn_substr, 2, 3, erk_string},
+  {"contains", efn_contains, 2, 2, erk_number},
+  {"starts_with", efn_starts_with, 2, 2, erk_number},
+  {"ends_with", efn_ends_with, 2, 2, erk_number},
+  {"str", efn_str, 1, 1, erk_string},
+  {"num", efn_num, 1, 1, erk_number},
+  {"date", efn_date, 1, 1, erk_number},
+  {"date_str", efn_date_str, 1, 1, erk_string},
+  {"datetime_str", efn_datetime_str, 1, 1, erk_string},
+  {"year", efn_year, 1, 1, erk_number},
+  {"month", efn_month, 1, 1, erk_number},
+  {"day", efn_day, 1, 1, erk_number},
+  {"hour", efn_hour, 1, 1, erk_number},
+  {"minute", efn_minute, 1, 1, erk_number},
+  {"second", efn_second, 1, 1, erk_number},
+  {"today", efn_today, 0, 0, erk_number},
+  {"now", efn_now, 0, 0, erk_number}
+};
+
+const dnExprFuncInfo *findFunction(const dtpString &name)
+{
+  for(size_t i=0; i != sizeof(DNEXPR_FUNCTIONS) / sizeof(DNEXPR_FUNCTIONS[0]); i++)
+    if (name == DNEXPR_FUNCTIONS[i].name)
+      return &DNEXPR_FUNCTIONS[i];
+  return DTP_NULL;
+}
+
+inline double roundTo(double value, double digits)
+{
+  const double factor = std::pow(10.0, digits);
+  const double scaled = value * factor;
+  return ((scaled < 0.0) ? -std::floor(-scaled + 0.5) : std::floor(scaled + 0.5)) / factor;
+}
+
+/// Returns part of date (year, month, ...) for numeric date function
+double datePart(dnExprFunc func, double value)
+{
+  if (isNan(value))
+    return DNEXPR_NAN;
+  uint year, month, day, hour, minute, second;
+  decodeDateTime(value, year, month, day, hour, minute, second);
+  switch (func) {
+    case efn_year: return year;
+    case efn_month: return month;
+    case efn_day: return day;
+    case efn_hour: return hour;
+    case efn_minute: return minute;
+    default: return second;
+  }
+}
+
+class dnExprFunction: public dnExprNode {
+public:
+  dnExprFunction(const dnExprFuncInfo &info): m_info(info) {}
+
+  virtual const dnExprValue &eval(const dnExprContext &context) {
+    switch (m_info.func) {
+      case efn_if: {
+        const dnExprValue &res = m_children[m_children[0].eval(context).isTrue() ? 1 : 2].eval(context);
+        m_value = res;
+        return m_value;
+      }
+      case efn_coalesce:
+        for(size_t i=0, epos = m_children.size(); i != epos; i++) {
+          const dnExprValue &res = m_children[i].eval(context);
+          if (!res.isNull()) {
+            m_value = res;
+            return m_value;
+          }
+        }
+        m_value.setNull();
+        return m_value;
+      case efn_is_null:
+        m_value.setBool(m_children[0].eval(context).isNull());
+        return m_value;
+      case efn_today:
+        m_value.setNumber(currentDate());
+        return m_value;
+      case efn_now:
+        m_value.setNumber(currentDateTime());
+        return m_value;
+      default:
+        break;
+    }
+
+    const dnExprValue *args[3];
+    for(size_t i=0, epos = m_children.size(); i != epos; i++) {
+      args[i] = &(m_children[i].eval(context));
+      if (args[i]->isNull()) {
+        m_value.setNull();
+        return m_value;
+      }
+    }
+
+    switch (m_info.func) {
+      case efn_len:
+        m_value.setNumber(static_cast<double>(args[0]->getString().length()));
+        break;
+      case efn_lower:
+      case efn_upper: {
+        const dtpString &input = args[0]->getString();
+        dtpString &text = m_value.prepareString();
+        text.assign(input);
+        for(size_t i=0, epos = text.length(); i != epos; i++)
+          text[i] = static_cast<char>((m_info.func == efn_lower) ?
+            tolower(static_cast<unsigned char>(text[i])) : toupper(static_cast<unsigned char>(text[i])));
+        break;
+      }
+      case efn_trim: {
+        const dtpString &input = args[0]->getString();
+        size_t first = input.find_first_not_of(" \t\r\n");
+        dtpString &text = m_value.prepareString();
+        if (first == dtpString::npos)
+          text.clear();
+        else
+          text.assign(input, first, input.find_last_not_of(" \t\r\n") - first + 1);
+        break;
+      }
+      case efn_substr: {
+        const dtpString &input = args[0]->getString();
+        double start = args[1]->getNumber();
+        double count = (m_children.size() > 2) ? args[2]->getNumber() : static_cast<double>(input.length());
+        dtpString &text = m_value.prepareString();
+        if ((start < 0.0) || (count <= 0.0) || (start >= static_cast<double>(input.length())))
+          text.clear();
+        else
+          text.assign(input, static_cast<size_t>(start), static_cast<size_t>(count));
+        break;
+      }
+      case efn_contains:
+        m_value.setBool(args[0]->getString().find(args[1]->getString()) != dtpString::npos);
+        break;
+      case efn_starts_with: {
+        const dtpString &input = args[0]->getString();
+        const dtpString &part = args[1]->getString();
+        m_value.setBool((part.length() <= input.length()) && (input.compare(0, part.length(), part) == 0));
+        break;
+      }
+      case efn_ends_with: {
+        const dtpString &input = args[0]->getString();
+        const dtpString &part = args[1]->getString();
+        m_value.setBool((part.length() <= input.length()) &&
+          (input.compare(input.length() - part.length(), part.length(), part) == 0));
+        break;
+      }
+      case efn_str: {
+        dtpString &text = m_value.prepareString();
+        text.clear();
+        appendText(text, *args[0]);
+        break;
+      }
+      case efn_num:
+        if (args[0]->isString()) {
+          const dtpString &input = args[0]->getString();
+          char *end;
+          double value = strtod(input.c_str(), &end);
+          if (input.empty() || (*end != '\0'))
+            m_value.setNull();
+          else
+            m_value.setNumber(value);
+        } else {
+          m_value.setNumber(args[0]->getNumber());
+        }
+        break;
+      case efn_date:
+        if (args[0]->isString()) {
+          double value;
+          if (parseIsoDateTime(args[0]->getString(), value))
+            m_value.setNumber(value);
+          else
+            m_value.setNull();
+        } else {
+          m_value.setNumber(args[0]->getNumber());
+        }
+        break;
+      case efn_date_str:
+        m_value.setString(dateToIsoStr(args[0]->getNumber()));
+        break;
+      case efn_datetime_str:
+        m_value.setString(dateTimeToIsoStr(args[0]->getNumber()));
+        break;
+      default: {
+        double numbers[3];
+        for(size_t i=0, epos = m_children.size(); i != epos; i++)
+          numbers[i] = args[i]->getNumber();
+        m_value.setNumber(calcNumber(numbers));
+        break;
+      }
+    }
+    return m_value;
+  }
+
+  virtual bool isNumeric() const {
+    if (m_info.resultKind == erk_args) {
+      // condition of "if" is not a result
+      for(size_t i = (m_info.func == efn_if) ? 1 : 0, epos = m_children.size(); i != epos; i++)
+        if (!m_children[i].isNumeric())
+          return false;
+      return true;
+    }
+    return (m_info.resultKind == erk_number);
+  }
+
+  virtual bool isConstant() const {
+    return (m_info.func != efn_today) && (m_info.func != efn_now) && dnExprNode::isConstant();
+  }
+
+  virtual const double *evalBatch(dnExprContext &context) {
+    if (!isVector())
+      return evalRows(context);
+
+    const size_t count = context.batchCount;
+    const double *args[3] = {DTP_NULL, DTP_NULL, DTP_NULL};
+    prepareBatch();
+    double *out = &m_batch[0];
+
+    if (m_info.func == efn_coalesce) {
+      std::fill(out, out + count, DNEXPR_NAN);
+      for(size_t a=0, epos = m_children.size(); a != epos; a++) {
+        const double *arg = m_children[a].evalBatch(context);
+        for(size_t i=0; i != count; i++)
+          if (isNan(out[i]))
+            out[i] = arg[i];
+      }
+      return out;
+    }
+
+    for(size_t a=0, epos = m_children.size(); a != epos; a++)
+      args[a] = m_children[a].evalBatch(context);
+
+    switch (m_info.func) {
+      case efn_abs:
+        for(size_t i=0; i != count; i++) out[i] = std::fabs(args[0][i]);
+        break;
+      case efn_floor:
+        for(size_t i=0; i != count; i++) out[i] = std::floor(args[0][i]);
+        break;
+      case efn_ceil:
+        for(size_t i=0; i != count; i++) out[i] = std::ceil(args[0][i]);
+        break;
+      case efn_sqrt:
+        for(size_t i=0; i != count; i++) out[i] = std::sqrt(args[0][i]);
+        break;
+      case efn_if:
+        for(size_t i=0; i != count; i++) out[i] = isTrueNumber(args[0][i]) ? args[1][i] : args[2][i];
+        break;
+      case efn_is_null:
+        for(size_t i=0; i != count; i++) out[i] = isNan(args[0][i]) ? 1.0 : 0.0;
+        break;
+      case efn_year:
+      case efn_month:
+      case efn_day:
+      case efn_hour:
+      case efn_minute:
+      case efn_second:
+        for(size_t i=0; i != count; i++) out[i] = datePart(m_info.func, args[0][i]);
+        break;
+      default: {
+        double numbers[3];
+        for(size_t i=0; i != count; i++) {
+          bool isNull = false;
+          for(size_t a=0, epos = m_children.size(); a != epos; a++) {
+            numbers[a] = args[a][i];
+            isNull = isNull || isNan(numbers[a]);
+          }
+          out[i] = isNull ? DNEXPR_NAN : calcNumber(numbers);
+        }
+        break;
+      }
+    }
+    return out;
+  }
+private:
+  /// Returns true if batch can be calculated from batches of arguments
+  bool isVector() const {
+    switch (m_info.func) {
+      case efn_abs: case efn_round: case efn_floor: case efn_ceil: case efn_sqrt: case efn_pow:
+      case efn_min: case efn_max: case efn_if: case efn_coalesce: case efn_is_null:
+      case efn_year: case efn_month: case efn_day: case efn_hour: case efn_minute: case efn_second:
+        return childrenNumeric();
+      default:
+        return false;
+    }
+  }
+
+  /// Calculates numeric function for non-null arguments
+  double calcNumber(const double *args) const {
+    switch (m_info.func) {
+      case efn_abs: return std::fabs(args[0]);
+      case efn_round: return roundTo(args[0], (m_children.size() > 1) ? args[1] : 0.0);
+      case efn_floor: return std::floor(args[0]);
+      case efn_ceil: return std::ceil(args[0]);
+      case efn_sqrt: return std::sqrt(args[0]);
+      case efn_pow: return std::pow(args[0], args[1]);
+      case efn_min: return (args[1] < args[0]) ? args[1] : args[0];
+      case efn_max: return (args[1] > args[0]) ? args[1] : args[0];
+      default: return datePart(m_info.func, args[0]);
+    }
+  }
+private:
+  const dnExprFuncInfo &m_info;
+};
+
+// ----------------------------------------------------------------------------
+// dnExprLexer
+// ----------------------------------------------------------------------------
+enum dnExprTokenType {
+  ett_end,
+  ett_number,
+  ett_string,
+  ett_name,
+  ett_quoted_name,
+  ett_operator,
+  ett_open,
+  ett_close,
+  ett_comma,
+  ett_dot
+};
+
+struct dnExprToken {
+  dnExprTokenType type;
+  dtpString text;
+  double number;
+  size_t pos;
+};
+
+class dnExprLexer {
+public:
+  dnExprLexer(const dtpString &source): m_source(source), m_pos(0) { next(); }
+
+  const dnExprToken &peek() const { return m_token; }
+
+  bool isOperator(const char *text) const {
+    return (m_token.type == ett_operator) && (m_token.text == text);
+  }
+
+  /// Returns true if token is a given keyword (case-insensitive)
+  bool isKeyword(const char *text) const {
+    if (m_token.type != ett_name)
+      return false;
+    dtpString lowerText(m_token.text);
+    for(size_t i=0, epos = lowerText.length(); i != epos; i++)
+      lowerText[i] = static_cast<char>(tolower(static_cast<unsigned char>(lowerText[i])));
+    return (lowerText == text);
+  }
+
+  void error(const dtpString &msg) const {
+    throw dnExprError(msg + " at position " + toString(static_cast<uint>(m_token.pos)) + " in: " + m_source);
+  }
+
+  void next() {
+    while ((m_pos < m_source.length()) && isspace(static_cast<unsigned char>(m_source[m_pos])))
+      m_pos++;
+
+    m_token.pos = m_pos;
+    m_token.text.clear();
+
+    if (m_pos >= m_source.length()) {
+      m_token.type = ett_end;
+      return;
+    }
+
+    const char c = m_source[m_pos];
+
+    if (isdigit(static_cast<unsigned char>(c))) {
+      const char *start = m_source.c_str() + m_pos;
+      char *end;
+      m_token.type = ett_number;
+      m_token.number = strtod(start, &end);
+      m_pos += static_cast<size_t>(end - start);
+      return;
+    }
+
+    if (isalpha(static_cast<unsigned char>(c)) || (c == '_')) {
+      size_t start = m_pos;
+      while ((m_pos < m_source.length()) &&
+        (isalnum(static_cast<unsigned char>(m_source[m_pos])) || (m_source[m_pos] == '_')))
+        m_pos++;
+      m_token.type = ett_name;
+      m_token.text = m_source.substr(start, m_pos - start);
+      return;
+    }
+
+    if ((c == '\'') || (c == '"')) {
+      m_token.type = ett_string;
+      m_pos++;
+      while ((m_pos < m_source.length()) && (m_source[m_pos] != c)) {
+        char ch = m_source[m_pos++];
+        if ((ch == '\\') && (m_pos < m_source.length())) {
+          ch = m_source[m_pos++];
+          if (ch == 'n')
+            ch = '\n';
+          else if (ch == 't')
+            ch = '\t';
+        }
+        m_token.text += ch;
+      }
+      if (m_pos >= m_source.length())
+        error("Unterminated string");
+      m_pos++;
+      return;
+    }
+
+    if (c == '[') {
+      size_t end = m_source.find(']', m_pos);
+      if (end == dtpString::npos)
+        error("Unterminated name");
+      m_token.type = ett_quoted_name;
+      m_token.text = m_source.substr(m_pos + 1, end - m_pos - 1);
+      m_pos = end + 1;
+      return;
+    }
+
+    m_pos++;
+    switch (c) {
+      case '(': m_token.type = ett_open; return;
+      case ')': m_token.type = ett_close; return;
+      case ',': m_token.type = ett_comma; return;
+      case '.': m_token.type = ett_dot; return;
+      default: break;
+    }
+
+    static const char *const twoCharOps[] = {"==", "!=", "<>", "<=", ">=", "&&", "||"};
+    if (m_pos < m_source.length())
+      for(size_t i=0; i != sizeof(twoCharOps) / sizeof(twoCharOps[0]); i++)
+        if ((c == twoCharOps[i][0]) && (m_source[m_pos] == twoCharOps[i][1])) {
+          m_token.type = ett_operator;
+          m_token.text = twoCharOps[i];
+          m_pos++;
+          return;
+        }
+
+    if (dtpString("+-*/%=<>!").find(c) == dtpString::npos)
+      error(dtpString("Unexpected character '") + c + "'");
+
+    m_token.type = ett_operator;
+    m_token.text = c;
+  }
+private:
+  const dtpString &m_source;
+  size_t m_pos;
+  dnExprToken m_token;
+};
+
+// ----------------------------------------------------------------------------
+// dnExprParser
+// ----------------------------------------------------------------------------
+/// Recursive descent parser, builds node tree and list of fields
+class dnExprParser {
+public:
+  typedef DTP_UNIQUE_PTR(dnExprNode) NodeGuard;
+
+  dnExprParser(const dtpString &source, std::vector<dtpString> &paths): m_lexer(source), m_paths(paths) {}
+
+  dnExprNode *parse() {
+    NodeGuard res(parseOr());
+    if (m_lexer.peek().type != ett_end)
+      m_lexer.error("Unexpected token");
+    return res.release();
+  }
+private:
+  dnExprNode *parseOr() {
+    NodeGuard res(parseAnd());
+    while (m_lexer.isKeyword("or") || m_lexer.isOperator("||")) {
+      m_lexer.next();
+      NodeGuard right(parseAnd());
+      res.reset(fold(new dnExprLogic(false, res.release(), right.release())));
+    }
+    return res.release();
+  }
+
+  dnExprNode *parseAnd() {
+    NodeGuard res(parseNot());
+    while (m_lexer.isKeyword("and") || m_lexer.isOperator("&&")) {
+      m_lexer.next();
+      NodeGuard right(parseNot());
+      res.reset(fold(new dnExprLogic(true, res.release(), right.release())));
+    }
+    return res.release();
+  }
+
+  dnExprNode *parseNot() {
+    if (m_lexer.isKeyword("not") || m_lexer.isOperator("!")) {
+      m_lexer.next();
+      return fold(new dnExprUnary(euo_not, parseNot()));
+    }
+    return parseCompare();
+  }
+
+  dnExprNode *parseCompare() {
+    NodeGuard res(parseAdditive());
+    static const char *const ops[] = {"=", "==", "!=", "<>", "<", "<=", ">", ">="};
+    static const dnExprBinaryOp codes[] = {ebo_eq, ebo_eq, ebo_ne, ebo_ne, ebo_lt, ebo_le, ebo_gt, ebo_ge};
+    for(size_t i=0; i != sizeof(ops) / sizeof(ops[0]); i++)
+      if (m_lexer.isOperator(ops[i])) {
+        m_lexer.next();
+        NodeGuard right(parseAdditive());
+        return fold(new dnExprBinary(codes[i], res.release(), right.release()));
+      }
+    return res.release();
+  }
+
+  dnExprNode *parseAdditive() {
+    NodeGuard res(parseMultiplicative());
+    while (m_lexer.isOperator("+") || m_lexer.isOperator("-")) {
+      dnExprBinaryOp op = m_lexer.isOperator("+") ? ebo_add : ebo_sub;
+      m_lexer.next();
+      NodeGuard right(parseMultiplicative());
+      res.reset(fold(new dnExprBinary(op, res.release(), right.release())));
+    }
+    return res.release();
+  }
+
+  dnExprNode *parseMultiplicative() {
+    NodeGuard res(parseUnary());
+    while (m_lexer.isOperator("*") || m_lexer.isOperator("/") || m_lexer.isOperator("%")) {
+      dnExprBinaryOp op = m_lexer.isOperator("*") ? ebo_mul : (m_lexer.isOperator("/") ? ebo_div : ebo_mod);
+      m_lexer.next();
+      NodeGuard right(parseUnary());
+      res.reset(fold(new dnExprBinary(op, res.release(), right.release())));
+    }
+    return res.release();
+  }
+
+  dnExprNode *parseUnary() {
+    if (m_lexer.isOperator("-")) {
+      m_lexer.next();
+      return fold(new dnExprUnary(euo_neg, parseUnary()));
+    }
+    if (m_lexer.isOperator("+")) {
+      m_lexer.next();
+      return parseUnary();
+    }
+    return parsePrimary();
+  }
+
+  dnExprNode *parsePrimary() {
+    const dnExprToken &token = m_lexer.peek();
+    dnExprValue value;
+
+    switch (token.type) {
+      case ett_number:
+        value.setNumber(token.number);
+        m_lexer.next();
+        return new dnExprLiteral(value);
+      case ett_string:
+        value.setString(token.text);
+        m_lexer.next();
+        return new dnExprLiteral(value);
+      case ett_open: {
+        m_lexer.next();
+        NodeGuard res(parseOr());
+        expect(ett_close, "')' expected");
+        return res.release();
+      }
+      case ett_name:
+        if (m_lexer.isKeyword("true") || m_lexer.isKeyword("false")) {
+          value.setBool(m_lexer.isKeyword("true"));
+          m_lexer.next();
+          return new dnExprLiteral(value);
+        }
+        if (m_lexer.isKeyword("null")) {
+          m_lexer.next();
+          return new dnExprLiteral(value);
+        }
+        return parseName();
+      case ett_quoted_name:
+        return parseName();
+      default:
+        m_lexer.error("Value expected");
+        return DTP_NULL;
+    }
+  }
+
+  /// Parses function call or field path
+  dnExprNode *parseName() {
+    const bool quoted = (m_lexer.peek().type == ett_quoted_name);
+    dtpString path = m_lexer.peek().text;
+    m_lexer.next();
+
+    if (!quoted && (m_lexer.peek().type == ett_open))
+      return parseFunction(path);
+
+    while (m_lexer.peek().type == ett_dot) {
+      m_lexer.next();
+      if ((m_lexer.peek().type != ett_name) && (m_lexer.peek().type != ett_quoted_name))
+        m_lexer.error("Field name expected");
+      path += DNTABLE_PATH_SEPARATOR;
+      path += m_lexer.peek().text;
+      m_lexer.next();
+    }
+
+    if (path.empty())
+      m_lexer.error("Empty field name");
+
+    return new dnExprField(addField(path), path);
+  }
+
+  dnExprNode *parseFunction(const dtpString &name) {
+    dtpString lowerName(name);
+    for(size_t i=0, epos = lowerName.length(); i != epos; i++)
+      lowerName[i] = static_cast<char>(tolower(static_cast<unsigned char>(lowerName[i])));
+
+    const dnExprFuncInfo *info = findFunction(lowerName);
+    if (info == DTP_NULL)
+      m_lexer.error("Unknown function: " + name);
+
+    NodeGuard res(new dnExprFunction(*info));
+    uint argCount = 0;
+
+    m_lexer.next();
+    if (m_lexer.peek().type != ett_close) {
+      for(;;) {
+        res->addChild(parseOr());
+        argCount++;
+        if (m_lexer.peek().type != ett_comma)
+          break;
+        m_lexer.next();
+      }
+    }
+    expect(ett_close, "')' expected");
+
+    if ((argCount < info->minArgs) || (argCount > info->maxArgs))
+      throw dnExprError("Wrong number of arguments for " + lowerName + ": " + toString(argCount));
+
+    return fold(res.release());
+  }
+
+  void expect(dnExprTokenType type, const char *msg) {
+    if (m_lexer.peek().type != type)
+      m_lexer.error(msg);
+    m_lexer.next();
+  }
+
+  /// Returns number of field, adds it if not found
+  uint addField(const dtpString &path) {
+    std::vector<dtpString>::const_iterator it = std::find(m_paths.begin(), m_paths.end(), path);
+    if (it != m_paths.end())
+      return static_cast<uint>(it - m_paths.begin());
+    m_paths.push_back(path);
+    return static_cast<uint>(m_paths.size() - 1);
+  }
+
+  /// Replaces constant node by its value
+  dnExprNode *fold(dnExprNode *node) {
+    NodeGuard guard(node);
+    if (!node->isConstant())
+      return guard.release();
+    dnExprContext context;
+    return new dnExprLiteral(node->eval(context));
+  }
+private:
+  dnExprLexer m_lexer;
+  std::vector<dtpString> &m_paths;
+};
+
+// ----------------------------------------------------------------------------
+// table operations
+// ----------------------------------------------------------------------------
+/// Copies a given rows of table to output, columns keep container types
+void copyTableRows(const dnode &table, const std::vector<size_type> &rows, dnode &output)
+{
+  dnTableReader reader(table);
+  dnode result, helper, itemHelper;
+
+  if (reader.isColumnar()) {
+    dtpString name;
+    result.setAsParent();
+    for(size_type c=0, epos = table.size(); c != epos; c++) {
+      const dnode &column = table.getNode(c, helper);
+      DTP_UNIQUE_PTR(dnode) newColumn(column.isArray() ? new dnode(ict_array, column.getElementType()) : new dnode(ict_list));
+      for(std::vector<size_type>::const_iterator it = rows.begin(), rpos = rows.end(); it != rpos; ++it)
+        if (newColumn->isArray())
+          newColumn->addItem(column.getNode(*it, itemHelper));
+        else
+          newColumn->addChild(new dnode(column.getNode(*it, itemHelper)));
+      table.getElementName(c, name);
+      result.addChild(name, newColumn.release());
+    }
+  } else {
+    result.setAsList();
+    for(std::vector<size_type>::const_iterator it = rows.begin(), epos = rows.end(); it != epos; ++it)
+      result.addChild(new dnode(table.getNode(*it, helper)));
+  }
+
+  output.swap(result);
+}
+
+/// Order of key values: nulls, numbers, strings
+int compareKeys(const dnExprValue &a, const dnExprValue &b)
+{
+  const int rankA = a.isNull() ? 0 : (a.isString() ? 2 : 1);
+  const int rankB = b.isNull() ? 0 : (b.isString() ? 2 : 1);
+  if (rankA != rankB)
+    return (rankA < rankB) ? -1 : 1;
+  if (rankA == 1)
+    return compareNumbers(a.getNumber(), b.getNumber());
+  if (rankA == 2)
+    return a.getString().compare(b.getString());
+  return 0;
+}
+
+struct dnExprKeyLess {
+  const std::vector<dnExprValue> &keys;
+  bool ascending;
+
+  dnExprKeyLess(const std::vector<dnExprValue> &aKeys, bool aAscending): keys(aKeys), ascending(aAscending) {}
+
+  bool operator()(size_type a, size_type b) const {
+    int cmp = compareKeys(keys[a], keys[b]);
+    return ascending ? (cmp < 0) : (cmp > 0);
+  }
+};
+
+struct dnExprNumberKeyLess {
+  const std::vector<double> &keys;
+  bool ascending;
+
+  dnExprNumberKeyLess(const std::vector<double> &aKeys, bool aAscending): keys(aKeys), ascending(aAscending) {}
+
+  bool operator()(size_type a, size_type b) const {
+    const double ka = keys[a], kb = keys[b];
+    // NaN (null) goes first
+    int cmp = isNan(ka) ? (isNan(kb) ? 0 : -1) : (isNan(kb) ? 1 : compareNumbers(ka, kb));
+    return ascending ? (cmp < 0) : (cmp > 0);
+  }
+};
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// dnExpression
+// ----------------------------------------------------------------------------
+struct dnExpression::Impl {
+  dtpString source;
+  DTP_UNIQUE_PTR(dnExprNode) root;
+  std::vector<dtpString> paths;
+  DTP_UNIQUE_PTR(dnTableReader) reader;
+};
+
+dnExpression::dnExpression(): m_impl(new Impl())
+{
+}
+
+dnExpression::dnExpression(const dtpString &source): m_impl(new Impl())
+{
+  DTP_UNIQUE_PTR(Impl) guard(m_impl);
+  compile(source);
+  guard.release();
+}
+
+dnExpression::dnExpression(const dnExpression &src): m_impl(new Impl())
+{
+  DTP_UNIQUE_PTR(Impl) guard(m_impl);
+  if (src.isCompiled())
+    compile(src.getSource());
+  guard.release();
+}
+
+dnExpression &dnExpression::operator=(const dnExpression &src)
+{
+  if (this != &src) {
+    if (src.isCompiled()) {
+      compile(src.getSource());
+    } else {
+      delete m_impl;
+      m_impl = new Impl();
+    }
+  }
+  return *this;
+}
+
+dnExpression::~dnExpression()
+{
+  delete m_impl;
+}
+
+void dnExpression::compile(const dtpString &source)
+{
+  std::vector<dtpString> paths;
+  dnExprParser parser(source, paths);
+  DTP_UNIQUE_PTR(dnExprNode) root(parser.parse());
+
+  unbindTable();
+  m_impl->source = source;
+  m_impl->paths.swap(paths);
+  m_impl->root.reset(root.release());
+}
+
+bool dnExpression::isCompiled() const
+{
+  return (m_impl->root.get() != DTP_NULL);
+}
+
+const dtpString &dnExpression::getSource() const
+{
+  return m_impl->source;
+}
+
+const std::vector<dtpString> &dnExpression::getFieldPaths() const
+{
+  return m_impl->paths;
+}
+
+void dnExpression::checkCompiled() const
+{
+  if (!isCompiled())
+    throw dnExprError("Expression not compiled");
+}
+
+void dnExpression::checkBound() const
+{
+  checkCompiled();
+  if (!isBound())
+    throw dnExprError("Expression not bound to table");
+}
+
+const dnExprValue &dnExpression::evaluate(const dnode &row)
+{
+  checkCompiled();
+  dnExprContext context;
+  context.row = &row;
+  return m_impl->root->eval(context);
+}
+
+bool dnExpression::test(const dnode &row)
+{
+  return evaluate(row).isTrue();
+}
+
+void dnExpression::bindTable(const dnode &table)
+{
+  checkCompiled();
+  DTP_UNIQUE_PTR(dnTableReader) reader(new dnTableReader(table));
+  for(std::vector<dtpString>::const_iterator it = m_impl->paths.begin(), epos = m_impl->paths.end(); it != epos; ++it)
+    reader->addField(*it);
+
+  m_impl->reader.reset(reader.release());
+  m_impl->root->bind(m_impl->reader.get());
+}
+
+void dnExpression::unbindTable()
+{
+  if (m_impl->root.get() != DTP_NULL)
+    m_impl->root->bind(DTP_NULL);
+  m_impl->reader.reset();
+}
+
+bool dnExpression::isBound() const
+{
+  return (m_impl->reader.get() != DTP_NULL);
+}
+
+dnExpression::size_type dnExpression::getRowCount() const
+{
+  checkBound();
+  return m_impl->reader->rowCount();
+}
+
+bool dnExpression::isNumeric() const
+{
+  checkCompiled();
+  return m_impl->root->isNumeric();
+}
+
+const dnExprValue &dnExpression::evaluateRow(size_type row)
+{
+  checkBound();
+  if (row >= m_impl->reader->rowCount())
+    throw dnError("Index out of range: " + toString(row));
+
+  dnExprContext context;
+  context.reader = m_impl->reader.get();
+  context.rowIndex = row;
+  return m_impl->root->eval(context);
+}
+
+bool dnExpression::testRow(size_type row)
+{
+  return evaluateRow(row).isTrue();
+}
+
+void dnExpression::evaluateBatch(size_type first, size_type count, double *output)
+{
+  checkBound();
+  if ((first > m_impl->reader->rowCount()) || (count > m_impl->reader->rowCount() - first))
+    throw dnError("Index out of range: " + toString(first + count));
+
+  dnExprContext context;
+  context.reader = m_impl->reader.get();
+
+  for(size_type done = 0; done < count; done += context.batchCount) {
+    context.batchFirst = first + done;
+    context.batchCount = std::min<size_type>(count - done, DNEXPR_BATCH_SIZE);
+    const double *res = m_impl->root->evalBatch(context);
+    std::copy(res, res + context.batchCount, output + done);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// expr_filter
+// ----------------------------------------------------------------------------
+void dtp::expr_filter(const dnode &table, const dtpString &predicate, dnode &output)
+{
+  dnExpression expr(predicate);
+  expr.bindTable(table);
+
+  const size_type rowCount = expr.getRowCount();
+  std::vector<size_type> rows;
+
+  if (expr.isNumeric()) {
+    std::vector<double> values(DNEXPR_BATCH_SIZE);
+    for(size_type first = 0; first < rowCount; first += DNEXPR_BATCH_SIZE) {
+      const size_type count = std::min<size_type>(rowCount - first, DNEXPR_BATCH_SIZE);
+      expr.evaluateBatch(first, count, &values[0]);
+      for(size_type i=0; i != count; i++)
+        if (isTrueNumber(values[i]))
+          rows.push_back(first + i);
+    }
+  } else {
+    for(size_type row = 0; row != rowCount; row++)
+      if (expr.testRow(row))
+        rows.push_back(row);
+  }
+
+  copyTableRows(table, rows, output);
+}
+
+// ----------------------------------------------------------------------------
+// expr_project
+// ----------------------------------------------------------------------------
+void dtp::expr_project(const dnode &table, const std::vector<dnExprColumn> &columns, dnode &output)
+{
+  boost::ptr_vector<dnExpression> exprs;
+  for(std::vector<dnExprColumn>::const_iterator it = columns.begin(), epos = columns.end(); it != epos; ++it) {
+    for(std::vector<dnExprColumn>::const_iterator prev = columns.begin(); prev != it; ++prev)
+      if (prev->name == it->name)
+        throw dnError("Duplicate output column: " + it->name);
+    exprs.push_back(new dnExpression(it->expression));
+    exprs.back().bindTable(table);
+  }
+
+  dnTableReader reader(table);
+  const size_type rowCount = reader.rowCount();
+  dnode result, value;
+
+  if (reader.isColumnar()) {
+    result.setAsParent();
+    std::vector<double> values(DNEXPR_BATCH_SIZE);
+    for(size_t c=0, epos = columns.size(); c != epos; c++) {
+      dnExpression &expr = exprs[c];
+      DTP_UNIQUE_PTR(dnode) column;
+      if (expr.isNumeric()) {
+        column.reset(new dnode(ict_array, vt_double));
+        for(size_type first = 0; first < rowCount; first += DNEXPR_BATCH_SIZE) {
+          const size_type count = std::min<size_type>(rowCount - first, DNEXPR_BATCH_SIZE);
+          expr.evaluateBatch(first, count, &values[0]);
+          for(size_type i=0; i != count; i++)
+            column->addItem(values[i]);
+        }
+      } else {
+        column.reset(new dnode(ict_list));
+        for(size_type row = 0; row != rowCount; row++) {
+          expr.evaluateRow(row).getAsNode(value);
+          column->addChild(new dnode(value));
+        }
+      }
+      result.addChild(columns[c].name, column.release());
+    }
+  } else {
+    result.setAsList();
+    for(size_type row = 0; row != rowCount; row++) {
+      DTP_UNIQUE_PTR(dnode) item(new dnode(ict_parent));
+      for(size_t c=0, epos = columns.size(); c != epos; c++) {
+        DTP_UNIQUE_PTR(dnode) field(new dnode());
+        exprs[c].evaluateRow(row).getAsNode(*field);
+        item->addChild(columns[c].name, field.release());
+      }
+      result.addChild(item.release());
+    }
+  }
+
+  output.swap(result);
+}
+
+// ----------------------------------------------------------------------------
+// expr_sort
+// ----------------------------------------------------------------------------
+void dtp::expr_sort(const dnode &table, const dtpString &key, bool ascending, dnode &output)
+{
+  dnExpression expr(key);
+  expr.bindTable(table);
+
+  const size_type rowCount = expr.getRowCount();
+  std::vector<size_type> order(rowCount);
+  for(size_type i=0; i != rowCount; i++)
+    order[i] = i;
+
+  if (expr.isNumeric()) {
+    std::vector<double> keys(rowCount);
+    if (rowCount > 0)
+      expr.evaluateBatch(0, rowCount, &keys[0]);
+    std::stable_sort(order.begin(), order.end(), dnExprNumberKeyLess(keys, ascending));
+  } else {
+    std::vector<dnExprValue> keys(rowCount);
+    for(size_type i=0; i != rowCount; i++)
+      keys[i] = expr.evaluateRow(i);
+    std::stable_sort(order.begin(), order.end(), dnExprKeyLess(keys, ascending));
+  }
+
+  copyTableRows(table, order, output);
+}
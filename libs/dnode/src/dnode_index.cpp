@@ -0,0 +1,155 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_index.cpp
+// Project:     dtpLib
+// Purpose:     Secondary indexes on child fields of dnode list items
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include "dtp/dnode_index.h"
+
+using namespace dtp;
+
+// ----------------------------------------------------------------------------
+// dnListIndex
+// ----------------------------------------------------------------------------
+dnListIndex::dnListIndex(const dtpString &keyPath): m_keyPath(keyPath)
+{
+  size_t start = 0, end;
+  do {
+    end = keyPath.find(DNINDEX_PATH_SEPARATOR, start);
+    if (end == dtpString::npos)
+      end = keyPath.length();
+    if (end > start)
+      m_path.push_back(keyPath.substr(start, end - start));
+    start = end + 1;
+  } while (end < keyPath.length());
+
+  if (m_path.empty())
+    throw dnError("Empty index key path");
+}
+
+void dnListIndex::rebuild(const dnode &list)
+{
+  clear();
+  dnode helper;
+  for(size_type i=0, epos = list.size(); i != epos; i++)
+    addItem(list.getNode(i, helper), i);
+}
+
+const dnode *dnListIndex::findKey(const dnode &item) const
+{
+  const dnode *current = &item;
+  dnode helper;
+  size_type idx;
+
+  for(std::vector<dtpString>::const_iterator it = m_path.begin(), epos = m_path.end(); it != epos; ++it) {
+    if (!current->isParent())
+      return DTP_NULL;
+    idx = current->indexOfName(*it);
+    if (idx == dnode::npos)
+      return DTP_NULL;
+    // children of parent are returned by reference, helper is not used
+    current = &(current->getNode(idx, helper));
+  }
+
+  return current;
+}
+
+// ----------------------------------------------------------------------------
+// dnIndexedList
+// ----------------------------------------------------------------------------
+dnIndexedList::dnIndexedList(): m_list(ict_list)
+{
+}
+
+dnIndexedList::dnIndexedList(const dnode &list): m_list(list)
+{
+}
+
+dnIndexedList::~dnIndexedList()
+{
+  for(IndexMap::iterator it = m_indexes.begin(), epos = m_indexes.end(); it != epos; ++it)
+    delete it->second;
+}
+
+void dnIndexedList::setList(const dnode &list)
+{
+  m_list = list;
+  rebuildIndexes();
+}
+
+void dnIndexedList::swapList(dnode &list)
+{
+  m_list.swap(list);
+  rebuildIndexes();
+}
+
+void dnIndexedList::addItem(const dnode &item)
+{
+  const size_type pos = m_list.size();
+  m_list.addChild(new dnode(item));
+  for(IndexMap::iterator it = m_indexes.begin(), epos = m_indexes.end(); it != epos; ++it)
+    it->second->addItem(m_list[pos], pos);
+}
+
+void dnIndexedList::setElement(size_type index, const dnode &item)
+{
+  checkIndex(index);
+  for(IndexMap::iterator it = m_indexes.begin(), epos = m_indexes.end(); it != epos; ++it)
+    it->second->eraseItem(m_list[index], index, false);
+  m_list.setElement(index, item);
+  for(IndexMap::iterator it = m_indexes.begin(), epos = m_indexes.end(); it != epos; ++it)
+    it->second->addItem(m_list[index], index);
+}
+
+void dnIndexedList::eraseElement(size_type index)
+{
+  checkIndex(index);
+  for(IndexMap::iterator it = m_indexes.begin(), epos = m_indexes.end(); it != epos; ++it)
+    it->second->eraseItem(m_list[index], index, (index + 1 < m_list.size()));
+  m_list.eraseElement(index);
+}
+
+void dnIndexedList::clear()
+{
+  m_list.clear();
+  m_list.setAsList();
+  for(IndexMap::iterator it = m_indexes.begin(), epos = m_indexes.end(); it != epos; ++it)
+    it->second->clear();
+}
+
+dnListIndex &dnIndexedList::addIndex(const dtpString &name, dnListIndex *index)
+{
+  DTP_UNIQUE_PTR(dnListIndex) guard(index);
+  if (hasIndex(name))
+    throw dnError("Index already exists: " + name);
+  index->rebuild(m_list);
+  m_indexes.insert(std::make_pair(name, index));
+  guard.release();
+  return *index;
+}
+
+void dnIndexedList::removeIndex(const dtpString &name)
+{
+  IndexMap::iterator it = m_indexes.find(name);
+  if (it != m_indexes.end()) {
+    delete it->second;
+    m_indexes.erase(it);
+  }
+}
+
+dnListIndex &dnIndexedList::getIndex(const dtpString &name) const
+{
+  IndexMap::const_iterator it = m_indexes.find(name);
+  if (it == m_indexes.end())
+    throw dnError("Index not found: " + name);
+  return *(it->second);
+}
+
+void dnIndexedList::rebuildIndexes()
+{
+  for(IndexMap::iterator it = m_indexes.begin(), epos = m_indexes.end(); it != epos; ++it)
+    it->second->rebuild(m_list);
+}
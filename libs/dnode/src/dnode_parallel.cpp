@@ -0,0 +1,552 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_parallel.cpp
+// Project:     dtpLib
+// Purpose:     Parallel deep copy & compare for large dnode trees
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <new>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include "dtp/dnode_parallel.h"
+
+using namespace dtp;
+using namespace Details;
+
+// ----------------------------------------------------------------------------
+// dnThreadPoolImpl
+// ----------------------------------------------------------------------------
+namespace dtp {
+namespace Details {
+
+/// Tasks passed to a single execute() call
+struct dnThreadPoolBatch {
+  dnParallelTask **tasks;
+  size_t count;
+  size_t next;
+  size_t done;
+  bool failed;
+  bool outOfMemory;
+  dtpString errorMessage;
+
+  dnThreadPoolBatch(dnParallelTask **aTasks, size_t aCount):
+    tasks(aTasks), count(aCount), next(0), done(0), failed(false), outOfMemory(false) {}
+};
+
+class dnThreadPoolImpl {
+public:
+  dnThreadPoolImpl(uint threadCount);
+  ~dnThreadPoolImpl();
+
+  uint getConcurrency() const { return m_threadCount + 1; }
+  void execute(dnParallelTask **tasks, size_t count);
+protected:
+  void workerLoop();
+  dnParallelTask *claim(dnThreadPoolBatch &batch);
+  void runTask(dnThreadPoolBatch &batch, dnParallelTask *task, boost::unique_lock<boost::mutex> &lock);
+private:
+  uint m_threadCount;
+  bool m_stopping;
+  boost::mutex m_mutex;
+  boost::condition_variable m_workCond;
+  boost::condition_variable m_doneCond;
+  std::deque<dnThreadPoolBatch *> m_batches;
+  boost::thread_group m_threads;
+};
+
+} // namespace Details
+} // namespace dtp
+
+dnThreadPoolImpl::dnThreadPoolImpl(uint threadCount): m_threadCount(threadCount), m_stopping(false)
+{
+  for(uint i=0; i != threadCount; i++)
+    m_threads.create_thread(boost::bind(&dnThreadPoolImpl::workerLoop, this));
+}
+
+dnThreadPoolImpl::~dnThreadPoolImpl()
+{
+  {
+    boost::lock_guard<boost::mutex> guard(m_mutex);
+    m_stopping = true;
+  }
+  m_workCond.notify_all();
+  m_threads.join_all();
+}
+
+dnParallelTask *dnThreadPoolImpl::claim(dnThreadPoolBatch &batch)
+{
+  dnParallelTask *res = batch.tasks[batch.next++];
+  if (batch.next == batch.count)
+    m_batches.erase(std::find(m_batches.begin(), m_batches.end(), &batch));
+  return res;
+}
+
+void dnThreadPoolImpl::runTask(dnThreadPoolBatch &batch, dnParallelTask *task, boost::unique_lock<boost::mutex> &lock)
+{
+  if (!batch.failed) {
+    bool outOfMemory = false;
+    bool failed = true;
+    dtpString errorMessage;
+
+    lock.unlock();
+    try {
+      task->run();
+      failed = false;
+    }
+    catch(std::bad_alloc &) {
+      outOfMemory = true;
+    }
+    catch(std::exception &e) {
+      errorMessage = e.what();
+    }
+    catch(...) {
+      errorMessage = "Unknown error in parallel task";
+    }
+    lock.lock();
+
+    if (failed && !batch.failed) {
+      batch.failed = true;
+      batch.outOfMemory = outOfMemory;
+      batch.errorMessage = errorMessage;
+    }
+  }
+
+  batch.done++;
+  if (batch.done == batch.count)
+    m_doneCond.notify_all();
+}
+
+void dnThreadPoolImpl::workerLoop()
+{
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  for(;;) {
+    while (!m_stopping && m_batches.empty())
+      m_workCond.wait(lock);
+
+    if (m_stopping)
+      break;
+
+    dnThreadPoolBatch &batch = *m_batches.front();
+    runTask(batch, claim(batch), lock);
+  }
+}
+
+void dnThreadPoolImpl::execute(dnParallelTask **tasks, size_t count)
+{
+  if (count == 0)
+    return;
+
+  dnThreadPoolBatch batch(tasks, count);
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+
+  if ((m_threadCount > 0) && (count > 1)) {
+    m_batches.push_back(&batch);
+    m_workCond.notify_all();
+  } else {
+    batch.next = count;
+    for(size_t i=0; i != count; i++)
+      runTask(batch, tasks[i], lock);
+  }
+
+  // calling thread helps with its own batch, then waits for tasks taken by workers
+  while (batch.next < batch.count)
+    runTask(batch, claim(batch), lock);
+
+  while (batch.done < batch.count)
+    m_doneCond.wait(lock);
+
+  if (batch.failed) {
+    if (batch.outOfMemory)
+      throw std::bad_alloc();
+    throw dnError(batch.errorMessage);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// dnThreadPool
+// ----------------------------------------------------------------------------
+namespace {
+
+uint defaultWorkerCount()
+{
+  uint cores = boost::thread::hardware_concurrency();
+  return (cores > 1) ? (cores - 1) : 0;
+}
+
+boost::once_flag defaultPoolFlag = BOOST_ONCE_INIT;
+DTP_UNIQUE_PTR(dnThreadPool) defaultPool;
+
+void initDefaultPool()
+{
+  defaultPool.reset(new dnThreadPool());
+}
+
+} // namespace
+
+dnThreadPool::dnThreadPool(uint threadCount)
+{
+  m_impl = new dnThreadPoolImpl((threadCount > 0) ? threadCount : defaultWorkerCount());
+}
+
+dnThreadPool::~dnThreadPool()
+{
+  delete m_impl;
+}
+
+uint dnThreadPool::getConcurrency() const
+{
+  return m_impl->getConcurrency();
+}
+
+void dnThreadPool::execute(dnParallelTask **tasks, size_t count)
+{
+  m_impl->execute(tasks, count);
+}
+
+dnThreadPool &dnThreadPool::getDefault()
+{
+  boost::call_once(defaultPoolFlag, initDefaultPool);
+  return *defaultPool;
+}
+
+// ----------------------------------------------------------------------------
+// copy
+// ----------------------------------------------------------------------------
+namespace {
+
+typedef dnode::size_type size_type;
+
+const uint DPAR_TASKS_PER_THREAD = 4;
+
+dnThreadPool &getPool(const dnParallelOptions &options)
+{
+  return (options.pool != DTP_NULL) ? *options.pool : dnThreadPool::getDefault();
+}
+
+bool useParallel(size_type itemCount, const dnParallelOptions &options)
+{
+  return (itemCount >= options.minParallelItems) && (itemCount > 1) && (getPool(options).getConcurrency() > 1);
+}
+
+size_type calcTaskCount(size_type itemCount, dnThreadPool &pool)
+{
+  return std::min<size_type>(itemCount, pool.getConcurrency() * DPAR_TASKS_PER_THREAD);
+}
+
+inline size_type rangeStart(size_type itemCount, size_type taskCount, size_type taskNo)
+{
+  return static_cast<size_type>(static_cast<uint64>(itemCount) * taskNo / taskCount);
+}
+
+/// Executes RangeTask(first, last, arg) for ranges covering [0, itemCount)
+template<typename RangeTask, typename Arg>
+void executeRanges(dnThreadPool &pool, size_type itemCount, Arg &arg)
+{
+  size_type taskCount = calcTaskCount(itemCount, pool);
+  boost::ptr_vector<RangeTask> tasks;
+  std::vector<dnParallelTask *> taskPtrs;
+
+  tasks.reserve(taskCount);
+  taskPtrs.reserve(taskCount);
+
+  for(size_type i=0; i != taskCount; i++) {
+    tasks.push_back(new RangeTask(rangeStart(itemCount, taskCount, i), rangeStart(itemCount, taskCount, i + 1), arg));
+    taskPtrs.push_back(&tasks.back());
+  }
+
+  pool.execute(&taskPtrs[0], taskPtrs.size());
+}
+
+/// Clones of source children, deleted unless released
+class dnCloneBuffer {
+public:
+  dnCloneBuffer(const dnChildColnBase &source): m_source(source), m_items(source.size(), DTP_NULL) {}
+  ~dnCloneBuffer() {
+    for(std::vector<dnode *>::iterator it = m_items.begin(), epos = m_items.end(); it != epos; ++it)
+      delete *it;
+  }
+
+  const dnChildColnBase &getSource() const { return m_source; }
+  void set(size_type index, dnode *node) { m_items[index] = node; }
+  dnode *release(size_type index) {
+    dnode *res = m_items[index];
+    m_items[index] = DTP_NULL;
+    return res;
+  }
+private:
+  const dnChildColnBase &m_source;
+  std::vector<dnode *> m_items;
+};
+
+class dnCloneRangeTask: public dnParallelTask {
+public:
+  dnCloneRangeTask(size_type first, size_type last, dnCloneBuffer &output):
+    m_first(first), m_last(last), m_output(output) {}
+
+  virtual void run() {
+    const dnChildColnBase &source = m_output.getSource();
+    for(size_type i = m_first; i != m_last; i++)
+      m_output.set(i, new dnode(source.at(i)));
+  }
+private:
+  size_type m_first;
+  size_type m_last;
+  dnCloneBuffer &m_output;
+};
+
+void cloneChildren(dnCloneBuffer &output, const dnParallelOptions &options)
+{
+  executeRanges<dnCloneRangeTask>(getPool(options), output.getSource().size(), output);
+}
+
+void prepareContainer(dnode &output, const dnode &input)
+{
+  output.clear();
+  if (input.isList())
+    output.setAsList();
+  else
+    output.setAsParent();
+}
+
+/// Inserts child into output as dnChildColnBase::copyItemsFrom does
+void insertCopy(dnChildColnBase &output, const dnode &input, size_type index, dnode *child, dtpString &nameBuffer)
+{
+  if (input.isList()) {
+    output.insert(child);
+  } else {
+    input.getElementName(index, nameBuffer);
+    if (nameBuffer.empty())
+      nameBuffer = toString(static_cast<int>(index));
+    output.insert(nameBuffer, child);
+  }
+}
+
+void copyNode(dnode &output, const dnode &input, const dnParallelOptions &options, uint depth)
+{
+  if (!input.isParent()) {
+    output.copyFrom(input);
+    return;
+  }
+
+  const dnChildColnBase &source = input.getChildrenR();
+  size_type cnt = source.size();
+  dtpString name;
+
+  if (useParallel(cnt, options)) {
+    dnCloneBuffer clones(source);
+    cloneChildren(clones, options);
+    prepareContainer(output, input);
+    dnChildColnBase &target = output.getChildren();
+    for(size_type i=0; i != cnt; i++)
+      insertCopy(target, input, i, clones.release(i), name);
+  } else if (depth < options.maxSplitDepth) {
+    DTP_UNIQUE_PTR(dnode) child;
+    prepareContainer(output, input);
+    dnChildColnBase &target = output.getChildren();
+    for(size_type i=0; i != cnt; i++) {
+      child.reset(new dnode());
+      copyNode(*child, source.at(i), options, depth + 1);
+      insertCopy(target, input, i, child.release(), name);
+    }
+  } else {
+    output.copyFrom(input);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// compare
+// ----------------------------------------------------------------------------
+bool isSameShape(const dnode &lhs, const dnode &rhs)
+{
+  return
+    (lhs.isArray() == rhs.isArray()) &&
+    (lhs.isList() == rhs.isList()) &&
+    (lhs.size() == rhs.size());
+}
+
+/// Buffers reused while comparing items of a single container
+struct dnDeepCompareContext {
+  dnode leftHelper;
+  dnode rightHelper;
+  dtpString leftName;
+  dtpString rightName;
+};
+
+bool deepEqual(const dnode &lhs, const dnode &rhs);
+
+bool itemEqual(const dnode &lhs, const dnode &rhs, size_type index, dnDeepCompareContext &context)
+{
+  if (!lhs.isList() && lhs.isParent()) {
+    lhs.getElementName(index, context.leftName);
+    rhs.getElementName(index, context.rightName);
+    if (context.leftName != context.rightName)
+      return false;
+  }
+
+  return deepEqual(
+    lhs.getNode(index, context.leftHelper),
+    rhs.getNode(index, context.rightHelper)
+  );
+}
+
+bool deepEqual(const dnode &lhs, const dnode &rhs)
+{
+  if (&lhs == &rhs)
+    return true;
+
+  if (!lhs.isContainer() || !rhs.isContainer()) {
+    if (lhs.isContainer() != rhs.isContainer())
+      return false;
+    return lhs.isEqualTo(rhs);
+  }
+
+  if (!isSameShape(lhs, rhs))
+    return false;
+
+  dnDeepCompareContext context;
+  for(size_type i=0, epos = lhs.size(); i != epos; i++)
+    if (!itemEqual(lhs, rhs, i, context))
+      return false;
+
+  return true;
+}
+
+/// Shared state of compare tasks
+class dnParallelCompare {
+public:
+  dnParallelCompare(const dnode &lhs, const dnode &rhs): m_lhs(lhs), m_rhs(rhs), m_different(false) {}
+
+  const dnode &getLeft() const { return m_lhs; }
+  const dnode &getRight() const { return m_rhs; }
+  bool isDifferent() const { return m_different.load(boost::memory_order_relaxed); }
+  void setDifferent() { m_different.store(true, boost::memory_order_relaxed); }
+private:
+  const dnode &m_lhs;
+  const dnode &m_rhs;
+  boost::atomic<bool> m_different;
+};
+
+class dnCompareRangeTask: public dnParallelTask {
+public:
+  dnCompareRangeTask(size_type first, size_type last, dnParallelCompare &state):
+    m_first(first), m_last(last), m_state(state) {}
+
+  virtual void run() {
+    dnDeepCompareContext context;
+    for(size_type i = m_first; i != m_last; i++) {
+      if (m_state.isDifferent())
+        break;
+      if (!itemEqual(m_state.getLeft(), m_state.getRight(), i, context)) {
+        m_state.setDifferent();
+        break;
+      }
+    }
+  }
+private:
+  size_type m_first;
+  size_type m_last;
+  dnParallelCompare &m_state;
+};
+
+bool parallelEqual(const dnode &lhs, const dnode &rhs, const dnParallelOptions &options, uint depth)
+{
+  if ((&lhs == &rhs) || !lhs.isContainer() || !rhs.isContainer())
+    return deepEqual(lhs, rhs);
+
+  if (!isSameShape(lhs, rhs))
+    return false;
+
+  size_type cnt = lhs.size();
+
+  if (useParallel(cnt, options)) {
+    dnParallelCompare state(lhs, rhs);
+    executeRanges<dnCompareRangeTask>(getPool(options), cnt, state);
+    return !state.isDifferent();
+  }
+
+  if (lhs.isArray() || (depth >= options.maxSplitDepth))
+    return deepEqual(lhs, rhs);
+
+  dnDeepCompareContext context;
+  for(size_type i=0; i != cnt; i++) {
+    if (!lhs.isList()) {
+      lhs.getElementName(i, context.leftName);
+      rhs.getElementName(i, context.rightName);
+      if (context.leftName != context.rightName)
+        return false;
+    }
+    if (!parallelEqual(lhs.getNode(i, context.leftHelper), rhs.getNode(i, context.rightHelper), options, depth + 1))
+      return false;
+  }
+
+  return true;
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// Function definitions
+// ----------------------------------------------------------------------------
+void dtp::dpar_copy_from(dnode &output, const dnode &input, const dnParallelOptions &options)
+{
+  if (&output == &input)
+    return;
+  copyNode(output, input, options, 0);
+}
+
+void dtp::dpar_copy_children_from(dnode &output, const dnode &input, const dnParallelOptions &options)
+{
+  size_type cnt = input.isParent() ? input.size() : 0;
+
+  if (!useParallel(cnt, options)) {
+    output.copyChildrenFrom(input);
+    return;
+  }
+
+  dnCloneBuffer clones(input.getChildrenR());
+  cloneChildren(clones, options);
+
+  if (!output.isParent()) {
+    if (input.isList())
+      output.setAsList();
+    else
+      output.setAsParent();
+  }
+
+  if (input.isList()) {
+    for(size_type i=0; i != cnt; i++)
+      output.addChild(clones.release(i));
+  } else {
+    for(size_type i=0; i != cnt; i++)
+      output.addChild(input.getElementName(i), clones.release(i));
+  }
+}
+
+dnode *dtp::dpar_clone_child(const dnode &input, dnPosType index, const dnParallelOptions &options)
+{
+  if (!input.isParent())
+    return input.cloneElement(index);
+
+  DTP_UNIQUE_PTR(dnode) res(new dnode());
+  copyNode(*res, input.getChildrenR().at(index), options, 0);
+  return res.release();
+}
+
+bool dtp::dnode_deep_equal(const dnode &lhs, const dnode &rhs)
+{
+  return deepEqual(lhs, rhs);
+}
+
+bool dtp::dpar_deep_equal(const dnode &lhs, const dnode &rhs, const dnParallelOptions &options)
+{
+  return parallelEqual(lhs, rhs, options, 0);
+}
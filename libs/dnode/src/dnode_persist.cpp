@@ -0,0 +1,1069 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_persist.cpp
+// Project:     dtpLib
+// Purpose:     Persistent data node tree stored in memory-mapped file
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "dtp/dnode_persist.h"
+#include "dtp/details/dnode_view_builder.h"
+
+using namespace dtp;
+using namespace Details;
+
+namespace {
+
+const char DNPERSIST_MAGIC[4] = {'D', 'N', 'P', '1'};
+const uint64 DNPERSIST_MIN_TABLE_CAPACITY = 4;
+
+struct dnPersistCommitSlot {
+  uint64 sequence;
+  dnViewOffset rootOffset;
+  dnViewOffset heapEnd;
+  dnViewOffset freeTableOffset;
+  uint64 freeTableSize;   ///< number of (offset, size) pairs, unused items have zero size
+  uint64 checksum;
+};
+
+struct dnPersistHeader {
+  char magic[4];
+  uint byteOrderMark;
+  uint version;
+  uint xdoubleSize;
+  uint64 reserved;
+  dnPersistCommitSlot slots[2];
+};
+
+inline uint64 dnPersistAlign(uint64 size)
+{
+  return (size + 7) & ~static_cast<uint64>(7);
+}
+
+// FNV-1a of slot without checksum field
+uint64 dnPersistChecksum(const dnPersistCommitSlot &slot)
+{
+  const byte *data = reinterpret_cast<const byte *>(&slot);
+  const size_t size = sizeof(slot) - sizeof(slot.checksum);
+  uint64 res = 14695981039346656037ULL;
+  for(size_t i=0; i < size; i++) {
+    res ^= data[i];
+    res *= 1099511628211ULL;
+  }
+  return res;
+}
+
+inline uint64 dnPersistCapacity(const dnViewRecord &record)
+{
+  return (record.reserved > record.count) ? record.reserved : record.count;
+}
+
+inline bool dnPersistHasNodeTable(const dnViewRecord &record)
+{
+  dnValueType kind = static_cast<dnValueType>(record.kind);
+  return (kind == vt_parent) || ((kind == vt_array) && (record.itemType == vt_datanode));
+}
+
+// splits "a/b/c" into "a/b" and "c"
+void dnPersistSplitPath(const dtpString &path, dtpString &parentPath, dtpString &name)
+{
+  size_t pos = path.find_last_of(DNVIEW_PATH_SEPARATOR);
+  if (pos == dtpString::npos) {
+    parentPath.clear();
+    name = path;
+  } else {
+    parentPath = path.substr(0, pos);
+    name = path.substr(pos + 1);
+  }
+}
+
+bool dnPersistIsIndex(const char *text, size_t len, uint64 &output)
+{
+  if (len == 0)
+    return false;
+  output = 0;
+  for(size_t i=0; i < len; i++) {
+    if ((text[i] < '0') || (text[i] > '9'))
+      return false;
+    output = output * 10 + static_cast<uint64>(text[i] - '0');
+  }
+  return true;
+}
+
+template<typename ValueType>
+void dnPersistPutValue(byte *target, const dnode &value)
+{
+  ValueType item = value.getAs<ValueType>();
+  memcpy(target, &item, sizeof(item));
+}
+
+void dnPersistPutItem(dnValueType itemType, byte *target, const dnode &value)
+{
+  switch (itemType) {
+    case vt_byte: dnPersistPutValue<byte>(target, value); break;
+    case vt_int: dnPersistPutValue<int>(target, value); break;
+    case vt_uint: dnPersistPutValue<uint>(target, value); break;
+    case vt_int64: dnPersistPutValue<int64>(target, value); break;
+    case vt_uint64: dnPersistPutValue<uint64>(target, value); break;
+    case vt_bool: dnPersistPutValue<bool>(target, value); break;
+    case vt_float: dnPersistPutValue<float>(target, value); break;
+    case vt_double:
+    case vt_date:
+    case vt_time:
+    case vt_datetime: dnPersistPutValue<double>(target, value); break;
+    case vt_xdouble: dnPersistPutValue<xdouble>(target, value); break;
+    default:
+      throw dnError("Array type not supported by DNV layout: " + getValueTypeName(itemType));
+  }
+}
+
+// ----------------------------------------------------------------------------
+// dnPersistFreeList
+// ----------------------------------------------------------------------------
+/// Free blocks indexed by offset (for merge of neighbours) and by size (for best fit)
+class dnPersistFreeList {
+public:
+  typedef std::map<dnViewOffset, uint64> OffsetMap;
+  typedef std::multimap<uint64, dnViewOffset> SizeMap;
+
+  dnPersistFreeList(): m_totalSize(0) {}
+
+  void clear() {
+    m_byOffset.clear();
+    m_bySize.clear();
+    m_totalSize = 0;
+  }
+
+  size_t size() const { return m_byOffset.size(); }
+  void swap(dnPersistFreeList &other) {
+    m_byOffset.swap(other.m_byOffset);
+    m_bySize.swap(other.m_bySize);
+    std::swap(m_totalSize, other.m_totalSize);
+  }
+  uint64 totalSize() const { return m_totalSize; }
+  const OffsetMap &blocks() const { return m_byOffset; }
+
+  /// Adds block merged with free neighbours, returns offset & size of resulting block
+  void insert(dnViewOffset offset, uint64 size, dnViewOffset &outOffset, uint64 &outSize) {
+    OffsetMap::iterator next = m_byOffset.lower_bound(offset);
+    if (next != m_byOffset.begin()) {
+      OffsetMap::iterator prev = next;
+      --prev;
+      if (prev->first + prev->second == offset) {
+        offset = prev->first;
+        size += prev->second;
+        erase(prev);
+      }
+    }
+    if ((next != m_byOffset.end()) && (offset + size == next->first)) {
+      size += next->second;
+      erase(next);
+    }
+    m_byOffset.insert(std::make_pair(offset, size));
+    m_bySize.insert(std::make_pair(size, offset));
+    m_totalSize += size;
+    outOffset = offset;
+    outSize = size;
+  }
+
+  /// Removes block at offset
+  void remove(dnViewOffset offset) {
+    OffsetMap::iterator it = m_byOffset.find(offset);
+    if (it != m_byOffset.end())
+      erase(it);
+  }
+
+  /// Takes smallest block not smaller than size, returns false if not found
+  bool take(uint64 size, dnViewOffset &output) {
+    SizeMap::iterator it = m_bySize.lower_bound(size);
+    if (it == m_bySize.end())
+      return false;
+    output = it->second;
+    uint64 restSize = it->first - size;
+    erase(m_byOffset.find(output));
+    if (restSize > 0) {
+      m_byOffset.insert(std::make_pair(output + size, restSize));
+      m_bySize.insert(std::make_pair(restSize, output + size));
+      m_totalSize += restSize;
+    }
+    return true;
+  }
+
+protected:
+  void erase(OffsetMap::iterator it) {
+    SizeMap::iterator sit = m_bySize.lower_bound(it->second);
+    while (sit->second != it->first)
+      ++sit;
+    m_bySize.erase(sit);
+    m_totalSize -= it->second;
+    m_byOffset.erase(it);
+  }
+private:
+  OffsetMap m_byOffset;
+  SizeMap m_bySize;
+  uint64 m_totalSize;
+};
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// dnPersistentStore::Impl
+// ----------------------------------------------------------------------------
+struct dnPersistentStore::Impl {
+  typedef std::vector<std::pair<dnViewOffset, uint64> > BlockList;
+  typedef std::vector<dnViewOffset> OffsetList;
+
+  dtpString fileName;
+  boost::interprocess::file_mapping mapping;
+  boost::interprocess::mapped_region region;
+  byte *base;
+  uint64 fileSize;
+  uint activeSlot;
+  dnPersistCommitSlot committed;
+  dnViewOffset rootOffset;
+  uint64 heapEnd;
+  dnPersistFreeList freeBlocks;
+  BlockList pendingBlocks; ///< released blocks of last commit point
+  std::set<dnViewOffset> freshBlocks; ///< blocks allocated after last commit point
+  bool modified;
+
+  Impl(const dtpString &aFileName):
+    fileName(aFileName),
+    mapping(aFileName.c_str(), boost::interprocess::read_write),
+    region(mapping, boost::interprocess::read_write),
+    base(static_cast<byte *>(region.get_address())),
+    fileSize(region.get_size()),
+    activeSlot(0), rootOffset(0), heapEnd(0), modified(false)
+  {
+    memset(&committed, 0, sizeof(committed));
+  }
+
+  // -- heap interface for dnViewNodeWriter --
+  dnViewOffset alloc(size_t size);
+
+  void put(dnViewOffset offset, const void *data, size_t size) {
+    if (size > 0)
+      memcpy(base + offset, data, size);
+  }
+
+  // -- blocks --
+  byte *ptr(dnViewOffset offset) const { return base + offset; }
+  dnViewRecord *record(dnViewOffset offset) const { return reinterpret_cast<dnViewRecord *>(base + offset); }
+  dnViewRecord readRecord(dnViewOffset offset) const { return dnViewReadRaw<dnViewRecord>(base + offset); }
+  dnViewOffset tableItem(dnViewOffset table, uint64 index) const {
+    return dnViewReadRaw<dnViewOffset>(base + table + index * sizeof(dnViewOffset));
+  }
+  void setTableItem(dnViewOffset table, uint64 index, dnViewOffset value) {
+    memcpy(base + table + index * sizeof(dnViewOffset), &value, sizeof(value));
+  }
+  uint64 stringBlockSize(dnViewOffset offset) const {
+    return sizeof(uint64) + dnViewReadRaw<uint64>(base + offset) + 1;
+  }
+  bool isFresh(dnViewOffset offset) const { return (freshBlocks.find(offset) != freshBlocks.end()); }
+
+  void release(dnViewOffset offset, uint64 size);
+  void addFreeBlock(dnViewOffset offset, uint64 size);
+  void releaseNode(dnViewOffset offset);
+  dnViewOffset writableBlock(dnViewOffset offset, uint64 size, uint64 usedSize, uint64 newSize);
+  dnViewOffset writableRecord(dnViewOffset offset);
+  dnViewOffset writeNode(const dnode &value);
+  dnViewOffset writeString(const dtpString &value);
+  int compareName(dnViewOffset nameOffset, const dtpString &name) const;
+
+  // -- file --
+  void create();
+  void load();
+  void resize(uint64 newSize);
+  void ensureSize(uint64 size);
+  bool isValidSlot(const dnPersistCommitSlot &slot) const;
+  void restoreState();
+  void commit();
+
+  // -- tree --
+  bool resolve(const dtpString &path, OffsetList &chain, OffsetList &indices, uint64 &itemIndex) const;
+  void relink(OffsetList &chain, const OffsetList &indices, size_t level, dnViewOffset newOffset);
+  void setElement(const dtpString &path, const dnode &value);
+  void setArrayItem(OffsetList &chain, const OffsetList &indices, uint64 itemIndex, const dnode &value);
+  void appendEntry(OffsetList &chain, const OffsetList &indices, const dtpString *name, const dnode &value);
+  void eraseEntry(OffsetList &chain, const OffsetList &indices, uint64 index);
+};
+
+// ----------------------------------------------------------------------------
+dnViewOffset dnPersistentStore::Impl::alloc(size_t size)
+{
+  if (size == 0)
+    return 0;
+
+  const uint64 blockSize = dnPersistAlign(size);
+  dnViewOffset res;
+
+  if (!freeBlocks.take(blockSize, res)) {
+    ensureSize(heapEnd + blockSize);
+    res = heapEnd;
+    heapEnd += blockSize;
+  }
+
+  memset(base + res, 0, static_cast<size_t>(blockSize));
+  freshBlocks.insert(res);
+  modified = true;
+  return res;
+}
+
+void dnPersistentStore::Impl::release(dnViewOffset offset, uint64 size)
+{
+  if (size == 0)
+    return;
+
+  const uint64 blockSize = dnPersistAlign(size);
+  if (freshBlocks.erase(offset) > 0)
+    addFreeBlock(offset, blockSize);
+  else
+    pendingBlocks.push_back(std::make_pair(offset, blockSize));
+  modified = true;
+}
+
+void dnPersistentStore::Impl::addFreeBlock(dnViewOffset offset, uint64 size)
+{
+  dnViewOffset blockOffset;
+  uint64 blockSize;
+  freeBlocks.insert(offset, size, blockOffset, blockSize);
+  // block at end of heap is returned to heap
+  if (blockOffset + blockSize == heapEnd) {
+    freeBlocks.remove(blockOffset);
+    heapEnd = blockOffset;
+  }
+}
+
+void dnPersistentStore::Impl::releaseNode(dnViewOffset offset)
+{
+  const dnViewRecord rec = readRecord(offset);
+  const uint64 cap = dnPersistCapacity(rec);
+  const dnValueType kind = static_cast<dnValueType>(rec.kind);
+
+  if (kind == vt_string) {
+    release(rec.a, stringBlockSize(rec.a));
+  } else if (dnPersistHasNodeTable(rec)) {
+    for(uint64 i=0; i < rec.count; i++)
+      releaseNode(tableItem(rec.a, i));
+    if ((rec.flags & dvfNamed) != 0) {
+      dnViewOffset nameOffset;
+      for(uint64 i=0; i < rec.count; i++) {
+        nameOffset = tableItem(rec.b, i);
+        if (nameOffset != 0)
+          release(nameOffset, stringBlockSize(nameOffset));
+      }
+      release(rec.b, 2 * cap * sizeof(dnViewOffset));
+    }
+    release(rec.a, cap * sizeof(dnViewOffset));
+  } else if (kind == vt_array) {
+    if (rec.itemType == vt_string) {
+      for(uint64 i=0; i < rec.count; i++)
+        release(tableItem(rec.a, i), stringBlockSize(tableItem(rec.a, i)));
+      release(rec.a, cap * sizeof(dnViewOffset));
+    } else {
+      release(rec.a, cap * dnViewWriter::getItemSize(static_cast<dnValueType>(rec.itemType)));
+    }
+  }
+
+  release(offset, sizeof(dnViewRecord));
+}
+
+dnViewOffset dnPersistentStore::Impl::writableBlock(dnViewOffset offset, uint64 size, uint64 usedSize, uint64 newSize)
+{
+  if ((size == newSize) && isFresh(offset))
+    return offset;
+
+  dnViewOffset res = alloc(static_cast<size_t>(newSize));
+  uint64 copySize = std::min(usedSize, newSize);
+  if (copySize > 0)
+    memcpy(base + res, base + offset, static_cast<size_t>(copySize));
+  release(offset, size);
+  return res;
+}
+
+dnViewOffset dnPersistentStore::Impl::writableRecord(dnViewOffset offset)
+{
+  return writableBlock(offset, sizeof(dnViewRecord), sizeof(dnViewRecord), sizeof(dnViewRecord));
+}
+
+dnViewOffset dnPersistentStore::Impl::writeNode(const dnode &value)
+{
+  dnViewNodeWriter<Impl> writer(*this);
+  return writer.writeNode(value);
+}
+
+dnViewOffset dnPersistentStore::Impl::writeString(const dtpString &value)
+{
+  dnViewNodeWriter<Impl> writer(*this);
+  return writer.writeString(value);
+}
+
+int dnPersistentStore::Impl::compareName(dnViewOffset nameOffset, const dtpString &name) const
+{
+  if (nameOffset == 0)
+    return name.empty() ? 0 : -1;
+  dnViewString text(reinterpret_cast<const char *>(base + nameOffset + sizeof(uint64)),
+    static_cast<size_t>(dnViewReadRaw<uint64>(base + nameOffset)));
+  return text.compare(name.c_str(), name.length());
+}
+
+// ----------------------------------------------------------------------------
+void dnPersistentStore::Impl::resize(uint64 newSize)
+{
+  // unmap before resize, required on some platforms
+  boost::interprocess::mapped_region().swap(region);
+  base = DTP_NULL;
+  boost::filesystem::resize_file(fileName.c_str(), newSize);
+  boost::interprocess::mapped_region newRegion(mapping, boost::interprocess::read_write);
+  region.swap(newRegion);
+  base = static_cast<byte *>(region.get_address());
+  fileSize = region.get_size();
+}
+
+void dnPersistentStore::Impl::ensureSize(uint64 size)
+{
+  if (size <= fileSize)
+    return;
+  uint64 newSize = std::max(fileSize * 2, DNPERSIST_MIN_FILE_SIZE);
+  while (newSize < size)
+    newSize *= 2;
+  resize(newSize);
+}
+
+void dnPersistentStore::Impl::create()
+{
+  dnPersistHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, DNPERSIST_MAGIC, sizeof(header.magic));
+  header.byteOrderMark = DNVIEW_BYTE_ORDER_MARK;
+  header.version = DNPERSIST_VERSION;
+  header.xdoubleSize = sizeof(xdouble);
+  memcpy(base, &header, sizeof(header));
+
+  activeSlot = 1;
+  memset(&committed, 0, sizeof(committed));
+  heapEnd = dnPersistAlign(sizeof(dnPersistHeader));
+  rootOffset = writeNode(dnode());
+  commit();
+}
+
+bool dnPersistentStore::Impl::isValidSlot(const dnPersistCommitSlot &slot) const
+{
+  if ((slot.sequence == 0) || (slot.checksum != dnPersistChecksum(slot)))
+    return false;
+  if ((slot.heapEnd > fileSize) || (slot.rootOffset + sizeof(dnViewRecord) > slot.heapEnd))
+    return false;
+  if ((slot.freeTableSize > fileSize) ||
+      (slot.freeTableOffset + 2 * slot.freeTableSize * sizeof(uint64) > slot.heapEnd))
+    return false;
+  return true;
+}
+
+void dnPersistentStore::Impl::load()
+{
+  if (fileSize < sizeof(dnPersistHeader))
+    throw dnPersistFormatError("file too small");
+
+  dnPersistHeader header;
+  memcpy(&header, base, sizeof(header));
+
+  if (memcmp(header.magic, DNPERSIST_MAGIC, sizeof(header.magic)) != 0)
+    throw dnPersistFormatError("wrong signature");
+  if (header.byteOrderMark != DNVIEW_BYTE_ORDER_MARK)
+    throw dnPersistFormatError("wrong byte order");
+  if (header.version != DNPERSIST_VERSION)
+    throw dnPersistFormatError("unsupported version " + toString(header.version));
+  if (header.xdoubleSize != sizeof(xdouble))
+    throw dnPersistFormatError("incompatible xdouble size");
+
+  bool valid0 = isValidSlot(header.slots[0]);
+  bool valid1 = isValidSlot(header.slots[1]);
+
+  if (!valid0 && !valid1)
+    throw dnPersistFormatError("no valid commit point");
+
+  if (valid0 && valid1)
+    activeSlot = (header.slots[1].sequence > header.slots[0].sequence) ? 1 : 0;
+  else
+    activeSlot = valid1 ? 1 : 0;
+
+  committed = header.slots[activeSlot];
+  restoreState();
+}
+
+void dnPersistentStore::Impl::restoreState()
+{
+  rootOffset = committed.rootOffset;
+  heapEnd = committed.heapEnd;
+  freeBlocks.clear();
+  pendingBlocks.clear();
+  freshBlocks.clear();
+
+  // unused items of table have zero size
+  uint64 offset, size;
+  for(uint64 i=0; i < committed.freeTableSize; i++) {
+    offset = dnViewReadRaw<uint64>(base + committed.freeTableOffset + 2 * i * sizeof(uint64));
+    size = dnViewReadRaw<uint64>(base + committed.freeTableOffset + (2 * i + 1) * sizeof(uint64));
+    if (size > 0)
+      addFreeBlock(offset, size);
+  }
+
+  modified = false;
+}
+
+void dnPersistentStore::Impl::commit()
+{
+  // free table of previous commit point is not used by the new one
+  if (committed.freeTableSize > 0)
+    pendingBlocks.push_back(std::make_pair(committed.freeTableOffset, 2 * committed.freeTableSize * sizeof(uint64)));
+
+  // table must not overwrite pending blocks, they are still used by last commit point;
+  // merge of blocks can only decrease number of items
+  const uint64 tableCapacity = freeBlocks.size() + pendingBlocks.size() + 1;
+  const dnViewOffset tableOffset = alloc(static_cast<size_t>(2 * tableCapacity * sizeof(uint64)));
+
+  dnPersistFreeList nextFree(freeBlocks);
+  uint64 nextHeapEnd = heapEnd;
+  dnViewOffset blockOffset;
+  uint64 blockSize;
+  for(BlockList::const_iterator it = pendingBlocks.begin(), epos = pendingBlocks.end(); it != epos; ++it) {
+    nextFree.insert(it->first, it->second, blockOffset, blockSize);
+    if (blockOffset + blockSize == nextHeapEnd) {
+      nextFree.remove(blockOffset);
+      nextHeapEnd = blockOffset;
+    }
+  }
+
+  uint64 *table = reinterpret_cast<uint64 *>(base + tableOffset);
+  for(dnPersistFreeList::OffsetMap::const_iterator it = nextFree.blocks().begin(), epos = nextFree.blocks().end();
+      it != epos; ++it)
+  {
+    *table++ = it->first;
+    *table++ = it->second;
+  }
+
+  dnPersistCommitSlot slot;
+  memset(&slot, 0, sizeof(slot));
+  slot.sequence = committed.sequence + 1;
+  slot.rootOffset = rootOffset;
+  slot.heapEnd = nextHeapEnd;
+  slot.freeTableOffset = tableOffset;
+  slot.freeTableSize = tableCapacity;
+  slot.checksum = dnPersistChecksum(slot);
+
+  if (!region.flush(0, static_cast<size_t>(heapEnd), false))
+    throw dnError("Cannot flush file: " + fileName);
+
+  const uint nextSlot = 1 - activeSlot;
+  memcpy(base + offsetof(dnPersistHeader, slots) + nextSlot * sizeof(dnPersistCommitSlot), &slot, sizeof(slot));
+
+  if (!region.flush(0, sizeof(dnPersistHeader), false))
+    throw dnError("Cannot flush file: " + fileName);
+
+  activeSlot = nextSlot;
+  committed = slot;
+  heapEnd = nextHeapEnd;
+  freeBlocks.swap(nextFree);
+  pendingBlocks.clear();
+  freshBlocks.clear();
+  modified = false;
+}
+
+// ----------------------------------------------------------------------------
+bool dnPersistentStore::Impl::resolve(const dtpString &path, OffsetList &chain, OffsetList &indices, uint64 &itemIndex) const
+{
+  chain.assign(1, rootOffset);
+  indices.clear();
+  itemIndex = dnode::npos;
+
+  const char *segStart = path.c_str();
+  const char *segEnd;
+  uint64 index;
+  dnodeView container;
+  dnViewRecord rec;
+
+  while (*segStart != '\0') {
+    segEnd = segStart;
+    while ((*segEnd != '\0') && (*segEnd != DNVIEW_PATH_SEPARATOR))
+      ++segEnd;
+
+    size_t segLen = segEnd - segStart;
+    if (segLen > 0) {
+      // item of scalar array must be last item of path
+      if (itemIndex != dnode::npos)
+        return false;
+
+      rec = readRecord(chain.back());
+      if ((rec.kind != vt_parent) && (rec.kind != vt_array))
+        return false;
+
+      container = makeView(base, chain.back());
+      index = container.indexOfName(segStart, segLen);
+      if (index == dnodeView::npos)
+        if (!dnPersistIsIndex(segStart, segLen, index) || (index >= rec.count))
+          return false;
+
+      if (dnPersistHasNodeTable(rec)) {
+        indices.push_back(index);
+        chain.push_back(tableItem(rec.a, index));
+      } else {
+        itemIndex = index;
+      }
+    }
+
+    segStart = (*segEnd == '\0') ? segEnd : segEnd + 1;
+  }
+
+  return true;
+}
+
+// Replaces link to chain[level] with newOffset, copying parents which belong to last commit point
+void dnPersistentStore::Impl::relink(OffsetList &chain, const OffsetList &indices, size_t level, dnViewOffset newOffset)
+{
+  dnViewOffset parentOffset, tableOffset;
+  dnViewRecord rec;
+  uint64 cap;
+
+  while ((level > 0) && (chain[level] != newOffset)) {
+    chain[level] = newOffset;
+    --level;
+    parentOffset = chain[level];
+    rec = readRecord(parentOffset);
+    cap = dnPersistCapacity(rec);
+    tableOffset = writableBlock(rec.a, cap * sizeof(dnViewOffset), rec.count * sizeof(dnViewOffset), cap * sizeof(dnViewOffset));
+    setTableItem(tableOffset, indices[level], newOffset);
+    if (tableOffset == rec.a) {
+      newOffset = parentOffset;
+    } else {
+      newOffset = writableRecord(parentOffset);
+      record(newOffset)->a = tableOffset;
+    }
+  }
+
+  if (level == 0)
+    rootOffset = newOffset;
+  chain[level] = newOffset;
+}
+
+void dnPersistentStore::Impl::setElement(const dtpString &path, const dnode &value)
+{
+  OffsetList chain, indices;
+  uint64 itemIndex;
+
+  if (!resolve(path, chain, indices, itemIndex)) {
+    dtpString parentPath, name;
+    dnPersistSplitPath(path, parentPath, name);
+    if (name.empty() || !resolve(parentPath, chain, indices, itemIndex) || (itemIndex != dnode::npos) ||
+        ((record(chain.back())->flags & dvfNamed) == 0))
+      throw dnError("Path not found: " + path);
+    appendEntry(chain, indices, &name, value);
+    return;
+  }
+
+  if (itemIndex != dnode::npos) {
+    setArrayItem(chain, indices, itemIndex, value);
+    return;
+  }
+
+  dnViewOffset oldOffset = chain.back();
+  dnViewOffset newOffset = writeNode(value);
+  relink(chain, indices, chain.size() - 1, newOffset);
+  releaseNode(oldOffset);
+}
+
+void dnPersistentStore::Impl::setArrayItem(OffsetList &chain, const OffsetList &indices, uint64 itemIndex, const dnode &value)
+{
+  const dnViewOffset arrayOffset = chain.back();
+  const dnViewRecord rec = readRecord(arrayOffset);
+  const uint64 cap = dnPersistCapacity(rec);
+  const dnValueType itemType = static_cast<dnValueType>(rec.itemType);
+  dnViewOffset dataOffset;
+
+  if (itemType == vt_string) {
+    dnViewOffset oldString = tableItem(rec.a, itemIndex);
+    dnViewOffset newString = writeString(value.getAs<dtpString>());
+    dataOffset = writableBlock(rec.a, cap * sizeof(dnViewOffset), rec.count * sizeof(dnViewOffset), cap * sizeof(dnViewOffset));
+    setTableItem(dataOffset, itemIndex, newString);
+    release(oldString, stringBlockSize(oldString));
+  } else {
+    const uint64 itemSize = dnViewWriter::getItemSize(itemType);
+    dataOffset = writableBlock(rec.a, cap * itemSize, rec.count * itemSize, cap * itemSize);
+    dnPersistPutItem(itemType, base + dataOffset + itemIndex * itemSize, value);
+  }
+
+  if (dataOffset != rec.a) {
+    dnViewOffset newOffset = writableRecord(arrayOffset);
+    record(newOffset)->a = dataOffset;
+    relink(chain, indices, chain.size() - 1, newOffset);
+  }
+}
+
+void dnPersistentStore::Impl::appendEntry(OffsetList &chain, const OffsetList &indices, const dtpString *name, const dnode &value)
+{
+  const dnViewOffset containerOffset = chain.back();
+  const dnViewRecord rec = readRecord(containerOffset);
+  const dnValueType kind = static_cast<dnValueType>(rec.kind);
+  const bool named = ((rec.flags & dvfNamed) != 0);
+
+  if ((kind != vt_parent) && (kind != vt_array))
+    throw dnError("Element is not a container");
+  if ((name != DTP_NULL) && !named)
+    throw dnError("Container does not support names");
+
+  const uint64 cnt = rec.count;
+  const uint64 cap = dnPersistCapacity(rec);
+  uint64 newCap = cap;
+  if (cnt + 1 > cap)
+    newCap = std::max(cap * 2, DNPERSIST_MIN_TABLE_CAPACITY);
+  // capacity is stored in uint field
+  if (newCap > 0xffffffffULL)
+    newCap = cnt + 1;
+
+  dnViewRecord newRec = rec;
+  newRec.count = cnt + 1;
+  newRec.reserved = static_cast<uint>(newCap);
+
+  if (dnPersistHasNodeTable(rec) || (rec.itemType == vt_string)) {
+    dnViewOffset itemOffset;
+    if (kind == vt_array && (rec.itemType == vt_string))
+      itemOffset = writeString(value.getAs<dtpString>());
+    else
+      itemOffset = writeNode(value);
+
+    newRec.a = writableBlock(rec.a, cap * sizeof(dnViewOffset), cnt * sizeof(dnViewOffset), newCap * sizeof(dnViewOffset));
+    setTableItem(newRec.a, cnt, itemOffset);
+
+    if (named) {
+      const dtpString emptyName;
+      const dtpString &itemName = (name != DTP_NULL) ? *name : emptyName;
+      const dnViewOffset nameOffset = itemName.empty() ? 0 : writeString(itemName);
+
+      // names [0, cnt), sorted index [cnt, 2 * cnt) -> names [0, cnt + 1), sorted index [cnt + 1, 2 * cnt + 2)
+      std::vector<dnViewOffset> sorted(static_cast<size_t>(cnt));
+      if (cnt > 0)
+        memcpy(&sorted[0], base + rec.b + cnt * sizeof(dnViewOffset), static_cast<size_t>(cnt * sizeof(dnViewOffset)));
+
+      newRec.b = writableBlock(rec.b, 2 * cap * sizeof(dnViewOffset), cnt * sizeof(dnViewOffset), 2 * newCap * sizeof(dnViewOffset));
+      setTableItem(newRec.b, cnt, nameOffset);
+
+      // upper bound keeps order of equal names
+      uint64 first = 0, count = cnt, step, mid;
+      while (count > 0) {
+        step = count / 2;
+        mid = first + step;
+        if (compareName(tableItem(newRec.b, sorted[static_cast<size_t>(mid)]), itemName) <= 0) {
+          first = mid + 1;
+          count -= step + 1;
+        } else {
+          count = step;
+        }
+      }
+      sorted.insert(sorted.begin() + static_cast<size_t>(first), cnt);
+      memcpy(base + newRec.b + (cnt + 1) * sizeof(dnViewOffset), &sorted[0], sorted.size() * sizeof(dnViewOffset));
+    }
+  } else {
+    const uint64 itemSize = dnViewWriter::getItemSize(static_cast<dnValueType>(rec.itemType));
+    newRec.a = writableBlock(rec.a, cap * itemSize, cnt * itemSize, newCap * itemSize);
+    dnPersistPutItem(static_cast<dnValueType>(rec.itemType), base + newRec.a + cnt * itemSize, value);
+  }
+
+  dnViewOffset newOffset = writableRecord(containerOffset);
+  memcpy(base + newOffset, &newRec, sizeof(newRec));
+  relink(chain, indices, chain.size() - 1, newOffset);
+}
+
+void dnPersistentStore::Impl::eraseEntry(OffsetList &chain, const OffsetList &indices, uint64 index)
+{
+  const dnViewOffset containerOffset = chain.back();
+  const dnViewRecord rec = readRecord(containerOffset);
+  const uint64 cnt = rec.count;
+  const uint64 cap = dnPersistCapacity(rec);
+  dnViewRecord newRec = rec;
+  newRec.count = cnt - 1;
+  newRec.reserved = static_cast<uint>(cap);
+
+  dnViewOffset releasedNode = 0;
+
+  if (dnPersistHasNodeTable(rec) || (rec.itemType == vt_string)) {
+    const dnViewOffset itemOffset = tableItem(rec.a, index);
+    newRec.a = writableBlock(rec.a, cap * sizeof(dnViewOffset), cnt * sizeof(dnViewOffset), cap * sizeof(dnViewOffset));
+    memmove(base + newRec.a + index * sizeof(dnViewOffset), base + newRec.a + (index + 1) * sizeof(dnViewOffset),
+      static_cast<size_t>((cnt - index - 1) * sizeof(dnViewOffset)));
+
+    if ((rec.flags & dvfNamed) != 0) {
+      std::vector<dnViewOffset> names(static_cast<size_t>(2 * cnt));
+      memcpy(&names[0], base + rec.b, names.size() * sizeof(dnViewOffset));
+
+      const dnViewOffset nameOffset = names[static_cast<size_t>(index)];
+      names.erase(names.begin() + static_cast<size_t>(index));
+      std::vector<dnViewOffset>::iterator it = names.begin() + static_cast<size_t>(cnt - 1);
+      while (it != names.end()) {
+        if (*it == index) {
+          it = names.erase(it);
+        } else {
+          if (*it > index)
+            --(*it);
+          ++it;
+        }
+      }
+
+      newRec.b = writableBlock(rec.b, 2 * cap * sizeof(dnViewOffset), 0, 2 * cap * sizeof(dnViewOffset));
+      if (!names.empty())
+        memcpy(base + newRec.b, &names[0], names.size() * sizeof(dnViewOffset));
+      if (nameOffset != 0)
+        release(nameOffset, stringBlockSize(nameOffset));
+    }
+
+    if (rec.itemType == vt_string && rec.kind == vt_array)
+      release(itemOffset, stringBlockSize(itemOffset));
+    else
+      releasedNode = itemOffset;
+  } else {
+    const uint64 itemSize = dnViewWriter::getItemSize(static_cast<dnValueType>(rec.itemType));
+    newRec.a = writableBlock(rec.a, cap * itemSize, cnt * itemSize, cap * itemSize);
+    memmove(base + newRec.a + index * itemSize, base + newRec.a + (index + 1) * itemSize,
+      static_cast<size_t>((cnt - index - 1) * itemSize));
+  }
+
+  dnViewOffset newOffset = writableRecord(containerOffset);
+  memcpy(base + newOffset, &newRec, sizeof(newRec));
+  relink(chain, indices, chain.size() - 1, newOffset);
+
+  if (releasedNode != 0)
+    releaseNode(releasedNode);
+}
+
+// ----------------------------------------------------------------------------
+// dnPersistentStore
+// ----------------------------------------------------------------------------
+dnPersistentStore::dnPersistentStore(): m_impl(DTP_NULL)
+{
+}
+
+dnPersistentStore::dnPersistentStore(const dtpString &fileName): m_impl(DTP_NULL)
+{
+  open(fileName);
+}
+
+dnPersistentStore::~dnPersistentStore()
+{
+  close();
+}
+
+void dnPersistentStore::open(const dtpString &fileName)
+{
+  close();
+
+  bool isNew = !boost::filesystem::exists(fileName.c_str());
+  if (isNew) {
+    std::ofstream output(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!output.good())
+      throw dnError("Cannot create file: " + fileName);
+    output.close();
+    boost::filesystem::resize_file(fileName.c_str(), DNPERSIST_MIN_FILE_SIZE);
+  }
+
+  try {
+    m_impl = new Impl(fileName);
+  }
+  catch(boost::interprocess::interprocess_exception &e) {
+    throw dnError("Cannot map file: " + fileName + ": " + e.what());
+  }
+
+  try {
+    if (isNew)
+      m_impl->create();
+    else
+      m_impl->load();
+  }
+  catch(...) {
+    close();
+    throw;
+  }
+}
+
+void dnPersistentStore::close()
+{
+  delete m_impl;
+  m_impl = DTP_NULL;
+}
+
+bool dnPersistentStore::isOpen() const
+{
+  return (m_impl != DTP_NULL);
+}
+
+const dtpString &dnPersistentStore::getFileName() const
+{
+  checkOpen();
+  return m_impl->fileName;
+}
+
+void dnPersistentStore::checkOpen() const
+{
+  if (m_impl == DTP_NULL)
+    throw dnError("Store is not open");
+}
+
+dnodeView dnPersistentStore::makeView(const void *base, dnViewOffset recordOffset)
+{
+  const byte *basePtr = static_cast<const byte *>(base);
+  return dnodeView(basePtr, reinterpret_cast<const dnViewRecord *>(basePtr + recordOffset));
+}
+
+dnodeView dnPersistentStore::getRoot() const
+{
+  checkOpen();
+  return makeView(m_impl->base, m_impl->rootOffset);
+}
+
+bool dnPersistentStore::getElementByPath(const dtpString &path, dnodeView &output) const
+{
+  return getRoot().getElementByPath(path, output);
+}
+
+void dnPersistentStore::load(dnode &output) const
+{
+  getRoot().toNode(output);
+}
+
+void dnPersistentStore::setRoot(const dnode &value)
+{
+  checkOpen();
+  dnViewOffset oldOffset = m_impl->rootOffset;
+  m_impl->rootOffset = m_impl->writeNode(value);
+  m_impl->releaseNode(oldOffset);
+}
+
+void dnPersistentStore::setElement(const dtpString &path, const dnode &value)
+{
+  checkOpen();
+  m_impl->setElement(path, value);
+}
+
+void dnPersistentStore::addItem(const dtpString &path, const dnode &value)
+{
+  checkOpen();
+  Impl::OffsetList chain, indices;
+  uint64 itemIndex;
+  if (!m_impl->resolve(path, chain, indices, itemIndex) || (itemIndex != dnode::npos))
+    throw dnError("Path not found: " + path);
+  m_impl->appendEntry(chain, indices, DTP_NULL, value);
+}
+
+void dnPersistentStore::addChild(const dtpString &path, const dtpString &name, const dnode &value)
+{
+  checkOpen();
+  Impl::OffsetList chain, indices;
+  uint64 itemIndex;
+  if (!m_impl->resolve(path, chain, indices, itemIndex) || (itemIndex != dnode::npos))
+    throw dnError("Path not found: " + path);
+  m_impl->appendEntry(chain, indices, &name, value);
+}
+
+void dnPersistentStore::eraseElement(const dtpString &path)
+{
+  checkOpen();
+  Impl::OffsetList chain, indices;
+  uint64 itemIndex;
+  if (!m_impl->resolve(path, chain, indices, itemIndex))
+    throw dnError("Path not found: " + path);
+
+  if (itemIndex != dnode::npos) {
+    m_impl->eraseEntry(chain, indices, itemIndex);
+  } else {
+    if (chain.size() < 2)
+      throw dnError("Root cannot be erased");
+    uint64 index = indices.back();
+    chain.pop_back();
+    indices.pop_back();
+    m_impl->eraseEntry(chain, indices, index);
+  }
+}
+
+void dnPersistentStore::commit()
+{
+  checkOpen();
+  if (m_impl->modified)
+    m_impl->commit();
+}
+
+void dnPersistentStore::rollback()
+{
+  checkOpen();
+  m_impl->restoreState();
+}
+
+void dnPersistentStore::flush()
+{
+  checkOpen();
+  if (!m_impl->region.flush(0, static_cast<size_t>(m_impl->heapEnd), false))
+    throw dnError("Cannot flush file: " + m_impl->fileName);
+}
+
+void dnPersistentStore::compact()
+{
+  checkOpen();
+  commit();
+
+  const dtpString fileName = m_impl->fileName;
+  const dtpString partName = fileName + DNPERSIST_PART_EXT;
+
+  dnode tree;
+  load(tree);
+
+  boost::filesystem::remove(partName.c_str());
+  {
+    dnPersistentStore part(partName);
+    part.setRoot(tree);
+    part.commit();
+  }
+
+  close();
+  boost::filesystem::rename(partName.c_str(), fileName.c_str());
+  open(fileName);
+}
+
+bool dnPersistentStore::isModified() const
+{
+  return (m_impl != DTP_NULL) && m_impl->modified;
+}
+
+uint64 dnPersistentStore::getSequence() const
+{
+  checkOpen();
+  return m_impl->committed.sequence;
+}
+
+uint64 dnPersistentStore::getDataSize() const
+{
+  checkOpen();
+  return m_impl->heapEnd;
+}
+
+uint64 dnPersistentStore::getFreeSize() const
+{
+  checkOpen();
+  uint64 res = m_impl->freeBlocks.totalSize();
+  for(Impl::BlockList::const_iterator it = m_impl->pendingBlocks.begin(), epos = m_impl->pendingBlocks.end(); it != epos; ++it)
+    res += it->second;
+  return res;
+}
+
+uint64 dnPersistentStore::getFileSize() const
+{
+  checkOpen();
+  return m_impl->fileSize;
+}
@@ -0,0 +1,700 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_sketch.cpp
+// Project:     dtpLib
+// Purpose:     Streaming quantile, histogram & distinct count sketches
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+
+#include "dtp/dnode_sketch.h"
+
+using namespace dtp;
+using namespace Details;
+
+namespace {
+
+const double DSKETCH_PI = 3.14159265358979323846;
+const uint DSKETCH_BUFFER_FACTOR = 5;
+const uint DSKETCH_MIN_PRECISION = 4;
+const uint DSKETCH_MAX_PRECISION = 18;
+
+inline bool isNan(double value)
+{
+  return (value != value);
+}
+
+inline bool isFinite(double value)
+{
+  return !isNan(value) && (std::fabs(value) <= std::numeric_limits<double>::max());
+}
+
+/// Linear interpolation between (x1, y1) & (x2, y2)
+inline double interpolate(double x, double x1, double y1, double x2, double y2)
+{
+  if (x2 <= x1)
+    return y2;
+  return y1 + (x - x1) * (y2 - y1) / (x2 - x1);
+}
+
+/// FNV-1a
+inline uint64 sketchTextHash(const char *text, size_t length)
+{
+  uint64 res = 14695981039346656037ULL;
+  for(const char *it = text, *epos = text + length; it != epos; ++it) {
+    res ^= static_cast<unsigned char>(*it);
+    res *= 1099511628211ULL;
+  }
+  return res;
+}
+
+/// 64-bit finalizer (MurmurHash3)
+inline uint64 sketchMix(uint64 value)
+{
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ULL;
+  value ^= value >> 33;
+  return value;
+}
+
+template<typename T>
+void writeVector(const std::vector<T> &items, dnValueType itemType, dnode &output)
+{
+  output.setAsArray(itemType);
+  for(typename std::vector<T>::const_iterator it = items.begin(), epos = items.end(); it != epos; ++it)
+    output.addItem(*it);
+}
+
+template<typename T>
+void readVector(const dnode &input, std::vector<T> &output)
+{
+  dnode::size_type cnt = input.size();
+  output.resize(cnt);
+  for(dnode::size_type i=0; i != cnt; i++)
+    output[i] = input.get<T>(i);
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// dnQuantileSketch
+// ----------------------------------------------------------------------------
+dnQuantileSketch::dnQuantileSketch(double compression): m_compression(compression)
+{
+  if (!(compression >= 1.0))
+    throw dnError("Invalid quantile sketch compression: "+toString(compression));
+  m_bufferLimit = static_cast<size_t>(compression * DSKETCH_BUFFER_FACTOR);
+  clear();
+}
+
+void dnQuantileSketch::clear()
+{
+  m_count = 0;
+  m_min = m_max = 0.0;
+  m_centroids.clear();
+  m_buffer.clear();
+}
+
+void dnQuantileSketch::add(double value)
+{
+  if (isNan(value))
+    return;
+
+  if (m_count == 0) {
+    m_min = m_max = value;
+  } else {
+    if (value < m_min)
+      m_min = value;
+    if (value > m_max)
+      m_max = value;
+  }
+
+  m_count++;
+  m_buffer.push_back(Centroid(value, 1.0));
+  if (m_buffer.size() >= m_bufferLimit)
+    flush();
+}
+
+void dnQuantileSketch::merge(const dnQuantileSketch &other)
+{
+  if (other.empty())
+    return;
+
+  other.flush();
+  std::vector<Centroid> items(other.m_centroids);
+
+  if (empty()) {
+    m_min = other.m_min;
+    m_max = other.m_max;
+  } else {
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+  }
+
+  m_count += other.m_count;
+  m_buffer.insert(m_buffer.end(), items.begin(), items.end());
+  flush();
+}
+
+/// k1 scale function of t-digest, centroid can span at most 1 unit of k
+double dnQuantileSketch::scale(double q) const
+{
+  if (q < 0.0)
+    q = 0.0;
+  else if (q > 1.0)
+    q = 1.0;
+  return m_compression / (2.0 * DSKETCH_PI) * std::asin(2.0 * q - 1.0);
+}
+
+void dnQuantileSketch::flush() const
+{
+  if (m_buffer.empty())
+    return;
+
+  m_work.clear();
+  m_work.reserve(m_centroids.size() + m_buffer.size());
+  m_work.insert(m_work.end(), m_centroids.begin(), m_centroids.end());
+  m_work.insert(m_work.end(), m_buffer.begin(), m_buffer.end());
+  m_buffer.clear();
+  std::sort(m_work.begin(), m_work.end());
+
+  double totalWeight = 0.0;
+  for(std::vector<Centroid>::const_iterator it = m_work.begin(), epos = m_work.end(); it != epos; ++it)
+    totalWeight += it->weight;
+
+  m_centroids.clear();
+  Centroid current = m_work[0];
+  double weightBefore = 0.0;
+  double kLow = scale(0.0);
+
+  for(size_t i = 1, epos = m_work.size(); i != epos; i++) {
+    const Centroid &next = m_work[i];
+    double proposedWeight = current.weight + next.weight;
+
+    if (scale((weightBefore + proposedWeight) / totalWeight) - kLow <= 1.0) {
+      current.mean += (next.mean - current.mean) * next.weight / proposedWeight;
+      current.weight = proposedWeight;
+    } else {
+      weightBefore += current.weight;
+      kLow = scale(weightBefore / totalWeight);
+      m_centroids.push_back(current);
+      current = next;
+    }
+  }
+
+  m_centroids.push_back(current);
+}
+
+size_t dnQuantileSketch::getCentroidCount() const
+{
+  flush();
+  return m_centroids.size();
+}
+
+double dnQuantileSketch::quantile(double q) const
+{
+  if (empty())
+    return 0.0;
+  if (q <= 0.0)
+    return m_min;
+  if (q >= 1.0)
+    return m_max;
+
+  flush();
+
+  size_t cnt = m_centroids.size();
+  if (cnt == 1)
+    return m_centroids[0].mean;
+
+  double totalWeight = 0.0;
+  for(size_t i=0; i != cnt; i++)
+    totalWeight += m_centroids[i].weight;
+
+  double index = q * totalWeight;
+
+  // values between min & center of first centroid
+  double firstCenter = m_centroids[0].weight / 2.0;
+  if (index < firstCenter)
+    return interpolate(index, 0.0, m_min, firstCenter, m_centroids[0].mean);
+
+  // values between centers of neighbour centroids
+  double weightBefore = 0.0;
+  for(size_t i=0; i + 1 < cnt; i++) {
+    double left = weightBefore + m_centroids[i].weight / 2.0;
+    double right = weightBefore + m_centroids[i].weight + m_centroids[i + 1].weight / 2.0;
+    if (index < right)
+      return interpolate(index, left, m_centroids[i].mean, right, m_centroids[i + 1].mean);
+    weightBefore += m_centroids[i].weight;
+  }
+
+  // values between center of last centroid & max
+  double lastCenter = totalWeight - m_centroids[cnt - 1].weight / 2.0;
+  return interpolate(index, lastCenter, m_centroids[cnt - 1].mean, totalWeight, m_max);
+}
+
+double dnQuantileSketch::cdf(double value) const
+{
+  if (empty() || (value < m_min))
+    return 0.0;
+  if (value >= m_max)
+    return 1.0;
+
+  flush();
+
+  size_t cnt = m_centroids.size();
+  double totalWeight = 0.0;
+  for(size_t i=0; i != cnt; i++)
+    totalWeight += m_centroids[i].weight;
+
+  if (value < m_centroids[0].mean)
+    return interpolate(value, m_min, 0.0, m_centroids[0].mean, m_centroids[0].weight / 2.0) / totalWeight;
+
+  double weightBefore = 0.0;
+  for(size_t i=0; i + 1 < cnt; i++) {
+    if (value < m_centroids[i + 1].mean) {
+      double left = weightBefore + m_centroids[i].weight / 2.0;
+      double right = weightBefore + m_centroids[i].weight + m_centroids[i + 1].weight / 2.0;
+      return interpolate(value, m_centroids[i].mean, left, m_centroids[i + 1].mean, right) / totalWeight;
+    }
+    weightBefore += m_centroids[i].weight;
+  }
+
+  double lastCenter = totalWeight - m_centroids[cnt - 1].weight / 2.0;
+  return interpolate(value, m_centroids[cnt - 1].mean, lastCenter, m_max, totalWeight) / totalWeight;
+}
+
+void dnQuantileSketch::toNode(dnode &output) const
+{
+  flush();
+
+  std::vector<double> means, weights;
+  means.reserve(m_centroids.size());
+  weights.reserve(m_centroids.size());
+  for(std::vector<Centroid>::const_iterator it = m_centroids.begin(), epos = m_centroids.end(); it != epos; ++it) {
+    means.push_back(it->mean);
+    weights.push_back(it->weight);
+  }
+
+  dnode res(ict_parent);
+  dnode *meansNode = new dnode();
+  res.addChild("means", meansNode);
+  writeVector(means, vt_double, *meansNode);
+  dnode *weightsNode = new dnode();
+  res.addChild("weights", weightsNode);
+  writeVector(weights, vt_double, *weightsNode);
+  res.addChild("compression", new dnode(m_compression));
+  res.addChild("count", new dnode(m_count));
+  res.addChild("min", new dnode(m_min));
+  res.addChild("max", new dnode(m_max));
+  output.swap(res);
+}
+
+void dnQuantileSketch::fromNode(const dnode &input)
+{
+  std::vector<double> means, weights;
+  readVector(input.getElement("means"), means);
+  readVector(input.getElement("weights"), weights);
+  if (means.size() != weights.size())
+    throw dnError("Invalid quantile sketch state");
+
+  dnQuantileSketch res(input.get<double>("compression"));
+  res.m_count = input.get<uint64>("count");
+  res.m_min = input.get<double>("min");
+  res.m_max = input.get<double>("max");
+  res.m_centroids.reserve(means.size());
+  for(size_t i=0, epos = means.size(); i != epos; i++)
+    res.m_centroids.push_back(Centroid(means[i], weights[i]));
+
+  *this = res;
+}
+
+// ----------------------------------------------------------------------------
+// dnHistogram
+// ----------------------------------------------------------------------------
+dnHistogram::dnHistogram(double minValue, double maxValue, uint bucketCount):
+  m_min(minValue), m_max(maxValue), m_counts(bucketCount, 0)
+{
+  if ((bucketCount == 0) || !(maxValue > minValue) || !isFinite(maxValue - minValue))
+    throw dnError("Invalid histogram range");
+  m_scale = static_cast<double>(bucketCount) / (maxValue - minValue);
+  clear();
+}
+
+void dnHistogram::clear()
+{
+  m_count = m_underflow = m_overflow = 0;
+  std::fill(m_counts.begin(), m_counts.end(), 0);
+}
+
+void dnHistogram::add(double value)
+{
+  if (isNan(value))
+    return;
+
+  m_count++;
+  if (value < m_min) {
+    m_underflow++;
+  } else if (value > m_max) {
+    m_overflow++;
+  } else {
+    size_t index = static_cast<size_t>((value - m_min) * m_scale);
+    if (index >= m_counts.size())
+      index = m_counts.size() - 1;
+    m_counts[index]++;
+  }
+}
+
+void dnHistogram::merge(const dnHistogram &other)
+{
+  if ((m_min != other.m_min) || (m_max != other.m_max) || (m_counts.size() != other.m_counts.size()))
+    throw dnError("Histogram bucket layouts differ");
+
+  m_count += other.m_count;
+  m_underflow += other.m_underflow;
+  m_overflow += other.m_overflow;
+  for(size_t i=0, epos = m_counts.size(); i != epos; i++)
+    m_counts[i] += other.m_counts[i];
+}
+
+dnHistogramBucket dnHistogram::getBucket(uint index) const
+{
+  double cnt = static_cast<double>(m_counts.size());
+  double width = m_max - m_min;
+  return dnHistogramBucket(
+    m_min + width * index / cnt,
+    (index + 1 == m_counts.size()) ? m_max : m_min + width * (index + 1) / cnt,
+    m_counts[index]);
+}
+
+void dnHistogram::getBuckets(std::vector<dnHistogramBucket> &output) const
+{
+  output.resize(m_counts.size());
+  for(uint i=0, epos = getBucketCount(); i != epos; i++)
+    output[i] = getBucket(i);
+}
+
+void dnHistogram::toNode(dnode &output) const
+{
+  dnode res(ict_parent);
+  res.addChild("min", new dnode(m_min));
+  res.addChild("max", new dnode(m_max));
+  res.addChild("count", new dnode(m_count));
+  res.addChild("underflow", new dnode(m_underflow));
+  res.addChild("overflow", new dnode(m_overflow));
+  dnode *countsNode = new dnode();
+  res.addChild("counts", countsNode);
+  writeVector(m_counts, vt_uint64, *countsNode);
+  output.swap(res);
+}
+
+void dnHistogram::fromNode(const dnode &input)
+{
+  const dnode countsNode = input.getElement("counts");
+  dnHistogram res(input.get<double>("min"), input.get<double>("max"), countsNode.size());
+  readVector(countsNode, res.m_counts);
+  res.m_count = input.get<uint64>("count");
+  res.m_underflow = input.get<uint64>("underflow");
+  res.m_overflow = input.get<uint64>("overflow");
+  *this = res;
+}
+
+// ----------------------------------------------------------------------------
+// dnLogHistogram
+// ----------------------------------------------------------------------------
+dnLogHistogram::dnLogHistogram(double relativeAccuracy)
+{
+  init(relativeAccuracy);
+}
+
+void dnLogHistogram::init(double relativeAccuracy)
+{
+  if (!((relativeAccuracy > 0.0) && (relativeAccuracy < 1.0)))
+    throw dnError("Invalid histogram accuracy: "+toString(relativeAccuracy));
+
+  m_accuracy = relativeAccuracy;
+  m_gamma = (1.0 + relativeAccuracy) / (1.0 - relativeAccuracy);
+  m_logGamma = std::log(m_gamma);
+  clear();
+}
+
+void dnLogHistogram::clear()
+{
+  m_count = m_zeroCount = 0;
+  m_positive.clear();
+  m_negative.clear();
+}
+
+int dnLogHistogram::bucketIndex(double absValue) const
+{
+  return static_cast<int>(std::ceil(std::log(absValue) / m_logGamma));
+}
+
+double dnLogHistogram::bucketUpper(int index) const
+{
+  return std::exp(index * m_logGamma);
+}
+
+/// Value with relative distance to both bucket bounds equal to accuracy
+double dnLogHistogram::bucketValue(int index) const
+{
+  return 2.0 * bucketUpper(index) / (m_gamma + 1.0);
+}
+
+void dnLogHistogram::add(double value)
+{
+  if (!isFinite(value))
+    return;
+
+  m_count++;
+  if (value > 0.0)
+    m_positive[bucketIndex(value)]++;
+  else if (value < 0.0)
+    m_negative[bucketIndex(-value)]++;
+  else
+    m_zeroCount++;
+}
+
+void dnLogHistogram::merge(const dnLogHistogram &other)
+{
+  if (m_accuracy != other.m_accuracy)
+    throw dnError("Histogram accuracies differ");
+
+  m_count += other.m_count;
+  m_zeroCount += other.m_zeroCount;
+  for(bucket_map::const_iterator it = other.m_positive.begin(), epos = other.m_positive.end(); it != epos; ++it)
+    m_positive[it->first] += it->second;
+  for(bucket_map::const_iterator it = other.m_negative.begin(), epos = other.m_negative.end(); it != epos; ++it)
+    m_negative[it->first] += it->second;
+}
+
+double dnLogHistogram::quantile(double q) const
+{
+  if (empty())
+    return 0.0;
+
+  if (q < 0.0)
+    q = 0.0;
+  else if (q > 1.0)
+    q = 1.0;
+
+  uint64 rank = static_cast<uint64>(q * static_cast<double>(m_count - 1));
+  uint64 seen = 0;
+
+  for(bucket_map::const_reverse_iterator it = m_negative.rbegin(), epos = m_negative.rend(); it != epos; ++it) {
+    seen += it->second;
+    if (seen > rank)
+      return -bucketValue(it->first);
+  }
+
+  seen += m_zeroCount;
+  if (seen > rank)
+    return 0.0;
+
+  for(bucket_map::const_iterator it = m_positive.begin(), epos = m_positive.end(); it != epos; ++it) {
+    seen += it->second;
+    if (seen > rank)
+      return bucketValue(it->first);
+  }
+
+  return bucketValue(m_positive.rbegin()->first);
+}
+
+void dnLogHistogram::getBuckets(std::vector<dnHistogramBucket> &output) const
+{
+  output.clear();
+  output.reserve(m_negative.size() + m_positive.size() + 1);
+
+  for(bucket_map::const_reverse_iterator it = m_negative.rbegin(), epos = m_negative.rend(); it != epos; ++it)
+    output.push_back(dnHistogramBucket(-bucketUpper(it->first), -bucketUpper(it->first - 1), it->second));
+
+  if (m_zeroCount > 0)
+    output.push_back(dnHistogramBucket(0.0, 0.0, m_zeroCount));
+
+  for(bucket_map::const_iterator it = m_positive.begin(), epos = m_positive.end(); it != epos; ++it)
+    output.push_back(dnHistogramBucket(bucketUpper(it->first - 1), bucketUpper(it->first), it->second));
+}
+
+void dnLogHistogram::toNode(dnode &output) const
+{
+  std::vector<int> posIndex, negIndex;
+  std::vector<uint64> posCount, negCount;
+
+  for(bucket_map::const_iterator it = m_positive.begin(), epos = m_positive.end(); it != epos; ++it) {
+    posIndex.push_back(it->first);
+    posCount.push_back(it->second);
+  }
+
+  for(bucket_map::const_iterator it = m_negative.begin(), epos = m_negative.end(); it != epos; ++it) {
+    negIndex.push_back(it->first);
+    negCount.push_back(it->second);
+  }
+
+  dnode res(ict_parent);
+  res.addChild("accuracy", new dnode(m_accuracy));
+  res.addChild("count", new dnode(m_count));
+  res.addChild("zero", new dnode(m_zeroCount));
+
+  dnode *child = new dnode();
+  res.addChild("pos_index", child);
+  writeVector(posIndex, vt_int, *child);
+  child = new dnode();
+  res.addChild("pos_count", child);
+  writeVector(posCount, vt_uint64, *child);
+  child = new dnode();
+  res.addChild("neg_index", child);
+  writeVector(negIndex, vt_int, *child);
+  child = new dnode();
+  res.addChild("neg_count", child);
+  writeVector(negCount, vt_uint64, *child);
+
+  output.swap(res);
+}
+
+void dnLogHistogram::fromNode(const dnode &input)
+{
+  std::vector<int> posIndex, negIndex;
+  std::vector<uint64> posCount, negCount;
+
+  readVector(input.getElement("pos_index"), posIndex);
+  readVector(input.getElement("pos_count"), posCount);
+  readVector(input.getElement("neg_index"), negIndex);
+  readVector(input.getElement("neg_count"), negCount);
+
+  if ((posIndex.size() != posCount.size()) || (negIndex.size() != negCount.size()))
+    throw dnError("Invalid histogram state");
+
+  dnLogHistogram res(input.get<double>("accuracy"));
+  res.m_count = input.get<uint64>("count");
+  res.m_zeroCount = input.get<uint64>("zero");
+  for(size_t i=0, epos = posIndex.size(); i != epos; i++)
+    res.m_positive[posIndex[i]] = posCount[i];
+  for(size_t i=0, epos = negIndex.size(); i != epos; i++)
+    res.m_negative[negIndex[i]] = negCount[i];
+
+  *this = res;
+}
+
+// ----------------------------------------------------------------------------
+// dnDistinctCounter
+// ----------------------------------------------------------------------------
+dnDistinctCounter::dnDistinctCounter(uint precision)
+{
+  init(precision);
+}
+
+void dnDistinctCounter::init(uint precision)
+{
+  if ((precision < DSKETCH_MIN_PRECISION) || (precision > DSKETCH_MAX_PRECISION))
+    throw dnError("Invalid distinct counter precision: "+toString(precision));
+
+  m_precision = precision;
+  m_registers.assign(static_cast<size_t>(1) << precision, 0);
+}
+
+void dnDistinctCounter::clear()
+{
+  std::fill(m_registers.begin(), m_registers.end(), 0);
+}
+
+void dnDistinctCounter::add(double value)
+{
+  if (isNan(value))
+    return;
+  if (value == 0.0)
+    value = 0.0; // -0.0 and 0.0 are the same value
+
+  uint64 bits;
+  memcpy(&bits, &value, sizeof(bits));
+  addHash(sketchMix(bits));
+}
+
+void dnDistinctCounter::add(const dnStringRef &text)
+{
+  addHash(sketchMix(sketchTextHash(text.data(), text.length())));
+}
+
+/// Register selected by top bits keeps max position of first 1 bit in remaining bits
+void dnDistinctCounter::addHash(uint64 hash)
+{
+  size_t index = static_cast<size_t>(hash >> (64 - m_precision));
+  uint64 rest = hash << m_precision;
+  byte maxRank = static_cast<byte>(64 - m_precision + 1);
+  byte rank = 1;
+
+  while ((rank < maxRank) && ((rest & 0x8000000000000000ULL) == 0)) {
+    rank++;
+    rest <<= 1;
+  }
+
+  if (rank > m_registers[index])
+    m_registers[index] = rank;
+}
+
+void dnDistinctCounter::merge(const dnDistinctCounter &other)
+{
+  if (m_precision != other.m_precision)
+    throw dnError("Distinct counter precisions differ");
+
+  for(size_t i=0, epos = m_registers.size(); i != epos; i++)
+    if (other.m_registers[i] > m_registers[i])
+      m_registers[i] = other.m_registers[i];
+}
+
+double dnDistinctCounter::estimate() const
+{
+  double m = static_cast<double>(m_registers.size());
+  double alpha;
+
+  switch (m_registers.size()) {
+    case 16: alpha = 0.673; break;
+    case 32: alpha = 0.697; break;
+    case 64: alpha = 0.709; break;
+    default: alpha = 0.7213 / (1.0 + 1.079 / m); break;
+  }
+
+  double sum = 0.0;
+  size_t zeroCount = 0;
+  for(std::vector<byte>::const_iterator it = m_registers.begin(), epos = m_registers.end(); it != epos; ++it) {
+    sum += std::ldexp(1.0, -static_cast<int>(*it));
+    if (*it == 0)
+      zeroCount++;
+  }
+
+  double res = alpha * m * m / sum;
+
+  // small range correction - linear counting
+  if ((res <= 2.5 * m) && (zeroCount > 0))
+    res = m * std::log(m / static_cast<double>(zeroCount));
+
+  return res;
+}
+
+void dnDistinctCounter::toNode(dnode &output) const
+{
+  dnode res(ict_parent);
+  res.addChild("precision", new dnode(m_precision));
+  dnode *registers = new dnode();
+  res.addChild("registers", registers);
+  writeVector(m_registers, vt_byte, *registers);
+  output.swap(res);
+}
+
+void dnDistinctCounter::fromNode(const dnode &input)
+{
+  dnDistinctCounter res(input.get<uint>("precision"));
+  const dnode registers = input.getElement("registers");
+  if (registers.size() != res.m_registers.size())
+    throw dnError("Invalid distinct counter state");
+
+  for(dnode::size_type i=0, epos = registers.size(); i != epos; i++)
+    res.m_registers[i] = static_cast<byte>(registers.get<uint>(i));
+
+  *this = res;
+}
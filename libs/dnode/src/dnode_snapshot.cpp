@@ -0,0 +1,346 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_snapshot.cpp
+// Project:     dtpLib
+// Purpose:     Versioned dnode state with lock-free readers
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cassert>
+
+#include <boost/thread/locks.hpp>
+
+#include "dtp/dnode_snapshot.h"
+
+using namespace dtp;
+using namespace Details;
+
+// ----------------------------------------------------------------------------
+// dnSnapshotReaderSlot
+// ----------------------------------------------------------------------------
+namespace {
+
+/// Epoch of reader which has nothing pinned
+const uint64 DN_SNAPSHOT_IDLE_EPOCH = static_cast<uint64>(-1);
+
+}
+
+namespace dtp {
+namespace Details {
+
+/// Epoch of reader's pinned version, allocated separately to avoid false sharing
+/// with reader's other fields
+struct dnSnapshotReaderSlot {
+  boost::atomic<uint64> epoch;
+  char padding[64];
+
+  dnSnapshotReaderSlot(): epoch(DN_SNAPSHOT_IDLE_EPOCH) {}
+};
+
+} // namespace Details
+} // namespace dtp
+
+// ----------------------------------------------------------------------------
+// dnodeSnapshotVersion
+// ----------------------------------------------------------------------------
+const dnodeSnapshotVersion::size_type dnodeSnapshotVersion::npos = static_cast<dnodeSnapshotVersion::size_type>(-1);
+
+dnodeSnapshotVersion::size_type dnodeSnapshotVersion::indexOfName(const dtpString &name) const
+{
+  name_index::const_iterator it = m_index.find(name);
+  if (it == m_index.end())
+    return npos;
+  return it->second;
+}
+
+const dnode &dnodeSnapshotVersion::get(const dtpString &name) const
+{
+  size_type idx = indexOfName(name);
+  if (idx == npos)
+    throw dnError("Snapshot branch ["+name+"] not found");
+  return *m_branches[idx];
+}
+
+void dnodeSnapshotVersion::copyTo(dnode &output) const
+{
+  dnode res(ict_parent);
+  for(size_type i=0, epos = size(); i != epos; i++)
+    res.addChild(m_names[i], new dnode(*m_branches[i]));
+  output.swap(res);
+}
+
+void dnodeSnapshotVersion::rebuildIndex()
+{
+  m_index.clear();
+  for(size_type i=0, epos = size(); i != epos; i++)
+    m_index.insert(std::make_pair(m_names[i], i));
+}
+
+// ----------------------------------------------------------------------------
+// dnodeSnapshot
+// ----------------------------------------------------------------------------
+dnodeSnapshot::dnodeSnapshot(): m_current(new dnodeSnapshotVersion()), m_epoch(0), m_writerActive(false), m_retiredCount(0)
+{
+}
+
+dnodeSnapshot::~dnodeSnapshot()
+{
+  assert(m_readers.empty());
+  assert(!m_writerActive.load());
+
+  for(std::vector<dnodeSnapshotVersion *>::iterator it = m_retired.begin(), epos = m_retired.end(); it != epos; ++it)
+    delete *it;
+  delete m_current.load();
+}
+
+uint64 dnodeSnapshot::getVersion() const
+{
+  return m_current.load(boost::memory_order_acquire)->getVersion();
+}
+
+size_t dnodeSnapshot::getRetiredCount() const
+{
+  return m_retiredCount.load(boost::memory_order_relaxed);
+}
+
+/// Reader announces epoch before loading current version. Writer advances
+/// epoch after exchanging current version, so a reader which could load
+/// replaced version has epoch not greater than retire epoch of that version.
+const dnodeSnapshotVersion &dnodeSnapshot::pin(dnSnapshotReaderSlot &slot) const
+{
+  slot.epoch.store(m_epoch.load(boost::memory_order_seq_cst), boost::memory_order_seq_cst);
+  return *m_current.load(boost::memory_order_seq_cst);
+}
+
+void dnodeSnapshot::unpin(dnSnapshotReaderSlot &slot) const
+{
+  slot.epoch.store(DN_SNAPSHOT_IDLE_EPOCH, boost::memory_order_release);
+}
+
+void dnodeSnapshot::addReader(dnSnapshotReaderSlot *slot)
+{
+  boost::lock_guard<boost::mutex> guard(m_readersMutex);
+  m_readers.push_back(slot);
+}
+
+void dnodeSnapshot::removeReader(dnSnapshotReaderSlot *slot)
+{
+  boost::lock_guard<boost::mutex> guard(m_readersMutex);
+  m_readers.erase(std::remove(m_readers.begin(), m_readers.end(), slot), m_readers.end());
+}
+
+void dnodeSnapshot::beginWrite()
+{
+  if (m_writerActive.exchange(true))
+    throw dnError("Snapshot writer already exists");
+}
+
+void dnodeSnapshot::endWrite()
+{
+  m_writerActive.store(false);
+}
+
+void dnodeSnapshot::publish(dnodeSnapshotVersion *version)
+{
+  DTP_UNIQUE_PTR(dnodeSnapshotVersion) guard(version);
+  m_retired.reserve(m_retired.size() + 1);
+  guard.release();
+
+  dnodeSnapshotVersion *old = m_current.exchange(version, boost::memory_order_seq_cst);
+  old->m_retireEpoch = m_epoch.fetch_add(1, boost::memory_order_seq_cst);
+  m_retired.push_back(old);
+
+  m_retiredCount.store(m_retired.size(), boost::memory_order_relaxed);
+  reclaim();
+}
+
+uint64 dnodeSnapshot::getMinReaderEpoch()
+{
+  uint64 res = DN_SNAPSHOT_IDLE_EPOCH;
+
+  boost::lock_guard<boost::mutex> guard(m_readersMutex);
+  for(std::vector<dnSnapshotReaderSlot *>::const_iterator it = m_readers.begin(), epos = m_readers.end(); it != epos; ++it)
+    res = std::min(res, (*it)->epoch.load(boost::memory_order_seq_cst));
+
+  return res;
+}
+
+void dnodeSnapshot::reclaim()
+{
+  if (m_retired.empty())
+    return;
+
+  uint64 minEpoch = getMinReaderEpoch();
+
+  std::vector<dnodeSnapshotVersion *>::iterator out = m_retired.begin();
+  for(std::vector<dnodeSnapshotVersion *>::iterator it = m_retired.begin(), epos = m_retired.end(); it != epos; ++it) {
+    if ((*it)->m_retireEpoch < minEpoch)
+      delete *it;
+    else
+      *out++ = *it;
+  }
+
+  m_retired.erase(out, m_retired.end());
+  m_retiredCount.store(m_retired.size(), boost::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+// dnodeSnapshotReader
+// ----------------------------------------------------------------------------
+dnodeSnapshotReader::dnodeSnapshotReader(dnodeSnapshot &snapshot):
+  m_snapshot(snapshot), m_slot(new dnSnapshotReaderSlot()), m_pinned(DTP_NULL), m_pinCount(0)
+{
+  try {
+    m_snapshot.addReader(m_slot);
+  }
+  catch(...) {
+    delete m_slot;
+    throw;
+  }
+}
+
+dnodeSnapshotReader::~dnodeSnapshotReader()
+{
+  m_snapshot.removeReader(m_slot);
+  delete m_slot;
+}
+
+const dnodeSnapshotVersion &dnodeSnapshotReader::pin()
+{
+  if (m_pinCount == 0)
+    m_pinned = &m_snapshot.pin(*m_slot);
+  m_pinCount++;
+  return *m_pinned;
+}
+
+void dnodeSnapshotReader::unpin()
+{
+  assert(m_pinCount > 0);
+  if (--m_pinCount == 0) {
+    m_pinned = DTP_NULL;
+    m_snapshot.unpin(*m_slot);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// dnodeSnapshotWriter
+// ----------------------------------------------------------------------------
+dnodeSnapshotWriter::dnodeSnapshotWriter(dnodeSnapshot &snapshot): m_snapshot(snapshot), m_modified(false)
+{
+  m_snapshot.beginWrite();
+  try {
+    discard();
+  }
+  catch(...) {
+    m_snapshot.endWrite();
+    throw;
+  }
+}
+
+dnodeSnapshotWriter::~dnodeSnapshotWriter()
+{
+  m_snapshot.endWrite();
+}
+
+dnodeSnapshotWriter::size_type dnodeSnapshotWriter::indexOfName(const dtpString &name) const
+{
+  std::vector<dtpString>::const_iterator it = std::find(m_names.begin(), m_names.end(), name);
+  if (it == m_names.end())
+    return dnodeSnapshotVersion::npos;
+  return static_cast<size_type>(it - m_names.begin());
+}
+
+dnodeSnapshotWriter::size_type dnodeSnapshotWriter::findOrAdd(const dtpString &name)
+{
+  size_type idx = indexOfName(name);
+  if (idx == dnodeSnapshotVersion::npos) {
+    m_names.reserve(m_names.size() + 1);
+    m_branches.reserve(m_names.size() + 1);
+    m_private.reserve(m_names.size() + 1);
+
+    idx = size();
+    m_names.push_back(name);
+    m_branches.push_back(dnodeSnapshotVersion::branch_ptr());
+    m_private.push_back(boost::shared_ptr<dnode>());
+  }
+  return idx;
+}
+
+dnode &dnodeSnapshotWriter::modify(const dtpString &name)
+{
+  size_type idx = indexOfName(name);
+  if (idx == dnodeSnapshotVersion::npos)
+    throw dnError("Snapshot branch ["+name+"] not found");
+
+  if (!m_private[idx]) {
+    boost::shared_ptr<dnode> copy(new dnode(*m_branches[idx]));
+    m_private[idx] = copy;
+    m_branches[idx] = copy;
+  }
+
+  m_modified = true;
+  return *m_private[idx];
+}
+
+void dnodeSnapshotWriter::setBranch(const dtpString &name, dnode *value)
+{
+  boost::shared_ptr<dnode> branch(value);
+  size_type idx = findOrAdd(name);
+  m_private[idx] = branch;
+  m_branches[idx] = branch;
+  m_modified = true;
+}
+
+void dnodeSnapshotWriter::setBranch(const dtpString &name, const dnode &value)
+{
+  setBranch(name, new dnode(value));
+}
+
+void dnodeSnapshotWriter::eraseBranch(const dtpString &name)
+{
+  size_type idx = indexOfName(name);
+  if (idx == dnodeSnapshotVersion::npos)
+    return;
+
+  m_names.erase(m_names.begin() + idx);
+  m_branches.erase(m_branches.begin() + idx);
+  m_private.erase(m_private.begin() + idx);
+  m_modified = true;
+}
+
+const dnode &dnodeSnapshotWriter::get(const dtpString &name) const
+{
+  size_type idx = indexOfName(name);
+  if (idx == dnodeSnapshotVersion::npos)
+    throw dnError("Snapshot branch ["+name+"] not found");
+  return *m_branches[idx];
+}
+
+uint64 dnodeSnapshotWriter::publish()
+{
+  DTP_UNIQUE_PTR(dnodeSnapshotVersion) version(new dnodeSnapshotVersion());
+  version->m_version = m_snapshot.getCurrentForWriter().getVersion() + 1;
+  version->m_names = m_names;
+  version->m_branches = m_branches;
+  version->rebuildIndex();
+
+  uint64 res = version->getVersion();
+  m_snapshot.publish(version.release());
+
+  // published branches are visible to readers, next change needs a new copy
+  std::fill(m_private.begin(), m_private.end(), boost::shared_ptr<dnode>());
+  m_modified = false;
+  return res;
+}
+
+void dnodeSnapshotWriter::discard()
+{
+  const dnodeSnapshotVersion &current = m_snapshot.getCurrentForWriter();
+
+  m_names.assign(current.m_names.begin(), current.m_names.end());
+  m_branches.assign(current.m_branches.begin(), current.m_branches.end());
+  m_private.assign(m_names.size(), boost::shared_ptr<dnode>());
+  m_modified = false;
+}
@@ -0,0 +1,368 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_split.cpp
+// Project:     dtpLib
+// Purpose:     Allocation-free string splitting & joining for dnode
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+#include "dtp/dnode_split.h"
+#include "dtp/dnode_cast.h"
+
+using namespace dtp;
+using namespace Details;
+
+namespace {
+
+const size_t DNSPLIT_NUM_BUFFER_SIZE = 64;
+
+inline bool isFieldSpace(char c)
+{
+  return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+}
+
+inline void trimField(const char *&begin, const char *&end)
+{
+  while ((begin != end) && isFieldSpace(*begin))
+    ++begin;
+  while ((begin != end) && isFieldSpace(*(end - 1)))
+    --end;
+}
+
+void throwInvalidNumber(const char *begin, const char *end)
+{
+  throw dnError(dtpString("Invalid number in field: [") + dtpString(begin, end - begin) + "]");
+}
+
+// ----------------------------------------------------------------------------
+// field conversion
+// ----------------------------------------------------------------------------
+template<typename T, bool IsInteger = std::numeric_limits<T>::is_integer>
+struct dnSplitNumberParser {
+  // integers
+  static void parse(const char *begin, const char *end, T &output) {
+    trimField(begin, end);
+    if (begin == end) {
+      output = 0;
+      return;
+    }
+
+    const char *fieldBegin = begin;
+    bool negative = false;
+
+    if ((*begin == '-') || (*begin == '+')) {
+      negative = (*begin == '-');
+      ++begin;
+    }
+
+    if ((begin == end) || (negative && !std::numeric_limits<T>::is_signed))
+      throwInvalidNumber(fieldBegin, end);
+
+    const uint64 limit = negative ?
+      static_cast<uint64>(-(std::numeric_limits<T>::min() + 1)) + 1 :
+      static_cast<uint64>(std::numeric_limits<T>::max());
+
+    uint64 value = 0;
+    uint digit;
+    for(; begin != end; ++begin) {
+      digit = static_cast<uint>(*begin - '0');
+      if ((digit > 9) || (value > (limit - digit) / 10))
+        throwInvalidNumber(fieldBegin, end);
+      value = value * 10 + digit;
+    }
+
+    if (negative)
+      output = static_cast<T>(-static_cast<int64>(value - 1) - 1);
+    else
+      output = static_cast<T>(value);
+  }
+};
+
+template<typename T>
+struct dnSplitNumberParser<T, false> {
+  // floating point
+  static void parse(const char *begin, const char *end, T &output) {
+    trimField(begin, end);
+    if (begin == end) {
+      output = 0;
+      return;
+    }
+
+    size_t len = end - begin;
+    char buffer[DNSPLIT_NUM_BUFFER_SIZE];
+    dtpString longBuffer;
+    const char *text;
+
+    if (len < DNSPLIT_NUM_BUFFER_SIZE) {
+      memcpy(buffer, begin, len);
+      buffer[len] = '\0';
+      text = buffer;
+    } else {
+      longBuffer.assign(begin, len);
+      text = longBuffer.c_str();
+    }
+
+    char *parseEnd;
+    double value = strtod(text, &parseEnd);
+    if (parseEnd != text + len)
+      throwInvalidNumber(begin, end);
+
+    output = static_cast<T>(value);
+  }
+};
+
+template<typename T>
+class dnSplitNumberWriter {
+public:
+  dnSplitNumberWriter(std::vector<T> &output): m_output(output), m_index(0) {}
+
+  void operator()(const dnStringRef &field) {
+    dnSplitNumberParser<T>::parse(field.begin(), field.end(), m_output[m_index++]);
+  }
+private:
+  std::vector<T> &m_output;
+  size_t m_index;
+};
+
+class dnSplitStringWriter {
+public:
+  dnSplitStringWriter(dnodeColn &output): m_output(output), m_index(0) {}
+
+  void operator()(const dnStringRef &field) {
+    m_buffer.assign(field.data(), field.length());
+    if (m_index < m_output.size())
+      m_output[m_index].setAs<dtpString>(m_buffer);
+    else
+      m_output.push_back(new dnode(m_buffer));
+    m_index++;
+  }
+private:
+  dnodeColn &m_output;
+  dtpString m_buffer;
+  size_t m_index;
+};
+
+void prepareArray(dnode &output, dnValueType itemType)
+{
+  if (!output.isArray() || (output.getElementType() != itemType))
+    output.setAsArray(itemType);
+}
+
+template<typename T>
+void explodeNumbers(const dnStringRef &text, const dnSplitSeparator &separator, size_t cnt,
+  dnode &output, dnValueType itemType)
+{
+  prepareArray(output, itemType);
+  std::vector<T> *items = std_vector_cast<T>(output);
+  if (items == DTP_NULL)
+    throw dnError(dtpString("Array type not supported by explode: ") + toString(static_cast<int>(itemType)));
+
+  items->resize(cnt);
+  dnSplitNumberWriter<T> writer(*items);
+  dstr_for_each_field(text, separator, writer);
+}
+
+void explodeStrings(const dnStringRef &text, const dnSplitSeparator &separator, size_t cnt,
+  dnode &output)
+{
+  prepareArray(output, vt_string);
+  dnodeColn &items = dynamic_cast<dnArrayOfDataNode2 *>(output.getArray())->getItems();
+
+  if (items.size() > cnt)
+    items.erase(items.begin() + cnt, items.end());
+  else
+    items.reserve(cnt);
+
+  dnSplitStringWriter writer(items);
+  dstr_for_each_field(text, separator, writer);
+}
+
+template<typename T>
+void implodeFormatted(const std::vector<T> &items, const dnStringRef &separator, const char *format,
+  dtpString &output)
+{
+  const int BUFFER_SIZE = 32;
+  char buffer[BUFFER_SIZE];
+  int len;
+
+  output.reserve(items.size() * (separator.length() + 8));
+  for(typename std::vector<T>::const_iterator it = items.begin(), epos = items.end(); it != epos; ++it) {
+    if (it != items.begin())
+      output.append(separator.data(), separator.length());
+    len = snprintf(buffer, BUFFER_SIZE, format, *it);
+    if (len < 0)
+      throw dnError("Number formatting failed");
+    if (len < BUFFER_SIZE) {
+      output.append(buffer, len);
+    } else {
+      // value longer than buffer - format again with exact size
+      std::vector<char> longBuffer(len + 1);
+      snprintf(&longBuffer[0], longBuffer.size(), format, *it);
+      output.append(&longBuffer[0], len);
+    }
+  }
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// dnSplitSeparator
+// ----------------------------------------------------------------------------
+dnSplitSeparator::dnSplitSeparator(): m_isSet(false)
+{
+  memset(m_charSet, 0, sizeof(m_charSet));
+}
+
+dnSplitSeparator::dnSplitSeparator(const char *text): m_isSet(false)
+{
+  init(dnStringRef(text));
+}
+
+dnSplitSeparator::dnSplitSeparator(const dtpString &text): m_isSet(false)
+{
+  init(dnStringRef(text));
+}
+
+void dnSplitSeparator::init(const dnStringRef &text)
+{
+  if (text.empty())
+    throw dnError("Empty separator");
+  text.assignTo(m_text);
+  memset(m_charSet, 0, sizeof(m_charSet));
+}
+
+dnSplitSeparator dnSplitSeparator::anyOf(const dnStringRef &chars)
+{
+  if (chars.empty())
+    throw dnError("Empty separator set");
+
+  dnSplitSeparator res;
+  res.m_isSet = true;
+  chars.assignTo(res.m_text);
+  for(const char *it = chars.begin(), *epos = chars.end(); it != epos; ++it)
+    res.m_charSet[static_cast<unsigned char>(*it)] = true;
+  return res;
+}
+
+const char *dnSplitSeparator::findAnyOf(const char *begin, const char *end, size_t &sepLength) const
+{
+  sepLength = 1;
+  for(; begin != end; ++begin)
+    if (m_charSet[static_cast<unsigned char>(*begin)])
+      return begin;
+  return end;
+}
+
+const char *dnSplitSeparator::findText(const char *begin, const char *end) const
+{
+  const size_t sepLength = m_text.length();
+  const char *sepData = m_text.data();
+  const char firstChar = sepData[0];
+
+  while (static_cast<size_t>(end - begin) >= sepLength) {
+    const void *found = memchr(begin, firstChar, end - begin - sepLength + 1);
+    if (found == DTP_NULL)
+      break;
+    begin = static_cast<const char *>(found);
+    if (memcmp(begin + 1, sepData + 1, sepLength - 1) == 0)
+      return begin;
+    ++begin;
+  }
+
+  return end;
+}
+
+// ----------------------------------------------------------------------------
+// Function definitions
+// ----------------------------------------------------------------------------
+dnode &dtp::dstr_explode(const dnStringRef &text, const dnSplitSeparator &separator, dnode &output,
+  dnValueType itemType)
+{
+  size_t cnt = dstr_count_fields(text, separator);
+
+  switch (itemType) {
+    case vt_string:
+      explodeStrings(text, separator, cnt, output);
+      break;
+    case vt_int:
+      explodeNumbers<int>(text, separator, cnt, output, itemType);
+      break;
+    case vt_uint:
+      explodeNumbers<uint>(text, separator, cnt, output, itemType);
+      break;
+    case vt_int64:
+      explodeNumbers<int64>(text, separator, cnt, output, itemType);
+      break;
+    case vt_uint64:
+      explodeNumbers<uint64>(text, separator, cnt, output, itemType);
+      break;
+    case vt_float:
+      explodeNumbers<float>(text, separator, cnt, output, itemType);
+      break;
+    case vt_double:
+      explodeNumbers<double>(text, separator, cnt, output, itemType);
+      break;
+    default:
+      throw dnError(dtpString("Item type not supported by explode: ") + toString(static_cast<int>(itemType)));
+  }
+
+  return output;
+}
+
+dnStringRef dtp::dstr_trim(const dnStringRef &text)
+{
+  const char *begin = text.begin();
+  const char *end = text.end();
+  trimField(begin, end);
+  return dnStringRef(begin, end - begin);
+}
+
+double dtp::dstr_to_double(const dnStringRef &text)
+{
+  double res;
+  dnSplitNumberParser<double>::parse(text.begin(), text.end(), res);
+  return res;
+}
+
+dtpString &dtp::dstr_implode(const dnode &input, const dnStringRef &separator, dtpString &output)
+{
+  output.clear();
+
+  if (!input.isContainer()) {
+    if (!input.isNull())
+      output = input.getAs<dtpString>();
+    return output;
+  }
+
+  dnode &source = const_cast<dnode &>(input);
+  if (input.isArray()) {
+    switch (input.getElementType()) {
+      case vt_int:
+        implodeFormatted(*std_vector_cast<int>(source), separator, "%d", output);
+        return output;
+      case vt_uint:
+        implodeFormatted(*std_vector_cast<uint>(source), separator, "%u", output);
+        return output;
+      case vt_double:
+        // 17 significant digits - every double is restored by dstr_explode
+        implodeFormatted(*std_vector_cast<double>(source), separator, "%.17g", output);
+        return output;
+      default:
+        break;
+    }
+  }
+
+  dnode helper;
+  for(dnode::size_type i = 0, epos = input.size(); i != epos; i++)
+  {
+    if (i != 0)
+      output.append(separator.data(), separator.length());
+    output += input.getNode(i, helper).getAs<dtpString>();
+  }
+  return output;
+}
@@ -0,0 +1,500 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_stats.cpp
+// Project:     dtpLib
+// Purpose:     One-pass statistics for dnode arrays & tables
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include "dtp/dnode_stats.h"
+
+using namespace dtp;
+using namespace Details;
+
+// ----------------------------------------------------------------------------
+// dnStatsAccumulator
+// ----------------------------------------------------------------------------
+void dnStatsAccumulator::clear()
+{
+  m_count = 0;
+  m_mean = m_m2 = m_m3 = 0.0;
+  m_min = m_max = 0.0;
+  m_sum = m_sumCorrection = 0.0;
+}
+
+/// Neumaier variant of Kahan summation - keeps low-order bits lost in sum
+void dnStatsAccumulator::addToSum(double value)
+{
+  double newSum = m_sum + value;
+  if (std::fabs(m_sum) >= std::fabs(value))
+    m_sumCorrection += (m_sum - newSum) + value;
+  else
+    m_sumCorrection += (value - newSum) + m_sum;
+  m_sum = newSum;
+}
+
+void dnStatsAccumulator::add(double value)
+{
+  if (m_count == 0) {
+    m_min = m_max = value;
+  } else {
+    if (value < m_min)
+      m_min = value;
+    if (value > m_max)
+      m_max = value;
+  }
+
+  double prevCount = static_cast<double>(m_count);
+  m_count++;
+  double n = static_cast<double>(m_count);
+  double delta = value - m_mean;
+  double deltaN = delta / n;
+  double term = delta * deltaN * prevCount;
+
+  m_mean += deltaN;
+  m_m3 += term * deltaN * (n - 2.0) - 3.0 * deltaN * m_m2;
+  m_m2 += term;
+  addToSum(value);
+}
+
+void dnStatsAccumulator::merge(const dnStatsAccumulator &other)
+{
+  if (other.m_count == 0)
+    return;
+  if (m_count == 0) {
+    *this = other;
+    return;
+  }
+
+  double countA = static_cast<double>(m_count);
+  double countB = static_cast<double>(other.m_count);
+  double n = countA + countB;
+  double delta = other.m_mean - m_mean;
+  double deltaN = delta / n;
+
+  m_m3 = m_m3 + other.m_m3
+    + delta * deltaN * deltaN * countA * countB * (countA - countB)
+    + 3.0 * deltaN * (countA * other.m_m2 - countB * m_m2);
+  m_m2 = m_m2 + other.m_m2 + delta * deltaN * countA * countB;
+  m_mean += deltaN * countB;
+  m_count += other.m_count;
+
+  m_min = std::min(m_min, other.m_min);
+  m_max = std::max(m_max, other.m_max);
+
+  addToSum(other.m_sum);
+  addToSum(other.m_sumCorrection);
+}
+
+double dnStatsAccumulator::variance() const
+{
+  if (m_count == 0)
+    return 0.0;
+  return m_m2 / static_cast<double>(m_count);
+}
+
+double dnStatsAccumulator::sampleVariance() const
+{
+  if (m_count < 2)
+    return 0.0;
+  return m_m2 / static_cast<double>(m_count - 1);
+}
+
+double dnStatsAccumulator::stdDev() const
+{
+  return std::sqrt(variance());
+}
+
+double dnStatsAccumulator::sampleStdDev() const
+{
+  return std::sqrt(sampleVariance());
+}
+
+double dnStatsAccumulator::skewness() const
+{
+  if (m_m2 <= 0.0)
+    return 0.0;
+  return std::sqrt(static_cast<double>(m_count)) * m_m3 / std::pow(m_m2, 1.5);
+}
+
+void dnStatsAccumulator::toNode(dnode &output) const
+{
+  dnode res(ict_parent);
+  res.addChild("count", new dnode(m_count));
+  res.addChild("mean", new dnode(m_mean));
+  res.addChild("m2", new dnode(m_m2));
+  res.addChild("m3", new dnode(m_m3));
+  res.addChild("min", new dnode(m_min));
+  res.addChild("max", new dnode(m_max));
+  res.addChild("sum", new dnode(m_sum));
+  res.addChild("sum_corr", new dnode(m_sumCorrection));
+  output.swap(res);
+}
+
+void dnStatsAccumulator::fromNode(const dnode &input)
+{
+  m_count = input.get<uint64>("count");
+  m_mean = input.get<double>("mean");
+  m_m2 = input.get<double>("m2");
+  m_m3 = input.get<double>("m3");
+  m_min = input.get<double>("min");
+  m_max = input.get<double>("max");
+  m_sum = input.get<double>("sum");
+  m_sumCorrection = input.get<double>("sum_corr");
+}
+
+// ----------------------------------------------------------------------------
+// dnCovarianceAccumulator
+// ----------------------------------------------------------------------------
+void dnCovarianceAccumulator::clear()
+{
+  m_count = 0;
+  m_meanX = m_meanY = 0.0;
+  m_m2X = m_m2Y = m_coMoment = 0.0;
+}
+
+void dnCovarianceAccumulator::add(double x, double y)
+{
+  m_count++;
+  double n = static_cast<double>(m_count);
+  double deltaX = x - m_meanX;
+  double deltaY = y - m_meanY;
+
+  m_meanX += deltaX / n;
+  m_meanY += deltaY / n;
+  m_m2X += deltaX * (x - m_meanX);
+  m_m2Y += deltaY * (y - m_meanY);
+  m_coMoment += deltaX * (y - m_meanY);
+}
+
+void dnCovarianceAccumulator::merge(const dnCovarianceAccumulator &other)
+{
+  if (other.m_count == 0)
+    return;
+  if (m_count == 0) {
+    *this = other;
+    return;
+  }
+
+  double countA = static_cast<double>(m_count);
+  double countB = static_cast<double>(other.m_count);
+  double n = countA + countB;
+  double deltaX = other.m_meanX - m_meanX;
+  double deltaY = other.m_meanY - m_meanY;
+  double factor = countA * countB / n;
+
+  m_m2X += other.m_m2X + deltaX * deltaX * factor;
+  m_m2Y += other.m_m2Y + deltaY * deltaY * factor;
+  m_coMoment += other.m_coMoment + deltaX * deltaY * factor;
+  m_meanX += deltaX * countB / n;
+  m_meanY += deltaY * countB / n;
+  m_count += other.m_count;
+}
+
+double dnCovarianceAccumulator::covariance() const
+{
+  if (m_count == 0)
+    return 0.0;
+  return m_coMoment / static_cast<double>(m_count);
+}
+
+double dnCovarianceAccumulator::sampleCovariance() const
+{
+  if (m_count < 2)
+    return 0.0;
+  return m_coMoment / static_cast<double>(m_count - 1);
+}
+
+double dnCovarianceAccumulator::correlation() const
+{
+  if ((m_m2X <= 0.0) || (m_m2Y <= 0.0))
+    return 0.0;
+  return m_coMoment / std::sqrt(m_m2X * m_m2Y);
+}
+
+void dnCovarianceAccumulator::toNode(dnode &output) const
+{
+  dnode res(ict_parent);
+  res.addChild("count", new dnode(m_count));
+  res.addChild("mean_x", new dnode(m_meanX));
+  res.addChild("mean_y", new dnode(m_meanY));
+  res.addChild("m2_x", new dnode(m_m2X));
+  res.addChild("m2_y", new dnode(m_m2Y));
+  res.addChild("co_moment", new dnode(m_coMoment));
+  output.swap(res);
+}
+
+void dnCovarianceAccumulator::fromNode(const dnode &input)
+{
+  m_count = input.get<uint64>("count");
+  m_meanX = input.get<double>("mean_x");
+  m_meanY = input.get<double>("mean_y");
+  m_m2X = input.get<double>("m2_x");
+  m_m2Y = input.get<double>("m2_y");
+  m_coMoment = input.get<double>("co_moment");
+}
+
+// ----------------------------------------------------------------------------
+// value readers
+// ----------------------------------------------------------------------------
+namespace {
+
+typedef dnode::size_type size_type;
+
+/// Reads container items or field of rows as double values.
+/// Arrays of numbers are read directly from their vectors.
+class dnStatsReader {
+public:
+  dnStatsReader(const dnode &input, const dtpString *fieldName):
+    m_input(input), m_fieldName(fieldName), m_podType(vt_undefined), m_items(DTP_NULL)
+  {
+    if (!input.isContainer())
+      throw dnError("Container expected as statistics input");
+
+    m_size = input.size();
+    if ((fieldName == DTP_NULL) && input.isArray() && (m_size > 0))
+      initPod(input.getArrayR());
+  }
+
+  size_type size() const { return m_size; }
+
+  /// Returns <false> if value is null or missing
+  bool read(size_type index, double &output)
+  {
+    switch (m_podType) {
+      case vt_byte: output = podItem<byte>(index); return true;
+      case vt_int: output = podItem<int>(index); return true;
+      case vt_uint: output = podItem<uint>(index); return true;
+      case vt_float: output = podItem<float>(index); return true;
+      case vt_double: output = podItem<double>(index); return true;
+      case vt_xdouble: output = podItem<xdouble>(index); return true;
+      default: return readNode(index, output);
+    }
+  }
+
+  void addRange(size_type first, size_type last, dnStatsAccumulator &output)
+  {
+    switch (m_podType) {
+      case vt_byte: addPodRange<byte>(first, last, output); break;
+      case vt_int: addPodRange<int>(first, last, output); break;
+      case vt_uint: addPodRange<uint>(first, last, output); break;
+      case vt_float: addPodRange<float>(first, last, output); break;
+      case vt_double: addPodRange<double>(first, last, output); break;
+      case vt_xdouble: addPodRange<xdouble>(first, last, output); break;
+      default: {
+        double value;
+        for(size_type i = first; i != last; i++)
+          if (readNode(i, value))
+            output.add(value);
+        break;
+      }
+    }
+  }
+protected:
+  template<typename T>
+  void setPod(const dnArray *arr)
+  {
+    m_items = &(checked_cast<const dnArrayOfPod<T> *>(arr)->getItems()[0]);
+  }
+
+  void initPod(const dnArray *arr)
+  {
+    m_podType = arr->getValueType();
+    switch (m_podType) {
+      case vt_byte: setPod<byte>(arr); break;
+      case vt_int: setPod<int>(arr); break;
+      case vt_uint: setPod<uint>(arr); break;
+      case vt_float: setPod<float>(arr); break;
+      case vt_double: setPod<double>(arr); break;
+      case vt_xdouble: setPod<xdouble>(arr); break;
+      default:
+        m_podType = vt_undefined;
+        break;
+    }
+  }
+
+  template<typename T>
+  double podItem(size_type index) const
+  {
+    return static_cast<double>(static_cast<const T *>(m_items)[index]);
+  }
+
+  template<typename T>
+  void addPodRange(size_type first, size_type last, dnStatsAccumulator &output) const
+  {
+    const T *items = static_cast<const T *>(m_items);
+    for(size_type i = first; i != last; i++)
+      output.add(static_cast<double>(items[i]));
+  }
+
+  bool readNode(size_type index, double &output)
+  {
+    const dnode *item = m_input.getNodePtrR(index, m_helper);
+    if (m_fieldName != DTP_NULL) {
+      item = item->peekChildR(*m_fieldName);
+      if (item == DTP_NULL)
+        return false;
+    }
+
+    if (item->isNull())
+      return false;
+
+    output = item->getAs<double>();
+    return true;
+  }
+private:
+  const dnode &m_input;
+  const dtpString *m_fieldName;
+  size_type m_size;
+  int m_podType;
+  const void *m_items;
+  dnode m_helper;
+};
+
+/// Input of statistics function: single series or pairs
+struct dnStatsInput {
+  const dnode *inputX;
+  const dtpString *fieldX;
+  const dnode *inputY;
+  const dtpString *fieldY;
+
+  dnStatsInput(const dnode &aInputX, const dtpString *aFieldX):
+    inputX(&aInputX), fieldX(aFieldX), inputY(DTP_NULL), fieldY(DTP_NULL) {}
+  dnStatsInput(const dnode &aInputX, const dtpString *aFieldX, const dnode &aInputY, const dtpString *aFieldY):
+    inputX(&aInputX), fieldX(aFieldX), inputY(&aInputY), fieldY(aFieldY) {}
+
+  size_type size() const
+  {
+    size_type res = inputX->size();
+    if ((inputY != DTP_NULL) && (inputY->size() != res))
+      throw dnError("Statistics inputs differ in size");
+    return res;
+  }
+};
+
+void addRange(const dnStatsInput &input, size_type first, size_type last, dnStatsAccumulator &output)
+{
+  dnStatsReader reader(*input.inputX, input.fieldX);
+  reader.addRange(first, last, output);
+}
+
+void addRange(const dnStatsInput &input, size_type first, size_type last, dnCovarianceAccumulator &output)
+{
+  dnStatsReader readerX(*input.inputX, input.fieldX);
+  dnStatsReader readerY(*input.inputY, input.fieldY);
+  double x, y;
+
+  for(size_type i = first; i != last; i++)
+    if (readerX.read(i, x) && readerY.read(i, y))
+      output.add(x, y);
+}
+
+// ----------------------------------------------------------------------------
+// parallel reduce
+// ----------------------------------------------------------------------------
+const uint DSTAT_TASKS_PER_THREAD = 4;
+
+template<class Accumulator>
+class dnStatsRangeTask: public dnParallelTask {
+public:
+  dnStatsRangeTask(size_type first, size_type last, const dnStatsInput &input):
+    m_first(first), m_last(last), m_input(input) {}
+
+  virtual void run() { addRange(m_input, m_first, m_last, m_result); }
+  const Accumulator &getResult() const { return m_result; }
+private:
+  size_type m_first;
+  size_type m_last;
+  const dnStatsInput &m_input;
+  Accumulator m_result;
+};
+
+/// Splits input into ranges reduced on pool threads, partial results are
+/// merged in range order.
+template<class Accumulator>
+void reduce(const dnStatsInput &input, Accumulator &output, const dnParallelOptions &options)
+{
+  size_type itemCount = input.size();
+  dnThreadPool &pool = (options.pool != DTP_NULL) ? *options.pool : dnThreadPool::getDefault();
+
+  if ((itemCount < options.minParallelItems) || (itemCount < 2) || (pool.getConcurrency() < 2)) {
+    addRange(input, 0, itemCount, output);
+    return;
+  }
+
+  size_type taskCount = std::min<size_type>(itemCount, pool.getConcurrency() * DSTAT_TASKS_PER_THREAD);
+  boost::ptr_vector<dnStatsRangeTask<Accumulator> > tasks;
+  std::vector<dnParallelTask *> taskPtrs;
+
+  tasks.reserve(taskCount);
+  taskPtrs.reserve(taskCount);
+
+  for(size_type i=0; i != taskCount; i++) {
+    size_type first = static_cast<size_type>(static_cast<uint64>(itemCount) * i / taskCount);
+    size_type last = static_cast<size_type>(static_cast<uint64>(itemCount) * (i + 1) / taskCount);
+    tasks.push_back(new dnStatsRangeTask<Accumulator>(first, last, input));
+    taskPtrs.push_back(&tasks.back());
+  }
+
+  pool.execute(&taskPtrs[0], taskPtrs.size());
+
+  for(size_type i=0; i != taskCount; i++)
+    output.merge(tasks[i].getResult());
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// functions
+// ----------------------------------------------------------------------------
+void dtp::dstat_array(const dnode &input, dnStatsAccumulator &output)
+{
+  dnStatsInput statsInput(input, DTP_NULL);
+  addRange(statsInput, 0, statsInput.size(), output);
+}
+
+void dtp::dstat_column(const dnode &table, const dtpString &fieldName, dnStatsAccumulator &output)
+{
+  dnStatsInput statsInput(table, &fieldName);
+  addRange(statsInput, 0, statsInput.size(), output);
+}
+
+void dtp::dstat_covariance(const dnode &inputX, const dnode &inputY, dnCovarianceAccumulator &output)
+{
+  dnStatsInput statsInput(inputX, DTP_NULL, inputY, DTP_NULL);
+  addRange(statsInput, 0, statsInput.size(), output);
+}
+
+void dtp::dstat_covariance_columns(const dnode &table, const dtpString &fieldX, const dtpString &fieldY, dnCovarianceAccumulator &output)
+{
+  dnStatsInput statsInput(table, &fieldX, table, &fieldY);
+  addRange(statsInput, 0, statsInput.size(), output);
+}
+
+void dtp::dpar_stat_array(const dnode &input, dnStatsAccumulator &output, const dnParallelOptions &options)
+{
+  reduce(dnStatsInput(input, DTP_NULL), output, options);
+}
+
+void dtp::dpar_stat_column(const dnode &table, const dtpString &fieldName, dnStatsAccumulator &output, const dnParallelOptions &options)
+{
+  reduce(dnStatsInput(table, &fieldName), output, options);
+}
+
+void dtp::dpar_stat_covariance(const dnode &inputX, const dnode &inputY, dnCovarianceAccumulator &output, const dnParallelOptions &options)
+{
+  reduce(dnStatsInput(inputX, DTP_NULL, inputY, DTP_NULL), output, options);
+}
+
+void dtp::dpar_stat_covariance_columns(const dnode &table, const dtpString &fieldX, const dtpString &fieldY, dnCovarianceAccumulator &output,
+  const dnParallelOptions &options)
+{
+  reduce(dnStatsInput(table, &fieldX, table, &fieldY), output, options);
+}
@@ -0,0 +1,345 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_string_pool.cpp
+// Project:     dtpLib
+// Purpose:     Array of strings packed into one contiguous character buffer
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <algorithm>
+
+#include "dtp/dnode_string_pool.h"
+
+using namespace dtp;
+using namespace Details;
+
+namespace {
+
+// compares two items of pool by bytes, shorter prefix goes first
+class dnStringPoolLess {
+public:
+  dnStringPoolLess(const char *data, const dnStringPool::offset_vector &offsets): m_data(data), m_offsets(offsets) {}
+
+  bool operator()(dnStringPool::size_type lhs, dnStringPool::size_type rhs) const {
+    const dnStringPool::size_type lhsLen = m_offsets[lhs + 1] - m_offsets[lhs] - 1;
+    const dnStringPool::size_type rhsLen = m_offsets[rhs + 1] - m_offsets[rhs] - 1;
+    int res = memcmp(m_data + m_offsets[lhs], m_data + m_offsets[rhs], std::min(lhsLen, rhsLen));
+    if (res != 0)
+      return (res < 0);
+    return (lhsLen < rhsLen);
+  }
+private:
+  const char *m_data;
+  const dnStringPool::offset_vector &m_offsets;
+};
+
+class dnStringPoolFieldWriter {
+public:
+  dnStringPoolFieldWriter(dnStringPool &output): m_output(output) {}
+  void operator()(const dnStringRef &field) { m_output.push_back(field); }
+private:
+  dnStringPool &m_output;
+};
+
+inline bool csvNeedsQuotes(const dnStringRef &field, char sepChar, char quoteChar)
+{
+  for(const char *it = field.begin(), *epos = field.end(); it != epos; ++it)
+    if ((*it == sepChar) || (*it == quoteChar) || (*it == '\r') || (*it == '\n'))
+      return true;
+  return false;
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// dnStringPool
+// ----------------------------------------------------------------------------
+dnStringPool::dnStringPool()
+{
+  m_offsets.push_back(0);
+}
+
+void dnStringPool::reserve(size_type itemCount, size_type charCount)
+{
+  m_offsets.reserve(itemCount + 1);
+  m_data.reserve(charCount + itemCount);
+}
+
+void dnStringPool::clear()
+{
+  m_data.clear();
+  m_offsets.resize(1);
+}
+
+void dnStringPool::resize(size_type newSize)
+{
+  size_type oldSize = size();
+  if (newSize < oldSize) {
+    m_data.resize(m_offsets[newSize]);
+    m_offsets.resize(newSize + 1);
+  } else if (newSize > oldSize) {
+    m_data.reserve(m_data.size() + newSize - oldSize);
+    m_offsets.reserve(newSize + 1);
+    for(size_type i = oldSize; i != newSize; i++)
+      endItem();
+  }
+}
+
+void dnStringPool::shrinkToFit()
+{
+  if (m_data.capacity() > m_data.size())
+    data_vector(m_data).swap(m_data);
+  if (m_offsets.capacity() > m_offsets.size())
+    offset_vector(m_offsets).swap(m_offsets);
+}
+
+void dnStringPool::swap(dnStringPool &other)
+{
+  m_data.swap(other.m_data);
+  m_offsets.swap(other.m_offsets);
+}
+
+dnStringPool::size_type dnStringPool::memoryUsed() const
+{
+  return sizeof(*this) + m_data.capacity() + m_offsets.capacity() * sizeof(size_type);
+}
+
+void dnStringPool::pop_back()
+{
+  if (empty())
+    throw dnError("Pool is empty");
+  m_offsets.pop_back();
+  m_data.resize(m_offsets.back());
+}
+
+void dnStringPool::set(size_type index, const dnStringRef &value)
+{
+  checkIndex(index);
+
+  if (isInData(value.data())) {
+    dtpString temp(value.data(), value.length());
+    set(index, dnStringRef(temp));
+    return;
+  }
+
+  const size_type start = m_offsets[index];
+  const size_type oldLen = m_offsets[index + 1] - start - 1;
+  const size_type newLen = value.length();
+
+  if (newLen == oldLen) {
+    if (newLen > 0)
+      memcpy(&m_data[start], value.data(), newLen);
+    return;
+  }
+
+  if (newLen < oldLen) {
+    memcpy(&m_data[start], value.data(), newLen);
+    m_data.erase(m_data.begin() + (start + newLen), m_data.begin() + (start + oldLen));
+    const size_type delta = oldLen - newLen;
+    for(size_type i = index + 1, epos = m_offsets.size(); i != epos; i++)
+      m_offsets[i] -= delta;
+  } else {
+    memcpy(&m_data[start], value.data(), oldLen);
+    m_data.insert(m_data.begin() + (start + oldLen), value.begin() + oldLen, value.end());
+    const size_type delta = newLen - oldLen;
+    for(size_type i = index + 1, epos = m_offsets.size(); i != epos; i++)
+      m_offsets[i] += delta;
+  }
+}
+
+dnStringPool::size_type dnStringPool::find(const dnStringRef &value, size_type startPos) const
+{
+  // compared size includes terminator, so the item must have the same length
+  const size_type valueSize = value.length() + 1;
+  const char *valueData = value.data();
+
+  for(size_type i = startPos, epos = size(); i < epos; i++) {
+    if (m_offsets[i + 1] - m_offsets[i] != valueSize)
+      continue;
+    if (memcmp(&m_data[m_offsets[i]], valueData, valueSize - 1) == 0)
+      return i;
+  }
+
+  return dnode::npos;
+}
+
+void dnStringPool::sort()
+{
+  const size_type n = size();
+  if (n < 2)
+    return;
+
+  std::vector<size_type> order(n);
+  for(size_type i = 0; i != n; i++)
+    order[i] = i;
+
+  std::sort(order.begin(), order.end(), dnStringPoolLess(&m_data[0], m_offsets));
+
+  data_vector newData;
+  offset_vector newOffsets;
+  newData.resize(m_data.size());
+  newOffsets.reserve(m_offsets.size());
+  newOffsets.push_back(0);
+
+  size_type writePos = 0;
+  size_type itemSize;
+  for(size_type i = 0; i != n; i++) {
+    itemSize = m_offsets[order[i] + 1] - m_offsets[order[i]];
+    memcpy(&newData[writePos], &m_data[m_offsets[order[i]]], itemSize);
+    writePos += itemSize;
+    newOffsets.push_back(writePos);
+  }
+
+  m_data.swap(newData);
+  m_offsets.swap(newOffsets);
+}
+
+dtpString &dnStringPool::implode(const dnStringRef &separator, dtpString &output) const
+{
+  output.clear();
+  const size_type n = size();
+  if (n == 0)
+    return output;
+
+  output.reserve(m_data.size() - n + (n - 1) * separator.length());
+  for(size_type i = 0; i != n; i++) {
+    if (i != 0)
+      output.append(separator.data(), separator.length());
+    output.append(&m_data[m_offsets[i]], m_offsets[i + 1] - m_offsets[i] - 1);
+  }
+  return output;
+}
+
+void dnStringPool::explode(const dnStringRef &text, const dnSplitSeparator &separator)
+{
+  clear();
+  m_data.reserve(text.length() + 1);
+  dnStringPoolFieldWriter writer(*this);
+  dstr_for_each_field(text, separator, writer);
+}
+
+dtpString &dnStringPool::writeCsvLine(dtpString &output, char sepChar, char quoteChar, bool forceQuoted) const
+{
+  output.clear();
+  const size_type n = size();
+  if (n == 0)
+    return output;
+
+  output.reserve(m_data.size() + 2 * n);
+  dnStringRef field;
+  for(size_type i = 0; i != n; i++) {
+    if (i != 0)
+      output += sepChar;
+    field = dnStringRef(&m_data[m_offsets[i]], m_offsets[i + 1] - m_offsets[i] - 1);
+    if (forceQuoted || csvNeedsQuotes(field, sepChar, quoteChar)) {
+      output += quoteChar;
+      for(const char *it = field.begin(), *epos = field.end(); it != epos; ++it) {
+        if (*it == quoteChar)
+          output += quoteChar;
+        output += *it;
+      }
+      output += quoteChar;
+    } else {
+      output.append(field.data(), field.length());
+    }
+  }
+  return output;
+}
+
+void dnStringPool::readCsvLine(const dnStringRef &line, char sepChar, char quoteChar)
+{
+  clear();
+  m_data.reserve(line.length() + 1);
+
+  const char *pos = line.begin();
+  const char *epos = line.end();
+  const char *fieldEnd;
+
+  if (pos == epos)
+    return;
+
+  for(;;) {
+    if (*pos == quoteChar) {
+      ++pos;
+      for(;;) {
+        fieldEnd = static_cast<const char *>(memchr(pos, quoteChar, epos - pos));
+        if (fieldEnd == DTP_NULL)
+          throw dnError(dtpString("Unterminated quote in CSV line: [") + line.str() + "]");
+        appendChars(pos, fieldEnd);
+        pos = fieldEnd + 1;
+        if ((pos != epos) && (*pos == quoteChar)) {
+          appendChar(quoteChar);
+          ++pos;
+        } else {
+          break;
+        }
+      }
+      // text between closing quote and separator is kept as is
+      fieldEnd = static_cast<const char *>(memchr(pos, sepChar, epos - pos));
+      if (fieldEnd == DTP_NULL)
+        fieldEnd = epos;
+      appendChars(pos, fieldEnd);
+    } else {
+      fieldEnd = static_cast<const char *>(memchr(pos, sepChar, epos - pos));
+      if (fieldEnd == DTP_NULL)
+        fieldEnd = epos;
+      appendChars(pos, fieldEnd);
+    }
+    endItem();
+
+    if (fieldEnd == epos)
+      break;
+    pos = fieldEnd + 1;
+    if (pos == epos) {
+      // trailing separator gives empty last field
+      endItem();
+      break;
+    }
+  }
+}
+
+void dnStringPool::fromArray(const dnode &input)
+{
+  clear();
+
+  if (!input.isContainer()) {
+    if (!input.isNull())
+      push_back(dnStringRef(input.getAs<dtpString>()));
+    return;
+  }
+
+  const size_type n = input.size();
+  m_offsets.reserve(n + 1);
+
+  dtpString buffer;
+  dnode helper;
+  for(size_type i = 0; i != n; i++) {
+    buffer = input.getNode(i, helper).getAs<dtpString>();
+    push_back(dnStringRef(buffer));
+  }
+}
+
+void dnStringPool::toArray(dnode &output) const
+{
+  if (!output.isArray() || (output.getElementType() != vt_string))
+    output.setAsArray(vt_string);
+
+  dnodeColn &items = dynamic_cast<dnArrayOfDataNode2 *>(output.getArray())->getItems();
+  const size_type n = size();
+
+  if (items.size() > n)
+    items.erase(items.begin() + n, items.end());
+  else
+    items.reserve(n);
+
+  dtpString buffer;
+  for(size_type i = 0; i != n; i++) {
+    buffer.assign(&m_data[m_offsets[i]], m_offsets[i + 1] - m_offsets[i] - 1);
+    if (i < items.size())
+      items[i].setAs<dtpString>(buffer);
+    else
+      items.push_back(new dnode(buffer));
+  }
+}
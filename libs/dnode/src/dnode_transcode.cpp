@@ -0,0 +1,889 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_transcode.cpp
+// Project:     dtpLib
+// Purpose:     Streaming transcoder between JSON, BION, CSV and structure outputs
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <climits>
+#include <cstdio>
+
+#include "dtp/dnode_transcode.h"
+
+using namespace dtp;
+using namespace base;
+
+#define DTC_STRING_TO_UCHAR(a) reinterpret_cast<const unsigned char *>((a).c_str())
+
+// ----------------------------------------------------------------------------
+// dnStructureOutputJson
+// ----------------------------------------------------------------------------
+dnStructureOutputJson::dnStructureOutputJson(yajl_gen *context, std::ostream *output, size_t flushSize):
+  m_context(context), m_output(output), m_flushSize(flushSize), m_bytesWritten(0)
+{
+}
+
+void dnStructureOutputJson::accept(StructureWriterIntf &writer)
+{
+  writer.visit(*this);
+}
+
+void dnStructureOutputJson::flush()
+{
+  if (m_output == DTP_NULL)
+    return;
+
+  const unsigned char * buf;
+  unsigned int len;
+  yajl_gen_get_buf(*m_context, &buf, &len);
+  if (len > 0) {
+    m_output->write(reinterpret_cast<const char *>(buf), len);
+    m_bytesWritten += len;
+    yajl_gen_clear(*m_context);
+  }
+}
+
+void dnStructureOutputJson::checkFlush()
+{
+  if (m_output == DTP_NULL)
+    return;
+
+  const unsigned char * buf;
+  unsigned int len;
+  yajl_gen_get_buf(*m_context, &buf, &len);
+  if (len >= m_flushSize)
+    flush();
+}
+
+void dnStructureOutputJson::writeNumberText(const dtpString &text)
+{
+  yajl_gen_number(*m_context, text.c_str(), text.length());
+  checkFlush();
+}
+
+void dnStructureOutputJson::beginWrite()
+{
+}
+
+void dnStructureOutputJson::endWrite()
+{
+  flush();
+}
+
+void dnStructureOutputJson::beginMap()
+{
+  yajl_gen_map_open(*m_context);
+}
+
+void dnStructureOutputJson::endMap()
+{
+  yajl_gen_map_close(*m_context);
+  checkFlush();
+}
+
+void dnStructureOutputJson::beginArray(size_t size)
+{
+  yajl_gen_array_open(*m_context);
+}
+
+void dnStructureOutputJson::beginArrayOf(const std::string &valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputJson::beginArrayOf(float valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputJson::beginArrayOf(double valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputJson::beginArrayOf(xdouble valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputJson::beginArrayOf(bool valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputJson::beginArrayOf(byte valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputJson::beginArrayOf(int valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputJson::beginArrayOf(uint valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputJson::beginArrayOf(int64 valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputJson::beginArrayOf(uint64 valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputJson::endArray()
+{
+  yajl_gen_array_close(*m_context);
+  checkFlush();
+}
+
+void dnStructureOutputJson::writeKeyName(const std::string &name)
+{
+  yajl_gen_string(*m_context, DTC_STRING_TO_UCHAR(name), name.length());
+}
+
+void dnStructureOutputJson::writeValue(const std::string &value)
+{
+  yajl_gen_string(*m_context, DTC_STRING_TO_UCHAR(value), value.length());
+  checkFlush();
+}
+
+void dnStructureOutputJson::writeValue(float value)
+{
+  yajl_gen_double(*m_context, value);
+  checkFlush();
+}
+
+void dnStructureOutputJson::writeValue(double value)
+{
+  yajl_gen_double(*m_context, value);
+  checkFlush();
+}
+
+void dnStructureOutputJson::writeValue(xdouble value)
+{
+  yajl_gen_double(*m_context, static_cast<double>(value));
+  checkFlush();
+}
+
+void dnStructureOutputJson::writeValue(byte value)
+{
+  yajl_gen_integer(*m_context, value);
+  checkFlush();
+}
+
+void dnStructureOutputJson::writeValue(int value)
+{
+  yajl_gen_integer(*m_context, value);
+  checkFlush();
+}
+
+void dnStructureOutputJson::writeValue(uint value)
+{
+  if (value <= static_cast<uint>(LONG_MAX)) {
+    yajl_gen_integer(*m_context, static_cast<long>(value));
+    checkFlush();
+  } else {
+    writeNumberText(toString(value, m_numBuffer));
+  }
+}
+
+void dnStructureOutputJson::writeValue(int64 value)
+{
+  if ((value >= LONG_MIN) && (value <= LONG_MAX)) {
+    yajl_gen_integer(*m_context, static_cast<long>(value));
+    checkFlush();
+  } else {
+    writeNumberText(toString(value, m_numBuffer));
+  }
+}
+
+void dnStructureOutputJson::writeValue(uint64 value)
+{
+  if (value <= static_cast<uint64>(LONG_MAX)) {
+    yajl_gen_integer(*m_context, static_cast<long>(value));
+    checkFlush();
+  } else {
+    writeNumberText(toString(value, m_numBuffer));
+  }
+}
+
+void dnStructureOutputJson::writeValue(bool value)
+{
+  yajl_gen_bool(*m_context, value ? 1 : 0);
+  checkFlush();
+}
+
+void dnStructureOutputJson::writeNullValue()
+{
+  yajl_gen_null(*m_context);
+  checkFlush();
+}
+
+// ----------------------------------------------------------------------------
+// dnStructureOutputBion
+// ----------------------------------------------------------------------------
+void dnStructureOutputBion::writeListMarker()
+{
+  m_bionWriter.writeValue(static_cast<int>(dbatList));
+}
+
+void dnStructureOutputBion::beginArray(size_t size)
+{
+  base::StructureOutputBion::beginArray(size);
+  writeListMarker();
+}
+
+void dnStructureOutputBion::beginArrayOf(const std::string &valueTag, size_t size)
+{
+  // strings are always written as variable array
+  base::StructureOutputBion::beginArrayOf(valueTag, size);
+  writeListMarker();
+}
+
+void dnStructureOutputBion::beginArrayOf(float valueTag, size_t size)
+{
+  beginTypedArray(valueTag, size);
+}
+
+void dnStructureOutputBion::beginArrayOf(double valueTag, size_t size)
+{
+  beginTypedArray(valueTag, size);
+}
+
+void dnStructureOutputBion::beginArrayOf(xdouble valueTag, size_t size)
+{
+  beginTypedArray(valueTag, size);
+}
+
+void dnStructureOutputBion::beginArrayOf(bool valueTag, size_t size)
+{
+  beginTypedArray(valueTag, size);
+}
+
+void dnStructureOutputBion::beginArrayOf(byte valueTag, size_t size)
+{
+  beginTypedArray(valueTag, size);
+}
+
+void dnStructureOutputBion::beginArrayOf(int valueTag, size_t size)
+{
+  beginTypedArray(valueTag, size);
+}
+
+void dnStructureOutputBion::beginArrayOf(uint valueTag, size_t size)
+{
+  beginTypedArray(valueTag, size);
+}
+
+void dnStructureOutputBion::beginArrayOf(int64 valueTag, size_t size)
+{
+  beginTypedArray(valueTag, size);
+}
+
+void dnStructureOutputBion::beginArrayOf(uint64 valueTag, size_t size)
+{
+  beginTypedArray(valueTag, size);
+}
+
+// ----------------------------------------------------------------------------
+// dnStructureOutputCsv
+// ----------------------------------------------------------------------------
+dnStructureOutputCsv::dnStructureOutputCsv(std::ostream &output, char sepChar, char quoteChar):
+  m_output(output), m_sepChar(sepChar), m_quoteChar(quoteChar), m_level(clvNone), m_headerWritten(false)
+{
+}
+
+void dnStructureOutputCsv::accept(StructureWriterIntf &writer)
+{
+  writer.visit(*this);
+}
+
+void dnStructureOutputCsv::throwNotFlat() const
+{
+  throw dnError("CSV output requires list of flat maps");
+}
+
+void dnStructureOutputCsv::writeLine(const dnStringPool &fields)
+{
+  fields.writeCsvLine(m_lineBuffer, m_sepChar, m_quoteChar);
+  m_lineBuffer += '\n';
+  m_output.write(m_lineBuffer.data(), m_lineBuffer.length());
+}
+
+void dnStructureOutputCsv::setField(const dtpString &value)
+{
+  if (m_level != clvRow)
+    throwNotFlat();
+
+  std::map<dtpString, size_t>::const_iterator it = m_columns.find(m_key);
+  if (m_headerWritten) {
+    if (it == m_columns.end())
+      throw dnError("Unknown CSV column: [" + m_key + "]");
+    m_row[it->second] = value;
+  } else {
+    // first row defines columns
+    if (it != m_columns.end())
+      throw dnError("Duplicated CSV column: [" + m_key + "]");
+    m_columns.insert(std::make_pair(m_key, m_row.size()));
+    m_header.push_back(dnStringRef(m_key));
+    m_row.push_back(value);
+  }
+}
+
+void dnStructureOutputCsv::setDoubleField(double value)
+{
+  // 17 significant digits - value is restored exactly when parsed
+  char buffer[32];
+  int len = snprintf(buffer, sizeof(buffer), "%.17g", value);
+  m_numBuffer.assign(buffer, len);
+  setField(m_numBuffer);
+}
+
+void dnStructureOutputCsv::beginWrite()
+{
+  m_level = clvNone;
+  m_headerWritten = false;
+  m_header.clear();
+  m_columns.clear();
+  m_row.clear();
+}
+
+void dnStructureOutputCsv::endWrite()
+{
+  m_output.flush();
+}
+
+void dnStructureOutputCsv::beginMap()
+{
+  if (m_level != clvList)
+    throwNotFlat();
+  m_level = clvRow;
+}
+
+void dnStructureOutputCsv::endMap()
+{
+  if (!m_headerWritten) {
+    writeLine(m_header);
+    m_headerWritten = true;
+  }
+
+  m_fields.clear();
+  for(std::vector<dtpString>::iterator it = m_row.begin(), epos = m_row.end(); it != epos; ++it) {
+    m_fields.push_back(dnStringRef(*it));
+    it->clear();
+  }
+  writeLine(m_fields);
+  m_level = clvList;
+}
+
+void dnStructureOutputCsv::beginArray(size_t size)
+{
+  if (m_level != clvNone)
+    throwNotFlat();
+  m_level = clvList;
+}
+
+void dnStructureOutputCsv::beginArrayOf(const std::string &valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputCsv::beginArrayOf(float valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputCsv::beginArrayOf(double valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputCsv::beginArrayOf(xdouble valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputCsv::beginArrayOf(bool valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputCsv::beginArrayOf(byte valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputCsv::beginArrayOf(int valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputCsv::beginArrayOf(uint valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputCsv::beginArrayOf(int64 valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputCsv::beginArrayOf(uint64 valueTag, size_t size)
+{
+  beginArray(size);
+}
+
+void dnStructureOutputCsv::endArray()
+{
+  m_level = clvNone;
+}
+
+void dnStructureOutputCsv::writeKeyName(const std::string &name)
+{
+  m_key = name;
+}
+
+void dnStructureOutputCsv::writeValue(const std::string &value)
+{
+  setField(value);
+}
+
+void dnStructureOutputCsv::writeValue(float value)
+{
+  setDoubleField(value);
+}
+
+void dnStructureOutputCsv::writeValue(double value)
+{
+  setDoubleField(value);
+}
+
+void dnStructureOutputCsv::writeValue(xdouble value)
+{
+  setDoubleField(static_cast<double>(value));
+}
+
+void dnStructureOutputCsv::writeValue(byte value)
+{
+  setField(toString(static_cast<uint>(value), m_numBuffer));
+}
+
+void dnStructureOutputCsv::writeValue(int value)
+{
+  setField(toString(value, m_numBuffer));
+}
+
+void dnStructureOutputCsv::writeValue(uint value)
+{
+  setField(toString(value, m_numBuffer));
+}
+
+void dnStructureOutputCsv::writeValue(int64 value)
+{
+  setField(toString(value, m_numBuffer));
+}
+
+void dnStructureOutputCsv::writeValue(uint64 value)
+{
+  setField(toString(value, m_numBuffer));
+}
+
+void dnStructureOutputCsv::writeValue(bool value)
+{
+  m_numBuffer = value ? "true" : "false";
+  setField(m_numBuffer);
+}
+
+void dnStructureOutputCsv::writeNullValue()
+{
+  m_numBuffer.clear();
+  setField(m_numBuffer);
+}
+
+// ----------------------------------------------------------------------------
+// dnCsvStructureReader
+// ----------------------------------------------------------------------------
+dnCsvStructureReader::dnCsvStructureReader(StructureOutputIntf &output, char sepChar, char quoteChar):
+  m_output(output), m_sepChar(sepChar), m_quoteChar(quoteChar)
+{
+}
+
+bool dnCsvStructureReader::readRecord(std::istream &input, dtpString &output)
+{
+  if (!std::getline(input, output))
+    return false;
+
+  size_t quoteCount = 0;
+  size_t checkedLength = 0;
+  for(;;) {
+    if (!output.empty() && (output[output.length() - 1] == '\r'))
+      output.erase(output.length() - 1);
+    for(size_t i = checkedLength, epos = output.length(); i != epos; i++)
+      if (output[i] == m_quoteChar)
+        quoteCount++;
+    checkedLength = output.length();
+
+    // odd number of quotes - quoted field continues in next line
+    if ((quoteCount % 2 == 0) || !std::getline(input, m_lineBuffer))
+      break;
+    output += '\n';
+    output += m_lineBuffer;
+  }
+  return true;
+}
+
+void dnCsvStructureReader::read(std::istream &input)
+{
+  dnStringPool header, fields;
+  dtpString record;
+  bool headerRead = false;
+  dnStringRef value;
+
+  m_output.beginWrite();
+  m_output.beginArray();
+
+  while (readRecord(input, record)) {
+    if (record.empty())
+      continue;
+
+    if (!headerRead) {
+      header.readCsvLine(dnStringRef(record), m_sepChar, m_quoteChar);
+      headerRead = true;
+      continue;
+    }
+
+    fields.readCsvLine(dnStringRef(record), m_sepChar, m_quoteChar);
+    if (fields.size() > header.size())
+      throw dnError("CSV line has more fields than header: [" + record + "]");
+
+    m_output.beginMap();
+    for(dnStringPool::size_type i = 0, epos = header.size(); i != epos; i++) {
+      value = header.get(i);
+      m_buffer.assign(value.data(), value.length());
+      m_output.writeKeyName(m_buffer);
+      if (i < fields.size()) {
+        value = fields.get(i);
+        m_buffer.assign(value.data(), value.length());
+      } else {
+        m_buffer.clear();
+      }
+      m_output.writeValue(m_buffer);
+    }
+    m_output.endMap();
+  }
+
+  m_output.endArray();
+  m_output.endWrite();
+}
+
+// ----------------------------------------------------------------------------
+// dnJsonStructureReader
+// ----------------------------------------------------------------------------
+dnJsonStructureReader::dnJsonStructureReader(StructureOutputIntf &output, bool checkUtf8, bool commentsEnabled):
+  YawlReaderBase(checkUtf8, commentsEnabled), m_output(output)
+{
+}
+
+void dnJsonStructureReader::read(const dtpString &input)
+{
+  m_output.beginWrite();
+  parseString(input);
+  parseComplete();
+  m_output.endWrite();
+}
+
+void dnJsonStructureReader::read(std::istream &input, size_t bufferSize)
+{
+  m_output.beginWrite();
+  parseStream(input, bufferSize);
+  m_output.endWrite();
+}
+
+int dnJsonStructureReader::processNull()
+{
+  m_output.writeNullValue();
+  return 1;
+}
+
+int dnJsonStructureReader::processBoolean(int boolVal)
+{
+  m_output.writeValue(boolVal != 0);
+  return 1;
+}
+
+int dnJsonStructureReader::processInteger(long integerVal)
+{
+  if ((integerVal >= INT_MIN) && (integerVal <= INT_MAX))
+    m_output.writeValue(static_cast<int>(integerVal));
+  else
+    m_output.writeValue(static_cast<int64>(integerVal));
+  return 1;
+}
+
+int dnJsonStructureReader::processDouble(double doubleVal)
+{
+  m_output.writeValue(doubleVal);
+  return 1;
+}
+
+int dnJsonStructureReader::processString(const unsigned char * stringVal,
+                     unsigned int stringLen)
+{
+  m_buffer.assign(reinterpret_cast<const char *>(stringVal), stringLen);
+  m_output.writeValue(m_buffer);
+  return 1;
+}
+
+int dnJsonStructureReader::processMapKey(const unsigned char * stringVal,
+                   unsigned int stringLen)
+{
+  m_buffer.assign(reinterpret_cast<const char *>(stringVal), stringLen);
+  m_output.writeKeyName(m_buffer);
+  return 1;
+}
+
+int dnJsonStructureReader::processStartMap()
+{
+  m_output.beginMap();
+  return 1;
+}
+
+int dnJsonStructureReader::processEndMap()
+{
+  m_output.endMap();
+  return 1;
+}
+
+int dnJsonStructureReader::processStartArray()
+{
+  m_output.beginArray();
+  return 1;
+}
+
+int dnJsonStructureReader::processEndArray()
+{
+  m_output.endArray();
+  return 1;
+}
+
+// ----------------------------------------------------------------------------
+// dnBionStructureProcessor
+// ----------------------------------------------------------------------------
+dnBionStructureProcessor::dnBionStructureProcessor(StructureOutputIntf &output, bool dnodeDialect):
+  m_output(output), m_dnodeDialect(dnodeDialect), m_arrayInitWait(false)
+{
+}
+
+void dnBionStructureProcessor::processHeader(void *data, size_t dataSize)
+{
+  m_arrayInitWait = false;
+  m_output.beginWrite();
+}
+
+void dnBionStructureProcessor::processFooter(void *data, size_t dataSize)
+{
+  m_output.endWrite();
+}
+
+void dnBionStructureProcessor::processObjectBegin()
+{
+  // struct as first item: array without marker, handled as list (like in dnBionProcessor)
+  m_arrayInitWait = false;
+  m_output.beginMap();
+}
+
+void dnBionStructureProcessor::processObjectEnd()
+{
+  m_output.endMap();
+}
+
+void dnBionStructureProcessor::processArrayBegin()
+{
+  m_output.beginArray();
+  m_arrayInitWait = m_dnodeDialect;
+}
+
+void dnBionStructureProcessor::processArrayEnd()
+{
+  m_arrayInitWait = false;
+  m_output.endArray();
+}
+
+void dnBionStructureProcessor::processFixTypeArrayBegin(BionValueType valueType, unsigned int elementSize, size_t arraySize)
+{
+  m_arrayInitWait = false;
+
+  switch (valueType) {
+  case bvt_bool:
+  case bvt_bool_data:
+    m_output.beginArrayOf(bool(), arraySize);
+    break;
+  case bvt_int:
+    if (elementSize == sizeof(int64))
+      m_output.beginArrayOf(int64(), arraySize);
+    else if (elementSize == sizeof(byte))
+      m_output.beginArrayOf(byte(), arraySize);
+    else
+      m_output.beginArrayOf(int(), arraySize);
+    break;
+  case bvt_uint:
+    if (elementSize == sizeof(uint64))
+      m_output.beginArrayOf(uint64(), arraySize);
+    else if (elementSize == sizeof(byte))
+      m_output.beginArrayOf(byte(), arraySize);
+    else
+      m_output.beginArrayOf(uint(), arraySize);
+    break;
+  case bvt_float:
+    if (elementSize == sizeof(float))
+      m_output.beginArrayOf(float(), arraySize);
+    else if (elementSize == sizeof(xdouble))
+      m_output.beginArrayOf(xdouble(), arraySize);
+    else
+      m_output.beginArrayOf(double(), arraySize);
+    break;
+  case bvt_zstring:
+    m_output.beginArrayOf(std::string(), arraySize);
+    break;
+  default:
+    m_output.beginArray(arraySize);
+    break;
+  }
+}
+
+void dnBionStructureProcessor::processFixTypeArrayEnd()
+{
+  m_output.endArray();
+}
+
+void dnBionStructureProcessor::processElementName(char *name)
+{
+  m_buffer.assign(name);
+  m_output.writeKeyName(m_buffer);
+}
+
+void dnBionStructureProcessor::processFloat(float value)
+{
+  m_arrayInitWait = false;
+  m_output.writeValue(value);
+}
+
+void dnBionStructureProcessor::processDouble(double value)
+{
+  m_arrayInitWait = false;
+  m_output.writeValue(value);
+}
+
+void dnBionStructureProcessor::processXDouble(xdouble value)
+{
+  m_arrayInitWait = false;
+  m_output.writeValue(value);
+}
+
+void dnBionStructureProcessor::processZString(char *value)
+{
+  m_arrayInitWait = false;
+  m_buffer.assign(value);
+  m_output.writeValue(m_buffer);
+}
+
+void dnBionStructureProcessor::processBool(bool value)
+{
+  m_arrayInitWait = false;
+  m_output.writeValue(value);
+}
+
+void dnBionStructureProcessor::processNull()
+{
+  m_arrayInitWait = false;
+  m_output.writeNullValue();
+}
+
+void dnBionStructureProcessor::processInt(int value)
+{
+  if (!consumeMarker())
+    m_output.writeValue(value);
+}
+
+void dnBionStructureProcessor::processInt64(int64 value)
+{
+  if (!consumeMarker())
+    m_output.writeValue(value);
+}
+
+void dnBionStructureProcessor::processUInt(uint value)
+{
+  if (!consumeMarker())
+    m_output.writeValue(value);
+}
+
+void dnBionStructureProcessor::processUInt64(uint64 value)
+{
+  if (!consumeMarker())
+    m_output.writeValue(value);
+}
+
+// ----------------------------------------------------------------------------
+// Function definitions
+// ----------------------------------------------------------------------------
+void dtp::dtc_json_to_bion(std::istream &input, std::ostream &output, bool dnodeDialect)
+{
+  BionWriter<std::ostream> writer(output);
+
+  if (dnodeDialect) {
+    dnStructureOutputBion bionOutput(writer);
+    dtc_json_to_structure(input, bionOutput);
+  } else {
+    StructureOutputBion bionOutput(writer);
+    dtc_json_to_structure(input, bionOutput);
+  }
+}
+
+void dtp::dtc_bion_to_json(std::istream &input, std::ostream &output, bool dnodeDialect, bool beautify)
+{
+  YawlWriter writer(beautify, "  ");
+  dnStructureOutputJson jsonOutput(writer.getContext(), &output);
+  dtc_bion_to_structure(input, jsonOutput, dnodeDialect);
+  jsonOutput.flush();
+}
+
+void dtp::dtc_json_to_structure(std::istream &input, StructureOutputIntf &output)
+{
+  dnJsonStructureReader reader(output);
+  reader.read(input);
+}
+
+void dtp::dtc_bion_to_structure(std::istream &input, StructureOutputIntf &output, bool dnodeDialect)
+{
+  dnBionStructureProcessor processor(output, dnodeDialect);
+  BionReader<std::istream, dnBionStructureProcessor> reader(input, processor);
+  reader.process();
+}
+
+void dtp::dtc_json_to_csv(std::istream &input, std::ostream &output, char sepChar, char quoteChar)
+{
+  dnStructureOutputCsv csvOutput(output, sepChar, quoteChar);
+  dtc_json_to_structure(input, csvOutput);
+}
+
+void dtp::dtc_csv_to_json(std::istream &input, std::ostream &output, bool beautify, char sepChar, char quoteChar)
+{
+  YawlWriter writer(beautify, "  ");
+  dnStructureOutputJson jsonOutput(writer.getContext(), &output);
+  dtc_csv_to_structure(input, jsonOutput, sepChar, quoteChar);
+  jsonOutput.flush();
+}
+
+void dtp::dtc_csv_to_structure(std::istream &input, StructureOutputIntf &output, char sepChar, char quoteChar)
+{
+  dnCsvStructureReader reader(output, sepChar, quoteChar);
+  reader.read(input);
+}
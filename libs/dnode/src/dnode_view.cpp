@@ -0,0 +1,571 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dnode_view.cpp
+// Project:     dtpLib
+// Purpose:     Read-only data node view over serialized buffer
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <fstream>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "dtp/dnode_view.h"
+#include "dtp/details/dnode_view_builder.h"
+
+using namespace dtp;
+using namespace Details;
+
+namespace {
+
+const char DNVIEW_MAGIC[4] = {'D', 'N', 'V', '1'};
+const uint DNVIEW_MAX_DEPTH = 1024;
+
+// ----------------------------------------------------------------------------
+// dnViewBuilder
+// ----------------------------------------------------------------------------
+/// Writes DNV image into contiguous buffer
+class dnViewBuilder {
+public:
+  dnViewBuilder(std::vector<char> &output): m_output(output) {}
+
+  void build(const dnode &input) {
+    m_output.clear();
+    dnViewOffset headerOffset = alloc(sizeof(dnViewHeader));
+    dnViewNodeWriter<dnViewBuilder> writer(*this);
+    dnViewOffset rootOffset = writer.writeNode(input);
+
+    dnViewHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DNVIEW_MAGIC, sizeof(header.magic));
+    header.byteOrderMark = DNVIEW_BYTE_ORDER_MARK;
+    header.version = DNVIEW_VERSION;
+    header.xdoubleSize = sizeof(xdouble);
+    header.rootOffset = rootOffset;
+    header.totalSize = m_output.size();
+    memcpy(&m_output[static_cast<size_t>(headerOffset)], &header, sizeof(header));
+  }
+
+  /// Reserves zero-filled block aligned to 8 bytes
+  dnViewOffset alloc(size_t size) {
+    size_t res = (m_output.size() + 7) & ~static_cast<size_t>(7);
+    m_output.resize(res + size, 0);
+    return res;
+  }
+
+  void put(dnViewOffset offset, const void *data, size_t size) {
+    if (size > 0)
+      memcpy(&m_output[static_cast<size_t>(offset)], data, size);
+  }
+
+private:
+  std::vector<char> &m_output;
+};
+
+template<typename ValueType>
+void dnViewAddArrayItems(const ValueType *items, size_t cnt, dnode &output)
+{
+  for(size_t i=0; i < cnt; i++)
+    output.addItem(items[i]);
+}
+
+bool dnViewIsIndex(const char *text, size_t len, uint64 &output)
+{
+  if (len == 0)
+    return false;
+  output = 0;
+  for(size_t i=0; i < len; i++) {
+    if ((text[i] < '0') || (text[i] > '9'))
+      return false;
+    output = output * 10 + static_cast<uint64>(text[i] - '0');
+  }
+  return true;
+}
+
+/// Returns true if count items of itemSize bytes starting at offset fit in dataSize bytes.
+/// Checked without computing offset + count * itemSize, which can overflow.
+bool dnViewFits(uint64 offset, uint64 count, uint64 itemSize, uint64 dataSize)
+{
+  if (offset > dataSize)
+    return false;
+  return (itemSize == 0) || (count <= (dataSize - offset) / itemSize);
+}
+
+/// Returns true if string (length, characters, terminator) at offset fits in dataSize bytes
+bool dnViewStringFits(const byte *base, uint64 offset, uint64 dataSize)
+{
+  if (!dnViewFits(offset, 1, sizeof(uint64), dataSize))
+    return false;
+  return dnViewReadRaw<uint64>(base + offset) < dataSize - offset - sizeof(uint64);
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// dnViewWriter
+// ----------------------------------------------------------------------------
+void dnViewWriter::write(const dnode &input, std::vector<char> &output)
+{
+  dnViewBuilder builder(output);
+  builder.build(input);
+}
+
+void dnViewWriter::writeToFile(const dnode &input, const dtpString &fileName)
+{
+  std::vector<char> buffer;
+  write(input, buffer);
+
+  std::ofstream output(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!output.good())
+    throw dnError("Cannot create file: " + fileName);
+  output.write(&buffer[0], buffer.size());
+  if (!output.good())
+    throw dnError("Write to file failed: " + fileName);
+}
+
+size_t dnViewWriter::getItemSize(dnValueType valueType)
+{
+  switch (valueType) {
+    case vt_byte: return sizeof(byte);
+    case vt_int: return sizeof(int);
+    case vt_uint: return sizeof(uint);
+    case vt_int64: return sizeof(int64);
+    case vt_uint64: return sizeof(uint64);
+    case vt_bool: return sizeof(bool);
+    case vt_float: return sizeof(float);
+    case vt_double: return sizeof(double);
+    case vt_date: return sizeof(double);
+    case vt_time: return sizeof(double);
+    case vt_datetime: return sizeof(double);
+    case vt_xdouble: return sizeof(xdouble);
+    default: return 0;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// dnodeView
+// ----------------------------------------------------------------------------
+const dnodeView::size_type dnodeView::npos = static_cast<dnodeView::size_type>(-1);
+
+dnodeView dnodeView::open(const void *data, size_t dataSize)
+{
+  if ((data == DTP_NULL) || (dataSize < sizeof(dnViewHeader)))
+    throw dnViewFormatError("buffer too small");
+
+  if ((reinterpret_cast<size_t>(data) % 8) != 0)
+    throw dnViewFormatError("buffer not aligned");
+
+  const byte *base = static_cast<const byte *>(data);
+  dnViewHeader header;
+  memcpy(&header, base, sizeof(header));
+
+  if (memcmp(header.magic, DNVIEW_MAGIC, sizeof(header.magic)) != 0)
+    throw dnViewFormatError("wrong signature");
+  if (header.byteOrderMark != DNVIEW_BYTE_ORDER_MARK)
+    throw dnViewFormatError("wrong byte order");
+  if (header.version != DNVIEW_VERSION)
+    throw dnViewFormatError("unsupported version " + toString(header.version));
+  if (header.xdoubleSize != sizeof(xdouble))
+    throw dnViewFormatError("incompatible xdouble size");
+  if ((header.totalSize > dataSize) || !dnViewFits(header.rootOffset, 1, sizeof(dnViewRecord), header.totalSize))
+    throw dnViewFormatError("truncated data");
+
+  return dnodeView(base, reinterpret_cast<const dnViewRecord *>(base + header.rootOffset));
+}
+
+bool dnodeView::validate(size_t dataSize) const
+{
+  if (m_record == DTP_NULL)
+    return true;
+  return validateNode(m_record, dataSize, 0);
+}
+
+bool dnodeView::validateNode(const dnViewRecord *record, size_t dataSize, uint depth) const
+{
+  if (depth > DNVIEW_MAX_DEPTH)
+    return false;
+
+  dnViewOffset recordOffset = reinterpret_cast<const byte *>(record) - m_base;
+  if ((recordOffset % 8 != 0) || !dnViewFits(recordOffset, 1, sizeof(dnViewRecord), dataSize))
+    return false;
+
+  uint64 cnt = record->count;
+  dnValueType kind = static_cast<dnValueType>(record->kind);
+
+  if (kind == vt_string) {
+    if (!dnViewStringFits(m_base, record->a, dataSize) ||
+        (Details::dnViewReadRaw<uint64>(m_base + record->a) != cnt))
+      return false;
+  } else if ((kind == vt_parent) || ((kind == vt_array) && (record->itemType == vt_datanode))) {
+    if (!dnViewFits(record->a, cnt, sizeof(dnViewOffset), dataSize))
+      return false;
+    for(uint64 i=0; i < cnt; i++)
+      if (!validateNode(recordAt(offsetTableItem(record->a, i)), dataSize, depth + 1))
+        return false;
+    if ((kind == vt_parent) && ((record->flags & dvfNamed) != 0)) {
+      if (!dnViewFits(record->b, 2 * cnt, sizeof(dnViewOffset), dataSize))
+        return false;
+      for(uint64 i=0; i < cnt; i++) {
+        dnViewOffset nameOffset = offsetTableItem(record->b, i);
+        if ((nameOffset != 0) && !dnViewStringFits(m_base, nameOffset, dataSize))
+          return false;
+        if (offsetTableItem(record->b, cnt + i) >= cnt)
+          return false;
+      }
+    }
+  } else if (kind == vt_array) {
+    dnValueType itemType = static_cast<dnValueType>(record->itemType);
+    if (itemType == vt_string) {
+      if (!dnViewFits(record->a, cnt, sizeof(dnViewOffset), dataSize))
+        return false;
+      for(uint64 i=0; i < cnt; i++)
+        if (!dnViewStringFits(m_base, offsetTableItem(record->a, i), dataSize))
+          return false;
+    } else {
+      size_t itemSize = dnViewWriter::getItemSize(itemType);
+      if ((itemSize == 0) || !dnViewFits(record->a, cnt, itemSize, dataSize))
+        return false;
+    }
+  } else if (kind > vt_last) {
+    return false;
+  }
+
+  return true;
+}
+
+dnValueType dnodeView::getElementType() const
+{
+  checkContainer();
+  if (isArray())
+    return getItemType();
+  return vt_datanode;
+}
+
+void dnodeView::checkContainer() const
+{
+  if (!isContainer())
+    throw dnError("Not a container");
+}
+
+void dnodeView::checkIndex(size_type index) const
+{
+  checkContainer();
+  if (index >= m_record->count)
+    throw dnError("Index out of range: " + toString(index));
+}
+
+dnodeView dnodeView::getElement(size_type index) const
+{
+  checkIndex(index);
+  if (isParent() || (getItemType() == vt_datanode))
+    return dnodeView(m_base, recordAt(offsetTableItem(m_record->a, index)));
+  else
+    return dnodeView(m_base, m_record, index);
+}
+
+dnodeView dnodeView::getElement(const char *name, size_t nameLen) const
+{
+  size_type idx = indexOfName(name, nameLen);
+  if (idx == npos)
+    throw dnError("Element not found: " + dtpString(name, nameLen));
+  return dnodeView(m_base, recordAt(offsetTableItem(m_record->a, idx)));
+}
+
+bool dnodeView::findElement(const char *name, size_t nameLen, dnodeView &output) const
+{
+  size_type idx = indexOfName(name, nameLen);
+  if (idx == npos)
+    return false;
+  output = dnodeView(m_base, recordAt(offsetTableItem(m_record->a, idx)));
+  return true;
+}
+
+dnViewString dnodeView::getElementName(size_type index) const
+{
+  checkIndex(index);
+  if (!supportsNames())
+    return dnViewString();
+  dnViewOffset nameOffset = offsetTableItem(m_record->b, index);
+  if (nameOffset == 0)
+    return dnViewString();
+  return stringAt(nameOffset);
+}
+
+void dnodeView::getElementName(size_type index, dtpString &output) const
+{
+  dnViewString name = getElementName(index);
+  output.assign(name.data(), name.length());
+}
+
+dnodeView::size_type dnodeView::indexOfName(const char *name, size_t nameLen) const
+{
+  if (!supportsNames() || (nameLen == 0))
+    return npos;
+
+  const dnViewOffset sortedOffset = m_record->b + m_record->count * sizeof(dnViewOffset);
+  uint64 first = 0, cnt = m_record->count, step, mid;
+
+  // lower bound
+  while (cnt > 0) {
+    step = cnt / 2;
+    mid = first + step;
+    dnViewOffset nameOffset = offsetTableItem(m_record->b, offsetTableItem(sortedOffset, mid));
+    int cmp = (nameOffset == 0) ? ((nameLen == 0) ? 0 : -1) : stringAt(nameOffset).compare(name, nameLen);
+    if (cmp < 0) {
+      first = mid + 1;
+      cnt -= step + 1;
+    } else {
+      cnt = step;
+    }
+  }
+
+  if (first < m_record->count) {
+    uint64 idx = offsetTableItem(sortedOffset, first);
+    dnViewOffset nameOffset = offsetTableItem(m_record->b, idx);
+    if ((nameOffset != 0) && (stringAt(nameOffset).compare(name, nameLen) == 0))
+      return static_cast<size_type>(idx);
+  }
+
+  return npos;
+}
+
+bool dnodeView::getElementByPath(const char *path, dnodeView &output, char separator) const
+{
+  dnodeView current(*this);
+  const char *segStart = path;
+  const char *segEnd;
+  uint64 index;
+
+  while (*segStart != '\0') {
+    segEnd = segStart;
+    while ((*segEnd != '\0') && (*segEnd != separator))
+      ++segEnd;
+
+    size_t segLen = segEnd - segStart;
+    if (segLen > 0) {
+      if (!current.isContainer())
+        return false;
+      if (!current.findElement(segStart, segLen, current)) {
+        if (!dnViewIsIndex(segStart, segLen, index) || (index >= current.size()))
+          return false;
+        current = current.getElement(static_cast<size_type>(index));
+      }
+    }
+
+    segStart = (*segEnd == '\0') ? segEnd : segEnd + 1;
+  }
+
+  output = current;
+  return true;
+}
+
+const byte *dnodeView::getValuePtr() const
+{
+  if (m_itemIndex == npos)
+    return reinterpret_cast<const byte *>(&m_record->a);
+  return m_base + m_record->a + m_itemIndex * dnViewWriter::getItemSize(getItemType());
+}
+
+dnViewString dnodeView::getStringRef() const
+{
+  if (getValueType() != vt_string)
+    throw dnError("Value is not a string");
+  if (m_itemIndex == npos)
+    return stringAt(m_record->a);
+  return stringAt(offsetTableItem(m_record->a, m_itemIndex));
+}
+
+namespace dtp {
+
+template<>
+dtpString dnodeView::getAs<dtpString>() const
+{
+  if (getValueType() == vt_string)
+    return getStringRef().str();
+  dnValue helper;
+  getValue(helper);
+  return helper.getAs<dtpString>();
+}
+
+} // namespace dtp
+
+void dnodeView::getValue(dnValue &output) const
+{
+  switch (getValueType()) {
+    case vt_null:
+      output.clear();
+      break;
+    case vt_byte:
+      output.setAs<byte>(getAs<byte>());
+      break;
+    case vt_int:
+      output.setAs<int>(getAs<int>());
+      break;
+    case vt_uint:
+      output.setAs<uint>(getAs<uint>());
+      break;
+    case vt_int64:
+      output.setAs<int64>(getAs<int64>());
+      break;
+    case vt_uint64:
+      output.setAs<uint64>(getAs<uint64>());
+      break;
+    case vt_bool:
+      output.setAs<bool>(getAs<bool>());
+      break;
+    case vt_float:
+      output.setAs<float>(getAs<float>());
+      break;
+    case vt_double:
+      output.setAs<double>(getAs<double>());
+      break;
+    case vt_xdouble:
+      output.setAs<xdouble>(getAs<xdouble>());
+      break;
+    case vt_date:
+    case vt_time:
+    case vt_datetime:
+      output.setAs<double>(Details::dnViewReadRaw<double>(getValuePtr()));
+      output.convertTo(getValueType());
+      break;
+    case vt_string:
+      output.setAs<dtpString>(getStringRef().str());
+      break;
+    default:
+      throw dnError("Container value cannot be read as scalar");
+  }
+}
+
+void dnodeView::toNode(dnode &output) const
+{
+  switch (getValueType()) {
+    case vt_parent: {
+      if (supportsNames())
+        output.setAsParent();
+      else
+        output.setAsList();
+      for(size_type i=0, epos = size(); i < epos; i++) {
+        DTP_UNIQUE_PTR(dnode) child(new dnode());
+        getElement(i).toNode(*child);
+        if (supportsNames())
+          output.addChild(getElementName(i).str(), child.release());
+        else
+          output.addChild(child.release());
+      }
+      break;
+    }
+    case vt_array: {
+      dnValueType itemType = getItemType();
+      size_t cnt = size();
+      output.setAsArray(itemType);
+      switch (itemType) {
+        case vt_datanode: {
+          dnode item;
+          for(size_type i=0; i < cnt; i++) {
+            getElement(i).toNode(item);
+            output.addItem(item);
+          }
+          break;
+        }
+        case vt_string:
+          for(size_type i=0; i < cnt; i++)
+            output.addItem(getElement(i).getStringRef().str());
+          break;
+        case vt_byte: dnViewAddArrayItems(arrayData<byte>(), cnt, output); break;
+        case vt_int: dnViewAddArrayItems(arrayData<int>(), cnt, output); break;
+        case vt_uint: dnViewAddArrayItems(arrayData<uint>(), cnt, output); break;
+        case vt_int64: dnViewAddArrayItems(arrayData<int64>(), cnt, output); break;
+        case vt_uint64: dnViewAddArrayItems(arrayData<uint64>(), cnt, output); break;
+        case vt_bool: dnViewAddArrayItems(arrayData<bool>(), cnt, output); break;
+        case vt_float: dnViewAddArrayItems(arrayData<float>(), cnt, output); break;
+        case vt_double: dnViewAddArrayItems(arrayData<double>(), cnt, output); break;
+        case vt_xdouble: dnViewAddArrayItems(arrayData<xdouble>(), cnt, output); break;
+        case vt_date:
+        case vt_time:
+        case vt_datetime: {
+          dnValue value;
+          for(size_type i=0; i < cnt; i++) {
+            getElement(i).getValue(value);
+            output.addItem(dnode(value));
+          }
+          break;
+        }
+        default:
+          throw dnError("Array type not supported by DNV layout: " + getValueTypeName(itemType));
+      }
+      break;
+    }
+    default: {
+      dnValue value;
+      getValue(value);
+      output = dnode(value);
+      break;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// dnViewMappedFile
+// ----------------------------------------------------------------------------
+struct dnViewMappedFile::Impl {
+  boost::interprocess::file_mapping mapping;
+  boost::interprocess::mapped_region region;
+
+  Impl(const dtpString &fileName):
+    mapping(fileName.c_str(), boost::interprocess::read_only),
+    region(mapping, boost::interprocess::read_only)
+  {}
+};
+
+dnViewMappedFile::dnViewMappedFile(): m_impl(DTP_NULL)
+{
+}
+
+dnViewMappedFile::dnViewMappedFile(const dtpString &fileName): m_impl(DTP_NULL)
+{
+  open(fileName);
+}
+
+dnViewMappedFile::~dnViewMappedFile()
+{
+  close();
+}
+
+void dnViewMappedFile::open(const dtpString &fileName)
+{
+  close();
+  try {
+    m_impl = new Impl(fileName);
+  }
+  catch(boost::interprocess::interprocess_exception &e) {
+    throw dnError("Cannot map file: " + fileName + ": " + e.what());
+  }
+
+  try {
+    m_root = dnodeView::open(m_impl->region.get_address(), m_impl->region.get_size());
+  }
+  catch(...) {
+    close();
+    throw;
+  }
+}
+
+void dnViewMappedFile::close()
+{
+  m_root = dnodeView();
+  delete m_impl;
+  m_impl = DTP_NULL;
+}
+
+bool dnViewMappedFile::isOpen() const
+{
+  return (m_impl != DTP_NULL);
+}
+
+size_t dnViewMappedFile::getDataSize() const
+{
+  return (m_impl != DTP_NULL) ? m_impl->region.get_size() : 0;
+}
@@ -0,0 +1,68 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        benchCompare.cpp
+// Purpose:     Compares benchmark CSV reports, flags regressions
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+// Usage:
+//   benchCompare <baseline.csv> <current.csv> [--threshold=pct]
+//
+// Compares median run time of each (name, size) pair.
+// Exit code: 0 - no regressions, 1 - regression found, 2 - invalid input.
+
+#include <iostream>
+#include <iomanip>
+
+#include "base/string.h"
+#include "benchHarness.h"
+
+using namespace perf;
+
+int main(int argc, char *argv[])
+{
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <baseline.csv> <current.csv> [--threshold=pct]\n";
+    return 2;
+  }
+
+  double threshold = 10.0;
+  const dtpString thresholdPrefix("--threshold=");
+  for(int i=3; i < argc; i++) {
+    dtpString arg(argv[i]);
+    if (arg.compare(0, thresholdPrefix.length(), thresholdPrefix) == 0) {
+      threshold = stringToDouble(arg.substr(thresholdPrefix.length()));
+    } else {
+      std::cerr << "Unknown argument: " << arg << "\n";
+      return 2;
+    }
+  }
+
+  BenchResults baseline, current;
+  if (!BenchReport::readCsvFile(argv[1], baseline)) {
+    std::cerr << "Cannot read baseline: " << argv[1] << "\n";
+    return 2;
+  }
+  if (!BenchReport::readCsvFile(argv[2], current)) {
+    std::cerr << "Cannot read results: " << argv[2] << "\n";
+    return 2;
+  }
+
+  BenchComparator comparator(threshold);
+  BenchComparator::Items items;
+  uint regressions = comparator.compare(baseline, current, items);
+
+  std::cout << std::left << std::setw(32) << "name" << std::right << std::setw(10) << "size"
+    << std::setw(16) << "baseline_ns" << std::setw(16) << "current_ns" << std::setw(10) << "change%"
+    << "  verdict\n";
+  std::cout << std::fixed << std::setprecision(1);
+  for(BenchComparator::Items::const_iterator it = items.begin(), epos = items.end(); it != epos; ++it) {
+    std::cout << std::left << std::setw(32) << it->name << std::right << std::setw(10) << it->size
+      << std::setw(16) << it->baselineNs << std::setw(16) << it->currentNs << std::setw(10) << it->changePct
+      << "  " << BenchComparator::verdictName(it->verdict) << "\n";
+  }
+
+  std::cout << "Regressions (threshold " << threshold << "%): " << regressions << "\n";
+  return (regressions > 0) ? 1 : 0;
+}
@@ -0,0 +1,532 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        benchHarness.h
+// Project:     dtpLib
+// Purpose:     Benchmark harness: repeated runs, statistics, JSON/CSV reports
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DTPBENCHHARNESS_H__
+#define _DTPBENCHHARNESS_H__
+
+// ----------------------------------------------------------------------------
+// Description
+// ----------------------------------------------------------------------------
+/** \file benchHarness.h
+\brief Benchmark harness: repeated runs, statistics, JSON/CSV reports
+
+Each benchmark case is executed for every requested size:
+ - setUp(size) - not measured
+ - warmup runs - not measured
+ - measured runs, each: run() timed with steady clock, then reset() (not measured)
+
+For each (case, size) pair harness reports min / median / p90 / p99 / max / mean
+run time, items per second and bytes per second (calculated from median).
+If dnode performance counters are enabled (DATANODE_PERF_COUNTERS) average
+counter values per run are reported as well.
+
+Reports can be written as JSON or CSV. CSV report can be used as a baseline
+for benchCompare tool.
+
+\code
+  class InsertVector: public perf::BenchCase {
+  public:
+    InsertVector(): BenchCase("insert", "vector") {}
+    virtual void setUp(uint size) { m_size = size; }
+    virtual void run() { for(uint i=0; i < m_size; i++) m_vect.push_back(i); }
+    virtual void reset() { m_vect.clear(); }
+    virtual uint64 items() const { return m_size; }
+  ...
+  };
+
+  perf::BenchRunner runner(options);
+  runner.addCase(new InsertVector());
+  runner.execute();
+  runner.writeCsv(std::cout);
+\endcode
+*/
+
+// ----------------------------------------------------------------------------
+// Headers
+// ----------------------------------------------------------------------------
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+
+#include <boost/shared_ptr.hpp>
+
+#ifndef BOOST_CHRONO_HEADER_ONLY
+#define BOOST_CHRONO_HEADER_ONLY
+#endif
+#include <boost/chrono.hpp>
+
+#include "base/string.h"
+#include "dtp/dnode.h"
+
+namespace perf {
+
+// ----------------------------------------------------------------------------
+// Simple type definitions
+// ----------------------------------------------------------------------------
+typedef std::vector<double> BenchSamples;
+
+// ----------------------------------------------------------------------------
+// Class definitions
+// ----------------------------------------------------------------------------
+
+// ----------------------------------------------------------------------------
+// BenchCase
+// ----------------------------------------------------------------------------
+/// Base class for benchmark cases. Only run() is measured.
+class BenchCase {
+public:
+  BenchCase(const dtpString &operation, const dtpString &container):
+    m_operation(operation), m_container(container), m_size(0) {}
+  virtual ~BenchCase() {}
+
+  /// name of benchmark: operation_container
+  dtpString getName() const { return m_operation + "_" + m_container; }
+  const dtpString &getOperation() const { return m_operation; }
+  const dtpString &getContainer() const { return m_container; }
+
+  /// prepares input data for a given size
+  virtual void setUp(uint size) { m_size = size; }
+  /// measured operation
+  virtual void run() = 0;
+  /// restores state after run() so it can be repeated
+  virtual void reset() {}
+  /// releases input data
+  virtual void tearDown() {}
+  /// number of items processed by single run()
+  virtual uint64 items() const { return m_size; }
+  /// number of bytes processed by single run(), 0 if not applicable
+  virtual uint64 bytes() const { return 0; }
+protected:
+  uint getSize() const { return m_size; }
+private:
+  dtpString m_operation;
+  dtpString m_container;
+  uint m_size;
+};
+
+typedef boost::shared_ptr<BenchCase> BenchCaseGuard;
+
+// ----------------------------------------------------------------------------
+// BenchOptions
+// ----------------------------------------------------------------------------
+struct BenchOptions {
+  uint warmupRuns;
+  uint measuredRuns;
+  std::vector<uint> sizes;
+  dtpString filter; ///< if not empty - only cases with name containing filter are executed
+
+  BenchOptions(): warmupRuns(2), measuredRuns(15) {
+    sizes.push_back(1000);
+    sizes.push_back(100000);
+  }
+};
+
+// ----------------------------------------------------------------------------
+// BenchResult
+// ----------------------------------------------------------------------------
+struct BenchResult {
+  dtpString name;
+  uint size;
+  uint runs;
+  double minNs;
+  double medianNs;
+  double p90Ns;
+  double p99Ns;
+  double maxNs;
+  double meanNs;
+  double itemsPerSec;
+  double bytesPerSec;
+  dtp::dnPerfCounters counters; ///< average values per run
+
+  BenchResult(): size(0), runs(0), minNs(0), medianNs(0), p90Ns(0), p99Ns(0), maxNs(0), meanNs(0),
+    itemsPerSec(0), bytesPerSec(0)
+  {
+    counters.clear();
+  }
+};
+
+typedef std::vector<BenchResult> BenchResults;
+
+// ----------------------------------------------------------------------------
+// BenchStats
+// ----------------------------------------------------------------------------
+class BenchStats {
+public:
+  /// Returns percentile (0..100) of sorted samples, nearest-rank method.
+  static double percentile(const BenchSamples &sorted, double pct) {
+    if (sorted.empty())
+      return 0.0;
+    if (pct <= 0.0)
+      return sorted.front();
+    size_t rank = static_cast<size_t>(std::ceil(pct / 100.0 * sorted.size()));
+    if (rank < 1)
+      rank = 1;
+    if (rank > sorted.size())
+      rank = sorted.size();
+    return sorted[rank - 1];
+  }
+
+  static double median(const BenchSamples &sorted) {
+    size_t cnt = sorted.size();
+    if (cnt == 0)
+      return 0.0;
+    if (cnt % 2 == 1)
+      return sorted[cnt / 2];
+    else
+      return (sorted[cnt / 2 - 1] + sorted[cnt / 2]) / 2.0;
+  }
+
+  static double mean(const BenchSamples &samples) {
+    if (samples.empty())
+      return 0.0;
+    double sum = 0.0;
+    for(BenchSamples::const_iterator it = samples.begin(), epos = samples.end(); it != epos; ++it)
+      sum += *it;
+    return sum / samples.size();
+  }
+
+  /// Fills result statistics using (unsorted) samples [ns]
+  static void calc(BenchSamples samples, uint64 items, uint64 bytes, BenchResult &output) {
+    std::sort(samples.begin(), samples.end());
+    output.runs = static_cast<uint>(samples.size());
+    output.minNs = samples.empty() ? 0.0 : samples.front();
+    output.maxNs = samples.empty() ? 0.0 : samples.back();
+    output.medianNs = median(samples);
+    output.p90Ns = percentile(samples, 90.0);
+    output.p99Ns = percentile(samples, 99.0);
+    output.meanNs = mean(samples);
+    if (output.medianNs > 0.0) {
+      output.itemsPerSec = static_cast<double>(items) * 1e9 / output.medianNs;
+      output.bytesPerSec = static_cast<double>(bytes) * 1e9 / output.medianNs;
+    } else {
+      output.itemsPerSec = output.bytesPerSec = 0.0;
+    }
+  }
+};
+
+// ----------------------------------------------------------------------------
+// BenchStopwatch
+// ----------------------------------------------------------------------------
+class BenchStopwatch {
+public:
+  typedef boost::chrono::steady_clock clock_type;
+
+  void start() { m_start = clock_type::now(); }
+  /// returns time since start in nanoseconds
+  double elapsedNs() const {
+    return static_cast<double>(
+      boost::chrono::duration_cast<boost::chrono::nanoseconds>(clock_type::now() - m_start).count());
+  }
+private:
+  clock_type::time_point m_start;
+};
+
+// ----------------------------------------------------------------------------
+// BenchReport
+// ----------------------------------------------------------------------------
+/// Reads & writes benchmark results in JSON / CSV formats.
+class BenchReport {
+public:
+  static const char *csvHeader() {
+    return "name,size,runs,min_ns,median_ns,p90_ns,p99_ns,max_ns,mean_ns,items_per_sec,bytes_per_sec,"
+      "bridge_allocs,pool_hits,pool_misses,deep_copies,string_allocs,type_conversions,exceptions";
+  }
+
+  static void writeCsv(const BenchResults &results, std::ostream &output) {
+    output << csvHeader() << "\n";
+    for(BenchResults::const_iterator it = results.begin(), epos = results.end(); it != epos; ++it) {
+      output << it->name << "," << it->size << "," << it->runs << ","
+        << fmt(it->minNs) << "," << fmt(it->medianNs) << "," << fmt(it->p90Ns) << "," << fmt(it->p99Ns) << ","
+        << fmt(it->maxNs) << "," << fmt(it->meanNs) << "," << fmt(it->itemsPerSec) << "," << fmt(it->bytesPerSec) << ","
+        << it->counters.bridgeAllocs << "," << it->counters.poolHits << "," << it->counters.poolMisses << ","
+        << it->counters.deepCopies << "," << it->counters.stringAllocs << "," << it->counters.typeConversions << ","
+        << it->counters.exceptionsThrown << "\n";
+    }
+  }
+
+  static void writeJson(const BenchResults &results, std::ostream &output) {
+    output << "{\n  \"benchmarks\": [";
+    for(BenchResults::const_iterator it = results.begin(), epos = results.end(); it != epos; ++it) {
+      if (it != results.begin())
+        output << ",";
+      output << "\n    {"
+        << "\"name\": \"" << it->name << "\", "
+        << "\"size\": " << it->size << ", "
+        << "\"runs\": " << it->runs << ", "
+        << "\"min_ns\": " << fmt(it->minNs) << ", "
+        << "\"median_ns\": " << fmt(it->medianNs) << ", "
+        << "\"p90_ns\": " << fmt(it->p90Ns) << ", "
+        << "\"p99_ns\": " << fmt(it->p99Ns) << ", "
+        << "\"max_ns\": " << fmt(it->maxNs) << ", "
+        << "\"mean_ns\": " << fmt(it->meanNs) << ", "
+        << "\"items_per_sec\": " << fmt(it->itemsPerSec) << ", "
+        << "\"bytes_per_sec\": " << fmt(it->bytesPerSec);
+      if (dtp::dnPerfStats::enabled()) {
+        output << ", \"counters\": {"
+          << "\"bridge_allocs\": " << it->counters.bridgeAllocs << ", "
+          << "\"pool_hits\": " << it->counters.poolHits << ", "
+          << "\"pool_misses\": " << it->counters.poolMisses << ", "
+          << "\"deep_copies\": " << it->counters.deepCopies << ", "
+          << "\"string_allocs\": " << it->counters.stringAllocs << ", "
+          << "\"type_conversions\": " << it->counters.typeConversions << ", "
+          << "\"exceptions\": " << it->counters.exceptionsThrown << "}";
+      }
+      output << "}";
+    }
+    output << "\n  ]\n}\n";
+  }
+
+  /// Reads CSV written by writeCsv. Only name, size, runs and timing columns are restored.
+  /// Returns false if input cannot be parsed.
+  static bool readCsv(std::istream &input, BenchResults &output) {
+    std::string line;
+    output.clear();
+    if (!std::getline(input, line))
+      return false;
+    if (line.compare(0, 5, "name,") != 0)
+      return false;
+
+    std::vector<std::string> cells;
+    while(std::getline(input, line)) {
+      if (line.empty())
+        continue;
+      splitCsvLine(line, cells);
+      if (cells.size() < 11)
+        return false;
+      BenchResult item;
+      item.name = cells[0];
+      item.size = stringToUInt(cells[1]);
+      item.runs = stringToUInt(cells[2]);
+      item.minNs = stringToDouble(cells[3]);
+      item.medianNs = stringToDouble(cells[4]);
+      item.p90Ns = stringToDouble(cells[5]);
+      item.p99Ns = stringToDouble(cells[6]);
+      item.maxNs = stringToDouble(cells[7]);
+      item.meanNs = stringToDouble(cells[8]);
+      item.itemsPerSec = stringToDouble(cells[9]);
+      item.bytesPerSec = stringToDouble(cells[10]);
+      output.push_back(item);
+    }
+    return true;
+  }
+
+  static bool readCsvFile(const dtpString &fname, BenchResults &output) {
+    std::ifstream input(fname.c_str());
+    if (!input.good())
+      return false;
+    return readCsv(input, output);
+  }
+
+protected:
+  static std::string fmt(double value) {
+    std::ostringstream out;
+    out.precision(3);
+    out << std::fixed << value;
+    return out.str();
+  }
+
+  static void splitCsvLine(const std::string &line, std::vector<std::string> &output) {
+    output.clear();
+    std::string::size_type startPos = 0, sepPos;
+    do {
+      sepPos = line.find(',', startPos);
+      if (sepPos == std::string::npos) {
+        output.push_back(line.substr(startPos));
+      } else {
+        output.push_back(line.substr(startPos, sepPos - startPos));
+        startPos = sepPos + 1;
+      }
+    } while (sepPos != std::string::npos);
+  }
+};
+
+// ----------------------------------------------------------------------------
+// BenchRunner
+// ----------------------------------------------------------------------------
+class BenchRunner {
+public:
+  BenchRunner(const BenchOptions &options): m_options(options) {}
+  virtual ~BenchRunner() {}
+
+  /// Adds case to be executed, takes ownership of object.
+  void addCase(BenchCase *benchCase) {
+    m_cases.push_back(BenchCaseGuard(benchCase));
+  }
+
+  /// Executes all cases for all sizes, returns number of executed benchmarks.
+  uint execute(std::ostream *log = DTP_NULL) {
+    uint res = 0;
+    for(std::vector<BenchCaseGuard>::iterator it = m_cases.begin(), epos = m_cases.end(); it != epos; ++it) {
+      if (!m_options.filter.empty() && ((*it)->getName().find(m_options.filter) == dtpString::npos))
+        continue;
+      for(std::vector<uint>::const_iterator sit = m_options.sizes.begin(), sepos = m_options.sizes.end(); sit != sepos; ++sit) {
+        m_results.push_back(executeCase(**it, *sit));
+        res++;
+        if (log != DTP_NULL)
+          (*log) << m_results.back().name << " [" << *sit << "]: median = " << m_results.back().medianNs << " ns\n";
+      }
+    }
+    return res;
+  }
+
+  const BenchResults &getResults() const { return m_results; }
+
+  void writeCsv(std::ostream &output) const { BenchReport::writeCsv(m_results, output); }
+  void writeJson(std::ostream &output) const { BenchReport::writeJson(m_results, output); }
+
+protected:
+  BenchResult executeCase(BenchCase &benchCase, uint size) {
+    BenchResult res;
+    BenchSamples samples;
+    BenchStopwatch stopwatch;
+
+    res.name = benchCase.getName();
+    res.size = size;
+
+    benchCase.setUp(size);
+
+    for(uint i=0; i < m_options.warmupRuns; i++) {
+      benchCase.run();
+      benchCase.reset();
+    }
+
+    samples.reserve(m_options.measuredRuns);
+    dtp::dnPerfStats::reset();
+
+    for(uint i=0; i < m_options.measuredRuns; i++) {
+      stopwatch.start();
+      benchCase.run();
+      samples.push_back(stopwatch.elapsedNs());
+      benchCase.reset();
+    }
+
+    dtp::dnPerfCounters counters = dtp::dnPerfStats::snapshot();
+    BenchStats::calc(samples, benchCase.items(), benchCase.bytes(), res);
+    averageCounters(counters, m_options.measuredRuns, res.counters);
+
+    benchCase.tearDown();
+    return res;
+  }
+
+  static void averageCounters(const dtp::dnPerfCounters &total, uint runs, dtp::dnPerfCounters &output) {
+    if (runs == 0)
+      runs = 1;
+    output.bridgeAllocs = total.bridgeAllocs / runs;
+    output.poolHits = total.poolHits / runs;
+    output.poolMisses = total.poolMisses / runs;
+    output.deepCopies = total.deepCopies / runs;
+    output.stringAllocs = total.stringAllocs / runs;
+    output.typeConversions = total.typeConversions / runs;
+    output.exceptionsThrown = total.exceptionsThrown / runs;
+  }
+
+private:
+  BenchOptions m_options;
+  std::vector<BenchCaseGuard> m_cases;
+  BenchResults m_results;
+};
+
+// ----------------------------------------------------------------------------
+// BenchComparator
+// ----------------------------------------------------------------------------
+/// Compares current results with a baseline using median run time.
+class BenchComparator {
+public:
+  enum Verdict { bvSame, bvRegression, bvImprovement, bvNew, bvMissing };
+
+  struct Item {
+    dtpString name;
+    uint size;
+    double baselineNs;
+    double currentNs;
+    double changePct;
+    Verdict verdict;
+  };
+
+  typedef std::vector<Item> Items;
+
+  /// @param[in] thresholdPct allowed slowdown in percent before run is reported as regression
+  BenchComparator(double thresholdPct = 10.0): m_thresholdPct(thresholdPct) {}
+
+  /// Returns number of regressions found
+  uint compare(const BenchResults &baseline, const BenchResults &current, Items &output) const {
+    uint res = 0;
+    output.clear();
+
+    for(BenchResults::const_iterator it = current.begin(), epos = current.end(); it != epos; ++it) {
+      Item item;
+      item.name = it->name;
+      item.size = it->size;
+      item.currentNs = it->medianNs;
+      item.baselineNs = 0.0;
+      item.changePct = 0.0;
+
+      const BenchResult *base = find(baseline, it->name, it->size);
+      if (base == DTP_NULL) {
+        item.verdict = bvNew;
+      } else {
+        item.baselineNs = base->medianNs;
+        if (base->medianNs > 0.0)
+          item.changePct = (it->medianNs - base->medianNs) * 100.0 / base->medianNs;
+        if (item.changePct > m_thresholdPct) {
+          item.verdict = bvRegression;
+          res++;
+        } else if (item.changePct < -m_thresholdPct) {
+          item.verdict = bvImprovement;
+        } else {
+          item.verdict = bvSame;
+        }
+      }
+      output.push_back(item);
+    }
+
+    for(BenchResults::const_iterator it = baseline.begin(), epos = baseline.end(); it != epos; ++it) {
+      if (find(current, it->name, it->size) == DTP_NULL) {
+        Item item;
+        item.name = it->name;
+        item.size = it->size;
+        item.baselineNs = it->medianNs;
+        item.currentNs = 0.0;
+        item.changePct = 0.0;
+        item.verdict = bvMissing;
+        output.push_back(item);
+      }
+    }
+
+    return res;
+  }
+
+  static const char *verdictName(Verdict value) {
+    switch (value) {
+      case bvSame: return "ok";
+      case bvRegression: return "REGRESSION";
+      case bvImprovement: return "improved";
+      case bvNew: return "new";
+      case bvMissing: return "missing";
+      default: return "?";
+    }
+  }
+
+protected:
+  static const BenchResult *find(const BenchResults &results, const dtpString &name, uint size) {
+    for(BenchResults::const_iterator it = results.begin(), epos = results.end(); it != epos; ++it)
+      if ((it->name == name) && (it->size == size))
+        return &(*it);
+    return DTP_NULL;
+  }
+private:
+  double m_thresholdPct;
+};
+
+} // namespace perf
+
+#endif // _DTPBENCHHARNESS_H__
@@ -3233,12 +3233,15 @@ void test_size_dnode_map_str()
 //-----------------------------------------
 template< class F >
 void addBench(F fun, const dtpString &testName, scDataNode &output) {
+  dnPerfStats::reset();
   Timer::reset("bench");
   Timer::start("bench");
   for(int i=1; i <= REPEAT_COUNT; i++)
     fun();
   Timer::stop("bench");
   output.addElement(testName, scDataNode(Timer::getTotal("bench")));
+  if (dnPerfStats::enabled())
+    BOOST_TEST_MESSAGE(testName + " counters: " + dnPerfStats::toString(dnPerfStats::snapshot()));
 }
 
 
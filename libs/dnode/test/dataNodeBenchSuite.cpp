@@ -0,0 +1,14 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dataNodeBenchSuite.cpp
+// Purpose:     Data node benchmark suite based on benchHarness.h
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#include "dataNodeBenchSuite.ipp"
+
+int main(int argc, char *argv[])
+{
+  return runBenchSuite(argc, argv);
+}
@@ -0,0 +1,1070 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dataNodeBenchSuite.ipp
+// Purpose:     Data node benchmark suite based on benchHarness.h
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+// Replacement for Timer-based dataNodeBench.
+// Each case is parameterized by item count and executed with warmup and
+// repeated measured runs, see benchHarness.h.
+//
+// containers: stl vector, stl map, dnode list, dnode parent, dnode array (double, byte),
+//             sparse array (double), compressed array (double), string pool,
+//             persistent store, indexed list (hash, sorted)
+// operations: insert, accum, find, traverse, sort, convert, stats, reduce,
+//             sketch (p99), json write/read, bion write/read,
+//             dump (string / stream),
+//             explode (line split),
+//             update (persistent store, in place + commit),
+//             group_by (count, sum, avg), hash_join (inner),
+//             expr_filter (row by row / batch on columns)
+//
+// command line:
+//   dataNodeBenchSuite [--format=csv|json] [--output=fname] [--sizes=1000,100000]
+//                      [--runs=15] [--warmup=2] [--filter=text]
+
+// std
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <cstdio>
+
+//base
+#include "base/string.h"
+
+//sc
+#include "dtp/dnode.h"
+#include "dtp/dnode_serializer.h"
+#include "dtp/dnode_bion.h"
+#include "dtp/dnode_split.h"
+#include "dtp/dnode_stats.h"
+#include "dtp/dnode_sketch.h"
+#include "dtp/dnode_sparse.h"
+#include "dtp/dnode_compressed.h"
+#include "dtp/dnode_string_pool.h"
+#include "dtp/dnode_persist.h"
+#include "dtp/dnode_index.h"
+#include "dtp/dnode_algorithm.h"
+#include "dtp/dnode_expr.h"
+
+#include "benchHarness.h"
+
+using namespace dtp;
+using namespace perf;
+
+namespace {
+
+// ----------------------------------------------------------------------------
+// helpers
+// ----------------------------------------------------------------------------
+void bench_fill_names(uint n, std::vector<dtpString> &names)
+{
+  dtpString str;
+  names.clear();
+  names.reserve(n);
+  for(uint i=1; i <= n; i++)
+    names.push_back(toString(i, str));
+}
+
+void bench_fill_list(uint n, dnode &node)
+{
+  node = dnode(ict_list);
+  for(uint i=0; i < n; i++)
+    node.addChild(new dnode(static_cast<int>(i % 10)));
+}
+
+void bench_fill_parent(const std::vector<dtpString> &names, dnode &node)
+{
+  node = dnode(ict_parent);
+  for(uint i=0, epos = names.size(); i < epos; i++)
+    node.addChild(names[i], new dnode(static_cast<int>(i % 10)));
+}
+
+void bench_fill_array_dbl(uint n, dnode &node)
+{
+  node = dnode(ict_array, vt_double);
+  for(uint i=0; i < n; i++)
+    node.addItem(static_cast<double>((i + 13) % n) / 10.0); // little unsorted
+}
+
+// ----------------------------------------------------------------------------
+// std::vector
+// ----------------------------------------------------------------------------
+class BenchInsertVector: public BenchCase {
+public:
+  BenchInsertVector(): BenchCase("insert", "vector") {}
+  virtual void run() {
+    for(uint i=0, epos = getSize(); i < epos; i++)
+      m_vect.push_back(i % 10);
+  }
+  virtual void reset() { std::vector<int>().swap(m_vect); }
+private:
+  std::vector<int> m_vect;
+};
+
+class BenchAccumVector: public BenchCase {
+public:
+  BenchAccumVector(): BenchCase("accum", "vector"), m_sum(0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    m_vect.clear();
+    for(uint i=0; i < size; i++)
+      m_vect.push_back(i % 10);
+  }
+  virtual void run() { m_sum += std::accumulate(m_vect.begin(), m_vect.end(), 0); }
+  virtual void tearDown() { m_vect.clear(); }
+  virtual uint64 bytes() const { return m_vect.size() * sizeof(int); }
+private:
+  std::vector<int> m_vect;
+  int m_sum;
+};
+
+class BenchFindVector: public BenchCase {
+public:
+  BenchFindVector(): BenchCase("find", "vector"), m_sum(0), m_step(1), m_searches(0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    m_vect.clear();
+    for(uint i=0; i < size; i++)
+      m_vect.push_back(i);
+    // find is O(n), search only for about 100 values spread over the vector
+    m_step = std::max<uint>(1, size / 100);
+    m_searches = (size + m_step - 1) / m_step;
+  }
+  virtual void run() {
+    for(uint i=0, epos = getSize(); i < epos; i += m_step)
+      m_sum += *std::find(m_vect.begin(), m_vect.end(), static_cast<int>(i));
+  }
+  virtual void tearDown() { m_vect.clear(); }
+  /// number of searches executed by run()
+  virtual uint64 items() const { return m_searches; }
+private:
+  std::vector<int> m_vect;
+  int m_sum;
+  uint m_step;
+  uint m_searches;
+};
+
+// ----------------------------------------------------------------------------
+// std::map
+// ----------------------------------------------------------------------------
+class BenchInsertMap: public BenchCase {
+public:
+  BenchInsertMap(): BenchCase("insert", "map") {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_names(size, m_names);
+  }
+  virtual void run() {
+    for(uint i=0, epos = m_names.size(); i < epos; i++)
+      m_map.insert(std::make_pair(m_names[i], static_cast<int>(i % 10)));
+  }
+  virtual void reset() { m_map.clear(); }
+  virtual void tearDown() { m_names.clear(); }
+private:
+  std::vector<dtpString> m_names;
+  std::map<dtpString, int> m_map;
+};
+
+class BenchFindMap: public BenchCase {
+public:
+  BenchFindMap(): BenchCase("find", "map"), m_sum(0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_names(size, m_names);
+    m_map.clear();
+    for(uint i=0, epos = m_names.size(); i < epos; i++)
+      m_map.insert(std::make_pair(m_names[i], static_cast<int>(i % 10)));
+  }
+  virtual void run() {
+    for(uint i=0, epos = m_names.size(); i < epos; i++)
+      m_sum += m_map.find(m_names[i])->second;
+  }
+  virtual void tearDown() { m_names.clear(); m_map.clear(); }
+private:
+  std::vector<dtpString> m_names;
+  std::map<dtpString, int> m_map;
+  int m_sum;
+};
+
+// ----------------------------------------------------------------------------
+// dnode list
+// ----------------------------------------------------------------------------
+class BenchInsertDnodeList: public BenchCase {
+public:
+  BenchInsertDnodeList(): BenchCase("insert", "dnode_list") {}
+  virtual void run() { bench_fill_list(getSize(), m_node); }
+  virtual void reset() { m_node.clear(); }
+private:
+  dnode m_node;
+};
+
+class BenchAccumDnodeList: public BenchCase {
+public:
+  BenchAccumDnodeList(): BenchCase("accum", "dnode_list"), m_sum(0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_list(size, m_node);
+  }
+  virtual void run() {
+    for(uint i=0, epos = m_node.size(); i < epos; i++)
+      m_sum += m_node.get<int>(i);
+  }
+  virtual void tearDown() { m_node.clear(); }
+private:
+  dnode m_node;
+  int m_sum;
+};
+
+class BenchIterDnodeList: public BenchCase {
+public:
+  BenchIterDnodeList(): BenchCase("iterate", "dnode_list"), m_sum(0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_list(size, m_node);
+  }
+  virtual void run() {
+    for(dnode::const_iterator it = m_node.begin(), epos = m_node.end(); it != epos; ++it)
+      m_sum += it->getAsInt();
+  }
+  virtual void tearDown() { m_node.clear(); }
+private:
+  dnode m_node;
+  int m_sum;
+};
+
+/// Queue use: push at back, pop from front (n operations on a list of size n)
+class BenchQueueDnodeList: public BenchCase {
+public:
+  BenchQueueDnodeList(dnInitContainerType listType, const char *name):
+    BenchCase("queue", name), m_listType(listType), m_sum(0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    m_node = dnode(m_listType);
+    for(uint i=0; i < size; i++)
+      m_node.push_back(static_cast<int>(i % 10));
+  }
+  virtual void run() {
+    for(uint i=0, epos = getSize(); i < epos; i++) {
+      m_sum += m_node.get<int>(0);
+      m_node.eraseElement(0);
+      m_node.push_back(static_cast<int>(i % 10));
+    }
+  }
+  virtual void tearDown() { m_node.clear(); }
+private:
+  dnInitContainerType m_listType;
+  dnode m_node;
+  int m_sum;
+};
+
+// ----------------------------------------------------------------------------
+// dnode parent
+// ----------------------------------------------------------------------------
+class BenchInsertDnodeParent: public BenchCase {
+public:
+  BenchInsertDnodeParent(): BenchCase("insert", "dnode_parent") {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_names(size, m_names);
+  }
+  virtual void run() { bench_fill_parent(m_names, m_node); }
+  virtual void reset() { m_node.clear(); }
+  virtual void tearDown() { m_names.clear(); }
+private:
+  std::vector<dtpString> m_names;
+  dnode m_node;
+};
+
+class BenchFindDnodeParent: public BenchCase {
+public:
+  BenchFindDnodeParent(): BenchCase("find", "dnode_parent"), m_sum(0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_names(size, m_names);
+    bench_fill_parent(m_names, m_node);
+  }
+  virtual void run() {
+    for(uint i=0, epos = m_names.size(); i < epos; i++)
+      m_sum += m_node.get<int>(m_names[i]);
+  }
+  virtual void tearDown() { m_names.clear(); m_node.clear(); }
+private:
+  std::vector<dtpString> m_names;
+  dnode m_node;
+  int m_sum;
+};
+
+/// Keyed lookup in list of parents using attached index
+class BenchFindIndexedList: public BenchCase {
+public:
+  BenchFindIndexedList(bool sorted, const char *name):
+    BenchCase("find", name), m_sorted(sorted), m_hashIndex(DTP_NULL), m_sortedIndex(DTP_NULL), m_sum(0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    m_list.clear();
+    m_list.removeIndex("id");
+    if (m_sorted) {
+      m_list.addIndex("id", new dnSortedIndex<int>("id"));
+      m_sortedIndex = &m_list.getIndexAs<dnSortedIndex<int> >("id");
+    } else {
+      m_list.addIndex("id", new dnHashIndex<int>("id"));
+      m_hashIndex = &m_list.getIndexAs<dnHashIndex<int> >("id");
+    }
+    dnode item(ict_parent);
+    item.addChild("id", new dnode(0));
+    item.addChild("value", new dnode(0));
+    for(uint i=0; i < size; i++) {
+      item.setElement("id", dnode(static_cast<int>(i)));
+      item.setElement("value", dnode(static_cast<int>(i % 10)));
+      m_list.addItem(item);
+    }
+  }
+  virtual void run() {
+    const uint n = getSize();
+    dnode::size_type pos;
+    for(uint i=0; i < n; i++) {
+      if (m_sorted)
+        pos = m_sortedIndex->find(static_cast<int>((i * 7) % n));
+      else
+        pos = m_hashIndex->find(static_cast<int>((i * 7) % n));
+      m_sum += m_list[pos].get<int>("value");
+    }
+  }
+  virtual void tearDown() { m_list.clear(); }
+private:
+  bool m_sorted;
+  dnIndexedList m_list;
+  dnHashIndex<int> *m_hashIndex;
+  dnSortedIndex<int> *m_sortedIndex;
+  int m_sum;
+};
+
+/// Hash grouping of list of parents by two keys with count, sum & avg
+class BenchGroupByDnodeList: public BenchCase {
+public:
+  BenchGroupByDnodeList(): BenchCase("group_by", "dnode_list"), m_sum(0) {
+    m_keys.push_back("city");
+    m_keys.push_back("shop");
+    m_aggregates.push_back(dnAggregateSpec(daf_count));
+    m_aggregates.push_back(dnAggregateSpec(daf_sum, "qty"));
+    m_aggregates.push_back(dnAggregateSpec(daf_avg, "price"));
+  }
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    m_rows = dnode(ict_list);
+    dnode item(ict_parent);
+    item.addChild("city", new dnode(dtpString()));
+    item.addChild("shop", new dnode(0));
+    item.addChild("qty", new dnode(0));
+    item.addChild("price", new dnode(0.0));
+    for(uint i=0; i < size; i++) {
+      item.setElement("city", dnode(dtpString("city") + toString(i % 100)));
+      item.setElement("shop", dnode(static_cast<int>(i % 7)));
+      item.setElement("qty", dnode(static_cast<int>(i % 10)));
+      item.setElement("price", dnode(static_cast<double>(i % 1000) * 0.01));
+      m_rows.addItem(item);
+    }
+  }
+  virtual void run() {
+    dnode output;
+    group_by(m_rows, m_keys, m_aggregates, output);
+    m_sum += output.size();
+  }
+  virtual void tearDown() { m_rows.clear(); }
+private:
+  dnode m_rows;
+  std::vector<dtpString> m_keys;
+  std::vector<dnAggregateSpec> m_aggregates;
+  dnode::size_type m_sum;
+};
+
+/// Inner hash join of orders with customers (hash table for customers)
+class BenchHashJoinDnodeList: public BenchCase {
+public:
+  BenchHashJoinDnodeList(): BenchCase("hash_join", "dnode_list"),
+    m_leftKeys(1, "customer_id"), m_rightKeys(1, "id"), m_sum(0)
+  {
+    m_columns.push_back(dnJoinColumn(djs_left, "order_no"));
+    m_columns.push_back(dnJoinColumn(djs_right, "name"));
+  }
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    const uint customerCount = size / 10 + 1;
+    m_orders = dnode(ict_list);
+    m_customers = dnode(ict_list);
+
+    dnode item(ict_parent);
+    item.addChild("order_no", new dnode(0));
+    item.addChild("customer_id", new dnode(0));
+    for(uint i=0; i < size; i++) {
+      item.setElement("order_no", dnode(static_cast<int>(i)));
+      item.setElement("customer_id", dnode(static_cast<int>((i * 7) % customerCount)));
+      m_orders.addItem(item);
+    }
+
+    dnode customer(ict_parent);
+    customer.addChild("id", new dnode(0));
+    customer.addChild("name", new dnode(dtpString()));
+    for(uint i=0; i < customerCount; i++) {
+      customer.setElement("id", dnode(static_cast<int>(i)));
+      customer.setElement("name", dnode(dtpString("customer") + toString(i)));
+      m_customers.addItem(customer);
+    }
+  }
+  virtual void run() {
+    dnode output;
+    hash_join(m_orders, m_customers, m_leftKeys, m_rightKeys, m_columns, djt_inner, output);
+    m_sum += output.size();
+  }
+  virtual void tearDown() {
+    m_orders.clear();
+    m_customers.clear();
+  }
+private:
+  dnode m_orders;
+  dnode m_customers;
+  std::vector<dtpString> m_leftKeys;
+  std::vector<dtpString> m_rightKeys;
+  std::vector<dnJoinColumn> m_columns;
+  dnode::size_type m_sum;
+};
+
+/// Filter by compiled expression: row by row on list, in batches on columns
+class BenchExprFilter: public BenchCase {
+public:
+  BenchExprFilter(bool columnar, const char *container): BenchCase("expr_filter", container),
+    m_columnar(columnar), m_sum(0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    if (m_columnar) {
+      m_table = dnode(ict_parent);
+      dnode *qty = new dnode(ict_array, vt_int);
+      dnode *price = new dnode(ict_array, vt_double);
+      for(uint i=0; i < size; i++) {
+        qty->addItem(static_cast<int>(i % 10));
+        price->addItem(static_cast<double>(i % 1000) * 0.01);
+      }
+      m_table.addChild("qty", qty);
+      m_table.addChild("price", price);
+    } else {
+      m_table = dnode(ict_list);
+      dnode item(ict_parent);
+      item.addChild("qty", new dnode(0));
+      item.addChild("price", new dnode(0.0));
+      for(uint i=0; i < size; i++) {
+        item.setElement("qty", dnode(static_cast<int>(i % 10)));
+        item.setElement("price", dnode(static_cast<double>(i % 1000) * 0.01));
+        m_table.addItem(item);
+      }
+    }
+  }
+  virtual void run() {
+    dnode output;
+    expr_filter(m_table, "qty * price > 20 and qty % 2 = 0", output);
+    m_sum += output.size();
+  }
+  virtual void tearDown() { m_table.clear(); }
+private:
+  bool m_columnar;
+  dnode m_table;
+  dnode::size_type m_sum;
+};
+
+/// Read pass over table built row by row, optionally compacted after build
+class BenchTraverseDnodeTree: public BenchCase {
+public:
+  BenchTraverseDnodeTree(bool compact, const char *name):
+    BenchCase("traverse", name), m_compact(compact), m_sum(0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    // two tables built together, so rows of each are scattered on heap
+    dnode other(ict_list);
+    m_node = dnode(ict_list);
+    for(uint i=0; i < size; i++) {
+      m_node.addChild(newRow(i));
+      other.addChild(newRow(i));
+    }
+    if (m_compact)
+      m_node.compact();
+  }
+  virtual void run() {
+    const dnode &table = m_node;
+    for(uint i=0, epos = table.size(); i < epos; i++) {
+      const dnode &row = table[i];
+      m_sum += row.get<int>("id") + row["value"].getAsInt();
+    }
+  }
+  virtual void tearDown() { m_node.clear(); }
+protected:
+  static dnode *newRow(uint index) {
+    dnode *row = new dnode(ict_parent);
+    row->addChild("id", new dnode(static_cast<int>(index)));
+    row->addChild("value", new dnode(static_cast<int>(index % 10)));
+    return row;
+  }
+private:
+  bool m_compact;
+  dnode m_node;
+  int m_sum;
+};
+
+// ----------------------------------------------------------------------------
+// dnode array
+// ----------------------------------------------------------------------------
+class BenchInsertDnodeArray: public BenchCase {
+public:
+  BenchInsertDnodeArray(): BenchCase("insert", "dnode_array_dbl") {}
+  virtual void run() { bench_fill_array_dbl(getSize(), m_node); }
+  virtual void reset() { m_node.clear(); }
+  virtual uint64 bytes() const { return static_cast<uint64>(getSize()) * sizeof(double); }
+private:
+  dnode m_node;
+};
+
+class BenchAccumDnodeArray: public BenchCase {
+public:
+  BenchAccumDnodeArray(): BenchCase("accum", "dnode_array_dbl"), m_sum(0.0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_array_dbl(size, m_node);
+  }
+  virtual void run() {
+    for(uint i=0, epos = m_node.size(); i < epos; i++)
+      m_sum += m_node.get<double>(i);
+  }
+  virtual void tearDown() { m_node.clear(); }
+  virtual uint64 bytes() const { return static_cast<uint64>(getSize()) * sizeof(double); }
+private:
+  dnode m_node;
+  double m_sum;
+};
+
+class BenchSortDnodeArray: public BenchCase {
+public:
+  BenchSortDnodeArray(): BenchCase("sort", "dnode_array_dbl") {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_array_dbl(size, m_source);
+    m_node.copyFrom(m_source);
+  }
+  virtual void run() { m_node.sort(); }
+  virtual void reset() { m_node.copyFrom(m_source); }
+  virtual void tearDown() { m_node.clear(); m_source.clear(); }
+  virtual uint64 bytes() const { return static_cast<uint64>(getSize()) * sizeof(double); }
+private:
+  dnode m_source;
+  dnode m_node;
+};
+
+class BenchConvertDnodeArray: public BenchCase {
+public:
+  BenchConvertDnodeArray(): BenchCase("convert", "dnode_array_dbl") {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_array_dbl(size, m_source);
+    m_node.copyFrom(m_source);
+  }
+  virtual void run() { m_node.forceElementTypeAll(vt_int); }
+  virtual void reset() { m_node.copyFrom(m_source); }
+  virtual void tearDown() { m_node.clear(); m_source.clear(); }
+  virtual uint64 bytes() const { return static_cast<uint64>(getSize()) * sizeof(double); }
+private:
+  dnode m_source;
+  dnode m_node;
+};
+
+class BenchConvertDnodeValue: public BenchCase {
+public:
+  BenchConvertDnodeValue(): BenchCase("convert", "dnode_value"), m_sum(0) {}
+  virtual void run() {
+    dnode value;
+    for(uint i=0, epos = getSize(); i < epos; i++) {
+      value.setAs<int>(static_cast<int>(i));
+      value.convertTo(vt_double);
+      value.convertTo(vt_int64);
+      m_sum += value.getAs<int64>();
+    }
+  }
+private:
+  int64 m_sum;
+};
+
+class BenchStatsDnodeArray: public BenchCase {
+public:
+  BenchStatsDnodeArray(): BenchCase("stats", "dnode_array_dbl"), m_variance(0.0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_array_dbl(size, m_node);
+  }
+  virtual void run() {
+    dnStatsAccumulator stats;
+    dstat_array(m_node, stats);
+    m_variance = stats.variance();
+  }
+  virtual void tearDown() { m_node.clear(); }
+  virtual uint64 bytes() const { return static_cast<uint64>(getSize()) * sizeof(double); }
+private:
+  dnode m_node;
+  double m_variance;
+};
+
+class BenchSketchDnodeArray: public BenchCase {
+public:
+  BenchSketchDnodeArray(): BenchCase("sketch", "dnode_array_dbl"), m_p99(0.0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_array_dbl(size, m_node);
+  }
+  virtual void run() {
+    dnQuantileSketch sketch;
+    dsketch_add_array(m_node, sketch);
+    m_p99 = sketch.quantile(0.99);
+  }
+  virtual void tearDown() { m_node.clear(); }
+  virtual uint64 bytes() const { return static_cast<uint64>(getSize()) * sizeof(double); }
+private:
+  dnode m_node;
+  double m_p99;
+};
+
+struct BenchByteSumVisitor {
+  uint64 total;
+  BenchByteSumVisitor(): total(0) {}
+  void operator()(byte value) { total += value; }
+};
+
+/// Sum of byte array, fixedCount > 0 overrides item count given by size
+/// (to test arrays over 4G items with DATANODE_SIZE64)
+class BenchReduceDnodeByteArray: public BenchCase {
+public:
+  BenchReduceDnodeByteArray(uint64 fixedCount, const char *name):
+    BenchCase("reduce", name), m_fixedCount(fixedCount), m_count(0), m_sum(0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    m_count = (m_fixedCount > 0) ? m_fixedCount : size;
+    m_node = dnode(ict_array, vt_byte);
+    m_node.resize(static_cast<dnode::size_type>(m_count));
+    for(dnode::size_type i=0, epos = m_node.size(); i < epos; i += 4096)
+      m_node.set<byte>(i, static_cast<byte>(i % 251));
+  }
+  virtual void run() {
+    m_sum += m_node.visitVectorValues<byte>(BenchByteSumVisitor()).total;
+  }
+  virtual void tearDown() { m_node.clear(); }
+  virtual uint64 bytes() const { return m_count; }
+private:
+  uint64 m_fixedCount;
+  uint64 m_count;
+  dnode m_node;
+  uint64 m_sum;
+};
+
+/// Sum of sparse array with 1% of non-default items
+class BenchReduceSparseArray: public BenchCase {
+public:
+  BenchReduceSparseArray(): BenchCase("reduce", "sparse_array_dbl"), m_sum(0.0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    m_array = dnSparseArray<double>(size);
+    for(uint i=0; i < size; i += 100)
+      m_array.set(i, static_cast<double>(i % 17));
+  }
+  virtual void run() { m_sum += m_array.sum(0.0); }
+  virtual void tearDown() { m_array.clear(); }
+  virtual uint64 bytes() const { return static_cast<uint64>(getSize()) * sizeof(double); }
+private:
+  dnSparseArray<double> m_array;
+  double m_sum;
+};
+
+class BenchReduceCompressedArray: public BenchCase {
+public:
+  BenchReduceCompressedArray(): BenchCase("reduce", "compressed_array_dbl"), m_sum(0.0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    dnode source;
+    bench_fill_array_dbl(size, source);
+    m_array.fromArray(source);
+  }
+  virtual void run() { m_sum += m_array.sum(0.0); }
+  virtual void tearDown() { m_array.clear(); }
+  virtual uint64 bytes() const { return static_cast<uint64>(getSize()) * sizeof(double); }
+private:
+  dnCompressedArray<double> m_array;
+  double m_sum;
+};
+
+class BenchSortStrings: public BenchCase {
+public:
+  BenchSortStrings(bool packed, const char *name): BenchCase("sort", name), m_packed(packed), m_bytes(0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    std::vector<dtpString> names;
+    bench_fill_names(size, names);
+    std::reverse(names.begin(), names.end());
+    m_source = dnode(ict_array, vt_string);
+    m_bytes = 0;
+    for(uint i=0, epos = names.size(); i < epos; i++) {
+      m_source.addItem(names[i]);
+      m_bytes += names[i].length();
+    }
+    reset();
+  }
+  virtual void run() {
+    if (m_packed)
+      m_pool.sort();
+    else
+      m_node.sort();
+  }
+  virtual void reset() {
+    if (m_packed)
+      m_pool.fromArray(m_source);
+    else
+      m_node.copyFrom(m_source);
+  }
+  virtual void tearDown() { m_node.clear(); m_source.clear(); m_pool.clear(); }
+  virtual uint64 bytes() const { return m_bytes; }
+private:
+  bool m_packed;
+  uint64 m_bytes;
+  dnode m_source;
+  dnode m_node;
+  dnStringPool m_pool;
+};
+
+// ----------------------------------------------------------------------------
+// serialization
+// ----------------------------------------------------------------------------
+class BenchJsonWrite: public BenchCase {
+public:
+  BenchJsonWrite(): BenchCase("json_write", "dnode_list") {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_list(size, m_node);
+  }
+  virtual void run() { m_serializer.convToString(m_node, m_text); }
+  virtual void tearDown() { m_node.clear(); }
+  virtual uint64 bytes() const { return m_text.length(); }
+private:
+  dnSerializer m_serializer;
+  dnode m_node;
+  dtpString m_text;
+};
+
+class BenchJsonRead: public BenchCase {
+public:
+  BenchJsonRead(): BenchCase("json_read", "dnode_list") {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    dnode node;
+    bench_fill_list(size, node);
+    m_serializer.convToString(node, m_text);
+  }
+  virtual void run() { m_serializer.convFromString(m_text, m_node); }
+  virtual void reset() { m_node.clear(); }
+  virtual void tearDown() { m_text.clear(); }
+  virtual uint64 bytes() const { return m_text.length(); }
+private:
+  dnSerializer m_serializer;
+  dnode m_node;
+  dtpString m_text;
+};
+
+/// Debug dump of table, built as one string or streamed
+class BenchDumpDnodeList: public BenchCase {
+public:
+  BenchDumpDnodeList(bool stream, const char *name):
+    BenchCase("dump", name), m_stream(stream), m_size(0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_list(size, m_node);
+  }
+  virtual void run() {
+    if (m_stream) {
+      std::ostringstream output;
+      m_node.dump(output);
+      m_size = output.tellp();
+    } else {
+      m_size = m_node.dump().length();
+    }
+  }
+  virtual void tearDown() { m_node.clear(); }
+  virtual uint64 bytes() const { return m_size; }
+private:
+  bool m_stream;
+  dnode m_node;
+  uint64 m_size;
+};
+
+class BenchBionWrite: public BenchCase {
+public:
+  BenchBionWrite(): BenchCase("bion_write", "dnode_list"), m_bytes(0) {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_list(size, m_node);
+  }
+  virtual void run() {
+    std::stringstream s;
+    dnBionWriter<std::stringstream> writer(s);
+    writer.write(m_node);
+    m_bytes = static_cast<uint64>(s.tellp());
+  }
+  virtual void tearDown() { m_node.clear(); }
+  virtual uint64 bytes() const { return m_bytes; }
+private:
+  dnode m_node;
+  uint64 m_bytes;
+};
+
+class BenchBionRead: public BenchCase {
+public:
+  BenchBionRead(): BenchCase("bion_read", "dnode_list") {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    dnode node;
+    bench_fill_list(size, node);
+    std::stringstream s;
+    dnBionWriter<std::stringstream> writer(s);
+    writer.write(node);
+    m_data = s.str();
+  }
+  virtual void run() {
+    std::stringstream s(m_data);
+    dnBionProcessor proc(m_node);
+    BionReader<std::stringstream, dnBionProcessor> reader(s, proc);
+    reader.process();
+  }
+  virtual void reset() { m_node.clear(); }
+  virtual void tearDown() { m_data.clear(); }
+  virtual uint64 bytes() const { return m_data.length(); }
+private:
+  dnode m_node;
+  std::string m_data;
+};
+
+// ----------------------------------------------------------------------------
+// persistent store
+// ----------------------------------------------------------------------------
+class BenchUpdatePersistentStore: public BenchCase {
+public:
+  BenchUpdatePersistentStore(): BenchCase("update", "persistent_store"), m_fileName("bench_suite.dnp") {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    std::remove(m_fileName.c_str());
+    dnode root(ict_parent);
+    dnode *values = new dnode(ict_array, vt_double);
+    for(uint i=0; i < size; i++)
+      values->addItem(0.0);
+    root.addChild("values", values);
+    m_store.open(m_fileName);
+    m_store.setRoot(root);
+    m_store.commit();
+  }
+  virtual void run() {
+    dtpString path;
+    for(uint i=0; i < getSize(); i++) {
+      path = "values/" + toString(i);
+      m_store.setElement(path, dnode(static_cast<double>(i)));
+    }
+    m_store.commit();
+  }
+  virtual void tearDown() {
+    m_store.close();
+    std::remove(m_fileName.c_str());
+  }
+private:
+  dnPersistentStore m_store;
+  dtpString m_fileName;
+};
+
+// ----------------------------------------------------------------------------
+// string splitting
+// ----------------------------------------------------------------------------
+void bench_fill_line(uint n, dtpString &line)
+{
+  dtpString str;
+  line.clear();
+  for(uint i=0; i < n; i++) {
+    if (i > 0)
+      line += ",";
+    line += toString(i % 1000, str);
+  }
+}
+
+class BenchExplodeLine: public BenchCase {
+public:
+  BenchExplodeLine(): BenchCase("explode", "dnode_list") {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_line(size, m_line);
+  }
+  virtual void run() { dnode::explode(",", m_line, m_node); }
+  virtual void reset() { m_node.clear(); }
+  virtual void tearDown() { m_line.clear(); }
+  virtual uint64 bytes() const { return m_line.length(); }
+private:
+  dnode m_node;
+  dtpString m_line;
+};
+
+class BenchSplitLineInt: public BenchCase {
+public:
+  BenchSplitLineInt(): BenchCase("explode", "dnode_array_int") {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_line(size, m_line);
+  }
+  virtual void run() { dstr_explode(m_line, ",", m_node, vt_int); }
+  virtual void tearDown() { m_line.clear(); m_node.clear(); }
+  virtual uint64 bytes() const { return m_line.length(); }
+private:
+  dnode m_node;
+  dtpString m_line;
+};
+
+class BenchSplitLineRefs: public BenchCase {
+public:
+  BenchSplitLineRefs(): BenchCase("explode", "vector_ref") {}
+  virtual void setUp(uint size) {
+    BenchCase::setUp(size);
+    bench_fill_line(size, m_line);
+  }
+  virtual void run() { dstr_split(m_line, ",", m_fields); }
+  virtual void tearDown() { m_line.clear(); m_fields.clear(); }
+  virtual uint64 bytes() const { return m_line.length(); }
+private:
+  std::vector<dnStringRef> m_fields;
+  dtpString m_line;
+};
+
+// ----------------------------------------------------------------------------
+// suite
+// ----------------------------------------------------------------------------
+void addBenchSuiteCases(BenchRunner &runner)
+{
+  runner.addCase(new BenchInsertVector());
+  runner.addCase(new BenchAccumVector());
+  runner.addCase(new BenchFindVector());
+  runner.addCase(new BenchInsertMap());
+  runner.addCase(new BenchFindMap());
+  runner.addCase(new BenchInsertDnodeList());
+  runner.addCase(new BenchAccumDnodeList());
+  runner.addCase(new BenchIterDnodeList());
+  runner.addCase(new BenchQueueDnodeList(ict_list, "dnode_list"));
+  runner.addCase(new BenchQueueDnodeList(ict_deque, "dnode_deque"));
+  runner.addCase(new BenchInsertDnodeParent());
+  runner.addCase(new BenchFindDnodeParent());
+  runner.addCase(new BenchFindIndexedList(false, "indexed_list_hash"));
+  runner.addCase(new BenchFindIndexedList(true, "indexed_list_sorted"));
+  runner.addCase(new BenchGroupByDnodeList());
+  runner.addCase(new BenchHashJoinDnodeList());
+  runner.addCase(new BenchExprFilter(false, "dnode_list"));
+  runner.addCase(new BenchExprFilter(true, "dnode_columns"));
+  runner.addCase(new BenchTraverseDnodeTree(false, "dnode_tree"));
+  runner.addCase(new BenchTraverseDnodeTree(true, "dnode_tree_compact"));
+  runner.addCase(new BenchInsertDnodeArray());
+  runner.addCase(new BenchAccumDnodeArray());
+  runner.addCase(new BenchSortDnodeArray());
+  runner.addCase(new BenchConvertDnodeArray());
+  runner.addCase(new BenchConvertDnodeValue());
+  runner.addCase(new BenchStatsDnodeArray());
+  runner.addCase(new BenchSketchDnodeArray());
+  runner.addCase(new BenchReduceDnodeByteArray(0, "dnode_array_byte"));
+#ifdef DATANODE_SIZE64
+  runner.addCase(new BenchReduceDnodeByteArray(0x100000000ULL + 1024, "dnode_array_byte_4g"));
+#endif
+  runner.addCase(new BenchReduceSparseArray());
+  runner.addCase(new BenchReduceCompressedArray());
+  runner.addCase(new BenchSortStrings(false, "dnode_array_str"));
+  runner.addCase(new BenchSortStrings(true, "string_pool"));
+  runner.addCase(new BenchJsonWrite());
+  runner.addCase(new BenchJsonRead());
+  runner.addCase(new BenchDumpDnodeList(false, "dnode_list_string"));
+  runner.addCase(new BenchDumpDnodeList(true, "dnode_list_stream"));
+  runner.addCase(new BenchBionWrite());
+  runner.addCase(new BenchBionRead());
+  runner.addCase(new BenchUpdatePersistentStore());
+  runner.addCase(new BenchExplodeLine());
+  runner.addCase(new BenchSplitLineInt());
+  runner.addCase(new BenchSplitLineRefs());
+}
+
+bool readBenchOption(const dtpString &arg, const char *name, dtpString &output)
+{
+  dtpString prefix = dtpString("--") + name + "=";
+  if (arg.compare(0, prefix.length(), prefix) != 0)
+    return false;
+  output = arg.substr(prefix.length());
+  return true;
+}
+
+void parseBenchSizes(const dtpString &text, std::vector<uint> &output)
+{
+  output.clear();
+  std::istringstream input(text);
+  dtpString item;
+  while(std::getline(input, item, ','))
+    if (!item.empty())
+      output.push_back(stringToUInt(item));
+}
+
+} // namespace
+
+int runBenchSuite(int argc, char *argv[])
+{
+  BenchOptions options;
+  dtpString format("csv"), outputName, value;
+
+  for(int i=1; i < argc; i++) {
+    dtpString arg(argv[i]);
+    if (readBenchOption(arg, "format", value))
+      format = value;
+    else if (readBenchOption(arg, "output", value))
+      outputName = value;
+    else if (readBenchOption(arg, "sizes", value))
+      parseBenchSizes(value, options.sizes);
+    else if (readBenchOption(arg, "runs", value))
+      options.measuredRuns = stringToUInt(value);
+    else if (readBenchOption(arg, "warmup", value))
+      options.warmupRuns = stringToUInt(value);
+    else if (readBenchOption(arg, "filter", value))
+      options.filter = value;
+    else {
+      std::cerr << "Unknown argument: " << arg << "\n"
+        << "Usage: " << argv[0]
+        << " [--format=csv|json] [--output=fname] [--sizes=n1,n2] [--runs=n] [--warmup=n] [--filter=text]\n";
+      return 2;
+    }
+  }
+
+  if ((format != "csv") && (format != "json")) {
+    std::cerr << "Unknown format: " << format << "\n";
+    return 2;
+  }
+
+  BenchRunner runner(options);
+  addBenchSuiteCases(runner);
+  runner.execute(&std::cerr);
+
+  std::ofstream outFile;
+  if (!outputName.empty()) {
+    outFile.open(outputName.c_str());
+    if (!outFile.good()) {
+      std::cerr << "Cannot open output file: " << outputName << "\n";
+      return 1;
+    }
+  }
+
+  std::ostream &output = outputName.empty() ? std::cout : outFile;
+  if (format == "json")
+    runner.writeJson(output);
+  else
+    runner.writeCsv(output);
+
+  return 0;
+}
@@ -131,3 +131,48 @@ BOOST_AUTO_TEST_CASE(array_processing)
 #endif
 }
 
+
+BOOST_AUTO_TEST_CASE(test_array_force_type_all)
+{
+  dnode arr(ict_array, vt_int);
+  for(int i=0; i < 100; i++)
+    arr.addItem(i - 50);
+
+  // widening
+  arr.forceElementTypeAll(vt_double);
+  BOOST_CHECK(arr.getArrayR()->getValueType() == vt_double);
+  BOOST_CHECK(arr.size() == 100);
+  BOOST_CHECK(arr.get<double>(0) == -50.0);
+  BOOST_CHECK(arr.get<double>(99) == 49.0);
+
+  // narrowing - values are kept in target range, out of range cast is undefined
+  dnode narrow(ict_array, vt_double);
+  for(int i=0; i < 100; i++)
+    narrow.addItem(i * 2.0);
+  narrow.setElement(1, dnode(2.5));
+  narrow.forceElementTypeAll(vt_byte);
+  BOOST_CHECK(narrow.getArrayR()->getValueType() == vt_byte);
+  BOOST_CHECK(narrow.get<int>(1) == 2);
+  BOOST_CHECK(narrow.get<int>(60) == 120);
+  BOOST_CHECK(narrow.get<int>(99) == 198);
+
+  narrow.forceElementTypeAll(vt_float);
+  BOOST_CHECK(narrow.get<float>(60) == 120.0f);
+
+  // empty array
+  dnode empty(ict_array, vt_uint);
+  empty.forceElementTypeAll(vt_xdouble);
+  BOOST_CHECK(empty.getArrayR()->getValueType() == vt_xdouble);
+  BOOST_CHECK(empty.empty());
+
+  // node array - converted item by item
+  dnode nodes(ict_array, vt_datanode);
+  nodes.addItem(dnode(1));
+  nodes.addItem(dnode(dtpString("2")));
+  nodes.forceElementTypeAll(vt_int);
+  BOOST_CHECK(nodes.getElementType(1) == vt_int);
+  BOOST_CHECK(nodes.get<int>(1) == 2);
+
+  // only numeric value arrays can change type
+  BOOST_CHECK_THROW(arr.forceElementTypeAll(vt_string), dnError);
+}
@@ -0,0 +1,14 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dataNodeTestBenchHarness.cpp
+// Purpose:     Test benchmark harness statistics, reports & comparator.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#define BOOST_TEST_NO_MAIN
+#define BOOST_TEST_MODULE BenchHarness
+//#include <boost/test/unit_test.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include "dataNodeTestBenchHarness.ipp"
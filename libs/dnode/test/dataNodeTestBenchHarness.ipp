@@ -0,0 +1,210 @@
+#include <sstream>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_serializer.h"
+
+#include "benchHarness.h"
+
+using namespace dtp;
+using namespace perf;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+BenchResult bench_test_result(const dtpString &name, uint size, double medianNs)
+{
+  BenchResult res;
+  res.name = name;
+  res.size = size;
+  res.runs = 15;
+  res.minNs = medianNs - 10.5;
+  res.medianNs = medianNs;
+  res.p90Ns = medianNs + 20.25;
+  res.p99Ns = medianNs + 30.125;
+  res.maxNs = medianNs + 40;
+  res.meanNs = medianNs + 1.5;
+  res.itemsPerSec = 1234567.5;
+  res.bytesPerSec = 0;
+  return res;
+}
+
+/// Counts calls of each step
+class BenchTestCountingCase: public BenchCase {
+public:
+  BenchTestCountingCase(): BenchCase("count", "test"), m_runs(0), m_resets(0) {}
+  virtual void run() { m_runs++; }
+  virtual void reset() { m_resets++; }
+  uint getRuns() const { return m_runs; }
+  uint getResets() const { return m_resets; }
+private:
+  uint m_runs;
+  uint m_resets;
+};
+
+BOOST_AUTO_TEST_CASE(test_bench_stats)
+{
+  BenchSamples sorted;
+  for(int i=1; i <= 100; i++)
+    sorted.push_back(i);
+
+  BOOST_CHECK(BenchStats::percentile(sorted, 0.0) == 1.0);
+  BOOST_CHECK(BenchStats::percentile(sorted, 50.0) == 50.0);
+  BOOST_CHECK(BenchStats::percentile(sorted, 90.0) == 90.0);
+  BOOST_CHECK(BenchStats::percentile(sorted, 99.0) == 99.0);
+  BOOST_CHECK(BenchStats::percentile(sorted, 100.0) == 100.0);
+  BOOST_CHECK(BenchStats::median(sorted) == 50.5);
+  BOOST_CHECK(BenchStats::mean(sorted) == 50.5);
+
+  // nearest rank on a small set
+  BenchSamples four;
+  for(int i=1; i <= 4; i++)
+    four.push_back(i * 10);
+  BOOST_CHECK(BenchStats::percentile(four, 25.0) == 10.0);
+  BOOST_CHECK(BenchStats::percentile(four, 26.0) == 20.0);
+  BOOST_CHECK(BenchStats::percentile(four, 90.0) == 40.0);
+  BOOST_CHECK(BenchStats::median(four) == 25.0);
+
+  BenchSamples empty;
+  BOOST_CHECK(BenchStats::percentile(empty, 50.0) == 0.0);
+  BOOST_CHECK(BenchStats::median(empty) == 0.0);
+
+  // calc sorts samples
+  BenchSamples samples;
+  samples.push_back(500);
+  samples.push_back(100);
+  samples.push_back(400);
+  samples.push_back(200);
+  samples.push_back(300);
+  BenchResult result;
+  BenchStats::calc(samples, 1000, 4000, result);
+  BOOST_CHECK(result.runs == 5);
+  BOOST_CHECK(result.minNs == 100.0);
+  BOOST_CHECK(result.maxNs == 500.0);
+  BOOST_CHECK(result.medianNs == 300.0);
+  BOOST_CHECK(result.p90Ns == 500.0);
+  BOOST_CHECK(result.meanNs == 300.0);
+  BOOST_CHECK_CLOSE(result.itemsPerSec, 1000 * 1e9 / 300.0, 1e-9);
+  BOOST_CHECK_CLOSE(result.bytesPerSec, 4000 * 1e9 / 300.0, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(test_bench_report_csv)
+{
+  BenchResults results;
+  results.push_back(bench_test_result("insert_vector", 1000, 1500.5));
+  results.push_back(bench_test_result("find_map", 100000, 98765.25));
+
+  std::stringstream csv;
+  BenchReport::writeCsv(results, csv);
+
+  BenchResults restored;
+  BOOST_CHECK(BenchReport::readCsv(csv, restored));
+  BOOST_REQUIRE(restored.size() == 2);
+  for(size_t i=0; i < results.size(); i++) {
+    BOOST_CHECK(restored[i].name == results[i].name);
+    BOOST_CHECK(restored[i].size == results[i].size);
+    BOOST_CHECK(restored[i].runs == results[i].runs);
+    BOOST_CHECK(restored[i].minNs == results[i].minNs);
+    BOOST_CHECK(restored[i].medianNs == results[i].medianNs);
+    BOOST_CHECK(restored[i].p90Ns == results[i].p90Ns);
+    BOOST_CHECK(restored[i].p99Ns == results[i].p99Ns);
+    BOOST_CHECK(restored[i].maxNs == results[i].maxNs);
+    BOOST_CHECK(restored[i].meanNs == results[i].meanNs);
+    BOOST_CHECK(restored[i].itemsPerSec == results[i].itemsPerSec);
+  }
+
+  std::stringstream invalid("median,name\n1,2\n");
+  BOOST_CHECK(!BenchReport::readCsv(invalid, restored));
+  std::stringstream truncated(dtpString(BenchReport::csvHeader()) + "\ninsert_vector,1000\n");
+  BOOST_CHECK(!BenchReport::readCsv(truncated, restored));
+}
+
+BOOST_AUTO_TEST_CASE(test_bench_report_json)
+{
+  BenchResults results;
+  results.push_back(bench_test_result("insert_vector", 1000, 1500.5));
+  results.push_back(bench_test_result("find_map", 100000, 98765.25));
+
+  std::stringstream json;
+  BenchReport::writeJson(results, json);
+  BOOST_TEST_MESSAGE("json: " << json.str());
+
+  dnode report;
+  dnSerializer serializer;
+  serializer.convFromString(json.str(), report);
+
+  BOOST_REQUIRE(report.hasChild("benchmarks"));
+  dnode benchmarks = report["benchmarks"];
+  BOOST_REQUIRE(benchmarks.size() == 2);
+  dnode item = benchmarks.getElement(1);
+  BOOST_CHECK(item.get<dtpString>("name") == "find_map");
+  BOOST_CHECK(item.get<uint>("size") == 100000);
+  BOOST_CHECK(item.get<uint>("runs") == 15);
+  BOOST_CHECK(item.get<double>("median_ns") == 98765.25);
+  BOOST_CHECK(item.get<double>("p99_ns") == 98795.375);
+  BOOST_CHECK(item.hasChild("counters") == dnPerfStats::enabled());
+}
+
+BOOST_AUTO_TEST_CASE(test_bench_comparator)
+{
+  BenchResults baseline, current;
+  baseline.push_back(bench_test_result("same", 10, 1000));
+  baseline.push_back(bench_test_result("limit", 10, 1000));
+  baseline.push_back(bench_test_result("slower", 10, 1000));
+  baseline.push_back(bench_test_result("faster", 10, 1000));
+  baseline.push_back(bench_test_result("removed", 10, 1000));
+  current.push_back(bench_test_result("same", 10, 1050));
+  current.push_back(bench_test_result("limit", 10, 1100));
+  current.push_back(bench_test_result("slower", 10, 1101));
+  current.push_back(bench_test_result("faster", 10, 800));
+  current.push_back(bench_test_result("added", 10, 1000));
+  // same name, other size is a different benchmark
+  current.push_back(bench_test_result("same", 20, 5000));
+
+  BenchComparator comparator(10.0);
+  BenchComparator::Items items;
+  BOOST_CHECK(comparator.compare(baseline, current, items) == 1);
+  BOOST_REQUIRE(items.size() == 7);
+  BOOST_CHECK(items[0].verdict == BenchComparator::bvSame);
+  BOOST_CHECK_CLOSE(items[0].changePct, 5.0, 1e-9);
+  BOOST_CHECK(items[1].verdict == BenchComparator::bvSame);
+  BOOST_CHECK(items[2].verdict == BenchComparator::bvRegression);
+  BOOST_CHECK(items[2].baselineNs == 1000.0);
+  BOOST_CHECK(items[2].currentNs == 1101.0);
+  BOOST_CHECK(items[3].verdict == BenchComparator::bvImprovement);
+  BOOST_CHECK(items[4].verdict == BenchComparator::bvNew);
+  BOOST_CHECK(items[5].verdict == BenchComparator::bvNew);
+  BOOST_CHECK(items[6].name == "removed");
+  BOOST_CHECK(items[6].verdict == BenchComparator::bvMissing);
+
+  // larger threshold accepts the slowdown
+  BenchComparator tolerant(20.0);
+  BOOST_CHECK(tolerant.compare(baseline, current, items) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_bench_runner)
+{
+  BenchOptions options;
+  options.warmupRuns = 2;
+  options.measuredRuns = 5;
+  options.sizes.clear();
+  options.sizes.push_back(10);
+  options.sizes.push_back(20);
+
+  BenchTestCountingCase *benchCase = new BenchTestCountingCase();
+  BenchRunner runner(options);
+  runner.addCase(benchCase);
+  BOOST_CHECK(runner.execute() == 2);
+
+  BOOST_CHECK(benchCase->getRuns() == 14);
+  BOOST_CHECK(benchCase->getResets() == 14);
+  BOOST_REQUIRE(runner.getResults().size() == 2);
+  BOOST_CHECK(runner.getResults()[1].name == "count_test");
+  BOOST_CHECK(runner.getResults()[1].size == 20);
+  BOOST_CHECK(runner.getResults()[1].runs == 5);
+
+  options.filter = "other";
+  BenchRunner filtered(options);
+  filtered.addCase(new BenchTestCountingCase());
+  BOOST_CHECK(filtered.execute() == 0);
+}
@@ -0,0 +1,14 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dataNodeTestBind.cpp
+// Purpose:     Test structure binding.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#define BOOST_TEST_NO_MAIN
+#define BOOST_TEST_MODULE Bind
+//#include <boost/test/unit_test.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include "dataNodeTestBind.ipp"
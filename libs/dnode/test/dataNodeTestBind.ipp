@@ -0,0 +1,165 @@
+#include <vector>
+#include <sstream>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_bind.h"
+#include "dtp/dnode_bind_json.h"
+#include "dtp/dnode_bind_bion.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+struct BindPoint {
+  int x;
+  double y;
+
+  BindPoint(): x(0), y(0.0) {}
+  BindPoint(int ax, double ay): x(ax), y(ay) {}
+
+  bool operator==(const BindPoint &rhs) const { return (x == rhs.x) && (y == rhs.y); }
+};
+
+struct BindShape {
+  dtpString name;
+  uint64 id;
+  bool visible;
+  std::vector<BindPoint> points;
+  std::vector<double> weights;
+  std::vector<dtpString> tags;
+
+  BindShape(): id(0), visible(false) {}
+};
+
+DNODE_BIND_BEGIN(BindPoint)
+  DNODE_BIND_FIELD(x)
+  DNODE_BIND_FIELD(y)
+DNODE_BIND_END()
+
+DNODE_BIND_BEGIN(BindShape)
+  DNODE_BIND_FIELD_AS(name, "shape_name")
+  DNODE_BIND_FIELD(id)
+  DNODE_BIND_FIELD(visible)
+  DNODE_BIND_FIELD(points)
+  DNODE_BIND_FIELD(weights)
+  DNODE_BIND_FIELD(tags)
+DNODE_BIND_END()
+
+void build_bind_sample(BindShape &output)
+{
+  output.name = "triangle";
+  output.id = 12345678901ULL;
+  output.visible = true;
+  output.points.push_back(BindPoint(0, 0.5));
+  output.points.push_back(BindPoint(10, 1.5));
+  output.points.push_back(BindPoint(5, 7.25));
+  output.weights.push_back(0.25);
+  output.weights.push_back(0.75);
+  output.tags.push_back("red");
+  output.tags.push_back("closed");
+}
+
+bool bind_shapes_equal(const BindShape &lhs, const BindShape &rhs)
+{
+  return
+    (lhs.name == rhs.name) &&
+    (lhs.id == rhs.id) &&
+    (lhs.visible == rhs.visible) &&
+    (lhs.points == rhs.points) &&
+    (lhs.weights == rhs.weights) &&
+    (lhs.tags == rhs.tags);
+}
+
+BOOST_AUTO_TEST_CASE(test_bind_field_count)
+{
+  BOOST_CHECK(dbind_field_count<BindPoint>() == 2);
+  BOOST_CHECK(dbind_field_count<BindShape>() == 6);
+}
+
+BOOST_AUTO_TEST_CASE(test_bind_node_round_trip)
+{
+  BindShape shape1, shape2;
+  build_bind_sample(shape1);
+
+  dnode node;
+  dbind_to_node(shape1, node);
+
+  BOOST_CHECK(node.isParent());
+  BOOST_CHECK(node.size() == 6);
+  BOOST_CHECK(node.get<dtpString>("shape_name") == "triangle");
+  BOOST_CHECK(node.getElement("points").isList());
+  BOOST_CHECK(node.getElement("points").size() == 3);
+  BOOST_CHECK(node.getElement("weights").isArray());
+  BOOST_CHECK(node.getElement("tags").isArray());
+
+  dbind_from_node(node, shape2);
+  BOOST_CHECK(bind_shapes_equal(shape1, shape2));
+}
+
+BOOST_AUTO_TEST_CASE(test_bind_node_by_name)
+{
+  dnode node(ict_parent);
+  node.addChild("extra", new dnode(1));
+  node.addChild("y", new dnode(2.5));
+  node.addChild("x", new dnode(7));
+
+  BindPoint point;
+  dbind_from_node(node, point);
+
+  BOOST_CHECK(point.x == 7);
+  BOOST_CHECK(point.y == 2.5);
+}
+
+BOOST_AUTO_TEST_CASE(test_bind_json_round_trip)
+{
+  BindShape shape1, shape2;
+  build_bind_sample(shape1);
+
+  dtpString json;
+  dbind_write_json(shape1, json);
+  BOOST_TEST_MESSAGE("json: " << json);
+
+  dbind_read_json(json, shape2);
+  BOOST_CHECK(bind_shapes_equal(shape1, shape2));
+}
+
+BOOST_AUTO_TEST_CASE(test_bind_json_unknown_keys)
+{
+  BindPoint point;
+  dbind_read_json("{\"z\": {\"a\": [1, 2, {\"b\": null}]}, \"x\": 3, \"w\": [], \"y\": 4}", point);
+
+  BOOST_CHECK(point.x == 3);
+  BOOST_CHECK(point.y == 4.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_bind_json_type_error)
+{
+  BindPoint point;
+  BOOST_CHECK_THROW(dbind_read_json("{\"x\": [1, 2]}", point), dnError);
+  BOOST_CHECK_THROW(dbind_read_json("[1, 2]", point), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_bind_bion_write)
+{
+  BindShape shape1, shape2;
+  build_bind_sample(shape1);
+
+  std::stringstream s;
+  dbind_write_bion(shape1, s);
+
+  s.seekg(0, std::ios::beg);
+  dnode node;
+  dnBionProcessor proc(node);
+  BionReader<std::stringstream, dnBionProcessor> reader(s, proc);
+  reader.process();
+
+  dnode expected;
+  dbind_to_node(shape1, expected);
+  BOOST_CHECK(node.size() == expected.size());
+  BOOST_CHECK(node.getElement("points").size() == 3);
+
+  dbind_from_node(node, shape2);
+  BOOST_CHECK(bind_shapes_equal(shape1, shape2));
+}
@@ -0,0 +1,14 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dataNodeTestCompact.cpp
+// Purpose:     Test compaction of data node trees.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#define BOOST_TEST_NO_MAIN
+#define BOOST_TEST_MODULE Compact
+//#include <boost/test/unit_test.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include "dataNodeTestCompact.ipp"
@@ -0,0 +1,201 @@
+#include <vector>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_parallel.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+void build_compact_sample(dnode &output, int itemCount)
+{
+  output.setAsParent();
+  for(int i=0; i < itemCount; i++) {
+    dnode *item = new dnode(ict_parent);
+    item->addChild("id", new dnode(i));
+    item->addChild("label", new dnode(dtpString("item") + toString(i)));
+
+    dnode *tags = new dnode(ict_list);
+    tags->addChild(new dnode(dtpString("t") + toString(i % 7)));
+    tags->addChild(new dnode(i % 2 == 0));
+    item->addChild("tags", tags);
+
+    output.addChild(dtpString("n") + toString(i), item);
+  }
+}
+
+dnode::size_type compact_spill_count(dnode &node)
+{
+  return dynamic_cast<Details::dnChildColnCompact &>(node.getChildren()).getSpillCount();
+}
+
+BOOST_AUTO_TEST_CASE(test_compact_layout)
+{
+  dnode node, copy;
+  build_compact_sample(node, 100);
+  copy.copyFrom(node);
+
+  node.compact();
+  const dnode &compacted = node;
+
+  BOOST_CHECK(node.isCompact());
+  BOOST_CHECK(compacted["n5"].isCompact());
+  BOOST_CHECK(compacted["n5"]["tags"].isCompact());
+  BOOST_CHECK(compacted["n5"]["tags"].isList());
+  BOOST_CHECK(!compacted.isList());
+  BOOST_CHECK(compact_spill_count(node) == 0);
+  BOOST_CHECK(dnode_deep_equal(compacted, copy));
+
+  // children of a container are stored next to each other
+  for(int i=1; i < 100; i++)
+    BOOST_CHECK(&compacted[i] == &compacted[i - 1] + 1);
+  BOOST_CHECK(&compacted["n0"]["label"] == &compacted["n0"]["id"] + 1);
+  // nested containers follow in depth-first order
+  BOOST_CHECK(&compacted["n0"]["id"] == &compacted[99] + 1);
+  BOOST_CHECK(&compacted["n0"]["tags"][0] == &compacted["n0"]["tags"] + 1);
+
+  for(int i=0; i < 100; i++) {
+    dtpString name = dtpString("n") + toString(i);
+    BOOST_CHECK(compacted.indexOfName(name) == static_cast<dnode::size_type>(i));
+    BOOST_CHECK(compacted.getElementName(i) == name);
+    BOOST_CHECK(compacted[name].get<int>("id") == i);
+  }
+  BOOST_CHECK(!compacted.hasChild("n100"));
+  BOOST_CHECK(compacted.indexOfName("") == dnode::npos);
+
+  // copy is a regular container
+  dnode copy2(node);
+  BOOST_CHECK(!copy2.isCompact());
+  BOOST_CHECK(dnode_deep_equal(copy2, copy));
+}
+
+BOOST_AUTO_TEST_CASE(test_compact_mutation)
+{
+  dnode node, expected;
+  build_compact_sample(node, 20);
+  node.compact();
+  expected.copyFrom(node);
+
+  node.addChild("x", new dnode(1));
+  expected.addChild("x", new dnode(1));
+  BOOST_CHECK(node.get<int>("x") == 1);
+  BOOST_CHECK(node.indexOfName("x") == 20);
+  BOOST_CHECK(compact_spill_count(node) == 1);
+
+  node.eraseElement(3);
+  expected.eraseElement(3);
+  BOOST_CHECK(!node.hasChild("n3"));
+  BOOST_CHECK(node.indexOfName("n4") == 3);
+  BOOST_CHECK(node.indexOfName("x") == 19);
+
+  node.eraseElements(5, 4);
+  expected.eraseElements(5, 4);
+  BOOST_CHECK(node.size() == 16);
+  BOOST_CHECK(node.indexOfName("n10") == 5);
+
+  node.setElement(0, dnode(7));
+  expected.setElement(0, dnode(7));
+  BOOST_CHECK(node.get<int>("n0") == 7);
+
+  node.getChildren().setName(1, "renamed");
+  expected.getChildren().setName(1, "renamed");
+  BOOST_CHECK(node.indexOfName("renamed") == 1);
+  BOOST_CHECK(!node.hasChild("n1"));
+
+  DTP_UNIQUE_PTR(dnode) extracted(node.extractChild(2));
+  DTP_UNIQUE_PTR(dnode) extractedExpected(expected.extractChild(2));
+  BOOST_CHECK(extracted->get<int>("id") == 2);
+  BOOST_CHECK(node.indexOfName("n4") == 2);
+
+  node["n4"]["tags"].addChild(new dnode(3));
+  expected["n4"]["tags"].addChild(new dnode(3));
+  BOOST_CHECK(node["n4"]["tags"].size() == 3);
+
+  node.resize(20);
+  expected.resize(20);
+  BOOST_CHECK(node.size() == 20);
+  BOOST_CHECK(dnode_deep_equal(node, expected));
+
+  node.resize(2);
+  BOOST_CHECK(node.size() == 2);
+  BOOST_CHECK(node.indexOfName("n0") == 0);
+  BOOST_CHECK(node.indexOfName("x") == dnode::npos);
+
+  node.clear();
+  BOOST_CHECK(!node.isCompact());
+}
+
+BOOST_AUTO_TEST_CASE(test_compact_list_sort)
+{
+  dnode list(ict_list);
+  for(int i=0; i < 50; i++)
+    list.addChild(new dnode((i * 17) % 50));
+
+  list.compact();
+  list.addChild(new dnode(-1));
+  list.sort<int>();
+
+  BOOST_CHECK(list.size() == 51);
+  for(int i=0; i < 51; i++)
+    BOOST_CHECK(list.get<int>(i) == i - 1);
+
+  list.push_front(100);
+  BOOST_CHECK(list.get<int>(0) == 100);
+  BOOST_CHECK(list.get<int>(1) == -1);
+}
+
+BOOST_AUTO_TEST_CASE(test_compact_duplicate_names)
+{
+  dnode node(ict_parent);
+  for(int i=0; i < 30; i++)
+    node.addChild(dtpString("k") + toString(i % 10), new dnode(i));
+
+  node.compact();
+  BOOST_CHECK(node.size() == 30);
+  BOOST_CHECK(node.indexOfName("k3") == 3);
+  BOOST_CHECK(node.getElementName(23) == "k3");
+
+  node.eraseElement(3);
+  BOOST_CHECK(node.indexOfName("k3") == 12);
+
+  node.getChildren().swap(0, 12);
+  BOOST_CHECK(node.indexOfName("k3") == 0);
+  BOOST_CHECK(node.get<int>("k3") == 13);
+  BOOST_CHECK(node.indexOfName("k0") == 9);
+}
+
+BOOST_AUTO_TEST_CASE(test_compact_subtree)
+{
+  dnode node;
+  build_compact_sample(node, 10);
+  node["n2"].freeze();
+  node["n3"]["tags"].setAsDeque();
+
+  dnode *arr = new dnode();
+  arr->setAsArray(vt_int);
+  for(int i=0; i < 1000; i++)
+    arr->addItem(i);
+  arr->getArray()->eraseFrom(10);
+  node.addChild("arr", arr);
+  dnMemoryUsage before = node["arr"].memoryUsage();
+
+  node.compact();
+  const dnode &compacted = node;
+
+  BOOST_CHECK(compacted["n2"].isFrozen());
+  BOOST_CHECK(compacted["n3"]["tags"].isDeque());
+  BOOST_CHECK(compacted["n3"].isCompact());
+  BOOST_CHECK(compacted["n2"]["tags"][0].getAsString() == "t2");
+  BOOST_CHECK(node["arr"].memoryUsage().arrays < before.arrays);
+  BOOST_CHECK(compacted["arr"].get<int>(9) == 9);
+
+  // compact again after mutation - nodes are moved to a new block
+  node.addChild("y", new dnode(2));
+  BOOST_CHECK(compact_spill_count(node) == 1);
+  node.compact();
+  BOOST_CHECK(compact_spill_count(node) == 0);
+  BOOST_CHECK(compacted.get<int>("y") == 2);
+  BOOST_CHECK(compacted["n9"].get<int>("id") == 9);
+}
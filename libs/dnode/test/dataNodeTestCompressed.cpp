@@ -0,0 +1,14 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        dataNodeTestCompressed.cpp
+// Purpose:     Test compressed numeric arrays.
+// Author:      Piotr Likus
+// Modified by:
+// Created:     18/10/2026
+/////////////////////////////////////////////////////////////////////////////
+
+#define BOOST_TEST_NO_MAIN
+#define BOOST_TEST_MODULE Compressed
+//#include <boost/test/unit_test.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include "dataNodeTestCompressed.ipp"
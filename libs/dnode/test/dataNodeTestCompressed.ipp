@@ -0,0 +1,116 @@
+#include <vector>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_compressed.h"
+#include "dtp/dnode_parallel.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+struct compressed_count_visitor {
+  uint count;
+  compressed_count_visitor(): count(0) {}
+  void operator()(int64) { count++; }
+};
+
+BOOST_AUTO_TEST_CASE(test_compressed_int64)
+{
+  dnCompressedArray<int64> arr;
+  std::vector<int64> expected;
+  int64 stamp = 1600000000000LL;
+  for(uint i = 0; i < 1000; i++) {
+    stamp += 1000 + (i % 3);
+    arr.push_back(stamp);
+    expected.push_back(stamp);
+  }
+  arr.push_back(-5);
+  expected.push_back(-5);
+
+  BOOST_CHECK(arr.size() == 1001);
+  BOOST_CHECK(arr.blockCount() == 1001 / DCOMPRESS_BLOCK_SIZE);
+  BOOST_CHECK(arr.dataSize() < expected.size() * sizeof(int64) / 2);
+  BOOST_CHECK(arr.memoryUsed() == sizeof(arr) + arr.dataSize());
+  BOOST_CHECK_THROW(arr.get(1001), dnError);
+
+  bool valid = true;
+  for(uint i = 0; i < expected.size(); i++)
+    if (arr.get(i) != expected[i])
+      valid = false;
+  BOOST_CHECK(valid);
+
+  // re-encoded block with wider deltas
+  arr.set(200, 7);
+  arr.set(1000, 9);
+  expected[200] = 7;
+  expected[1000] = 9;
+  valid = true;
+  for(dnCompressedArray<int64>::const_iterator it = arr.begin(), epos = arr.end(); it != epos; ++it)
+    if (*it != expected[it.index()])
+      valid = false;
+  BOOST_CHECK(valid);
+
+  BOOST_CHECK(arr.visitValues(compressed_count_visitor()).count == 1001);
+  BOOST_CHECK(arr.minValue() == 7);
+  BOOST_CHECK(arr.maxValue() == expected[999]);
+}
+
+BOOST_AUTO_TEST_CASE(test_compressed_double)
+{
+  dnCompressedArray<double> arr;
+  std::vector<double> expected;
+  for(uint i = 0; i < 700; i++) {
+    double value = 20.0 + static_cast<double>(i % 8) * 0.25;
+    arr.push_back(value);
+    expected.push_back(value);
+  }
+  arr.push_back(-1e300);
+  expected.push_back(-1e300);
+
+  bool valid = true;
+  double total = 0.0;
+  for(uint i = 0; i < expected.size(); i++) {
+    total += expected[i];
+    if (arr.get(i) != expected[i])
+      valid = false;
+  }
+  BOOST_CHECK(valid);
+  BOOST_CHECK(arr.sum(0.0) == total);
+  BOOST_CHECK(arr.minValue() == -1e300);
+  BOOST_CHECK(arr.maxValue() == 21.75);
+  BOOST_CHECK(arr.dataSize() < expected.size() * sizeof(double));
+
+  arr.set(3, 3.5);
+  BOOST_CHECK(arr.get(3) == 3.5);
+  BOOST_CHECK(arr.get(4) == expected[4]);
+  BOOST_CHECK(arr.get(699) == expected[699]);
+}
+
+BOOST_AUTO_TEST_CASE(test_compressed_array_conv)
+{
+  dnode source(ict_array, vt_double);
+  for(uint i = 0; i < 300; i++)
+    source.addItem(static_cast<double>(i) / 4.0);
+
+  dnCompressedArray<double> arr;
+  arr.fromArray(source);
+  BOOST_CHECK(arr.size() == 300);
+  BOOST_CHECK(arr.get(299) == 299.0 / 4.0);
+  BOOST_CHECK(arr.mean() == source.get<double>(150) - 0.125);
+
+  dnode output;
+  arr.toArray(output);
+  BOOST_CHECK(output.getElementType() == vt_double);
+  BOOST_CHECK(dnode_deep_equal(output, source));
+
+  // list of scalars
+  dnode list(ict_list);
+  list.addChild(new dnode(3));
+  list.addChild(new dnode(-4));
+  dnCompressedArray<int> ints;
+  ints.fromArray(list);
+  BOOST_CHECK(ints.size() == 2);
+  BOOST_CHECK(ints.get(1) == -4);
+}
@@ -0,0 +1,98 @@
+#include <sstream>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+void build_dump_sample(dnode &output)
+{
+  output.setAsParent();
+  output.addChild("id", new dnode(12));
+  output.addChild("label", new dnode(dtpString("a[b]:c")));
+
+  dnode *values = new dnode(ict_list);
+  values->addChild(new dnode(1));
+  values->addChild(new dnode(2));
+  output.addChild("values", values);
+
+  dnode *level1 = new dnode(ict_parent);
+  dnode *level2 = new dnode(ict_parent);
+  level2->addChild("deep", new dnode(dtpString("bottom")));
+  level1->addChild("level2", level2);
+  output.addChild("level1", level1);
+}
+
+BOOST_AUTO_TEST_CASE(test_dump_scalar)
+{
+  dnode value(dtpString("a[b]:c"));
+  BOOST_CHECK_EQUAL(value.dump(), "{\nas_scalar:[type=" + toString(int(vt_string)) + "][value=a?b??c]\n");
+
+  dnode empty;
+  BOOST_CHECK_EQUAL(empty.dump(), "{\nas_scalar:[type=" + toString(int(vt_null)) + "][value=/null/]\n");
+
+  dnode named(ict_parent);
+  named.addChild("x", new dnode(5));
+  BOOST_CHECK_EQUAL(named.dump(">", "root"),
+    ">{head:[name=root];\n>as_parent:[count=1][children="
+    ">  {head:[name=x];\n>  as_scalar:[type=" + toString(int(vt_int)) + "][value=5]\n;\n]\n");
+}
+
+BOOST_AUTO_TEST_CASE(test_dump_stream)
+{
+  dnode node;
+  build_dump_sample(node);
+
+  std::ostringstream output;
+  BOOST_CHECK(node.dump(output));
+  BOOST_CHECK_EQUAL(output.str(), node.dump());
+
+  dtpString text;
+  dnDumpStringSink sink(text);
+  BOOST_CHECK(node.dump(sink));
+  BOOST_CHECK_EQUAL(text, node.dump());
+  BOOST_CHECK(text.find("bottom") != dtpString::npos);
+  BOOST_CHECK(text.find("      {head:[name=deep];") != dtpString::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_dump_max_depth)
+{
+  dnode node;
+  build_dump_sample(node);
+
+  dnDumpOptions options;
+  options.maxDepth = 1;
+  dtpString text;
+  dnDumpStringSink sink(text);
+  BOOST_CHECK(!node.dump(sink, options));
+
+  BOOST_CHECK(text.find("head:[name=level1]") != dtpString::npos);
+  BOOST_CHECK(text.find("level2") == dtpString::npos);
+  BOOST_CHECK(text.find("[children=...]") != dtpString::npos);
+
+  options.maxDepth = 3;
+  text.clear();
+  BOOST_CHECK(node.dump(sink, options));
+  BOOST_CHECK_EQUAL(text, node.dump());
+}
+
+BOOST_AUTO_TEST_CASE(test_dump_max_size)
+{
+  dnode node;
+  build_dump_sample(node);
+  dtpString full = node.dump();
+
+  dnDumpOptions options;
+  options.maxSize = 40;
+  std::ostringstream output;
+  BOOST_CHECK(!node.dump(output, options));
+  BOOST_CHECK_EQUAL(output.str(), full.substr(0, 40) + "...");
+
+  options.maxSize = full.length();
+  std::ostringstream outputFull;
+  BOOST_CHECK(node.dump(outputFull, options));
+  BOOST_CHECK_EQUAL(outputFull.str(), full);
+}
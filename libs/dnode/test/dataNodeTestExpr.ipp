@@ -0,0 +1,265 @@
+#include <vector>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_expr.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+namespace {
+
+void add_item(const dtpString &name, int qty, double price, const dtpString &city, dnode &rows)
+{
+  dnode *row = new dnode(ict_parent);
+  row->addChild("name", new dnode(name));
+  row->addChild("qty", new dnode(qty));
+  row->addChild("price", new dnode(price));
+  dnode *address = new dnode(ict_parent);
+  address->addChild("city", new dnode(city));
+  row->addChild("address", address);
+  rows.addChild(row);
+}
+
+void build_expr_sample(dnode &rows)
+{
+  rows = dnode(ict_list);
+  add_item("pen", 10, 1.5, "Paris", rows);
+  add_item("book", 2, 20.0, "Berlin", rows);
+  add_item("lamp", 1, 35.0, "Paris", rows);
+  add_item("cup", 6, 4.0, "Rome", rows);
+}
+
+/// Converts rows table (with numeric qty & price) into columns table
+void build_expr_columns(const dnode &rows, dnode &table)
+{
+  table = dnode(ict_parent);
+  dnode *name = new dnode(ict_array, vt_string);
+  dnode *qty = new dnode(ict_array, vt_int);
+  dnode *price = new dnode(ict_array, vt_double);
+  for(dnode::size_type i=0, epos = rows.size(); i != epos; i++) {
+    name->addItem(rows[i].get<dtpString>("name"));
+    qty->addItem(rows[i].get<int>("qty"));
+    price->addItem(rows[i].get<double>("price"));
+  }
+  table.addChild("name", name);
+  table.addChild("qty", qty);
+  table.addChild("price", price);
+}
+
+double eval_number(const dtpString &source, const dnode &row)
+{
+  dnExpression expr(source);
+  return expr.evaluate(row).getNumber();
+}
+
+dtpString eval_string(const dtpString &source, const dnode &row)
+{
+  dnExpression expr(source);
+  return expr.evaluate(row).getString();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_expr_row)
+{
+  dnode rows;
+  build_expr_sample(rows);
+  const dnode &row = rows[0];
+
+  // arithmetic with precedence, fields
+  BOOST_CHECK_EQUAL(eval_number("1 + 2 * 3 - 4 / 2", row), 5.0);
+  BOOST_CHECK_EQUAL(eval_number("(1 + 2) * 3 % 4", row), 1.0);
+  BOOST_CHECK_EQUAL(eval_number("qty * price", row), 15.0);
+  BOOST_CHECK_EQUAL(eval_number("-qty + round(2.456, 1) * 10", row), 15.0);
+  BOOST_CHECK_EQUAL(eval_number("max(qty, 12) + min(1, abs(-3))", row), 13.0);
+
+  // comparison & logic
+  dnExpression expr("qty >= 10 and price < 2 or name = 'book'");
+  BOOST_CHECK(expr.test(row));
+  BOOST_CHECK(expr.test(rows[1]));
+  BOOST_CHECK(!expr.test(rows[2]));
+  BOOST_CHECK(dnExpression("not (qty != 10) && !false").test(row));
+
+  // strings, paths
+  BOOST_CHECK(eval_string("name + '-' + qty", row) == "pen-10");
+  BOOST_CHECK(eval_string("upper(address.city)", row) == "PARIS");
+  BOOST_CHECK(eval_string("substr(trim('  abcdef '), 1, 3)", row) == "bcd");
+  BOOST_CHECK(dnExpression("starts_with(name, 'pe') and contains(address.city, 'ar')").test(row));
+  BOOST_CHECK_EQUAL(eval_number("len(name) + num('2.5')", row), 5.5);
+
+  // dates
+  BOOST_CHECK_EQUAL(eval_number("year(date('2026-10-18 12:30'))", row), 2026.0);
+  BOOST_CHECK_EQUAL(eval_number("hour(date('2026-10-18T12:30:15'))", row), 12.0);
+  BOOST_CHECK_EQUAL(eval_number("date('2026-03-01') - date('2026-02-28')", row), 1.0);
+  BOOST_CHECK(eval_string("date_str(date('2026-10-18') + 14)", row) == "2026-11-01");
+  BOOST_CHECK(dnExpression("is_null(date('2026-13-01'))").test(row));
+
+  // nulls: missing field, propagation, coalesce
+  dnExpression missing("unknown + 1");
+  BOOST_CHECK(missing.evaluate(row).isNull());
+  BOOST_CHECK(!dnExpression("unknown > 1").test(row));
+  BOOST_CHECK_EQUAL(eval_number("coalesce(unknown, null, qty)", row), 10.0);
+  BOOST_CHECK(dnExpression("is_null(address.zip)").test(row));
+
+  // result is reused between rows
+  dnExpression total("qty * price");
+  BOOST_CHECK_EQUAL(total.evaluate(rows[1]).getNumber(), 40.0);
+  BOOST_CHECK_EQUAL(total.evaluate(rows[3]).getNumber(), 24.0);
+
+  std::vector<dtpString> paths = dnExpression("price * qty + price + address.city.len").getFieldPaths();
+  BOOST_REQUIRE_EQUAL(paths.size(), 3U);
+  BOOST_CHECK(paths[0] == "price");
+  BOOST_CHECK(paths[2] == "address/city/len");
+}
+
+BOOST_AUTO_TEST_CASE(test_expr_errors)
+{
+  dnode rows;
+  build_expr_sample(rows);
+
+  BOOST_CHECK_THROW(dnExpression("1 +"), dnExprError);
+  BOOST_CHECK_THROW(dnExpression("(1 + 2"), dnExprError);
+  BOOST_CHECK_THROW(dnExpression("1 2"), dnExprError);
+  BOOST_CHECK_THROW(dnExpression("'abc"), dnExprError);
+  BOOST_CHECK_THROW(dnExpression("unknown_func(1)"), dnExprError);
+  BOOST_CHECK_THROW(dnExpression("pow(1)"), dnExprError);
+  BOOST_CHECK_THROW(dnExpression("qty # 2"), dnExprError);
+
+  // type errors are reported during evaluation (or folding of constants)
+  BOOST_CHECK_THROW(dnExpression("'a' - 1"), dnExprError);
+  dnExpression expr("name * 2");
+  BOOST_CHECK_THROW(expr.evaluate(rows[0]), dnExprError);
+  BOOST_CHECK_THROW(dnExpression("address + 1").evaluate(rows[0]), dnExprError);
+  BOOST_CHECK_THROW(dnExpression("name < 1").evaluate(rows[0]), dnExprError);
+  BOOST_CHECK(!dnExpression("name = 1").test(rows[0]));
+
+  dnExpression empty;
+  BOOST_CHECK(!empty.isCompiled());
+  BOOST_CHECK_THROW(empty.evaluate(rows[0]), dnExprError);
+  BOOST_CHECK_THROW(expr.evaluateRow(0), dnExprError);
+
+  // column not found in columns table
+  dnode table;
+  build_expr_columns(rows, table);
+  dnExpression unknown("city = 'Paris'");
+  BOOST_CHECK_THROW(unknown.bindTable(table), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_expr_batch)
+{
+  dnode rows(ict_list), table;
+  for(int i=0; i < 3000; i++)
+    add_item(dtpString("item") + toString(i), i % 13, static_cast<double>(i % 7) * 0.5, "Paris", rows);
+  build_expr_columns(rows, table);
+
+  const char *sources[] = {
+    "qty * price - qty / 2",
+    "if(qty > 6 and price <= 1.5, qty, -price)",
+    "round(sqrt(qty * 3), 1) + pow(price, 2) % 5",
+    "coalesce(null, qty) = 4 or not (price > 1)",
+    "len(name) + qty"
+  };
+
+  for(size_t s=0; s != sizeof(sources) / sizeof(sources[0]); s++) {
+    dnExpression expr(sources[s]);
+    expr.bindTable(table);
+    BOOST_REQUIRE(expr.isNumeric());
+    BOOST_REQUIRE_EQUAL(expr.getRowCount(), 3000U);
+
+    std::vector<double> values(3000);
+    expr.evaluateBatch(0, 3000, &values[0]);
+
+    dnExpression rowExpr(expr);
+    BOOST_CHECK(!rowExpr.isBound());
+    rowExpr.bindTable(rows);
+
+    for(dnode::size_type i=0; i != 3000; i++) {
+      BOOST_CHECK_EQUAL(values[i], expr.evaluateRow(i).getNumber());
+      BOOST_CHECK_EQUAL(values[i], rowExpr.evaluateRow(i).getNumber());
+    }
+  }
+
+  // null as NaN, range check
+  dnode nulls(ict_list);
+  for(int i=0; i < 3; i++) {
+    dnode *row = new dnode(ict_parent);
+    row->addChild("value", (i == 1) ? new dnode() : new dnode(i));
+    nulls.addChild(row);
+  }
+  dnExpression expr("value * 2");
+  expr.bindTable(nulls);
+  double values[3];
+  expr.evaluateBatch(0, 3, values);
+  BOOST_CHECK_EQUAL(values[2], 4.0);
+  BOOST_CHECK(values[1] != values[1]);
+  BOOST_CHECK_THROW(expr.evaluateBatch(2, 2, values), dnError);
+
+  expr.unbindTable();
+  BOOST_CHECK_THROW(expr.evaluateRow(0), dnExprError);
+}
+
+BOOST_AUTO_TEST_CASE(test_expr_table_ops)
+{
+  dnode rows, table, output;
+  build_expr_sample(rows);
+  build_expr_columns(rows, table);
+
+  // filter keeps format of input
+  expr_filter(rows, "qty * price > 10 and address.city = 'Paris'", output);
+  BOOST_REQUIRE_EQUAL(output.size(), 2U);
+  BOOST_CHECK(output[0].get<dtpString>("name") == "pen");
+  BOOST_CHECK(output[1].get<dtpString>("name") == "lamp");
+  BOOST_CHECK(output[1]["address"].get<dtpString>("city") == "Paris");
+
+  expr_filter(table, "qty * price > 20", output);
+  BOOST_REQUIRE(output.supportsNames());
+  BOOST_REQUIRE_EQUAL(output["qty"].size(), 3U);
+  BOOST_CHECK_EQUAL(output["qty"].getElementType(), vt_int);
+  BOOST_CHECK(output["name"].get<dtpString>(2) == "cup");
+
+  expr_filter(table, "lower(name)", output);
+  BOOST_CHECK_EQUAL(output["name"].size(), 4U);
+
+  // project
+  std::vector<dnExprColumn> columns;
+  columns.push_back(dnExprColumn("total", "qty * price"));
+  columns.push_back(dnExprColumn("label", "upper(name) + ':' + qty"));
+  columns.push_back(dnExprColumn("cheap", "price < 5"));
+
+  expr_project(rows, columns, output);
+  BOOST_REQUIRE_EQUAL(output.size(), 4U);
+  BOOST_CHECK_EQUAL(output[1].get<double>("total"), 40.0);
+  BOOST_CHECK(output[1].get<dtpString>("label") == "BOOK:2");
+  BOOST_CHECK(output[3].get<bool>("cheap"));
+
+  expr_project(table, columns, output);
+  BOOST_CHECK_EQUAL(output["total"].getElementType(), vt_double);
+  BOOST_CHECK_EQUAL(output["total"].get<double>(3), 24.0);
+  BOOST_CHECK(output["label"].isList());
+  BOOST_CHECK(output["label"].get<dtpString>(2) == "LAMP:1");
+  BOOST_CHECK_EQUAL(output["cheap"].get<double>(0), 1.0);
+
+  columns.push_back(dnExprColumn("total", "qty"));
+  BOOST_CHECK_THROW(expr_project(rows, columns, output), dnError);
+
+  // sort: numeric key, string key, stable order of equal keys
+  expr_sort(table, "qty * price", false, output);
+  BOOST_CHECK(output["name"].get<dtpString>(0) == "book");
+  BOOST_CHECK(output["name"].get<dtpString>(3) == "pen");
+
+  expr_sort(rows, "address.city", true, output);
+  BOOST_REQUIRE_EQUAL(output.size(), 4U);
+  BOOST_CHECK(output[0].get<dtpString>("name") == "book");
+  BOOST_CHECK(output[1].get<dtpString>("name") == "pen");
+  BOOST_CHECK(output[2].get<dtpString>("name") == "lamp");
+  BOOST_CHECK(output[3].get<dtpString>("name") == "cup");
+
+  // nulls first
+  rows[1].eraseElement(rows[1].indexOfName("qty"));
+  expr_sort(rows, "qty", true, output);
+  BOOST_CHECK(output[0].get<dtpString>("name") == "book");
+  BOOST_CHECK(output[1].get<dtpString>("name") == "lamp");
+}
@@ -0,0 +1,187 @@
+#include <vector>
+#include <boost/thread.hpp>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_parallel.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+void build_freeze_sample(dnode &output, int itemCount)
+{
+  output.setAsParent();
+  for(int i=0; i < itemCount; i++) {
+    dnode *item = new dnode(ict_parent);
+    item->addChild("id", new dnode(i));
+    item->addChild("label", new dnode(dtpString("item") + toString(i)));
+
+    dnode *tags = new dnode(ict_list);
+    tags->addChild(new dnode(dtpString("t") + toString(i % 7)));
+    tags->addChild(new dnode(i % 2 == 0));
+    item->addChild("tags", tags);
+
+    output.addChild(dtpString("n") + toString(i), item);
+  }
+}
+
+class dnTestFrozenReader {
+public:
+  dnTestFrozenReader(const dnode &input, int itemCount, bool &failed):
+    m_input(input), m_itemCount(itemCount), m_failed(failed) {}
+
+  void operator()() {
+    dnode helper;
+    for(int pass = 0; pass < 20; pass++)
+      for(int i=0; i < m_itemCount; i++) {
+        const dnode &item = m_input.getNode(dtpString("n") + toString(i), helper);
+        if (item.get<int>("id") != i)
+          m_failed = true;
+        if (item["tags"][0].getAsString() != dtpString("t") + toString(i % 7))
+          m_failed = true;
+      }
+  }
+private:
+  const dnode &m_input;
+  int m_itemCount;
+  bool &m_failed;
+};
+
+BOOST_AUTO_TEST_CASE(test_freeze_lookup)
+{
+  dnode node, copy;
+  build_freeze_sample(node, 200);
+  copy.copyFrom(node);
+
+  node.freeze();
+  const dnode &frozen = node;
+
+  BOOST_CHECK(frozen.isFrozen());
+  BOOST_CHECK(frozen["n5"].isFrozen());
+  BOOST_CHECK(frozen["n5"]["tags"].isFrozen());
+  BOOST_CHECK(!frozen["n5"]["id"].isFrozen());
+  BOOST_CHECK(frozen.size() == 200);
+  BOOST_CHECK(!frozen.isList());
+  BOOST_CHECK(frozen["n5"]["tags"].isList());
+
+  for(int i=0; i < 200; i++) {
+    dtpString name = dtpString("n") + toString(i);
+    BOOST_CHECK(frozen.hasChild(name));
+    BOOST_CHECK(frozen.indexOfName(name) == static_cast<dnode::size_type>(i));
+    BOOST_CHECK(frozen.getElementName(i) == name);
+    BOOST_CHECK(frozen[name].get<int>("id") == i);
+    BOOST_CHECK(frozen[name]["label"].getAsString() == dtpString("item") + toString(i));
+  }
+
+  BOOST_CHECK(!frozen.hasChild("n200"));
+  BOOST_CHECK(!frozen.hasChild(""));
+  BOOST_CHECK(frozen.indexOfName("x") == dnode::npos);
+  BOOST_CHECK_THROW(frozen["missing"], dnError);
+
+  // small container - linear search
+  BOOST_CHECK(frozen["n7"].indexOfName("label") == 1);
+  BOOST_CHECK(!frozen["n7"].hasChild("lab"));
+
+  BOOST_CHECK(dnode_deep_equal(frozen, copy));
+}
+
+BOOST_AUTO_TEST_CASE(test_freeze_duplicate_names)
+{
+  dnode node(ict_parent);
+  for(int i=0; i < 30; i++)
+    node.addChild(dtpString("k") + toString(i % 10), new dnode(i));
+
+  node.freeze();
+  const dnode &frozen = node;
+
+  BOOST_CHECK(frozen.size() == 30);
+  BOOST_CHECK(frozen.indexOfName("k3") == 3);
+  BOOST_CHECK(frozen.get<int>("k9") == 9);
+  BOOST_CHECK(frozen.getElementName(23) == "k3");
+  BOOST_CHECK(frozen[23].getAs<int>() == 23);
+}
+
+BOOST_AUTO_TEST_CASE(test_freeze_mutation)
+{
+  dnode node;
+  build_freeze_sample(node, 20);
+  node.freeze();
+
+  BOOST_CHECK_THROW(node.addChild("x", new dnode(1)), dnError);
+  BOOST_CHECK_THROW(node.eraseElement(0), dnError);
+  BOOST_CHECK_THROW(node.setElement(0, dnode(1)), dnError);
+  BOOST_CHECK_THROW(node[1], dnError);
+  BOOST_CHECK_THROW(node.getChildren().setName(0, "x"), dnError);
+  BOOST_CHECK_THROW(node.resize(3), dnError);
+  BOOST_CHECK(node.size() == 20);
+
+  dnode copy(node);
+  BOOST_CHECK(!copy.isFrozen());
+  BOOST_CHECK(dnode_deep_equal(copy, node));
+  copy.addChild("x", new dnode(1));
+  copy[0]["tags"].addChild(new dnode(3));
+  BOOST_CHECK(copy.size() == 21);
+  BOOST_CHECK(copy.get<int>("x") == 1);
+  BOOST_CHECK(copy.getElementName(4) == "n4");
+
+  // whole value can still be replaced
+  node.clear();
+  BOOST_CHECK(!node.isFrozen());
+  node.setAsParent();
+  node.addChild("y", new dnode(2));
+  BOOST_CHECK(node.size() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_freeze_subtree)
+{
+  dnode node;
+  build_freeze_sample(node, 10);
+
+  node["n3"].freeze();
+  BOOST_CHECK(!node.isFrozen());
+  BOOST_CHECK(!node.getElement("n3").isFrozen()); // copy
+  BOOST_CHECK(static_cast<const dnode &>(node)["n3"].isFrozen());
+
+  node.addChild("extra", new dnode(1));
+  BOOST_CHECK(node.size() == 11);
+  BOOST_CHECK_THROW(node["n3"].addChild("z", new dnode(0)), dnError);
+
+  // freezing again is no-op
+  node["n3"].freeze();
+  node.freeze();
+  BOOST_CHECK(node.isFrozen());
+  BOOST_CHECK(static_cast<const dnode &>(node)["n3"].get<int>("id") == 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_freeze_concurrent_reads)
+{
+  const int itemCount = 300;
+  dnode node;
+  build_freeze_sample(node, itemCount);
+  node.freeze();
+
+  bool failed[4] = {false, false, false, false};
+  boost::thread_group threads;
+  for(int i=0; i < 4; i++)
+    threads.create_thread(dnTestFrozenReader(node, itemCount, failed[i]));
+  threads.join_all();
+
+  for(int i=0; i < 4; i++)
+    BOOST_CHECK(!failed[i]);
+}
+
+BOOST_AUTO_TEST_CASE(test_freeze_memory)
+{
+  dnode node;
+  build_freeze_sample(node, 500);
+  dnMemoryUsage before = node.memoryUsage();
+
+  node.freeze();
+  dnMemoryUsage after = node.memoryUsage();
+
+  BOOST_TEST_MESSAGE("freeze memory: " << toString(before.total()) << " -> " << toString(after.total()));
+  BOOST_CHECK(after.total() < before.total());
+  BOOST_CHECK(after.nodeCount == before.nodeCount);
+}
@@ -0,0 +1,169 @@
+#include <vector>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_algorithm.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+namespace {
+
+void add_sale(const dtpString &city, int shop, int qty, double price, dnode &rows)
+{
+  dnode *row = new dnode(ict_parent);
+  row->addChild("city", new dnode(city));
+  dnode *info = new dnode(ict_parent);
+  info->addChild("shop", new dnode(shop));
+  row->addChild("info", info);
+  row->addChild("qty", new dnode(qty));
+  row->addChild("price", new dnode(price));
+  rows.addChild(row);
+}
+
+void build_sales_rows(dnode &output)
+{
+  output = dnode(ict_list);
+  add_sale("Paris", 1, 2, 10.0, output);
+  add_sale("Rome", 2, 1, 4.0, output);
+  add_sale("Paris", 1, 3, 6.0, output);
+  add_sale("Paris", 3, 5, 2.0, output);
+  add_sale("Rome", 2, 4, 8.0, output);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_group_by_rows)
+{
+  dnode sales;
+  build_sales_rows(sales);
+
+  std::vector<dtpString> keys;
+  keys.push_back("city");
+  keys.push_back("info/shop");
+
+  std::vector<dnAggregateSpec> aggs;
+  aggs.push_back(dnAggregateSpec(daf_count));
+  aggs.push_back(dnAggregateSpec(daf_sum, "qty"));
+  aggs.push_back(dnAggregateSpec(daf_avg, "price"));
+  aggs.push_back(dnAggregateSpec(daf_max, "price", "top"));
+
+  dnode output;
+  group_by(sales, keys, aggs, output);
+
+  // groups in order of first appearance
+  BOOST_REQUIRE_EQUAL(output.size(), 3U);
+  BOOST_CHECK(output[0].get<dtpString>("city") == "Paris");
+  BOOST_CHECK_EQUAL(output[0].get<int>("shop"), 1);
+  BOOST_CHECK_EQUAL(output[0].get<uint64>("count"), 2U);
+  BOOST_CHECK_EQUAL(output[0].get<int64>("sum_qty"), 5);
+  BOOST_CHECK_EQUAL(output[0].get<double>("avg_price"), 8.0);
+  BOOST_CHECK_EQUAL(output[0].get<double>("top"), 10.0);
+  BOOST_CHECK(output[1].get<dtpString>("city") == "Rome");
+  BOOST_CHECK_EQUAL(output[1].get<int64>("sum_qty"), 5);
+  BOOST_CHECK_EQUAL(output[2].get<int>("shop"), 3);
+  BOOST_CHECK_EQUAL(output[2].get<uint64>("count"), 1U);
+
+  // missing key field forms null group, missing value is skipped
+  dnode *row = new dnode(ict_parent);
+  row->addChild("qty", new dnode(7));
+  sales.addChild(row);
+  keys.pop_back();
+  group_by(sales, keys, aggs, output);
+  BOOST_REQUIRE_EQUAL(output.size(), 3U);
+  BOOST_CHECK(output[2]["city"].isNull());
+  BOOST_CHECK_EQUAL(output[2].get<int64>("sum_qty"), 7);
+  BOOST_CHECK(output[2]["avg_price"].isNull());
+
+  aggs.push_back(dnAggregateSpec(daf_sum));
+  BOOST_CHECK_THROW(group_by(sales, keys, aggs, output), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_group_by_columns)
+{
+  dnode table(ict_parent);
+  dnode *city = new dnode(ict_array, vt_string);
+  dnode *qty = new dnode(ict_array, vt_int);
+  dnode *price = new dnode(ict_array, vt_double);
+  const char *cities[] = {"Paris", "Rome", "Paris", "Oslo", "Rome", "Paris"};
+  for(int i=0; i < 6; i++) {
+    city->addItem(dtpString(cities[i]));
+    qty->addItem(i + 1);
+    price->addItem(static_cast<double>(i) * 0.5);
+  }
+  table.addChild("city", city);
+  table.addChild("qty", qty);
+  table.addChild("price", price);
+
+  std::vector<dtpString> keys(1, "city");
+  std::vector<dnAggregateSpec> aggs;
+  aggs.push_back(dnAggregateSpec(daf_count));
+  aggs.push_back(dnAggregateSpec(daf_sum, "qty"));
+  aggs.push_back(dnAggregateSpec(daf_sum, "price"));
+  aggs.push_back(dnAggregateSpec(daf_min, "qty"));
+
+  dnode output;
+  group_by(table, keys, aggs, output);
+
+  BOOST_REQUIRE(output.supportsNames());
+  BOOST_REQUIRE_EQUAL(output["city"].size(), 3U);
+  BOOST_CHECK(output["city"].get<dtpString>(2) == "Oslo");
+  BOOST_CHECK_EQUAL(output["count"].getElementType(), vt_uint64);
+  BOOST_CHECK_EQUAL(output["count"].get<uint64>(0), 3U);
+  BOOST_CHECK_EQUAL(output["sum_qty"].getElementType(), vt_int64);
+  BOOST_CHECK_EQUAL(output["sum_qty"].get<int64>(0), 1 + 3 + 6);
+  BOOST_CHECK_EQUAL(output["sum_price"].getElementType(), vt_double);
+  BOOST_CHECK_EQUAL(output["sum_price"].get<double>(1), 0.5 + 2.0);
+  BOOST_CHECK_EQUAL(output["min_qty"].get<double>(1), 2.0);
+
+  // rows output for columnar input
+  dnGroupByOptions options;
+  options.outputFormat = dtf_rows;
+  group_by(table, keys, aggs, output, options);
+  BOOST_REQUIRE_EQUAL(output.size(), 3U);
+  BOOST_CHECK_EQUAL(output[2].get<uint64>("count"), 1U);
+
+  keys[0] = "missing";
+  BOOST_CHECK_THROW(group_by(table, keys, aggs, output), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_group_by_parallel)
+{
+  dnode sales(ict_list);
+  for(int i=0; i < 20000; i++)
+    add_sale(dtpString("city") + toString(i % 37), i % 5, i % 11, static_cast<double>(i % 13), sales);
+
+  std::vector<dtpString> keys;
+  keys.push_back("city");
+  keys.push_back("info/shop");
+
+  std::vector<dnAggregateSpec> aggs;
+  aggs.push_back(dnAggregateSpec(daf_count));
+  aggs.push_back(dnAggregateSpec(daf_sum, "qty"));
+  aggs.push_back(dnAggregateSpec(daf_min, "price"));
+  aggs.push_back(dnAggregateSpec(daf_max, "price"));
+
+  dnGroupByOptions sequential;
+  sequential.parallel = false;
+  dnGroupByOptions parallel;
+  parallel.minParallelRows = 1;
+
+  dnode output1, output2;
+  group_by(sales, keys, aggs, output1, sequential);
+  group_by(sales, keys, aggs, output2, parallel);
+
+  BOOST_REQUIRE_EQUAL(output1.size(), output2.size());
+  uint64 total = 0;
+  for(dnode::size_type i=0, epos = output1.size(); i != epos; i++) {
+    BOOST_CHECK(output1[i].get<dtpString>("city") == output2[i].get<dtpString>("city"));
+    BOOST_CHECK_EQUAL(output1[i].get<int>("shop"), output2[i].get<int>("shop"));
+    BOOST_CHECK_EQUAL(output1[i].get<uint64>("count"), output2[i].get<uint64>("count"));
+    BOOST_CHECK_EQUAL(output1[i].get<int64>("sum_qty"), output2[i].get<int64>("sum_qty"));
+    BOOST_CHECK_EQUAL(output1[i].get<double>("min_price"), output2[i].get<double>("min_price"));
+    BOOST_CHECK_EQUAL(output1[i].get<double>("max_price"), output2[i].get<double>("max_price"));
+    total += output2[i].get<uint64>("count");
+  }
+  BOOST_CHECK_EQUAL(total, 20000U);
+}
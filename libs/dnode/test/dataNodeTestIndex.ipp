@@ -0,0 +1,118 @@
+#include <vector>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_index.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+namespace {
+
+void build_index_item(int id, const dtpString &city, int age, dnode &output)
+{
+  output = dnode(ict_parent);
+  output.addChild("id", new dnode(id));
+  dnode *profile = new dnode(ict_parent);
+  profile->addChild("city", new dnode(city));
+  profile->addChild("age", new dnode(age));
+  output.addChild("profile", profile);
+}
+
+void build_index_sample(dnIndexedList &output)
+{
+  dnode item;
+  build_index_item(10, "Paris", 30, item);
+  output.addItem(item);
+  build_index_item(20, "Berlin", 25, item);
+  output.addItem(item);
+  build_index_item(30, "Paris", 41, item);
+  output.addItem(item);
+  build_index_item(40, "Rome", 25, item);
+  output.addItem(item);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_index_hash)
+{
+  dnIndexedList list;
+  list.addIndex("id", new dnHashIndex<int>("id"));
+  list.addIndex("city", new dnHashIndex<dtpString>("profile/city"));
+  build_index_sample(list);
+
+  dnHashIndex<int> &ids = list.getIndexAs<dnHashIndex<int> >("id");
+  BOOST_CHECK_EQUAL(ids.size(), 4U);
+  BOOST_CHECK_EQUAL(ids.find(30), 2U);
+  BOOST_CHECK(ids.find(35) == dnode::npos);
+  BOOST_CHECK_EQUAL(list[ids.find(20)].get<int>("id"), 20);
+
+  std::vector<dnode::size_type> found;
+  list.getIndexAs<dnHashIndex<dtpString> >("city").findAll("Paris", found);
+  BOOST_REQUIRE_EQUAL(found.size(), 2U);
+  BOOST_CHECK_EQUAL(found[0], 0U);
+  BOOST_CHECK_EQUAL(found[1], 2U);
+
+  BOOST_CHECK_THROW(list.getIndexAs<dnSortedIndex<int> >("id"), dnError);
+  BOOST_CHECK_THROW(list.getIndex("name"), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_index_sorted_range)
+{
+  dnIndexedList list;
+  build_index_sample(list);
+  // index attached to list with items is built on attach
+  list.addIndex("age", new dnSortedIndex<int>("profile/age"));
+
+  dnSortedIndex<int> &ages = list.getIndexAs<dnSortedIndex<int> >("age");
+  BOOST_CHECK_EQUAL(ages.count(25), 2U);
+  BOOST_CHECK_EQUAL(ages.find(25), 1U);
+
+  std::vector<dnode::size_type> found;
+  ages.findRange(25, 35, found);
+  BOOST_REQUIRE_EQUAL(found.size(), 3U);
+  BOOST_CHECK_EQUAL(list[found[2]].get<int>("id"), 10);
+
+  found.clear();
+  ages.findRange(42, 50, found);
+  BOOST_CHECK(found.empty());
+  BOOST_CHECK_EQUAL(ages.begin()->first, 25);
+}
+
+BOOST_AUTO_TEST_CASE(test_index_maintenance)
+{
+  dnIndexedList list;
+  list.addIndex("id", new dnHashIndex<int>("id"));
+  list.addIndex("age", new dnSortedIndex<int>("profile/age"));
+  build_index_sample(list);
+
+  dnHashIndex<int> &ids = list.getIndexAs<dnHashIndex<int> >("id");
+  dnSortedIndex<int> &ages = list.getIndexAs<dnSortedIndex<int> >("age");
+
+  // replace key
+  dnode item;
+  build_index_item(25, "Oslo", 60, item);
+  list.setElement(1, item);
+  BOOST_CHECK(ids.find(20) == dnode::npos);
+  BOOST_CHECK_EQUAL(ids.find(25), 1U);
+  BOOST_CHECK_EQUAL(ages.find(60), 1U);
+
+  // positions after erased item are shifted
+  list.eraseElement(0);
+  BOOST_CHECK(ids.find(10) == dnode::npos);
+  BOOST_CHECK_EQUAL(ids.find(25), 0U);
+  BOOST_CHECK_EQUAL(ids.find(40), 2U);
+  BOOST_CHECK_EQUAL(ages.find(41), 1U);
+  BOOST_CHECK_EQUAL(ids.size(), 3U);
+
+  // items without key field are not indexed
+  list.addItem(dnode(ict_parent));
+  BOOST_CHECK_EQUAL(list.size(), 4U);
+  BOOST_CHECK_EQUAL(ids.size(), 3U);
+
+  list.clear();
+  BOOST_CHECK_EQUAL(ids.size(), 0U);
+  BOOST_CHECK(ages.find(41) == dnode::npos);
+}
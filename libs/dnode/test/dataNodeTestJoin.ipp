@@ -0,0 +1,164 @@
+#include <vector>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_algorithm.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+namespace {
+
+void add_order(int orderNo, int customerId, double amount, dnode &rows)
+{
+  dnode *row = new dnode(ict_parent);
+  row->addChild("order_no", new dnode(orderNo));
+  row->addChild("customer_id", new dnode(customerId));
+  row->addChild("amount", new dnode(amount));
+  rows.addChild(row);
+}
+
+void add_customer(int64 id, const dtpString &name, dnode &rows)
+{
+  dnode *row = new dnode(ict_parent);
+  row->addChild("id", new dnode(id));
+  row->addChild("name", new dnode(name));
+  dnode *address = new dnode(ict_parent);
+  address->addChild("city", new dnode(name + " city"));
+  row->addChild("address", address);
+  rows.addChild(row);
+}
+
+void build_join_sample(dnode &orders, dnode &customers)
+{
+  orders = dnode(ict_list);
+  add_order(1, 10, 5.0, orders);
+  add_order(2, 30, 7.5, orders);
+  add_order(3, 20, 1.0, orders);
+  add_order(4, 10, 2.5, orders);
+
+  customers = dnode(ict_list);
+  add_customer(10, "Anna", customers);
+  add_customer(20, "Bob", customers);
+  add_customer(10, "Anna-2", customers);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_hash_join_rows)
+{
+  dnode orders, customers;
+  build_join_sample(orders, customers);
+
+  std::vector<dtpString> leftKeys(1, "customer_id"), rightKeys(1, "id");
+  std::vector<dnJoinColumn> columns;
+  columns.push_back(dnJoinColumn(djs_left, "order_no"));
+  columns.push_back(dnJoinColumn(djs_right, "name", "customer"));
+  columns.push_back(dnJoinColumn(djs_right, "address/city"));
+
+  dnode output;
+  hash_join(orders, customers, leftKeys, rightKeys, columns, djt_inner, output);
+
+  // ordered by left row, then by right row, int and int64 keys match
+  BOOST_REQUIRE_EQUAL(output.size(), 5U);
+  BOOST_CHECK_EQUAL(output[0].get<int>("order_no"), 1);
+  BOOST_CHECK(output[0].get<dtpString>("customer") == "Anna");
+  BOOST_CHECK(output[1].get<dtpString>("customer") == "Anna-2");
+  BOOST_CHECK(output[2].get<dtpString>("city") == "Bob city");
+  BOOST_CHECK_EQUAL(output[3].get<int>("order_no"), 4);
+  BOOST_CHECK_EQUAL(output[0].size(), 3U);
+  BOOST_CHECK(output[0].indexOfName("amount") == dnode::npos);
+
+  hash_join(orders, customers, leftKeys, rightKeys, columns, djt_left, output);
+  BOOST_REQUIRE_EQUAL(output.size(), 6U);
+  BOOST_CHECK_EQUAL(output[2].get<int>("order_no"), 2);
+  BOOST_CHECK(output[2]["customer"].isNull());
+  BOOST_CHECK(output[3].get<dtpString>("customer") == "Bob");
+
+  // key count mismatch, duplicated output name
+  std::vector<dtpString> twoKeys(2, "id");
+  BOOST_CHECK_THROW(hash_join(orders, customers, leftKeys, twoKeys, columns, djt_inner, output), dnError);
+  columns.push_back(dnJoinColumn(djs_left, "amount", "customer"));
+  BOOST_CHECK_THROW(hash_join(orders, customers, leftKeys, rightKeys, columns, djt_inner, output), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_hash_join_semi_columns)
+{
+  dnode orders, customers;
+  build_join_sample(orders, customers);
+
+  // columnar left table
+  dnode table(ict_parent);
+  dnode *orderNo = new dnode(ict_array, vt_int);
+  dnode *customerId = new dnode(ict_array, vt_int);
+  for(int i=0; i < 4; i++) {
+    orderNo->addItem(orders[i].get<int>("order_no"));
+    customerId->addItem(orders[i].get<int>("customer_id"));
+  }
+  table.addChild("order_no", orderNo);
+  table.addChild("customer_id", customerId);
+
+  std::vector<dtpString> leftKeys(1, "customer_id"), rightKeys(1, "id");
+  std::vector<dnJoinColumn> columns(1, dnJoinColumn(djs_left, "order_no"));
+
+  dnode output;
+  hash_join(table, customers, leftKeys, rightKeys, columns, djt_semi, output);
+
+  // each left row once, array column keeps its type
+  BOOST_REQUIRE(output.supportsNames());
+  BOOST_REQUIRE_EQUAL(output["order_no"].size(), 3U);
+  BOOST_CHECK_EQUAL(output["order_no"].getElementType(), vt_int);
+  BOOST_CHECK_EQUAL(output["order_no"].get<int>(0), 1);
+  BOOST_CHECK_EQUAL(output["order_no"].get<int>(1), 3);
+  BOOST_CHECK_EQUAL(output["order_no"].get<int>(2), 4);
+
+  // right columns of left join are lists (can contain nulls)
+  columns.push_back(dnJoinColumn(djs_right, "name"));
+  hash_join(table, customers, leftKeys, rightKeys, columns, djt_left, output);
+  BOOST_REQUIRE_EQUAL(output["name"].size(), 6U);
+  BOOST_CHECK(output["name"].isList());
+  BOOST_CHECK(output["name"][2].isNull());
+
+  BOOST_CHECK_THROW(hash_join(table, customers, leftKeys, rightKeys, columns, djt_semi, output), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_hash_join_parallel)
+{
+  dnode orders(ict_list), customers(ict_list);
+  for(int i=0; i < 30000; i++)
+    add_order(i, i % 1200, static_cast<double>(i % 17), orders);
+  for(int i=0; i < 1000; i++)
+    add_customer(i, dtpString("customer") + toString(i), customers);
+
+  std::vector<dtpString> leftKeys(1, "customer_id"), rightKeys(1, "id");
+  std::vector<dnJoinColumn> columns;
+  columns.push_back(dnJoinColumn(djs_left, "order_no"));
+  columns.push_back(dnJoinColumn(djs_right, "name"));
+
+  dnJoinOptions sequential;
+  sequential.parallel = false;
+  dnJoinOptions parallel;
+  parallel.minParallelRows = 1;
+
+  for(int joinType = djt_inner; joinType <= djt_left; joinType++) {
+    dnode output1, output2;
+    // hash table for smaller right table, larger left table is probed
+    hash_join(orders, customers, leftKeys, rightKeys, columns, static_cast<dnJoinType>(joinType), output1, sequential);
+    hash_join(orders, customers, leftKeys, rightKeys, columns, static_cast<dnJoinType>(joinType), output2, parallel);
+
+    BOOST_REQUIRE_EQUAL(output1.size(), output2.size());
+    BOOST_CHECK_EQUAL(output1.size(), (joinType == djt_inner) ? 25000U : 30000U);
+    for(dnode::size_type i=0, epos = output1.size(); i != epos; i++) {
+      BOOST_CHECK_EQUAL(output1[i].get<int>("order_no"), output2[i].get<int>("order_no"));
+      BOOST_CHECK(output1[i]["name"].isNull() == output2[i]["name"].isNull());
+    }
+  }
+
+  // hash table for smaller left table
+  dnode output;
+  std::vector<dnJoinColumn> nameColumn(1, dnJoinColumn(djs_left, "name"));
+  hash_join(customers, orders, rightKeys, leftKeys, nameColumn, djt_semi, output, parallel);
+  BOOST_CHECK_EQUAL(output.size(), 1000U);
+}
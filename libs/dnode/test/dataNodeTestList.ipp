@@ -96,3 +96,109 @@ BOOST_AUTO_TEST_CASE(test_list)
 
 }
 
+
+BOOST_AUTO_TEST_CASE(test_deque_list)
+{
+  dnode queue(ict_deque);
+  BOOST_CHECK(queue.isList());
+  BOOST_CHECK(queue.isDeque());
+
+  // work queue: push at back, pop from front
+  for(int i=0; i < 1000; i++)
+    queue.push_back(i);
+  for(int i=0; i < 500; i++) {
+    BOOST_CHECK(queue[0].getAs<int>() == i);
+    queue.eraseElement(0);
+  }
+  BOOST_CHECK(queue.size() == 500);
+  BOOST_CHECK(queue.get<int>(0) == 500);
+
+  queue.push_front(-1);
+  queue.getChildren().insert(2, new dnode(-2));
+  BOOST_CHECK(queue.get<int>(0) == -1);
+  BOOST_CHECK(queue.get<int>(1) == 500);
+  BOOST_CHECK(queue.get<int>(2) == -2);
+  BOOST_CHECK(queue.get<int>(queue.size() - 1) == 999);
+
+  // sliding window: drop oldest items in bulk
+  queue.eraseElements(0, 3);
+  BOOST_CHECK(queue.size() == 499);
+  BOOST_CHECK(queue.get<int>(0) == 501);
+
+  // algorithms
+  BOOST_CHECK(queue.find(700) != queue.end());
+  queue.push_back(5);
+  queue.sort<int>();
+  BOOST_CHECK(queue.get<int>(0) == 5);
+  BOOST_CHECK(queue.is_sorted<int>());
+  BOOST_CHECK(queue.binary_search<int>(800));
+
+  // copy keeps deque mode
+  dnode copy(queue);
+  BOOST_CHECK(copy.isDeque());
+  BOOST_CHECK(copy.size() == queue.size());
+  BOOST_CHECK(copy.get<int>(10) == queue.get<int>(10));
+
+  // conversion of existing list keeps items
+  dnode list(ict_list);
+  for(int i=0; i < 10; i++)
+    list.addChild(new dnode(i));
+  list.setAsDeque();
+  BOOST_CHECK(list.isDeque());
+  BOOST_CHECK(list.size() == 10);
+  BOOST_CHECK(list.get<int>(9) == 9);
+  list.setAsList();
+  BOOST_CHECK(list.isDeque());
+
+  list.resize(4);
+  BOOST_CHECK(list.size() == 4);
+  list.eraseFrom(2);
+  BOOST_CHECK(list.size() == 2);
+  BOOST_CHECK(list.get<int>(1) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_erase_range)
+{
+  // list
+  dnode list(ict_list);
+  for(int i=0; i < 10; i++)
+    list.addChild(new dnode(i));
+  list.eraseElements(2, 5);
+  BOOST_CHECK(list.size() == 5);
+  BOOST_CHECK(list.get<int>(1) == 1);
+  BOOST_CHECK(list.get<int>(2) == 7);
+  list.eraseElements(5, 0);
+  BOOST_CHECK(list.size() == 5);
+
+  // parent - name index is updated
+  dnode parent(ict_parent);
+  for(int i=0; i < 10; i++)
+    parent.addChild(dtpString("n") + toString(i), new dnode(i));
+  parent.addChild("n1", new dnode(100));
+  parent.eraseElements(1, 3);
+  BOOST_CHECK(parent.size() == 8);
+  BOOST_CHECK(!parent.hasChild("n2"));
+  BOOST_CHECK(parent.hasChild("n4"));
+  BOOST_CHECK(parent.get<int>("n4") == 4);
+  BOOST_CHECK(parent.getElementName(1) == "n4");
+
+  // truncate
+  parent.eraseFrom(5);
+  BOOST_CHECK(parent.size() == 5);
+  BOOST_CHECK(!parent.hasChild("n9"));
+  BOOST_CHECK(parent.get<int>("n7") == 7);
+
+  // arrays
+  dnode arr(ict_array, vt_int);
+  dnode nodeArr(ict_array, vt_datanode);
+  for(int i=0; i < 10; i++) {
+    arr.addItem(i);
+    nodeArr.addItem(dnode(i));
+  }
+  arr.eraseElements(0, 4);
+  nodeArr.eraseElements(8, 2);
+  BOOST_CHECK(arr.size() == 6);
+  BOOST_CHECK(arr.get<int>(0) == 4);
+  BOOST_CHECK(nodeArr.size() == 8);
+  BOOST_CHECK(nodeArr.get<int>(7) == 7);
+}
@@ -0,0 +1,267 @@
+#include <vector>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_parallel.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+void build_parallel_sample(dnode &output, int itemCount)
+{
+  output.setAsParent();
+  for(int i=0; i < itemCount; i++) {
+    dnode *item = new dnode(ict_parent);
+    item->addChild("id", new dnode(i));
+    item->addChild("label", new dnode(dtpString("item") + toString(i)));
+
+    dnode *values = new dnode(ict_array, vt_int);
+    for(int j=0; j < 5; j++)
+      values->addItem(i * 10 + j);
+    item->addChild("values", values);
+
+    dnode *tags = new dnode(ict_list);
+    tags->addChild(new dnode(dtpString("t") + toString(i % 7)));
+    item->addChild("tags", tags);
+
+    output.addChild(dtpString("n") + toString(i), item);
+  }
+}
+
+dnParallelOptions parallel_test_options(dnThreadPool &pool)
+{
+  dnParallelOptions res;
+  res.minParallelItems = 16;
+  res.pool = &pool;
+  return res;
+}
+
+class dnTestFailingTask: public dnParallelTask {
+public:
+  virtual void run() { throw dnError("test failure"); }
+};
+
+class dnTestCountingTask: public dnParallelTask {
+public:
+  dnTestCountingTask(): m_count(0), m_pool(DTP_NULL) {}
+  dnTestCountingTask(dnThreadPool &pool): m_count(0), m_pool(&pool) {}
+
+  virtual void run() {
+    if (m_pool != DTP_NULL) {
+      std::vector<dnTestCountingTask> inner(10);
+      std::vector<dnParallelTask *> ptrs;
+      for(size_t i=0; i < inner.size(); i++)
+        ptrs.push_back(&inner[i]);
+      m_pool->execute(&ptrs[0], ptrs.size());
+      for(size_t i=0; i < inner.size(); i++)
+        m_count += inner[i].getCount();
+    } else {
+      m_count = 1;
+    }
+  }
+
+  int getCount() const { return m_count; }
+private:
+  int m_count;
+  dnThreadPool *m_pool;
+};
+
+/// Builds, iterates & destroys a tree, to be run concurrently
+class dnTestBuildTask: public dnParallelTask {
+public:
+  dnTestBuildTask(): m_sum(0) {}
+
+  virtual void run() {
+    for(int round=0; round < 5; round++) {
+      dnode tree;
+      build_parallel_sample(tree, 100);
+      dnode::size_type index = 0;
+      for(dnode::const_iterator it = tree.begin(), epos = tree.end(); it != epos; ++it, ++index)
+        m_sum += tree.getElement(index).get<int>("id");
+    }
+  }
+
+  int getSum() const { return m_sum; }
+private:
+  int m_sum;
+};
+
+BOOST_AUTO_TEST_CASE(test_parallel_pool_execute)
+{
+  dnThreadPool pool(3);
+  BOOST_CHECK(pool.getConcurrency() == 4);
+
+  std::vector<dnTestCountingTask> tasks(20, dnTestCountingTask(pool));
+  std::vector<dnParallelTask *> ptrs;
+  for(size_t i=0; i < tasks.size(); i++)
+    ptrs.push_back(&tasks[i]);
+
+  pool.execute(&ptrs[0], ptrs.size());
+
+  int total = 0;
+  for(size_t i=0; i < tasks.size(); i++)
+    total += tasks[i].getCount();
+  BOOST_CHECK(total == 200);
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_pool_error)
+{
+  dnThreadPool pool(2);
+  dnTestCountingTask ok1, ok2;
+  dnTestFailingTask failing;
+  dnParallelTask *ptrs[3] = {&ok1, &failing, &ok2};
+
+  BOOST_CHECK_THROW(pool.execute(ptrs, 3), dnError);
+
+  // pool is still usable
+  dnParallelTask *okPtrs[2] = {&ok1, &ok2};
+  pool.execute(okPtrs, 2);
+  BOOST_CHECK(ok1.getCount() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_memory_stats)
+{
+  dnThreadPool pool(3);
+  const uint64 bridgesBefore = dnMemoryStats::liveBridgeCount();
+
+  // containers & bridges are registered from several threads at once
+  std::vector<dnTestBuildTask> tasks(16);
+  std::vector<dnParallelTask *> ptrs;
+  for(size_t i=0; i < tasks.size(); i++)
+    ptrs.push_back(&tasks[i]);
+  pool.execute(&ptrs[0], ptrs.size());
+
+  for(size_t i=0; i < tasks.size(); i++)
+    BOOST_CHECK(tasks[i].getSum() == 5 * 4950);
+
+  BOOST_CHECK(dnMemoryStats::liveBridgeCount() == bridgesBefore);
+
+  dnode stats;
+  dnMemoryStats::getStats(stats);
+  BOOST_CHECK(dnMemoryStats::enabled() != stats.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_copy_from)
+{
+  dnThreadPool pool(3);
+  dnode input, seqOutput, parOutput;
+  build_parallel_sample(input, 500);
+
+  seqOutput.copyFrom(input);
+  parOutput.setAsArray(vt_int);
+  dpar_copy_from(parOutput, input, parallel_test_options(pool));
+
+  BOOST_CHECK(parOutput.isParent());
+  BOOST_CHECK(!parOutput.isList());
+  BOOST_CHECK(parOutput.size() == 500);
+  BOOST_CHECK(parOutput.getElementName(123) == "n123");
+  BOOST_CHECK(parOutput.getElement("n499").get<int>("id") == 499);
+  BOOST_CHECK(dnode_deep_equal(seqOutput, parOutput));
+  BOOST_CHECK(dnode_deep_equal(input, parOutput));
+  BOOST_CHECK(dpar_deep_equal(input, parOutput, parallel_test_options(pool)));
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_copy_named)
+{
+  // every item is a named parent cloned on a worker, nested 3 levels deep;
+  // races on shared container pools are reported by ThreadSanitizer
+  dnThreadPool pool(3);
+  dnParallelOptions options = parallel_test_options(pool);
+  options.minParallelItems = 1;
+
+  dnode input(ict_list);
+  for(int i=0; i < 200; i++) {
+    dnode *level1 = new dnode(ict_parent);
+    dnode *level2 = new dnode(ict_parent);
+    dnode *level3 = new dnode();
+    build_parallel_sample(*level3, 3);
+    level2->addChild("inner", level3);
+    level2->addChild("id", new dnode(i));
+    level1->addChild("outer", level2);
+    level1->addChild(dtpString("k") + toString(i), new dnode(i * 2));
+    input.addChild(level1);
+  }
+
+  for(int round=0; round < 5; round++) {
+    dnode output;
+    dpar_copy_from(output, input, options);
+    BOOST_CHECK(output.size() == 200);
+    BOOST_CHECK(output.getElement(150)["outer"].get<int>("id") == 150);
+    BOOST_CHECK(output.getElement(150).get<int>("k150") == 300);
+    BOOST_CHECK(dnode_deep_equal(input, output));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_copy_split)
+{
+  // small root with large branches
+  dnThreadPool pool(2);
+  dnode input(ict_list), output;
+  for(int i=0; i < 3; i++) {
+    dnode *branch = new dnode();
+    build_parallel_sample(*branch, 100);
+    input.addChild(branch);
+  }
+
+  dpar_copy_from(output, input, parallel_test_options(pool));
+
+  BOOST_CHECK(output.isList());
+  BOOST_CHECK(output.size() == 3);
+  BOOST_CHECK(output.getElement(2).size() == 100);
+  BOOST_CHECK(dnode_deep_equal(input, output));
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_copy_children)
+{
+  dnThreadPool pool(3);
+  dnode input, output;
+  build_parallel_sample(input, 300);
+
+  output.setAsParent();
+  output.addChild("first", new dnode(1));
+  dpar_copy_children_from(output, input, parallel_test_options(pool));
+
+  BOOST_CHECK(output.size() == 301);
+  BOOST_CHECK(output.getElementName(0) == "first");
+  BOOST_CHECK(output.getElementName(300) == "n299");
+  BOOST_CHECK(dnode_deep_equal(output.getElement("n42"), input.getElement("n42")));
+
+  dnode *clone = dpar_clone_child(input, 7, parallel_test_options(pool));
+  BOOST_CHECK(dnode_deep_equal(*clone, input.getElement(7)));
+  delete clone;
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_deep_equal)
+{
+  dnThreadPool pool(3);
+  dnParallelOptions options = parallel_test_options(pool);
+  dnode lhs, rhs;
+  build_parallel_sample(lhs, 400);
+  build_parallel_sample(rhs, 400);
+
+  BOOST_CHECK(dnode_deep_equal(lhs, rhs));
+  BOOST_CHECK(dpar_deep_equal(lhs, rhs, options));
+
+  // value difference in a nested array
+  rhs[399]["values"].setElement(4, dnode(-1));
+  BOOST_CHECK(!dnode_deep_equal(lhs, rhs));
+  BOOST_CHECK(!dpar_deep_equal(lhs, rhs, options));
+
+  // name difference
+  rhs.clear();
+  build_parallel_sample(rhs, 400);
+  rhs.getChildren().setName(200, "other");
+  BOOST_CHECK(!dnode_deep_equal(lhs, rhs));
+  BOOST_CHECK(!dpar_deep_equal(lhs, rhs, options));
+
+  // container kind & size
+  dnode list(ict_list), parent(ict_parent);
+  list.addChild(new dnode(1));
+  parent.addChild("0", new dnode(1));
+  BOOST_CHECK(!dnode_deep_equal(list, parent));
+  BOOST_CHECK(!dnode_deep_equal(lhs, lhs.getElement(0)));
+  BOOST_CHECK(dnode_deep_equal(dnode(5), dnode(5)));
+  BOOST_CHECK(!dnode_deep_equal(dnode(5), dnode(6)));
+}
@@ -0,0 +1,202 @@
+#include <cstdio>
+#include <fstream>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_persist.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+namespace {
+
+const char *PERSIST_TEST_FILE = "test_persist.dnp";
+
+void build_persist_sample(dnode &output)
+{
+  output.setAsParent();
+  output.addChild("name", new dnode(dtpString("alpha")));
+  output.addChild("count", new dnode(12));
+
+  dnode *values = new dnode(ict_array, vt_double);
+  for(int i=0; i < 5; i++)
+    values->addItem(static_cast<double>(i));
+  output.addChild("values", values);
+
+  dnode *tags = new dnode(ict_array, vt_string);
+  tags->addItem(dtpString("red"));
+  output.addChild("tags", tags);
+
+  output.addChild("items", new dnode(ict_list));
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_persist_reopen)
+{
+  std::remove(PERSIST_TEST_FILE);
+  {
+    dnPersistentStore store(PERSIST_TEST_FILE);
+    BOOST_CHECK(store.getRoot().isNull());
+    BOOST_CHECK_EQUAL(store.getSequence(), 1U);
+
+    dnode sample;
+    build_persist_sample(sample);
+    store.setRoot(sample);
+    BOOST_CHECK(store.isModified());
+    store.commit();
+    BOOST_CHECK(!store.isModified());
+  }
+
+  dnPersistentStore store(PERSIST_TEST_FILE);
+  BOOST_CHECK_EQUAL(store.getSequence(), 2U);
+
+  dnodeView item;
+  BOOST_CHECK(store.getElementByPath("name", item));
+  BOOST_CHECK(item.getStringRef() == "alpha");
+  BOOST_CHECK_EQUAL(store.getRoot().get<int>("count"), 12);
+  BOOST_CHECK_EQUAL(store.getRoot().getElement("values").arrayData<double>()[3], 3.0);
+  BOOST_CHECK(store.getRoot().validate(static_cast<size_t>(store.getDataSize())));
+
+  dnode loaded;
+  store.load(loaded);
+  BOOST_CHECK_EQUAL(loaded.get<int>("count"), 12);
+  BOOST_CHECK_EQUAL(loaded["values"].size(), 5U);
+
+  store.close();
+  std::remove(PERSIST_TEST_FILE);
+}
+
+BOOST_AUTO_TEST_CASE(test_persist_modify)
+{
+  std::remove(PERSIST_TEST_FILE);
+  {
+    dnPersistentStore store(PERSIST_TEST_FILE);
+    dnode sample;
+    build_persist_sample(sample);
+    store.setRoot(sample);
+    store.commit();
+
+    store.setElement("count", dnode(13));
+    store.setElement("values/1", dnode(7.5));
+    store.addItem("values", dnode(8.5));
+    store.addItem("tags", dnode(dtpString("green")));
+    store.setElement("tags/0", dnode(dtpString("blue")));
+    for(int i=0; i < 20; i++)
+      store.addItem("items", dnode(i));
+    // missing last path item is added as named child
+    store.setElement("limit", dnode(100));
+    store.addChild("", "base", dnode(dtpString("beta")));
+    store.eraseElement("name");
+    store.eraseElement("items/0");
+    store.commit();
+  }
+
+  dnPersistentStore store(PERSIST_TEST_FILE);
+  dnodeView root = store.getRoot();
+  BOOST_CHECK(!root.hasChild("name"));
+  BOOST_CHECK_EQUAL(root.get<int>("count"), 13);
+  BOOST_CHECK_EQUAL(root.get<int>("limit"), 100);
+  BOOST_CHECK(root.getElement("base").getStringRef() == "beta");
+  BOOST_CHECK_EQUAL(root.getElement("values").size(), 6U);
+  BOOST_CHECK_EQUAL(root.getElement("values").get<double>(1), 7.5);
+  BOOST_CHECK_EQUAL(root.getElement("values").get<double>(5), 8.5);
+  BOOST_CHECK(root.getElement("tags").getElement(static_cast<dnodeView::size_type>(0)).getStringRef() == "blue");
+  BOOST_CHECK(root.getElement("tags").getElement(1).getStringRef() == "green");
+  BOOST_CHECK_EQUAL(root.getElement("items").size(), 19U);
+  BOOST_CHECK_EQUAL(root.getElement("items").get<int>(0), 1);
+  BOOST_CHECK(root.validate(static_cast<size_t>(store.getDataSize())));
+
+  BOOST_CHECK_THROW(store.setElement("missing/value", dnode(1)), dnError);
+  BOOST_CHECK_THROW(store.eraseElement(""), dnError);
+
+  store.close();
+  std::remove(PERSIST_TEST_FILE);
+}
+
+BOOST_AUTO_TEST_CASE(test_persist_rollback)
+{
+  std::remove(PERSIST_TEST_FILE);
+  {
+    dnPersistentStore store(PERSIST_TEST_FILE);
+    dnode sample;
+    build_persist_sample(sample);
+    store.setRoot(sample);
+    store.commit();
+
+    store.setElement("count", dnode(99));
+    store.rollback();
+    BOOST_CHECK_EQUAL(store.getRoot().get<int>("count"), 12);
+
+    // closed without commit
+    store.eraseElement("count");
+  }
+
+  dnPersistentStore store(PERSIST_TEST_FILE);
+  BOOST_CHECK_EQUAL(store.getRoot().get<int>("count"), 12);
+
+  // space released by updates is reused after commit
+  store.setElement("count", dnode(0));
+  store.commit();
+  uint64 dataSize = store.getDataSize();
+  for(int i=1; i < 100; i++) {
+    store.setElement("count", dnode(i));
+    store.setElement("name", dnode(dtpString(i % 10, 'x')));
+    store.commit();
+  }
+  BOOST_CHECK(store.getDataSize() <= dataSize + 1024);
+
+  store.close();
+  std::remove(PERSIST_TEST_FILE);
+}
+
+BOOST_AUTO_TEST_CASE(test_persist_recovery)
+{
+  std::remove(PERSIST_TEST_FILE);
+  uint64 sequence;
+  {
+    dnPersistentStore store(PERSIST_TEST_FILE);
+    dnode sample;
+    build_persist_sample(sample);
+    store.setRoot(sample);
+    store.commit();
+    sequence = store.getSequence();
+    store.setElement("count", dnode(20));
+    store.commit();
+  }
+
+  // damage commit slot with higher sequence (header: 24 bytes, slot: 48 bytes)
+  {
+    std::fstream file(PERSIST_TEST_FILE, std::ios::in | std::ios::out | std::ios::binary);
+    uint64 seq0, seq1;
+    file.seekg(24);
+    file.read(reinterpret_cast<char *>(&seq0), sizeof(seq0));
+    file.seekg(24 + 48);
+    file.read(reinterpret_cast<char *>(&seq1), sizeof(seq1));
+    uint64 damaged = 0;
+    file.seekp((seq0 > seq1) ? 24 + 8 : 24 + 48 + 8);
+    file.write(reinterpret_cast<const char *>(&damaged), sizeof(damaged));
+  }
+
+  dnPersistentStore store(PERSIST_TEST_FILE);
+  BOOST_CHECK_EQUAL(store.getSequence(), sequence);
+  BOOST_CHECK_EQUAL(store.getRoot().get<int>("count"), 12);
+
+  dnode big(ict_list);
+  for(int i=0; i < 10000; i++)
+    big.addChild(new dnode(dtpString("item") + toString(i)));
+  store.setElement("big", big);
+  store.commit();
+  store.eraseElement("big");
+  uint64 usedSize = store.getDataSize();
+
+  store.compact();
+  BOOST_CHECK(store.getDataSize() < usedSize);
+  BOOST_CHECK(!store.getRoot().hasChild("big"));
+  BOOST_CHECK_EQUAL(store.getRoot().get<int>("count"), 12);
+
+  store.close();
+  std::remove(PERSIST_TEST_FILE);
+}
@@ -0,0 +1,83 @@
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+struct dnByteSumVisitor {
+  uint64 total;
+  dnByteSumVisitor(): total(0) {}
+  void operator()(byte value) { total += value; }
+};
+
+BOOST_AUTO_TEST_CASE(test_size_types)
+{
+  BOOST_CHECK_EQUAL(sizeof(dnode::size_type), sizeof(dnSizeType));
+  BOOST_CHECK_EQUAL(sizeof(Details::dnArray::size_type), sizeof(dnSizeType));
+  BOOST_CHECK_EQUAL(sizeof(Details::dnChildColnBaseIntf::size_type), sizeof(dnSizeType));
+  BOOST_CHECK_EQUAL(sizeof(dnPosType), sizeof(dnSizeType));
+  BOOST_CHECK(dnPosType(-1) < 0);
+#ifdef DATANODE_SIZE64
+  BOOST_CHECK_EQUAL(sizeof(dnSizeType), 8U);
+#else
+  BOOST_CHECK_EQUAL(sizeof(dnSizeType), sizeof(uint));
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(test_size_positions)
+{
+  dnode arr(ict_array, vt_byte);
+  for(int i=0; i < 200; i++)
+    arr.addItem(static_cast<byte>(i));
+
+  dnPosType pos = 150;
+  dnode helper;
+  BOOST_CHECK_EQUAL(arr.get<int>(pos), 150);
+  BOOST_CHECK_EQUAL(arr.getNode(pos, helper).getAs<int>(), 150);
+
+  dnPosType foundPos = -1;
+  BOOST_CHECK(arr.getArrayR()->binarySearchValue(static_cast<byte>(120), dtpSignCompareOp<byte>(), foundPos));
+  BOOST_CHECK_EQUAL(foundPos, 120);
+
+  arr.eraseElements(static_cast<dnode::size_type>(10), static_cast<dnode::size_type>(90));
+  BOOST_CHECK_EQUAL(arr.size(), 110U);
+  BOOST_CHECK_EQUAL(arr.get<int>(10), 100);
+
+  dnode::const_iterator first = arr.begin();
+  dnode::const_iterator last = arr.end();
+  BOOST_CHECK_EQUAL(last - first, static_cast<dnode::const_iterator::difference_type>(110));
+
+  dnode list(ict_list);
+  for(int i=0; i < 10; i++)
+    list.addChild(new dnode(i));
+  list.eraseElement(static_cast<dnode::size_type>(3));
+  BOOST_CHECK_EQUAL(list.size(), 9U);
+  BOOST_CHECK_EQUAL(list.getChildren().at(pos - 147).getAs<int>(), 4);
+}
+
+#ifdef DATANODE_SIZE64
+// needs over 4 GB of memory
+BOOST_AUTO_TEST_CASE(test_size64_byte_array)
+{
+  const dnSizeType itemCount = 0x100000000ULL + 1024;
+  dnode arr(ict_array, vt_byte);
+  arr.resize(itemCount);
+  arr.set<byte>(0, 1);
+  arr.set<byte>(0x100000000ULL, 2);
+  arr.set<byte>(itemCount - 1, 3);
+
+  BOOST_CHECK(arr.size() == itemCount);
+  BOOST_CHECK_EQUAL(arr.get<int>(0x100000000ULL), 2);
+  BOOST_CHECK_EQUAL(arr.get<int>(itemCount - 1), 3);
+
+  dnByteSumVisitor sum = arr.visitVectorValues<byte>(dnByteSumVisitor());
+  BOOST_CHECK_EQUAL(sum.total, 6U);
+
+  arr.eraseElements(0x100000000ULL, 1024);
+  BOOST_CHECK(arr.size() == 0x100000000ULL);
+  BOOST_CHECK_EQUAL(arr.get<int>(0x100000000ULL - 1), 0);
+}
+#endif
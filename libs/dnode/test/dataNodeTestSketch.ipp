@@ -0,0 +1,213 @@
+#include <cmath>
+#include <vector>
+#include <sstream>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_sketch.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+bool sketch_close(double value, double expected, double tolerance)
+{
+  return std::fabs(value - expected) <= tolerance * std::max(1.0, std::fabs(expected));
+}
+
+BOOST_AUTO_TEST_CASE(test_sketch_quantile)
+{
+  dnQuantileSketch sketch;
+  BOOST_CHECK(sketch.empty());
+  BOOST_CHECK(sketch.quantile(0.5) == 0.0);
+
+  const int itemCount = 100000;
+  // values 0..itemCount-1 in scrambled order
+  for(int i=0; i < itemCount; i++)
+    sketch.add(static_cast<double>((i * 7919) % itemCount));
+
+  BOOST_CHECK(sketch.count() == itemCount);
+  BOOST_CHECK(sketch.minValue() == 0.0);
+  BOOST_CHECK(sketch.maxValue() == itemCount - 1);
+  BOOST_CHECK(sketch.getCentroidCount() < itemCount / 100);
+  BOOST_CHECK(sketch.quantile(0.0) == 0.0);
+  BOOST_CHECK(sketch.quantile(1.0) == itemCount - 1);
+  BOOST_CHECK(sketch_close(sketch.quantile(0.5), itemCount * 0.5, 0.01));
+  BOOST_CHECK(sketch_close(sketch.quantile(0.99), itemCount * 0.99, 0.001));
+  BOOST_CHECK(sketch_close(sketch.quantile(0.001), itemCount * 0.001, 0.5));
+  BOOST_CHECK(sketch_close(sketch.cdf(itemCount * 0.25), 0.25, 0.01));
+  BOOST_CHECK(sketch.cdf(-1.0) == 0.0);
+  BOOST_CHECK(sketch.cdf(itemCount) == 1.0);
+
+  // merge of halves
+  dnQuantileSketch lower, upper;
+  for(int i=0; i < itemCount / 2; i++)
+    lower.add(static_cast<double>(i));
+  for(int i=itemCount / 2; i < itemCount; i++)
+    upper.add(static_cast<double>(i));
+  lower.merge(upper);
+  BOOST_CHECK(lower.count() == itemCount);
+  BOOST_CHECK(lower.maxValue() == itemCount - 1);
+  BOOST_CHECK(sketch_close(lower.quantile(0.5), itemCount * 0.5, 0.01));
+  BOOST_CHECK(sketch_close(lower.quantile(0.9), itemCount * 0.9, 0.01));
+
+  // state
+  dnode state;
+  sketch.toNode(state);
+  dnQuantileSketch restored(10.0);
+  restored.fromNode(state);
+  BOOST_CHECK(restored.count() == sketch.count());
+  BOOST_CHECK(restored.getCompression() == sketch.getCompression());
+  BOOST_CHECK(restored.quantile(0.75) == sketch.quantile(0.75));
+
+  BOOST_CHECK_THROW(dnQuantileSketch(0.0), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_sketch_histogram)
+{
+  dnHistogram hist(0.0, 10.0, 5);
+  double values[] = {-1.0, 0.0, 1.5, 2.0, 3.9, 9.99, 10.0, 11.0};
+  hist.add(values, values + 8);
+
+  BOOST_CHECK(hist.count() == 8);
+  BOOST_CHECK(hist.getUnderflow() == 1);
+  BOOST_CHECK(hist.getOverflow() == 1);
+  BOOST_CHECK(hist.getBucketValue(0) == 2);
+  BOOST_CHECK(hist.getBucketValue(1) == 2);
+  BOOST_CHECK(hist.getBucketValue(4) == 2);
+
+  dnHistogramBucket bucket = hist.getBucket(1);
+  BOOST_CHECK(bucket.lower == 2.0);
+  BOOST_CHECK(bucket.upper == 4.0);
+
+  dnHistogram other(0.0, 10.0, 5);
+  other.add(5.0);
+  hist.merge(other);
+  BOOST_CHECK(hist.count() == 9);
+  BOOST_CHECK(hist.getBucketValue(2) == 1);
+
+  dnode state;
+  hist.toNode(state);
+  dnHistogram restored(0.0, 1.0, 1);
+  restored.fromNode(state);
+  BOOST_CHECK(restored.getBucketCount() == 5);
+  BOOST_CHECK(restored.getBucketValue(4) == 2);
+  BOOST_CHECK(restored.getOverflow() == 1);
+
+  BOOST_CHECK_THROW(hist.merge(dnHistogram(0.0, 10.0, 4)), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_sketch_log_histogram)
+{
+  const double accuracy = 0.01;
+  dnLogHistogram hist(accuracy);
+  const int itemCount = 10000;
+
+  for(int i=1; i <= itemCount; i++)
+    hist.add(static_cast<double>(i));
+  hist.add(0.0);
+  hist.add(-5.0);
+
+  BOOST_CHECK(hist.count() == itemCount + 2);
+  BOOST_CHECK(sketch_close(hist.quantile(0.0), -5.0, accuracy));
+  BOOST_CHECK(hist.quantile(1.5 / (itemCount + 1)) == 0.0);
+  BOOST_CHECK(sketch_close(hist.quantile(0.5), itemCount * 0.5, 2.0 * accuracy));
+  BOOST_CHECK(sketch_close(hist.quantile(0.99), itemCount * 0.99, 2.0 * accuracy));
+  BOOST_CHECK(sketch_close(hist.quantile(1.0), itemCount, accuracy));
+
+  std::vector<dnHistogramBucket> buckets;
+  hist.getBuckets(buckets);
+  uint64 total = 0;
+  for(size_t i=0; i < buckets.size(); i++)
+    total += buckets[i].count;
+  BOOST_CHECK(total == hist.count());
+  BOOST_CHECK(buckets[0].upper < 0.0);
+
+  dnLogHistogram part1(accuracy), part2(accuracy);
+  for(int i=1; i <= itemCount; i++)
+    ((i % 2 == 0) ? part1 : part2).add(static_cast<double>(i));
+  part1.merge(part2);
+  BOOST_CHECK(part1.count() == itemCount);
+  BOOST_CHECK(sketch_close(part1.quantile(0.5), itemCount * 0.5, 2.0 * accuracy));
+
+  dnode state;
+  hist.toNode(state);
+  dnLogHistogram restored;
+  restored.fromNode(state);
+  BOOST_CHECK(restored.count() == hist.count());
+  BOOST_CHECK(restored.quantile(0.9) == hist.quantile(0.9));
+
+  BOOST_CHECK_THROW(hist.merge(dnLogHistogram(0.02)), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_sketch_distinct)
+{
+  const int itemCount = 50000;
+  dnDistinctCounter counter;
+  for(int i=0; i < itemCount * 3; i++)
+    counter.add(static_cast<double>(i % itemCount));
+  BOOST_CHECK(sketch_close(counter.estimate(), itemCount, 0.05));
+
+  dnDistinctCounter small;
+  small.add(1.0);
+  small.add(1.0);
+  small.add(-0.0);
+  small.add(0.0);
+  small.add(dnStringRef("abc"));
+  BOOST_CHECK(sketch_close(small.estimate(), 3.0, 0.01));
+
+  dnDistinctCounter texts, otherTexts;
+  for(int i=0; i < itemCount; i++) {
+    dtpString text = "item-" + toString(i);
+    ((i % 2 == 0) ? texts : otherTexts).add(dnStringRef(text));
+  }
+  texts.merge(otherTexts);
+  BOOST_CHECK(sketch_close(texts.estimate(), itemCount, 0.05));
+
+  dnode state;
+  texts.toNode(state);
+  dnDistinctCounter restored(4);
+  restored.fromNode(state);
+  BOOST_CHECK(restored.getPrecision() == texts.getPrecision());
+  BOOST_CHECK(restored.estimate() == texts.estimate());
+
+  BOOST_CHECK_THROW(dnDistinctCounter(3), dnError);
+  BOOST_CHECK_THROW(texts.merge(dnDistinctCounter(10)), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_sketch_input)
+{
+  dnode numbers;
+  numbers.setAsArray(vt_double);
+  for(int i=1; i <= 100; i++)
+    numbers.addItem(static_cast<double>(i));
+
+  dnQuantileSketch sketch;
+  dsketch_add_array(numbers, sketch);
+  BOOST_CHECK(sketch.count() == 100);
+  BOOST_CHECK(sketch.maxValue() == 100.0);
+
+  dnode mixed(ict_list);
+  mixed.addChild(new dnode(1));
+  mixed.addChild(new dnode());
+  mixed.addChild(new dnode("a"));
+  mixed.addChild(new dnode("a"));
+  dnDistinctCounter distinct;
+  dsketch_add_array(mixed, distinct);
+  BOOST_CHECK(sketch_close(distinct.estimate(), 2.0, 0.01));
+
+  BOOST_CHECK_THROW(dsketch_add_array(dnode(1), sketch), dnError);
+
+  std::istringstream csv("id;amount;name\n1; 10.5;a\n2;;b\n3;20;a\n4\n5;30;c\n");
+  dnHistogram hist(0.0, 40.0, 4);
+  dsketch_add_csv_column(csv, 1, dnSplitSeparator(";"), hist, true);
+  BOOST_CHECK(hist.count() == 3);
+  BOOST_CHECK(hist.getBucketValue(1) == 1);
+  BOOST_CHECK(hist.getBucketValue(2) == 1);
+  BOOST_CHECK(hist.getBucketValue(3) == 1);
+
+  std::istringstream csvNames("1;10.5;a\n2;;b\n3;20;a\n");
+  dsketch_add_csv_column(csvNames, 2, dnSplitSeparator(";"), distinct);
+  BOOST_CHECK(sketch_close(distinct.estimate(), 3.0, 0.01));
+}
@@ -0,0 +1,221 @@
+#include <vector>
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_snapshot.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+void build_snapshot_branch(dnode &output, int value)
+{
+  output.setAsParent();
+  output.addChild("value", new dnode(value));
+  output.addChild("double", new dnode(value * 2));
+}
+
+class dnTestSnapshotReaderTask {
+public:
+  dnTestSnapshotReaderTask(dnodeSnapshot &snapshot, boost::atomic<bool> &stop, bool &failed, int &reads):
+    m_snapshot(snapshot), m_stop(stop), m_failed(failed), m_reads(reads) {}
+
+  void operator()() {
+    dnodeSnapshotReader reader(m_snapshot);
+    uint64 lastVersion = 0;
+
+    while (!m_stop.load()) {
+      dnodeSnapshotGuard guard(reader);
+      if (guard->getVersion() < lastVersion)
+        m_failed = true;
+      lastVersion = guard->getVersion();
+
+      // both branches are always published together
+      const dnode &counter = guard->get("counter");
+      const dnode &mirror = guard->get("mirror");
+      int value = counter.get<int>("value");
+      if ((counter.get<int>("double") != value * 2) || (mirror.get<int>("value") != value))
+        m_failed = true;
+      if (guard->get("static").size() != 100)
+        m_failed = true;
+      m_reads++;
+    }
+  }
+private:
+  dnodeSnapshot &m_snapshot;
+  boost::atomic<bool> &m_stop;
+  bool &m_failed;
+  int &m_reads;
+};
+
+BOOST_AUTO_TEST_CASE(test_snapshot_publish)
+{
+  dnodeSnapshot snapshot;
+  dnodeSnapshotReader reader(snapshot);
+
+  BOOST_CHECK(snapshot.getVersion() == 0);
+  BOOST_CHECK(reader.pin().empty());
+  reader.unpin();
+
+  dnodeSnapshotWriter writer(snapshot);
+  BOOST_CHECK_THROW(dnodeSnapshotWriter second(snapshot), dnError);
+
+  dnode *branch = new dnode();
+  build_snapshot_branch(*branch, 1);
+  writer.setBranch("a", branch);
+  writer.setBranch("b", dnode(5));
+  BOOST_CHECK(writer.isModified());
+  BOOST_CHECK(snapshot.getVersion() == 0);
+
+  BOOST_CHECK(writer.publish() == 1);
+  BOOST_CHECK(!writer.isModified());
+
+  {
+    dnodeSnapshotGuard guard(reader);
+    BOOST_CHECK(guard->getVersion() == 1);
+    BOOST_CHECK(guard->size() == 2);
+    BOOST_CHECK(guard->getName(1) == "b");
+    BOOST_CHECK(guard->get("a").get<int>("double") == 2);
+    BOOST_CHECK(guard->get("b").getAs<int>() == 5);
+    BOOST_CHECK(!guard->hasBranch("c"));
+    BOOST_CHECK_THROW(guard->get("c"), dnError);
+
+    dnode all;
+    guard->copyTo(all);
+    BOOST_CHECK(all.size() == 2);
+    BOOST_CHECK(all["a"].get<int>("value") == 1);
+  }
+
+  writer.modify("a").setElement("value", dnode(7));
+  BOOST_CHECK(writer.get("a").get<int>("value") == 7);
+  writer.eraseBranch("b");
+  BOOST_CHECK_THROW(writer.modify("b"), dnError);
+  writer.publish();
+
+  dnodeSnapshotGuard guard(reader);
+  BOOST_CHECK(guard->getVersion() == 2);
+  BOOST_CHECK(guard->size() == 1);
+  BOOST_CHECK(guard->get("a").get<int>("value") == 7);
+}
+
+BOOST_AUTO_TEST_CASE(test_snapshot_sharing)
+{
+  dnodeSnapshot snapshot;
+  dnodeSnapshotReader reader(snapshot);
+  dnodeSnapshotWriter writer(snapshot);
+
+  writer.setBranch("a", dnode(1));
+  writer.setBranch("b", dnode(2));
+  writer.publish();
+
+  dnodeSnapshotVersion::branch_ptr a1, b1;
+  {
+    dnodeSnapshotGuard guard(reader);
+    a1 = guard->getBranchPtr(0);
+    b1 = guard->getBranchPtr(1);
+  }
+
+  writer.modify("a").setAs<int>(10);
+  writer.publish();
+
+  dnodeSnapshotGuard guard(reader);
+  // unchanged branch is shared, modified one is a new copy
+  BOOST_CHECK(guard->getBranchPtr(1) == b1);
+  BOOST_CHECK(guard->getBranchPtr(0) != a1);
+  BOOST_CHECK(a1->getAs<int>() == 1);
+  BOOST_CHECK(guard->at(0).getAs<int>() == 10);
+
+  // discard
+  writer.modify("b").setAs<int>(20);
+  writer.discard();
+  BOOST_CHECK(writer.get("b").getAs<int>() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_snapshot_reclaim)
+{
+  dnodeSnapshot snapshot;
+  dnodeSnapshotReader reader1(snapshot), reader2(snapshot);
+  dnodeSnapshotWriter writer(snapshot);
+
+  writer.setBranch("a", dnode(1));
+  writer.publish();
+  BOOST_CHECK(snapshot.getRetiredCount() == 0);
+
+  const dnodeSnapshotVersion &pinned = reader1.pin();
+  BOOST_CHECK(&reader1.pin() == &pinned);
+
+  for(int i=2; i <= 5; i++) {
+    writer.modify("a").setAs<int>(i);
+    writer.publish();
+  }
+
+  // version 1 is pinned, versions after it are kept too
+  BOOST_CHECK(snapshot.getRetiredCount() == 4);
+  BOOST_CHECK(pinned.getVersion() == 1);
+  BOOST_CHECK(pinned.get("a").getAs<int>() == 1);
+
+  {
+    dnodeSnapshotGuard guard(reader2);
+    BOOST_CHECK(guard->get("a").getAs<int>() == 5);
+  }
+
+  reader1.unpin();
+  BOOST_CHECK(reader1.isPinned());
+  snapshot.reclaim();
+  BOOST_CHECK(snapshot.getRetiredCount() == 4);
+
+  reader1.unpin();
+  BOOST_CHECK(!reader1.isPinned());
+  snapshot.reclaim();
+  BOOST_CHECK(snapshot.getRetiredCount() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_snapshot_concurrent)
+{
+  const int threadCount = 4;
+  dnodeSnapshot snapshot;
+  boost::atomic<bool> stop(false);
+  bool failed[threadCount] = {false, false, false, false};
+  int reads[threadCount] = {0, 0, 0, 0};
+
+  {
+    dnodeSnapshotWriter writer(snapshot);
+    dnode *branch = new dnode();
+    build_snapshot_branch(*branch, 0);
+    writer.setBranch("counter", branch);
+    writer.setBranch("mirror", dnode(ict_parent));
+    writer.modify("mirror").addChild("value", new dnode(0));
+    dnode *data = new dnode(ict_list);
+    for(int i=0; i < 100; i++)
+      data->addChild(new dnode(i));
+    writer.setBranch("static", data);
+    writer.publish();
+
+    boost::thread_group threads;
+    for(int i=0; i < threadCount; i++)
+      threads.create_thread(dnTestSnapshotReaderTask(snapshot, stop, failed[i], reads[i]));
+
+    for(int i=1; i <= 2000; i++) {
+      dnode *next = new dnode();
+      build_snapshot_branch(*next, i);
+      writer.setBranch("counter", next);
+      writer.modify("mirror").setElement("value", dnode(i));
+      writer.publish();
+    }
+
+    stop = true;
+    threads.join_all();
+    BOOST_CHECK(snapshot.getVersion() == 2001);
+  }
+
+  snapshot.reclaim();
+  BOOST_CHECK(snapshot.getRetiredCount() == 0);
+
+  for(int i=0; i < threadCount; i++) {
+    BOOST_CHECK(!failed[i]);
+    BOOST_CHECK(reads[i] > 0);
+  }
+}
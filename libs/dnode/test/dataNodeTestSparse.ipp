@@ -0,0 +1,134 @@
+#include <vector>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_sparse.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+struct sparse_count_visitor {
+  uint count;
+  sparse_count_visitor(): count(0) {}
+  void operator()(double) { count++; }
+};
+
+BOOST_AUTO_TEST_CASE(test_sparse_get_set)
+{
+  dnSparseArray<double> arr(100000, -1.0);
+  BOOST_CHECK(arr.size() == 100000);
+  BOOST_CHECK(arr.get(500) == -1.0);
+  BOOST_CHECK_THROW(arr.get(100000), dnError);
+
+  arr.set(99999, 3.0);
+  arr.set(7, 1.0);
+  arr.set(5000, 2.0);
+  arr.set(6, 0.5);
+  arr.set(5000, 2.5);
+  BOOST_CHECK(arr.nonDefaultCount() == 4);
+  BOOST_CHECK(arr.chunkCount() == 3);
+  BOOST_CHECK(arr.get(6) == 0.5);
+  BOOST_CHECK(arr.get(7) == 1.0);
+  BOOST_CHECK(arr.get(8) == -1.0);
+  BOOST_CHECK(arr.get(5000) == 2.5);
+  BOOST_CHECK(arr.get(99999) == 3.0);
+
+  // setting default removes item
+  arr.set(7, -1.0);
+  arr.reset(5000);
+  arr.reset(5001);
+  BOOST_CHECK(arr.nonDefaultCount() == 2);
+  BOOST_CHECK(arr.chunkCount() == 2);
+  BOOST_CHECK(arr.get(7) == -1.0);
+
+  arr.resize(50000);
+  BOOST_CHECK(arr.nonDefaultCount() == 1);
+  BOOST_CHECK_THROW(arr.set(50000, 1.0), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_sparse_iterate)
+{
+  dnSparseArray<int> arr(20000);
+  for(uint i = 19999; i >= 100; i -= 997)
+    arr.set(i, static_cast<int>(i));
+
+  std::vector<uint> indices;
+  for(dnSparseArray<int>::const_iterator it = arr.begin(), epos = arr.end(); it != epos; ++it) {
+    BOOST_CHECK_EQUAL(it.value(), static_cast<int>(it.index()));
+    indices.push_back(it.index());
+  }
+
+  BOOST_CHECK_EQUAL(indices.size(), arr.nonDefaultCount());
+  for(size_t i=1; i < indices.size(); i++)
+    BOOST_CHECK(indices[i - 1] < indices[i]);
+
+  dnSparseArray<int> empty(10);
+  BOOST_CHECK(empty.begin() == empty.end());
+}
+
+BOOST_AUTO_TEST_CASE(test_sparse_reduce)
+{
+  dnSparseArray<double> arr(1000, 1.0);
+  arr.set(10, 5.0);
+  arr.set(900, -3.0);
+
+  BOOST_CHECK_EQUAL(arr.sum(0.0), 998.0 + 5.0 - 3.0);
+  BOOST_CHECK_EQUAL(arr.mean(), 1.0);
+  BOOST_CHECK_EQUAL(arr.minValue(), -3.0);
+  BOOST_CHECK_EQUAL(arr.maxValue(), 5.0);
+  BOOST_CHECK_EQUAL(arr.visitValues(sparse_count_visitor()).count, 2U);
+
+  // all items set - default not included
+  dnSparseArray<double> full(2, 0.0);
+  full.set(0, 4.0);
+  full.set(1, 6.0);
+  BOOST_CHECK_EQUAL(full.minValue(), 4.0);
+  BOOST_CHECK_EQUAL(full.maxValue(), 6.0);
+
+  dnSparseArray<double> empty;
+  BOOST_CHECK_EQUAL(empty.sum(0.0), 0.0);
+  BOOST_CHECK_EQUAL(empty.mean(), 0.0);
+  BOOST_CHECK_EQUAL(empty.minValue(), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_sparse_convert)
+{
+  dnode dense(ict_array, vt_double);
+  for(int i=0; i < 50000; i++)
+    dense.addItem((i % 1000 == 0) ? static_cast<double>(i) : 0.0);
+
+  dnSparseArray<double> arr;
+  arr.fromArray(dense);
+  BOOST_CHECK(arr.size() == 50000);
+  BOOST_CHECK(arr.nonDefaultCount() == 49);
+  BOOST_CHECK(arr.get(3000) == 3000.0);
+  BOOST_CHECK(arr.memoryUsed() * 10 < 50000 * sizeof(double));
+
+  dnode back;
+  arr.toArray(back);
+  BOOST_CHECK(back.isArray());
+  BOOST_CHECK(back.size() == 50000);
+  BOOST_CHECK_EQUAL(back.get<double>(3000), 3000.0);
+  BOOST_CHECK_EQUAL(back.get<double>(3001), 0.0);
+
+  // list of values converted item by item
+  dnode list(ict_list);
+  list.addChild(new dnode(2));
+  list.addChild(new dnode(0));
+  list.addChild(new dnode(dtpString("7")));
+  dnSparseArray<int> fromList;
+  fromList.fromArray(list);
+  BOOST_CHECK(fromList.nonDefaultCount() == 2);
+  BOOST_CHECK_EQUAL(fromList.get(2), 7);
+
+  // stored as node
+  dnode stored;
+  arr.toNode(stored);
+  dnSparseArray<double> restored;
+  restored.fromNode(stored);
+  BOOST_CHECK(restored.size() == arr.size());
+  BOOST_CHECK(restored.nonDefaultCount() == arr.nonDefaultCount());
+  BOOST_CHECK_EQUAL(restored.sum(0.0), arr.sum(0.0));
+}
@@ -0,0 +1,211 @@
+#include <cmath>
+#include <vector>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_stats.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+bool stats_close(double value, double expected, double tolerance = 1e-9)
+{
+  return std::fabs(value - expected) <= tolerance * std::max(1.0, std::fabs(expected));
+}
+
+void build_stats_table(dnode &output, int rowCount)
+{
+  output = dnode(ict_list);
+  for(int i=0; i < rowCount; i++) {
+    dnode *row = new dnode(ict_parent);
+    row->addChild("x", new dnode(i));
+    row->addChild("y", new dnode(2.0 * i + 1.0));
+    if (i % 10 != 0)
+      row->addChild("z", new dnode(static_cast<double>(i % 7)));
+    output.addChild(row);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_stats_accumulator)
+{
+  dnStatsAccumulator stats;
+  BOOST_CHECK(stats.empty());
+  BOOST_CHECK(stats.variance() == 0.0);
+
+  double values[] = {2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0};
+  stats.add(values, values + 8);
+
+  BOOST_CHECK(stats.count() == 8);
+  BOOST_CHECK(stats_close(stats.sum(), 40.0));
+  BOOST_CHECK(stats_close(stats.mean(), 5.0));
+  BOOST_CHECK(stats_close(stats.variance(), 4.0));
+  BOOST_CHECK(stats_close(stats.stdDev(), 2.0));
+  BOOST_CHECK(stats_close(stats.sampleVariance(), 32.0 / 7.0));
+  BOOST_CHECK(stats.minValue() == 2.0);
+  BOOST_CHECK(stats.maxValue() == 9.0);
+  // sum of cubed deviations = 42
+  BOOST_CHECK(stats_close(stats.skewness(), (42.0 / 8.0) / 8.0));
+
+  // symmetric series
+  dnStatsAccumulator symmetric;
+  double symValues[] = {-3.0, -1.0, 0.0, 1.0, 3.0};
+  symmetric.add(symValues, symValues + 5);
+  BOOST_CHECK(stats_close(symmetric.skewness(), 0.0));
+
+  // large offset does not destroy precision
+  dnStatsAccumulator offset;
+  for(int i=0; i < 1000; i++)
+    offset.add(1e9 + (i % 2));
+  BOOST_CHECK(stats_close(offset.variance(), 0.25, 1e-6));
+
+  // compensated sum
+  dnStatsAccumulator smallSum;
+  smallSum.add(1.0);
+  for(int i=0; i < 10000; i++)
+    smallSum.add(1e-16);
+  BOOST_CHECK(smallSum.sum() > 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_stats_merge)
+{
+  dnStatsAccumulator all, part1, part2, empty;
+  for(int i=0; i < 1000; i++) {
+    double value = std::sin(static_cast<double>(i)) * 100.0 + i * 0.5;
+    all.add(value);
+    if (i < 300)
+      part1.add(value);
+    else
+      part2.add(value);
+  }
+
+  part1.merge(empty);
+  part1.merge(part2);
+  BOOST_CHECK(part1.count() == all.count());
+  BOOST_CHECK(stats_close(part1.mean(), all.mean()));
+  BOOST_CHECK(stats_close(part1.variance(), all.variance()));
+  BOOST_CHECK(stats_close(part1.skewness(), all.skewness(), 1e-7));
+  BOOST_CHECK(stats_close(part1.sum(), all.sum()));
+  BOOST_CHECK(part1.minValue() == all.minValue());
+  BOOST_CHECK(part1.maxValue() == all.maxValue());
+
+  empty.merge(all);
+  BOOST_CHECK(stats_close(empty.variance(), all.variance()));
+
+  // state stored as node
+  dnode state;
+  all.toNode(state);
+  dnStatsAccumulator restored;
+  restored.fromNode(state);
+  BOOST_CHECK(restored.count() == all.count());
+  BOOST_CHECK(restored.variance() == all.variance());
+  BOOST_CHECK(restored.sum() == all.sum());
+}
+
+BOOST_AUTO_TEST_CASE(test_stats_array)
+{
+  dnode arr(ict_array, vt_int);
+  for(int i=1; i <= 100; i++)
+    arr.addItem(i);
+
+  dnStatsAccumulator stats;
+  dstat_array(arr, stats);
+  BOOST_CHECK(stats.count() == 100);
+  BOOST_CHECK(stats_close(stats.mean(), 50.5));
+  BOOST_CHECK(stats_close(stats.variance(), (100.0 * 100.0 - 1.0) / 12.0));
+
+  // arrays of nodes & lists, nulls are skipped
+  dnode list(ict_list);
+  list.addChild(new dnode(1.5));
+  list.addChild(new dnode());
+  list.addChild(new dnode(dtpString("2.5")));
+  dnStatsAccumulator listStats;
+  dstat_array(list, listStats);
+  BOOST_CHECK(listStats.count() == 2);
+  BOOST_CHECK(stats_close(listStats.mean(), 2.0));
+
+  dnode int64Arr(ict_array, vt_int64);
+  int64Arr.addItem(static_cast<int64>(3));
+  int64Arr.addItem(static_cast<int64>(5));
+  dnStatsAccumulator int64Stats;
+  dstat_array(int64Arr, int64Stats);
+  BOOST_CHECK(stats_close(int64Stats.mean(), 4.0));
+
+  BOOST_CHECK_THROW(dstat_array(dnode(5), stats), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_stats_column)
+{
+  dnode table;
+  build_stats_table(table, 50);
+
+  dnStatsAccumulator stats;
+  dstat_column(table, "x", stats);
+  BOOST_CHECK(stats.count() == 50);
+  BOOST_CHECK(stats_close(stats.mean(), 24.5));
+
+  // missing fields are skipped
+  dnStatsAccumulator partial;
+  dstat_column(table, "z", partial);
+  BOOST_CHECK(partial.count() == 45);
+
+  // y = 2x + 1
+  dnCovarianceAccumulator cov;
+  dstat_covariance_columns(table, "x", "y", cov);
+  BOOST_CHECK(cov.count() == 50);
+  BOOST_CHECK(stats_close(cov.covariance(), 2.0 * stats.variance()));
+  BOOST_CHECK(stats_close(cov.correlation(), 1.0));
+  BOOST_CHECK(stats_close(cov.meanY(), 2.0 * 24.5 + 1.0));
+
+  dnode xs(ict_array, vt_double), ys(ict_array, vt_double);
+  for(int i=0; i < 20; i++) {
+    xs.addItem(static_cast<double>(i));
+    ys.addItem(static_cast<double>(-i));
+  }
+  dnCovarianceAccumulator negCov;
+  dstat_covariance(xs, ys, negCov);
+  BOOST_CHECK(stats_close(negCov.correlation(), -1.0));
+  BOOST_CHECK(stats_close(negCov.sampleCovariance(), -35.0));
+
+  ys.addItem(1.0);
+  BOOST_CHECK_THROW(dstat_covariance(xs, ys, negCov), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_stats_parallel)
+{
+  dnThreadPool pool(3);
+  dnParallelOptions options;
+  options.minParallelItems = 16;
+  options.pool = &pool;
+
+  dnode arr(ict_array, vt_double);
+  for(int i=0; i < 10000; i++)
+    arr.addItem(std::cos(static_cast<double>(i)) * 1000.0);
+
+  dnStatsAccumulator seqStats, parStats;
+  dstat_array(arr, seqStats);
+  dpar_stat_array(arr, parStats, options);
+  BOOST_CHECK(parStats.count() == seqStats.count());
+  BOOST_CHECK(stats_close(parStats.mean(), seqStats.mean()));
+  BOOST_CHECK(stats_close(parStats.variance(), seqStats.variance()));
+  BOOST_CHECK(stats_close(parStats.skewness(), seqStats.skewness(), 1e-7));
+
+  dnode table;
+  build_stats_table(table, 1000);
+  dnStatsAccumulator seqCol, parCol;
+  dstat_column(table, "z", seqCol);
+  dpar_stat_column(table, "z", parCol, options);
+  BOOST_CHECK(parCol.count() == seqCol.count());
+  BOOST_CHECK(stats_close(parCol.variance(), seqCol.variance()));
+
+  dnCovarianceAccumulator seqCov, parCov;
+  dstat_covariance_columns(table, "x", "z", seqCov);
+  dpar_stat_covariance_columns(table, "x", "z", parCov, options);
+  BOOST_CHECK(parCov.count() == seqCov.count());
+  BOOST_CHECK(stats_close(parCov.covariance(), seqCov.covariance()));
+
+  dnCovarianceAccumulator parArrCov;
+  dpar_stat_covariance(arr, arr, parArrCov, options);
+  BOOST_CHECK(stats_close(parArrCov.correlation(), 1.0));
+}
@@ -0,0 +1,140 @@
+#include <sstream>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_string_pool.h"
+#include "dtp/dnode_bion.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+BOOST_AUTO_TEST_CASE(test_string_pool_get_set)
+{
+  dnStringPool pool;
+  BOOST_CHECK(pool.empty());
+
+  pool.push_back("alpha");
+  pool.push_back("");
+  pool.push_back("gamma");
+  BOOST_CHECK(pool.size() == 3);
+  BOOST_CHECK(pool.dataSize() == 13);
+  BOOST_CHECK(pool.get(0) == dnStringRef("alpha"));
+  BOOST_CHECK(pool.length(1) == 0);
+  BOOST_CHECK(strcmp(pool.c_str(2), "gamma") == 0);
+  BOOST_CHECK_THROW(pool.get(3), dnError);
+
+  // same length - in place, other lengths move following items
+  pool.set(0, "ALPHA");
+  pool.set(1, "beta");
+  pool.set(2, "g");
+  BOOST_CHECK(pool.getString(0) == "ALPHA");
+  BOOST_CHECK(pool.getString(1) == "beta");
+  BOOST_CHECK(pool.getString(2) == "g");
+
+  // value taken from the pool itself
+  pool.push_back(pool.get(1));
+  pool.set(0, pool.get(3));
+  BOOST_CHECK(pool.getString(0) == "beta");
+  BOOST_CHECK(pool.getString(3) == "beta");
+
+  pool.pop_back();
+  pool.resize(5);
+  BOOST_CHECK(pool.size() == 5);
+  BOOST_CHECK(pool.length(4) == 0);
+  pool.resize(1);
+  BOOST_CHECK(pool.dataSize() == 5);
+}
+
+BOOST_AUTO_TEST_CASE(test_string_pool_find_sort)
+{
+  dnStringPool pool;
+  pool.push_back("pear");
+  pool.push_back("apple");
+  pool.push_back("app");
+  pool.push_back("plum");
+  pool.push_back("apple");
+
+  BOOST_CHECK(pool.find("apple") == 1);
+  BOOST_CHECK(pool.find("apple", 2) == 4);
+  BOOST_CHECK(pool.find("ap") == dnode::npos);
+
+  pool.sort();
+  BOOST_CHECK(pool.getString(0) == "app");
+  BOOST_CHECK(pool.getString(1) == "apple");
+  BOOST_CHECK(pool.getString(2) == "apple");
+  BOOST_CHECK(pool.getString(3) == "pear");
+  BOOST_CHECK(pool.getString(4) == "plum");
+  BOOST_CHECK(pool.dataSize() == 26);
+}
+
+BOOST_AUTO_TEST_CASE(test_string_pool_text)
+{
+  dnStringPool pool;
+  dtpString line;
+
+  pool.explode("1,22,,333", ",");
+  BOOST_CHECK(pool.size() == 4);
+  BOOST_CHECK(pool.getString(3) == "333");
+  BOOST_CHECK(pool.implode("; ", line) == "1; 22; ; 333");
+
+  pool.clear();
+  pool.push_back("a,b");
+  pool.push_back("say \"hi\"");
+  pool.push_back("");
+  pool.push_back("x");
+  BOOST_CHECK(pool.writeCsvLine(line) == "\"a,b\",\"say \"\"hi\"\"\",,x");
+
+  dnStringPool parsed;
+  parsed.readCsvLine(line);
+  BOOST_CHECK(parsed.size() == 4);
+  for(dnStringPool::size_type i = 0; i < pool.size(); i++)
+    BOOST_CHECK(parsed.get(i) == pool.get(i));
+
+  parsed.readCsvLine("a;b;", ';');
+  BOOST_CHECK(parsed.size() == 3);
+  BOOST_CHECK(parsed.length(2) == 0);
+  BOOST_CHECK_THROW(parsed.readCsvLine("\"abc"), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_string_pool_array_bion)
+{
+  dnode source(ict_array, vt_string);
+  source.addItem(dtpString("one"));
+  source.addItem(dtpString("two"));
+  source.addItem(dtpString("three"));
+
+  dnStringPool pool;
+  pool.fromArray(source);
+  BOOST_CHECK(pool.size() == 3);
+  BOOST_CHECK(pool.getString(2) == "three");
+
+  dnode output;
+  pool.toArray(output);
+  BOOST_CHECK(output.isArray());
+  BOOST_CHECK(output.getElementType() == vt_string);
+  BOOST_CHECK(output == source);
+
+  // pool is written in the same format as vt_string array
+  std::stringstream s;
+  dnBionWriter<std::stringstream> writer(s);
+  writer.write(pool);
+
+  s.seekg(0, std::ios::beg);
+  dnode node;
+  dnBionProcessor proc(node);
+  BionReader<std::stringstream, dnBionProcessor> reader(s, proc);
+  reader.process();
+  BOOST_CHECK(node == source);
+
+  s.clear();
+  s.seekg(0, std::ios::beg);
+  dnStringPool loaded;
+  dnBionStringPoolProcessor poolProc(loaded);
+  BionReader<std::stringstream, dnBionStringPoolProcessor> poolReader(s, poolProc);
+  poolReader.process();
+  BOOST_CHECK(loaded.size() == 3);
+  BOOST_CHECK(loaded.getString(0) == "one");
+  BOOST_CHECK(loaded.getString(2) == "three");
+}
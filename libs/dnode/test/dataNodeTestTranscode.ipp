@@ -0,0 +1,182 @@
+#include <sstream>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_bion.h"
+#include "dtp/dnode_transcode.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+const char *TRANSCODE_SAMPLE_JSON =
+  "{\"name\":\"alpha\",\"count\":12,\"big\":12345678901,\"ratio\":0.5,\"flag\":true,\"none\":null,"
+  "\"items\":[1,2,3],\"nested\":[{\"id\":1},{\"id\":2,\"tags\":[\"a\",\"b\"]}],\"empty\":[]}";
+
+void read_bion_to_node(std::stringstream &input, dnode &output)
+{
+  input.seekg(0, std::ios::beg);
+  dnBionProcessor proc(output);
+  BionReader<std::stringstream, dnBionProcessor> reader(input, proc);
+  reader.process();
+}
+
+BOOST_AUTO_TEST_CASE(test_transcode_json_to_bion)
+{
+  std::stringstream input(TRANSCODE_SAMPLE_JSON);
+  std::stringstream bion;
+
+  dtc_json_to_bion(input, bion);
+
+  dnode node;
+  read_bion_to_node(bion, node);
+
+  BOOST_CHECK(node.isParent());
+  BOOST_CHECK(node.size() == 9);
+  BOOST_CHECK(node.get<dtpString>("name") == "alpha");
+  BOOST_CHECK(node.get<int>("count") == 12);
+  BOOST_CHECK(node.get<int64>("big") == 12345678901LL);
+  BOOST_CHECK(node.get<double>("ratio") == 0.5);
+  BOOST_CHECK(node.get<bool>("flag"));
+  BOOST_CHECK(node.getElement("none").isNull());
+  BOOST_CHECK(node.getElement("items").size() == 3);
+  BOOST_CHECK(node.getElement("items").get<int>(2) == 3);
+  BOOST_CHECK(node.getElement("nested").size() == 2);
+  BOOST_CHECK(node.getElement("nested").getElement(1).getElement("tags").get<dtpString>(1) == "b");
+  BOOST_CHECK(node.getElement("empty").size() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_transcode_bion_to_json)
+{
+  dnode source(ict_parent);
+  source.addChild("id", new dnode(7));
+  source.addChild("label", new dnode(dtpString("seven")));
+  dnode *values = new dnode(ict_array, vt_int);
+  for(int i=0; i < 5; i++)
+    values->addItem(i * 10);
+  source.addChild("values", values);
+  dnode *list = new dnode(ict_list);
+  list->addChild(new dnode(1.5));
+  list->addChild(new dnode(dtpString("x")));
+  source.addChild("mixed", list);
+
+  std::stringstream bion;
+  dnBionWriter<std::stringstream> writer(bion);
+  writer.write(source);
+
+  bion.seekg(0, std::ios::beg);
+  std::stringstream json;
+  dtc_bion_to_json(bion, json);
+
+  BOOST_TEST_MESSAGE("json: " << json.str());
+  BOOST_CHECK(json.str() == "{\"id\":7,\"label\":\"seven\",\"values\":[0,10,20,30,40],\"mixed\":[1.5,\"x\"]}");
+
+  // and back
+  std::stringstream bion2;
+  dtc_json_to_bion(json, bion2);
+  dnode node;
+  read_bion_to_node(bion2, node);
+  BOOST_CHECK(node.get<dtpString>("label") == "seven");
+  BOOST_CHECK(node.getElement("values").get<int>(4) == 40);
+  BOOST_CHECK(node.getElement("mixed").get<dtpString>(1) == "x");
+}
+
+BOOST_AUTO_TEST_CASE(test_transcode_json_to_structure)
+{
+  YawlWriter writer(false, "");
+  dnStructureOutputJson output(writer.getContext());
+  std::stringstream input(TRANSCODE_SAMPLE_JSON);
+
+  dtc_json_to_structure(input, output);
+
+  dtpString text;
+  writer.outputToString(text);
+  BOOST_CHECK(text == TRANSCODE_SAMPLE_JSON);
+}
+
+BOOST_AUTO_TEST_CASE(test_transcode_chunked)
+{
+  YawlWriter writer(false, "");
+  dnStructureOutputJson output(writer.getContext());
+  dnJsonStructureReader reader(output);
+  std::stringstream input(TRANSCODE_SAMPLE_JSON);
+
+  // small buffer - tokens are split between chunks
+  reader.read(input, 7);
+
+  dtpString text;
+  writer.outputToString(text);
+  BOOST_CHECK(text == TRANSCODE_SAMPLE_JSON);
+}
+
+BOOST_AUTO_TEST_CASE(test_transcode_invalid_json)
+{
+  std::stringstream input("{\"a\": [1, 2}");
+  std::stringstream bion;
+  BOOST_CHECK_THROW(dtc_json_to_bion(input, bion), std::runtime_error);
+}
+
+const char *TRANSCODE_SAMPLE_ROWS_JSON =
+  "[{\"id\":1,\"name\":\"a, b\",\"note\":\"say \\\"hi\\\"\"},"
+  "{\"id\":2,\"name\":\"line\\nbreak\",\"note\":null},"
+  "{\"name\":\"c\",\"id\":3.5}]";
+
+const char *TRANSCODE_SAMPLE_CSV =
+  "id,name,note\n"
+  "1,\"a, b\",\"say \"\"hi\"\"\"\n"
+  "2,\"line\nbreak\",\n"
+  "3.5,c,\n";
+
+BOOST_AUTO_TEST_CASE(test_transcode_json_to_csv)
+{
+  std::stringstream input(TRANSCODE_SAMPLE_ROWS_JSON);
+  std::stringstream csv;
+
+  dtc_json_to_csv(input, csv);
+
+  BOOST_TEST_MESSAGE("csv: " << csv.str());
+  BOOST_CHECK(csv.str() == TRANSCODE_SAMPLE_CSV);
+}
+
+BOOST_AUTO_TEST_CASE(test_transcode_csv_round_trip)
+{
+  std::stringstream csv(TRANSCODE_SAMPLE_CSV);
+  std::stringstream json;
+
+  dtc_csv_to_json(csv, json);
+
+  // CSV has no value types - all values are read back as strings
+  BOOST_TEST_MESSAGE("json: " << json.str());
+  BOOST_CHECK(json.str() ==
+    "[{\"id\":\"1\",\"name\":\"a, b\",\"note\":\"say \\\"hi\\\"\"},"
+    "{\"id\":\"2\",\"name\":\"line\\nbreak\",\"note\":\"\"},"
+    "{\"id\":\"3.5\",\"name\":\"c\",\"note\":\"\"}]");
+
+  std::stringstream csv2;
+  dtc_json_to_csv(json, csv2);
+  BOOST_CHECK(csv2.str() == TRANSCODE_SAMPLE_CSV);
+
+  // CRLF line ends, empty line, missing trailing field, custom separator
+  std::stringstream input("a;b\r\n1;x y\r\n\r\n2\r\n");
+  std::stringstream json2;
+  dtc_csv_to_json(input, json2, false, ';');
+  BOOST_CHECK(json2.str() == "[{\"a\":\"1\",\"b\":\"x y\"},{\"a\":\"2\",\"b\":\"\"}]");
+}
+
+BOOST_AUTO_TEST_CASE(test_transcode_csv_invalid)
+{
+  std::stringstream output;
+
+  std::stringstream notList("{\"a\":1}");
+  BOOST_CHECK_THROW(dtc_json_to_csv(notList, output), dnError);
+  std::stringstream nested("[{\"a\":[1,2]}]");
+  BOOST_CHECK_THROW(dtc_json_to_csv(nested, output), dnError);
+  std::stringstream unknownKey("[{\"a\":1},{\"b\":2}]");
+  BOOST_CHECK_THROW(dtc_json_to_csv(unknownKey, output), dnError);
+
+  std::stringstream tooManyFields("a\n1,2\n");
+  BOOST_CHECK_THROW(dtc_csv_to_json(tooManyFields, output), dnError);
+  std::stringstream unterminated("a\n\"x\n");
+  BOOST_CHECK_THROW(dtc_csv_to_json(unterminated, output), dnError);
+}
@@ -1,9 +1,11 @@
 #include <vector>
+#include <limits>
 #include "base/btypes.h"
 #include "base/algorithm.h"
 #include "base/utils.h"
 #include "dtp/dnode_cast.h"
 #include "dtp/dnode_algorithm.h"
+#include "dtp/dnode_split.h"
 
 using namespace base;
 using namespace dtp;
@@ -105,6 +107,73 @@ BOOST_AUTO_TEST_CASE(node_utils)
   BOOST_CHECK(node2.size() == 4);
 }
 
+BOOST_AUTO_TEST_CASE(node_split)
+{
+  // multi-character separator
+  dnode node = dnode::explode("-x-", "First-x-Second-x-Third");
+  BOOST_CHECK(node.size() == 3);
+  BOOST_CHECK(node.get<dtpString>(1) == "Second");
+
+  // string refs
+  std::vector<dnStringRef> fields;
+  dstr_split("a::bb::::c", "::", fields);
+  BOOST_CHECK(fields.size() == 4);
+  BOOST_CHECK(fields[1] == dnStringRef("bb"));
+  BOOST_CHECK(fields[2].empty());
+  BOOST_CHECK(dstr_count_fields("", ",") == 0);
+  BOOST_CHECK(dstr_count_fields("a,", ",") == 2);
+
+  // set of separators
+  dstr_explode("red;green, blue", dnSplitSeparator::anyOf(";,"), node);
+  BOOST_CHECK(node.isArray());
+  BOOST_CHECK(node.size() == 3);
+  BOOST_CHECK(node.get<dtpString>(2) == " blue");
+
+  // typed output, reused
+  dstr_explode("1, -2,30,,2147483647", ",", node, vt_int);
+  BOOST_CHECK(node.getElementType() == vt_int);
+  BOOST_CHECK(node.size() == 5);
+  BOOST_CHECK(node.get<int>(1) == -2);
+  BOOST_CHECK(node.get<int>(3) == 0);
+  BOOST_CHECK(node.get<int>(4) == 2147483647);
+  dstr_explode("7,8", ",", node, vt_int);
+  BOOST_CHECK(node.size() == 2);
+  BOOST_CHECK(node.accumulate<int>(0) == 15);
+
+  dstr_explode("0.5|1.25|-2e3", "|", node, vt_double);
+  BOOST_CHECK(node.get<double>(2) == -2000.0);
+
+  BOOST_CHECK_THROW(dstr_explode("1,x", ",", node, vt_int), dnError);
+  BOOST_CHECK_THROW(dstr_explode("-1", ",", node, vt_uint), dnError);
+  BOOST_CHECK_THROW(dstr_explode("2147483648", ",", node, vt_int), dnError);
+  BOOST_CHECK_THROW(dstr_explode("1.5z", ",", node, vt_double), dnError);
+
+  // implode
+  dtpString text;
+  dstr_explode("3,4,5", ",", node, vt_int);
+  BOOST_CHECK(dstr_implode(node, "##", text) == "3##4##5");
+  BOOST_CHECK(dstr_implode(node, "##", text) == node.implode("##"));
+  dstr_explode("x,y", ",", node);
+  BOOST_CHECK(dstr_implode(node, ", ", text) == "x, y");
+  BOOST_CHECK(dstr_implode(fields.begin(), fields.end(), "/", text) == "a/bb//c");
+
+  // doubles: fractions & large magnitudes are neither truncated nor skipped
+  dnode doubles(ict_array, vt_double);
+  doubles.addItem(0.1);
+  doubles.addItem(-1.5e300);
+  doubles.addItem(123456789.125);
+  doubles.addItem(1e-9);
+  doubles.addItem(-std::numeric_limits<double>::max());
+  dstr_implode(doubles, ";", text);
+  dstr_explode(text, ";", node, vt_double);
+  BOOST_CHECK(node.size() == 5);
+  for(dnode::size_type i=0; i < doubles.size(); i++)
+    BOOST_CHECK(node.get<double>(i) == doubles.get<double>(i));
+
+  dstr_explode("-2147483648,2147483647", ",", node, vt_int);
+  BOOST_CHECK(dstr_implode(node, ",", text) == "-2147483648,2147483647");
+}
+
 BOOST_AUTO_TEST_CASE(test_valgs)
 {
   dnode vector(ict_array, vt_double);
@@ -231,4 +300,131 @@ BOOST_AUTO_TEST_CASE(test_init)
   BOOST_CHECK(str.length() > 0);
   init(str);
   BOOST_CHECK(str.length() == 0);
-}
\ No newline at end of file
+}
+BOOST_AUTO_TEST_CASE(test_memory_usage)
+{
+  dnode scalar(12);
+  dnMemoryUsage scalarUsage = scalar.memoryUsage();
+  BOOST_CHECK(scalarUsage.nodeCount == 1);
+  BOOST_CHECK(scalarUsage.nodeHeaders == sizeof(dnode));
+  BOOST_CHECK(scalarUsage.strings == 0);
+
+  dnode text(dtpString("This is a long text which will not fit in short string buffer"));
+  BOOST_CHECK(text.memoryUsage().strings > sizeof(dtpString));
+
+  dnode parent(ict_parent);
+  for(int i=0; i < 10; i++)
+    parent.addChild("item"+toString(i), i);
+
+  dnMemoryUsage parentUsage = parent.memoryUsage();
+  BOOST_CHECK(parentUsage.nodeCount == 11);
+  BOOST_CHECK(parentUsage.nodeHeaders == 11 * sizeof(dnode));
+  BOOST_CHECK(parentUsage.childMaps > 0);
+  BOOST_CHECK(parentUsage.nameVectors >= 10 * sizeof(dtpString));
+
+  dnode list(ict_list);
+  for(int i=0; i < 10; i++)
+    list.addChild(i);
+
+  dnMemoryUsage listUsage = list.memoryUsage();
+  BOOST_CHECK(listUsage.nodeCount == 11);
+  BOOST_CHECK(listUsage.nameVectors == 0);
+  BOOST_CHECK(listUsage.childMaps < parentUsage.childMaps);
+
+  dnode arr(ict_array, vt_double);
+  for(int i=0; i < 100; i++)
+    arr.addItemAsDouble(static_cast<double>(i));
+
+  dnMemoryUsage arrUsage = arr.memoryUsage();
+  BOOST_CHECK(arrUsage.nodeCount == 1);
+  BOOST_CHECK(arrUsage.arrays >= 100 * sizeof(double));
+
+  // nested containers are included in parent usage
+  parent.addChild("array", arr);
+  dnMemoryUsage nestedUsage = parent.memoryUsage();
+  BOOST_CHECK(nestedUsage.nodeCount == 12);
+  BOOST_CHECK(nestedUsage.arrays >= 100 * sizeof(double));
+  BOOST_CHECK(nestedUsage.total() > parentUsage.total());
+
+  // live bridges (iterators) of other nodes do not change usage of a tree
+  {
+    dnode::const_iterator it = list.begin();
+    BOOST_CHECK(it != list.end());
+    BOOST_CHECK(parent.memoryUsage().total() == nestedUsage.total());
+    if (dnMemoryStats::enabled())
+      BOOST_CHECK(dnMemoryStats::liveBridgeCount() >= 1);
+  }
+
+  dnode stats;
+  dnMemoryStats::getStats(stats);
+  if (dnMemoryStats::enabled()) {
+    BOOST_CHECK(stats.hasChild("dnChildColnDblMap"));
+    BOOST_CHECK(stats.hasChild("dnChildColnList"));
+    BOOST_CHECK(stats.hasChild("dnArrayOfPod<double>"));
+    BOOST_CHECK(stats["dnChildColnList"].getElement("count").getAs<uint64>() >= 1);
+  } else {
+    BOOST_CHECK(stats.empty());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_perf_counters)
+{
+  dnPerfStats::reset();
+  dnPerfCounters counters = dnPerfStats::snapshot();
+  BOOST_CHECK(counters.typeConversions == 0);
+  BOOST_CHECK(counters.deepCopies == 0);
+
+  dnode list(ict_list);
+  for(int i=0; i < 10; i++)
+    list.addChild(i);
+
+  dtpString text = list.getElement(0).getAs<dtpString>();
+  dnode listCopy(list);
+  dnode textNode(text);
+
+  try {
+    textNode.getElement("missing"); // not a container
+  } catch(dnError &) {
+  }
+
+  int sum = 0;
+  for(dnode::const_iterator it = list.begin(), epos = list.end(); it != epos; ++it)
+    sum += it->getAs<int>();
+  BOOST_CHECK(sum == 45);
+
+  counters = dnPerfStats::snapshot();
+  if (dnPerfStats::enabled()) {
+    BOOST_CHECK(counters.typeConversions >= 1);
+    BOOST_CHECK(counters.deepCopies >= 1);
+    BOOST_CHECK(counters.stringAllocs >= 1);
+    BOOST_CHECK(counters.exceptionsThrown >= 1);
+    BOOST_CHECK(counters.bridgeAllocs >= 2);
+    BOOST_TEST_MESSAGE(dnPerfStats::toString(counters));
+  } else {
+    BOOST_CHECK(counters.typeConversions == 0);
+  }
+
+  dnPerfStats::reset();
+  BOOST_CHECK(dnPerfStats::snapshot().deepCopies == 0);
+
+  // one read between different types is one conversion
+  dnode intNode(12);
+  BOOST_CHECK(intNode.getAs<dtpString>() == "12");
+  BOOST_CHECK(intNode.getAs<int>() == 12);
+  counters = dnPerfStats::snapshot();
+  if (dnPerfStats::enabled()) {
+    BOOST_CHECK(counters.typeConversions == 1);
+  }
+
+  // released bridge slot is reused by next iterator on the same thread
+  for(int i=0; i < 2; i++) {
+    dnode::const_iterator it = list.begin();
+    BOOST_CHECK(it->getAs<int>() == 0);
+  }
+  counters = dnPerfStats::snapshot();
+  if (dnPerfStats::enabled()) {
+    BOOST_CHECK(counters.poolHits >= 1);
+  } else {
+    BOOST_CHECK(counters.poolHits == 0);
+  }
+}
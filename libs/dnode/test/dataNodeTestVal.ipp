@@ -175,3 +175,47 @@ BOOST_AUTO_TEST_CASE(test_stl_iterator)
 
   BOOST_CHECK(*test.scalarBegin<int>() == 2);
 }
+
+BOOST_AUTO_TEST_CASE(test_value_conversion)
+{
+  dnValue val;
+
+  // numeric widening & narrowing
+  val.setAs<int>(-7);
+  val.convertTo(vt_int64);
+  BOOST_CHECK(val.getValueType() == vt_int64);
+  BOOST_CHECK(val.getAs<int64>() == -7);
+  val.convertTo(vt_double);
+  BOOST_CHECK(val.getAs<double>() == -7.0);
+  val.setAs<double>(3.75);
+  val.convertTo(vt_int);
+  BOOST_CHECK(val.getAs<int>() == 3);
+  val.convertTo(vt_bool);
+  BOOST_CHECK(val.getAs<bool>());
+
+  // to & from string
+  val.setAs<uint>(42);
+  val.convertTo(vt_string);
+  BOOST_CHECK(val.getValueType() == vt_string);
+  BOOST_CHECK(val.getAs<dtpString>() == "42");
+  val.convertTo(vt_float);
+  BOOST_CHECK(val.getAs<float>() == 42.0f);
+
+  // not a value type
+  BOOST_CHECK_THROW(val.convertTo(vt_parent), std::runtime_error);
+  BOOST_CHECK_THROW(val.convertTo(static_cast<dnValueType>(vt_last + 1)), std::runtime_error);
+
+  // equality uses storage or value depending on type
+  dnValue s1, s2, src;
+  s1.setAs<dtpString>("abc");
+  s2.setAs<dtpString>("abc");
+  BOOST_CHECK(s1 == s2);
+  s2.setAs<dtpString>("abd");
+  BOOST_CHECK(!(s1 == s2));
+  src.setAs<int>(5);
+  val.setAs<int>(5);
+  BOOST_CHECK(val == src);
+  BOOST_CHECK(val.isEqualTo(src));
+  src.setAs<dtpString>("5");
+  BOOST_CHECK(val.isEqualTo(src));
+}
@@ -0,0 +1,178 @@
+#include <vector>
+#include <cstring>
+#include "base/btypes.h"
+#include "dtp/dnode.h"
+#include "dtp/dnode_view.h"
+#include "dtp/dnode_parallel.h"
+
+using namespace dtp;
+
+// Functions that can be used:
+//   BOOST_TEST_MESSAGE("balance-0: " << toString(balance));
+//   BOOST_CHECK(balance == dec::decimal2(0));
+
+void build_view_sample(dnode &output)
+{
+  output.setAsParent();
+  output.addChild("name", new dnode(dtpString("alpha")));
+  output.addChild("count", new dnode(12));
+  output.addChild("ratio", new dnode(0.5));
+  output.addChild("flag", new dnode(true));
+
+  dnode *values = new dnode(ict_array, vt_double);
+  for(int i=0; i < 10; i++)
+    values->addItem(static_cast<double>(i) / 2.0);
+  output.addChild("values", values);
+
+  dnode *tags = new dnode(ict_array, vt_string);
+  tags->addItem(dtpString("red"));
+  tags->addItem(dtpString("green"));
+  output.addChild("tags", tags);
+
+  dnode *items = new dnode(ict_list);
+  for(int i=0; i < 3; i++) {
+    dnode *item = new dnode(ict_parent);
+    item->addChild("id", new dnode(i));
+    item->addChild("label", new dnode(dtpString("item") + toString(i)));
+    items->addChild(item);
+  }
+  output.addChild("items", items);
+}
+
+BOOST_AUTO_TEST_CASE(test_view_access)
+{
+  dnode source;
+  build_view_sample(source);
+
+  std::vector<char> buffer;
+  dnViewWriter::write(source, buffer);
+
+  dnodeView root = dnodeView::open(&buffer[0], buffer.size());
+  BOOST_CHECK(root.validate(buffer.size()));
+
+  BOOST_CHECK(root.isParent());
+  BOOST_CHECK(root.supportsNames());
+  BOOST_CHECK(root.size() == source.size());
+  BOOST_CHECK(root.getElementName(0) == "name");
+  BOOST_CHECK(root.hasChild("ratio"));
+  BOOST_CHECK(!root.hasChild("missing"));
+  BOOST_CHECK(root.indexOfName("flag") == 3);
+
+  BOOST_CHECK(root.getElement("name").getStringRef() == "alpha");
+  BOOST_CHECK(root.get<int>("count") == 12);
+  BOOST_CHECK(root.get<double>("ratio") == 0.5);
+  BOOST_CHECK(root.get<bool>("flag"));
+  // conversion rules same as in dnode
+  BOOST_CHECK(root.get<dtpString>("count") == source.get<dtpString>("count"));
+  BOOST_CHECK(root.get<double>("count") == 12.0);
+
+  dnodeView values = root.getElement("values");
+  BOOST_CHECK(values.isArray());
+  BOOST_CHECK(values.getElementType() == vt_double);
+  BOOST_CHECK(values.size() == 10);
+  BOOST_CHECK(values.get<double>(3) == 1.5);
+  BOOST_CHECK(values.arrayData<double>()[9] == 4.5);
+
+  dnodeView tags = root.getElement("tags");
+  BOOST_CHECK(tags.getElement(1).getStringRef() == "green");
+  BOOST_CHECK(tags.get<dtpString>(0) == "red");
+
+  dnodeView items = root.getElement("items");
+  BOOST_CHECK(items.isList());
+  BOOST_CHECK(items.getElementName(0).empty());
+
+  int sum = 0;
+  for(dnodeView::const_iterator it = items.begin(), epos = items.end(); it != epos; ++it)
+    sum += it->get<int>("id");
+  BOOST_CHECK(sum == 3);
+
+  dnodeView found;
+  BOOST_CHECK(root.getElementByPath("items/2/label", found));
+  BOOST_CHECK(found.getStringRef() == "item2");
+  BOOST_CHECK(root.getElementByPath("values/4", found));
+  BOOST_CHECK(found.getAs<double>() == 2.0);
+  BOOST_CHECK(!root.getElementByPath("items/5/label", found));
+  BOOST_CHECK(!root.getElementByPath("name/x", found));
+
+  BOOST_CHECK_THROW(root.getElement("missing"), dnError);
+  BOOST_CHECK_THROW(values.getElement(10), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_view_to_node)
+{
+  dnode source;
+  build_view_sample(source);
+
+  std::vector<char> buffer;
+  dnViewWriter::write(source, buffer);
+
+  dnode copy;
+  dnodeView::open(&buffer[0], buffer.size()).toNode(copy);
+  BOOST_CHECK(dnode_deep_equal(copy, source));
+}
+
+BOOST_AUTO_TEST_CASE(test_view_date_time)
+{
+  dnode source(ict_parent);
+  dnode *date = new dnode(45000.0);
+  date->convertTo(vt_date);
+  dnode *time = new dnode(0.25);
+  time->convertTo(vt_time);
+  dnode *stamp = new dnode(45000.5);
+  stamp->convertTo(vt_datetime);
+  source.addChild("date", date);
+  source.addChild("time", time);
+  source.addChild("stamp", stamp);
+
+  std::vector<char> buffer;
+  dnViewWriter::write(source, buffer);
+  dnodeView root = dnodeView::open(&buffer[0], buffer.size());
+  BOOST_CHECK(root.validate(buffer.size()));
+
+  BOOST_CHECK(root.getElement("date").getValueType() == vt_date);
+  BOOST_CHECK(root.getElement("time").getValueType() == vt_time);
+  BOOST_CHECK(root.getElement("stamp").getValueType() == vt_datetime);
+  BOOST_CHECK(root.get<double>("stamp") == 45000.5);
+  BOOST_CHECK(root.get<dtpString>("date") == source.get<dtpString>("date"));
+
+  dnode copy;
+  root.toNode(copy);
+  BOOST_CHECK(copy["time"].getValueType() == vt_time);
+  BOOST_CHECK(dnode_deep_equal(copy, source));
+
+  // pointers are meaningless outside of process
+  source.addChild("ptr", new dnode(static_cast<void_ptr>(&source)));
+  BOOST_CHECK_THROW(dnViewWriter::write(source, buffer), dnError);
+}
+
+BOOST_AUTO_TEST_CASE(test_view_invalid)
+{
+  std::vector<char> buffer(64, 'x');
+  BOOST_CHECK_THROW(dnodeView::open(&buffer[0], buffer.size()), dnViewFormatError);
+
+  dnode source;
+  build_view_sample(source);
+  dnViewWriter::write(source, buffer);
+  BOOST_CHECK_THROW(dnodeView::open(&buffer[0], buffer.size() / 2), dnViewFormatError);
+}
+
+BOOST_AUTO_TEST_CASE(test_view_validate_overflow)
+{
+  dnode source(ict_array, vt_int);
+  for(int i=0; i < 3; i++)
+    source.addItem(i);
+
+  std::vector<char> buffer;
+  dnViewWriter::write(source, buffer);
+  BOOST_CHECK(dnodeView::open(&buffer[0], buffer.size()).validate(buffer.size()));
+
+  // item offset close to 2^64 - offset + size wraps around to a small value
+  Details::dnViewHeader header;
+  memcpy(&header, &buffer[0], sizeof(header));
+  Details::dnViewRecord record;
+  memcpy(&record, &buffer[static_cast<size_t>(header.rootOffset)], sizeof(record));
+  record.a = static_cast<uint64>(0) - 8;
+  memcpy(&buffer[static_cast<size_t>(header.rootOffset)], &record, sizeof(record));
+
+  BOOST_CHECK(!dnodeView::open(&buffer[0], buffer.size()).validate(buffer.size()));
+}
@@ -24,39 +24,57 @@ bool scDbBase::isSupported(unsigned int flags, unsigned int domain)
   return false;
 }
 
-/// perform SQL insert
-ulong64 scDbBase::insertData(const scString &a_tableName, const scDataNode *values, const scDataNode *columnNames)
+/// Returns list of column names: given list, child names of values or names
+/// exploded from a single comma-separated string (only then helper is used).
+static const scDataNode *prepareColumnNames(const scDataNode *values, const scDataNode *columnNames, scDataNode &helper)
 {
-  scString columns, sqlTxt, nameTxt;
-  scDataNode columnNameList, valueList, paramList, name;
-  
   if (columnNames != SC_NULL)
   {
-    columns = columnNames->implode(",");
+    if (columnNames->size())
+      return columnNames;
+    scDataNode::explode(",", columnNames->implode(","), helper);
   } else if (values->isParent()) {
-    columns = values->childNames().implode(",");
-  } 
-  
-  if (columns.length() <= 0) {
+    helper = values->childNames();
+  }
+  return &helper;
+}
+
+/// perform SQL insert
+ulong64 scDbBase::insertData(const scString &a_tableName, const scDataNode *values, const scDataNode *columnNames)
+{
+  scString columns, valueList, sqlTxt, nameTxt;
+  scDataNode columnNameHelper, paramList, name;
+
+  const scDataNode *columnNameList = prepareColumnNames(values, columnNames, columnNameHelper);
+
+  if (columnNameList->size() <= 0) {
     throw scError("insertData: column names not provided");
   }
-  
-  scDataNode::explode(",", columns, columnNameList);
+
   std::auto_ptr<scDataNode> paramGuard;
   paramList.setAsParent();
-   
-  for(int i=0, epos = columnNameList.size(); i != epos; i++)
-  {    
-    columnNameList.getElement(i, name);  
+
+  // column & value lists are built directly, without implode/explode round-trip
+  for(int i=0, epos = columnNameList->size(); i != epos; i++)
+  {
+    columnNameList->getElement(i, name);
     nameTxt = name.getAsString();
     paramGuard.reset(new scDataNode((*values)[i]));
     paramList.addChild(nameTxt, paramGuard.release());
-    valueList.addItemAsString("{"+nameTxt+"}");
+
+    if (i != 0) {
+      columns += ",";
+      valueList += ",";
+    }
+    columns += nameTxt;
+    valueList += "{";
+    valueList += nameTxt;
+    valueList += "}";
   }
-  
-  sqlTxt = 
-  "insert into "+a_tableName+" ("+columns+") values("+valueList.implode(",")+")";
-  
+
+  sqlTxt =
+  "insert into "+a_tableName+" ("+columns+") values("+valueList+")";
+
   return execute(sqlTxt, &paramList);
 }
 
@@ -64,29 +82,23 @@ ulong64 scDbBase::insertData(const scString &a_tableName, const scDataNode *valu
 ulong64 scDbBase::updateData(const scString &a_tableName, 
   const scDataNode *values, const scDataNode *columnNames, const scDataNode *selectorParams, const scString *selectorSql)
 {
-  scString columns, sqlTxt, nameTxt, paramName, whereTxt;
-  scDataNode columnNameList, paramList, name, setList, selectorList, param;
+  scString sqlTxt, nameTxt, paramName, whereTxt;
+  scDataNode columnNameHelper, paramList, name, setList, selectorList, param;
   assert((selectorParams != SC_NULL) || (selectorSql != SC_NULL));    
   
-  if (columnNames != SC_NULL)
-  {
-    columns = columnNames->implode(",");
-  } else if (values->isParent()) {
-    columns = values->childNames().implode(",");
-  } 
+  const scDataNode *columnNameList = prepareColumnNames(values, columnNames, columnNameHelper);
   
-  if (columns.length() <= 0) {
+  if (columnNameList->size() <= 0) {
     throw scError("updateData: column names not provided");
   }
   
-  scDataNode::explode(",", columns, columnNameList);
   std::auto_ptr<scDataNode> paramGuard;
 
   paramList.setAsParent();
    
-  for(int i=0, epos = columnNameList.size(); i != epos; i++)
+  for(int i=0, epos = columnNameList->size(); i != epos; i++)
   {    
-    columnNameList.getElement(i, name);  
+    columnNameList->getElement(i, name);  
     nameTxt = name.getAsString();
     paramName = "v_"+nameTxt;
     setList.addItemAsString(nameTxt+" = "+"{"+paramName+"}");
@@ -16,7 +16,10 @@
 /** \file varint.h
 \brief Encode & decode variable-size integer values.
 
-Long description
+Values up to 31 bits use UTF-8 like encoding (1-6 bytes).
+Larger values of 64-bit types use lead byte 0xFE followed by 7 bytes (42 bits)
+or lead byte 0xFF followed by 11 bytes (full 64 bits), each following byte
+keeps 6 bits of value.
 */
 
 // ----------------------------------------------------------------------------
@@ -36,6 +39,31 @@ Long description
 // Constants
 // ----------------------------------------------------------------------------
 const unsigned int VARINT_MAX_SIZE_INT = 6;
+const unsigned int VARINT_MAX_SIZE_INT64 = 12;
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+/// Writes lead byte & 6-bit groups of value (most significant first)
+inline void varint_encode_wide(unsigned long long value, unsigned char leadByte, unsigned int groupCount, unsigned char *output)
+{
+  *output = leadByte;
+  for(unsigned int i = groupCount; i > 0; i--) {
+    output++;
+    *output = static_cast<unsigned char>(0x80 | ((value >> (6 * (i - 1))) & 0x3f));
+  }
+}
+
+/// Reads 6-bit groups of value following lead byte
+inline unsigned long long varint_decode_wide(const unsigned char *input, unsigned int groupCount)
+{
+  unsigned long long res = 0;
+  for(unsigned int i = 0; i < groupCount; i++) {
+    input++;
+    res = (res << 6) | ((*input) & 0x3f);
+  }
+  return res;
+}
 
 // ----------------------------------------------------------------------------
 // Functions
@@ -132,9 +160,15 @@ unsigned int varint_encode(T value, void *output, size_t outputSize)
     destPtr++;
     writeByte = 0x80 | (value & 0x3f);
     *destPtr = writeByte;
+  } else if (static_cast<unsigned long long>(value) <= 0x3FFFFFFFFFFULL)
+  {
+    writtenSize = 8;
+    assert(writtenSize <= outputSize);
+    varint_encode_wide(static_cast<unsigned long long>(value), 0xFE, 7, destPtr);
   } else {
-    assert(false);
-    writtenSize = 0;
+    writtenSize = 12;
+    assert(writtenSize <= outputSize);
+    varint_encode_wide(static_cast<unsigned long long>(value), 0xFF, 11, destPtr);
   }
 
   assert(writtenSize > 0);
@@ -178,7 +212,7 @@ unsigned int varint_decode(void *input, size_t inputSize, T &output)
     assert(inputSize >= 4);
     output =  ((*srcPtr) & 0x07) << 18;
     srcPtr++;
-    output =  ((*srcPtr) & 0x3f) << 12;
+    output += ((*srcPtr) & 0x3f) << 12;
     srcPtr++;
     output += ((*srcPtr) & 0x3f) << 6;
     srcPtr++;
@@ -188,9 +222,9 @@ unsigned int varint_decode(void *input, size_t inputSize, T &output)
     assert(inputSize >= 5);
     output =  ((*srcPtr) & 0x03) << 24;
     srcPtr++;
-    output =  ((*srcPtr) & 0x3f) << 18;
+    output += ((*srcPtr) & 0x3f) << 18;
     srcPtr++;
-    output =  ((*srcPtr) & 0x3f) << 12;
+    output += ((*srcPtr) & 0x3f) << 12;
     srcPtr++;
     output += ((*srcPtr) & 0x3f) << 6;
     srcPtr++;
@@ -200,18 +234,23 @@ unsigned int varint_decode(void *input, size_t inputSize, T &output)
     assert(inputSize >= 6);
     output =  ((*srcPtr) & 0x01) << 30;
     srcPtr++;
-    output =  ((*srcPtr) & 0x3f) << 24;
+    output += ((*srcPtr) & 0x3f) << 24;
     srcPtr++;
-    output =  ((*srcPtr) & 0x3f) << 18;
+    output += ((*srcPtr) & 0x3f) << 18;
     srcPtr++;
-    output =  ((*srcPtr) & 0x3f) << 12;
+    output += ((*srcPtr) & 0x3f) << 12;
     srcPtr++;
     output += ((*srcPtr) & 0x3f) << 6;
     srcPtr++;
     output += ((*srcPtr) & 0x3f);
+  } else if (*srcPtr == 0xFE) {
+    srcSize = 8;
+    assert(inputSize >= 8);
+    output = static_cast<T>(varint_decode_wide(srcPtr, 7));
   } else {
-    assert(false);
-    srcSize = 0;
+    srcSize = 12;
+    assert(inputSize >= 12);
+    output = static_cast<T>(varint_decode_wide(srcPtr, 11));
   }
 
   assert(srcSize > 0);
@@ -241,9 +280,10 @@ inline unsigned int varint_get_size(void *input, size_t inputSize)
     srcSize = 5;
   } else if (*srcPtr < 0xFE) {
     srcSize = 6;
+  } else if (*srcPtr == 0xFE) {
+    srcSize = 8;
   } else {
-    assert(false);
-    srcSize = 0;
+    srcSize = 12;
   }
 
   assert(srcSize > 0);
@@ -57,3 +57,43 @@ BOOST_AUTO_TEST_CASE(varint_test)
   BOOST_CHECK(value = value1);
 }
 
+
+BOOST_AUTO_TEST_CASE(varint_test_wide)
+{
+  char valbuffer[VARINT_MAX_SIZE_INT64];
+  uint value, value1;
+  uint64 value64, value64b;
+  size_t writtenSize, readSize;
+
+  // 4-6 byte values
+  value = 300000;
+  writtenSize = varint_encode(value, valbuffer, sizeof(valbuffer));
+  readSize = varint_decode(valbuffer, sizeof(valbuffer), value1);
+  BOOST_CHECK_EQUAL(writtenSize, 4U);
+  BOOST_CHECK(readSize == writtenSize);
+  BOOST_CHECK_EQUAL(value, value1);
+
+  value = 0x7FFFFFF0;
+  writtenSize = varint_encode(value, valbuffer, sizeof(valbuffer));
+  readSize = varint_decode(valbuffer, sizeof(valbuffer), value1);
+  BOOST_CHECK_EQUAL(writtenSize, 6U);
+  BOOST_CHECK(readSize == writtenSize);
+  BOOST_CHECK_EQUAL(value, value1);
+
+  // 64-bit values
+  value64 = 5000000000ULL;
+  writtenSize = varint_encode(value64, valbuffer, sizeof(valbuffer));
+  BOOST_CHECK_EQUAL(varint_get_size(valbuffer, sizeof(valbuffer)), writtenSize);
+  readSize = varint_decode(valbuffer, sizeof(valbuffer), value64b);
+  BOOST_CHECK_EQUAL(writtenSize, 8U);
+  BOOST_CHECK(readSize == writtenSize);
+  BOOST_CHECK(value64 == value64b);
+
+  value64 = 0xFFFFFFFFFFFFFFFFULL;
+  writtenSize = varint_encode(value64, valbuffer, sizeof(valbuffer));
+  BOOST_CHECK_EQUAL(varint_get_size(valbuffer, sizeof(valbuffer)), writtenSize);
+  readSize = varint_decode(valbuffer, sizeof(valbuffer), value64b);
+  BOOST_CHECK_EQUAL(writtenSize, 12U);
+  BOOST_CHECK(readSize == writtenSize);
+  BOOST_CHECK(value64 == value64b);
+}